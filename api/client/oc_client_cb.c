@@ -23,6 +23,7 @@
 
 #include "api/client/oc_client_cb_internal.h"
 #include "api/oc_discovery_internal.h"
+#include "api/oc_endpoint_internal.h"
 #include "api/oc_event_callback_internal.h"
 #include "api/oc_helpers_internal.h"
 #include "api/oc_ping_internal.h"
@@ -325,6 +326,19 @@ oc_ri_free_client_cbs_by_endpoint_v1(const oc_endpoint_t *endpoint,
   }
 }
 
+void
+oc_client_cbs_update_endpoint(const oc_endpoint_t *from,
+                              const oc_endpoint_t *to)
+{
+  for (oc_client_cb_t *cb = (oc_client_cb_t *)oc_list_head(g_client_cbs);
+       cb != NULL; cb = cb->next) {
+    if (!cb->multicast && !cb->discovery &&
+        oc_endpoint_compare(&cb->endpoint, from) == 0) {
+      oc_endpoint_copy_address(&cb->endpoint, to);
+    }
+  }
+}
+
 void
 oc_ri_free_client_cbs_by_endpoint(const oc_endpoint_t *endpoint)
 {
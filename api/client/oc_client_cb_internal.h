@@ -106,6 +106,16 @@ void oc_client_cbs_shutdown(void);
 /** @brief Initialize multicast client callbacks. */
 void oc_client_cbs_shutdown_multicasts(void);
 
+/**
+ * @brief Move the callbacks awaiting a response from a server to a new
+ * address of the server.
+ *
+ * @param from previous endpoint of the server (cannot be NULL)
+ * @param to new endpoint of the server (cannot be NULL)
+ */
+void oc_client_cbs_update_endpoint(const oc_endpoint_t *from,
+                                   const oc_endpoint_t *to) OC_NONNULL();
+
 /**
  * @brief Removes the client callback. This is silent remove client without
  * triggering of 'cb.handler'.
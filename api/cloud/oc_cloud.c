@@ -124,13 +124,77 @@ oc_cloud_set_endpoint(oc_cloud_context_t *ctx)
     ctx->cloud_ep->device = ctx->device;
     success = true;
   }
-#ifdef OC_DNS_CACHE
-  oc_dns_clear_cache();
-#endif /* OC_DNS_CACHE */
 
   return success;
 }
 
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+
+static void
+cloud_endpoint_resolved(int status, const oc_endpoint_t *endpoint,
+                        void *user_data)
+{
+  oc_cloud_context_t *ctx = (oc_cloud_context_t *)user_data;
+  oc_trigger_t step = ctx->cloud_ep_resolve_step;
+  ctx->cloud_ep_resolve_step = NULL;
+  if (status == 0) {
+    oc_endpoint_copy(ctx->cloud_ep, endpoint);
+    // set device id to cloud endpoint for multiple servers
+    ctx->cloud_ep->device = ctx->device;
+  } else {
+    ctx->cloud_ep_resolve_failed = true;
+  }
+  if (step != NULL) {
+    oc_reset_delayed_callback(ctx, step, 0);
+  }
+}
+
+int
+oc_cloud_resolve_endpoint_async(oc_cloud_context_t *ctx, oc_trigger_t step)
+{
+  assert(ctx->cloud_ep != NULL);
+  if (!oc_endpoint_is_empty(ctx->cloud_ep)) {
+    return 0;
+  }
+  if (ctx->cloud_ep_resolve_failed) {
+    // report the failure of the finished resolution to the rescheduled step
+    ctx->cloud_ep_resolve_failed = false;
+    return -1;
+  }
+  if (oc_endpoint_resolve_is_pending(&ctx->cloud_ep_resolve)) {
+    ctx->cloud_ep_resolve_step = step;
+    return 1;
+  }
+
+  const oc_string_t *ep_addr =
+    oc_endpoint_addresses_selected_uri(&ctx->store.ci_servers);
+  int ret = oc_string_to_endpoint_async(ep_addr, ctx->cloud_ep,
+                                        &ctx->cloud_ep_resolve,
+                                        cloud_endpoint_resolved, ctx);
+  if (ret == 0) {
+    // set device id to cloud endpoint for multiple servers
+    ctx->cloud_ep->device = ctx->device;
+    return 0;
+  }
+  if (ret < 0) {
+    memset(ctx->cloud_ep, 0, sizeof(oc_endpoint_t));
+    return -1;
+  }
+  OC_CLOUD_DBG("resolving cloud endpoint %s", oc_string(*ep_addr));
+  ctx->cloud_ep_resolve_step = step;
+  return 1;
+}
+
+void
+oc_cloud_resolve_endpoint_cancel(oc_cloud_context_t *ctx)
+{
+  oc_endpoint_resolve_cancel(&ctx->cloud_ep_resolve);
+  ctx->cloud_ep_resolve_step = NULL;
+  ctx->cloud_ep_resolve_failed = false;
+}
+
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
+
 void
 oc_cloud_endpoint_log(const char *prefix, const oc_endpoint_t *endpoint)
 {
@@ -165,6 +229,9 @@ oc_cloud_close_endpoint(const oc_endpoint_t *ep)
 void
 oc_cloud_reset_endpoint(oc_cloud_context_t *ctx)
 {
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+  oc_cloud_resolve_endpoint_cancel(ctx);
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
   oc_cloud_close_endpoint(ctx->cloud_ep);
   memset(ctx->cloud_ep, 0, sizeof(oc_endpoint_t));
   ctx->cloud_ep_state = OC_SESSION_DISCONNECTED;
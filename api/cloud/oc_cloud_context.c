@@ -37,6 +37,7 @@
 #endif /* OC_SECURITY */
 
 #include <assert.h>
+#include <string.h>
 
 OC_LIST(g_cloud_context_list);
 OC_MEMB(g_cloud_context_pool, oc_cloud_context_t, OC_MAX_NUM_DEVICES);
@@ -96,6 +97,11 @@ cloud_context_init(size_t device)
   ctx->device = device;
   ctx->cloud_ep_state = OC_SESSION_DISCONNECTED;
   ctx->cloud_ep = oc_new_endpoint();
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+  memset(&ctx->cloud_ep_resolve, 0, sizeof(ctx->cloud_ep_resolve));
+  ctx->cloud_ep_resolve_step = NULL;
+  ctx->cloud_ep_resolve_failed = false;
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
   ctx->selected_identity_cred_id = -1;
   oc_cloud_store_initialize(&ctx->store, cloud_context_on_server_change, ctx);
   oc_cloud_store_load(&ctx->store);
@@ -125,6 +131,9 @@ cloud_context_deinit(oc_cloud_context_t *ctx)
   // when the device is shut down during de-registration.
   reinitialize_cloud_storage(ctx);
   oc_cloud_store_deinitialize(&ctx->store);
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+  oc_cloud_resolve_endpoint_cancel(ctx);
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
   oc_cloud_close_endpoint(ctx->cloud_ep);
   oc_free_endpoint(ctx->cloud_ep);
   oc_list_remove(g_cloud_context_list, ctx);
@@ -20,6 +20,7 @@
 #define OC_CLOUD_CONTEXT_INTERNAL_H
 
 #include "api/cloud/oc_cloud_store_internal.h"
+#include "api/oc_endpoint_internal.h"
 #include "oc_cloud.h"
 #include "util/oc_compiler.h"
 
@@ -88,10 +89,18 @@ struct oc_cloud_context_t
 
   oc_session_state_t cloud_ep_state;
   oc_endpoint_t *cloud_ep;
-
-  oc_link_t *rd_publish_resources;   /**< Resource links to publish */
-  oc_link_t *rd_published_resources; /**< Resource links already published */
-  oc_link_t *rd_delete_resources;    /**< Resource links to delete */
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+  oc_endpoint_resolve_t cloud_ep_resolve; /**< Resolution of cloud_ep */
+  oc_trigger_t cloud_ep_resolve_step; /**< Cloud manager step resumed once
+                                         cloud_ep is resolved */
+  bool cloud_ep_resolve_failed; /**< Last resolution of cloud_ep failed */
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
+
+  oc_link_t *rd_publish_resources;    /**< Resource links to publish */
+  oc_link_t *rd_publishing_resources; /**< Resource links of the publish
+                                         request in flight */
+  oc_link_t *rd_published_resources;  /**< Resource links already published */
+  oc_link_t *rd_delete_resources;     /**< Resource links to delete */
 
   oc_cloud_registration_context_t registration_ctx; /**< Registration context */
 
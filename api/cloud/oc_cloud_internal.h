@@ -68,6 +68,31 @@ void cloud_deinit_devices(size_t devices);
 /** Set cloud endpoint from currently selected cloud server address */
 bool oc_cloud_set_endpoint(oc_cloud_context_t *ctx) OC_NONNULL();
 
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+
+/**
+ * @brief Set cloud endpoint from currently selected cloud server address
+ * without blocking the event loop on a DNS lookup.
+ *
+ * If the address must be resolved, the step is rescheduled once the lookup
+ * finishes and the step should return without doing anything else. The
+ * rescheduled step gets the result of the resolution from the next call.
+ *
+ * @param ctx cloud context (cannot be NULL)
+ * @param step cloud manager step to reschedule (cannot be NULL)
+ * @return 0 cloud endpoint is set
+ * @return 1 resolution of the cloud endpoint is in progress
+ * @return -1 on failure
+ */
+int oc_cloud_resolve_endpoint_async(oc_cloud_context_t *ctx, oc_trigger_t step)
+  OC_NONNULL();
+
+/** Cancel the resolution of the cloud endpoint started by
+ * oc_cloud_resolve_endpoint_async */
+void oc_cloud_resolve_endpoint_cancel(oc_cloud_context_t *ctx) OC_NONNULL();
+
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
+
 /** Close connection to currently selected cloud server address  */
 void oc_cloud_close_endpoint(const oc_endpoint_t *ep) OC_NONNULL();
 
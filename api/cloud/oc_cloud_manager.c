@@ -75,9 +75,12 @@ cloud_manager_start(oc_cloud_context_t *ctx)
 }
 
 void
-cloud_manager_stop(const oc_cloud_context_t *ctx)
+cloud_manager_stop(oc_cloud_context_t *ctx)
 {
   OC_CLOUD_DBG("cloud_manager_stop");
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+  oc_cloud_resolve_endpoint_cancel(ctx);
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
   oc_remove_delayed_callback(ctx, cloud_manager_reconnect_async);
   oc_remove_delayed_callback(ctx, cloud_manager_register_async);
   oc_remove_delayed_callback(ctx, cloud_manager_login_async);
@@ -413,6 +416,17 @@ cloud_manager_register_async(void *data)
   }
 
   OC_CLOUD_DBG("try register(%d)", ctx->retry.count);
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+  int resolved =
+    oc_cloud_resolve_endpoint_async(ctx, cloud_manager_register_async);
+  if (resolved > 0) {
+    // the step is rescheduled once the cloud endpoint is resolved
+    return OC_EVENT_DONE;
+  }
+  if (resolved < 0) {
+    goto retry;
+  }
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
   oc_cloud_access_conf_t conf;
   if (!oc_cloud_set_access_conf(ctx, cloud_manager_register_handler, ctx,
                                 ctx->schedule_action.timeout, &conf)) {
@@ -652,6 +666,17 @@ cloud_manager_login_async(void *data)
   }
 
   OC_CLOUD_DBG("try login(%d)", ctx->retry.count);
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+  int resolved =
+    oc_cloud_resolve_endpoint_async(ctx, cloud_manager_login_async);
+  if (resolved > 0) {
+    // the step is rescheduled once the cloud endpoint is resolved
+    return OC_EVENT_DONE;
+  }
+  if (resolved < 0) {
+    goto retry;
+  }
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
   oc_cloud_access_conf_t conf;
   if (!oc_cloud_set_access_conf(ctx, cloud_manager_login_handler, ctx,
                                 ctx->schedule_action.timeout, &conf)) {
@@ -872,6 +897,17 @@ cloud_manager_refresh_token_async(void *data)
   oc_remove_delayed_callback(ctx, cloud_manager_send_ping_async);
 
   OC_CLOUD_DBG("try refresh token(%d)", ctx->retry.refresh_token_count);
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+  int resolved =
+    oc_cloud_resolve_endpoint_async(ctx, cloud_manager_refresh_token_async);
+  if (resolved > 0) {
+    // the step is rescheduled once the cloud endpoint is resolved
+    return OC_EVENT_DONE;
+  }
+  if (resolved < 0) {
+    goto retry;
+  }
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
   oc_cloud_access_conf_t conf;
   if (!oc_cloud_set_access_conf(ctx, cloud_manager_refresh_token_handler, ctx,
                                 ctx->schedule_action.timeout, &conf)) {
@@ -99,7 +99,7 @@ void cloud_manager_start(oc_cloud_context_t *ctx) OC_NONNULL();
  *
  * @param ctx cloud context (cannot be NULL)
  */
-void cloud_manager_stop(const oc_cloud_context_t *ctx) OC_NONNULL();
+void cloud_manager_stop(oc_cloud_context_t *ctx) OC_NONNULL();
 
 /**
  * @brief Check if retry of the cloud registration step with changed server
@@ -72,6 +72,25 @@ rd_link_pop(oc_link_t **head)
   return link;
 }
 
+/* Move all links to the end of the list */
+static void
+rd_link_append_all(oc_link_t **head, oc_link_t **links)
+{
+  if (*links == NULL) {
+    return;
+  }
+  if (*head == NULL) {
+    *head = *links;
+  } else {
+    oc_link_t *tail = *head;
+    while (tail->next != NULL) {
+      tail = tail->next;
+    }
+    tail->next = *links;
+  }
+  *links = NULL;
+}
+
 static void
 rd_link_free(oc_link_t **head)
 {
@@ -112,23 +131,19 @@ rd_link_remove_by_resource(oc_link_t **head, const oc_resource_t *res)
   return rd_link_remove(head, rd_link_find(*head, res));
 }
 
-static void
-cloud_publish_resources_handler(oc_client_response_t *data)
-{
-  oc_cloud_context_t *ctx = (oc_cloud_context_t *)data->user_data;
-  OC_CLOUD_DBG("publish resources handler(%d)", data->code);
-
-  if ((ctx->store.status & OC_CLOUD_LOGGED_IN) == 0) {
-    return;
-  }
-  if (data->code != OC_STATUS_CHANGED) {
-    return;
-  }
+static void cloud_publish_resources(oc_cloud_context_t *ctx);
 
+/* Move the links confirmed by the response from the list of links in flight
+ * to the list of published links, returns the number of confirmed links */
+static size_t
+cloud_publish_resources_confirm(oc_cloud_context_t *ctx,
+                                const oc_rep_t *payload)
+{
   oc_rep_t *link = NULL;
-  if (!oc_rep_get_object_array(data->payload, OC_RSRVD_LINKS, &link)) {
-    return;
+  if (!oc_rep_get_object_array(payload, OC_RSRVD_LINKS, &link)) {
+    return 0;
   }
+  size_t confirmed = 0;
   for (; link != NULL; link = link->next) {
     char *href = NULL;
     size_t href_size = 0;
@@ -144,15 +159,40 @@ cloud_publish_resources_handler(oc_client_response_t *data)
       continue;
     }
     oc_link_t *l =
-      rd_link_find_by_href(ctx->rd_publish_resources, href, href_size);
+      rd_link_find_by_href(ctx->rd_publishing_resources, href, href_size);
     if (l == NULL) {
       OC_CLOUD_DBG("link(%s) skipped: not found", href);
       continue;
     }
     l->ins = instance_id;
-    rd_link_remove(&ctx->rd_publish_resources, l);
+    rd_link_remove(&ctx->rd_publishing_resources, l);
     OC_CLOUD_DBG("link(href=%s,ins=%" PRId64 ") published", href, instance_id);
-    rd_link_add(&ctx->rd_published_resources, l);
+    // the order of the published links doesn't matter, avoid walking the list
+    l->next = ctx->rd_published_resources;
+    ctx->rd_published_resources = l;
+    ++confirmed;
+  }
+  return confirmed;
+}
+
+static void
+cloud_publish_resources_handler(oc_client_response_t *data)
+{
+  oc_cloud_context_t *ctx = (oc_cloud_context_t *)data->user_data;
+  OC_CLOUD_DBG("publish resources handler(%d)", data->code);
+
+  size_t confirmed = 0;
+  if ((ctx->store.status & OC_CLOUD_LOGGED_IN) != 0 &&
+      data->code == OC_STATUS_CHANGED) {
+    confirmed = cloud_publish_resources_confirm(ctx, data->payload);
+  }
+  // links not confirmed by the response are published again by the next
+  // request
+  rd_link_append_all(&ctx->rd_publish_resources,
+                     &ctx->rd_publishing_resources);
+  if (confirmed > 0 && ctx->rd_publish_resources != NULL) {
+    // continue with the links that didn't fit into the previous request
+    cloud_publish_resources(ctx);
   }
 }
 
@@ -170,12 +210,59 @@ cloud_publish_resources(oc_cloud_context_t *ctx)
     OC_CLOUD_DBG("cannot publish resource links when not logged in");
     return;
   }
+  if (ctx->rd_publishing_resources != NULL) {
+    // the links are published when the response to the request in flight is
+    // received
+    OC_CLOUD_DBG("publish of resource links already in progress");
+    return;
+  }
 
-  if (!rd_publish(ctx->rd_publish_resources, ctx->cloud_ep, ctx->device,
-                  ctx->time_to_live, cloud_publish_resources_handler, LOW_QOS,
-                  ctx)) {
+  if (ctx->rd_publish_resources == NULL) {
+    if (!rd_publish(NULL, ctx->cloud_ep, ctx->device, ctx->time_to_live,
+                    cloud_publish_resources_handler, LOW_QOS, ctx)) {
+      OC_CLOUD_ERR("cannot send publish resource links request");
+    }
+    return;
+  }
+
+  rd_publish_partition_t partition;
+  memset(&partition, 0, sizeof(rd_publish_partition_t));
+  if (!rd_publish_partial(ctx->rd_publish_resources, ctx->cloud_ep, ctx->device,
+                          ctx->time_to_live, rd_publish_max_payload_size(),
+                          cloud_publish_resources_handler, LOW_QOS, ctx,
+                          &partition)) {
     OC_CLOUD_ERR("cannot send publish resource links request");
+    return;
   }
+  ctx->rd_publishing_resources = partition.published;
+  ctx->rd_publish_resources = partition.not_published;
+}
+
+static void cloud_delete_resources(oc_cloud_context_t *ctx);
+
+static oc_event_callback_retval_t
+cloud_rd_publish_changes_async(void *data)
+{
+  oc_cloud_context_t *ctx = (oc_cloud_context_t *)data;
+  if (ctx->rd_publish_resources != NULL) {
+    cloud_publish_resources(ctx);
+  }
+  if (ctx->rd_delete_resources != NULL) {
+    cloud_delete_resources(ctx);
+  }
+  return OC_EVENT_DONE;
+}
+
+/* Changes of the resource links are collected for a short time and sent
+ * together */
+static void
+cloud_rd_schedule_changes(oc_cloud_context_t *ctx)
+{
+  if (oc_has_delayed_callback(ctx, cloud_rd_publish_changes_async, false)) {
+    return;
+  }
+  oc_set_delayed_callback_ms_v1(ctx, cloud_rd_publish_changes_async,
+                                OC_CLOUD_RD_BATCH_DELAY_MS);
 }
 
 int
@@ -192,6 +279,10 @@ oc_cloud_add_resource(oc_resource_t *res)
   if (publish != NULL) {
     return 0;
   }
+  const oc_link_t *publishing = rd_link_find(ctx->rd_publishing_resources, res);
+  if (publishing != NULL) {
+    return 0;
+  }
   const oc_link_t *published = rd_link_find(ctx->rd_published_resources, res);
   if (published != NULL) {
     return 0;
@@ -207,17 +298,25 @@ oc_cloud_add_resource(oc_resource_t *res)
     return -1;
   }
   rd_link_add(&ctx->rd_publish_resources, link);
-  cloud_publish_resources(ctx);
+  cloud_rd_schedule_changes(ctx);
   return 0;
 }
 
 static void
 move_published_to_publish_resources(oc_cloud_context_t *ctx)
 {
-  while (ctx->rd_published_resources) {
-    oc_link_t *link = rd_link_pop(&ctx->rd_published_resources);
-    rd_link_add(&ctx->rd_publish_resources, link);
-  }
+  rd_link_append_all(&ctx->rd_publish_resources,
+                     &ctx->rd_published_resources);
+}
+
+/* The response to the request in flight won't be processed anymore, so its
+ * links are published again too */
+static void
+move_all_to_publish_resources(oc_cloud_context_t *ctx)
+{
+  rd_link_append_all(&ctx->rd_publish_resources,
+                     &ctx->rd_publishing_resources);
+  move_published_to_publish_resources(ctx);
 }
 
 static oc_event_callback_retval_t
@@ -229,8 +328,6 @@ publish_published_resources(void *data)
   return OC_EVENT_CONTINUE;
 }
 
-static void cloud_delete_resources(oc_cloud_context_t *ctx);
-
 static void
 delete_resources_handler(oc_client_response_t *data)
 {
@@ -290,18 +387,17 @@ cloud_rd_manager_status_changed(oc_cloud_context_t *ctx)
 {
   if ((ctx->store.status & OC_CLOUD_LOGGED_IN) == 0) {
     oc_remove_delayed_callback(ctx, publish_published_resources);
+    oc_remove_delayed_callback(ctx, cloud_rd_publish_changes_async);
+    // all links are published again after reconnect
+    move_all_to_publish_resources(ctx);
     return;
   }
   if ((ctx->store.status & OC_CLOUD_REFRESHED_TOKEN) != 0) {
     // when refresh occurs we don't want to publish resources.
     return;
   }
-  if (ctx->rd_publish_resources != NULL) {
-    cloud_publish_resources(ctx);
-  }
-  if (ctx->rd_delete_resources != NULL) {
-    cloud_delete_resources(ctx);
-  }
+  oc_remove_delayed_callback(ctx, cloud_rd_publish_changes_async);
+  cloud_rd_publish_changes_async(ctx);
 
   oc_remove_delayed_callback(ctx, publish_published_resources);
   if (ctx->time_to_live != RD_PUBLISH_TTL_UNLIMITED) {
@@ -313,8 +409,10 @@ void
 cloud_rd_deinit(oc_cloud_context_t *ctx)
 {
   oc_remove_delayed_callback(ctx, publish_published_resources);
+  oc_remove_delayed_callback(ctx, cloud_rd_publish_changes_async);
 
   rd_link_free(&ctx->rd_delete_resources);
+  rd_link_free(&ctx->rd_publishing_resources);
   rd_link_free(&ctx->rd_published_resources);
   rd_link_free(&ctx->rd_publish_resources);
 }
@@ -323,9 +421,10 @@ void
 cloud_rd_reset_context(oc_cloud_context_t *ctx)
 {
   oc_remove_delayed_callback(ctx, publish_published_resources);
+  oc_remove_delayed_callback(ctx, cloud_rd_publish_changes_async);
 
   rd_link_free(&ctx->rd_delete_resources);
-  move_published_to_publish_resources(ctx);
+  move_all_to_publish_resources(ctx);
 }
 
 void
@@ -344,6 +443,11 @@ oc_cloud_delete_resource(oc_resource_t *res)
 
   oc_link_t *published =
     rd_link_remove_by_resource(&ctx->rd_published_resources, res);
+  if (published == NULL) {
+    // the link of the request in flight is unpublished by the instance id sent
+    // in the request
+    published = rd_link_remove_by_resource(&ctx->rd_publishing_resources, res);
+  }
 
 #ifdef OC_SECURITY
   const oc_sec_pstat_t *pstat = oc_sec_get_pstat(res->device);
@@ -362,7 +466,7 @@ oc_cloud_delete_resource(oc_resource_t *res)
       published->resource = NULL;
     }
     rd_link_add(&ctx->rd_delete_resources, published);
-    cloud_delete_resources(ctx);
+    cloud_rd_schedule_changes(ctx);
   }
 }
 
@@ -26,12 +26,23 @@
 extern "C" {
 #endif
 
+#ifndef OC_CLOUD_RD_BATCH_DELAY_MS
+/**
+ * @brief Time in milliseconds during which added and deleted resource links are
+ * collected before they are published or unpublished together.
+ */
+#define OC_CLOUD_RD_BATCH_DELAY_MS (100)
+#endif /* !OC_CLOUD_RD_BATCH_DELAY_MS */
+
 /**
  * @brief Update resource links after manager status change.
  *
  * If cloud is in logged in state the function executes several resource links
- * updates: deletes links scheduled to be deleted, publishes links scheduled
- * to be published and republishes links that were already published.
+ * updates: deletes links scheduled to be deleted and publishes links scheduled
+ * to be published. Links are published by requests limited by the payload size,
+ * the next request is sent when the response to the previous one is received.
+ * When the cloud is not logged in, the published links are scheduled to be
+ * published again, so all links are republished after a reconnect.
  * Additionally, if Time to Live property is not equal to
  * RD_PUBLISH_TTL_UNLIMITED then published links are scheduled to be republished
  * each hour. (If cloud_rd_manager_status_changed function is triggered again
@@ -45,9 +56,10 @@ void cloud_rd_manager_status_changed(oc_cloud_context_t *ctx) OC_NONNULL();
 /**
  * @brief Deallocate all resource directory context member variables.
  *
- * Deallocate the list of to be published resources, the list of published
- * resources and the list of to be deleted resources. Remove delayed callback
- * that republishes resources (if it's active).
+ * Deallocate the list of to be published resources, the list of resources of
+ * the publish request in flight, the list of published resources and the list
+ * of to be deleted resources. Remove delayed callbacks that publish resources
+ * (if they are active).
  *
  * @param ctx Cloud context, must not be NULL
  */
@@ -56,8 +68,9 @@ void cloud_rd_deinit(oc_cloud_context_t *ctx) OC_NONNULL();
 /**
  * @brief Reset resource directory context member variables.
  *
- * Items in the list of published resources are moved to the list of to be
- * published resources. The list of to be deleted resources is cleared.
+ * Items in the lists of published resources and of resources of the publish
+ * request in flight are moved to the list of to be published resources. The
+ * list of to be deleted resources is cleared.
  *
  * @param ctx Cloud context, must not be NULL
  */
@@ -25,6 +25,7 @@
 #include "api/oc_core_res_internal.h"
 #include "api/oc_helpers_internal.h"
 #include "api/oc_link_internal.h"
+#include "api/oc_ri_internal.h"
 #include "messaging/coap/coap_internal.h"
 #include "messaging/coap/options_internal.h"
 #include "oc_api.h"
@@ -118,39 +119,204 @@ rd_publish_with_device_id(const oc_link_t *links, const oc_endpoint_t *endpoint,
   return oc_do_post();
 }
 
-bool
-rd_publish(const oc_link_t *links, const oc_endpoint_t *endpoint, size_t device,
-           uint32_t ttl, oc_response_handler_t handler, oc_qos_t qos,
-           void *user_data)
+typedef struct
+{
+  char buffer[OC_UUID_LEN];
+  oc_string_view_t id;
+  oc_string_view_t name;
+} rd_device_id_t;
+
+static bool
+rd_get_device_id(size_t device, rd_device_id_t *did)
 {
   const oc_device_info_t *device_info = oc_core_get_device_info(device);
   if (device_info == NULL) {
     OC_CLOUD_ERR("device(%zu) info not found", device);
     return false;
   }
-  char uuid_buf[OC_UUID_LEN] = { 0 };
-  int uuid_len =
-    oc_uuid_to_str_v1(&device_info->di, uuid_buf, OC_ARRAY_SIZE(uuid_buf));
+  int uuid_len = oc_uuid_to_str_v1(&device_info->di, did->buffer,
+                                   OC_ARRAY_SIZE(did->buffer));
   assert(uuid_len > 0);
-  oc_string_view_t uuid = oc_string_view(uuid_buf, (size_t)uuid_len);
-  oc_string_view_t name = oc_string_view2(&device_info->name);
+  did->id = oc_string_view(did->buffer, (size_t)uuid_len);
+  did->name = oc_string_view2(&device_info->name);
+  return true;
+}
+
+bool
+rd_publish(const oc_link_t *links, const oc_endpoint_t *endpoint, size_t device,
+           uint32_t ttl, oc_response_handler_t handler, oc_qos_t qos,
+           void *user_data)
+{
+  rd_device_id_t did;
+  if (!rd_get_device_id(device, &did)) {
+    return false;
+  }
 
   if (links != NULL) {
-    return rd_publish_with_device_id(links, endpoint, uuid, name, ttl, handler,
-                                     qos, user_data);
+    return rd_publish_with_device_id(links, endpoint, did.id, did.name, ttl,
+                                     handler, qos, user_data);
   }
 
   oc_link_t *link_p = oc_new_link(oc_core_get_resource_by_index(OCF_P, device));
   oc_link_t *link_d = oc_new_link(oc_core_get_resource_by_index(OCF_D, device));
   oc_list_add((oc_list_t)link_p, link_d);
 
-  bool status = rd_publish_with_device_id(link_p, endpoint, uuid, name, ttl,
-                                          handler, qos, user_data);
+  bool status = rd_publish_with_device_id(link_p, endpoint, did.id, did.name,
+                                          ttl, handler, qos, user_data);
   oc_delete_link(link_p);
   oc_delete_link(link_d);
   return status;
 }
 
+size_t
+rd_publish_max_payload_size(void)
+{
+#ifdef OC_BLOCK_WISE
+  return (size_t)OC_MAX_APP_DATA_SIZE;
+#else  /* !OC_BLOCK_WISE */
+  return (size_t)OC_BLOCK_SIZE;
+#endif /* OC_BLOCK_WISE */
+}
+
+/* Size of the head of a CBOR data item with the given argument */
+static size_t
+rd_cbor_head_size(uint64_t value)
+{
+  if (value < 24) {
+    return 1;
+  }
+  if (value <= UINT8_MAX) {
+    return 2;
+  }
+  if (value <= UINT16_MAX) {
+    return 3;
+  }
+  if (value <= UINT32_MAX) {
+    return 5;
+  }
+  return 9;
+}
+
+static size_t
+rd_cbor_text_size(size_t length)
+{
+  return rd_cbor_head_size(length) + length;
+}
+
+/* Upper bound of the size of the head and the break of a map or an array, for
+ * both definite and indefinite length containers */
+static size_t
+rd_cbor_container_size(size_t count)
+{
+  return rd_cbor_head_size(count) + 1;
+}
+
+/* Upper bound of the size of the encoded int64 value */
+#define RD_CBOR_INT_MAX_SIZE (9)
+
+#define RD_CBOR_KEY_SIZE(key) rd_cbor_text_size(OC_CHAR_ARRAY_LEN(key))
+
+static size_t
+rd_publish_header_size(oc_string_view_t id, oc_string_view_t name)
+{
+  // {di, n, ttl, links: [...]}
+  return rd_cbor_container_size(4) + RD_CBOR_KEY_SIZE("di") +
+         rd_cbor_text_size(id.length) + RD_CBOR_KEY_SIZE("n") +
+         rd_cbor_text_size(name.length) + RD_CBOR_KEY_SIZE("ttl") +
+         RD_CBOR_INT_MAX_SIZE + RD_CBOR_KEY_SIZE("links") +
+         /* indefinite length array */ rd_cbor_container_size(0);
+}
+
+static size_t
+rd_interfaces_size(unsigned iface_mask)
+{
+  // each interface is counted as the longest one
+  size_t count = 0;
+  for (; iface_mask != 0; iface_mask &= iface_mask - 1) {
+    ++count;
+  }
+  return rd_cbor_container_size(count) +
+         count * rd_cbor_text_size(OC_CHAR_ARRAY_LEN(OC_IF_STARTUP_REVERT_STR));
+}
+
+static size_t
+rd_link_size(const oc_resource_t *resource, size_t rel_len)
+{
+  // {href, rt: [...], if: [...], rel, ins, p: {bm}}
+  size_t size = rd_cbor_container_size(6) + RD_CBOR_KEY_SIZE("href") +
+                rd_cbor_text_size(oc_string_len(resource->uri));
+  size_t rt_count = oc_string_array_get_allocated_size(resource->types);
+  size += RD_CBOR_KEY_SIZE("rt") + rd_cbor_container_size(rt_count);
+  for (size_t i = 0; i < rt_count; ++i) {
+    size +=
+      rd_cbor_text_size(oc_string_array_get_item_size(resource->types, i));
+  }
+  size += RD_CBOR_KEY_SIZE("if") + rd_interfaces_size(resource->interfaces);
+  size += RD_CBOR_KEY_SIZE("rel") + rd_cbor_text_size(rel_len);
+  size += RD_CBOR_KEY_SIZE("ins") + RD_CBOR_INT_MAX_SIZE;
+  size += RD_CBOR_KEY_SIZE("p") + rd_cbor_container_size(1) +
+          RD_CBOR_KEY_SIZE("bm") + RD_CBOR_INT_MAX_SIZE;
+  return size;
+}
+
+size_t
+rd_publish_links_fit(const oc_link_t *links, oc_string_view_t id,
+                     oc_string_view_t name, size_t max_payload_size)
+{
+  size_t size = rd_publish_header_size(id, name);
+  size_t count = 0;
+  for (const oc_link_t *link = links; link != NULL; link = link->next) {
+    const char *rel = oc_string_array_get_item(link->rel, 0);
+    size_t rel_len = oc_strnlen(rel, STRING_ARRAY_ITEM_MAX_LEN);
+    // unterminated rel is skipped by the encoder
+    if (rel_len < STRING_ARRAY_ITEM_MAX_LEN) {
+      size += rd_link_size(link->resource, rel_len);
+    }
+    if (size > max_payload_size) {
+      break;
+    }
+    ++count;
+  }
+  return count;
+}
+
+bool
+rd_publish_partial(oc_link_t *links, const oc_endpoint_t *endpoint,
+                   size_t device, uint32_t ttl, size_t max_payload_size,
+                   oc_response_handler_t handler, oc_qos_t qos, void *user_data,
+                   rd_publish_partition_t *partition)
+{
+  assert(links != NULL);
+  assert(partition != NULL);
+
+  rd_device_id_t did;
+  if (!rd_get_device_id(device, &did)) {
+    return false;
+  }
+  size_t count =
+    rd_publish_links_fit(links, did.id, did.name, max_payload_size);
+  if (count == 0) {
+    OC_CLOUD_WRN("link(%s) exceeds the publish payload limit(%zu)",
+                 oc_string(links->resource->uri), max_payload_size);
+    count = 1;
+  }
+  oc_link_t *last = links;
+  for (size_t i = 1; i < count; ++i) {
+    last = last->next;
+  }
+  oc_link_t *not_published = last->next;
+  last->next = NULL;
+  OC_CLOUD_DBG("publishing %zu resource links", count);
+  if (!rd_publish_with_device_id(links, endpoint, did.id, did.name, ttl,
+                                 handler, qos, user_data)) {
+    last->next = not_published;
+    return false;
+  }
+  partition->published = links;
+  partition->not_published = not_published;
+  return true;
+}
+
 static bool
 rd_prepare_write_buffer(oc_write_buffer_t *wb, char *buffer, size_t buffer_size,
                         oc_string_view_t id)
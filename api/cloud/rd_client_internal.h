@@ -66,6 +66,67 @@ bool rd_publish(const oc_link_t *links, const oc_endpoint_t *endpoint,
                 size_t device, uint32_t ttl, oc_response_handler_t handler,
                 oc_qos_t qos, void *user_data) OC_NONNULL(2, 5);
 
+/**
+ * @brief Maximal size of the payload of a single publish request.
+ *
+ * Publish requests are not split by block-wise transfer, so the payload is
+ * limited by the application data buffer (or by the block size if block-wise
+ * transfer is disabled).
+ */
+size_t rd_publish_max_payload_size(void);
+
+/**
+ * @brief Count the leading resource links that fit into a publish request.
+ *
+ * The encoded size of the payload is estimated from above, so the counted links
+ * always fit.
+ *
+ * @param links List of resource links.
+ * @param id The id of the device.
+ * @param name The name of the device.
+ * @param max_payload_size Maximal size of the encoded payload.
+ *
+ * @return Number of links that fit into the payload, 0 if the list is empty or
+ * the first link does not fit.
+ */
+size_t rd_publish_links_fit(const oc_link_t *links, oc_string_view_t id,
+                            oc_string_view_t name, size_t max_payload_size);
+
+typedef struct
+{
+  oc_link_t *published;     /// Linked list of sent resource links.
+  oc_link_t *not_published; /// Linked list of resource links that did not fit
+                            /// into the request.
+} rd_publish_partition_t;
+
+/**
+  @brief Publish the leading resource links that fit into a single request.
+
+  The input list is split into the sent links and the links that did not fit
+  into the payload. A link that does not fit into an empty payload is sent
+  alone, so the caller always makes progress.
+
+  @param links List of resource links to publish (cannot be NULL).
+  @param endpoint The endpoint of the RD (cannot be NULL).
+  @param device Index of the device for an unique identifier.
+  @param ttl Time in seconds to indicate a RD, i.e. how long to keep this
+    published item.
+  @param max_payload_size Maximal size of the encoded payload.
+  @param handler To refer to the request sent out on behalf of calling this API
+  (cannot be NULL).
+  @param qos Quality of service.
+  @param user_data The user data passed from the registration function.
+  @param partition The partition of links into sent and not sent links (valid
+  only if the function returns true, cannot be NULL).
+
+  @return Returns true if success.
+*/
+bool rd_publish_partial(oc_link_t *links, const oc_endpoint_t *endpoint,
+                        size_t device, uint32_t ttl, size_t max_payload_size,
+                        oc_response_handler_t handler, oc_qos_t qos,
+                        void *user_data, rd_publish_partition_t *partition)
+  OC_NONNULL(1, 2, 6, 9);
+
 typedef struct
 {
   oc_link_t *deleted;     /// Linked list of deleted resource links.
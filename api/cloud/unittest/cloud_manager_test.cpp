@@ -29,13 +29,16 @@
 #include "oc_api.h"
 #include "oc_rep.h"
 #include "oc_cloud.h"
+#include "port/oc_dns_internal.h"
 #include "port/oc_log_internal.h"
 #include "tests/gtest/Device.h"
 #include "tests/gtest/RepPool.h"
+#include "util/oc_features.h"
 
 #include "gtest/gtest.h"
 
 #include <array>
+#include <atomic>
 #include <optional>
 #include <string>
 #include <vector>
@@ -485,6 +488,165 @@ TEST_F(TestCloudManager, cloud_manager_select_next_server_on_custom_retry)
   ASSERT_EQ(0, oc_cloud_manager_stop(&m_context));
 }
 
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+
+class TestCloudManagerResolve : public TestCloudManager {
+public:
+  void SetUp() override
+  {
+    TestCloudManager::SetUp();
+    steps = 0;
+    resolved.store(0);
+    fail = false;
+    oc_dns_set_resolver(Resolve);
+#ifdef OC_DNS_CACHE
+    oc_dns_clear_cache();
+#endif /* OC_DNS_CACHE */
+    oc_endpoint_addresses_clear(&m_context.store.ci_servers);
+    oc_uuid_t sid;
+    oc_gen_uuid(&sid);
+    ASSERT_NE(nullptr,
+              oc_endpoint_addresses_add(
+                &m_context.store.ci_servers,
+                oc_endpoint_address_make_view_with_uuid(kDomainServer, sid)));
+    ASSERT_TRUE(oc_endpoint_addresses_select_by_uri(&m_context.store.ci_servers,
+                                                    kDomainServer));
+  }
+
+  void TearDown() override
+  {
+    oc_cloud_resolve_endpoint_cancel(&m_context);
+#ifdef OC_DNS_CACHE
+    oc_dns_clear_cache();
+#endif /* OC_DNS_CACHE */
+    oc_dns_set_resolver(nullptr);
+    TestCloudManager::TearDown();
+  }
+
+  static int Resolve(const char *, transport_flags flags,
+                     oc_endpoint_t *endpoint)
+  {
+    ++resolved;
+    if (fail) {
+      return -1;
+    }
+    if ((flags & IPV6) != 0) {
+      endpoint->addr.ipv6.address[15] = 1;
+    }
+#ifdef OC_IPV4
+    else {
+      endpoint->addr.ipv4.address[0] = 127;
+      endpoint->addr.ipv4.address[3] = 1;
+    }
+#endif /* OC_IPV4 */
+    return 0;
+  }
+
+  static oc_event_callback_retval_t Step(void *)
+  {
+    ++steps;
+    oc::TestDevice::Terminate();
+    return OC_EVENT_DONE;
+  }
+
+  static constexpr auto kDomainServer =
+    OC_STRING_VIEW("coap://cloud.plgd.test:5683");
+  static int steps;
+  static std::atomic<int> resolved;
+  static bool fail;
+};
+
+int TestCloudManagerResolve::steps{ 0 };
+std::atomic<int> TestCloudManagerResolve::resolved{ 0 };
+bool TestCloudManagerResolve::fail{ false };
+
+TEST_F(TestCloudManagerResolve, ResolveEndpointAsync)
+{
+  ASSERT_EQ(1, oc_cloud_resolve_endpoint_async(&m_context, Step));
+  // the endpoint is not set until the lookup finishes
+  EXPECT_TRUE(oc_endpoint_is_empty(m_context.cloud_ep));
+  EXPECT_EQ(0, steps);
+  // a step invoked while the lookup is running waits for the same lookup
+  ASSERT_EQ(1, oc_cloud_resolve_endpoint_async(&m_context, Step));
+
+  oc::TestDevice::PoolEventsMsV1(1s);
+  // the step is rescheduled once
+  EXPECT_EQ(1, steps);
+  ASSERT_FALSE(oc_endpoint_is_empty(m_context.cloud_ep));
+  EXPECT_EQ(m_context.device, m_context.cloud_ep->device);
+  EXPECT_EQ(0, oc_cloud_resolve_endpoint_async(&m_context, Step));
+  // the endpoint resolved by the manager step is used by the access functions
+  EXPECT_TRUE(oc_cloud_set_endpoint(&m_context));
+}
+
+TEST_F(TestCloudManagerResolve, ResolveEndpointAsyncFail)
+{
+  fail = true;
+  ASSERT_EQ(1, oc_cloud_resolve_endpoint_async(&m_context, Step));
+  oc::TestDevice::PoolEventsMsV1(1s);
+  EXPECT_EQ(1, steps);
+  EXPECT_TRUE(oc_endpoint_is_empty(m_context.cloud_ep));
+  // the rescheduled step gets the failure
+  EXPECT_EQ(-1, oc_cloud_resolve_endpoint_async(&m_context, Step));
+  // and the retry starts a new lookup
+  EXPECT_EQ(1, oc_cloud_resolve_endpoint_async(&m_context, Step));
+}
+
+TEST_F(TestCloudManagerResolve, ResolveEndpointAsyncAddressLiteral)
+{
+  oc_endpoint_addresses_clear(&m_context.store.ci_servers);
+  oc_uuid_t sid;
+  oc_gen_uuid(&sid);
+  ASSERT_NE(nullptr,
+            oc_endpoint_addresses_add(
+              &m_context.store.ci_servers,
+              oc_endpoint_address_make_view_with_uuid(kTestServer, sid)));
+  ASSERT_TRUE(oc_endpoint_addresses_select_by_uri(&m_context.store.ci_servers,
+                                                  kTestServer));
+  EXPECT_EQ(0, oc_cloud_resolve_endpoint_async(&m_context, Step));
+  EXPECT_FALSE(oc_endpoint_is_empty(m_context.cloud_ep));
+  EXPECT_EQ(0, steps);
+}
+
+TEST_F(TestCloudManagerResolve, StopCancelsResolution)
+{
+  ASSERT_EQ(1, oc_cloud_resolve_endpoint_async(&m_context, Step));
+  cloud_manager_stop(&m_context);
+  EXPECT_FALSE(oc_endpoint_resolve_is_pending(&m_context.cloud_ep_resolve));
+  oc::TestDevice::PoolEventsMsV1(50ms);
+  EXPECT_EQ(0, steps);
+  EXPECT_TRUE(oc_endpoint_is_empty(m_context.cloud_ep));
+}
+
+TEST_F(TestCloudManagerResolve, RegisterWithDomain)
+{
+  oc_cloud_set_schedule_action(
+    &m_context,
+    [](oc_cloud_action_t, uint8_t retry_count, uint64_t *delay,
+       uint16_t *timeout, void *data) -> bool {
+      auto *ctx = static_cast<oc_cloud_context_t *>(data);
+      if (retry_count == 0) {
+        *delay = 0;
+        *timeout = kTimeout.count();
+        return true;
+      }
+      schedule_stop_cloud_manager(ctx);
+      return false;
+    },
+    &m_context);
+
+  m_context.store.status = OC_CLOUD_INITIALIZED;
+  m_context.store.cps = OC_CPS_READYTOREGISTER;
+  cloud_manager_start(&m_context);
+  oc::TestDevice::PoolEventsMsV1(200ms);
+  cloud_manager_stop(&m_context);
+  // the register step resolved the domain by the asynchronous lookup
+  EXPECT_LT(0, resolved.load());
+  EXPECT_FALSE(oc_endpoint_resolve_is_pending(&m_context.cloud_ep_resolve));
+}
+
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
+
 #endif /* !OC_SECURITY */
 
 class TestCloudManagerData : public testing::Test {
@@ -18,6 +18,7 @@
 
 #include "api/cloud/oc_cloud_context_internal.h"
 #include "api/cloud/oc_cloud_internal.h"
+#include "api/cloud/oc_cloud_rd_internal.h"
 #include "api/oc_link_internal.h"
 #include "oc_api.h"
 #include "oc_collection.h"
@@ -36,6 +37,15 @@ public:
 
   void TearDown() override { oc::TestDevice::Reset(); }
 
+  static size_t countLinks(const oc_link_t *head)
+  {
+    size_t count = 0;
+    for (; head != nullptr; head = head->next) {
+      ++count;
+    }
+    return count;
+  }
+
   static oc_resource_t *findResource(oc_link_t *head, const oc_resource_t *res)
   {
     for (oc_link_t *l = head; l; l = l->next) {
@@ -92,3 +102,70 @@ TEST_F(TestCloudRD, cloud_delete)
   // Clean-up
   EXPECT_TRUE(oc_delete_resource(res1));
 }
+
+TEST_F(TestCloudRD, cloud_publish_batch)
+{
+  oc_cloud_context_t *ctx = oc_cloud_get_context(kDeviceID);
+  ASSERT_NE(nullptr, ctx);
+  size_t count = countLinks(ctx->rd_publish_resources);
+
+  // When
+  oc_resource_t *res1 = oc_new_resource(nullptr, "/light/1", 1, kDeviceID);
+  oc_resource_bind_resource_type(res1, "test");
+  ASSERT_EQ(0, oc_cloud_add_resource(res1));
+  oc_resource_t *res2 = oc_new_resource(nullptr, "/light/2", 1, kDeviceID);
+  oc_resource_bind_resource_type(res2, "test");
+  ASSERT_EQ(0, oc_cloud_add_resource(res2));
+  // already scheduled
+  ASSERT_EQ(0, oc_cloud_add_resource(res1));
+
+  // Then
+  // links are collected until the batch is sent
+  EXPECT_EQ(count + 2, countLinks(ctx->rd_publish_resources));
+  EXPECT_EQ(nullptr, ctx->rd_publishing_resources);
+  EXPECT_EQ(res1, findResource(ctx->rd_publish_resources, res1));
+  EXPECT_EQ(res2, findResource(ctx->rd_publish_resources, res2));
+
+  // Clean-up
+  oc_cloud_delete_resource(res2);
+  oc_cloud_delete_resource(res1);
+  EXPECT_EQ(count, countLinks(ctx->rd_publish_resources));
+  EXPECT_TRUE(oc_delete_resource(res2));
+  EXPECT_TRUE(oc_delete_resource(res1));
+}
+
+TEST_F(TestCloudRD, cloud_republish_after_reconnect)
+{
+  oc_cloud_context_t *ctx = oc_cloud_get_context(kDeviceID);
+  ASSERT_NE(nullptr, ctx);
+  ASSERT_EQ(0, ctx->store.status & OC_CLOUD_LOGGED_IN);
+
+  oc_resource_t *res1 = oc_new_resource(nullptr, "/light/1", 1, kDeviceID);
+  oc_resource_bind_resource_type(res1, "test");
+  oc_resource_t *res2 = oc_new_resource(nullptr, "/light/2", 1, kDeviceID);
+  oc_resource_bind_resource_type(res2, "test");
+  oc_link_t *published = oc_new_link(res1);
+  ASSERT_NE(nullptr, published);
+  oc_link_t *publishing = oc_new_link(res2);
+  ASSERT_NE(nullptr, publishing);
+  ctx->rd_published_resources = published;
+  ctx->rd_publishing_resources = publishing;
+
+  // When
+  cloud_rd_manager_status_changed(ctx);
+
+  // Then
+  // published links and links of the request in flight are published again
+  EXPECT_EQ(nullptr, ctx->rd_published_resources);
+  EXPECT_EQ(nullptr, ctx->rd_publishing_resources);
+  EXPECT_EQ(res1, findResource(ctx->rd_publish_resources, res1));
+  EXPECT_EQ(res2, findResource(ctx->rd_publish_resources, res2));
+
+  // Clean-up
+  oc_cloud_delete_resource(res2);
+  oc_cloud_delete_resource(res1);
+  EXPECT_EQ(nullptr, findResource(ctx->rd_publish_resources, res1));
+  EXPECT_EQ(nullptr, findResource(ctx->rd_publish_resources, res2));
+  EXPECT_TRUE(oc_delete_resource(res2));
+  EXPECT_TRUE(oc_delete_resource(res1));
+}
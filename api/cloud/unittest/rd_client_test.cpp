@@ -37,7 +37,9 @@
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
@@ -309,6 +311,7 @@ countTotalLinks()
     [](oc_cloud_context_t *ctx, void *user_data) {
       auto *count = static_cast<size_t *>(user_data);
       *count += countLinks(ctx->rd_publish_resources);
+      *count += countLinks(ctx->rd_publishing_resources);
       *count += countLinks(ctx->rd_published_resources);
       *count += countLinks(ctx->rd_delete_resources);
     },
@@ -362,6 +365,120 @@ TEST_F(TestRDClient, Delete_ManyLinks)
   EXPECT_EQ(nullptr, to_delete);
 }
 
+// number of links that can be allocated by a test, at most wanted
+static size_t
+availableLinks(size_t wanted)
+{
+#ifdef OC_DYNAMIC_ALLOCATION
+  return wanted;
+#else  // !OC_DYNAMIC_ALLOCATION
+  auto kMaxLinks = static_cast<size_t>(OC_MAX_APP_RESOURCES);
+  size_t total = countTotalLinks();
+  return total >= kMaxLinks ? 0 : std::min(wanted, kMaxLinks - total);
+#endif // OC_DYNAMIC_ALLOCATION
+}
+
+TEST_F(TestRDClient, PublishLinksFit)
+{
+  oc_string_view_t id{ OC_STRING_VIEW("id") };
+  oc_string_view_t name{ OC_STRING_VIEW("name") };
+  EXPECT_EQ(0, rd_publish_links_fit(nullptr, id, name, /*max*/ 1024));
+
+  std::vector<oc_link_t *> links(availableLinks(8));
+  if (links.size() < 2) {
+    OC_DBG("Skipping test, not enough links available");
+    return;
+  }
+  for (size_t i = 0; i < links.size(); ++i) {
+    links[i] = oc_new_link(
+      oc_core_get_resource_by_index(i % 2 == 0 ? OCF_P : OCF_D, kDeviceID));
+    if (i > 0) {
+      links[i - 1]->next = links[i];
+    }
+  }
+
+  // not even the first link fits
+  EXPECT_EQ(0, rd_publish_links_fit(links[0], id, name, /*max*/ 1));
+  EXPECT_EQ(links.size(),
+            rd_publish_links_fit(links[0], id, name, /*max*/ SIZE_MAX));
+
+  // the counted links are encoded within the limit
+  for (size_t limit : { 128, 256, 512 }) {
+    size_t count = rd_publish_links_fit(links[0], id, name, limit);
+    if (count == 0) {
+      continue;
+    }
+    oc::RepPool pool{};
+    oc_link_t *rest = links[count - 1]->next;
+    links[count - 1]->next = nullptr;
+    EXPECT_TRUE(rd_publish_encode(links[0], id, name, /*ttl*/ UINT32_MAX));
+    links[count - 1]->next = rest;
+    EXPECT_GE(limit, static_cast<size_t>(oc_rep_get_encoded_payload_size()));
+  }
+
+  for (auto *link : links) {
+    oc_delete_link(link);
+  }
+}
+
+TEST_F(TestRDClient, PublishPartial_FailBadInput)
+{
+  oc_resource_t *p = oc_core_get_resource_by_index(OCF_P, kDeviceID);
+  oc_link_t *link_p = oc_new_link(p);
+  rd_publish_partition_t partition{};
+  // invalid device
+  EXPECT_FALSE(rd_publish_partial(link_p, &s_endpoint, /*device*/ 42,
+                                  /*ttl*/ 0, rd_publish_max_payload_size(),
+                                  onPostResponse, LOW_QOS,
+                                  /*user_data*/ nullptr, &partition));
+  EXPECT_EQ(nullptr, partition.published);
+  EXPECT_EQ(nullptr, link_p->next);
+  oc_delete_link(link_p);
+}
+
+TEST_F(TestRDClient, PublishPartial_ManyLinks)
+{
+  size_t kMaxLinks = availableLinks(16);
+  if (kMaxLinks < 2) {
+    OC_DBG("Skipping test, not enough links available");
+    return;
+  }
+  oc_resource_t *p = oc_core_get_resource_by_index(OCF_P, kDeviceID);
+  OC_LIST_LOCAL(links);
+  for (size_t i = 0; i < kMaxLinks; ++i) {
+    oc_link_t *link_p = oc_new_link(p);
+    oc_list_add(links, link_p);
+  }
+
+  auto *to_publish = static_cast<oc_link_t *>(oc_list_head(links));
+  size_t published = 0;
+  size_t requests = 0;
+  while (to_publish != nullptr) {
+    rd_publish_partition_t partition{};
+    // payload limit smaller than the encoded list forces multiple requests
+    ASSERT_TRUE(rd_publish_partial(to_publish, &s_endpoint, kDeviceID,
+                                   /*ttl*/ 0, /*max_payload_size*/ 256,
+                                   onPostResponse, LOW_QOS,
+                                   /*user_data*/ nullptr, &partition));
+    ASSERT_NE(nullptr, partition.published);
+    for (oc_link_t *link = partition.published; link != nullptr;) {
+      auto next = link->next;
+      oc_delete_link(link);
+      link = next;
+      ++published;
+    }
+    to_publish = partition.not_published;
+    ++requests;
+
+    // we drop the messages because otherwise they would get deallocated on
+    // timeout
+    oc::TestDevice::DropOutgoingMessages();
+  }
+
+  EXPECT_EQ(kMaxLinks, published);
+  EXPECT_LT(1, requests);
+}
+
 TEST_F(TestRDClient, DeleteIterateLinks_FailBufferTooSmall)
 {
   oc_resource_t *p = oc_core_get_resource_by_index(OCF_P, kDeviceID);
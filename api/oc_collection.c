@@ -20,6 +20,7 @@
 
 #if defined(OC_COLLECTIONS) && defined(OC_SERVER)
 #include "api/oc_collection_internal.h"
+#include "api/oc_discovery_cache_internal.h"
 #include "api/oc_endpoint_internal.h"
 #include "api/oc_helpers_internal.h"
 #include "api/oc_link_internal.h"
@@ -115,18 +116,57 @@ collection_free_resource_types(oc_list_t list)
   }
 }
 
+static void
+collection_link_index(oc_collection_t *collection, oc_link_t *link)
+{
+  link->collection = collection;
+  link->next_resource_link = link->resource->collection_links;
+  link->resource->collection_links = link;
+}
+
+static void
+collection_link_unindex(oc_link_t *link)
+{
+  oc_link_t **it = &link->resource->collection_links;
+  while (*it != NULL) {
+    if (*it == link) {
+      *it = link->next_resource_link;
+      break;
+    }
+    it = &(*it)->next_resource_link;
+  }
+  link->collection = NULL;
+  link->next_resource_link = NULL;
+}
+
 static void
 collection_free(oc_collection_t *collection, bool notify)
 {
   bool removed = oc_list_remove2(g_collections, collection) != NULL;
 
+  // a deleted resource is removed from all collections, so every linked
+  // resource is still allocated
   oc_link_t *link;
   while ((link = (oc_link_t *)oc_list_pop(collection->links)) != NULL) {
+    collection_link_unindex(link);
     oc_delete_link(link);
   }
 
-  if (notify && removed) {
-    oc_notify_resource_removed(&collection->res);
+  // remove the collection from the collections containing it
+  while ((link = collection->res.collection_links) != NULL) {
+    if (!oc_collection_remove_link_and_notify(
+          &link->collection->res, link, notify,
+          /*discoveryBatchDispatch*/ false)) {
+      collection_link_unindex(link);
+    }
+    oc_delete_link(link);
+  }
+
+  if (removed) {
+    oc_discovery_cache_invalidate();
+    if (notify) {
+      oc_notify_resource_removed(&collection->res);
+    }
   }
 
   oc_remove_delayed_callback(collection, collection_notify_batch_async);
@@ -212,6 +252,7 @@ oc_collection_add_link(oc_resource_t *collection, oc_link_t *link)
     next = next->next;
   }
   oc_list_insert(col->links, prev, link);
+  collection_link_index(col, link);
   if (link->resource == collection) {
     oc_string_array_add_item(link->rel, "self");
   }
@@ -230,6 +271,7 @@ oc_collection_remove_link_and_notify(oc_resource_t *collection,
   if (oc_list_remove2(col->links, link) == NULL) {
     return false;
   }
+  collection_link_unindex((oc_link_t *)link);
   if (notify) {
     oc_collection_notify_resource_changed(col, discoveryBatchDispatch);
   }
@@ -334,22 +376,56 @@ oc_collection_add(oc_collection_t *collection)
     return false;
   }
   oc_list_add(g_collections, collection);
+  oc_discovery_cache_invalidate();
   return true;
 }
 
 static bool
 collection_is_known_rt(oc_list_t list, oc_string_view_t rtv)
 {
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+  // all types in the list are interned, so a string without an atom is not
+  // one of them
+  oc_atom_t atom = oc_atom_find(rtv.data, rtv.length);
+  if (atom == OC_ATOM_NONE) {
+    return false;
+  }
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
   const oc_rt_t *rtt = (oc_rt_t *)oc_list_head(list);
   while (rtt != NULL) {
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+    if (rtt->atom == atom) {
+      return true;
+    }
+#else  /* !OC_HAS_FEATURE_ATOM_TABLE */
     if (oc_string_view_is_equal(rtv, oc_string_view2(&rtt->rt))) {
       return true;
     }
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
     rtt = rtt->next;
   }
   return false;
 }
 
+static bool
+collection_add_rt(oc_list_t list, oc_string_view_t rtv)
+{
+  oc_rt_t *rtt = (oc_rt_t *)oc_memb_alloc(&g_rtt_s);
+  if (rtt == NULL) {
+    return false;
+  }
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+  rtt->atom = oc_atom_intern(rtv.data, rtv.length);
+  if (rtt->atom == OC_ATOM_NONE) {
+    oc_memb_free(&g_rtt_s, rtt);
+    return false;
+  }
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
+  oc_new_string(&rtt->rt, rtv.data, rtv.length);
+  oc_list_add(list, rtt);
+  return true;
+}
+
 #ifdef OC_COLLECTIONS_IF_CREATE
 
 static oc_rt_factory_t *
@@ -570,13 +646,10 @@ oc_collection_add_supported_rt(oc_resource_t *collection, const char *rt)
   oc_collection_t *col = (oc_collection_t *)collection;
   oc_string_view_t rtv = oc_string_view(rt, strlen(rt));
   if (!collection_is_known_rt(col->supported_rts, rtv)) {
-    oc_rt_t *rtt = (oc_rt_t *)oc_memb_alloc(&g_rtt_s);
-    if (rtt == NULL) {
+    if (!collection_add_rt(col->supported_rts, rtv)) {
       OC_ERR("insufficient memory to add supported rt");
       return false;
     }
-    oc_new_string(&rtt->rt, rtv.data, rtv.length);
-    oc_list_add(col->supported_rts, rtt);
     return true;
   }
   return false;
@@ -588,44 +661,23 @@ oc_collection_add_mandatory_rt(oc_resource_t *collection, const char *rt)
   oc_collection_t *col = (oc_collection_t *)collection;
   oc_string_view_t rtv = oc_string_view(rt, strlen(rt));
   if (!collection_is_known_rt(col->mandatory_rts, rtv)) {
-    oc_rt_t *rtt = (oc_rt_t *)oc_memb_alloc(&g_rtt_s);
-    if (rtt == NULL) {
+    if (!collection_add_rt(col->mandatory_rts, rtv)) {
       OC_ERR("insufficient memory to add mandatory rt");
       return false;
     }
-    oc_new_string(&rtt->rt, rtv.data, rtv.length);
-    oc_list_add(col->mandatory_rts, rtt);
     return true;
   }
   return false;
 }
 
-oc_collection_t *
-oc_get_next_collection_with_link(const oc_resource_t *resource,
-                                 oc_collection_t *start)
+oc_link_t *
+oc_get_next_collection_link(const oc_resource_t *resource,
+                            const oc_link_t *start)
 {
-  oc_collection_t *collection = start;
-
-  if (!collection) {
-    collection = oc_collection_get_all();
-  } else {
-    collection = (oc_collection_t *)collection->res.next;
-  }
-
-  while (collection != NULL) {
-    if (collection->res.device == resource->device) {
-      const oc_link_t *link = (oc_link_t *)oc_list_head(collection->links);
-      while (link != NULL) {
-        if (link->resource == resource) {
-          return collection;
-        }
-        link = link->next;
-      }
-    }
-    collection = (oc_collection_t *)collection->res.next;
+  if (start == NULL) {
+    return resource->collection_links;
   }
-
-  return collection;
+  return start->next_resource_link;
 }
 
 typedef struct oc_handle_collection_request_result_t
@@ -27,6 +27,7 @@
 #include "oc_collection.h"
 #include "oc_helpers.h"
 #include "oc_ri.h"
+#include "util/oc_atom_internal.h"
 #include "util/oc_compiler.h"
 #include "util/oc_features.h"
 #include "util/oc_list.h"
@@ -42,6 +43,9 @@ typedef struct oc_rt_t
 {
   struct oc_rt_t *next;
   oc_string_t rt;
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+  oc_atom_t atom; ///< interned rt
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
 } oc_rt_t;
 
 enum {
@@ -79,11 +83,20 @@ oc_collection_t *oc_collection_get_all(void);
 /** @brief Free all collections from the global list */
 void oc_collections_free_all(void);
 
-/** @brief Iterate the global list of colletions and return the next collection
- * linked with the given resource */
-oc_collection_t *oc_get_next_collection_with_link(const oc_resource_t *resource,
-                                                  oc_collection_t *start)
-  OC_NONNULL(1);
+/**
+ * @brief Iterate the links of collections containing the given resource.
+ *
+ * The links are found through the reverse index kept by the resource, so the
+ * iteration does not depend on the total number of collections and links.
+ *
+ * @param resource the linked resource (cannot be NULL)
+ * @param start the previous link (NULL to get the first link)
+ * @return oc_link_t* the next link, the collection containing the link is
+ * available in oc_link_t::collection
+ * @return NULL if there are no more links
+ */
+oc_link_t *oc_get_next_collection_link(const oc_resource_t *resource,
+                                       const oc_link_t *start) OC_NONNULL(1);
 
 /** @brief Process CoAP request on a collection. */
 OC_NO_DISCARD_RETURN
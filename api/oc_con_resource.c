@@ -18,11 +18,13 @@
 
 #include "api/oc_con_resource_internal.h"
 #include "api/oc_core_res_internal.h"
+#include "api/oc_discovery_cache_internal.h"
 #include "api/oc_rep_internal.h"
 #include "api/oc_server_api_internal.h"
 #include "oc_api.h"
 #include "oc_core_res.h"
 #include "oc_rep.h"
+#include "util/oc_features.h"
 #include "util/oc_macros_internal.h"
 #include "util/oc_secure_string_internal.h"
 
@@ -40,6 +42,9 @@ oc_get_con_res_announced(void)
 void
 oc_set_con_res_announced(bool announce)
 {
+  if (g_announce_con_res != announce) {
+    oc_discovery_cache_invalidate();
+  }
   g_announce_con_res = announce;
 }
 
@@ -17,6 +17,7 @@
  ****************************************************************************/
 
 #include "api/oc_con_resource_internal.h"
+#include "api/oc_discovery_cache_internal.h"
 #include "api/oc_platform_internal.h"
 #include "messaging/coap/oc_coap.h"
 #include "oc_api.h"
@@ -86,6 +87,7 @@ static oc_device_info_t g_oc_device_info[OC_MAX_NUM_DEVICES] = { 0 };
 
 static int g_res_latency = 0;
 static OC_ATOMIC_UINT32_T g_device_count = 0;
+static size_t g_shared_ports_devices = 0;
 
 bool
 oc_is_device_resource_uri(oc_string_view_t uri)
@@ -140,6 +142,7 @@ oc_core_shutdown(void)
     g_oc_device_info = NULL;
   }
 #endif /* OC_DYNAMIC_ALLOCATION */
+  g_shared_ports_devices = 0;
 
 #ifdef OC_DYNAMIC_ALLOCATION
   if (g_core_resources != NULL) {
@@ -309,6 +312,12 @@ core_update_device_data(uint32_t device_count, oc_add_new_device_t cfg)
                 strlen(cfg.data_model_version));
   g_oc_device_info[device_count].add_device_cb = cfg.add_device_cb;
   g_oc_device_info[device_count].data = cfg.add_device_cb_data;
+  g_oc_device_info[device_count].shared_ports =
+    device_count > 0 &&
+    (cfg.ports.udp.flags & OC_CONNECTIVITY_SHARE_PORTS) != 0;
+  if (g_oc_device_info[device_count].shared_ports) {
+    ++g_shared_ports_devices;
+  }
 }
 
 static void
@@ -358,6 +367,14 @@ oc_core_add_new_device(oc_add_new_device_t cfg)
       OC_ERR("limit of value type of g_device_count reached");
       return NULL;
     }
+#ifdef OC_SECURITY
+    // secured sessions on the shared ports are not dispatched by device
+    if (device_count > 0 &&
+        (cfg.ports.udp.flags & OC_CONNECTIVITY_SHARE_PORTS) != 0) {
+      OC_ERR("sharing the ports of device 0 is not supported by secure builds");
+      return NULL;
+    }
+#endif /* OC_SECURITY */
     OC_ATOMIC_COMPARE_AND_SWAP32(g_device_count, device_count, device_count + 1,
                                  exchanged);
   }
@@ -440,6 +457,10 @@ oc_device_bind_rt(size_t device_index, const char *rt)
                              oc_string_array_get_item(types, (i - 1)));
   }
   oc_free_string_array(&types);
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+  oc_resource_intern_types(r);
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
+  oc_discovery_cache_invalidate();
 }
 
 void
@@ -543,6 +564,9 @@ oc_core_populate_resource(int core_resource, size_t device_index,
     oc_string_array_add_item(r->types, va_arg(rt_list, const char *));
   }
   va_end(rt_list);
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+  oc_resource_intern_types(r);
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
   r->interfaces = iface_mask;
   r->default_interface = default_interface;
   r->get_handler.cb = get;
@@ -552,6 +576,7 @@ oc_core_populate_resource(int core_resource, size_t device_index,
 #ifdef OC_HAS_FEATURE_ETAG
   r->etag = oc_etag_get();
 #endif /* OC_HAS_FEATURE_ETAG */
+  oc_discovery_cache_invalidate();
 }
 
 oc_uuid_t *
@@ -572,6 +597,58 @@ oc_core_get_device_info(size_t device)
   return &g_oc_device_info[device];
 }
 
+static bool
+core_device_is_reachable_on_ports_of_device0(size_t device)
+{
+  return device == 0 || g_oc_device_info[device].shared_ports;
+}
+
+size_t
+oc_core_select_device_on_shared_ports(size_t device, const char *uri,
+                                      size_t uri_len, const char *query,
+                                      size_t query_len)
+{
+  if (device != 0 || g_shared_ports_devices == 0) {
+    return device;
+  }
+
+  // device selected explicitly by the di query parameter
+  const char *di = NULL;
+  int di_len = -1;
+  if (query != NULL && query_len > 0) {
+    di_len = oc_ri_get_query_value_v1(query, query_len, "di",
+                                      OC_CHAR_ARRAY_LEN("di"), &di);
+  }
+  if (di_len > 0) {
+    oc_uuid_t uuid;
+    size_t index;
+    if (oc_str_to_uuid_v1(di, (size_t)di_len, &uuid) == OC_UUID_ID_SIZE &&
+        oc_core_get_device_index(uuid, &index) &&
+        core_device_is_reachable_on_ports_of_device0(index)) {
+      return index;
+    }
+    return device;
+  }
+
+#ifdef OC_SERVER
+  // device hosting the application resource
+  if (uri != NULL && uri_len > 0 &&
+      oc_ri_get_app_resource_by_uri(uri, uri_len, device) == NULL) {
+    uint32_t device_count = OC_ATOMIC_LOAD32(g_device_count);
+    for (size_t i = 1; i < device_count; ++i) {
+      if (g_oc_device_info[i].shared_ports &&
+          oc_ri_get_app_resource_by_uri(uri, uri_len, i) != NULL) {
+        return i;
+      }
+    }
+  }
+#else  /* !OC_SERVER */
+  (void)uri;
+  (void)uri_len;
+#endif /* OC_SERVER */
+  return device;
+}
+
 #ifdef OC_SECURITY
 bool
 oc_core_is_SVR(const oc_resource_t *resource, size_t device)
@@ -823,14 +900,8 @@ oc_filter_resource_by_rt(const oc_resource_t *resource,
       continue;
     }
     match = false;
-    for (size_t i = 0; i < oc_string_array_get_allocated_size(resource->types);
-         ++i) {
-      size_t size = oc_string_array_get_item_size(resource->types, i);
-      const char *t =
-        (const char *)oc_string_array_get_item(resource->types, i);
-      if ((size_t)rt_len == size && strncmp(rt, t, rt_len) == 0) {
-        return true;
-      }
+    if (oc_resource_has_type(resource, oc_string_view(rt, (size_t)rt_len))) {
+      return true;
     }
   } while (more_query_params);
   return match;
@@ -141,6 +141,26 @@ void oc_core_device_set_name(size_t device, const char *name, size_t name_len)
 /** @brief Check if the value is a valid device index */
 bool oc_core_device_is_valid(size_t device);
 
+/**
+ * @brief Select the device that should handle a request received on the ports
+ * of device 0, which are shared by all devices added with the
+ * OC_CONNECTIVITY_SHARE_PORTS flag.
+ *
+ * The device is selected by the "di" query parameter or by the URI of an
+ * application resource hosted by the device. Requests for resources hosted by
+ * device 0 and requests that cannot be matched are handled by device 0.
+ *
+ * @param device index of the device that received the request
+ * @param uri URI of the requested resource
+ * @param uri_len length of the URI
+ * @param query query of the request
+ * @param query_len length of the query
+ * @return index of the device that should handle the request
+ */
+size_t oc_core_select_device_on_shared_ports(size_t device, const char *uri,
+                                             size_t uri_len, const char *query,
+                                             size_t query_len);
+
 #ifdef __cplusplus
 }
 #endif
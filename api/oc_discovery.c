@@ -60,6 +60,11 @@
 #include "api/oc_etag_internal.h"
 #endif /* OC_HAS_FEATURE_ETAG */
 
+#ifdef OC_HAS_FEATURE_DISCOVERY_CACHE
+#include "api/oc_discovery_cache_internal.h"
+#include "api/oc_rep_encode_internal.h"
+#endif /* OC_HAS_FEATURE_DISCOVERY_CACHE */
+
 #ifdef _WIN32
 #include <windows.h>
 #else /* !_WIN32 */
@@ -263,11 +268,10 @@ encode_resource(CborEncoder *links, const oc_resource_t *resource,
   return true;
 }
 
-static int
-encode_device_core_resources(CborEncoder *links, const oc_request_t *request,
-                             oc_string_view_t anchor, bool include_endpoints)
+static bool
+discovery_iterate_core_resources(size_t device, oc_resource_iterate_fn_t fn,
+                                 void *data)
 {
-  int matches = 0;
   oc_core_resource_t platformRes[] = {
     OCF_P,
 #ifdef OC_HAS_FEATURE_PLGD_TIME
@@ -275,18 +279,17 @@ encode_device_core_resources(CborEncoder *links, const oc_request_t *request,
 #endif /* OC_HAS_FEATURE_PLGD_TIME */
   };
   for (size_t i = 0; i < OC_ARRAY_SIZE(platformRes); i++) {
-    if (encode_resource(links, oc_core_get_resource_by_index(platformRes[i], 0),
-                        request, anchor, include_endpoints)) {
-      matches++;
+    oc_resource_t *resource = oc_core_get_resource_by_index(platformRes[i], 0);
+    if (resource != NULL && !fn(resource, data)) {
+      return false;
     }
   }
 
-  size_t device_index = request->resource->device;
-  if (oc_get_con_res_announced() &&
-      encode_resource(links,
-                      oc_core_get_resource_by_index(OCF_CON, device_index),
-                      request, anchor, include_endpoints)) {
-    matches++;
+  if (oc_get_con_res_announced()) {
+    oc_resource_t *resource = oc_core_get_resource_by_index(OCF_CON, device);
+    if (resource != NULL && !fn(resource, data)) {
+      return false;
+    }
   }
 
   oc_core_resource_t res[] = {
@@ -319,15 +322,100 @@ encode_device_core_resources(CborEncoder *links, const oc_request_t *request,
 #endif /* OC_CLIENT && OC_SERVER && OC_CLOUD */
   };
   for (size_t i = 0; i < OC_ARRAY_SIZE(res); i++) {
-    if (encode_resource(links,
-                        oc_core_get_resource_by_index(res[i], device_index),
-                        request, anchor, include_endpoints)) {
-      matches++;
+    oc_resource_t *resource = oc_core_get_resource_by_index(res[i], device);
+    if (resource != NULL && !fn(resource, data)) {
+      return false;
     }
   }
-  return matches;
+  return true;
+}
+
+/* Iterate over the resources of the device in the order in which they are
+ * encoded in the /oic/res response */
+static void
+discovery_iterate_device_resources(size_t device, oc_resource_iterate_fn_t fn,
+                                   void *data)
+{
+  if (!discovery_iterate_core_resources(device, fn, data)) {
+    return;
+  }
+#ifdef OC_SERVER
+  for (oc_resource_t *resource = oc_ri_get_app_resources(); resource != NULL;
+       resource = resource->next) {
+    if (resource->device != device ||
+        (resource->properties & OC_DISCOVERABLE) == 0) {
+      continue;
+    }
+    if (!fn(resource, data)) {
+      return;
+    }
+  }
+
+#ifdef OC_COLLECTIONS
+  for (oc_resource_t *collection = (oc_resource_t *)oc_collection_get_all();
+       collection != NULL; collection = collection->next) {
+    if (collection->device != device ||
+        (collection->properties & OC_DISCOVERABLE) == 0) {
+      continue;
+    }
+    if (!fn(collection, data)) {
+      return;
+    }
+  }
+#endif /* OC_COLLECTIONS */
+#endif /* OC_SERVER */
+}
+
+typedef struct
+{
+  CborEncoder *links;
+  const oc_request_t *request;
+  oc_string_view_t anchor;
+  bool include_endpoints;
+  int matches;
+} discovery_encode_link_data_t;
+
+static bool
+discovery_encode_link(oc_resource_t *resource, void *data)
+{
+  discovery_encode_link_data_t *eld = (discovery_encode_link_data_t *)data;
+  if (encode_resource(eld->links, resource, eld->request, eld->anchor,
+                      eld->include_endpoints)) {
+    eld->matches++;
+  }
+  return true;
+}
+
+#ifdef OC_HAS_FEATURE_DISCOVERY_CACHE
+
+/* Get the resource type if the request is filtered by exactly one resource
+ * type */
+static bool
+discovery_request_get_single_rt(const oc_request_t *request, const char **rt,
+                                size_t *rt_len)
+{
+  size_t count = 0;
+  bool more_query_params = false;
+  oc_init_query_iterator();
+  do {
+    const char *value = NULL;
+    int value_len = -1;
+    more_query_params = oc_iterate_query_get_values_v1(
+      request, "rt", OC_CHAR_ARRAY_LEN("rt"), &value, &value_len);
+    if (value_len <= 0) {
+      continue;
+    }
+    if (++count > 1) {
+      return false;
+    }
+    *rt = value;
+    *rt_len = (size_t)value_len;
+  } while (more_query_params);
+  return count == 1;
 }
 
+#endif /* OC_HAS_FEATURE_DISCOVERY_CACHE */
+
 static int
 encode_device_resources(CborEncoder *links, const oc_request_t *request,
                         bool include_endpoints)
@@ -341,40 +429,70 @@ encode_device_resources(CborEncoder *links, const oc_request_t *request,
                  anchor + OC_CHAR_ARRAY_LEN(OC_SCHEME_OCF), OC_UUID_LEN);
   size_t anchor_len = oc_strnlen(anchor, OC_ARRAY_SIZE(anchor));
 
-  int matches = encode_device_core_resources(
-    links, request, oc_string_view(anchor, anchor_len), include_endpoints);
-#ifdef OC_SERVER
-  oc_resource_t *resource = oc_ri_get_app_resources();
-  for (; resource; resource = resource->next) {
-    if (resource->device != device_index ||
-        (resource->properties & OC_DISCOVERABLE) == 0)
-      continue;
+  discovery_encode_link_data_t eld = {
+    .links = links,
+    .request = request,
+    .anchor = oc_string_view(anchor, anchor_len),
+    .include_endpoints = include_endpoints,
+    .matches = 0,
+  };
+#ifdef OC_HAS_FEATURE_DISCOVERY_CACHE
+  // encode only the resources with the requested type
+  const char *rt = NULL;
+  size_t rt_len = 0;
+  if (discovery_request_get_single_rt(request, &rt, &rt_len) &&
+      oc_discovery_rt_index_iterate(device_index, rt, rt_len,
+                                    discovery_iterate_device_resources,
+                                    discovery_encode_link, &eld)) {
+    return eld.matches;
+  }
+#endif /* OC_HAS_FEATURE_DISCOVERY_CACHE */
+  discovery_iterate_device_resources(device_index, discovery_encode_link, &eld);
+  return eld.matches;
+}
 
-    if (encode_resource(links, resource, request,
-                        oc_string_view(anchor, anchor_len),
-                        include_endpoints)) {
-      matches++;
-    }
-  }
+#ifdef OC_HAS_FEATURE_DISCOVERY_CACHE
 
-#ifdef OC_COLLECTIONS
-  const oc_resource_t *collection = (oc_resource_t *)oc_collection_get_all();
-  for (; collection; collection = collection->next) {
-    if (collection->device != device_index ||
-        !(collection->properties & OC_DISCOVERABLE))
-      continue;
+/* Encode the links of the device or copy them from the cache */
+static int
+discovery_encode_links_cached(CborEncoder *links, const oc_request_t *request,
+                              bool include_endpoints)
+{
+  oc_discovery_cache_key_t key;
+  if (!oc_discovery_cache_key_init(&key, request, include_endpoints)) {
+    return encode_device_resources(links, request, include_endpoints);
+  }
+  oc_rep_encoder_t *encoder = oc_rep_global_encoder();
+  oc_discovery_cache_links_t cached;
+  if (oc_discovery_cache_get(&key, &cached)) {
+    g_err |= oc_rep_encoder_write_raw_to_container(encoder, links, cached.data,
+                                                   cached.size);
+    return cached.matches;
+  }
 
-    if (encode_resource(links, collection, request,
-                        oc_string_view(anchor, anchor_len),
-                        include_endpoints)) {
-      matches++;
-    }
+  long start = oc_rep_encoder_container_offset(encoder, links);
+  int matches = encode_device_resources(links, request, include_endpoints);
+  long end = oc_rep_encoder_container_offset(encoder, links);
+  if (g_err == CborNoError && start >= 0 && end >= start) {
+    oc_discovery_cache_put(&key, oc_rep_get_encoder_buf() + start,
+                           (size_t)(end - start), matches);
   }
-#endif /* OC_COLLECTIONS */
-#endif /* OC_SERVER */
   return matches;
 }
 
+#endif /* OC_HAS_FEATURE_DISCOVERY_CACHE */
+
+static int
+discovery_encode_links(CborEncoder *links, const oc_request_t *request,
+                       bool include_endpoints)
+{
+#ifdef OC_HAS_FEATURE_DISCOVERY_CACHE
+  return discovery_encode_links_cached(links, request, include_endpoints);
+#else  /* !OC_HAS_FEATURE_DISCOVERY_CACHE */
+  return encode_device_resources(links, request, include_endpoints);
+#endif /* OC_HAS_FEATURE_DISCOVERY_CACHE */
+}
+
 static void
 send_response(oc_request_t *request, oc_content_format_t content_format,
               bool is_empty, oc_status_t code, size_t response_length)
@@ -1109,7 +1227,7 @@ discovery_encode(const oc_request_t *request, oc_interface_mask_t iface)
   switch (iface) {
   case OC_IF_LL: {
     oc_rep_start_links_array();
-    int matches = encode_device_resources(oc_rep_array(links), request, true);
+    int matches = discovery_encode_links(oc_rep_array(links), request, true);
     oc_rep_end_links_array();
     return matches > 0 ? OC_STATUS_OK : OC_IGNORE;
   }
@@ -1141,8 +1259,8 @@ discovery_encode(const oc_request_t *request, oc_interface_mask_t iface)
     discovery_encode_sdi(oc_rep_object(props), device);
 #endif
     oc_rep_open_array(props, links);
-    matches = encode_device_resources(oc_rep_array(links), request,
-                                      iface == OC_IF_BASELINE);
+    matches = discovery_encode_links(oc_rep_array(links), request,
+                                     iface == OC_IF_BASELINE);
     oc_rep_close_array(props, links);
     oc_rep_end_object(oc_rep_array(root), props);
     oc_rep_end_array(oc_rep_get_encoder(), root);
@@ -1515,9 +1633,6 @@ oc_discovery_process_payload(const uint8_t *payload, size_t len,
 done:
   oc_free_rep(result.rep);
   oc_rep_set_pool(prev_rep_objects);
-#ifdef OC_DNS_CACHE
-  oc_dns_clear_cache();
-#endif /* OC_DNS_CACHE */
   return ret;
 }
 #endif /* OC_CLIENT */
@@ -0,0 +1,448 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "util/oc_features.h"
+
+#ifdef OC_HAS_FEATURE_DISCOVERY_CACHE
+
+#include "api/oc_discovery_cache_internal.h"
+#include "oc_api.h"
+#include "oc_core_res.h"
+#include "oc_rep.h"
+#include "port/oc_connectivity.h"
+#include "port/oc_log_internal.h"
+#include "util/oc_atom_internal.h"
+#include "util/oc_list.h"
+#include "util/oc_macros_internal.h"
+
+#ifdef OC_SECURITY
+#include "security/oc_pstat_internal.h"
+#include "security/oc_tls_internal.h"
+#endif /* OC_SECURITY */
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct discovery_cache_entry_t
+{
+  struct discovery_cache_entry_t *next;
+  oc_discovery_cache_key_t key;
+  uint8_t *data;
+  size_t size;
+  int matches;
+} discovery_cache_entry_t;
+
+typedef struct
+{
+  oc_atom_t rt;
+  uint32_t seq; ///< position of the resource in the iteration
+  oc_resource_t *resource;
+} discovery_rt_index_item_t;
+
+/* Resources of a device sorted by resource type */
+typedef struct discovery_rt_index_t
+{
+  struct discovery_rt_index_t *next;
+  size_t device;
+  discovery_rt_index_item_t *items;
+  size_t count;
+  size_t capacity;
+} discovery_rt_index_t;
+
+OC_LIST(g_discovery_cache);
+OC_LIST(g_discovery_rt_index);
+static size_t g_discovery_cache_count = 0;
+// generation of the resources, the cached entries are dropped when it changes
+static uint32_t g_discovery_cache_generation = 0;
+static uint32_t g_discovery_cache_valid_generation = 0;
+
+static uint64_t
+discovery_cache_hash(uint64_t hash, const void *data, size_t size)
+{
+  // FNV-1a
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= UINT64_C(0x100000001b3);
+  }
+  return hash;
+}
+
+static uint64_t
+discovery_cache_hash_endpoints(size_t device)
+{
+  uint64_t hash = UINT64_C(0xcbf29ce484222325);
+  for (const oc_endpoint_t *ep = oc_connectivity_get_endpoints(device);
+       ep != NULL; ep = ep->next) {
+    hash = discovery_cache_hash(hash, &ep->flags, sizeof(ep->flags));
+    hash = discovery_cache_hash(hash, &ep->interface_index,
+                                sizeof(ep->interface_index));
+    hash = discovery_cache_hash(hash, &ep->addr, sizeof(ep->addr));
+  }
+  return hash;
+}
+
+static bool
+discovery_cache_request_has_rt_query(const oc_request_t *request)
+{
+  bool more_query_params = false;
+  oc_init_query_iterator();
+  do {
+    const char *rt = NULL;
+    int rt_len = -1;
+    more_query_params = oc_iterate_query_get_values_v1(
+      request, "rt", OC_CHAR_ARRAY_LEN("rt"), &rt, &rt_len);
+    if (rt_len > 0) {
+      return true;
+    }
+  } while (more_query_params);
+  return false;
+}
+
+bool
+oc_discovery_cache_key_init(oc_discovery_cache_key_t *key,
+                            const oc_request_t *request, bool include_endpoints)
+{
+  if (oc_rep_encoder_get_type() != OC_REP_CBOR_ENCODER ||
+      discovery_cache_request_has_rt_query(request)) {
+    return false;
+  }
+
+  // the key is compared by memcmp, so the padding must be zeroed
+  memset(key, 0, sizeof(*key));
+  size_t device = request->resource->device;
+  key->device = device;
+  const oc_uuid_t *di = oc_core_get_device_id(device);
+  if (di != NULL) {
+    key->di = *di;
+  }
+  key->include_endpoints = include_endpoints;
+  key->con_announced = oc_get_con_res_announced();
+  key->dos = -1;
+#ifdef OC_SECURITY
+  key->dos = (int)oc_sec_get_pstat(device)->s;
+  key->has_peers = oc_tls_num_peers(device) != 0;
+#endif /* OC_SECURITY */
+  if (include_endpoints) {
+    key->endpoints_hash = discovery_cache_hash_endpoints(device);
+    key->latency = oc_core_get_latency();
+    if (request->origin != NULL) {
+      key->interface_index = request->origin->interface_index;
+      key->family = request->origin->flags & (IPV4 | IPV6);
+    }
+  }
+  return true;
+}
+
+static void
+discovery_cache_entry_free(discovery_cache_entry_t *entry)
+{
+  free(entry->data);
+  free(entry);
+}
+
+static void
+discovery_rt_index_free(discovery_rt_index_t *index)
+{
+  free(index->items);
+  free(index);
+}
+
+void
+oc_discovery_cache_clear(void)
+{
+  discovery_rt_index_t *index =
+    (discovery_rt_index_t *)oc_list_pop(g_discovery_rt_index);
+  while (index != NULL) {
+    discovery_rt_index_free(index);
+    index = (discovery_rt_index_t *)oc_list_pop(g_discovery_rt_index);
+  }
+  discovery_cache_entry_t *entry =
+    (discovery_cache_entry_t *)oc_list_pop(g_discovery_cache);
+  while (entry != NULL) {
+    discovery_cache_entry_free(entry);
+    entry = (discovery_cache_entry_t *)oc_list_pop(g_discovery_cache);
+  }
+  g_discovery_cache_count = 0;
+  g_discovery_cache_valid_generation = g_discovery_cache_generation;
+}
+
+void
+oc_discovery_cache_invalidate(void)
+{
+  ++g_discovery_cache_generation;
+}
+
+static void
+discovery_cache_drop_invalid(void)
+{
+  if (g_discovery_cache_valid_generation != g_discovery_cache_generation) {
+    OC_DBG("oc_discovery_cache: resources changed, dropping cached links");
+    oc_discovery_cache_clear();
+  }
+}
+
+size_t
+oc_discovery_cache_size(void)
+{
+  discovery_cache_drop_invalid();
+  return g_discovery_cache_count;
+}
+
+bool
+oc_discovery_cache_get(const oc_discovery_cache_key_t *key,
+                       oc_discovery_cache_links_t *links)
+{
+  discovery_cache_drop_invalid();
+  for (discovery_cache_entry_t *entry =
+         (discovery_cache_entry_t *)oc_list_head(g_discovery_cache);
+       entry != NULL; entry = entry->next) {
+    if (memcmp(&entry->key, key, sizeof(*key)) != 0) {
+      continue;
+    }
+    // move to the front to keep the list ordered by last use
+    oc_list_remove(g_discovery_cache, entry);
+    oc_list_push(g_discovery_cache, entry);
+    links->data = entry->data;
+    links->size = entry->size;
+    links->matches = entry->matches;
+    return true;
+  }
+  return false;
+}
+
+bool
+oc_discovery_cache_put(const oc_discovery_cache_key_t *key,
+                       const uint8_t *data, size_t size, int matches)
+{
+  discovery_cache_drop_invalid();
+  discovery_cache_entry_t *entry =
+    (discovery_cache_entry_t *)calloc(1, sizeof(discovery_cache_entry_t));
+  if (entry == NULL) {
+    OC_ERR("oc_discovery_cache: insufficient memory to cache links");
+    return false;
+  }
+  if (size > 0) {
+    entry->data = (uint8_t *)malloc(size);
+    if (entry->data == NULL) {
+      OC_ERR("oc_discovery_cache: insufficient memory to cache links");
+      free(entry);
+      return false;
+    }
+    memcpy(entry->data, data, size);
+  }
+  memcpy(&entry->key, key, sizeof(*key));
+  entry->size = size;
+  entry->matches = matches;
+
+  if (g_discovery_cache_count >= OC_DISCOVERY_CACHE_MAX_ENTRIES) {
+    discovery_cache_entry_t *lru =
+      (discovery_cache_entry_t *)oc_list_chop(g_discovery_cache);
+    if (lru != NULL) {
+      discovery_cache_entry_free(lru);
+      --g_discovery_cache_count;
+    }
+  }
+  oc_list_push(g_discovery_cache, entry);
+  ++g_discovery_cache_count;
+  return true;
+}
+
+typedef struct
+{
+  discovery_rt_index_t *index;
+  uint32_t seq;
+  bool ok;
+} discovery_rt_index_build_t;
+
+static bool
+discovery_rt_index_add(discovery_rt_index_t *index, oc_atom_t rt, uint32_t seq,
+                       oc_resource_t *resource)
+{
+  if (index->count == index->capacity) {
+    size_t capacity = index->capacity > 0 ? 2 * index->capacity : 16;
+    discovery_rt_index_item_t *items = (discovery_rt_index_item_t *)realloc(
+      index->items, capacity * sizeof(discovery_rt_index_item_t));
+    if (items == NULL) {
+      return false;
+    }
+    index->items = items;
+    index->capacity = capacity;
+  }
+  discovery_rt_index_item_t *item = &index->items[index->count++];
+  item->rt = rt;
+  item->seq = seq;
+  item->resource = resource;
+  return true;
+}
+
+/* Check if the type was already added for the resource, the items of the
+ * resource start at the index first */
+static bool
+discovery_rt_index_has_type(const discovery_rt_index_t *index, size_t first,
+                            oc_atom_t rt)
+{
+  for (size_t i = first; i < index->count; ++i) {
+    if (index->items[i].rt == rt) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool
+discovery_rt_index_add_resource(oc_resource_t *resource, void *data)
+{
+  discovery_rt_index_build_t *build = (discovery_rt_index_build_t *)data;
+  uint32_t seq = build->seq++;
+  size_t first = build->index->count;
+  size_t num_types = oc_string_array_get_allocated_size(resource->types);
+  for (size_t i = 0; i < num_types; ++i) {
+    size_t size = oc_string_array_get_item_size(resource->types, i);
+    if (size == 0) {
+      continue;
+    }
+    oc_atom_t rt;
+    if (resource->types_atoms != NULL) {
+      rt = resource->types_atoms[i];
+    } else {
+      const char *t =
+        (const char *)oc_string_array_get_item(resource->types, i);
+      rt = oc_atom_intern(t, size);
+    }
+    if (rt == OC_ATOM_NONE) {
+      build->ok = false;
+      return false;
+    }
+    if (discovery_rt_index_has_type(build->index, first, rt)) {
+      continue;
+    }
+    if (!discovery_rt_index_add(build->index, rt, seq, resource)) {
+      build->ok = false;
+      return false;
+    }
+  }
+  return true;
+}
+
+static int
+discovery_rt_index_item_compare(const void *lhs, const void *rhs)
+{
+  const discovery_rt_index_item_t *l = (const discovery_rt_index_item_t *)lhs;
+  const discovery_rt_index_item_t *r = (const discovery_rt_index_item_t *)rhs;
+  if (l->rt != r->rt) {
+    return l->rt < r->rt ? -1 : 1;
+  }
+  if (l->seq != r->seq) {
+    return l->seq < r->seq ? -1 : 1;
+  }
+  return 0;
+}
+
+static discovery_rt_index_t *
+discovery_rt_index_build(size_t device,
+                         oc_discovery_resources_iterate_fn_t iterate_resources)
+{
+  discovery_rt_index_t *index =
+    (discovery_rt_index_t *)calloc(1, sizeof(discovery_rt_index_t));
+  if (index == NULL) {
+    OC_ERR("oc_discovery_cache: insufficient memory to index resources");
+    return NULL;
+  }
+  index->device = device;
+  discovery_rt_index_build_t build = {
+    .index = index,
+    .seq = 0,
+    .ok = true,
+  };
+  iterate_resources(device, discovery_rt_index_add_resource, &build);
+  if (!build.ok) {
+    OC_ERR("oc_discovery_cache: insufficient memory to index resources");
+    discovery_rt_index_free(index);
+    return NULL;
+  }
+  if (index->count > 1) {
+    qsort(index->items, index->count, sizeof(discovery_rt_index_item_t),
+          discovery_rt_index_item_compare);
+  }
+  return index;
+}
+
+static discovery_rt_index_t *
+discovery_rt_index_get(size_t device,
+                       oc_discovery_resources_iterate_fn_t iterate_resources)
+{
+  discovery_cache_drop_invalid();
+  for (discovery_rt_index_t *index =
+         (discovery_rt_index_t *)oc_list_head(g_discovery_rt_index);
+       index != NULL; index = index->next) {
+    if (index->device == device) {
+      return index;
+    }
+  }
+  discovery_rt_index_t *index =
+    discovery_rt_index_build(device, iterate_resources);
+  if (index != NULL) {
+    oc_list_add(g_discovery_rt_index, index);
+  }
+  return index;
+}
+
+/* Find the first item with given resource type */
+static size_t
+discovery_rt_index_lower_bound(const discovery_rt_index_t *index, oc_atom_t rt)
+{
+  size_t lo = 0;
+  size_t hi = index->count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (index->items[mid].rt < rt) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+bool
+oc_discovery_rt_index_iterate(
+  size_t device, const char *rt, size_t rt_len,
+  oc_discovery_resources_iterate_fn_t iterate_resources,
+  oc_resource_iterate_fn_t fn, void *data)
+{
+  const discovery_rt_index_t *index =
+    discovery_rt_index_get(device, iterate_resources);
+  if (index == NULL) {
+    return false;
+  }
+  // all indexed types are interned, so a type without an atom has no resources
+  oc_atom_t atom = oc_atom_find(rt, rt_len);
+  if (atom == OC_ATOM_NONE) {
+    return true;
+  }
+  for (size_t i = discovery_rt_index_lower_bound(index, atom);
+       i < index->count && index->items[i].rt == atom; ++i) {
+    if (!fn(index->items[i].resource, data)) {
+      break;
+    }
+  }
+  return true;
+}
+
+#endif /* OC_HAS_FEATURE_DISCOVERY_CACHE */
@@ -0,0 +1,165 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifndef OC_DISCOVERY_CACHE_INTERNAL_H
+#define OC_DISCOVERY_CACHE_INTERNAL_H
+
+#include "api/oc_resource_internal.h"
+#include "oc_endpoint.h"
+#include "oc_ri.h"
+#include "oc_uuid.h"
+#include "util/oc_compiler.h"
+#include "util/oc_features.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef OC_HAS_FEATURE_DISCOVERY_CACHE
+
+/* Maximal number of cached encodings of /oic/res links, the least recently
+ * used entry is evicted when the cache is full */
+#ifndef OC_DISCOVERY_CACHE_MAX_ENTRIES
+#define OC_DISCOVERY_CACHE_MAX_ENTRIES (8)
+#endif /* OC_DISCOVERY_CACHE_MAX_ENTRIES */
+
+/**
+ * @brief Inputs that determine the encoded links of a device.
+ *
+ * The state of the device and its endpoints is part of the key, changes of
+ * resources must be reported by oc_discovery_cache_invalidate.
+ */
+typedef struct oc_discovery_cache_key_t
+{
+  size_t device;            ///< device index
+  oc_uuid_t di;             ///< device id used in the anchor of the links
+  uint64_t endpoints_hash;  ///< hash of the endpoints of the device
+  unsigned interface_index; ///< interface index of the request origin
+  transport_flags family;   ///< IPV4 and IPV6 flags of the request origin
+  int latency;              ///< latency encoded in the endpoints
+  int dos;                  ///< device onboarding state (-1 without security)
+  bool has_peers;           ///< device has connected TLS peers
+  bool con_announced;       ///< /oc/con is included in the links
+  bool include_endpoints;   ///< links contain the endpoints
+} oc_discovery_cache_key_t;
+
+/** @brief Encoded links returned by the cache */
+typedef struct oc_discovery_cache_links_t
+{
+  const uint8_t *data; ///< encoded links
+  size_t size;         ///< size of the encoded links
+  int matches;         ///< number of links
+} oc_discovery_cache_links_t;
+
+/**
+ * @brief Fill the cache key for a discovery request.
+ *
+ * @param[out] key the key to fill (cannot be NULL)
+ * @param request the discovery request (cannot be NULL)
+ * @param include_endpoints the links contain the endpoints
+ * @return true if the response to the request can be cached
+ * @return false otherwise (e.g. request filtered by rt query or response
+ * encoded in other format than CBOR)
+ */
+bool oc_discovery_cache_key_init(oc_discovery_cache_key_t *key,
+                                 const oc_request_t *request,
+                                 bool include_endpoints) OC_NONNULL();
+
+/**
+ * @brief Find cached links.
+ *
+ * @param key the key (cannot be NULL)
+ * @param[out] links the cached links (cannot be NULL), the data is valid until
+ * the next modification of the cache
+ * @return true if the links were found
+ * @return false otherwise
+ */
+bool oc_discovery_cache_get(const oc_discovery_cache_key_t *key,
+                            oc_discovery_cache_links_t *links) OC_NONNULL();
+
+/**
+ * @brief Store encoded links to the cache.
+ *
+ * @param key the key (cannot be NULL)
+ * @param data the encoded links (cannot be NULL)
+ * @param size the size of the encoded links
+ * @param matches the number of links
+ * @return true on success
+ * @return false on allocation failure
+ */
+bool oc_discovery_cache_put(const oc_discovery_cache_key_t *key,
+                            const uint8_t *data, size_t size, int matches)
+  OC_NONNULL();
+
+/**
+ * @brief Callback used to iterate over the discoverable resources of a device
+ * in the order in which they are encoded in the /oic/res response.
+ */
+typedef void (*oc_discovery_resources_iterate_fn_t)(size_t device,
+                                                    oc_resource_iterate_fn_t fn,
+                                                    void *data);
+
+/**
+ * @brief Iterate over the resources of a device that have given resource type.
+ *
+ * The resource types of the resources are interned and indexed on first use,
+ * the index is dropped together with the cached links.
+ *
+ * @param device device index
+ * @param rt resource type (cannot be NULL)
+ * @param rt_len length of the resource type
+ * @param iterate_resources callback to iterate over the resources of the
+ * device, used to build the index (cannot be NULL)
+ * @param fn callback invoked for each resource with the resource type, in the
+ * order of \p iterate_resources (cannot be NULL)
+ * @param data custom user data passed to \p fn
+ * @return true if the resources were iterated by the index
+ * @return false if the index is not available (e.g. allocation failure), the
+ * caller should iterate over all resources
+ */
+bool oc_discovery_rt_index_iterate(
+  size_t device, const char *rt, size_t rt_len,
+  oc_discovery_resources_iterate_fn_t iterate_resources,
+  oc_resource_iterate_fn_t fn, void *data) OC_NONNULL(2, 4, 5);
+
+/** @brief Drop all cached links, must be called when a resource is added,
+ * removed or its discoverable properties change */
+void oc_discovery_cache_invalidate(void);
+
+/** @brief Get the number of valid entries in the cache */
+size_t oc_discovery_cache_size(void);
+
+/** @brief Deallocate all cached links and resource type indexes */
+void oc_discovery_cache_clear(void);
+
+#else /* !OC_HAS_FEATURE_DISCOVERY_CACHE */
+
+/* The cache is compiled out, there is nothing to invalidate */
+#define oc_discovery_cache_invalidate()
+
+#endif /* OC_HAS_FEATURE_DISCOVERY_CACHE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OC_DISCOVERY_CACHE_INTERNAL_H */
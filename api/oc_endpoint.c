@@ -22,6 +22,7 @@
 #include "oc_core_res.h"
 #include "port/oc_allocator_internal.h"
 #include "port/oc_connectivity.h"
+#include "port/oc_dns.h"
 #include "port/oc_ip_internal.h"
 #include "port/oc_log_internal.h"
 #include "util/oc_macros_internal.h"
@@ -497,7 +498,63 @@ parse_endpoint_uri(const oc_string_t *endpoint_str,
   return true;
 }
 
+static bool
+endpoint_host_is_domain(const char *address, size_t host_len)
+{
+  return ('A' <= address[host_len - 1] && 'Z' >= address[host_len - 1]) ||
+         ('a' <= address[host_len - 1] && 'z' >= address[host_len - 1]);
+}
+
+static int
+endpoint_from_address(const endpoint_uri_t *ep_uri, const char *address,
+                      size_t host_len, oc_endpoint_t *endpoint,
+                      oc_string_t *uri)
+{
+  if (host_len > 1 && address[0] == '[' && address[host_len - 1] == ']') {
+    if (!oc_parse_ipv6_address(&address[1], host_len - 2, endpoint)) {
+      OC_ERR("cannot resolve address(%s): cannot parse ipv6 address", address);
+      return -1;
+    }
+    endpoint->flags = ep_uri->scheme_flags | IPV6;
+    endpoint->addr.ipv6.port = ep_uri->port;
+  }
+#ifdef OC_IPV4
+  else {
+    endpoint->flags = ep_uri->scheme_flags | IPV4;
+    endpoint->addr.ipv4.port = ep_uri->port;
+    oc_parse_ipv4_address(address, host_len, endpoint);
+  }
+#else  /* OC_IPV4 */
+  else {
+    return -1;
+  }
+#endif /* !OC_IPV4 */
+
+  /* Extract a uri path if requested and available */
+  if (uri != NULL && ep_uri->uri != NULL) {
+    oc_new_string(uri, ep_uri->uri, ep_uri->uri_len);
+  }
+  return 0;
+}
+
 #if defined(OC_DNS_LOOKUP) && (defined(OC_DNS_LOOKUP_IPV6) || defined(OC_IPV4))
+// https://www.rfc-editor.org/rfc/rfc1035.html#section-2.3.4
+#define ENDPOINT_MAX_HOST_LEN (254)
+
+static bool
+endpoint_uri_domain(const endpoint_uri_t *ep_uri, char *domain,
+                    size_t domain_size)
+{
+  if (ep_uri->host_len >= domain_size) {
+    OC_ERR("invalid domain length(%zu) of address(%s)", ep_uri->host_len,
+           ep_uri->address);
+    return false;
+  }
+  memcpy(domain, ep_uri->address, ep_uri->host_len);
+  domain[ep_uri->host_len] = '\0';
+  return true;
+}
+
 static bool
 dns_lookup(const char *domain, oc_string_t *addr, transport_flags flags)
 {
@@ -525,72 +582,30 @@ oc_parse_endpoint_string(const oc_string_t *endpoint_str,
     return -1;
   }
 
-  const char *address = ep_uri.address;
-  size_t host_len = ep_uri.host_len;
-#ifdef OC_DNS_LOOKUP
-  oc_string_t ipaddress;
-  memset(&ipaddress, 0, sizeof(oc_string_t));
-#endif /* OC_DNS_LOOKUP */
-  if (('A' <= address[host_len - 1] && 'Z' >= address[host_len - 1]) ||
-      ('a' <= address[host_len - 1] && 'z' >= address[host_len - 1])) {
+  if (!endpoint_host_is_domain(ep_uri.address, ep_uri.host_len)) {
+    return endpoint_from_address(&ep_uri, ep_uri.address, ep_uri.host_len,
+                                 endpoint, uri);
+  }
 #if defined(OC_DNS_LOOKUP) && (defined(OC_DNS_LOOKUP_IPV6) || defined(OC_IPV4))
-#define MAX_HOST_LEN 254
-    if (host_len > MAX_HOST_LEN) {
-      // https://www.rfc-editor.org/rfc/rfc1035.html#section-2.3.4
-      OC_ERR("invalid domain length(%zu) of address(%s)", host_len, address);
-      return -1;
-    }
-    char domain[MAX_HOST_LEN + 1];
-    memcpy(domain, address, host_len);
-    domain[host_len] = '\0';
-    if (!dns_lookup(domain, &ipaddress, ep_uri.scheme_flags)) {
-      OC_ERR("failed to resolve domain(%s)", domain);
-      return -1;
-    }
-
-    address = oc_string(ipaddress);
-    host_len = oc_string_len(ipaddress);
-#else  /* !OC_DNS_LOOKUP || (!OC_DNS_LOOKUP_IPV6 && !OC_IPV4) */
-    OC_ERR("cannot resolve address(%s): dns resolution disabled", address);
+  char domain[ENDPOINT_MAX_HOST_LEN + 1];
+  if (!endpoint_uri_domain(&ep_uri, domain, sizeof(domain))) {
     return -1;
-#endif /* OC_DNS_LOOKUP && (OC_DNS_LOOKUP_IPV6 || OC_IPV4) */
-  }
-
-  if (host_len > 1 && address[0] == '[' && address[host_len - 1] == ']') {
-    if (!oc_parse_ipv6_address(&address[1], host_len - 2, endpoint)) {
-      OC_ERR("cannot resolve address(%s): cannot parse ipv6 address", address);
-#ifdef OC_DNS_LOOKUP
-      oc_free_string(&ipaddress);
-#endif /* OC_DNS_LOOKUP */
-      return -1;
-    }
-    endpoint->flags = ep_uri.scheme_flags | IPV6;
-    endpoint->addr.ipv6.port = ep_uri.port;
   }
-#ifdef OC_IPV4
-  else {
-    endpoint->flags = ep_uri.scheme_flags | IPV4;
-    endpoint->addr.ipv4.port = ep_uri.port;
-    oc_parse_ipv4_address(address, host_len, endpoint);
-  }
-#else /* OC_IPV4 */
-  else {
-#ifdef OC_DNS_LOOKUP
-    oc_free_string(&ipaddress);
-#endif /* OC_DNS_LOOKUP */
+  oc_string_t ipaddress;
+  memset(&ipaddress, 0, sizeof(oc_string_t));
+  if (!dns_lookup(domain, &ipaddress, ep_uri.scheme_flags)) {
+    OC_ERR("failed to resolve domain(%s)", domain);
     return -1;
   }
-#endif /* !OC_IPV4 */
-#ifdef OC_DNS_LOOKUP
+  int ret = endpoint_from_address(&ep_uri, oc_string(ipaddress),
+                                  oc_string_len(ipaddress), endpoint, uri);
   oc_free_string(&ipaddress);
-#endif /* OC_DNS_LOOKUP */
-
-  /* Extract a uri path if requested and available */
-  if (uri != NULL && ep_uri.uri != NULL) {
-    oc_new_string(uri, ep_uri.uri, ep_uri.uri_len);
-  }
-
-  return 0;
+  return ret;
+#else  /* !OC_DNS_LOOKUP || (!OC_DNS_LOOKUP_IPV6 && !OC_IPV4) */
+  OC_ERR("cannot resolve address(%s): dns resolution disabled",
+         ep_uri.address);
+  return -1;
+#endif /* OC_DNS_LOOKUP && (OC_DNS_LOOKUP_IPV6 || OC_IPV4) */
 }
 
 int
@@ -604,6 +619,132 @@ oc_string_to_endpoint(const oc_string_t *endpoint_str, oc_endpoint_t *endpoint,
   return oc_parse_endpoint_string(endpoint_str, endpoint, uri);
 }
 
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+
+static void
+endpoint_resolve_finish(oc_endpoint_resolve_t *resolve, int status,
+                        const oc_endpoint_t *endpoint)
+{
+  oc_endpoint_resolve_handler_t handler = resolve->handler;
+  void *user_data = resolve->user_data;
+  // release the request before invoking the handler, so that the handler can
+  // start a new resolution with the same request
+  oc_free_string(&resolve->endpoint_str);
+  resolve->handler = NULL;
+  resolve->user_data = NULL;
+  handler(status, endpoint, user_data);
+}
+
+static void
+endpoint_dns_lookup_handler(const char *domain, int status,
+                            const oc_string_t *addr, void *user_data)
+{
+#if !OC_ERR_IS_ENABLED && !defined(OC_DNS_LOOKUP_IPV6)
+  (void)domain;
+#endif /* !OC_ERR_IS_ENABLED && !OC_DNS_LOOKUP_IPV6 */
+  oc_endpoint_resolve_t *resolve = (oc_endpoint_resolve_t *)user_data;
+  endpoint_uri_t ep_uri;
+  memset(&ep_uri, 0, sizeof(endpoint_uri_t));
+  if (!parse_endpoint_uri(&resolve->endpoint_str, &ep_uri, false)) {
+    endpoint_resolve_finish(resolve, -1, NULL);
+    return;
+  }
+  if (status == 0) {
+    oc_endpoint_t endpoint;
+    memset(&endpoint, 0, sizeof(oc_endpoint_t));
+    if (endpoint_from_address(&ep_uri, oc_string(*addr), oc_string_len(*addr),
+                              &endpoint, NULL) == 0) {
+      endpoint_resolve_finish(resolve, 0, &endpoint);
+      return;
+    }
+  }
+#ifdef OC_DNS_LOOKUP_IPV6
+  else if ((resolve->flags & IPV4) != 0) {
+    // fall back to IPv6 in the same order as dns_lookup
+    resolve->flags = ep_uri.scheme_flags | IPV6;
+    if (oc_dns_lookup_async(domain, resolve->flags, endpoint_dns_lookup_handler,
+                            resolve) == 0) {
+      return;
+    }
+  }
+#endif /* OC_DNS_LOOKUP_IPV6 */
+  OC_ERR("failed to resolve domain(%s)", domain);
+  endpoint_resolve_finish(resolve, -1, NULL);
+}
+
+int
+oc_string_to_endpoint_async(const oc_string_t *endpoint_str,
+                            oc_endpoint_t *endpoint,
+                            oc_endpoint_resolve_t *resolve,
+                            oc_endpoint_resolve_handler_t handler,
+                            void *user_data)
+{
+  if (endpoint_str == NULL || endpoint == NULL || resolve == NULL ||
+      handler == NULL) {
+    return -1;
+  }
+  oc_endpoint_resolve_cancel(resolve);
+  endpoint_uri_t ep_uri;
+  memset(&ep_uri, 0, sizeof(endpoint_uri_t));
+  if (!parse_endpoint_uri(endpoint_str, &ep_uri, false)) {
+    return -1;
+  }
+  if (!endpoint_host_is_domain(ep_uri.address, ep_uri.host_len)) {
+    memset(endpoint, 0, sizeof(oc_endpoint_t));
+    return endpoint_from_address(&ep_uri, ep_uri.address, ep_uri.host_len,
+                                 endpoint, NULL);
+  }
+#if defined(OC_IPV4) || defined(OC_DNS_LOOKUP_IPV6)
+  char domain[ENDPOINT_MAX_HOST_LEN + 1];
+  if (!endpoint_uri_domain(&ep_uri, domain, sizeof(domain))) {
+    return -1;
+  }
+#ifdef OC_IPV4
+  transport_flags flags = ep_uri.scheme_flags | IPV4;
+#else  /* !OC_IPV4 */
+  transport_flags flags = ep_uri.scheme_flags | IPV6;
+#endif /* OC_IPV4 */
+  oc_new_string(&resolve->endpoint_str, oc_string(*endpoint_str),
+                oc_string_len(*endpoint_str));
+  resolve->flags = flags;
+  resolve->handler = handler;
+  resolve->user_data = user_data;
+  if (oc_dns_lookup_async(domain, flags, endpoint_dns_lookup_handler,
+                          resolve) != 0) {
+    OC_ERR("failed to schedule resolution of domain(%s)", domain);
+    oc_free_string(&resolve->endpoint_str);
+    resolve->handler = NULL;
+    resolve->user_data = NULL;
+    return -1;
+  }
+  return 1;
+#else  /* !OC_IPV4 && !OC_DNS_LOOKUP_IPV6 */
+  OC_ERR("cannot resolve address(%s): dns resolution disabled",
+         ep_uri.address);
+  return -1;
+#endif /* OC_IPV4 || OC_DNS_LOOKUP_IPV6 */
+}
+
+bool
+oc_endpoint_resolve_is_pending(const oc_endpoint_resolve_t *resolve)
+{
+  return resolve->handler != NULL;
+}
+
+void
+oc_endpoint_resolve_cancel(oc_endpoint_resolve_t *resolve)
+{
+  if (resolve->handler == NULL) {
+    return;
+  }
+  oc_dns_lookup_async_cancel(endpoint_dns_lookup_handler, resolve);
+  oc_free_string(&resolve->endpoint_str);
+  resolve->handler = NULL;
+  resolve->user_data = NULL;
+}
+
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
+
 int
 oc_endpoint_string_parse_path(const oc_string_t *endpoint_str,
                               oc_string_t *path)
@@ -754,6 +895,14 @@ oc_endpoint_copy(oc_endpoint_t *dst, const oc_endpoint_t *src)
   dst->next = NULL;
 }
 
+void
+oc_endpoint_copy_address(oc_endpoint_t *dst, const oc_endpoint_t *src)
+{
+  memcpy(&dst->addr, &src->addr, sizeof(dst->addr));
+  dst->flags = (dst->flags & ~(IPV4 | IPV6)) | (src->flags & (IPV4 | IPV6));
+  dst->interface_index = src->interface_index;
+}
+
 int
 oc_endpoint_list_copy(oc_endpoint_t **dst, const oc_endpoint_t *src)
 {
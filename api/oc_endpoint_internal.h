@@ -20,7 +20,9 @@
 #define OC_ENDPOINT_INTERNAL_H
 
 #include "oc_endpoint.h"
+#include "oc_helpers.h"
 #include "util/oc_compiler.h"
+#include "util/oc_features.h"
 #include "util/oc_macros_internal.h"
 
 #include <stdbool.h>
@@ -123,6 +125,13 @@ typedef struct oc_string64_s
 bool oc_endpoint_to_string64(const oc_endpoint_t *endpoint,
                              oc_string64_t *endpoint_str);
 
+/**
+ * @brief Copy the address, the address family flag and the network interface
+ * of src to dst, other members of dst are kept.
+ */
+void oc_endpoint_copy_address(oc_endpoint_t *dst, const oc_endpoint_t *src)
+  OC_NONNULL();
+
 /** @brief Get session id of the endpoint */
 int64_t oc_endpoint_session_id(const oc_endpoint_t *endpoint) OC_NONNULL();
 
@@ -130,6 +139,63 @@ int64_t oc_endpoint_session_id(const oc_endpoint_t *endpoint) OC_NONNULL();
 void oc_endpoint_log(const char *prefix, const oc_endpoint_t *endpoint)
   OC_NONNULL();
 
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+
+/**
+ * @brief Callback invoked when an asynchronous endpoint resolution finishes.
+ *
+ * @param status 0 on success, -1 on failure
+ * @param endpoint the resolved endpoint (NULL on failure)
+ * @param user_data user data passed to oc_string_to_endpoint_async
+ */
+typedef void (*oc_endpoint_resolve_handler_t)(int status,
+                                              const oc_endpoint_t *endpoint,
+                                              void *user_data);
+
+/** @brief State of an asynchronous endpoint resolution, owned by the caller */
+typedef struct oc_endpoint_resolve_t
+{
+  oc_string_t endpoint_str; ///< copy of the resolved endpoint string
+  transport_flags flags;    ///< flags of the running DNS lookup
+  oc_endpoint_resolve_handler_t handler;
+  void *user_data;
+} oc_endpoint_resolve_t;
+
+/**
+ * @brief Convert an endpoint string to an endpoint without blocking the
+ * calling thread on a DNS lookup.
+ *
+ * An address literal is parsed immediately. A domain is resolved by
+ * oc_dns_lookup_async (served from the DNS cache when possible) and the
+ * handler is invoked from the event loop once the lookup finishes. A
+ * resolution already running with the same request is cancelled.
+ *
+ * @param endpoint_str the endpoint string (cannot be NULL)
+ * @param[out] endpoint the parsed endpoint, filled only if the function returns
+ * 0 (cannot be NULL)
+ * @param resolve the request, must stay valid until the handler is invoked or
+ * the request is cancelled (cannot be NULL)
+ * @param handler the completion handler (cannot be NULL)
+ * @param user_data user data passed to the handler
+ * @return 0 the endpoint was parsed without a lookup, handler is not invoked
+ * @return 1 the lookup was scheduled
+ * @return -1 on failure
+ */
+int oc_string_to_endpoint_async(const oc_string_t *endpoint_str,
+                                oc_endpoint_t *endpoint,
+                                oc_endpoint_resolve_t *resolve,
+                                oc_endpoint_resolve_handler_t handler,
+                                void *user_data);
+
+/** @brief Check if the resolution request is waiting for a DNS lookup */
+bool oc_endpoint_resolve_is_pending(const oc_endpoint_resolve_t *resolve)
+  OC_NONNULL();
+
+/** @brief Cancel the resolution, the handler is not invoked */
+void oc_endpoint_resolve_cancel(oc_endpoint_resolve_t *resolve) OC_NONNULL();
+
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
+
 #ifdef __cplusplus
 }
 #endif
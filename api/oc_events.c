@@ -25,11 +25,31 @@
 /** Translation array of oc_events_t to oc_process_event_t */
 static oc_process_event_t oc_events[__NUM_OC_EVENT_TYPES__] = { 0 };
 
+/* Network and security events are handled before the housekeeping events */
+static oc_process_priority_t
+event_priority(oc_events_t event)
+{
+#ifdef OC_SOFTWARE_UPDATE
+  if (event >= SW_UPDATE_NSA && event <= SW_UPDATE_DONE) {
+    return OC_PROCESS_PRIORITY_NORMAL;
+  }
+#endif /* OC_SOFTWARE_UPDATE */
+#ifdef OC_HAS_FEATURE_PUSH
+  if (event == PUSH_RSC_STATE_CHANGED) {
+    return OC_PROCESS_PRIORITY_NORMAL;
+  }
+#endif /* OC_HAS_FEATURE_PUSH */
+  (void)event;
+  return OC_PROCESS_PRIORITY_HIGH;
+}
+
 void
 oc_event_assign_oc_process_events(void)
 {
   for (int i = 0; i < __NUM_OC_EVENT_TYPES__; ++i) {
     oc_events[i] = oc_process_alloc_event();
+    oc_process_set_event_priority(oc_events[i],
+                                  event_priority((oc_events_t)i));
   }
 }
 
@@ -71,6 +71,8 @@ oc_new_link(oc_resource_t *resource)
   link->interfaces = resource->interfaces;
 #ifdef OC_COLLECTIONS
   resource->num_links++;
+  link->collection = NULL;
+  link->next_resource_link = NULL;
 #endif /* OC_COLLECTIONS */
   link->next = NULL;
   link->ins = (int64_t)oc_random_value();
@@ -66,6 +66,11 @@ struct oc_link_s
   int64_t ins;
   oc_string_array_t rel;
   OC_LIST_STRUCT(params);
+#ifdef OC_COLLECTIONS
+  oc_collection_t *collection; ///< collection containing the link
+  struct oc_link_s
+    *next_resource_link; ///< next link of a collection with the same resource
+#endif                   /* OC_COLLECTIONS */
 };
 
 enum {
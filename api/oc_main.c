@@ -16,6 +16,7 @@
  *
  ****************************************************************************/
 
+#include "api/oc_network_events_internal.h"
 #include "api/oc_ri_internal.h"
 #include "api/oc_runtime_internal.h"
 #include "oc_config.h"
@@ -28,8 +29,10 @@
 #include "port/oc_clock.h"
 #include "port/oc_connectivity.h"
 #include "port/oc_network_event_handler_internal.h"
+#include "util/oc_atom_internal.h"
 #include "util/oc_etimer_internal.h"
 #include "util/oc_features.h"
+#include "util/oc_pool_stats.h"
 #include "util/oc_process.h"
 
 #if defined(OC_COLLECTIONS) && defined(OC_SERVER) &&                           \
@@ -77,6 +80,10 @@
 #include "api/plgd/plgd_time_internal.h"
 #endif /* OC_HAS_FEATURE_PLGD_TIME */
 
+#ifdef OC_HAS_FEATURE_STORAGE_SNAPSHOT
+#include "api/oc_storage_snapshot_internal.h"
+#endif /* OC_HAS_FEATURE_STORAGE_SNAPSHOT */
+
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -105,8 +112,13 @@ oc_shutdown_all_devices(void)
     oc_connectivity_shutdown(device);
   }
 
+  oc_network_events_free();
   oc_network_event_handler_mutex_destroy();
   oc_core_shutdown();
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+  // the resources holding interned types are deallocated
+  oc_atom_table_clear();
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
 }
 
 static void
@@ -153,6 +165,11 @@ main_sec_clear_resources(size_t device)
 static void
 main_load_resources(void)
 {
+#ifdef OC_HAS_FEATURE_STORAGE_SNAPSHOT
+  // read the stores of all devices at once
+  oc_storage_snapshot_begin();
+#endif /* OC_HAS_FEATURE_STORAGE_SNAPSHOT */
+
 #ifdef OC_HAS_FEATURE_PLGD_TIME
   OC_DBG("oc_main_init(): loading plgd time");
   plgd_time_load();
@@ -192,6 +209,10 @@ main_load_resources(void)
 #endif /* OC_SOFTWARE_UPDATE */
   }
 #endif /* OC_SECURITY || OC_SOFTWARE_UPDATE */
+
+#ifdef OC_HAS_FEATURE_STORAGE_SNAPSHOT
+  oc_storage_snapshot_end();
+#endif /* OC_HAS_FEATURE_STORAGE_SNAPSHOT */
 }
 
 static void
@@ -356,6 +377,10 @@ oc_main_shutdown(void)
 
   g_signal_event_loop = NULL;
 
+#ifdef OC_POOL_STATS
+  oc_pool_stats_dump();
+#endif /* OC_POOL_STATS */
+
 #ifdef OC_MEMORY_TRACE
   oc_mem_trace_shutdown();
 #endif /* OC_MEMORY_TRACE */
@@ -17,6 +17,7 @@
  ****************************************************************************/
 
 #include "api/oc_message_internal.h"
+#include "api/oc_metrics_internal.h"
 #include "oc_buffer.h"
 #include "oc_config.h"
 #include "port/oc_allocator_internal.h"
@@ -41,11 +42,205 @@ OC_MEMB(oc_incoming_buffers, oc_message_t, OC_MAX_NUM_CONCURRENT_REQUESTS);
 OC_MEMB(oc_outgoing_buffers, oc_message_t, OC_MAX_NUM_CONCURRENT_REQUESTS);
 #endif /* OC_INOUT_BUFFER_POOL */
 
+#ifdef OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER
+
+/* Released data buffers are kept in pools of fixed size classes and reused by
+ * following allocations. A released buffer is linked to the free list through
+ * its first bytes. */
+typedef struct message_buffer_free_s
+{
+  struct message_buffer_free_s *next;
+} message_buffer_free_t;
+
+typedef struct
+{
+  OC_ATOMIC_INT32_T lock;
+  size_t size; ///< size of the buffers in the pool
+  message_buffer_free_t *free;
+  size_t free_count;
+  uint32_t allocated;
+  uint32_t reused;
+  uint32_t released;
+} message_buffer_pool_t;
+
+/* The last pool holds buffers of OC_PDU_SIZE, which is evaluated at runtime */
+static message_buffer_pool_t g_message_buffer_pools[] = {
+  { .size = 128 },
+  { .size = 512 },
+  { .size = 2048 },
+  { .size = 0 },
+};
+
+#define MESSAGE_BUFFER_PDU_POOL                                                \
+  (&g_message_buffer_pools[OC_ARRAY_SIZE(g_message_buffer_pools) - 1])
+
+static void
+message_buffer_pool_lock(message_buffer_pool_t *pool)
+{
+  bool swapped = false;
+  while (!swapped) {
+    int32_t expected = 0;
+    OC_ATOMIC_COMPARE_AND_SWAP32(pool->lock, expected, 1, swapped);
+  }
+}
+
+static void
+message_buffer_pool_unlock(message_buffer_pool_t *pool)
+{
+  OC_ATOMIC_STORE32(pool->lock, 0);
+}
+
+static void
+message_buffer_pool_free_locked(message_buffer_pool_t *pool)
+{
+  while (pool->free != NULL) {
+    message_buffer_free_t *next = pool->free->next;
+    free(pool->free);
+    pool->free = next;
+  }
+  pool->free_count = 0;
+}
+
+/* Keep the size of the OC_PDU_SIZE pool in sync with the current value, the
+ * cached buffers are dropped when the value changes */
+static void
+message_buffer_pool_update_size_locked(message_buffer_pool_t *pool)
+{
+  if (pool != MESSAGE_BUFFER_PDU_POOL || pool->size == (size_t)OC_PDU_SIZE) {
+    return;
+  }
+  message_buffer_pool_free_locked(pool);
+  pool->size = (size_t)OC_PDU_SIZE;
+}
+
+static size_t
+message_buffer_pool_size(const message_buffer_pool_t *pool)
+{
+  if (pool == MESSAGE_BUFFER_PDU_POOL) {
+    return (size_t)OC_PDU_SIZE;
+  }
+  return pool->size;
+}
+
+/* Smallest pool with buffers big enough for size */
+static message_buffer_pool_t *
+message_buffer_pool_for_size(size_t size)
+{
+  message_buffer_pool_t *found = NULL;
+  for (size_t i = 0; i < OC_ARRAY_SIZE(g_message_buffer_pools); ++i) {
+    message_buffer_pool_t *pool = &g_message_buffer_pools[i];
+    size_t pool_size = message_buffer_pool_size(pool);
+    if (pool_size >= size &&
+        (found == NULL || pool_size < message_buffer_pool_size(found))) {
+      found = pool;
+    }
+  }
+  return found;
+}
+
+/* Get a buffer of at least size bytes, the content of the buffer is not
+ * initialized */
+static uint8_t *
+message_buffer_allocate(size_t size, size_t *capacity)
+{
+  message_buffer_pool_t *pool = message_buffer_pool_for_size(size);
+  if (pool == NULL) {
+    // bigger than any pool
+    *capacity = size;
+    return (uint8_t *)malloc(size);
+  }
+  message_buffer_pool_lock(pool);
+  message_buffer_pool_update_size_locked(pool);
+  size_t pool_size = pool->size;
+  message_buffer_free_t *buffer = pool->free;
+  if (buffer != NULL) {
+    pool->free = buffer->next;
+    --pool->free_count;
+    ++pool->reused;
+  } else {
+    ++pool->allocated;
+  }
+  message_buffer_pool_unlock(pool);
+  *capacity = pool_size;
+  if (buffer != NULL) {
+    return (uint8_t *)buffer;
+  }
+  return (uint8_t *)malloc(pool_size);
+}
+
+static void
+message_buffer_release(uint8_t *data, size_t capacity)
+{
+  if (data == NULL) {
+    return;
+  }
+  message_buffer_pool_t *pool = message_buffer_pool_for_size(capacity);
+  if (pool != NULL) {
+    message_buffer_pool_lock(pool);
+    message_buffer_pool_update_size_locked(pool);
+    if (pool->size == capacity &&
+        pool->free_count < OC_MESSAGE_BUFFER_POOL_MAX_FREE) {
+      CLANG_IGNORE_WARNING_START
+      CLANG_IGNORE_WARNING("-Wcast-align")
+      message_buffer_free_t *buffer = (message_buffer_free_t *)data;
+      CLANG_IGNORE_WARNING_END
+      buffer->next = pool->free;
+      pool->free = buffer;
+      ++pool->free_count;
+      ++pool->released;
+      data = NULL;
+    }
+    message_buffer_pool_unlock(pool);
+  }
+  free(data);
+}
+
+size_t
+oc_message_buffer_pools_count(void)
+{
+  return OC_ARRAY_SIZE(g_message_buffer_pools);
+}
+
+bool
+oc_message_buffer_pool_stats(size_t index,
+                             oc_message_buffer_pool_stats_t *stats)
+{
+  if (index >= OC_ARRAY_SIZE(g_message_buffer_pools)) {
+    return false;
+  }
+  message_buffer_pool_t *pool = &g_message_buffer_pools[index];
+  message_buffer_pool_lock(pool);
+  message_buffer_pool_update_size_locked(pool);
+  stats->size = pool->size;
+  stats->free = pool->free_count;
+  stats->allocated = pool->allocated;
+  stats->reused = pool->reused;
+  stats->released = pool->released;
+  message_buffer_pool_unlock(pool);
+  return true;
+}
+
+void
+oc_message_buffer_pools_clear(void)
+{
+  for (size_t i = 0; i < OC_ARRAY_SIZE(g_message_buffer_pools); ++i) {
+    message_buffer_pool_t *pool = &g_message_buffer_pools[i];
+    message_buffer_pool_lock(pool);
+    message_buffer_pool_free_locked(pool);
+    pool->allocated = 0;
+    pool->reused = 0;
+    pool->released = 0;
+    message_buffer_pool_unlock(pool);
+  }
+}
+
+#endif /* OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER */
+
 static void
 message_deallocate(oc_message_t *message, oc_memb_t *pool)
 {
 #ifdef OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER
-  free(message->data);
+  message_buffer_release(message->data, message->capacity);
 #endif /* OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER */
 #ifdef OC_HAS_FEATURE_ALLOCATOR_MUTEX
   oc_allocator_mutex_lock();
@@ -70,16 +265,19 @@ message_allocate_with_size(oc_memb_t *pool, size_t size)
 #ifdef OC_HAS_FEATURE_ALLOCATOR_MUTEX
     OC_WRN("buffer: No free TX/RX buffers!");
 #endif /* OC_HAS_FEATURE_ALLOCATOR_MUTEX */
+    OC_METRICS_INCREMENT(OC_METRIC_MESSAGE_ALLOCATION_FAILURES);
     return NULL;
   }
 #ifdef OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER
-  message->data = (uint8_t *)malloc(size);
+  // the buffer is not zeroed, only the first length bytes are ever read
+  message->data = message_buffer_allocate(size, &message->capacity);
   if (message->data == NULL) {
     OC_ERR("Out of memory, cannot allocate message");
+    OC_METRICS_INCREMENT(OC_METRIC_MESSAGE_ALLOCATION_FAILURES);
+    message->capacity = 0;
     message_deallocate(message, pool);
     return NULL;
   }
-  memset(message->data, 0, size);
   message->size = size;
 #else  /* !OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER */
   (void)size;
@@ -98,6 +296,7 @@ message_allocate_with_size(oc_memb_t *pool, size_t size)
 #endif /* OC_HAS_FEATURE_ALLOCATOR_MUTEX */
   OC_TRACE("buffer: allocated message(%p) from pool(%p)", (void *)message,
            (void *)pool);
+  OC_METRICS_INCREMENT(OC_METRIC_MESSAGES_ALLOCATED);
   return message;
 }
 
@@ -203,6 +402,7 @@ oc_message_deallocate(oc_message_t *message)
 {
   oc_memb_t *pool = message->pool;
   message_deallocate(message, pool);
+  OC_METRICS_DECREMENT(OC_METRIC_MESSAGES_ALLOCATED);
   OC_TRACE("buffer: deallocated message(%p) from pool(%p)", (void *)message,
            (void *)pool);
 #ifdef OC_HAS_FEATURE_ALLOCATOR_MUTEX
@@ -252,15 +452,39 @@ oc_message_shrink_buffer(oc_message_t *message, size_t size)
   if (size == old_size) {
     return;
   }
-  uint8_t *new_data = (uint8_t *)realloc(message->data, size);
-  if (new_data == NULL && size > 0) {
-    OC_ERR("Out of memory, cannot shrink message buffer");
+  if (size == 0) {
+    message_buffer_release(message->data, message->capacity);
+    message->data = NULL;
+    message->size = 0;
+    message->capacity = 0;
+    message->length = 0;
+    return;
+  }
+  // keep the buffer if it fits and a smaller one would not be used
+  if (message->data != NULL && size <= message->capacity &&
+      message_buffer_pool_for_size(size) ==
+        message_buffer_pool_for_size(message->capacity)) {
+    message->size = size;
+    if (message->length > size) {
+      message->length = size;
+    }
+    return;
+  }
+  size_t capacity = 0;
+  uint8_t *new_data = message_buffer_allocate(size, &capacity);
+  if (new_data == NULL) {
+    OC_ERR("Out of memory, cannot resize message buffer");
     return;
   }
-  message->data = new_data;
-  message->size = size;
   if (message->length > size) {
     message->length = size;
   }
+  if (message->data != NULL) {
+    memcpy(new_data, message->data, message->length);
+    message_buffer_release(message->data, message->capacity);
+  }
+  message->data = new_data;
+  message->size = size;
+  message->capacity = capacity;
 }
 #endif /* OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER */
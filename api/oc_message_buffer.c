@@ -19,6 +19,7 @@
 #include "api/oc_events_internal.h"
 #include "api/oc_message_buffer_internal.h"
 #include "api/oc_message_internal.h"
+#include "api/oc_tracepoint_internal.h"
 #include "messaging/coap/engine_internal.h"
 #include "oc_signal_event_loop.h"
 #include "oc_buffer.h"
@@ -54,9 +55,20 @@ oc_recv_message(oc_message_t *message)
 void
 oc_send_message(oc_message_t *message)
 {
+#if defined(OC_SECURITY) && defined(OC_CLIENT)
+  // the peer is created asynchronously, keep the ciphersuite selected for the
+  // request with the endpoint
+  if ((message->endpoint.flags & (SECURED | MULTICAST | DISCOVERY)) ==
+      SECURED) {
+    oc_tls_bind_selection(&message->endpoint);
+  }
+#endif /* OC_SECURITY && OC_CLIENT */
   if (oc_process_post(&oc_message_buffer_handler,
                       oc_event_to_oc_process_event(OUTBOUND_NETWORK_EVENT),
                       message) == OC_PROCESS_ERR_FULL) {
+#if defined(OC_SECURITY) && defined(OC_CLIENT)
+    oc_tls_release_selection(&message->endpoint);
+#endif /* OC_SECURITY && OC_CLIENT */
     oc_message_unref(message);
   }
   _oc_signal_event_loop();
@@ -85,28 +97,45 @@ oc_close_all_tls_sessions_for_device_reset(size_t device)
 }
 #endif /* OC_SECURITY */
 
+/* Pass the message to the next handler, the message is released when the
+ * event queue is full */
+static void
+message_buffer_post(struct oc_process *p, oc_events_t event,
+                    oc_process_data_t data)
+{
+  if (oc_process_post(p, oc_event_to_oc_process_event(event), data) ==
+      OC_PROCESS_ERR_FULL) {
+    OC_ERR("could not pass message(%p) to the next handler, dropping it",
+           data);
+#if defined(OC_SECURITY) && defined(OC_CLIENT)
+    if (event == RI_TO_TLS_EVENT) {
+      // the selection bound by oc_send_message is not used by the message
+      oc_tls_release_selection(&((oc_message_t *)data)->endpoint);
+    }
+#endif /* OC_SECURITY && OC_CLIENT */
+    oc_message_unref((oc_message_t *)data);
+  }
+}
+
 static void
 handle_inbound_network_event(oc_process_data_t data)
 {
 #ifdef OC_SECURITY
   if (((oc_message_t *)data)->encrypted == 1) {
     OC_DBG("Inbound network event: encrypted request");
-    oc_process_post(&oc_tls_handler,
-                    oc_event_to_oc_process_event(UDP_TO_TLS_EVENT), data);
+    message_buffer_post(&oc_tls_handler, UDP_TO_TLS_EVENT, data);
     return;
   }
 #ifdef OC_OSCORE
   if (((oc_message_t *)data)->endpoint.flags & MULTICAST) {
     OC_DBG("Inbound network event: multicast request");
-    oc_process_post(&oc_oscore_handler,
-                    oc_event_to_oc_process_event(INBOUND_OSCORE_EVENT), data);
+    message_buffer_post(&oc_oscore_handler, INBOUND_OSCORE_EVENT, data);
     return;
   }
 #endif /* OC_OSCORE */
 #endif /* OC_SECURITY */
   OC_DBG("Inbound network event: decrypted request");
-  oc_process_post(&g_coap_engine,
-                  oc_event_to_oc_process_event(INBOUND_RI_EVENT), data);
+  message_buffer_post(&g_coap_engine, INBOUND_RI_EVENT, data);
 }
 
 static void
@@ -124,9 +153,7 @@ handle_outbound_network_event(oc_process_data_t data)
   if ((message->endpoint.flags & MULTICAST) &&
       (message->endpoint.flags & SECURED)) {
     OC_DBG("Outbound secure multicast request: forwarding to OSCORE");
-    oc_process_post(&oc_oscore_handler,
-                    oc_event_to_oc_process_event(OUTBOUND_GROUP_OSCORE_EVENT),
-                    data);
+    message_buffer_post(&oc_oscore_handler, OUTBOUND_GROUP_OSCORE_EVENT, data);
     return;
   }
 #endif /* OC_SECURITY && OC_OSCORE */
@@ -135,14 +162,12 @@ handle_outbound_network_event(oc_process_data_t data)
   if (message->endpoint.flags & SECURED) {
 #ifdef OC_OSCORE
     OC_DBG("Outbound network event: forwarding to OSCORE");
-    oc_process_post(&oc_oscore_handler,
-                    oc_event_to_oc_process_event(OUTBOUND_OSCORE_EVENT), data);
+    message_buffer_post(&oc_oscore_handler, OUTBOUND_OSCORE_EVENT, data);
     return;
   }
 #else  /* !OC_OSCORE */
     OC_DBG("Posting RI_TO_TLS_EVENT");
-    oc_process_post(&oc_tls_handler,
-                    oc_event_to_oc_process_event(RI_TO_TLS_EVENT), data);
+    message_buffer_post(&oc_tls_handler, RI_TO_TLS_EVENT, data);
     return;
   }
 #endif /* OC_OSCORE */
@@ -151,6 +176,8 @@ handle_outbound_network_event(oc_process_data_t data)
   if (oc_send_buffer(message) < 0) {
     OC_ERR("failed to send unicast message");
   }
+  OC_TRACEPOINT(OC_TRACEPOINT_SEND, OC_TRACEPOINT_KEY(message),
+                message->length);
   oc_message_unref(message);
 }
 
@@ -24,6 +24,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -92,12 +93,47 @@ size_t oc_message_buffer_size(const oc_message_t *message) OC_NONNULL();
 
 #ifdef OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER
 /**
- * @brief Shrink the message buffer to the minimum size.
+ * @brief Resize the message buffer.
  *
- * @param message the message to shrink
- * @param size the new size of the shrunk buffer
+ * The buffer is moved to the pool of the smallest size class that can hold \p
+ * size bytes, the first min(length, size) bytes of the data are preserved.
+ *
+ * @param message the message to resize
+ * @param size the new size of the buffer (0 releases the buffer)
  */
 void oc_message_shrink_buffer(oc_message_t *message, size_t size) OC_NONNULL();
+
+/* Maximal number of released buffers cached by a single size class pool */
+#ifndef OC_MESSAGE_BUFFER_POOL_MAX_FREE
+#define OC_MESSAGE_BUFFER_POOL_MAX_FREE (16)
+#endif /* OC_MESSAGE_BUFFER_POOL_MAX_FREE */
+
+typedef struct oc_message_buffer_pool_stats_t
+{
+  size_t size;        ///< size of the buffers in the pool
+  uint32_t allocated; ///< number of buffers allocated by malloc
+  uint32_t reused;    ///< number of allocations served from the pool
+  uint32_t released;  ///< number of buffers returned to the pool
+  size_t free;        ///< number of buffers currently cached by the pool
+} oc_message_buffer_pool_stats_t;
+
+/** @brief Get the number of size class pools of message buffers */
+size_t oc_message_buffer_pools_count(void);
+
+/**
+ * @brief Get statistics of a size class pool of message buffers.
+ *
+ * @param index index of the pool (the last pool holds buffers of OC_PDU_SIZE)
+ * @param[out] stats output statistics (cannot be NULL)
+ * @return true on success
+ * @return false if index is out of range
+ */
+bool oc_message_buffer_pool_stats(size_t index,
+                                  oc_message_buffer_pool_stats_t *stats)
+  OC_NONNULL();
+
+/** @brief Deallocate all cached buffers and reset the statistics */
+void oc_message_buffer_pools_clear(void);
 #endif /* OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER */
 
 #ifdef __cplusplus
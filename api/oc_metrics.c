@@ -0,0 +1,293 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifdef OC_METRICS
+
+#include "api/oc_metrics_internal.h"
+#include "port/oc_log_internal.h"
+#include "util/oc_atomic.h"
+
+#ifdef OC_SERVER
+#include "oc_api.h"
+#include "oc_rep.h"
+#endif /* OC_SERVER */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct
+{
+  const char *name;
+  oc_metric_type_t type;
+  const uint32_t *bounds; ///< upper bounds of histogram buckets
+} metric_descriptor_t;
+
+/* Processing time of an inbound message in microseconds, the last bucket
+ * takes all values over the last bound */
+static const uint32_t g_processing_time_bounds[OC_METRICS_HISTOGRAM_BUCKETS -
+                                               1] = {
+  50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000,
+};
+
+static const metric_descriptor_t g_metrics_descriptors[OC_METRIC_COUNT] = {
+  [OC_METRIC_MESSAGES_ALLOCATED] = { "message.allocated", OC_METRIC_TYPE_GAUGE,
+                                     NULL },
+  [OC_METRIC_MESSAGE_ALLOCATION_FAILURES] = { "message.allocation_failures",
+                                              OC_METRIC_TYPE_COUNTER, NULL },
+  [OC_METRIC_NETWORK_RECEIVED] = { "network.received", OC_METRIC_TYPE_COUNTER,
+                                   NULL },
+  [OC_METRIC_NETWORK_DROPPED] = { "network.dropped", OC_METRIC_TYPE_COUNTER,
+                                  NULL },
+  [OC_METRIC_NETWORK_QUEUED] = { "network.queued", OC_METRIC_TYPE_GAUGE,
+                                 NULL },
+  [OC_METRIC_NETWORK_THROTTLED] = { "network.throttled",
+                                    OC_METRIC_TYPE_COUNTER, NULL },
+  [OC_METRIC_COAP_TRANSACTIONS] = { "coap.transactions", OC_METRIC_TYPE_GAUGE,
+                                    NULL },
+  [OC_METRIC_COAP_RETRANSMISSIONS] = { "coap.retransmissions",
+                                       OC_METRIC_TYPE_COUNTER, NULL },
+  [OC_METRIC_COAP_TIMEOUTS] = { "coap.timeouts", OC_METRIC_TYPE_COUNTER,
+                                NULL },
+  [OC_METRIC_COAP_PROCESSING_TIME_US] = { "coap.processing_time_us",
+                                          OC_METRIC_TYPE_HISTOGRAM,
+                                          g_processing_time_bounds },
+  [OC_METRIC_TLS_PEERS] = { "tls.peers", OC_METRIC_TYPE_GAUGE, NULL },
+  [OC_METRIC_TLS_HANDSHAKES] = { "tls.handshakes", OC_METRIC_TYPE_COUNTER,
+                                 NULL },
+  [OC_METRIC_TLS_HANDSHAKE_FAILURES] = { "tls.handshake_failures",
+                                         OC_METRIC_TYPE_COUNTER, NULL },
+  [OC_METRIC_ACL_DENIED] = { "acl.denied", OC_METRIC_TYPE_COUNTER, NULL },
+};
+
+typedef struct
+{
+  OC_ATOMIC_UINT32_T sum;
+  OC_ATOMIC_UINT32_T buckets[OC_METRICS_HISTOGRAM_BUCKETS];
+} metric_histogram_t;
+
+/* Value of a counter or a gauge, number of observed values of a histogram */
+static OC_ATOMIC_UINT32_T g_metrics_values[OC_METRIC_COUNT];
+/* Histograms are sparse in the list of metrics, the storage is small enough to
+ * not bother with a mapping */
+static metric_histogram_t g_metrics_histograms[OC_METRIC_COUNT];
+
+static bool
+metric_is_valid(oc_metric_t metric)
+{
+  return (int)metric >= 0 && metric < OC_METRIC_COUNT;
+}
+
+static bool
+metric_is_histogram(oc_metric_t metric)
+{
+  return metric_is_valid(metric) &&
+         g_metrics_descriptors[metric].type == OC_METRIC_TYPE_HISTOGRAM;
+}
+
+const char *
+oc_metrics_name(oc_metric_t metric)
+{
+  if (!metric_is_valid(metric)) {
+    return NULL;
+  }
+  return g_metrics_descriptors[metric].name;
+}
+
+oc_metric_type_t
+oc_metrics_type(oc_metric_t metric)
+{
+  assert(metric_is_valid(metric));
+  return g_metrics_descriptors[metric].type;
+}
+
+uint32_t
+oc_metrics_value(oc_metric_t metric)
+{
+  if (!metric_is_valid(metric)) {
+    return 0;
+  }
+  return OC_ATOMIC_LOAD32(g_metrics_values[metric]);
+}
+
+void
+oc_metrics_increment(oc_metric_t metric)
+{
+  assert(metric_is_valid(metric));
+  OC_ATOMIC_INCREMENT32(g_metrics_values[metric]);
+}
+
+void
+oc_metrics_decrement(oc_metric_t metric)
+{
+  assert(metric_is_valid(metric));
+  assert(g_metrics_descriptors[metric].type == OC_METRIC_TYPE_GAUGE);
+  OC_ATOMIC_DECREMENT32(g_metrics_values[metric]);
+}
+
+static size_t
+histogram_bucket(const uint32_t *bounds, uint32_t value)
+{
+  // the bounds are few and sorted, a linear scan is fine
+  size_t bucket = 0;
+  while (bucket < OC_METRICS_HISTOGRAM_BUCKETS - 1 && value > bounds[bucket]) {
+    ++bucket;
+  }
+  return bucket;
+}
+
+void
+oc_metrics_observe(oc_metric_t metric, uint32_t value)
+{
+  assert(metric_is_histogram(metric));
+  metric_histogram_t *histogram = &g_metrics_histograms[metric];
+  size_t bucket =
+    histogram_bucket(g_metrics_descriptors[metric].bounds, value);
+  OC_ATOMIC_INCREMENT32(histogram->buckets[bucket]);
+  OC_ATOMIC_ADD32(histogram->sum, value);
+  OC_ATOMIC_INCREMENT32(g_metrics_values[metric]);
+}
+
+bool
+oc_metrics_histogram(oc_metric_t metric, oc_metrics_histogram_t *histogram)
+{
+  if (!metric_is_histogram(metric)) {
+    return false;
+  }
+  metric_histogram_t *h = &g_metrics_histograms[metric];
+  histogram->count = OC_ATOMIC_LOAD32(g_metrics_values[metric]);
+  histogram->sum = OC_ATOMIC_LOAD32(h->sum);
+  for (size_t i = 0; i < OC_METRICS_HISTOGRAM_BUCKETS; ++i) {
+    histogram->buckets[i] = OC_ATOMIC_LOAD32(h->buckets[i]);
+  }
+  return true;
+}
+
+uint32_t
+oc_metrics_histogram_bucket_bound(oc_metric_t metric, size_t bucket)
+{
+  if (!metric_is_histogram(metric) ||
+      bucket >= OC_METRICS_HISTOGRAM_BUCKETS - 1) {
+    return UINT32_MAX;
+  }
+  return g_metrics_descriptors[metric].bounds[bucket];
+}
+
+void
+oc_metrics_iterate(bool (*fn)(oc_metric_t metric, void *data), void *data)
+{
+  for (int i = 0; i < OC_METRIC_COUNT; ++i) {
+    if (!fn((oc_metric_t)i, data)) {
+      return;
+    }
+  }
+}
+
+void
+oc_metrics_reset(void)
+{
+  for (int i = 0; i < OC_METRIC_COUNT; ++i) {
+    if (g_metrics_descriptors[i].type == OC_METRIC_TYPE_GAUGE) {
+      continue;
+    }
+    OC_ATOMIC_STORE32(g_metrics_values[i], 0);
+    if (g_metrics_descriptors[i].type == OC_METRIC_TYPE_HISTOGRAM) {
+      metric_histogram_t *h = &g_metrics_histograms[i];
+      OC_ATOMIC_STORE32(h->sum, 0);
+      for (size_t j = 0; j < OC_METRICS_HISTOGRAM_BUCKETS; ++j) {
+        OC_ATOMIC_STORE32(h->buckets[j], 0);
+      }
+    }
+  }
+}
+
+#ifdef OC_SERVER
+
+static bool
+metrics_encode_metric(oc_metric_t metric, void *data)
+{
+  (void)data;
+  oc_rep_set_key(oc_rep_object(root), oc_metrics_name(metric));
+  if (oc_metrics_type(metric) != OC_METRIC_TYPE_HISTOGRAM) {
+    oc_rep_set_value_int(root, oc_metrics_value(metric));
+    return true;
+  }
+  oc_metrics_histogram_t h;
+  oc_metrics_histogram(metric, &h);
+  oc_rep_begin_object(oc_rep_object(root), histogram);
+  oc_rep_set_int(histogram, count, h.count);
+  oc_rep_set_int(histogram, sum, h.sum);
+  oc_rep_open_array(histogram, bounds);
+  for (size_t i = 0; i < OC_METRICS_HISTOGRAM_BUCKETS - 1; ++i) {
+    oc_rep_add_int(bounds, oc_metrics_histogram_bucket_bound(metric, i));
+  }
+  oc_rep_close_array(histogram, bounds);
+  oc_rep_open_array(histogram, buckets);
+  for (size_t i = 0; i < OC_METRICS_HISTOGRAM_BUCKETS; ++i) {
+    oc_rep_add_int(buckets, h.buckets[i]);
+  }
+  oc_rep_close_array(histogram, buckets);
+  oc_rep_end_object(oc_rep_object(root), histogram);
+  return true;
+}
+
+static void
+metrics_resource_get(oc_request_t *request, oc_interface_mask_t iface,
+                     void *data)
+{
+  (void)data;
+  oc_rep_start_root_object();
+  if (iface == OC_IF_BASELINE) {
+    oc_process_baseline_interface(request->resource);
+  }
+  oc_metrics_iterate(metrics_encode_metric, NULL);
+  oc_rep_end_root_object();
+  if (oc_rep_get_cbor_errno() != CborNoError) {
+    OC_ERR("cannot encode metrics resource: error(%d)",
+           (int)oc_rep_get_cbor_errno());
+    oc_send_response_with_callback(request, OC_STATUS_INTERNAL_SERVER_ERROR,
+                                   true);
+    return;
+  }
+  oc_send_response_with_callback(request, OC_STATUS_OK, true);
+}
+
+oc_resource_t *
+oc_metrics_resource_create(size_t device)
+{
+  oc_resource_t *res = oc_new_resource(NULL, OC_METRICS_URI, 1, device);
+  if (res == NULL) {
+    OC_ERR("cannot create metrics resource");
+    return NULL;
+  }
+  oc_resource_bind_resource_type(res, OC_METRICS_RT);
+  oc_resource_bind_resource_interface(res, OC_IF_R);
+  oc_resource_set_default_interface(res, OC_IF_R);
+  oc_resource_set_discoverable(res, true);
+  oc_resource_set_request_handler(res, OC_GET, metrics_resource_get, NULL);
+  if (!oc_add_resource(res)) {
+    OC_ERR("cannot add metrics resource to device(%zu)", device);
+    oc_delete_resource(res);
+    return NULL;
+  }
+  return res;
+}
+
+#endif /* OC_SERVER */
+
+#endif /* OC_METRICS */
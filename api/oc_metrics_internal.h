@@ -0,0 +1,58 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifndef OC_METRICS_INTERNAL_H
+#define OC_METRICS_INTERNAL_H
+
+#ifdef OC_METRICS
+
+#include "oc_metrics.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Increment a counter or a gauge, safe to call from any thread */
+void oc_metrics_increment(oc_metric_t metric);
+
+/** @brief Decrement a gauge, safe to call from any thread */
+void oc_metrics_decrement(oc_metric_t metric);
+
+/** @brief Add a value to a histogram, safe to call from any thread */
+void oc_metrics_observe(oc_metric_t metric, uint32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define OC_METRICS_INCREMENT(metric) oc_metrics_increment(metric)
+#define OC_METRICS_DECREMENT(metric) oc_metrics_decrement(metric)
+#define OC_METRICS_OBSERVE(metric, value) oc_metrics_observe(metric, value)
+
+#else /* !OC_METRICS */
+
+/* The metrics are compiled out, arguments are not evaluated */
+#define OC_METRICS_INCREMENT(metric)
+#define OC_METRICS_DECREMENT(metric)
+#define OC_METRICS_OBSERVE(metric, value)
+
+#endif /* OC_METRICS */
+
+#endif /* OC_METRICS_INTERNAL_H */
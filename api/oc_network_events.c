@@ -20,7 +20,9 @@
 #include "api/oc_events_internal.h"
 #include "api/oc_message_buffer_internal.h"
 #include "api/oc_message_internal.h"
+#include "api/oc_metrics_internal.h"
 #include "api/oc_network_events_internal.h"
+#include "api/oc_tracepoint_internal.h"
 #include "messaging/coap/coap_internal.h"
 #include "oc_buffer.h"
 #include "oc_config.h"
@@ -31,11 +33,21 @@
 #include "port/oc_connectivity.h"
 #include "port/oc_connectivity_internal.h"
 #include "port/oc_network_event_handler_internal.h"
+#include "util/oc_atomic.h"
 #include "util/oc_features.h"
 #include "util/oc_list.h"
 
 #include <assert.h>
 
+#ifdef OC_DYNAMIC_ALLOCATION
+#include <stdlib.h>
+#endif /* OC_DYNAMIC_ALLOCATION */
+
+/* Received messages are pushed by the network threads to a lock-free stack,
+ * which is emptied at once by the stack thread. The stack thread restores
+ * the order of arrival and keeps the messages in g_network_events, which is
+ * accessed only by the stack thread. */
+static oc_message_t *g_network_events_in = NULL;
 OC_LIST(g_network_events);
 #ifdef OC_HAS_FEATURE_TCP_ASYNC_CONNECT
 OC_LIST(g_network_tcp_connect_events);
@@ -46,35 +58,146 @@ static bool g_interface_down;
 #endif /* OC_NETWORK_MONITOR */
 
 #ifdef OC_DYNAMIC_ALLOCATION
-static size_t
-get_events_queue_length(size_t device, oc_list_t events)
+/* Number of queued messages of each device. The counters are allocated in
+ * blocks on first use and a block is never moved, so the counters can be
+ * accessed without a lock. */
+#define OC_NETWORK_EVENTS_COUNTERS_BLOCK_SIZE (64)
+#define OC_NETWORK_EVENTS_COUNTERS_MAX_BLOCKS (256)
+
+static OC_ATOMIC_INT32_T
+  *g_queue_length[OC_NETWORK_EVENTS_COUNTERS_MAX_BLOCKS] = { NULL };
+
+static OC_ATOMIC_INT32_T *
+network_events_queue_length(size_t device, bool create)
 {
-  size_t msg_count = 0;
-  for (oc_message_t *msg = (oc_message_t *)oc_list_head(events); msg != NULL;
-       msg = msg->next) {
-    if (msg->endpoint.device == device) {
-      ++msg_count;
+  size_t block = device / OC_NETWORK_EVENTS_COUNTERS_BLOCK_SIZE;
+  if (block >= OC_NETWORK_EVENTS_COUNTERS_MAX_BLOCKS) {
+    // queue length of such device is not tracked
+    return NULL;
+  }
+  OC_ATOMIC_INT32_T *counters = OC_ATOMIC_LOADPTR(g_queue_length[block]);
+  if (counters == NULL && create) {
+    OC_ATOMIC_INT32_T *new_counters = (OC_ATOMIC_INT32_T *)calloc(
+      OC_NETWORK_EVENTS_COUNTERS_BLOCK_SIZE, sizeof(OC_ATOMIC_INT32_T));
+    if (new_counters == NULL) {
+      return NULL;
+    }
+    bool swapped = false;
+    OC_ATOMIC_COMPARE_AND_SWAPPTR(g_queue_length[block], counters,
+                                  new_counters, swapped);
+    if (swapped) {
+      counters = new_counters;
+    } else {
+      // another thread allocated the block
+      free(new_counters);
     }
   }
-  return msg_count;
+  if (counters == NULL) {
+    return NULL;
+  }
+  return &counters[device % OC_NETWORK_EVENTS_COUNTERS_BLOCK_SIZE];
 }
 
 static void
-send_wakeup_signal(oc_list_t events)
+network_events_queue_length_increment(size_t device)
 {
-  size_t msg_total = oc_list_length(events);
+  OC_ATOMIC_INT32_T *count = network_events_queue_length(device, true);
+  if (count != NULL) {
+    OC_ATOMIC_INCREMENT32(*count);
+  }
+}
 
-  int deviceId = 0;
-  while (msg_total >= OC_DEVICE_MAX_NUM_CONCURRENT_REQUESTS) {
-    size_t msg_device_count = get_events_queue_length(deviceId, events);
-    if (msg_device_count >= OC_DEVICE_MAX_NUM_CONCURRENT_REQUESTS) {
-      oc_connectivity_wakeup(deviceId);
-    }
-    msg_total -= msg_device_count;
-    ++deviceId; // advance to the next device
+/* Decrement the queue length and wake up the network thread of the device if
+ * the queue stopped being full */
+static void
+network_events_queue_length_decrement(size_t device)
+{
+  OC_ATOMIC_INT32_T *count = network_events_queue_length(device, false);
+  if (count != NULL && OC_ATOMIC_DECREMENT32(*count) ==
+                         OC_DEVICE_MAX_NUM_CONCURRENT_REQUESTS - 1) {
+    oc_connectivity_wakeup(device);
   }
 }
+
+static void
+network_events_queue_length_free(void)
+{
+  for (size_t i = 0; i < OC_NETWORK_EVENTS_COUNTERS_MAX_BLOCKS; ++i) {
+    free((void *)g_queue_length[i]);
+    g_queue_length[i] = NULL;
+  }
+}
+#endif /* OC_DYNAMIC_ALLOCATION */
+
+static void
+network_events_push(oc_message_t *message)
+{
+  OC_METRICS_INCREMENT(OC_METRIC_NETWORK_RECEIVED);
+  OC_METRICS_INCREMENT(OC_METRIC_NETWORK_QUEUED);
+#ifdef OC_DYNAMIC_ALLOCATION
+  network_events_queue_length_increment(message->endpoint.device);
 #endif /* OC_DYNAMIC_ALLOCATION */
+#ifndef OC_ATOMIC_NOT_SUPPORTED
+  oc_message_t *head = OC_ATOMIC_LOADPTR(g_network_events_in);
+  bool swapped = false;
+  while (!swapped) {
+    message->next = head;
+    OC_ATOMIC_COMPARE_AND_SWAPPTR(g_network_events_in, head, message, swapped);
+  }
+#else  /* OC_ATOMIC_NOT_SUPPORTED */
+  oc_network_event_handler_mutex_lock();
+  message->next = g_network_events_in;
+  g_network_events_in = message;
+  oc_network_event_handler_mutex_unlock();
+#endif /* !OC_ATOMIC_NOT_SUPPORTED */
+}
+
+/* Move messages pushed by the network threads to g_network_events, must be
+ * called only from the stack thread */
+static void
+network_events_collect(void)
+{
+#ifndef OC_ATOMIC_NOT_SUPPORTED
+  oc_message_t *message =
+    (oc_message_t *)OC_ATOMIC_EXCHANGEPTR(g_network_events_in, NULL);
+#else  /* OC_ATOMIC_NOT_SUPPORTED */
+  oc_network_event_handler_mutex_lock();
+  oc_message_t *message = g_network_events_in;
+  g_network_events_in = NULL;
+  oc_network_event_handler_mutex_unlock();
+#endif /* !OC_ATOMIC_NOT_SUPPORTED */
+  if (message == NULL) {
+    return;
+  }
+
+  // the stack holds the newest message first -> reverse it
+  OC_LIST_LOCAL(arrived);
+  while (message != NULL) {
+    oc_message_t *next = message->next;
+    oc_list_push(arrived, message);
+    message = next;
+  }
+  oc_message_t *tail = (oc_message_t *)oc_list_tail(g_network_events);
+  if (tail == NULL) {
+    oc_list_copy(g_network_events, arrived);
+    return;
+  }
+  tail->next = (oc_message_t *)oc_list_head(arrived);
+}
+
+static oc_message_t *
+network_events_pop(void)
+{
+  oc_message_t *message = (oc_message_t *)oc_list_pop(g_network_events);
+  if (message == NULL) {
+    return NULL;
+  }
+  OC_METRICS_DECREMENT(OC_METRIC_NETWORK_QUEUED);
+#ifdef OC_DYNAMIC_ALLOCATION
+  network_events_queue_length_decrement(message->endpoint.device);
+#endif /* OC_DYNAMIC_ALLOCATION */
+  return message;
+}
 
 static void
 oc_process_network_event(void)
@@ -85,9 +208,6 @@ oc_process_network_event(void)
   oc_list_copy(network_tcp_connect_events, g_network_tcp_connect_events);
   oc_list_init(g_network_tcp_connect_events);
 #endif /* OC_HAS_FEATURE_TCP_ASYNC_CONNECT */
-  OC_LIST_LOCAL(network_events);
-  oc_list_copy(network_events, g_network_events);
-  oc_list_init(g_network_events);
 #ifdef OC_NETWORK_MONITOR
   bool interface_up = g_interface_up;
   g_interface_up = false;
@@ -96,11 +216,6 @@ oc_process_network_event(void)
 #endif /* OC_NETWORK_MONITOR */
   oc_network_event_handler_mutex_unlock();
 
-#ifdef OC_DYNAMIC_ALLOCATION
-  // send a wake-up signal in case the queue might reach the limit for a device
-  send_wakeup_signal(network_events);
-#endif /* OC_DYNAMIC_ALLOCATION */
-
 #ifdef OC_HAS_FEATURE_TCP_ASYNC_CONNECT
   oc_tcp_on_connect_event_t *event =
     (oc_tcp_on_connect_event_t *)oc_list_pop(network_tcp_connect_events);
@@ -110,10 +225,11 @@ oc_process_network_event(void)
       (oc_tcp_on_connect_event_t *)oc_list_pop(network_tcp_connect_events);
   }
 #endif /* OC_HAS_FEATURE_TCP_ASYNC_CONNECT */
-  oc_message_t *message = (oc_message_t *)oc_list_pop(network_events);
+  network_events_collect();
+  oc_message_t *message = network_events_pop();
   while (message != NULL) {
     oc_recv_message(message);
-    message = (oc_message_t *)oc_list_pop(network_events);
+    message = network_events_pop();
   }
 #ifdef OC_NETWORK_MONITOR
   if (interface_up) {
@@ -150,6 +266,7 @@ void
 oc_network_receive_event(oc_message_t *message)
 {
   if (!oc_process_is_running(&oc_network_events)) {
+    OC_METRICS_INCREMENT(OC_METRIC_NETWORK_DROPPED);
     oc_message_unref(message);
     return;
   }
@@ -158,15 +275,16 @@ oc_network_receive_event(oc_message_t *message)
   if (((message->endpoint.flags & TCP) == 0) &&
       !oc_udp_is_valid_message(message)) {
     OC_ERR("invalid header - dropping message");
+    OC_METRICS_INCREMENT(OC_METRIC_NETWORK_DROPPED);
     oc_message_unref(message);
     return;
   }
 #ifdef OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER
   oc_message_shrink_buffer(message, message->length);
 #endif /* OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER */
-  oc_network_event_handler_mutex_lock();
-  oc_list_add(g_network_events, message);
-  oc_network_event_handler_mutex_unlock();
+  OC_TRACEPOINT(OC_TRACEPOINT_RECEIVE, OC_TRACEPOINT_KEY(message),
+                message->length);
+  network_events_push(message);
 
   oc_process_poll(&oc_network_events);
   _oc_signal_event_loop();
@@ -193,12 +311,17 @@ size_t
 oc_network_drop_receive_events(const oc_endpoint_t *endpoint)
 {
   size_t dropped = 0;
-  oc_network_event_handler_mutex_lock();
+  network_events_collect();
   for (oc_message_t *message = (oc_message_t *)oc_list_head(g_network_events);
        message != NULL;) {
     oc_message_t *next = message->next;
     if (oc_endpoint_compare(&message->endpoint, endpoint) == 0) {
       oc_list_remove(g_network_events, message);
+      OC_METRICS_DECREMENT(OC_METRIC_NETWORK_QUEUED);
+      OC_METRICS_INCREMENT(OC_METRIC_NETWORK_DROPPED);
+#ifdef OC_DYNAMIC_ALLOCATION
+      network_events_queue_length_decrement(message->endpoint.device);
+#endif /* OC_DYNAMIC_ALLOCATION */
 #if OC_DBG_IS_ENABLED
       // GCOVR_EXCL_START
       oc_process_event_t ev =
@@ -217,20 +340,6 @@ oc_network_drop_receive_events(const oc_endpoint_t *endpoint)
     }
     message = next;
   }
-
-#ifdef OC_DYNAMIC_ALLOCATION
-  size_t queue_len =
-    get_events_queue_length(endpoint->device, g_network_events);
-  // unlock mutex and send a wake-up signal in case the queue for the device was
-  // full
-  oc_network_event_handler_mutex_unlock();
-  if (queue_len + dropped >= OC_DEVICE_MAX_NUM_CONCURRENT_REQUESTS) {
-    oc_connectivity_wakeup(endpoint->device);
-  }
-#else
-  oc_network_event_handler_mutex_unlock();
-#endif /* OC_DYNAMIC_ALLOCATION */
-
   return dropped;
 }
 
@@ -261,9 +370,26 @@ oc_network_interface_event(oc_interface_event_t event)
 size_t
 oc_network_get_event_queue_length(size_t device)
 {
-  oc_network_event_handler_mutex_lock();
-  size_t msg_count = get_events_queue_length(device, g_network_events);
-  oc_network_event_handler_mutex_unlock();
-  return msg_count;
+  const OC_ATOMIC_INT32_T *count = network_events_queue_length(device, false);
+  if (count == NULL) {
+    return 0;
+  }
+  int32_t msg_count = OC_ATOMIC_LOAD32(*count);
+  return msg_count > 0 ? (size_t)msg_count : 0;
 }
 #endif /* OC_DYNAMIC_ALLOCATION */
+
+void
+oc_network_events_free(void)
+{
+  network_events_collect();
+  oc_message_t *message = (oc_message_t *)oc_list_pop(g_network_events);
+  while (message != NULL) {
+    OC_METRICS_DECREMENT(OC_METRIC_NETWORK_QUEUED);
+    oc_message_unref(message);
+    message = (oc_message_t *)oc_list_pop(g_network_events);
+  }
+#ifdef OC_DYNAMIC_ALLOCATION
+  network_events_queue_length_free();
+#endif /* OC_DYNAMIC_ALLOCATION */
+}
@@ -55,6 +55,8 @@ void oc_network_tcp_connect_event(oc_tcp_on_connect_event_t *event)
 /**
  * @brief Drop received events for endpoint
  *
+ * Must be called from the thread running the stack.
+ *
  * @param endpoint the endpoint (cannot be NULL)
  * @return number of events dropped
  */
@@ -82,11 +84,21 @@ void oc_network_interface_event(oc_interface_event_t event);
 /**
  * @brief Returns the network event queue length for the device
  *
+ * The length is maintained atomically, the function can be called from any
+ * thread without locking.
+ *
  * @param device valid device index
  * @return number of events in the queue
  */
 size_t oc_network_get_event_queue_length(size_t device);
 
+/**
+ * @brief Release all queued events and the per-device queue length counters.
+ *
+ * Must be called after the network threads of all devices were stopped.
+ */
+void oc_network_events_free(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,7 +27,9 @@
 #include "oc_push.h"
 
 #include "api/oc_helpers_internal.h"
+#include "api/oc_rep_encode_internal.h"
 #include "api/oc_rep_internal.h"
+#include "api/oc_resource_internal.h"
 #include "api/oc_endpoint_internal.h"
 #include "oc_api.h"
 #include "oc_core_res.h"
@@ -47,6 +49,7 @@
 #include "util/oc_process.h"
 
 #include <inttypes.h>
+#include <stdlib.h>
 
 // TODO: add push component to logs and use standard logging functions
 #if defined(OC_PUSHDEBUG) || OC_DBG_IS_ENABLED
@@ -105,6 +108,7 @@ typedef struct oc_ns
   oc_string_array_t sourcert; ///< oic.r.pushproxy:sourcert
   oc_string_t state;          ///< oic.r.pushproxy:state
   void *user_data;            ///< used to point updated pushable Resource
+  uint32_t update_id; ///< id of the last update matched with the selector
 } oc_ns_t;
 
 /**
@@ -179,6 +183,85 @@ OC_MEMB(g_pushd_rsc_rep_instance_memb, oc_pushd_resource_rep_t, 1);
  */
 OC_LIST(g_pushd_rsc_rep_list);
 
+#ifndef OC_PUSH_NS_INDEX_BUCKETS
+/**
+ * @brief number of buckets of each table of the notification selector index
+ */
+#define OC_PUSH_NS_INDEX_BUCKETS (16)
+#endif /* !OC_PUSH_NS_INDEX_BUCKETS */
+
+#ifndef OC_PUSH_COALESCE_DELAY_MS
+/**
+ * @brief updates of a pushable Resource within this time (in milliseconds) are
+ * pushed together
+ */
+#define OC_PUSH_COALESCE_DELAY_MS (50)
+#endif /* !OC_PUSH_COALESCE_DELAY_MS */
+
+/**
+ * @brief entry of the notification selector index
+ */
+typedef struct oc_ns_index_entry
+{
+  struct oc_ns_index_entry *next;
+  oc_ns_t *ns_instance;
+} oc_ns_index_entry_t;
+
+/**
+ * @brief	memory block definition for storing entries of the notification
+ * selector index
+ */
+OC_MEMB(g_ns_index_entry_memb, oc_ns_index_entry_t, 1);
+
+/**
+ * @brief	index of `g_ns_list`, built on demand after any notification selector
+ * is changed
+ *
+ * 			- selectors with phref are indexed by (device, phref)
+ * 			- selectors without phref are indexed by (device, rt) for each rt of prt
+ * 			- selectors with only pif are kept in `by_pif`
+ * 			- selectors without any of them match no Resource
+ */
+static struct
+{
+  oc_ns_index_entry_t *by_href[OC_PUSH_NS_INDEX_BUCKETS];
+  oc_ns_index_entry_t *by_rt[OC_PUSH_NS_INDEX_BUCKETS];
+  oc_ns_index_entry_t *by_pif;
+  bool valid;
+} g_ns_index;
+
+/**
+ * @brief	id of the last update of a pushable Resource, used to visit each
+ * notification selector once per update
+ */
+static uint32_t g_push_update_id;
+
+#ifdef OC_TEST
+static oc_push_update_cb_t g_push_update_cb;
+static void *g_push_update_cb_data;
+#endif /* OC_TEST */
+
+/**
+ * @brief	pushable Resource updated since the last push
+ */
+typedef struct oc_push_pending
+{
+  struct oc_push_pending *next;
+  oc_string_t uri;
+  size_t device;
+} oc_push_pending_t;
+
+/**
+ * @brief	memory block definition for storing updated pushable Resources
+ */
+OC_MEMB(g_push_pending_memb, oc_push_pending_t, 1);
+
+/**
+ * @brief	`g_push_pending_list` keeps pushable Resources updated since the last
+ * push
+ */
+OC_LIST(g_push_pending_list);
+
 /**
  * @brief	process which handles push notification
  */
@@ -265,6 +348,8 @@ set_ns_properties(const oc_resource_t *resource, const oc_rep_t *rep,
    * by calling `oc_resource_set_properties_cbs()` in `get_ns_instance()`
    */
   oc_ns_t *ns_instance = (oc_ns_t *)data;
+  /* phref or prt may change, rebuild the index on next update */
+  g_ns_index.valid = false;
   while (rep != NULL) {
     switch (rep->type) {
     case OC_REP_STRING:
@@ -743,6 +828,7 @@ get_ns_instance(const char *href, const oc_string_array_t *types,
   oc_new_string(&ns_instance->state, pp_statestr(OC_PP_WFP),
                 strlen(pp_statestr(OC_PP_WFP)));
   ns_instance->user_data = NULL;
+  ns_instance->update_id = 0;
 
   OC_PUSH_DBG("state of Push Proxy (\"%s\") is initialized (%s)",
               oc_string(ns_instance->resource->uri), pp_statestr(OC_PP_WFP));
@@ -752,6 +838,7 @@ get_ns_instance(const char *href, const oc_string_array_t *types,
    * which keeps all Notification Selectors of all Devices
    */
   oc_list_add(g_ns_list, ns_instance);
+  g_ns_index.valid = false;
   return ns_instance->resource;
 }
 
@@ -775,6 +862,7 @@ free_ns_instance(oc_resource_t *resource)
 
       /* remove oc_ns_t instance from list */
       oc_list_remove(g_ns_list, ns_instance);
+      g_ns_index.valid = false;
 
       /* free each field of ns_instance */
       oc_free_string(&ns_instance->phref);
@@ -1536,6 +1624,9 @@ post_pushd_rsc(oc_request_t *request, oc_interface_mask_t iface_mask,
               request->resource->types,
               oc_string_array_get_item(rep->value.array, i));
           }
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+          oc_resource_intern_types(request->resource);
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
 
           /*
            * remove rep from list..
@@ -2282,6 +2373,8 @@ oc_push_init(void)
   oc_list_init(g_ns_list);
   oc_list_init(g_recvs_list);
   oc_list_init(g_pushd_rsc_rep_list);
+  oc_list_init(g_push_pending_list);
+  memset(&g_ns_index, 0, sizeof(g_ns_index));
 }
 
 /*
@@ -2290,9 +2383,15 @@ oc_push_init(void)
  * are removed (see oc_main_shutdown())
  * - for push receivers Resource: free in this function
  */
+static void push_pending_free(void);
+static void ns_index_clear(void);
+
 void
 oc_push_free(void)
 {
+  push_pending_free();
+  ns_index_clear();
+
   OC_PUSH_DBG("begin to free push receiver list!!!");
 
   oc_recvs_t *recvs_instance = (oc_recvs_t *)oc_list_pop(g_recvs_list);
@@ -2345,37 +2444,37 @@ response_to_push_rsc(oc_client_response_t *data)
 }
 
 /**
- * @brief send PUSH update request
+ * @brief encoded payload of PUSH update request, shared by all targets of an
+ * update
+ */
+typedef struct
+{
+  uint8_t *buffer;
+  int size; ///< size of the encoded payload, 0 if the payload is not built
+} oc_push_payload_t;
+
+/**
+ * @brief build payload of PUSH update request of source resource
  *
- * @param ns_instance composition of `oic.r.notificationselector` +
- * `oic.r.pushproxy`
+ * @param payload payload to build
+ * @param src_rsc updated pushable Resource
+ * @param href href property of the payload (optional)
  * @return true:success, false:fail
  */
 static bool
-push_update(oc_ns_t *ns_instance)
+push_payload_build(oc_push_payload_t *payload, const oc_resource_t *src_rsc,
+                   const char *href)
 {
-  oc_resource_t *src_rsc = (oc_resource_t *)ns_instance->user_data;
-  if (!ns_instance || !src_rsc) {
-    OC_PUSH_ERR("something wrong! corresponding notification selector source "
-                "resource is NULL, or updated resource is NULL!");
+  uint8_t *buffer = (uint8_t *)malloc((size_t)OC_MIN_APP_DATA_SIZE);
+  if (buffer == NULL) {
+    OC_PUSH_ERR("cannot allocate payload buffer");
     return false;
   }
+  /* the payload is encoded outside of any request, keep the encoder of the
+   * caller */
+  oc_rep_encoder_reset_t prev_encoder = oc_rep_global_encoder_reset(NULL);
+  oc_rep_new_realloc_v1(&buffer, OC_MIN_APP_DATA_SIZE, OC_MAX_APP_DATA_SIZE);
 
-  if (!src_rsc->payload_builder) {
-    OC_PUSH_ERR("payload_builder() of source resource is NULL!");
-    return false;
-  }
-
-  /*
-   * 1. find `notification selector` which monitors `src_rsc` from `ns_col_list`
-   * 2. post UPDATE by using URI, endpoint (use oc_sting_to_endpoint())
-   */
-  if (!oc_init_post(oc_string(ns_instance->targetpath),
-                    &ns_instance->pushtarget_ep, "if=oic.if.rw",
-                    &response_to_push_rsc, HIGH_QOS, ns_instance)) {
-    OC_PUSH_ERR("Could not init POST");
-    return false;
-  }
   /*
    * add other properties than "rep" object of "oic.r.pushpayload" Resource
    * here. payload_builder() only "rep" object.
@@ -2388,14 +2487,12 @@ push_update(oc_ns_t *ns_instance)
   /* anchor */
   char di[OC_UUID_LEN + 10];
   snprintf(di, sizeof(di), "ocf://");
-  oc_uuid_to_str(oc_core_get_device_id(ns_instance->resource->device), di + 6,
-                 OC_UUID_LEN);
+  oc_uuid_to_str(oc_core_get_device_id(src_rsc->device), di + 6, OC_UUID_LEN);
   oc_rep_set_text_string(root, anchor, di);
 
   /* href (optional) */
-  if (oc_string(ns_instance->phref) &&
-      strcmp(oc_string(ns_instance->phref), "") != 0) {
-    oc_rep_set_text_string(root, href, oc_string(ns_instance->phref));
+  if (href != NULL) {
+    oc_rep_set_text_string(root, href, href);
   }
 
   /* rt */
@@ -2415,6 +2512,64 @@ push_update(oc_ns_t *ns_instance)
 
   oc_rep_end_root_object();
 
+  buffer = oc_rep_shrink_encoder_buf(buffer);
+  int size = oc_rep_get_encoded_payload_size();
+  CborError err = oc_rep_get_cbor_errno();
+  oc_rep_global_encoder_reset(&prev_encoder);
+  if (err != CborNoError || size <= 0) {
+    OC_PUSH_ERR("cannot encode payload of \"%s\" (error: %d)",
+                oc_string(src_rsc->uri), (int)err);
+    free(buffer);
+    return false;
+  }
+  payload->buffer = buffer;
+  payload->size = size;
+  return true;
+}
+
+/**
+ * @brief free payload of PUSH update request
+ */
+static void
+push_payload_free(oc_push_payload_t *payload)
+{
+  free(payload->buffer);
+  payload->buffer = NULL;
+  payload->size = 0;
+}
+
+/**
+ * @brief send PUSH update request
+ *
+ * @param ns_instance composition of `oic.r.notificationselector` +
+ * `oic.r.pushproxy`
+ * @param payload encoded payload of the updated resource
+ * @return true:success, false:fail
+ */
+static bool
+push_update(oc_ns_t *ns_instance, const oc_push_payload_t *payload)
+{
+  oc_resource_t *src_rsc = (oc_resource_t *)ns_instance->user_data;
+  if (!ns_instance || !src_rsc) {
+    OC_PUSH_ERR("something wrong! corresponding notification selector source "
+                "resource is NULL, or updated resource is NULL!");
+    return false;
+  }
+
+  /*
+   * 1. find `notification selector` which monitors `src_rsc` from `ns_col_list`
+   * 2. post UPDATE by using URI, endpoint (use oc_sting_to_endpoint())
+   */
+  if (!oc_init_post(oc_string(ns_instance->targetpath),
+                    &ns_instance->pushtarget_ep, "if=oic.if.rw",
+                    &response_to_push_rsc, HIGH_QOS, ns_instance)) {
+    OC_PUSH_ERR("Could not init POST");
+    return false;
+  }
+
+  /* the payload is shared by all targets of the update */
+  oc_rep_encode_raw(payload->buffer, (size_t)payload->size);
+
   if (!oc_do_post()) {
     OC_PUSH_ERR("Could not send POST");
     return false;
@@ -2569,9 +2724,346 @@ _check_string_array_inclusion(oc_string_array_t *target,
   return false;
 }
 
+/**
+ * @brief check if updated Resource matches notification selector
+ *
+ * @details
+ * each of phref, prt and pif that exists in the selector must match the
+ * Resource, a selector without any of them matches nothing
+ *
+ * @param ns_instance notification selector
+ * @param resource updated Resource
+ * @return true:matched, false:not matched
+ */
+static bool
+ns_matches_resource(oc_ns_t *ns_instance, oc_resource_t *resource)
+{
+  const char *uri = oc_string(resource->uri);
+  char all_matched = 0x7;
+
+  if (ns_instance->resource->device != resource->device) {
+    return false;
+  }
+
+  /* if push proxy is not in "wait for update" state, just skip it... */
+  if (strcmp(oc_string(ns_instance->state), pp_statestr(OC_PP_WFU)) != 0) {
+    return false;
+  }
+
+  if (oc_string(ns_instance->phref)) {
+    if (strcmp(oc_string(ns_instance->phref), uri) != 0) {
+      OC_PUSH_DBG("%s:phref exists, but mismatches (phref:%s - uri:%s)",
+                  oc_string(ns_instance->resource->uri),
+                  oc_string(ns_instance->phref), uri);
+      return false;
+    }
+    OC_PUSH_DBG("%s:phref matches (phref:%s - uri:%s)",
+                oc_string(ns_instance->resource->uri),
+                oc_string(ns_instance->phref), uri);
+  } else {
+    OC_PUSH_DBG("%s:phref does not exist",
+                oc_string(ns_instance->resource->uri));
+    all_matched &= 0x6;
+  }
+
+  if (oc_string_array_get_allocated_size(ns_instance->prt) > 0) {
+    bool prt_matched =
+      _check_string_array_inclusion(&ns_instance->prt, &resource->types);
+#ifdef OC_PUSHDEBUG
+    OC_PUSH_PRINT("%s:prt %s (prt: [", oc_string(ns_instance->resource->uri),
+                  prt_matched ? "matches" : "exists, but mismatches");
+    for (size_t i = 0; i < oc_string_array_get_allocated_size(ns_instance->prt);
+         i++) {
+      OC_PUSH_PRINT("%s ", oc_string_array_get_item(ns_instance->prt, i));
+    }
+    OC_PUSH_PRINT("] - rt of updated rsc: [");
+    for (size_t i = 0; i < oc_string_array_get_allocated_size(resource->types);
+         i++) {
+      OC_PUSH_PRINT("%s ", oc_string_array_get_item(resource->types, i));
+    }
+    OC_PUSH_PRINT("])\n");
+#endif
+    if (!prt_matched) {
+      return false;
+    }
+  } else {
+    OC_PUSH_DBG("%s:prt does not exist", oc_string(ns_instance->resource->uri));
+    all_matched &= 0x5;
+  }
+
+  if (oc_string_array_get_allocated_size(ns_instance->pif) > 0) {
+    oc_interface_mask_t pif = 0;
+    for (size_t i = 0; i < oc_string_array_get_allocated_size(ns_instance->pif);
+         i++) {
+      pif |= oc_ri_get_interface_mask(
+        oc_string_array_get_item(ns_instance->pif, i),
+        oc_byte_string_array_get_item_size(ns_instance->pif, i));
+    }
+
+    if (!(pif & resource->interfaces)) {
+      OC_PUSH_DBG(
+        "%s:pif exists, but mismatches (pif:%#x - if of updated rsc:%#x)",
+        oc_string(ns_instance->resource->uri), pif, resource->interfaces);
+      return false;
+    }
+    OC_PUSH_DBG("%s:pif matches (pif:%#x - if of updated rsc:%#x)",
+                oc_string(ns_instance->resource->uri), pif,
+                resource->interfaces);
+  } else {
+    OC_PUSH_DBG("%s:pif does not exist", oc_string(ns_instance->resource->uri));
+    all_matched &= 0x3;
+  }
+
+  return all_matched != 0;
+}
+
+/**
+ * @brief bucket of the notification selector index for (device, key)
+ */
+static size_t
+ns_index_bucket(size_t device, const char *key, size_t key_len)
+{
+  /* FNV-1a */
+  uint32_t hash = 2166136261U;
+  for (size_t i = 0; i < key_len; i++) {
+    hash = (hash ^ (uint8_t)key[i]) * 16777619U;
+  }
+  hash = (hash ^ (uint32_t)device) * 16777619U;
+  return hash % OC_PUSH_NS_INDEX_BUCKETS;
+}
+
+static bool
+ns_index_add(oc_ns_index_entry_t **head, oc_ns_t *ns_instance)
+{
+  oc_ns_index_entry_t *entry =
+    (oc_ns_index_entry_t *)oc_memb_alloc(&g_ns_index_entry_memb);
+  if (entry == NULL) {
+    OC_PUSH_ERR("oc_memb_alloc() error!");
+    return false;
+  }
+  entry->ns_instance = ns_instance;
+  entry->next = *head;
+  *head = entry;
+  return true;
+}
+
+static void
+ns_index_free_list(oc_ns_index_entry_t **head)
+{
+  while (*head != NULL) {
+    oc_ns_index_entry_t *entry = *head;
+    *head = entry->next;
+    oc_memb_free(&g_ns_index_entry_memb, entry);
+  }
+}
+
+static void
+ns_index_clear(void)
+{
+  for (size_t i = 0; i < OC_PUSH_NS_INDEX_BUCKETS; i++) {
+    ns_index_free_list(&g_ns_index.by_href[i]);
+    ns_index_free_list(&g_ns_index.by_rt[i]);
+  }
+  ns_index_free_list(&g_ns_index.by_pif);
+  g_ns_index.valid = false;
+}
+
+static bool
+ns_index_add_selector(oc_ns_t *ns_instance)
+{
+  size_t device = ns_instance->resource->device;
+  if (oc_string(ns_instance->phref)) {
+    size_t bucket = ns_index_bucket(device, oc_string(ns_instance->phref),
+                                    oc_string_len(ns_instance->phref));
+    return ns_index_add(&g_ns_index.by_href[bucket], ns_instance);
+  }
+  size_t prt_len = oc_string_array_get_allocated_size(ns_instance->prt);
+  if (prt_len > 0) {
+    for (size_t i = 0; i < prt_len; i++) {
+      size_t rt_len = oc_string_array_get_item_size(ns_instance->prt, i);
+      if (rt_len == 0) {
+        continue;
+      }
+      size_t bucket = ns_index_bucket(
+        device, oc_string_array_get_item(ns_instance->prt, i), rt_len);
+      if (!ns_index_add(&g_ns_index.by_rt[bucket], ns_instance)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  if (oc_string_array_get_allocated_size(ns_instance->pif) > 0) {
+    return ns_index_add(&g_ns_index.by_pif, ns_instance);
+  }
+  /* selector without phref, prt and pif matches nothing */
+  return true;
+}
+
+/**
+ * @brief build the notification selector index from `g_ns_list`
+ */
+static bool
+ns_index_build(void)
+{
+  if (g_ns_index.valid) {
+    return true;
+  }
+  ns_index_clear();
+  for (oc_ns_t *ns_instance = (oc_ns_t *)oc_list_head(g_ns_list);
+       ns_instance != NULL; ns_instance = ns_instance->next) {
+    if (!ns_index_add_selector(ns_instance)) {
+      ns_index_clear();
+      return false;
+    }
+  }
+  g_ns_index.valid = true;
+  return true;
+}
+
+/**
+ * @brief push update of Resource to target of notification selector, the
+ * payload is built on the first use
+ *
+ * @param ns_instance notification selector
+ * @param resource updated Resource
+ * @param payloads payloads without and with href
+ */
+static void
+push_update_selector(oc_ns_t *ns_instance, oc_resource_t *resource,
+                     oc_push_payload_t payloads[2])
+{
+  /* selectors indexed in several buckets are visited once per update */
+  if (ns_instance->update_id == g_push_update_id) {
+    return;
+  }
+  ns_instance->update_id = g_push_update_id;
+  if (!ns_matches_resource(ns_instance, resource)) {
+    return;
+  }
+
+  OC_PUSH_DBG("resource \"%s\" matches notification selector \"%s\"!",
+              oc_string(resource->uri), oc_string(ns_instance->resource->uri));
+
+  /* matched phref equals to uri of the resource, so there are only two
+   * variants of the payload */
+  bool has_href = oc_string_len(ns_instance->phref) > 0;
+  oc_push_payload_t *payload = &payloads[has_href ? 1 : 0];
+  if (payload->size == 0 &&
+      !push_payload_build(payload, resource,
+                          has_href ? oc_string(resource->uri) : NULL)) {
+    return;
+  }
+
+  /* resource is necessary to identify which resource is being pushed..,
+   * before sending update to target server */
+  ns_instance->user_data = resource;
+
+#ifdef OC_TEST
+  if (g_push_update_cb != NULL) {
+    g_push_update_cb(ns_instance->resource, resource, g_push_update_cb_data);
+    return;
+  }
+#endif /* OC_TEST */
+
+  if (!push_update(ns_instance, payload)) {
+    OC_PUSH_ERR("sensing PUSH Update of \"%s\" failed!",
+                oc_string(resource->uri));
+  }
+}
+
+static void
+push_update_list(oc_ns_index_entry_t *entry, oc_resource_t *resource,
+                 oc_push_payload_t payloads[2])
+{
+  for (; entry != NULL; entry = entry->next) {
+    push_update_selector(entry->ns_instance, resource, payloads);
+  }
+}
+
+/**
+ * @brief push update of Resource to targets of all matching notification
+ * selectors
+ */
+static void
+push_resource_update(oc_resource_t *resource)
+{
+  if (!ns_index_build()) {
+    OC_PUSH_ERR("cannot build notification selector index");
+    return;
+  }
+  ++g_push_update_id;
+  if (g_push_update_id == 0) {
+    /* 0 is the initial id of selectors */
+    ++g_push_update_id;
+  }
+
+  oc_push_payload_t payloads[2];
+  memset(payloads, 0, sizeof(payloads));
+  size_t device = resource->device;
+
+  size_t bucket = ns_index_bucket(device, oc_string(resource->uri),
+                                  oc_string_len(resource->uri));
+  push_update_list(g_ns_index.by_href[bucket], resource, payloads);
+
+  for (size_t i = 0; i < oc_string_array_get_allocated_size(resource->types);
+       i++) {
+    bucket =
+      ns_index_bucket(device, oc_string_array_get_item(resource->types, i),
+                      oc_string_array_get_item_size(resource->types, i));
+    push_update_list(g_ns_index.by_rt[bucket], resource, payloads);
+  }
+
+  push_update_list(g_ns_index.by_pif, resource, payloads);
+
+  push_payload_free(&payloads[0]);
+  push_payload_free(&payloads[1]);
+}
+
+/**
+ * @brief push all pushable Resources updated since the last push
+ */
+static oc_event_callback_retval_t
+push_pending_updates_async(void *data)
+{
+  (void)data;
+  oc_push_pending_t *pending =
+    (oc_push_pending_t *)oc_list_pop(g_push_pending_list);
+  while (pending != NULL) {
+    /* the resource could have been deleted in the meantime */
+    oc_resource_t *resource = oc_ri_get_app_resource_by_uri(
+      oc_string(pending->uri), oc_string_len(pending->uri), pending->device);
+    if (resource != NULL && (resource->properties & OC_PUSHABLE) != 0 &&
+        resource->payload_builder != NULL &&
+        oc_process_is_running(&oc_push_process)) {
+      push_resource_update(resource);
+    }
+    oc_free_string(&pending->uri);
+    oc_memb_free(&g_push_pending_memb, pending);
+    pending = (oc_push_pending_t *)oc_list_pop(g_push_pending_list);
+  }
+  return OC_EVENT_DONE;
+}
+
+static void
+push_pending_free(void)
+{
+  oc_remove_delayed_callback(NULL, push_pending_updates_async);
+  oc_push_pending_t *pending =
+    (oc_push_pending_t *)oc_list_pop(g_push_pending_list);
+  while (pending != NULL) {
+    oc_free_string(&pending->uri);
+    oc_memb_free(&g_push_pending_memb, pending);
+    pending = (oc_push_pending_t *)oc_list_pop(g_push_pending_list);
+  }
+}
+
 /**
  * @brief trigger PUSH procedure
  *
+ * @details
+ * updates of the same Resource within OC_PUSH_COALESCE_DELAY_MS are pushed
+ * once, with the state of the Resource at the time of the push
+ *
  * @param uri path of updated Resource
  * @param device_index device index which the updated Resource belongs to
  */
@@ -2580,8 +3072,6 @@ oc_resource_state_changed(const char *uri, size_t uri_len, size_t device_index)
 {
   oc_resource_t *resource =
     oc_ri_get_app_resource_by_uri(uri, uri_len, device_index);
-  oc_ns_t *ns_instance = (oc_ns_t *)oc_list_head(g_ns_list);
-  char all_matched = 0x7;
 
   OC_PUSH_DBG("resource \"%s\"@device(%zu) is updated!", uri, device_index);
 
@@ -2595,122 +3085,81 @@ oc_resource_state_changed(const char *uri, size_t uri_len, size_t device_index)
                 device_index);
     return;
   }
+  if (!resource->payload_builder) {
+    OC_PUSH_ERR("payload_builder() of source resource is NULL!");
+    return;
+  }
+  if (!oc_process_is_running(&oc_push_process)) {
+    OC_PUSH_DBG("oc_push_process is not running!");
+    return;
+  }
 
-  for (; ns_instance; ns_instance = ns_instance->next) {
-    if (ns_instance->resource->device != device_index)
-      continue;
-
-    /* if push proxy is not in "wait for update" state, just skip it... */
-    if (strcmp(oc_string(ns_instance->state), pp_statestr(OC_PP_WFU)) != 0)
-      continue;
-
-    if (oc_string(ns_instance->phref)) {
-      if (strcmp(oc_string(ns_instance->phref), uri) != 0) {
-        OC_PUSH_DBG("%s:phref exists, but mismatches (phref:%s - uri:%s)",
-                    oc_string(ns_instance->resource->uri),
-                    oc_string(ns_instance->phref), uri);
-        all_matched = 0;
-      } else {
-        OC_PUSH_DBG("%s:phref matches (phref:%s - uri:%s)",
-                    oc_string(ns_instance->resource->uri),
-                    oc_string(ns_instance->phref), uri);
-      }
-    } else {
-      OC_PUSH_DBG("%s:phref does not exist",
-                  oc_string(ns_instance->resource->uri));
-      all_matched &= 0x6;
-    }
-
-    if (oc_string_array_get_allocated_size(ns_instance->prt) > 0) {
-      if (!_check_string_array_inclusion(&ns_instance->prt, &resource->types)) {
-#ifdef OC_PUSHDEBUG
-        OC_PUSH_PRINT("%s:prt exists, but mismatches (prt: [",
-                      oc_string(ns_instance->resource->uri));
-        for (size_t i = 0;
-             i < oc_string_array_get_allocated_size(ns_instance->prt); i++) {
-          OC_PUSH_PRINT("%s ", oc_string_array_get_item(ns_instance->prt, i));
-        }
-        OC_PUSH_PRINT("] - rt of updated rsc: [");
-        for (size_t i = 0;
-             i < oc_string_array_get_allocated_size(resource->types); i++) {
-          OC_PUSH_PRINT("%s ", oc_string_array_get_item(resource->types, i));
-        }
-        OC_PUSH_PRINT("])\n");
-#endif
-        all_matched = 0;
-      } else {
-#ifdef OC_PUSHDEBUG
-        OC_PUSH_PRINT("%s:prt matches (prt: [",
-                      oc_string(ns_instance->resource->uri));
-        for (size_t i = 0;
-             i < oc_string_array_get_allocated_size(ns_instance->prt); i++) {
-          OC_PUSH_PRINT("%s ", oc_string_array_get_item(ns_instance->prt, i));
-        }
-        OC_PUSH_PRINT("] - rt of updated rsc: [");
-        for (size_t i = 0;
-             i < oc_string_array_get_allocated_size(resource->types); i++) {
-          OC_PUSH_PRINT("%s ", oc_string_array_get_item(resource->types, i));
-        }
-        OC_PUSH_PRINT("])\n");
-#endif
-      }
-    } else {
-      OC_PUSH_DBG("%s:prt does not exist",
-                  oc_string(ns_instance->resource->uri));
-      all_matched &= 0x5;
-    }
-
-    if (oc_string_array_get_allocated_size(ns_instance->pif) > 0) {
-      oc_interface_mask_t pif = 0;
-      for (size_t i = 0;
-           i < oc_string_array_get_allocated_size(ns_instance->pif); i++) {
-        pif |= oc_ri_get_interface_mask(
-          oc_string_array_get_item(ns_instance->pif, i),
-          oc_byte_string_array_get_item_size(ns_instance->pif, i));
-      }
-
-      if (!(pif & resource->interfaces)) {
-        OC_PUSH_DBG(
-          "%s:pif exists, but mismatches (pif:%#x - if of updated rsc:%#x)",
-          oc_string(ns_instance->resource->uri), pif, resource->interfaces);
-        all_matched = 0;
-      } else {
-        OC_PUSH_DBG("%s:pif matches (pif:%#x - if of updated rsc:%#x)",
-                    oc_string(ns_instance->resource->uri), pif,
-                    resource->interfaces);
-      }
-    } else {
-      OC_PUSH_DBG("%s:pif does not exist",
-                  oc_string(ns_instance->resource->uri));
-      all_matched &= 0x3;
+  for (oc_push_pending_t *pending =
+         (oc_push_pending_t *)oc_list_head(g_push_pending_list);
+       pending != NULL; pending = pending->next) {
+    if (pending->device == device_index &&
+        oc_string_is_cstr_equal(&pending->uri, oc_string(resource->uri),
+                                oc_string_len(resource->uri))) {
+      OC_PUSH_DBG("update of \"%s\"@device(%zu) is already pending", uri,
+                  device_index);
+      return;
     }
+  }
 
-    if (all_matched) {
-      if (!oc_process_is_running(&oc_push_process)) {
-        OC_PUSH_DBG("oc_push_process is not running!");
-        return;
-      }
+  oc_push_pending_t *pending =
+    (oc_push_pending_t *)oc_memb_alloc(&g_push_pending_memb);
+  if (pending == NULL) {
+    OC_PUSH_ERR("oc_memb_alloc() error!");
+    return;
+  }
+  oc_new_string(&pending->uri, oc_string(resource->uri),
+                oc_string_len(resource->uri));
+  pending->device = device_index;
+  oc_list_add(g_push_pending_list, pending);
+
+  if (!oc_has_delayed_callback(NULL, push_pending_updates_async, false)) {
+    oc_set_delayed_callback_ms_v1(NULL, push_pending_updates_async,
+                                  OC_PUSH_COALESCE_DELAY_MS);
+  }
+}
 
-      OC_PUSH_DBG("resource \"%s\" matches notification selector \"%s\"!",
-                  oc_string(resource->uri),
-                  oc_string(ns_instance->resource->uri));
+#ifdef OC_TEST
 
-      /* resource is necessary to identify which resource is being pushed..,
-       * before sending update to target server */
-      ns_instance->user_data = resource;
+void
+oc_push_set_update_cb(oc_push_update_cb_t cb, void *data)
+{
+  g_push_update_cb = cb;
+  g_push_update_cb_data = data;
+}
 
-      /* post "event" for Resource which has just been updated */
-      if (!push_update(ns_instance)) {
-        OC_PUSH_ERR("sensing PUSH Update of \"%s\" failed!",
-                    oc_string(resource->uri));
-      }
-#if 0
-      oc_process_post(&oc_push_process,
-          oc_event_to_oc_process_event(PUSH_RSC_STATE_CHANGED), ns_instance);
-#endif
-    }
-    all_matched = 0x7;
+oc_resource_t *
+oc_push_create_notification_selector(size_t device, const char *href,
+                                     const oc_rep_t *rep)
+{
+  oc_string_array_t types;
+  oc_new_string_array(&types, 2);
+  oc_string_array_add_item(types, "oic.r.notificationselector");
+  oc_string_array_add_item(types, "oic.r.pushproxy");
+  oc_resource_t *resource = get_ns_instance(
+    href, &types, OC_DISCOVERABLE | OC_OBSERVABLE,
+    OC_IF_RW | OC_IF_BASELINE, device);
+  oc_free_string_array(&types);
+  if (resource == NULL) {
+    return NULL;
   }
+  if (!set_ns_properties(resource, rep, resource->set_properties.user_data)) {
+    free_ns_instance(resource);
+    return NULL;
+  }
+  return resource;
 }
 
+void
+oc_push_delete_notification_selector(oc_resource_t *resource)
+{
+  free_ns_instance(resource);
+}
+
+#endif /* OC_TEST */
+
 #endif /* OC_HAS_FEATURE_PUSH */
@@ -23,6 +23,9 @@
 #ifndef OC_PUSH_INTERNAL_H
 #define OC_PUSH_INTERNAL_H
 
+#include "oc_rep.h"
+#include "oc_ri.h"
+
 #include <stddef.h>
 
 #ifdef __cplusplus
@@ -37,6 +40,40 @@ void oc_create_pushconf_resource(size_t device_index);
 
 void oc_create_pushreceiver_resource(size_t device_index);
 
+#ifdef OC_TEST
+/**
+ * @brief callback invoked instead of sending PUSH update request
+ *
+ * @param ns_resource matched notification selector
+ * @param resource updated pushable Resource
+ * @param data user data
+ */
+typedef void (*oc_push_update_cb_t)(const oc_resource_t *ns_resource,
+                                    const oc_resource_t *resource, void *data);
+
+/** @brief set callback invoked instead of sending PUSH update request (NULL
+ * restores sending) */
+void oc_push_set_update_cb(oc_push_update_cb_t cb, void *data);
+
+/**
+ * @brief create notification selector + push proxy Resource and set its
+ * properties, same as created by a POST to the push configuration Resource
+ *
+ * @param device device index
+ * @param href path of the new Resource
+ * @param rep properties of the new Resource
+ * @return new Resource on success
+ * @return NULL on failure
+ */
+oc_resource_t *oc_push_create_notification_selector(size_t device,
+                                                    const char *href,
+                                                    const oc_rep_t *rep);
+
+/** @brief delete notification selector created by
+ * oc_push_create_notification_selector */
+void oc_push_delete_notification_selector(oc_resource_t *resource);
+#endif /* OC_TEST */
+
 #ifdef __cplusplus
 }
 #endif
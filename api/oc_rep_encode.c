@@ -411,14 +411,27 @@ oc_rep_encoder_remaining_size(oc_rep_encoder_t *encoder)
   return (long)(encoder->buffer.size - (size_t)encoder->ctx.data.ptr);
 }
 
-CborError
-oc_rep_encoder_write_raw(oc_rep_encoder_t *encoder, const uint8_t *data,
-                         size_t len)
+long
+oc_rep_encoder_container_offset(const oc_rep_encoder_t *encoder,
+                                const CborEncoder *container)
 {
-  long remaining = oc_rep_encoder_remaining_size(encoder);
-  if (remaining < 0) {
+  if (encoder->buffer.ptr == NULL || container->end == NULL) {
+    return -1;
+  }
+  assert(encoder->buffer.size >= (size_t)container->data.ptr);
+  return (long)(size_t)container->data.ptr;
+}
+
+static CborError
+rep_encoder_write_raw(oc_rep_encoder_t *encoder, CborEncoder *subEncoder,
+                      const uint8_t *data, size_t len)
+{
+  long offset = oc_rep_encoder_container_offset(encoder, subEncoder);
+  if (offset < 0) {
+    OC_WRN("encoder has not set end pointer.");
     return CborErrorInternalError;
   }
+  long remaining = (long)(encoder->buffer.size - (size_t)offset);
   if ((size_t)remaining < len) {
 #ifdef OC_DYNAMIC_ALLOCATION
     if (!encoder->buffer.enable_realloc) {
@@ -427,13 +440,13 @@ oc_rep_encoder_write_raw(oc_rep_encoder_t *encoder, const uint8_t *data,
       return CborErrorOutOfMemory;
     }
     CborEncoder prevEncoder;
-    memcpy(&prevEncoder, &encoder->ctx, sizeof(prevEncoder));
+    memcpy(&prevEncoder, subEncoder, sizeof(prevEncoder));
     size_t needed = len - remaining;
     CborError err = rep_buffer_realloc(encoder, needed);
     if (err != CborNoError) {
       return err;
     }
-    memcpy(&encoder->ctx, &prevEncoder, sizeof(prevEncoder));
+    memcpy(subEncoder, &prevEncoder, sizeof(prevEncoder));
 #else  /* OC_DYNAMIC_ALLOCATION */
     OC_WRN("Insufficient memory: Increase OC_MAX_APP_DATA_SIZE to "
            "accomodate a larger payload(+%lu)",
@@ -441,14 +454,29 @@ oc_rep_encoder_write_raw(oc_rep_encoder_t *encoder, const uint8_t *data,
     return CborErrorOutOfMemory;
 #endif /* !OC_DYNAMIC_ALLOCATION */
   }
-  oc_rep_encoder_convert_offset_to_ptr(encoder, &encoder->ctx);
-  memcpy(encoder->ctx.data.ptr, data, len);
+  oc_rep_encoder_convert_offset_to_ptr(encoder, subEncoder);
+  memcpy(subEncoder->data.ptr, data, len);
   // TODO: this is not correct for crc encoder, add write raw interface function
-  encoder->ctx.data.ptr = encoder->ctx.data.ptr + len;
-  oc_rep_encoder_convert_ptr_to_offset(encoder, &encoder->ctx);
+  subEncoder->data.ptr = subEncoder->data.ptr + len;
+  oc_rep_encoder_convert_ptr_to_offset(encoder, subEncoder);
   return CborNoError;
 }
 
+CborError
+oc_rep_encoder_write_raw(oc_rep_encoder_t *encoder, const uint8_t *data,
+                         size_t len)
+{
+  return rep_encoder_write_raw(encoder, &encoder->ctx, data, len);
+}
+
+CborError
+oc_rep_encoder_write_raw_to_container(oc_rep_encoder_t *encoder,
+                                      CborEncoder *container,
+                                      const uint8_t *data, size_t len)
+{
+  return rep_encoder_write_raw(encoder, container, data, len);
+}
+
 void
 oc_rep_encode_raw(const uint8_t *data, size_t len)
 {
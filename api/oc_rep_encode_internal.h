@@ -231,6 +231,24 @@ CborError oc_rep_encoder_write_raw(oc_rep_encoder_t *encoder,
                                    const uint8_t *data, size_t len)
   OC_NONNULL(1);
 
+/** @brief Write raw data to an open container of the encoder */
+CborError oc_rep_encoder_write_raw_to_container(oc_rep_encoder_t *encoder,
+                                                CborEncoder *container,
+                                                const uint8_t *data,
+                                                size_t len) OC_NONNULL(1, 2);
+
+/**
+ * @brief Get the offset of the write position of an open container in the
+ * encoder buffer.
+ *
+ * @param encoder the encoder (cannot be NULL)
+ * @param container the open container (cannot be NULL)
+ * @return >=0 offset of the write position
+ * @return -1 if the buffer is not set or the encoder is out of memory
+ */
+long oc_rep_encoder_container_offset(const oc_rep_encoder_t *encoder,
+                                     const CborEncoder *container) OC_NONNULL();
+
 /** @brief Write null representation to encoder */
 CborError oc_rep_encoder_write_null(oc_rep_encoder_t *encoder,
                                     CborEncoder *subEncoder) OC_NONNULL();
@@ -17,6 +17,7 @@
  ****************************************************************************/
 
 #include "api/oc_core_res_internal.h"
+#include "api/oc_discovery_cache_internal.h"
 #include "api/oc_enums_internal.h"
 #include "api/oc_ri_internal.h"
 #include "oc_api.h"
@@ -27,6 +28,10 @@
 #include "port/oc_log_internal.h"
 #include "util/oc_numeric_internal.h"
 
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+#include "util/oc_atom_internal.h"
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
+
 #ifdef OC_COLLECTIONS
 #include "api/oc_collection_internal.h"
 #endif /* OC_COLLECTIONS */
@@ -34,6 +39,8 @@
 #include <assert.h>
 #include <float.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 bool
 oc_resource_is_initialized(const oc_resource_t *resource)
@@ -50,6 +57,78 @@ oc_resource_supports_interface(const oc_resource_t *resource,
   return (resource->interfaces & iface) == iface;
 }
 
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+void
+oc_resource_intern_types(oc_resource_t *resource)
+{
+  oc_resource_free_types_atoms(resource);
+  size_t num_types = oc_string_array_get_allocated_size(resource->types);
+  if (num_types == 0) {
+    return;
+  }
+  oc_atom_t *atoms = (oc_atom_t *)calloc(num_types, sizeof(oc_atom_t));
+  if (atoms == NULL) {
+    OC_WRN("insufficient memory to intern resource types");
+    return;
+  }
+  for (size_t i = 0; i < num_types; ++i) {
+    size_t size = oc_string_array_get_item_size(resource->types, i);
+    if (size == 0) {
+      continue;
+    }
+    const char *t = (const char *)oc_string_array_get_item(resource->types, i);
+    atoms[i] = oc_atom_intern(t, size);
+    if (atoms[i] == OC_ATOM_NONE) {
+      OC_WRN("insufficient memory to intern resource types");
+      free(atoms);
+      return;
+    }
+  }
+  resource->types_atoms = atoms;
+}
+
+void
+oc_resource_free_types_atoms(oc_resource_t *resource)
+{
+  free(resource->types_atoms);
+  resource->types_atoms = NULL;
+}
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
+
+bool
+oc_resource_has_type(const oc_resource_t *resource, oc_string_view_t rt)
+{
+  assert(resource != NULL);
+  if (rt.length == 0) {
+    return false;
+  }
+  size_t num_types = oc_string_array_get_allocated_size(resource->types);
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+  if (resource->types_atoms != NULL) {
+    // all types of the resource are interned, so a string without an atom is
+    // not one of them
+    oc_atom_t atom = oc_atom_find(rt.data, rt.length);
+    if (atom == OC_ATOM_NONE) {
+      return false;
+    }
+    for (size_t i = 0; i < num_types; ++i) {
+      if (resource->types_atoms[i] == atom) {
+        return true;
+      }
+    }
+    return false;
+  }
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
+  for (size_t i = 0; i < num_types; ++i) {
+    size_t size = oc_string_array_get_item_size(resource->types, i);
+    const char *t = (const char *)oc_string_array_get_item(resource->types, i);
+    if (rt.length == size && memcmp(rt.data, t, size) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool
 oc_resource_get_method_handler(const oc_resource_t *resource,
                                oc_method_t method,
@@ -197,6 +276,7 @@ void
 oc_resource_tag_pos_desc(oc_resource_t *resource, oc_pos_description_t pos)
 {
   resource->tag_pos_desc = pos;
+  oc_discovery_cache_invalidate();
 }
 
 void
@@ -205,6 +285,7 @@ oc_resource_tag_pos_rel(oc_resource_t *resource, double x, double y, double z)
   resource->tag_pos_rel[0] = x;
   resource->tag_pos_rel[1] = y;
   resource->tag_pos_rel[2] = z;
+  oc_discovery_cache_invalidate();
 }
 
 bool
@@ -218,12 +299,14 @@ void
 oc_resource_tag_func_desc(oc_resource_t *resource, oc_enum_t func)
 {
   resource->tag_func_desc = func;
+  oc_discovery_cache_invalidate();
 }
 
 void
 oc_resource_tag_locn(oc_resource_t *resource, oc_locn_t locn)
 {
   resource->tag_locn = locn;
+  oc_discovery_cache_invalidate();
 }
 
 static void
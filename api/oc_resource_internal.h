@@ -59,6 +59,39 @@ bool oc_resource_match_uri(oc_string_view_t canonicalURI, oc_string_view_t uri);
 bool oc_resource_supports_interface(const oc_resource_t *resource,
                                     oc_interface_mask_t iface) OC_NONNULL();
 
+/**
+ * @brief Check if resource has given resource type.
+ *
+ * The interned types of the resource are compared if they are available.
+ *
+ * @param resource resource to check (cannot be NULL)
+ * @param rt resource type to check
+ * @return true resource has given resource type
+ * @return false resource does not have given resource type
+ */
+bool oc_resource_has_type(const oc_resource_t *resource, oc_string_view_t rt)
+  OC_NONNULL();
+
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+/**
+ * @brief Intern the resource types of the resource.
+ *
+ * Must be called whenever the types of the resource change. On allocation
+ * failure the resource is left without interned types and the types are
+ * compared as strings.
+ *
+ * @param resource resource to update (cannot be NULL)
+ */
+void oc_resource_intern_types(oc_resource_t *resource) OC_NONNULL();
+
+/**
+ * @brief Deallocate the interned resource types of the resource.
+ *
+ * @param resource resource to update (cannot be NULL)
+ */
+void oc_resource_free_types_atoms(oc_resource_t *resource) OC_NONNULL();
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
+
 /**
  * @brief Get resource request handler for given method.
  *
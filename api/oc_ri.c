@@ -16,12 +16,14 @@
  *
  ***************************************************************************/
 
+#include "api/oc_discovery_cache_internal.h"
 #include "api/oc_discovery_internal.h"
 #include "api/oc_endpoint_internal.h"
 #include "api/oc_event_callback_internal.h"
 #include "api/oc_events_internal.h"
 #include "api/oc_etag_internal.h"
 #include "api/oc_message_buffer_internal.h"
+#include "api/oc_metrics_internal.h"
 #include "api/oc_network_events_internal.h"
 #include "api/oc_rep_encode_internal.h"
 #include "api/oc_rep_decode_internal.h"
@@ -29,6 +31,7 @@
 #include "api/oc_resource_internal.h"
 #include "api/oc_ri_internal.h"
 #include "api/oc_ri_preparsed_request_internal.h"
+#include "api/oc_tracepoint_internal.h"
 #include "messaging/coap/coap_internal.h"
 #include "messaging/coap/options_internal.h"
 #include "messaging/coap/constants.h"
@@ -568,28 +571,25 @@ ri_delete_resource(oc_resource_t *resource, bool notify)
   bool needsBatchDispatch = false;
 #endif /* OC_RES_BATCH_SUPPORT && OC_DISCOVERY_RESOURCE_OBSERVABLE */
   // remove the resource from the collections
-  oc_collection_t *collection =
-    oc_get_next_collection_with_link(resource, NULL);
-  while (collection != NULL) {
-    oc_link_t *link = oc_get_link_by_uri(collection, oc_string(resource->uri),
-                                         oc_string_len(resource->uri));
-    if (link != NULL) {
-      if (oc_collection_remove_link_and_notify(
-            &collection->res, link, notify,
-            /*discoveryBatchDispatch*/ false)) {
+  oc_link_t *link = oc_get_next_collection_link(resource, NULL);
+  while (link != NULL) {
+    oc_link_t *next = oc_get_next_collection_link(resource, link);
+    if (oc_collection_remove_link_and_notify(&link->collection->res, link,
+                                             notify,
+                                             /*discoveryBatchDispatch*/ false)) {
 #if defined(OC_RES_BATCH_SUPPORT) && defined(OC_DISCOVERY_RESOURCE_OBSERVABLE)
-        needsBatchDispatch = true;
+      needsBatchDispatch = true;
 #endif /* OC_RES_BATCH_SUPPORT && OC_DISCOVERY_RESOURCE_OBSERVABLE */
-      }
-      oc_delete_link(link);
     }
-    collection = oc_get_next_collection_with_link(resource, collection);
+    oc_delete_link(link);
+    link = next;
   }
 #endif /* OC_COLLECTIONS */
 
   bool removed = oc_list_remove2(g_app_resources, resource) != NULL;
   removed =
     oc_list_remove2(g_app_resources_to_be_deleted, resource) != NULL || removed;
+  oc_discovery_cache_invalidate();
 
   oc_remove_delayed_callback(resource, oc_delayed_delete_resource_cb);
   oc_notify_clear(resource);
@@ -668,6 +668,7 @@ oc_ri_add_resource(oc_resource_t *resource)
   }
 
   oc_list_add(g_app_resources, resource);
+  oc_discovery_cache_invalidate();
   oc_notify_resource_added(resource);
   return true;
 }
@@ -698,6 +699,9 @@ oc_ri_free_resource_properties(oc_resource_t *resource)
   if (oc_string_array_get_allocated_size(resource->types) > 0) {
     oc_free_string_array(&(resource->types));
   }
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+  oc_resource_free_types_atoms(resource);
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
 }
 
 oc_interface_mask_t
@@ -1394,9 +1398,11 @@ ri_invoke_handler(coap_make_response_ctx_t *ctx,
 
     /* Process a request against a valid resource, request payload, and
      * interface. */
+    OC_TRACEPOINT_REQUEST(OC_TRACEPOINT_HANDLER_BEGIN, in->method);
     oc_status_t ret = ri_invoke_request_handler(
       in->preparsed_request_obj->cur_resource, in->method, in->request_obj,
       in->iface_mask, get_resource_is_collection(in->preparsed_request_obj));
+    OC_TRACEPOINT_REQUEST(OC_TRACEPOINT_HANDLER_END, ret);
     switch (ret) {
     case OC_STATUS_OK:
       break;
@@ -1610,13 +1616,18 @@ ri_parse_coap_request_header(coap_make_response_ctx_t *ctx,
   }
 
 #ifdef OC_SECURITY
-  if (cur_resource && !oc_sec_check_acl(method, cur_resource, endpoint)) {
+  if (cur_resource != NULL) {
     /* If resource is a coaps:// resource, then query ACL to check if
      * the requestor (the subject) is authorized to issue this request to
      * the resource.
      */
-    oc_ri_audit_log(method, cur_resource, endpoint);
-    bitmask_code |= BITMASK_CODE_UNAUTHORIZED;
+    bool granted = oc_sec_check_acl(method, cur_resource, endpoint);
+    OC_TRACEPOINT_REQUEST(OC_TRACEPOINT_ACL, granted ? 1 : 0);
+    if (!granted) {
+      oc_ri_audit_log(method, cur_resource, endpoint);
+      OC_METRICS_INCREMENT(OC_METRIC_ACL_DENIED);
+      bitmask_code |= BITMASK_CODE_UNAUTHORIZED;
+    }
   }
 #endif /* OC_SECURITY */
 
@@ -1956,4 +1967,8 @@ oc_ri_shutdown(void)
 
   ri_delete_all_app_resources();
 #endif /* OC_SERVER */
+
+#ifdef OC_HAS_FEATURE_DISCOVERY_CACHE
+  oc_discovery_cache_clear();
+#endif /* OC_HAS_FEATURE_DISCOVERY_CACHE */
 }
@@ -16,6 +16,7 @@
  *
  ****************************************************************************/
 
+#include "api/oc_message_internal.h"
 #include "api/oc_rep_internal.h"
 #include "oc_runtime_internal.h"
 #include "port/oc_allocator_internal.h"
@@ -40,4 +41,7 @@ oc_runtime_shutdown(void)
   oc_allocator_mutex_destroy();
 #endif /* OC_HAS_FEATURE_ALLOCATOR_MUTEX */
   oc_random_destroy();
+#ifdef OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER
+  oc_message_buffer_pools_clear();
+#endif /* OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER */
 }
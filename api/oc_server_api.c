@@ -17,10 +17,12 @@
  ****************************************************************************/
 
 #include "api/oc_core_res_internal.h"
+#include "api/oc_discovery_cache_internal.h"
 #include "api/oc_main_internal.h"
 #include "api/oc_message_internal.h"
 #include "api/oc_platform_internal.h"
 #include "api/oc_rep_internal.h"
+#include "api/oc_resource_internal.h"
 #include "api/oc_ri_internal.h"
 #include "api/oc_server_api_internal.h"
 #include "messaging/coap/options_internal.h"
@@ -445,6 +447,7 @@ oc_resource_bind_resource_interface(oc_resource_t *resource,
                                     oc_interface_mask_t iface_mask)
 {
   resource->interfaces |= iface_mask;
+  oc_discovery_cache_invalidate();
 }
 
 void
@@ -457,7 +460,14 @@ oc_resource_set_default_interface(oc_resource_t *resource,
 void
 oc_resource_bind_resource_type(oc_resource_t *resource, const char *type)
 {
+  if (oc_resource_has_type(resource, oc_string_view(type, strlen(type)))) {
+    return;
+  }
   oc_string_array_add_item(resource->types, type);
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+  oc_resource_intern_types(resource);
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
+  oc_discovery_cache_invalidate();
 }
 
 #ifdef OC_SECURITY
@@ -465,6 +475,7 @@ void
 oc_resource_make_public(oc_resource_t *resource)
 {
   resource->properties &= ~OC_SECURE;
+  oc_discovery_cache_invalidate();
 }
 #endif /* OC_SECURITY */
 
@@ -475,6 +486,7 @@ oc_resource_set_discoverable(oc_resource_t *resource, bool state)
     resource->properties |= OC_DISCOVERABLE;
   else
     resource->properties &= ~OC_DISCOVERABLE;
+  oc_discovery_cache_invalidate();
 }
 
 #ifdef OC_HAS_FEATURE_PUSH
@@ -485,6 +497,7 @@ oc_resource_set_pushable(oc_resource_t *resource, bool state)
     resource->properties |= OC_PUSHABLE;
   else
     resource->properties &= ~OC_PUSHABLE;
+  oc_discovery_cache_invalidate();
 }
 #endif /* OC_HAS_FEATURE_PUSH */
 
@@ -495,6 +508,7 @@ oc_resource_set_observable(oc_resource_t *resource, bool state)
     resource->properties |= OC_OBSERVABLE;
   else
     resource->properties &= ~(OC_OBSERVABLE | OC_PERIODIC);
+  oc_discovery_cache_invalidate();
 }
 
 void
@@ -502,6 +516,7 @@ oc_resource_set_periodic_observable(oc_resource_t *resource, uint16_t seconds)
 {
   resource->properties |= OC_OBSERVABLE | OC_PERIODIC;
   resource->observe_period_seconds = seconds;
+  oc_discovery_cache_invalidate();
 }
 
 static oc_request_handler_t *
@@ -544,6 +559,7 @@ oc_resource_set_secure_mcast(oc_resource_t *resource, bool supported)
     } else {
       resource->properties &= ~OC_SECURE_MCAST;
     }
+    oc_discovery_cache_invalidate();
   }
 }
 #endif /* OC_OSCORE */
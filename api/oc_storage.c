@@ -23,6 +23,7 @@
 #include "api/oc_rep_decode_internal.h"
 #include "api/oc_rep_internal.h"
 #include "oc_storage_internal.h"
+#include "oc_storage_snapshot_internal.h"
 #include "port/oc_connectivity.h"
 #include "port/oc_log_internal.h"
 #include "port/oc_storage.h"
@@ -101,6 +102,27 @@ oc_storage_free_buffer(oc_storage_buffer_t sb)
 #endif /* OC_APP_DATA_STORAGE_BUFFER */
 }
 
+static long
+storage_data_decode(const char *name, size_t device, const uint8_t *data,
+                    size_t size, oc_decode_from_storage_fn_t decode,
+                    void *decode_data)
+{
+#if !OC_ERR_IS_ENABLED
+  (void)name;
+#endif /* !OC_ERR_IS_ENABLED */
+  long ret = (long)size;
+  OC_MEMB_LOCAL(rep_objects, oc_rep_t, OC_MAX_NUM_REP_OBJECTS);
+  oc_memb_t *prev_rep_objects = oc_rep_reset_pool(&rep_objects);
+  oc_rep_t *rep = oc_parse_rep(data, size);
+  if (rep != NULL && decode(rep, device, decode_data) != 0) {
+    OC_ERR("cannot load from \"%s\" from store: cannot decode data", name);
+    ret = -1;
+  }
+  oc_free_rep(rep);
+  oc_rep_set_pool(prev_rep_objects);
+  return ret;
+}
+
 long
 oc_storage_data_load(const char *name, size_t device,
                      oc_decode_from_storage_fn_t decode, void *decode_data)
@@ -112,6 +134,16 @@ oc_storage_data_load(const char *name, size_t device,
     return -1;
   }
 
+#ifdef OC_HAS_FEATURE_STORAGE_SNAPSHOT
+  size_t snapshot_size = 0;
+  const uint8_t *snapshot_data =
+    oc_storage_snapshot_find(svr_tag, &snapshot_size);
+  if (snapshot_data != NULL) {
+    return storage_data_decode(name, device, snapshot_data, snapshot_size,
+                               decode, decode_data);
+  }
+#endif /* OC_HAS_FEATURE_STORAGE_SNAPSHOT */
+
   oc_storage_buffer_t buf = oc_storage_get_buffer(OC_MAX_APP_DATA_SIZE);
 #ifndef OC_APP_DATA_STORAGE_BUFFER
   if (buf.buffer == NULL) {
@@ -132,15 +164,14 @@ oc_storage_data_load(const char *name, size_t device,
     oc_storage_free_buffer(buf);
     return -1;
   }
-  OC_MEMB_LOCAL(rep_objects, oc_rep_t, OC_MAX_NUM_REP_OBJECTS);
-  oc_memb_t *prev_rep_objects = oc_rep_reset_pool(&rep_objects);
-  oc_rep_t *rep = oc_parse_rep(buf.buffer, (size_t)ret);
-  if (rep != NULL && decode(rep, device, decode_data) != 0) {
-    OC_ERR("cannot load from \"%s\" from store: cannot decode data", name);
-    ret = -1;
+  long size = ret;
+  ret = storage_data_decode(name, device, buf.buffer, (size_t)size, decode,
+                            decode_data);
+#ifdef OC_HAS_FEATURE_STORAGE_SNAPSHOT
+  if (ret >= 0) {
+    oc_storage_snapshot_loaded(svr_tag, buf.buffer, (size_t)size);
   }
-  oc_free_rep(rep);
-  oc_rep_set_pool(prev_rep_objects);
+#endif /* OC_HAS_FEATURE_STORAGE_SNAPSHOT */
   oc_storage_free_buffer(buf);
   return ret;
 }
@@ -224,7 +255,14 @@ oc_storage_data_save(const char *name, size_t device,
     OC_ERR("cannot dump \"%s\" to storage: cannot generate svr tag", name);
     goto error;
   }
+#ifdef OC_HAS_FEATURE_STORAGE_SNAPSHOT
+  oc_storage_snapshot_invalidate(svr_tag);
+#endif /* OC_HAS_FEATURE_STORAGE_SNAPSHOT */
   long ret = oc_storage_write(svr_tag, sb.buffer, size);
+#ifdef OC_HAS_FEATURE_STORAGE_SNAPSHOT
+  oc_storage_snapshot_written(svr_tag, ret >= 0 ? sb.buffer : NULL,
+                              (size_t)size);
+#endif /* OC_HAS_FEATURE_STORAGE_SNAPSHOT */
   oc_storage_free_buffer(sb);
   return ret;
 
@@ -241,6 +279,10 @@ oc_storage_data_clear(const char *name, size_t device)
     OC_ERR("cannot clear \"%s\" from store: cannot generate svr tag", name);
     return false;
   }
+#ifdef OC_HAS_FEATURE_STORAGE_SNAPSHOT
+  oc_storage_snapshot_invalidate(svr_tag);
+  oc_storage_snapshot_written(svr_tag, NULL, 0);
+#endif /* OC_HAS_FEATURE_STORAGE_SNAPSHOT */
   return oc_storage_write(svr_tag, (const uint8_t *)"", 0) == 0;
 }
 
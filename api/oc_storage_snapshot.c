@@ -0,0 +1,489 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "oc_config.h"
+#include "util/oc_features.h"
+
+#ifdef OC_HAS_FEATURE_STORAGE_SNAPSHOT
+
+#include "api/oc_storage_internal.h"
+#include "api/oc_storage_snapshot_internal.h"
+#include "port/oc_log_internal.h"
+#include "port/oc_storage.h"
+#include "port/oc_storage_internal.h"
+#include "util/oc_crc_internal.h"
+#include "util/oc_secure_string_internal.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SNAPSHOT_MAGIC "OCSS"
+#define SNAPSHOT_MAGIC_SIZE (4)
+#define SNAPSHOT_HEADER_SIZE (SNAPSHOT_MAGIC_SIZE + 2 + 2 + 4)
+// tag length, data size and CRC64
+#define SNAPSHOT_SECTION_OVERHEAD (1 + 4 + 8)
+
+typedef struct
+{
+  char tag[OC_STORAGE_SVR_TAG_MAX];
+  const uint8_t *data; ///< NULL if the section was removed
+  uint8_t *owned;      ///< copy of data not backed by the snapshot
+  size_t size;
+  uint64_t crc;
+  bool verified; ///< the checksum was verified or computed from the data
+} snapshot_section_t;
+
+typedef struct
+{
+  const uint8_t *buf; ///< content of the stored snapshot
+  size_t buf_size;
+  bool mapped; ///< buf is mapped by oc_storage_map, otherwise allocated
+  snapshot_section_t *sections;
+  size_t num_sections;
+  size_t capacity;
+  size_t cursor; ///< sections are usually looked up in the stored order
+  bool active;
+  bool dirty;   ///< the stored snapshot must be rewritten
+  bool invalid; ///< the stored snapshot is truncated or doesn't exist
+} snapshot_t;
+
+static snapshot_t g_snapshot = { 0 };
+
+static uint16_t
+snapshot_read_u16(const uint8_t *p)
+{
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t
+snapshot_read_u32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static uint64_t
+snapshot_read_u64(const uint8_t *p)
+{
+  return (uint64_t)snapshot_read_u32(p) |
+         ((uint64_t)snapshot_read_u32(p + 4) << 32);
+}
+
+static uint8_t *
+snapshot_write_u16(uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  return p + 2;
+}
+
+static uint8_t *
+snapshot_write_u32(uint8_t *p, uint32_t v)
+{
+  for (int i = 0; i < 4; ++i) {
+    p[i] = (uint8_t)(v >> (8 * i));
+  }
+  return p + 4;
+}
+
+static uint8_t *
+snapshot_write_u64(uint8_t *p, uint64_t v)
+{
+  p = snapshot_write_u32(p, (uint32_t)v);
+  return snapshot_write_u32(p, (uint32_t)(v >> 32));
+}
+
+static snapshot_section_t *
+snapshot_add_section(const char *tag, size_t tag_len)
+{
+  if (tag_len == 0 || tag_len >= OC_STORAGE_SVR_TAG_MAX) {
+    return NULL;
+  }
+  if (g_snapshot.num_sections == g_snapshot.capacity) {
+    size_t capacity = g_snapshot.capacity == 0 ? 16 : g_snapshot.capacity * 2;
+    snapshot_section_t *sections = (snapshot_section_t *)realloc(
+      g_snapshot.sections, capacity * sizeof(snapshot_section_t));
+    if (sections == NULL) {
+      OC_ERR("cannot allocate snapshot sections");
+      return NULL;
+    }
+    g_snapshot.sections = sections;
+    g_snapshot.capacity = capacity;
+  }
+  snapshot_section_t *section = &g_snapshot.sections[g_snapshot.num_sections];
+  memset(section, 0, sizeof(snapshot_section_t));
+  memcpy(section->tag, tag, tag_len);
+  section->tag[tag_len] = '\0';
+  ++g_snapshot.num_sections;
+  return section;
+}
+
+static snapshot_section_t *
+snapshot_get_section(const char *tag)
+{
+  size_t n = g_snapshot.num_sections;
+  for (size_t i = 0; i < n; ++i) {
+    size_t index = (g_snapshot.cursor + i) % n;
+    snapshot_section_t *section = &g_snapshot.sections[index];
+    if (strcmp(section->tag, tag) == 0) {
+      g_snapshot.cursor = index + 1;
+      return section;
+    }
+  }
+  return NULL;
+}
+
+static void
+snapshot_free_sections(void)
+{
+  for (size_t i = 0; i < g_snapshot.num_sections; ++i) {
+    free(g_snapshot.sections[i].owned);
+  }
+  free(g_snapshot.sections);
+  g_snapshot.sections = NULL;
+  g_snapshot.num_sections = 0;
+  g_snapshot.capacity = 0;
+  g_snapshot.cursor = 0;
+}
+
+static void
+snapshot_free_buffer(void)
+{
+  if (g_snapshot.buf == NULL) {
+    return;
+  }
+  if (g_snapshot.mapped) {
+    oc_storage_unmap(g_snapshot.buf, g_snapshot.buf_size);
+  } else {
+    free((void *)g_snapshot.buf);
+  }
+  g_snapshot.buf = NULL;
+  g_snapshot.buf_size = 0;
+  g_snapshot.mapped = false;
+}
+
+static bool
+snapshot_read(void)
+{
+  size_t size = 0;
+  const uint8_t *buf = oc_storage_map(OC_STORAGE_SNAPSHOT_STORE_NAME, &size);
+  if (buf != NULL) {
+    g_snapshot.buf = buf;
+    g_snapshot.buf_size = size;
+    g_snapshot.mapped = true;
+    return true;
+  }
+  long ret = oc_storage_size(OC_STORAGE_SNAPSHOT_STORE_NAME);
+  if (ret <= 0) {
+    return false;
+  }
+  uint8_t *data = (uint8_t *)malloc((size_t)ret);
+  if (data == NULL) {
+    OC_ERR("cannot allocate buffer for snapshot");
+    return false;
+  }
+  ret = oc_storage_read(OC_STORAGE_SNAPSHOT_STORE_NAME, data, (size_t)ret);
+  if (ret <= 0) {
+    free(data);
+    return false;
+  }
+  g_snapshot.buf = data;
+  g_snapshot.buf_size = (size_t)ret;
+  g_snapshot.mapped = false;
+  return true;
+}
+
+static bool
+snapshot_parse(void)
+{
+  const uint8_t *p = g_snapshot.buf;
+  const uint8_t *end = g_snapshot.buf + g_snapshot.buf_size;
+  if (g_snapshot.buf_size < SNAPSHOT_HEADER_SIZE ||
+      memcmp(p, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) != 0) {
+    OC_ERR("invalid snapshot header");
+    return false;
+  }
+  p += SNAPSHOT_MAGIC_SIZE;
+  uint16_t version = snapshot_read_u16(p);
+  if (version != OC_STORAGE_SNAPSHOT_VERSION) {
+    OC_WRN("unsupported snapshot version(%u)", (unsigned)version);
+    return false;
+  }
+  p += 2 + 2;
+  uint32_t count = snapshot_read_u32(p);
+  p += 4;
+  for (uint32_t i = 0; i < count; ++i) {
+    if ((size_t)(end - p) < SNAPSHOT_SECTION_OVERHEAD) {
+      OC_ERR("snapshot section(%u) is truncated", (unsigned)i);
+      return false;
+    }
+    size_t tag_len = *p++;
+    if ((size_t)(end - p) < tag_len + SNAPSHOT_SECTION_OVERHEAD - 1) {
+      OC_ERR("snapshot section(%u) is truncated", (unsigned)i);
+      return false;
+    }
+    const char *tag = (const char *)p;
+    p += tag_len;
+    size_t size = snapshot_read_u32(p);
+    p += 4;
+    uint64_t crc = snapshot_read_u64(p);
+    p += 8;
+    if ((size_t)(end - p) < size) {
+      OC_ERR("snapshot section(%u) is truncated", (unsigned)i);
+      return false;
+    }
+    snapshot_section_t *section = snapshot_add_section(tag, tag_len);
+    if (section == NULL) {
+      return false;
+    }
+    section->data = p;
+    section->size = size;
+    section->crc = crc;
+    p += size;
+  }
+  return true;
+}
+
+void
+oc_storage_snapshot_begin(void)
+{
+  if (g_snapshot.active || !oc_storage_path(NULL, 0)) {
+    return;
+  }
+  g_snapshot.active = true;
+  g_snapshot.dirty = false;
+  if (!snapshot_read()) {
+    OC_DBG("snapshot not found");
+    g_snapshot.invalid = true;
+    return;
+  }
+  g_snapshot.invalid = false;
+  if (!snapshot_parse()) {
+    // the per-tag stores are used and the snapshot is rewritten
+    snapshot_free_sections();
+    g_snapshot.dirty = true;
+    return;
+  }
+  OC_DBG("snapshot opened: sections=%zu size=%zu", g_snapshot.num_sections,
+         g_snapshot.buf_size);
+}
+
+static uint8_t *
+snapshot_encode(size_t *size)
+{
+  uint32_t count = 0;
+  size_t total = SNAPSHOT_HEADER_SIZE;
+  for (size_t i = 0; i < g_snapshot.num_sections; ++i) {
+    const snapshot_section_t *section = &g_snapshot.sections[i];
+    if (section->data == NULL) {
+      continue;
+    }
+    total += SNAPSHOT_SECTION_OVERHEAD + strlen(section->tag) + section->size;
+    ++count;
+  }
+  uint8_t *buf = (uint8_t *)malloc(total);
+  if (buf == NULL) {
+    OC_ERR("cannot allocate buffer for snapshot");
+    return NULL;
+  }
+  uint8_t *p = buf;
+  memcpy(p, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+  p += SNAPSHOT_MAGIC_SIZE;
+  p = snapshot_write_u16(p, OC_STORAGE_SNAPSHOT_VERSION);
+  p = snapshot_write_u16(p, 0);
+  p = snapshot_write_u32(p, count);
+  for (size_t i = 0; i < g_snapshot.num_sections; ++i) {
+    snapshot_section_t *section = &g_snapshot.sections[i];
+    if (section->data == NULL) {
+      continue;
+    }
+    if (!section->verified) {
+      section->crc = oc_crc64(0, section->data, section->size);
+    }
+    size_t tag_len = strlen(section->tag);
+    *p++ = (uint8_t)tag_len;
+    memcpy(p, section->tag, tag_len);
+    p += tag_len;
+    p = snapshot_write_u32(p, (uint32_t)section->size);
+    p = snapshot_write_u64(p, section->crc);
+    memcpy(p, section->data, section->size);
+    p += section->size;
+  }
+  assert((size_t)(p - buf) == total);
+  *size = total;
+  return buf;
+}
+
+void
+oc_storage_snapshot_end(void)
+{
+  if (!g_snapshot.active) {
+    return;
+  }
+  g_snapshot.active = false;
+  if (g_snapshot.dirty || g_snapshot.invalid) {
+    size_t size = 0;
+    // the sections may point to the stored snapshot, so it is released after
+    // the encoding
+    uint8_t *buf = snapshot_encode(&size);
+    snapshot_free_buffer();
+    if (buf != NULL) {
+      long ret = oc_storage_write(OC_STORAGE_SNAPSHOT_STORE_NAME, buf, size);
+      if (ret < 0) {
+        OC_ERR("cannot write snapshot: error(%ld)", ret);
+      } else {
+        g_snapshot.invalid = false;
+        OC_DBG("snapshot written: size=%zu", size);
+      }
+      free(buf);
+    }
+  }
+  snapshot_free_buffer();
+  snapshot_free_sections();
+  g_snapshot.dirty = false;
+}
+
+const uint8_t *
+oc_storage_snapshot_find(const char *svr_tag, size_t *size)
+{
+  if (!g_snapshot.active) {
+    return NULL;
+  }
+  snapshot_section_t *section = snapshot_get_section(svr_tag);
+  if (section == NULL || section->data == NULL) {
+    return NULL;
+  }
+  if (!section->verified) {
+    if (oc_crc64(0, section->data, section->size) != section->crc) {
+      OC_ERR("invalid checksum of snapshot section \"%s\"", svr_tag);
+      section->data = NULL;
+      g_snapshot.dirty = true;
+      return NULL;
+    }
+    section->verified = true;
+  }
+  *size = section->size;
+  return section->data;
+}
+
+static void
+snapshot_set_section(const char *svr_tag, const uint8_t *data, size_t size)
+{
+  snapshot_section_t *section = snapshot_get_section(svr_tag);
+  if (section == NULL) {
+    if (data == NULL) {
+      return;
+    }
+    section = snapshot_add_section(
+      svr_tag, oc_strnlen(svr_tag, OC_STORAGE_SVR_TAG_MAX));
+    if (section == NULL) {
+      return;
+    }
+  }
+  g_snapshot.dirty = true;
+  free(section->owned);
+  section->owned = NULL;
+  section->data = NULL;
+  section->size = 0;
+  section->verified = false;
+  if (data == NULL || size == 0) {
+    return;
+  }
+  section->owned = (uint8_t *)malloc(size);
+  if (section->owned == NULL) {
+    OC_ERR("cannot allocate snapshot section \"%s\"", svr_tag);
+    return;
+  }
+  memcpy(section->owned, data, size);
+  section->data = section->owned;
+  section->size = size;
+}
+
+void
+oc_storage_snapshot_loaded(const char *svr_tag, const uint8_t *data,
+                           size_t size)
+{
+  if (!g_snapshot.active) {
+    return;
+  }
+  snapshot_set_section(svr_tag, data, size);
+}
+
+static void
+snapshot_detach_buffer(void)
+{
+  if (!g_snapshot.mapped) {
+    return;
+  }
+  // truncation of a mapped store invalidates the mapping, so the sections are
+  // moved to a private copy
+  uint8_t *copy = (uint8_t *)malloc(g_snapshot.buf_size);
+  if (copy != NULL) {
+    memcpy(copy, g_snapshot.buf, g_snapshot.buf_size);
+  }
+  for (size_t i = 0; i < g_snapshot.num_sections; ++i) {
+    snapshot_section_t *section = &g_snapshot.sections[i];
+    if (section->data == NULL || section->owned != NULL) {
+      continue;
+    }
+    if (copy == NULL) {
+      section->data = NULL;
+      g_snapshot.dirty = true;
+      continue;
+    }
+    section->data = copy + (section->data - g_snapshot.buf);
+  }
+  size_t size = g_snapshot.buf_size;
+  snapshot_free_buffer();
+  if (copy != NULL) {
+    g_snapshot.buf = copy;
+    g_snapshot.buf_size = size;
+  }
+}
+
+void
+oc_storage_snapshot_invalidate(const char *svr_tag)
+{
+  (void)svr_tag;
+  if (g_snapshot.invalid) {
+    return;
+  }
+  // the snapshot is truncated before the per-tag store is written, so a
+  // failure between the writes cannot leave a stale section
+  snapshot_detach_buffer();
+  if (oc_storage_write(OC_STORAGE_SNAPSHOT_STORE_NAME, (const uint8_t *)"",
+                       0) < 0) {
+    OC_ERR("cannot invalidate snapshot");
+    return;
+  }
+  OC_DBG("snapshot invalidated by \"%s\"", svr_tag);
+  g_snapshot.invalid = true;
+}
+
+void
+oc_storage_snapshot_written(const char *svr_tag, const uint8_t *data,
+                            size_t size)
+{
+  if (!g_snapshot.active) {
+    return;
+  }
+  snapshot_set_section(svr_tag, data, size);
+}
+
+#endif /* OC_HAS_FEATURE_STORAGE_SNAPSHOT */
@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifndef OC_STORAGE_SNAPSHOT_INTERNAL_H
+#define OC_STORAGE_SNAPSHOT_INTERNAL_H
+
+#include "util/oc_compiler.h"
+#include "util/oc_features.h"
+
+#ifdef OC_HAS_FEATURE_STORAGE_SNAPSHOT
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The snapshot is a single store holding the encoded data of the svr tags of
+ * all devices. It is read (memory mapped if the port supports it) at the start
+ * of oc_main_init, so loading of the resources doesn't need to open a store
+ * for each svr tag.
+ *
+ * Layout (little-endian):
+ *   header:  magic "OCSS" | version (u16) | reserved (u16) | sections (u32)
+ *   section: tag length (u8) | tag | data size (u32) | CRC64 of data (u64) |
+ *            data
+ *
+ * The per-tag stores remain the source of truth. The snapshot is truncated
+ * before a per-tag store is written, and it is rewritten at the end of the
+ * load when a section was missing, invalid or changed.
+ */
+
+#define OC_STORAGE_SNAPSHOT_STORE_NAME "svr_snapshot"
+#define OC_STORAGE_SNAPSHOT_VERSION (1)
+
+/**
+ * @brief Open the snapshot, subsequent calls of oc_storage_data_load use the
+ * sections of the snapshot.
+ */
+void oc_storage_snapshot_begin(void);
+
+/**
+ * @brief Close the snapshot and rewrite it if it doesn't match the per-tag
+ * stores.
+ */
+void oc_storage_snapshot_end(void);
+
+/**
+ * @brief Find the section of the svr tag in the opened snapshot.
+ *
+ * @param svr_tag svr tag (cannot be NULL)
+ * @param[out] size size of the data (cannot be NULL)
+ * @return const uint8_t* data of the section with a valid checksum
+ * @return NULL if the snapshot is not opened or it has no valid section of
+ * the svr tag
+ */
+const uint8_t *oc_storage_snapshot_find(const char *svr_tag, size_t *size)
+  OC_NONNULL();
+
+/**
+ * @brief Record data of the svr tag loaded from the per-tag store.
+ *
+ * @param svr_tag svr tag (cannot be NULL)
+ * @param data encoded data (cannot be NULL)
+ * @param size size of the data
+ */
+void oc_storage_snapshot_loaded(const char *svr_tag, const uint8_t *data,
+                                size_t size) OC_NONNULL();
+
+/**
+ * @brief Invalidate the stored snapshot before the per-tag store of the svr
+ * tag is written.
+ *
+ * @param svr_tag svr tag (cannot be NULL)
+ */
+void oc_storage_snapshot_invalidate(const char *svr_tag) OC_NONNULL();
+
+/**
+ * @brief Record data of the svr tag written to the per-tag store.
+ *
+ * @param svr_tag svr tag (cannot be NULL)
+ * @param data written data, NULL if the store was cleared or the write failed
+ * @param size size of the data
+ */
+void oc_storage_snapshot_written(const char *svr_tag, const uint8_t *data,
+                                 size_t size) OC_NONNULL(1);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OC_HAS_FEATURE_STORAGE_SNAPSHOT */
+
+#endif /* OC_STORAGE_SNAPSHOT_INTERNAL_H */
@@ -0,0 +1,221 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifdef OC_TRACEPOINTS
+
+#include "api/oc_tracepoint_internal.h"
+#include "port/oc_clock.h"
+#include "util/oc_atomic.h"
+#include "util/oc_compiler.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+OC_STATIC_ASSERT((OC_TRACEPOINTS_RING_SIZE & (OC_TRACEPOINTS_RING_SIZE - 1)) ==
+                   0,
+                 "OC_TRACEPOINTS_RING_SIZE must be a power of 2");
+
+typedef struct
+{
+  OC_ATOMIC_UINT32_T head; ///< number of records written to the ring
+  oc_tracepoint_record_t records[OC_TRACEPOINTS_RING_SIZE];
+} tracepoint_ring_t;
+
+static tracepoint_ring_t g_rings[OC_TRACEPOINTS_MAX_RINGS];
+static OC_ATOMIC_UINT32_T g_rings_count = 0;
+static OC_ATOMIC_UINT32_T g_lost = 0;
+/* written and read only by the stack thread */
+static uint32_t g_request_key = 0;
+
+#ifdef OC_THREAD_LOCAL
+/* A ring is claimed by the thread on its first record, so a ring normally has a
+ * single writer */
+static OC_THREAD_LOCAL tracepoint_ring_t *g_thread_ring = NULL;
+#endif /* OC_THREAD_LOCAL */
+
+static const char *g_stage_names[OC_TRACEPOINT_STAGE_COUNT] = {
+  [OC_TRACEPOINT_RECEIVE] = "receive",
+  [OC_TRACEPOINT_DECRYPT] = "decrypt",
+  [OC_TRACEPOINT_PARSE] = "parse",
+  [OC_TRACEPOINT_DEDUP] = "dedup",
+  [OC_TRACEPOINT_ACL] = "acl",
+  [OC_TRACEPOINT_HANDLER_BEGIN] = "handler_begin",
+  [OC_TRACEPOINT_HANDLER_END] = "handler_end",
+  [OC_TRACEPOINT_ENCODE] = "encode",
+  [OC_TRACEPOINT_ENCRYPT] = "encrypt",
+  [OC_TRACEPOINT_SEND] = "send",
+};
+
+const char *
+oc_tracepoint_stage_name(oc_tracepoint_stage_t stage)
+{
+  if ((int)stage < 0 || stage >= OC_TRACEPOINT_STAGE_COUNT) {
+    return NULL;
+  }
+  return g_stage_names[stage];
+}
+
+static tracepoint_ring_t *
+tracepoint_thread_ring(void)
+{
+#ifdef OC_THREAD_LOCAL
+  if (g_thread_ring != NULL) {
+    return g_thread_ring;
+  }
+  uint32_t count = OC_ATOMIC_LOAD32(g_rings_count);
+  while (count < OC_TRACEPOINTS_MAX_RINGS) {
+    bool swapped = false;
+    OC_ATOMIC_COMPARE_AND_SWAP32(g_rings_count, count, count + 1, swapped);
+    if (swapped) {
+      g_thread_ring = &g_rings[count];
+      return g_thread_ring;
+    }
+  }
+  return NULL;
+#else  /* !OC_THREAD_LOCAL */
+  // all threads share the first ring
+  OC_ATOMIC_STORE32(g_rings_count, 1);
+  return &g_rings[0];
+#endif /* OC_THREAD_LOCAL */
+}
+
+void
+oc_tracepoint_record(oc_tracepoint_stage_t stage, uint32_t key, uint32_t arg)
+{
+  tracepoint_ring_t *ring = tracepoint_thread_ring();
+  if (ring == NULL) {
+    OC_ATOMIC_INCREMENT32(g_lost);
+    return;
+  }
+  uint32_t seq = OC_ATOMIC_INCREMENT32(ring->head);
+  oc_tracepoint_record_t *record =
+    &ring->records[(seq - 1) & (OC_TRACEPOINTS_RING_SIZE - 1)];
+  // invalidate the record while it is written, the sequence number is
+  // published last
+  OC_ATOMIC_STORE32(record->seq, 0);
+  record->timestamp = (uint64_t)oc_clock_time();
+  record->key = key;
+  record->arg = arg;
+  record->stage = (uint16_t)stage;
+  record->ring = (uint16_t)(ring - g_rings);
+  OC_ATOMIC_STORE32(record->seq, seq);
+}
+
+void
+oc_tracepoint_set_request(uint32_t key)
+{
+  g_request_key = key;
+}
+
+uint32_t
+oc_tracepoint_request(void)
+{
+  return g_request_key;
+}
+
+static bool
+tracepoint_ring_iterate(tracepoint_ring_t *ring,
+                        bool (*fn)(const oc_tracepoint_record_t *, void *),
+                        void *data)
+{
+  uint32_t head = OC_ATOMIC_LOAD32(ring->head);
+  uint32_t start =
+    head > OC_TRACEPOINTS_RING_SIZE ? head - OC_TRACEPOINTS_RING_SIZE : 0;
+  for (uint32_t seq = start + 1; seq <= head; ++seq) {
+    oc_tracepoint_record_t *src =
+      &ring->records[(seq - 1) & (OC_TRACEPOINTS_RING_SIZE - 1)];
+    if (OC_ATOMIC_LOAD32(src->seq) != seq) {
+      continue;
+    }
+    oc_tracepoint_record_t record;
+    memcpy(&record, src, sizeof(record));
+    if (OC_ATOMIC_LOAD32(src->seq) != seq) {
+      // overwritten while copied
+      continue;
+    }
+    record.seq = seq;
+    if (!fn(&record, data)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void
+oc_tracepoint_iterate(bool (*fn)(const oc_tracepoint_record_t *record,
+                                 void *data),
+                      void *data)
+{
+  // unclaimed rings are empty
+  for (size_t i = 0; i < OC_TRACEPOINTS_MAX_RINGS; ++i) {
+    if (!tracepoint_ring_iterate(&g_rings[i], fn, data)) {
+      return;
+    }
+  }
+}
+
+typedef struct
+{
+  oc_tracepoint_write_fn_t write;
+  void *data;
+  bool ok;
+} tracepoint_dump_ctx_t;
+
+static bool
+tracepoint_dump_record(const oc_tracepoint_record_t *record, void *data)
+{
+  tracepoint_dump_ctx_t *ctx = (tracepoint_dump_ctx_t *)data;
+  ctx->ok = ctx->write(record, sizeof(*record), ctx->data);
+  return ctx->ok;
+}
+
+bool
+oc_tracepoint_dump(oc_tracepoint_write_fn_t write, void *data)
+{
+  oc_tracepoint_dump_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, OC_TRACEPOINT_DUMP_MAGIC, sizeof(header.magic));
+  header.version = OC_TRACEPOINT_DUMP_VERSION;
+  header.record_size = (uint16_t)sizeof(oc_tracepoint_record_t);
+  header.ticks_per_second = (uint32_t)OC_CLOCK_SECOND;
+  header.lost = OC_ATOMIC_LOAD32(g_lost);
+  if (!write(&header, sizeof(header), data)) {
+    return false;
+  }
+  tracepoint_dump_ctx_t ctx = { write, data, true };
+  oc_tracepoint_iterate(tracepoint_dump_record, &ctx);
+  return ctx.ok;
+}
+
+void
+oc_tracepoint_clear(void)
+{
+  for (size_t i = 0; i < OC_TRACEPOINTS_MAX_RINGS; ++i) {
+    OC_ATOMIC_STORE32(g_rings[i].head, 0);
+    for (size_t j = 0; j < OC_TRACEPOINTS_RING_SIZE; ++j) {
+      OC_ATOMIC_STORE32(g_rings[i].records[j].seq, 0);
+    }
+  }
+  // rings cached by threads stay usable, a ring can then get more writers,
+  // which is safe because the slots are claimed atomically
+  OC_ATOMIC_STORE32(g_rings_count, 0);
+  OC_ATOMIC_STORE32(g_lost, 0);
+  g_request_key = 0;
+}
+
+#endif /* OC_TRACEPOINTS */
@@ -0,0 +1,76 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifndef OC_TRACEPOINT_INTERNAL_H
+#define OC_TRACEPOINT_INTERNAL_H
+
+#ifdef OC_TRACEPOINTS
+
+#include "oc_tracepoint.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef OC_TRACEPOINTS_RING_SIZE
+/* Number of records of a ring, must be a power of 2 */
+#define OC_TRACEPOINTS_RING_SIZE (1024)
+#endif /* !OC_TRACEPOINTS_RING_SIZE */
+
+#ifndef OC_TRACEPOINTS_MAX_RINGS
+/* Maximal number of threads writing records */
+#define OC_TRACEPOINTS_MAX_RINGS (8)
+#endif /* !OC_TRACEPOINTS_MAX_RINGS */
+
+/** @brief Write a record to the ring of the calling thread */
+void oc_tracepoint_record(oc_tracepoint_stage_t stage, uint32_t key,
+                          uint32_t arg);
+
+/**
+ * @brief Set the key of the request processed by the stack thread, used by
+ * stages without access to the message.
+ */
+void oc_tracepoint_set_request(uint32_t key);
+
+/** @brief Get the key of the request processed by the stack thread */
+uint32_t oc_tracepoint_request(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define OC_TRACEPOINT_KEY(message) ((uint32_t)(uintptr_t)(message))
+#define OC_TRACEPOINT(stage, key, arg)                                         \
+  oc_tracepoint_record(stage, key, (uint32_t)(arg))
+#define OC_TRACEPOINT_REQUEST(stage, arg)                                      \
+  oc_tracepoint_record(stage, oc_tracepoint_request(), (uint32_t)(arg))
+#define OC_TRACEPOINT_SET_REQUEST(key) oc_tracepoint_set_request(key)
+
+#else /* !OC_TRACEPOINTS */
+
+/* The tracepoints are compiled out, arguments are not evaluated */
+#define OC_TRACEPOINT_KEY(message)
+#define OC_TRACEPOINT(stage, key, arg)
+#define OC_TRACEPOINT_REQUEST(stage, arg)
+#define OC_TRACEPOINT_SET_REQUEST(key)
+
+#endif /* OC_TRACEPOINTS */
+
+#endif /* OC_TRACEPOINT_INTERNAL_H */
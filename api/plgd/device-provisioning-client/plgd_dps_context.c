@@ -95,6 +95,7 @@ dps_context_init(plgd_dps_context_t *ctx, size_t device)
   ctx->callbacks.on_cloud_status_change_data = NULL;
   dps_store_init(&ctx->store, dps_on_endpoint_change, ctx);
   ctx->status = 0;
+  ctx->aborted_requests = 0;
   ctx->transient_retry_count = 0;
   dps_pki_init(&ctx->pki);
   dps_cloud_observer_init(&ctx->cloud_observer);
@@ -137,6 +138,7 @@ dps_context_reset(plgd_dps_context_t *ctx)
   dps_store_init(&ctx->store, dps_on_endpoint_change, ctx);
   ctx->last_error = 0;
   ctx->status = 0;
+  ctx->aborted_requests = 0;
   ctx->transient_retry_count = 0;
   oc_set_string(&ctx->certificate_fingerprint.data, NULL, 0);
   ctx->certificate_fingerprint.md_type = MBEDTLS_MD_NONE;
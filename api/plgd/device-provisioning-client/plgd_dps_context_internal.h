@@ -67,6 +67,9 @@ struct plgd_dps_context_t
     certificate_fingerprint; ///< fingerprint of the DPS server certificate or
                              ///< intermediate certificate.
   uint32_t status; ///< provisioning status - bitmask of provisioning steps
+  uint32_t aborted_requests; ///< PLGD_DPS_GET_* flags of concurrent
+                             ///< provisioning requests aborted by a retry, the
+                             ///< responses to them are ignored
   dps_pki_configuration_t pki; ///< pki configuration
   plgd_cloud_status_observer_t
     cloud_observer;     ///< observer for changes of cloud status
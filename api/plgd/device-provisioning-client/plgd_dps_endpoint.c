@@ -25,7 +25,6 @@
 #include "api/oc_tcp_internal.h"  // oc_tcp_get_new_session_id, ...
 #include "oc_api.h"               // oc_close_session
 #include "oc_endpoint.h"          // oc_endpoint_t, oc_string_to_endpoint
-#include "port/oc_connectivity.h" // oc_dns_clear_cache
 #include "security/oc_tls_internal.h" // oc_tls_peer_t, oc_tls_select_cloud_ciphersuite, ...
 
 #include "mbedtls/ssl.h" // MBEDTLS_SSL_IS_SERVER, MBEDTLS_SSL_IS_CLIENT
@@ -43,9 +42,6 @@ dps_endpoint_init(plgd_dps_context_t *ctx, const oc_string_t *ep_str)
     if (ret != 0) {
       memset(ctx->endpoint, 0, sizeof(oc_endpoint_t));
     }
-#ifdef OC_DNS_CACHE
-    oc_dns_clear_cache();
-#endif /* OC_DNS_CACHE */
   }
   return ret;
 }
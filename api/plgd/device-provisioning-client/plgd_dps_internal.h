@@ -44,6 +44,15 @@ extern "C" {
    PLGD_DPS_HAS_CLOUD | PLGD_DPS_GET_CREDENTIALS | PLGD_DPS_HAS_CREDENTIALS |  \
    PLGD_DPS_GET_ACLS | PLGD_DPS_HAS_ACLS | PLGD_DPS_CLOUD_STARTED |            \
    PLGD_DPS_RENEW_CREDENTIALS | PLGD_DPS_TRANSIENT_FAILURE | PLGD_DPS_FAILURE)
+/// Flags of the provisioning steps executed concurrently once the owner is
+/// provisioned: the cloud configuration runs alongside the credentials and the
+/// ACLs
+#define PLGD_DPS_PROVISIONED_CONCURRENT_FLAGS                                  \
+  (PLGD_DPS_GET_CLOUD | PLGD_DPS_HAS_CLOUD | PLGD_DPS_GET_CREDENTIALS |        \
+   PLGD_DPS_HAS_CREDENTIALS | PLGD_DPS_GET_ACLS | PLGD_DPS_HAS_ACLS)
+/// Flags of the requests of the concurrently executed provisioning steps
+#define PLGD_DPS_PROVISIONED_CONCURRENT_REQUEST_FLAGS                          \
+  (PLGD_DPS_GET_CLOUD | PLGD_DPS_GET_CREDENTIALS | PLGD_DPS_GET_ACLS)
 
 static const char kPlgdDpsStatusUninitialized[] = "uninitialized";
 static const char kPlgdDpsStatusInitialized[] = "initialized";
@@ -285,6 +285,7 @@ oc_event_callback_retval_t
 dps_manager_provision_retry_async(void *data)
 {
   plgd_dps_context_t *ctx = (plgd_dps_context_t *)data;
+  dps_provisioning_abort_requests(ctx);
   dps_endpoint_disconnect(ctx);
   // TODO: wait for disconnect, only if really disconnected then continue
   dps_retry_increment(ctx, dps_provision_get_next_action(ctx));
@@ -31,9 +31,11 @@
 #include "plgd_dps_internal.h"
 
 #include "oc_acl.h"
+#include "oc_client_state.h"
 #include "oc_core_res.h"
 #include "oc_store.h"
 #include "security/oc_pstat_internal.h"
+#include "util/oc_macros_internal.h"
 
 #include <stdint.h>
 #include <string.h>
@@ -62,6 +64,46 @@ dps_provisioning_check_response(plgd_dps_context_t *ctx, oc_status_t code,
   return -1;
 }
 
+bool
+dps_provisioning_check_status(uint32_t status, uint32_t required,
+                              uint32_t concurrent)
+{
+  return (status & required) == required &&
+         (status & ~(required | concurrent)) == 0;
+}
+
+bool
+dps_provisioning_is_request_aborted(plgd_dps_context_t *ctx, uint32_t request)
+{
+  if ((ctx->aborted_requests & request) != 0) {
+    ctx->aborted_requests &= ~request;
+    return true;
+  }
+  // another concurrent step has failed and the retry repeats all unfinished
+  // steps
+  return (ctx->status & PLGD_DPS_PROVISIONED_ERROR_FLAGS) != 0 &&
+         (ctx->status & PLGD_DPS_PROVISIONED_CONCURRENT_REQUEST_FLAGS &
+          ~request) != 0;
+}
+
+void
+dps_provisioning_abort_requests(plgd_dps_context_t *ctx)
+{
+  uint32_t requests =
+    ctx->status & PLGD_DPS_PROVISIONED_CONCURRENT_REQUEST_FLAGS;
+  if (requests == 0) {
+    return;
+  }
+  DPS_DBG("abort provisioning requests(%u)", (unsigned)requests);
+  ctx->aborted_requests |= requests;
+  ctx->status &= ~requests;
+  if (ctx->endpoint != NULL && !dps_endpoint_is_empty(ctx->endpoint)) {
+    // invoke the handlers now, so a late response cannot be taken for
+    // the response to a repeated request
+    oc_ri_free_client_cbs_by_endpoint_v1(ctx->endpoint, OC_CANCELLED);
+  }
+}
+
 #if DPS_DBG_IS_ENABLED
 static void
 dps_on_apply_acl(oc_sec_on_apply_acl_data_t acl_data, void *user_data)
@@ -143,6 +185,10 @@ dps_get_acls_handler(oc_client_response_t *data)
 #if DPS_DBG_IS_ENABLED
   dps_print_status("get acls handler: ", ctx->status);
 #endif /* DPS_DBG_IS_ENABLED */
+  if (dps_provisioning_is_request_aborted(ctx, PLGD_DPS_GET_ACLS)) {
+    DPS_DBG("skipping response to aborted get acls request");
+    return;
+  }
   // we check only for PLGD_DPS_FAILURE flag, because retry will be rescheduled
   // if necessary
   if ((ctx->status & (PLGD_DPS_HAS_ACLS | PLGD_DPS_FAILURE)) ==
@@ -156,9 +202,11 @@ dps_get_acls_handler(oc_client_response_t *data)
   ctx->status &= ~PLGD_DPS_PROVISIONED_ERROR_FLAGS;
 
   const uint32_t expected_status = PLGD_DPS_INITIALIZED | PLGD_DPS_HAS_TIME |
-                                   PLGD_DPS_HAS_OWNER | PLGD_DPS_HAS_CLOUD |
+                                   PLGD_DPS_HAS_OWNER |
                                    PLGD_DPS_HAS_CREDENTIALS | PLGD_DPS_GET_ACLS;
-  if (ctx->status != expected_status) {
+  // cloud configuration is provisioned concurrently
+  if (!dps_provisioning_check_status(ctx->status, expected_status,
+                                     PLGD_DPS_GET_CLOUD | PLGD_DPS_HAS_CLOUD)) {
 #if DPS_ERR_IS_ENABLED
     // GCOVR_EXCL_START
     char str[256]; // NOLINT
@@ -190,7 +238,7 @@ dps_get_acls_handler(oc_client_response_t *data)
   dps_retry_reset(ctx, dps_provision_get_next_action(ctx));
   ctx->transient_retry_count = 0;
 
-  // go to next step -> start cloud
+  // go to next step -> start cloud when the cloud configuration is set
   dps_provisioning_schedule_next_step(ctx);
   return;
 
@@ -235,6 +283,10 @@ dps_get_credentials_handler(oc_client_response_t *data)
 #if DPS_DBG_IS_ENABLED
   dps_print_status("get credentials handler: ", ctx->status);
 #endif /* DPS_DBG_IS_ENABLED */
+  if (dps_provisioning_is_request_aborted(ctx, PLGD_DPS_GET_CREDENTIALS)) {
+    DPS_DBG("skipping response to aborted get credentials request");
+    return;
+  }
   // we check only for PLGD_DPS_FAILURE flag, because retry will be rescheduled
   // if necessary
   if ((ctx->status & (PLGD_DPS_HAS_CREDENTIALS | PLGD_DPS_FAILURE)) ==
@@ -248,9 +300,11 @@ dps_get_credentials_handler(oc_client_response_t *data)
   ctx->status &= ~PLGD_DPS_PROVISIONED_ERROR_FLAGS;
 
   const uint32_t expected_status = PLGD_DPS_INITIALIZED | PLGD_DPS_HAS_TIME |
-                                   PLGD_DPS_HAS_OWNER | PLGD_DPS_HAS_CLOUD |
+                                   PLGD_DPS_HAS_OWNER |
                                    PLGD_DPS_GET_CREDENTIALS;
-  if (ctx->status != expected_status) {
+  // cloud configuration is provisioned concurrently
+  if (!dps_provisioning_check_status(ctx->status, expected_status,
+                                     PLGD_DPS_GET_CLOUD | PLGD_DPS_HAS_CLOUD)) {
 #if DPS_ERR_IS_ENABLED
     // GCOVR_EXCL_START
     char str[256]; // NOLINT
@@ -389,6 +443,55 @@ dps_provision_next_step_acls(plgd_dps_context_t *ctx)
   return true;
 }
 
+typedef struct
+{
+  uint32_t request;  ///< PLGD_DPS_GET_* flag of the step
+  uint32_t result;   ///< PLGD_DPS_HAS_* flag of the step
+  uint32_t requires; ///< PLGD_DPS_HAS_* flags of steps that must finish first
+  bool (*execute)(plgd_dps_context_t *ctx);
+} dps_provision_step_t;
+
+// A step is executed as soon as the steps it requires are finished, so the
+// cloud configuration is requested alongside the credentials and the ACLs over
+// the session established by the owner step. The identity certificate chain of
+// the credentials is selected again if the cloud configuration is set last (see
+// dps_handle_set_cloud_response).
+static const dps_provision_step_t g_dps_provision_steps[] = {
+  { PLGD_DPS_GET_TIME, PLGD_DPS_HAS_TIME, 0, dps_provision_next_step_time },
+  { PLGD_DPS_GET_OWNER, PLGD_DPS_HAS_OWNER, PLGD_DPS_HAS_TIME,
+    dps_provision_next_step_owner },
+  { PLGD_DPS_GET_CLOUD, PLGD_DPS_HAS_CLOUD, PLGD_DPS_HAS_OWNER,
+    dps_provision_next_step_cloud_configuration },
+  { PLGD_DPS_GET_CREDENTIALS, PLGD_DPS_HAS_CREDENTIALS, PLGD_DPS_HAS_OWNER,
+    dps_provision_next_step_credentials },
+  { PLGD_DPS_GET_ACLS, PLGD_DPS_HAS_ACLS, PLGD_DPS_HAS_CREDENTIALS,
+    dps_provision_next_step_acls },
+};
+
+static bool
+dps_provision_execute_steps(plgd_dps_context_t *ctx)
+{
+  for (size_t i = 0; i < OC_ARRAY_SIZE(g_dps_provision_steps); ++i) {
+    const dps_provision_step_t *step = &g_dps_provision_steps[i];
+    if ((ctx->status & step->result) != 0 ||
+        (ctx->status & step->requires) != step->requires) {
+      continue;
+    }
+    if ((ctx->status & step->request &
+         PLGD_DPS_PROVISIONED_CONCURRENT_REQUEST_FLAGS) != 0) {
+      // waiting for the response
+      continue;
+    }
+    ctx->aborted_requests &= ~step->request;
+    if (!step->execute(ctx)) {
+      // the retry repeats all unfinished steps
+      dps_provisioning_abort_requests(ctx);
+      return false;
+    }
+  }
+  return true;
+}
+
 enum {
   DPS_START_CLOUD_OK = 0,
   DPS_START_CLOUD_MISSING_CERTIFICATES = -1,
@@ -445,28 +548,9 @@ dps_provision_next_step_async(void *user_data)
   bool failure = false;
   bool missing_certificates = false;
 
-  if ((ctx->status & PLGD_DPS_HAS_TIME) == 0) {
-    failure = !dps_provision_next_step_time(ctx);
-    goto finish;
-  }
-
-  if ((ctx->status & PLGD_DPS_HAS_OWNER) == 0) {
-    failure = !dps_provision_next_step_owner(ctx);
-    goto finish;
-  }
-
-  if ((ctx->status & PLGD_DPS_HAS_CLOUD) == 0) {
-    failure = !dps_provision_next_step_cloud_configuration(ctx);
-    goto finish;
-  }
-
-  if ((ctx->status & PLGD_DPS_HAS_CREDENTIALS) == 0) {
-    failure = !dps_provision_next_step_credentials(ctx);
-    goto finish;
-  }
-
-  if ((ctx->status & PLGD_DPS_HAS_ACLS) == 0) {
-    failure = !dps_provision_next_step_acls(ctx);
+  if ((ctx->status & PLGD_DPS_PROVISIONED_MASK) !=
+      PLGD_DPS_PROVISIONED_MASK) {
+    failure = !dps_provision_execute_steps(ctx);
     goto finish;
   }
 
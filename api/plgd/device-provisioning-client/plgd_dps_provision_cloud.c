@@ -237,6 +237,16 @@ dps_handle_set_cloud_response(oc_client_response_t *data)
     return PLGD_DPS_ERROR_SET_CLOUD;
   }
   dps_cloud_add_servers(cloud_ctx, cloud.ci_servers);
+
+  // the credentials are provisioned concurrently, if they were set first then
+  // the identity certificate chain selected by them was cleared with the old
+  // cloud configuration
+  if ((ctx->status & PLGD_DPS_HAS_CREDENTIALS) != 0 &&
+      !dps_try_set_identity_chain(ctx->device)) {
+    DPS_ERR("failed to set identity certificate chain for device(%zu)",
+            ctx->device);
+    return PLGD_DPS_ERROR_SET_CLOUD;
+  }
   return PLGD_DPS_OK;
 }
 
@@ -260,6 +270,10 @@ dps_set_cloud_handler(oc_client_response_t *data)
 #if DPS_DBG_IS_ENABLED
   dps_print_status("set cloud handler: ", ctx->status);
 #endif /* DPS_DBG_IS_ENABLED */
+  if (dps_provisioning_is_request_aborted(ctx, PLGD_DPS_GET_CLOUD)) {
+    DPS_DBG("skipping response to aborted set cloud request");
+    return;
+  }
   // we check only for PLGD_DPS_FAILURE flag, because retry will be rescheduled
   // if necessary
   if ((ctx->status & (PLGD_DPS_HAS_CLOUD | PLGD_DPS_FAILURE)) ==
@@ -276,7 +290,11 @@ dps_set_cloud_handler(oc_client_response_t *data)
   plgd_dps_error_t err = PLGD_DPS_ERROR_SET_CLOUD;
   const uint32_t expected_status = PLGD_DPS_INITIALIZED | PLGD_DPS_HAS_TIME |
                                    PLGD_DPS_HAS_OWNER | PLGD_DPS_GET_CLOUD;
-  if (ctx->status != expected_status) {
+  // credentials and ACLs are provisioned concurrently
+  if (!dps_provisioning_check_status(
+        ctx->status, expected_status,
+        PLGD_DPS_PROVISIONED_CONCURRENT_FLAGS &
+          ~(PLGD_DPS_GET_CLOUD | PLGD_DPS_HAS_CLOUD))) {
 #if DPS_ERR_IS_ENABLED
     // GCOVR_EXCL_START
     char str[256]; // NOLINT
@@ -309,7 +327,7 @@ dps_set_cloud_handler(oc_client_response_t *data)
   dps_retry_reset(ctx, dps_provision_get_next_action(ctx));
   ctx->transient_retry_count = 0;
 
-  // go to next step -> get credentials
+  // go to next step -> start cloud when the credentials and ACLs are set
   dps_provisioning_schedule_next_step(ctx);
   return;
 
@@ -407,6 +425,7 @@ dps_provisioning_set_cloud(plgd_dps_context_t *ctx)
     DPS_ERR("failed to dispatch POST request to %s", PLGD_DPS_CLOUD_URI);
     return false;
   }
-  dps_set_ps_and_last_error(ctx, PLGD_DPS_GET_CLOUD, 0, PLGD_DPS_OK);
+  dps_set_ps_and_last_error(ctx, PLGD_DPS_GET_CLOUD,
+                            PLGD_DPS_PROVISIONED_ERROR_FLAGS, PLGD_DPS_OK);
   return true;
 }
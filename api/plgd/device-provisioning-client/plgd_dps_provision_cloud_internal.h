@@ -94,6 +94,9 @@ bool dps_provisioning_set_cloud_encode_payload(const plgd_dps_context_t *ctx)
 /**
  * @brief Handle cloud configuration response.
  *
+ * If the credentials have been provisioned before the response, then their
+ * identity certificate chain is selected again for the new configuration.
+ *
  * @param data response data (cannot be NULL)
  * @return plgd_dps_error_t
  */
@@ -27,6 +27,7 @@
 #include "util/oc_compiler.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -45,6 +46,47 @@ OC_NO_DISCARD_RETURN
 int dps_provisioning_check_response(plgd_dps_context_t *ctx, oc_status_t code,
                                     const oc_rep_t *payload) OC_NONNULL(1);
 
+/**
+ * @brief Check the provisioning status in the response handler of
+ * a provisioning step.
+ *
+ * @param status provisioning status
+ * @param required flags that must be set
+ * @param concurrent flags of the steps executed concurrently with the step,
+ * these flags may be set
+ * @return true all required flags are set and no other flags than the
+ * concurrent flags are set
+ * @return false otherwise
+ */
+OC_NO_DISCARD_RETURN
+bool dps_provisioning_check_status(uint32_t status, uint32_t required,
+                                   uint32_t concurrent);
+
+/**
+ * @brief Check if the response to a concurrently executed provisioning request
+ * must be ignored.
+ *
+ * The response is ignored if the request was aborted by a retry or if another
+ * concurrently executed step has failed, in which case the step is repeated by
+ * the retry.
+ *
+ * @param ctx device provisioning context (cannot be NULL)
+ * @param request PLGD_DPS_GET_* flag of the request
+ * @return true the response must be ignored
+ * @return false otherwise
+ */
+OC_NO_DISCARD_RETURN
+bool dps_provisioning_is_request_aborted(plgd_dps_context_t *ctx,
+                                         uint32_t request) OC_NONNULL();
+
+/**
+ * @brief Abort the concurrently executed provisioning requests waiting for
+ * a response.
+ *
+ * @param ctx device provisioning context (cannot be NULL)
+ */
+void dps_provisioning_abort_requests(plgd_dps_context_t *ctx) OC_NONNULL();
+
 /**
  * @brief Starting executing missing DPS provisioning steps.
  *
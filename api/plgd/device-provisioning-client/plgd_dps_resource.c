@@ -147,6 +147,18 @@ dps_status_to_str(uint32_t status)
   if (status == (cloud_started | PLGD_DPS_RENEW_CREDENTIALS)) {
     return OC_STRING_VIEW(kPlgdDpsStatusRenewCredentials);
   }
+  // the cloud configuration is provisioned concurrently with the credentials
+  // and the ACLs, report the first unfinished step
+  if ((status & ~PLGD_DPS_PROVISIONED_CONCURRENT_FLAGS) == has_owner &&
+      (status & PLGD_DPS_PROVISIONED_CONCURRENT_REQUEST_FLAGS) != 0) {
+    if ((status & PLGD_DPS_HAS_CLOUD) == 0) {
+      return OC_STRING_VIEW(kPlgdDpsStatusGetCloud);
+    }
+    if ((status & PLGD_DPS_HAS_CREDENTIALS) == 0) {
+      return OC_STRING_VIEW(kPlgdDpsStatusGetCredentials);
+    }
+    return OC_STRING_VIEW(kPlgdDpsStatusGetAcls);
+  }
   return OC_STRING_VIEW_NULL;
 }
 
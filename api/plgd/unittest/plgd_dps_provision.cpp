@@ -20,7 +20,10 @@
 
 #ifdef OC_HAS_FEATURE_PLGD_DEVICE_PROVISIONING
 
+#include "api/plgd/device-provisioning-client/plgd_dps_context_internal.h"
+#include "api/plgd/device-provisioning-client/plgd_dps_internal.h"
 #include "api/plgd/device-provisioning-client/plgd_dps_provision_cloud_internal.h"
+#include "api/plgd/device-provisioning-client/plgd_dps_provision_internal.h"
 #include "oc_rep.h"
 #include "tests/gtest/RepPool.h"
 
@@ -173,4 +176,70 @@ TEST(DPSFillCloudTest, FillSuccess)
   EXPECT_EQ(endpoints.size(), count);
 }
 
+TEST(DPSProvisionTest, CheckStatus)
+{
+  const uint32_t required = PLGD_DPS_INITIALIZED | PLGD_DPS_HAS_TIME |
+                            PLGD_DPS_HAS_OWNER | PLGD_DPS_GET_CREDENTIALS;
+  const uint32_t concurrent = PLGD_DPS_GET_CLOUD | PLGD_DPS_HAS_CLOUD;
+  EXPECT_TRUE(dps_provisioning_check_status(required, required, concurrent));
+  EXPECT_TRUE(dps_provisioning_check_status(required | PLGD_DPS_GET_CLOUD,
+                                            required, concurrent));
+  EXPECT_TRUE(dps_provisioning_check_status(required | PLGD_DPS_HAS_CLOUD,
+                                            required, concurrent));
+
+  // missing required flag
+  EXPECT_FALSE(dps_provisioning_check_status(
+    required & ~PLGD_DPS_GET_CREDENTIALS, required, concurrent));
+  // flag of a step that is not executed concurrently
+  EXPECT_FALSE(dps_provisioning_check_status(required | PLGD_DPS_HAS_ACLS,
+                                             required, concurrent));
+  EXPECT_FALSE(dps_provisioning_check_status(required | PLGD_DPS_FAILURE,
+                                             required, concurrent));
+}
+
+TEST(DPSProvisionTest, IsRequestAborted)
+{
+  plgd_dps_context_t ctx{};
+  const uint32_t has_owner =
+    PLGD_DPS_INITIALIZED | PLGD_DPS_HAS_TIME | PLGD_DPS_HAS_OWNER;
+  ctx.status = has_owner | PLGD_DPS_GET_CLOUD | PLGD_DPS_GET_CREDENTIALS;
+  EXPECT_FALSE(dps_provisioning_is_request_aborted(&ctx, PLGD_DPS_GET_CLOUD));
+
+  // the response to a request aborted by a retry is ignored once
+  ctx.aborted_requests = PLGD_DPS_GET_CLOUD;
+  EXPECT_TRUE(dps_provisioning_is_request_aborted(&ctx, PLGD_DPS_GET_CLOUD));
+  EXPECT_EQ(0, ctx.aborted_requests);
+  EXPECT_FALSE(dps_provisioning_is_request_aborted(&ctx, PLGD_DPS_GET_CLOUD));
+
+  // a concurrent step has failed
+  ctx.status |= PLGD_DPS_FAILURE;
+  EXPECT_TRUE(dps_provisioning_is_request_aborted(&ctx, PLGD_DPS_GET_CLOUD));
+  EXPECT_TRUE(
+    dps_provisioning_is_request_aborted(&ctx, PLGD_DPS_GET_CREDENTIALS));
+
+  // the failed step is the only one waiting for a response
+  ctx.status = has_owner | PLGD_DPS_GET_CLOUD | PLGD_DPS_TRANSIENT_FAILURE;
+  EXPECT_FALSE(dps_provisioning_is_request_aborted(&ctx, PLGD_DPS_GET_CLOUD));
+}
+
+TEST(DPSProvisionTest, AbortRequests)
+{
+  plgd_dps_context_t ctx{};
+  oc_endpoint_t ep{};
+  ctx.endpoint = &ep;
+  const uint32_t status = PLGD_DPS_INITIALIZED | PLGD_DPS_HAS_TIME |
+                          PLGD_DPS_HAS_OWNER | PLGD_DPS_HAS_CREDENTIALS;
+  ctx.status = status;
+  dps_provisioning_abort_requests(&ctx);
+  EXPECT_EQ(status, ctx.status);
+  EXPECT_EQ(0, ctx.aborted_requests);
+
+  ctx.status = status | PLGD_DPS_GET_CLOUD | PLGD_DPS_GET_ACLS;
+  dps_provisioning_abort_requests(&ctx);
+  EXPECT_EQ(status, ctx.status);
+  EXPECT_EQ(PLGD_DPS_GET_CLOUD | PLGD_DPS_GET_ACLS, ctx.aborted_requests);
+  EXPECT_TRUE(dps_provisioning_is_request_aborted(&ctx, PLGD_DPS_GET_ACLS));
+  EXPECT_EQ(PLGD_DPS_GET_CLOUD, ctx.aborted_requests);
+}
+
 #endif /* OC_HAS_FEATURE_PLGD_DEVICE_PROVISIONING */
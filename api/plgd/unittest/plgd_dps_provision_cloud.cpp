@@ -24,13 +24,17 @@
 #include "api/plgd/device-provisioning-client/plgd_dps_context_internal.h"
 #include "api/plgd/device-provisioning-client/plgd_dps_log_internal.h"
 #include "api/plgd/device-provisioning-client/plgd_dps_manager_internal.h"
+#include "api/plgd/device-provisioning-client/plgd_dps_internal.h"
 #include "api/plgd/device-provisioning-client/plgd_dps_provision_cloud_internal.h"
+#include "api/plgd/device-provisioning-client/plgd_dps_security_internal.h"
 #include "oc_api.h"
 #include "oc_cloud.h"
 #include "oc_core_res.h"
+#include "oc_cred.h"
 #include "oc_helpers.h"
 #include "oc_rep.h"
 #include "oc_uuid.h"
+#include "plgd_dps_test.h"
 #include "security/oc_pstat_internal.h"
 #include "tests/gtest/Device.h"
 #include "tests/gtest/Endpoint.h"
@@ -222,6 +226,70 @@ TEST_F(DPSProvisionCloudWithServerTest, HandleSetCloudResponse)
   EXPECT_EQ(OC_SESSION_DISCONNECTED, cloud_ctx->cloud_ep_state);
 }
 
+#ifdef OC_DYNAMIC_ALLOCATION
+
+TEST_F(DPSProvisionCloudWithServerTest, HandleSetCloudResponseAfterCredentials)
+{
+  oc::keypair_t rootKey{ oc::GetECPKeyPair(MBEDTLS_ECP_DP_SECP256R1) };
+  oc::keypair_t identKey{ oc::GetECPKeyPair(MBEDTLS_ECP_DP_SECP256R1) };
+  int credid =
+    dps::addIdentityCertificate(kDeviceID, identKey, rootKey, false, true);
+  ASSERT_LT(0, credid);
+  ASSERT_EQ(credid, dps_get_identity_credid(kDeviceID));
+
+  auto ctx = std::make_unique<plgd_dps_context_t>();
+  ctx->device = kDeviceID;
+  oc_client_response_t data{};
+  data.user_data = ctx.get();
+  data.code = OC_STATUS_OK;
+  oc_cloud_context_t *cloud_ctx = oc_cloud_get_context(kDeviceID);
+  ASSERT_NE(nullptr, cloud_ctx);
+
+  // device logged in to a cloud with a different sid, the old cloud
+  // configuration is cleared
+  auto loginToOldCloud = [cloud_ctx] {
+    ASSERT_EQ(0, oc_cloud_provision_conf_resource(
+                   cloud_ctx, "coap://[ff02::158]", "at",
+                   "00000000-0000-0000-0000-000000000001", "apn"));
+    cloud_ctx->store.status = OC_CLOUD_REGISTERED | OC_CLOUD_LOGGED_IN;
+    std::string uid = "501";
+    oc_set_string(&cloud_ctx->store.uid, uid.c_str(), uid.length());
+    oc_endpoint_t ep = oc::endpoint::FromString("coap://[ff02::158]");
+    memcpy(cloud_ctx->cloud_ep, &ep, sizeof(oc_endpoint_t));
+    cloud_ctx->cloud_ep_state = OC_SESSION_CONNECTED;
+  };
+  oc::RepPool pool{};
+  ASSERT_EQ(CborNoError,
+            encodeConfResourcePayload(
+              "cis", "00000000-0000-0000-0000-000000000002", "at", "apn"));
+  oc::oc_rep_unique_ptr rep = pool.ParsePayload();
+  ASSERT_NE(nullptr, rep.get());
+  data.payload = rep.get();
+
+  // the cloud response arrives after the credentials response
+  loginToOldCloud();
+  ctx->status = PLGD_DPS_INITIALIZED | PLGD_DPS_HAS_TIME | PLGD_DPS_HAS_OWNER |
+                PLGD_DPS_GET_CLOUD | PLGD_DPS_HAS_CREDENTIALS;
+  ASSERT_TRUE(dps_try_set_identity_chain(kDeviceID));
+  ASSERT_EQ(credid, oc_cloud_get_identity_cert_chain(cloud_ctx));
+  EXPECT_EQ(PLGD_DPS_OK, dps_handle_set_cloud_response(&data));
+  EXPECT_EQ(OC_SESSION_DISCONNECTED, cloud_ctx->cloud_ep_state);
+  // the identity certificate chain is kept for the new cloud
+  EXPECT_EQ(credid, oc_cloud_get_identity_cert_chain(cloud_ctx));
+
+  // the cloud response arrives before the credentials response, the chain is
+  // selected by the credentials handler
+  loginToOldCloud();
+  ctx->status = PLGD_DPS_INITIALIZED | PLGD_DPS_HAS_TIME | PLGD_DPS_HAS_OWNER |
+                PLGD_DPS_GET_CLOUD | PLGD_DPS_GET_CREDENTIALS;
+  EXPECT_EQ(PLGD_DPS_OK, dps_handle_set_cloud_response(&data));
+  EXPECT_EQ(-1, oc_cloud_get_identity_cert_chain(cloud_ctx));
+
+  ASSERT_TRUE(oc_sec_remove_cred_by_credid(credid, kDeviceID));
+}
+
+#endif /* OC_DYNAMIC_ALLOCATION */
+
 TEST_F(DPSProvisionCloudWithServerTest, HasCloudConfiguration)
 {
   // invalid device
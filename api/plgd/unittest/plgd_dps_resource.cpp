@@ -371,6 +371,25 @@ TEST_F(DPSResourceTest, StatusToString)
       .data,
     kPlgdDpsStatusFailure);
 
+  // concurrently provisioned steps
+  status = PLGD_DPS_INITIALIZED | PLGD_DPS_HAS_TIME | PLGD_DPS_HAS_OWNER;
+  EXPECT_STREQ(
+    dps_status_to_str(status | PLGD_DPS_GET_CLOUD | PLGD_DPS_GET_CREDENTIALS)
+      .data,
+    kPlgdDpsStatusGetCloud);
+  EXPECT_STREQ(dps_status_to_str(status | PLGD_DPS_GET_CLOUD |
+                                 PLGD_DPS_HAS_CREDENTIALS | PLGD_DPS_GET_ACLS)
+                 .data,
+               kPlgdDpsStatusGetCloud);
+  EXPECT_STREQ(dps_status_to_str(status | PLGD_DPS_GET_CLOUD |
+                                 PLGD_DPS_HAS_CREDENTIALS | PLGD_DPS_HAS_ACLS)
+                 .data,
+               kPlgdDpsStatusGetCloud);
+  EXPECT_STREQ(dps_status_to_str(status | PLGD_DPS_GET_CLOUD |
+                                 PLGD_DPS_GET_CREDENTIALS | PLGD_DPS_FAILURE)
+                 .data,
+               kPlgdDpsStatusFailure);
+
   for (uint8_t i = 0; i < 32; ++i) {
     uint32_t flag = (1 << i);
     if ((PLGD_DPS_PROVISIONED_ALL_FLAGS & flag) == 0) {
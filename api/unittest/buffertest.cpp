@@ -247,7 +247,8 @@ testProcessMessagesByProcess()
   oc_ri_init();
 
   using oc_event_uptr = std::unique_ptr<Event, void (*)(Event *)>;
-  oc_process_num_events_t size = oc_process_num_events();
+  oc_process_num_events_t size =
+    oc_process_num_events(OC_PROCESS_PRIORITY_HIGH);
   std::vector<oc_event_uptr> events{};
   for (size_t i = 0; i < size; ++i) {
     auto *event = new Event;
@@ -264,11 +265,12 @@ testProcessMessagesByProcess()
   events.push_back(oc_event_uptr(event, [](Event *evt) { delete evt; }));
 
   EXPECT_EQ(size + 1, oc_process_nevents());
-  EXPECT_LT(size, oc_process_num_events());
+  EXPECT_LT(size, oc_process_num_events(OC_PROCESS_PRIORITY_HIGH));
 #else  /* !OC_DYNAMIC_ALLOCATION */
   // with static allocation the message should be thrown away and deallocated
   EXPECT_EQ(size, oc_process_nevents());
-  EXPECT_EQ(size, oc_process_num_events());
+  EXPECT_EQ(size, oc_process_num_events(OC_PROCESS_PRIORITY_HIGH));
+  EXPECT_EQ(1, oc_process_dropped_events(OC_PROCESS_PRIORITY_HIGH));
 #endif /* OC_DYNAMIC_ALLOCATION */
 
   oc_message_buffer_handler_stop();
@@ -329,6 +331,93 @@ TEST_F(TestMessage, MessageShrinkBuffer)
   EXPECT_EQ(data, message->data);
 }
 
+TEST_F(TestMessage, MessageResizeBuffer)
+{
+  auto message =
+    oc_message_unique_ptr(oc_message_allocate_with_size(16), &oc_message_unref);
+  ASSERT_NE(nullptr, message.get());
+  for (size_t i = 0; i < 16; ++i) {
+    message->data[i] = static_cast<uint8_t>(i);
+  }
+  message->length = 16;
+
+  // grow to a bigger size class, data must be preserved
+  oc_message_shrink_buffer(message.get(), 1024);
+  EXPECT_EQ(1024, oc_message_buffer_size(message.get()));
+  ASSERT_EQ(16, message->length);
+  for (size_t i = 0; i < 16; ++i) {
+    EXPECT_EQ(i, message->data[i]);
+  }
+
+  // shrink below the length
+  oc_message_shrink_buffer(message.get(), 8);
+  EXPECT_EQ(8, oc_message_buffer_size(message.get()));
+  ASSERT_EQ(8, message->length);
+  for (size_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(i, message->data[i]);
+  }
+}
+
+TEST_F(TestMessage, MessageBufferPools)
+{
+  oc_message_buffer_pools_clear();
+  ASSERT_LT(0, oc_message_buffer_pools_count());
+  oc_message_buffer_pool_stats_t stats{};
+  ASSERT_TRUE(oc_message_buffer_pool_stats(0, &stats));
+  EXPECT_EQ(0, stats.allocated);
+  EXPECT_EQ(0, stats.reused);
+  EXPECT_EQ(0, stats.free);
+  EXPECT_FALSE(oc_message_buffer_pool_stats(oc_message_buffer_pools_count(),
+                                            &stats));
+
+  size_t max_index = 0;
+  size_t max_size = 0;
+  for (size_t i = 0; i < oc_message_buffer_pools_count(); ++i) {
+    ASSERT_TRUE(oc_message_buffer_pool_stats(i, &stats));
+    EXPECT_LT(0, stats.size);
+    if (stats.size > max_size) {
+      max_index = i;
+      max_size = stats.size;
+    }
+  }
+
+  ASSERT_TRUE(oc_message_buffer_pool_stats(0, &stats));
+  size_t size = stats.size;
+  auto *message = oc_message_allocate_with_size(size);
+  ASSERT_NE(nullptr, message);
+  const uint8_t *data = message->data;
+  oc_message_unref(message);
+  ASSERT_TRUE(oc_message_buffer_pool_stats(0, &stats));
+  EXPECT_EQ(1, stats.allocated);
+  EXPECT_EQ(1, stats.released);
+  EXPECT_EQ(1, stats.free);
+
+  // a smaller allocation reuses the cached buffer
+  message = oc_message_allocate_with_size(size / 2);
+  ASSERT_NE(nullptr, message);
+  EXPECT_EQ(data, message->data);
+  EXPECT_EQ(size / 2, oc_message_buffer_size(message));
+  ASSERT_TRUE(oc_message_buffer_pool_stats(0, &stats));
+  EXPECT_EQ(1, stats.allocated);
+  EXPECT_EQ(1, stats.reused);
+  EXPECT_EQ(0, stats.free);
+  oc_message_unref(message);
+
+  // buffers bigger than all pools are not cached
+  ASSERT_TRUE(oc_message_buffer_pool_stats(max_index, &stats));
+  message = oc_message_allocate_with_size(max_size + 1);
+  ASSERT_NE(nullptr, message);
+  EXPECT_EQ(max_size + 1, oc_message_buffer_size(message));
+  oc_message_unref(message);
+  oc_message_buffer_pool_stats_t stats_after{};
+  ASSERT_TRUE(oc_message_buffer_pool_stats(max_index, &stats_after));
+  EXPECT_EQ(stats.free, stats_after.free);
+
+  oc_message_buffer_pools_clear();
+  ASSERT_TRUE(oc_message_buffer_pool_stats(0, &stats));
+  EXPECT_EQ(0, stats.free);
+}
+
 #endif /* OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER */
 
 TEST_F(TestMessage, MessageBufferSize)
@@ -255,6 +255,11 @@ TEST_F(TestCollections, AddLink)
   ASSERT_NE(link_2, nullptr);
   oc_collection_add_link(&collection->res, link_2);
   EXPECT_EQ(2, CountLinksInCollection(collection.get()));
+
+  // the linked resources must outlive the collection
+  collection.reset();
+  EXPECT_EQ(nullptr, oc_get_next_collection_link(&resource_1, nullptr));
+  EXPECT_EQ(nullptr, oc_get_next_collection_link(&resource_2, nullptr));
 }
 
 TEST_F(TestCollections, AddLink_Fail)
@@ -311,6 +316,70 @@ TEST_F(TestCollections, RemoveLink)
   EXPECT_EQ(0, CountLinksInCollection(collection.get()));
 }
 
+TEST_F(TestCollections, CollectionLinksOfResource)
+{
+  std::string uri = "/a";
+  oc_resource_t resource{};
+  resource.uri = OC_MMEM(&uri[0], uri.length() + 1, nullptr);
+  EXPECT_EQ(nullptr, oc_get_next_collection_link(&resource, nullptr));
+
+  auto collection_1 = MakeCollection();
+  ASSERT_NE(nullptr, collection_1);
+  oc_link_t *link_1 = oc_new_link(&resource);
+  ASSERT_NE(link_1, nullptr);
+  oc_collection_add_link(&collection_1->res, link_1);
+
+  auto collection_2 = MakeCollection();
+  ASSERT_NE(nullptr, collection_2);
+  oc_link_t *link_2 = oc_new_link(&resource);
+  ASSERT_NE(link_2, nullptr);
+  oc_collection_add_link(&collection_2->res, link_2);
+
+  std::vector<oc_collection_t *> collections{};
+  for (const oc_link_t *link = oc_get_next_collection_link(&resource, nullptr);
+       link != nullptr; link = oc_get_next_collection_link(&resource, link)) {
+    EXPECT_EQ(&resource, link->resource);
+    collections.push_back(link->collection);
+  }
+  ASSERT_EQ(2, collections.size());
+  EXPECT_NE(collections.end(),
+            std::find(collections.begin(), collections.end(),
+                      collection_1.get()));
+  EXPECT_NE(collections.end(),
+            std::find(collections.begin(), collections.end(),
+                      collection_2.get()));
+
+  oc_collection_remove_link(&collection_1->res, link_1);
+  oc_delete_link(link_1);
+  const oc_link_t *link = oc_get_next_collection_link(&resource, nullptr);
+  ASSERT_EQ(link_2, link);
+  EXPECT_EQ(collection_2.get(), link->collection);
+  EXPECT_EQ(nullptr, oc_get_next_collection_link(&resource, link));
+
+  oc_collection_remove_link(&collection_2->res, link_2);
+  oc_delete_link(link_2);
+  EXPECT_EQ(nullptr, oc_get_next_collection_link(&resource, nullptr));
+}
+
+TEST_F(TestCollections, FreeLinkedCollection)
+{
+  auto collection = MakeCollection();
+  ASSERT_NE(nullptr, collection);
+
+  auto linked = MakeCollection();
+  ASSERT_NE(nullptr, linked);
+  std::string uri = "/linked";
+  oc_new_string(&linked->res.uri, uri.c_str(), uri.length());
+  oc_link_t *link = oc_new_link(&linked->res);
+  ASSERT_NE(link, nullptr);
+  oc_collection_add_link(&collection->res, link);
+  ASSERT_EQ(1, CountLinksInCollection(collection.get()));
+
+  // a freed collection is removed from the collections containing it
+  linked.reset();
+  EXPECT_EQ(0, CountLinksInCollection(collection.get()));
+}
+
 TEST_F(TestCollections, GetAllLinks)
 {
   EXPECT_EQ(nullptr, oc_collection_get_links(nullptr));
@@ -355,6 +424,9 @@ TEST_F(TestCollections, GetLinkByURI)
                                        uri_1.length()));
   EXPECT_EQ(link_2, oc_get_link_by_uri(collection.get(), uri_2.c_str(),
                                        uri_2.length()));
+
+  // the linked resources must outlive the collection
+  collection.reset();
 }
 
 #ifdef OC_COLLECTIONS_IF_CREATE
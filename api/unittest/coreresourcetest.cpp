@@ -22,6 +22,7 @@
 #include "oc_api.h"
 #include "oc_core_res.h"
 #include "oc_helpers.h"
+#include "port/oc_connectivity.h"
 #include "port/oc_network_event_handler_internal.h"
 #include "tests/gtest/Device.h"
 #include "tests/gtest/RepPool.h"
@@ -35,6 +36,7 @@
 #include "gtest/gtest.h"
 
 #include <algorithm>
+#include <array>
 #include <cstdio>
 #include <cstdlib>
 #include <string>
@@ -91,6 +93,102 @@ TEST_F(TestCoreResource, CoreDevice_P)
   oc_connectivity_shutdown(kDevice1ID);
 }
 
+#if defined(OC_SERVER) && defined(OC_DYNAMIC_ALLOCATION)
+
+#ifdef OC_SECURITY
+
+TEST_F(TestCoreResource, SharePortsNotSupported)
+{
+  oc_add_new_device_t cfg{};
+  cfg.name = kDeviceName.c_str();
+  cfg.uri = kDeviceURI.c_str();
+  cfg.rt = kDeviceType.c_str();
+  cfg.spec_version = kOCFSpecVersion.c_str();
+  cfg.data_model_version = kOCFDataModelVersion.c_str();
+  // the flag is ignored for device 0
+  cfg.ports.udp.flags = OC_CONNECTIVITY_SHARE_PORTS;
+  ASSERT_NE(nullptr, oc_core_add_new_device(cfg));
+  EXPECT_EQ(nullptr, oc_core_add_new_device(cfg));
+  EXPECT_EQ(1, oc_core_get_num_devices());
+  oc_connectivity_shutdown(kDevice1ID);
+}
+
+#else /* !OC_SECURITY */
+
+TEST_F(TestCoreResource, SelectDeviceOnSharedPorts)
+{
+  oc_add_new_device_t cfg{};
+  cfg.name = kDeviceName.c_str();
+  cfg.uri = kDeviceURI.c_str();
+  cfg.rt = kDeviceType.c_str();
+  cfg.spec_version = kOCFSpecVersion.c_str();
+  cfg.data_model_version = kOCFDataModelVersion.c_str();
+  ASSERT_NE(nullptr, oc_core_add_new_device(cfg));
+  cfg.ports.udp.flags = OC_CONNECTIVITY_SHARE_PORTS;
+  ASSERT_NE(nullptr, oc_core_add_new_device(cfg));
+  cfg.ports.udp.flags = {};
+  ASSERT_NE(nullptr, oc_core_add_new_device(cfg));
+  EXPECT_FALSE(oc_core_get_device_info(0)->shared_ports);
+  EXPECT_TRUE(oc_core_get_device_info(1)->shared_ports);
+  EXPECT_FALSE(oc_core_get_device_info(2)->shared_ports);
+
+#ifdef __linux__
+  // only the unsecured UDP requests are dispatched to the sharing device
+  uint16_t port = 0;
+  for (const oc_endpoint_t *ep = oc_connectivity_get_endpoints(0);
+       ep != nullptr; ep = ep->next) {
+    if ((ep->flags & (IPV6 | SECURED | TCP)) == IPV6) {
+      port = ep->addr.ipv6.port;
+    }
+  }
+  for (const oc_endpoint_t *ep = oc_connectivity_get_endpoints(1);
+       ep != nullptr; ep = ep->next) {
+    EXPECT_EQ(0, ep->flags & (SECURED | TCP));
+    if ((ep->flags & IPV6) != 0) {
+      EXPECT_EQ(port, ep->addr.ipv6.port);
+    }
+  }
+#endif /* __linux__ */
+
+  oc_resource_t *res = oc_new_resource(nullptr, "/shared", 1, 1);
+  ASSERT_NE(nullptr, res);
+  oc_resource_bind_resource_type(res, "oic.r.test");
+  oc_resource_set_request_handler(res, OC_GET, oc::TestDevice::DummyHandler,
+                                  nullptr);
+  ASSERT_TRUE(oc_add_resource(res));
+
+  auto select = [](size_t device, std::string_view uri,
+                   std::string_view query = {}) {
+    return oc_core_select_device_on_shared_ports(
+      device, uri.data(), uri.length(), query.data(), query.length());
+  };
+  // selected by URI
+  EXPECT_EQ(1, select(0, "shared"));
+  EXPECT_EQ(1, select(0, "/shared"));
+  EXPECT_EQ(0, select(0, "oic/d"));
+  EXPECT_EQ(0, select(0, "unknown"));
+  // only requests received by device 0 are dispatched
+  EXPECT_EQ(2, select(2, "shared"));
+
+  // selected by di
+  std::array<char, OC_UUID_LEN> di{};
+  oc_uuid_to_str(oc_core_get_device_id(1), di.data(), di.size());
+  EXPECT_EQ(1, select(0, "oic/d", "di=" + std::string(di.data())));
+  // device 2 does not share the ports
+  oc_uuid_to_str(oc_core_get_device_id(2), di.data(), di.size());
+  EXPECT_EQ(0, select(0, "shared", "di=" + std::string(di.data())));
+  EXPECT_EQ(0, select(0, "shared", "di=invalid"));
+
+  EXPECT_TRUE(oc_delete_resource(res));
+  for (size_t i = 0; i < oc_core_get_num_devices(); ++i) {
+    oc_connectivity_shutdown(i);
+  }
+}
+
+#endif /* OC_SECURITY */
+
+#endif /* OC_SERVER && OC_DYNAMIC_ALLOCATION */
+
 static void
 encodeInterfaces(unsigned iface_mask, std::vector<std::string> iface_strs = {},
                  bool includePrivate = false)
@@ -19,6 +19,8 @@
 #include "discovery.h"
 
 #include "api/oc_client_api_internal.h"
+#include "api/oc_core_res_internal.h"
+#include "api/oc_discovery_cache_internal.h"
 #include "api/oc_discovery_internal.h"
 #include "api/oc_etag_internal.h"
 #include "api/oc_resource_internal.h"
@@ -261,6 +263,93 @@ TEST_F(TestDiscoveryWithServer, GetRequest)
   verifyLinks(links);
 }
 
+#ifdef OC_HAS_FEATURE_DISCOVERY_CACHE
+
+static oc::discovery::LinkDataMap
+getLinks(const oc_endpoint_t &ep, const char *query = nullptr)
+{
+  auto get_handler = [](oc_client_response_t *data) {
+    oc::TestDevice::Terminate();
+    ASSERT_EQ(OC_STATUS_OK, data->code);
+    *static_cast<oc::discovery::LinkDataMap *>(data->user_data) =
+      oc::discovery::ParseLinks(data->payload);
+  };
+
+  oc::discovery::LinkDataMap links{};
+  auto timeout = 1s;
+  EXPECT_TRUE(oc_do_get_with_timeout(OCF_RES_URI, &ep, query, timeout.count(),
+                                     get_handler, HIGH_QOS, &links));
+  oc::TestDevice::PoolEventsMsV1(timeout, true);
+  return links;
+}
+
+TEST_F(TestDiscoveryWithServer, GetRequestCached)
+{
+  auto epOpt = oc::TestDevice::GetEndpoint(kDeviceID);
+  ASSERT_TRUE(epOpt.has_value());
+  auto ep = std::move(*epOpt);
+
+  oc_discovery_cache_clear();
+  auto links = getLinks(ep);
+  ASSERT_FALSE(links.empty());
+  EXPECT_EQ(1, oc_discovery_cache_size());
+
+  // response encoded from the cache
+  auto cached_links = getLinks(ep);
+  EXPECT_EQ(1, oc_discovery_cache_size());
+  ASSERT_EQ(links.size(), cached_links.size());
+  for (const auto &[href, link] : links) {
+    auto it = cached_links.find(href);
+    ASSERT_NE(cached_links.end(), it);
+    EXPECT_EQ(link.anchor, it->second.anchor);
+    EXPECT_EQ(link.resourceTypes, it->second.resourceTypes);
+    EXPECT_EQ(link.interfaces, it->second.interfaces);
+  }
+  verifyLinks(cached_links);
+
+  // a change of a resource drops the cached links
+  oc_resource_t *res = oc_core_get_resource_by_index(OCF_D, kDeviceID);
+  ASSERT_NE(nullptr, res);
+  oc_resource_set_discoverable(res, false);
+  EXPECT_EQ(0, oc_discovery_cache_size());
+  links = getLinks(ep);
+  EXPECT_EQ(cached_links.size() - 1, links.size());
+  EXPECT_EQ(links.end(), links.find(oc_string(res->uri)));
+  oc_resource_set_discoverable(res, true);
+}
+
+TEST_F(TestDiscoveryWithServer, GetRequestFilteredByType)
+{
+  auto epOpt = oc::TestDevice::GetEndpoint(kDeviceID);
+  ASSERT_TRUE(epOpt.has_value());
+  auto ep = std::move(*epOpt);
+
+  // single rt query is resolved by the resource type index
+  auto links = getLinks(ep, "rt=" OCF_D_RT);
+  ASSERT_EQ(1, links.size());
+  EXPECT_NE(links.end(), links.find(OCF_D_URI));
+
+  // filtered responses are not cached
+  EXPECT_EQ(0, oc_discovery_cache_size());
+
+  // the index is dropped when a resource changes
+  oc_resource_t *res = oc_core_get_resource_by_index(OCF_D, kDeviceID);
+  ASSERT_NE(nullptr, res);
+  oc_resource_set_discoverable(res, false);
+  links = getLinks(ep, "rt=" OCF_RES_RT);
+  ASSERT_EQ(1, links.size());
+  EXPECT_NE(links.end(), links.find(OCF_RES_URI));
+  oc_resource_set_discoverable(res, true);
+
+  // multiple rt queries
+  links = getLinks(ep, "rt=" OCF_D_RT "&rt=" OCF_RES_RT);
+  ASSERT_EQ(2, links.size());
+  EXPECT_NE(links.end(), links.find(OCF_D_URI));
+  EXPECT_NE(links.end(), links.find(OCF_RES_URI));
+}
+
+#endif /* OC_HAS_FEATURE_DISCOVERY_CACHE */
+
 // baseline interface:
 // {
 //   <baseline properties>
@@ -23,14 +23,18 @@
 #include "oc_uuid.h"
 #include "port/oc_allocator_internal.h"
 #include "port/oc_connectivity.h"
+#include "port/oc_dns_internal.h"
 #include "port/oc_ip_internal.h"
 #include "port/oc_random.h"
 #include "tests/gtest/Device.h"
 #include "tests/gtest/Endpoint.h"
+#include "util/oc_features.h"
 
 #include "gtest/gtest.h"
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <string>
 #include <string_view>
@@ -964,3 +968,210 @@ TEST_F(TestEndpointWithServer, SetLocalAddress)
 }
 
 #endif /* OC_CLIENT */
+
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+
+using namespace std::chrono_literals;
+
+class TestEndpointAsync : public testing::Test {
+public:
+  static void SetUpTestCase() { ASSERT_TRUE(oc::TestDevice::StartServer()); }
+
+  static void TearDownTestCase() { oc::TestDevice::StopServer(); }
+
+  void SetUp() override
+  {
+    resolved.store(0);
+    failIPv4 = false;
+    fail = false;
+    oc_dns_set_resolver(Resolve);
+#ifdef OC_DNS_CACHE
+    oc_dns_clear_cache();
+#endif /* OC_DNS_CACHE */
+  }
+
+  void TearDown() override
+  {
+#ifdef OC_DNS_CACHE
+    oc_dns_clear_cache();
+#endif /* OC_DNS_CACHE */
+    oc_dns_set_resolver(nullptr);
+  }
+
+  static int Resolve(const char *, transport_flags flags,
+                     oc_endpoint_t *endpoint)
+  {
+    ++resolved;
+    if (fail) {
+      return -1;
+    }
+    if ((flags & IPV6) != 0) {
+      endpoint->addr.ipv6.address[15] = 1;
+      return 0;
+    }
+    if (failIPv4) {
+      return -1;
+    }
+#ifdef OC_IPV4
+    endpoint->addr.ipv4.address[0] = 127;
+    endpoint->addr.ipv4.address[3] = 1;
+#endif /* OC_IPV4 */
+    return 0;
+  }
+
+  static oc_string_t MakeString(const std::string &str)
+  {
+    oc_string_t s{};
+    oc_new_string(&s, str.c_str(), str.length());
+    return s;
+  }
+
+  struct Result
+  {
+    bool invoked;
+    int status;
+    oc_endpoint_t endpoint;
+  };
+
+  static void OnResolved(int status, const oc_endpoint_t *endpoint,
+                         void *user_data)
+  {
+    auto *result = static_cast<Result *>(user_data);
+    result->invoked = true;
+    result->status = status;
+    if (endpoint != nullptr) {
+      result->endpoint = *endpoint;
+    }
+    oc::TestDevice::Terminate();
+  }
+
+  static std::atomic<int> resolved;
+  static bool failIPv4;
+  static bool fail;
+};
+
+std::atomic<int> TestEndpointAsync::resolved{ 0 };
+bool TestEndpointAsync::failIPv4{ false };
+bool TestEndpointAsync::fail{ false };
+
+TEST_F(TestEndpointAsync, StringToEndpointAsync_F)
+{
+  oc_endpoint_resolve_t resolve{};
+  oc_endpoint_t ep{};
+  auto ep_str = MakeString("coap://[::1]:1234");
+  EXPECT_EQ(-1, oc_string_to_endpoint_async(nullptr, &ep, &resolve,
+                                            OnResolved, nullptr));
+  EXPECT_EQ(-1, oc_string_to_endpoint_async(&ep_str, nullptr, &resolve,
+                                            OnResolved, nullptr));
+  EXPECT_EQ(-1, oc_string_to_endpoint_async(&ep_str, &ep, nullptr, OnResolved,
+                                            nullptr));
+  EXPECT_EQ(-1, oc_string_to_endpoint_async(&ep_str, &ep, &resolve, nullptr,
+                                            nullptr));
+  oc_free_string(&ep_str);
+
+  ep_str = MakeString("http://plgd.dev");
+  EXPECT_EQ(-1, oc_string_to_endpoint_async(&ep_str, &ep, &resolve,
+                                            OnResolved, nullptr));
+  oc_free_string(&ep_str);
+  EXPECT_FALSE(oc_endpoint_resolve_is_pending(&resolve));
+}
+
+TEST_F(TestEndpointAsync, AddressLiteral)
+{
+  oc_endpoint_resolve_t resolve{};
+  oc_endpoint_t ep{};
+  Result result{};
+  auto ep_str = MakeString("coaps://[::1]:1234");
+  // address literal is parsed without a lookup and without the handler
+  EXPECT_EQ(0, oc_string_to_endpoint_async(&ep_str, &ep, &resolve,
+                                           OnResolved, &result));
+  oc_free_string(&ep_str);
+  EXPECT_FALSE(oc_endpoint_resolve_is_pending(&resolve));
+  EXPECT_FALSE(result.invoked);
+  EXPECT_EQ(0, resolved.load());
+  EXPECT_EQ(IPV6 | SECURED, ep.flags);
+  EXPECT_EQ(1234, ep.addr.ipv6.port);
+  EXPECT_EQ(1, ep.addr.ipv6.address[15]);
+}
+
+TEST_F(TestEndpointAsync, Domain)
+{
+  oc_endpoint_resolve_t resolve{};
+  oc_endpoint_t ep{};
+  Result result{};
+  auto ep_str = MakeString("coaps://plgd.dev:3456/uri");
+  ASSERT_EQ(1, oc_string_to_endpoint_async(&ep_str, &ep, &resolve, OnResolved,
+                                           &result));
+  oc_free_string(&ep_str);
+  EXPECT_TRUE(oc_endpoint_resolve_is_pending(&resolve));
+  // the handler is never invoked synchronously
+  EXPECT_FALSE(result.invoked);
+  oc::TestDevice::PoolEventsMsV1(1s);
+  ASSERT_TRUE(result.invoked);
+  EXPECT_FALSE(oc_endpoint_resolve_is_pending(&resolve));
+  EXPECT_EQ(0, result.status);
+  EXPECT_NE(0, result.endpoint.flags & SECURED);
+#ifdef OC_IPV4
+  EXPECT_NE(0, result.endpoint.flags & IPV4);
+  EXPECT_EQ(3456, result.endpoint.addr.ipv4.port);
+  EXPECT_EQ(127, result.endpoint.addr.ipv4.address[0]);
+#else  /* !OC_IPV4 */
+  EXPECT_NE(0, result.endpoint.flags & IPV6);
+  EXPECT_EQ(3456, result.endpoint.addr.ipv6.port);
+#endif /* OC_IPV4 */
+}
+
+#if defined(OC_IPV4) && defined(OC_DNS_LOOKUP_IPV6)
+TEST_F(TestEndpointAsync, FallbackToIPv6)
+{
+  failIPv4 = true;
+  oc_endpoint_resolve_t resolve{};
+  oc_endpoint_t ep{};
+  Result result{};
+  auto ep_str = MakeString("coap://plgd.dev");
+  ASSERT_EQ(1, oc_string_to_endpoint_async(&ep_str, &ep, &resolve, OnResolved,
+                                           &result));
+  oc_free_string(&ep_str);
+  oc::TestDevice::PoolEventsMsV1(1s);
+  ASSERT_TRUE(result.invoked);
+  EXPECT_EQ(0, result.status);
+  EXPECT_NE(0, result.endpoint.flags & IPV6);
+  EXPECT_EQ(5683, result.endpoint.addr.ipv6.port);
+  EXPECT_EQ(2, resolved.load());
+}
+#endif /* OC_IPV4 && OC_DNS_LOOKUP_IPV6 */
+
+TEST_F(TestEndpointAsync, DomainFail)
+{
+  fail = true;
+  oc_endpoint_resolve_t resolve{};
+  oc_endpoint_t ep{};
+  Result result{};
+  auto ep_str = MakeString("coap://plgd.dev");
+  ASSERT_EQ(1, oc_string_to_endpoint_async(&ep_str, &ep, &resolve, OnResolved,
+                                           &result));
+  oc_free_string(&ep_str);
+  oc::TestDevice::PoolEventsMsV1(1s);
+  ASSERT_TRUE(result.invoked);
+  EXPECT_EQ(-1, result.status);
+  EXPECT_FALSE(oc_endpoint_resolve_is_pending(&resolve));
+}
+
+TEST_F(TestEndpointAsync, Cancel)
+{
+  oc_endpoint_resolve_t resolve{};
+  oc_endpoint_t ep{};
+  Result result{};
+  auto ep_str = MakeString("coap://plgd.dev");
+  ASSERT_EQ(1, oc_string_to_endpoint_async(&ep_str, &ep, &resolve, OnResolved,
+                                           &result));
+  oc_free_string(&ep_str);
+  oc_endpoint_resolve_cancel(&resolve);
+  EXPECT_FALSE(oc_endpoint_resolve_is_pending(&resolve));
+  oc::TestDevice::PoolEventsMsV1(50ms);
+  EXPECT_FALSE(result.invoked);
+  // cancelling a finished request is a no-op
+  oc_endpoint_resolve_cancel(&resolve);
+}
+
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
@@ -0,0 +1,367 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifdef OC_METRICS
+
+#include "api/oc_message_internal.h"
+#include "api/oc_metrics_internal.h"
+#include "messaging/coap/transactions_internal.h"
+#include "oc_api.h"
+#include "oc_buffer.h"
+#include "oc_metrics.h"
+#include "port/oc_log_internal.h"
+#include "tests/gtest/Device.h"
+#include "tests/gtest/Endpoint.h"
+#include "tests/gtest/RepPool.h"
+#include "util/oc_features.h"
+
+#ifdef OC_SECURITY
+#include "security/oc_pstat_internal.h"
+#include "security/oc_tls_internal.h"
+#include "tests/gtest/tls/DTLS.h"
+#include "tests/gtest/tls/DTLSClient.h"
+
+#include "mbedtls/build_info.h"
+#endif /* OC_SECURITY */
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+
+// TODO: upgrade mingw, because on v10.2 std::thread doesn't work correctly
+#if defined(__MINGW32__) && defined(__GNUC__) && (__GNUC__ < 12)
+#define MINGW_WINTHREAD
+#else /* __MINGW32__ */
+#include <thread>
+#endif /* __MINGW32__ */
+
+static constexpr size_t kDeviceID{ 0 };
+
+using namespace std::chrono_literals;
+
+class TestMetrics : public testing::Test {
+public:
+  void SetUp() override { oc_metrics_reset(); }
+  void TearDown() override { oc_metrics_reset(); }
+};
+
+TEST_F(TestMetrics, Names)
+{
+  std::set<std::string> names{};
+  oc_metrics_iterate(
+    [](oc_metric_t metric, void *data) {
+      const char *name = oc_metrics_name(metric);
+      EXPECT_NE(nullptr, name);
+      static_cast<std::set<std::string> *>(data)->insert(name);
+      return true;
+    },
+    &names);
+  // names are unique
+  EXPECT_EQ(static_cast<size_t>(OC_METRIC_COUNT), names.size());
+
+  EXPECT_EQ(nullptr, oc_metrics_name(OC_METRIC_COUNT));
+  EXPECT_EQ(0, oc_metrics_value(OC_METRIC_COUNT));
+}
+
+TEST_F(TestMetrics, Iterate_Stop)
+{
+  int count = 0;
+  oc_metrics_iterate(
+    [](oc_metric_t, void *data) {
+      ++*static_cast<int *>(data);
+      return false;
+    },
+    &count);
+  EXPECT_EQ(1, count);
+}
+
+TEST_F(TestMetrics, Counter)
+{
+  ASSERT_EQ(OC_METRIC_TYPE_COUNTER, oc_metrics_type(OC_METRIC_ACL_DENIED));
+  EXPECT_EQ(0, oc_metrics_value(OC_METRIC_ACL_DENIED));
+  oc_metrics_increment(OC_METRIC_ACL_DENIED);
+  oc_metrics_increment(OC_METRIC_ACL_DENIED);
+  EXPECT_EQ(2, oc_metrics_value(OC_METRIC_ACL_DENIED));
+
+  oc_metrics_reset();
+  EXPECT_EQ(0, oc_metrics_value(OC_METRIC_ACL_DENIED));
+}
+
+TEST_F(TestMetrics, Gauge)
+{
+  ASSERT_EQ(OC_METRIC_TYPE_GAUGE, oc_metrics_type(OC_METRIC_TLS_PEERS));
+  uint32_t value = oc_metrics_value(OC_METRIC_TLS_PEERS);
+  oc_metrics_increment(OC_METRIC_TLS_PEERS);
+  oc_metrics_increment(OC_METRIC_TLS_PEERS);
+  EXPECT_EQ(value + 2, oc_metrics_value(OC_METRIC_TLS_PEERS));
+
+  // gauges track the current state, they are not reset
+  oc_metrics_reset();
+  EXPECT_EQ(value + 2, oc_metrics_value(OC_METRIC_TLS_PEERS));
+
+  oc_metrics_decrement(OC_METRIC_TLS_PEERS);
+  oc_metrics_decrement(OC_METRIC_TLS_PEERS);
+  EXPECT_EQ(value, oc_metrics_value(OC_METRIC_TLS_PEERS));
+}
+
+TEST_F(TestMetrics, Histogram)
+{
+  oc_metric_t metric = OC_METRIC_COAP_PROCESSING_TIME_US;
+  ASSERT_EQ(OC_METRIC_TYPE_HISTOGRAM, oc_metrics_type(metric));
+
+  uint32_t first = oc_metrics_histogram_bucket_bound(metric, 0);
+  uint32_t second = oc_metrics_histogram_bucket_bound(metric, 1);
+  ASSERT_LT(first, second);
+  uint32_t last =
+    oc_metrics_histogram_bucket_bound(metric, OC_METRICS_HISTOGRAM_BUCKETS - 2);
+  EXPECT_EQ(UINT32_MAX, oc_metrics_histogram_bucket_bound(
+                          metric, OC_METRICS_HISTOGRAM_BUCKETS - 1));
+
+  oc_metrics_observe(metric, 0);
+  oc_metrics_observe(metric, first);     // bounds are inclusive
+  oc_metrics_observe(metric, first + 1); // second bucket
+  oc_metrics_observe(metric, last + 1);  // overflow bucket
+
+  oc_metrics_histogram_t h;
+  ASSERT_TRUE(oc_metrics_histogram(metric, &h));
+  EXPECT_EQ(4, h.count);
+  EXPECT_EQ(4, oc_metrics_value(metric));
+  EXPECT_EQ(first + first + 1 + last + 1, h.sum);
+  EXPECT_EQ(2, h.buckets[0]);
+  EXPECT_EQ(1, h.buckets[1]);
+  EXPECT_EQ(1, h.buckets[OC_METRICS_HISTOGRAM_BUCKETS - 1]);
+
+  oc_metrics_reset();
+  ASSERT_TRUE(oc_metrics_histogram(metric, &h));
+  EXPECT_EQ(0, h.count);
+  EXPECT_EQ(0, h.sum);
+  for (size_t i = 0; i < OC_METRICS_HISTOGRAM_BUCKETS; ++i) {
+    EXPECT_EQ(0, h.buckets[i]);
+  }
+}
+
+TEST_F(TestMetrics, Histogram_F)
+{
+  oc_metrics_histogram_t h;
+  EXPECT_FALSE(oc_metrics_histogram(OC_METRIC_ACL_DENIED, &h));
+  EXPECT_FALSE(oc_metrics_histogram(OC_METRIC_COUNT, &h));
+  EXPECT_EQ(UINT32_MAX,
+            oc_metrics_histogram_bucket_bound(OC_METRIC_ACL_DENIED, 0));
+}
+
+TEST_F(TestMetrics, MessageAllocation)
+{
+  uint32_t allocated = oc_metrics_value(OC_METRIC_MESSAGES_ALLOCATED);
+  oc_message_t *message = oc_allocate_message();
+  ASSERT_NE(nullptr, message);
+  EXPECT_EQ(allocated + 1, oc_metrics_value(OC_METRIC_MESSAGES_ALLOCATED));
+  oc_message_unref(message);
+  EXPECT_EQ(allocated, oc_metrics_value(OC_METRIC_MESSAGES_ALLOCATED));
+}
+
+#ifndef OC_DYNAMIC_ALLOCATION
+
+TEST_F(TestMetrics, MessageAllocation_F)
+{
+  std::vector<oc_message_t *> messages{};
+  oc_message_t *message;
+  while ((message = oc_allocate_message()) != nullptr) {
+    messages.push_back(message);
+  }
+  EXPECT_EQ(1, oc_metrics_value(OC_METRIC_MESSAGE_ALLOCATION_FAILURES));
+  for (auto *m : messages) {
+    oc_message_unref(m);
+  }
+}
+
+#endif /* !OC_DYNAMIC_ALLOCATION */
+
+class TestMetricsWithServer : public testing::Test {
+public:
+  static void SetUpTestCase() { ASSERT_TRUE(oc::TestDevice::StartServer()); }
+
+  static void TearDownTestCase() { oc::TestDevice::StopServer(); }
+
+  void SetUp() override { oc_metrics_reset(); }
+
+  void TearDown() override
+  {
+#ifdef OC_SECURITY
+    oc_tls_close_peers(nullptr, nullptr);
+    oc_sec_pstat_t *pstat = oc_sec_get_pstat(kDeviceID);
+    pstat->s = OC_DOS_RFOTM;
+#endif /* OC_SECURITY */
+    oc::TestDevice::Reset();
+    oc_metrics_reset();
+  }
+
+  // confirmable transaction with an expired retransmission timer
+  static coap_transaction_t *newExpiredTransaction(uint16_t mid)
+  {
+    oc_endpoint_t ep = oc::endpoint::FromString("coap://[::1]:12345");
+    std::array<uint8_t, 1> token{ 0x42 };
+    coap_transaction_t *t =
+      coap_new_transaction(mid, token.data(), token.size(), &ep);
+    if (t == nullptr) {
+      return nullptr;
+    }
+    // empty confirmable CoAP message (ping)
+    t->message->data[0] = 0x40;
+    t->message->data[1] = 0x00;
+    t->message->data[2] = static_cast<uint8_t>(mid >> 8);
+    t->message->data[3] = static_cast<uint8_t>(mid);
+    t->message->length = 4;
+    coap_send_transaction(t);
+    oc_etimer_stop(&t->retrans_timer);
+    return t;
+  }
+};
+
+TEST_F(TestMetricsWithServer, Retransmission)
+{
+  uint32_t transactions = oc_metrics_value(OC_METRIC_COAP_TRANSACTIONS);
+  coap_transaction_t *t = newExpiredTransaction(42);
+  ASSERT_NE(nullptr, t);
+  EXPECT_EQ(transactions + 1, oc_metrics_value(OC_METRIC_COAP_TRANSACTIONS));
+
+  coap_check_transactions();
+  EXPECT_EQ(1, t->retrans_counter);
+  EXPECT_EQ(1, oc_metrics_value(OC_METRIC_COAP_RETRANSMISSIONS));
+  EXPECT_EQ(0, oc_metrics_value(OC_METRIC_COAP_TIMEOUTS));
+
+  coap_clear_transaction(t);
+  EXPECT_EQ(transactions, oc_metrics_value(OC_METRIC_COAP_TRANSACTIONS));
+}
+
+TEST_F(TestMetricsWithServer, RetransmissionTimeout)
+{
+  uint32_t transactions = oc_metrics_value(OC_METRIC_COAP_TRANSACTIONS);
+  coap_transaction_t *t = newExpiredTransaction(43);
+  ASSERT_NE(nullptr, t);
+  t->retrans_counter = COAP_MAX_RETRANSMIT - 1;
+
+  // the last expiration times out the transaction instead of retransmitting
+  coap_check_transactions();
+  EXPECT_EQ(0, oc_metrics_value(OC_METRIC_COAP_RETRANSMISSIONS));
+  EXPECT_EQ(1, oc_metrics_value(OC_METRIC_COAP_TIMEOUTS));
+  EXPECT_EQ(transactions, oc_metrics_value(OC_METRIC_COAP_TRANSACTIONS));
+}
+
+#if defined(OC_SECURITY) && defined(MBEDTLS_NET_C) &&                          \
+  defined(MBEDTLS_TIMING_C) && !defined(MINGW_WINTHREAD)
+
+TEST_F(TestMetricsWithServer, TLSHandshake)
+{
+  oc_sec_pstat_t *pstat = oc_sec_get_pstat(kDeviceID);
+  pstat->s = OC_DOS_RFNOP;
+
+  auto epOpt = oc::TestDevice::GetEndpoint(kDeviceID, SECURED, TCP);
+  ASSERT_TRUE(epOpt.has_value());
+  auto port = static_cast<uint16_t>(oc_endpoint_port(&*epOpt));
+
+  oc::tls::PreSharedKey psk = {
+    0xD1, 0xD0, 0xDB, 0x1F, 0x8B, 0xB2, 0x40, 0x55,
+    0x9B, 0x07, 0xB8, 0x76, 0x50, 0x7E, 0x25, 0xCF,
+  };
+  auto hint = oc::tls::AddPresharedKey(kDeviceID, psk);
+  ASSERT_TRUE(hint.has_value());
+
+  uint32_t peers = oc_metrics_value(OC_METRIC_TLS_PEERS);
+  oc::tls::DTLSClient dtls{};
+  dtls.SetPresharedKey(psk, *hint);
+  std::atomic<int> status{ 0 };
+  std::thread dtls_thread{ [&dtls, &status, port] {
+    status.store(dtls.ConnectWithHandshake("::1", port) ? 1 : -1);
+  } };
+  while (status.load() == 0) {
+    oc::TestDevice::PoolEventsMs(50);
+  }
+  dtls_thread.join();
+
+  ASSERT_EQ(1, status.load());
+  EXPECT_EQ(1, oc_metrics_value(OC_METRIC_TLS_HANDSHAKES));
+  EXPECT_EQ(0, oc_metrics_value(OC_METRIC_TLS_HANDSHAKE_FAILURES));
+  EXPECT_EQ(peers + 1, oc_metrics_value(OC_METRIC_TLS_PEERS));
+
+  oc_tls_close_peers(nullptr, nullptr);
+  EXPECT_EQ(peers, oc_metrics_value(OC_METRIC_TLS_PEERS));
+}
+
+#endif /* OC_SECURITY && MBEDTLS_NET_C && MBEDTLS_TIMING_C &&                  \
+          !MINGW_WINTHREAD */
+
+#if defined(OC_SERVER) && defined(OC_CLIENT) &&                                \
+  (!defined(OC_SECURITY) || defined(OC_HAS_FEATURE_RESOURCE_ACCESS_IN_RFOTM))
+
+TEST_F(TestMetricsWithServer, Resource)
+{
+  oc_resource_t *res = oc_metrics_resource_create(kDeviceID);
+  ASSERT_NE(nullptr, res);
+#ifdef OC_SECURITY
+  oc_resource_make_public(res);
+  oc_resource_set_access_in_RFOTM(res, true, OC_PERM_RETRIEVE);
+#endif /* OC_SECURITY */
+  EXPECT_EQ(res, oc_ri_get_app_resource_by_uri(OC_METRICS_URI,
+                                               strlen(OC_METRICS_URI),
+                                               kDeviceID));
+  oc_metrics_increment(OC_METRIC_ACL_DENIED);
+  oc_metrics_increment(OC_METRIC_ACL_DENIED);
+
+  auto epOpt = oc::TestDevice::GetEndpoint(kDeviceID);
+  ASSERT_TRUE(epOpt.has_value());
+  auto ep = std::move(*epOpt);
+
+  auto get_handler = [](oc_client_response_t *data) {
+    oc::TestDevice::Terminate();
+    *static_cast<bool *>(data->user_data) = true;
+    ASSERT_EQ(OC_STATUS_OK, data->code);
+    OC_DBG("GET payload: %s", oc::RepPool::GetJson(data->payload, true).data());
+    int64_t denied = 0;
+    EXPECT_TRUE(oc_rep_get_int(data->payload, "acl.denied", &denied));
+    EXPECT_EQ(2, denied);
+    // the request itself was counted before the response was encoded
+    int64_t received = 0;
+    EXPECT_TRUE(oc_rep_get_int(data->payload, "network.received", &received));
+    EXPECT_LT(0, received);
+    oc_rep_t *histogram = nullptr;
+    EXPECT_TRUE(oc_rep_get_object(data->payload, "coap.processing_time_us",
+                                  &histogram));
+  };
+
+  auto timeout = 1s;
+  bool invoked = false;
+  ASSERT_TRUE(oc_do_get_with_timeout(OC_METRICS_URI, &ep, nullptr,
+                                     timeout.count(), get_handler, HIGH_QOS,
+                                     &invoked));
+  oc::TestDevice::PoolEventsMsV1(timeout, true);
+  EXPECT_TRUE(invoked);
+
+  EXPECT_TRUE(oc_delete_resource(res));
+}
+
+#endif /* OC_SERVER && OC_CLIENT && (!OC_SECURITY ||                          \
+          OC_HAS_FEATURE_RESOURCE_ACCESS_IN_RFOTM) */
+
+#endif /* OC_METRICS */
@@ -0,0 +1,325 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2023 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "util/oc_features.h"
+
+#ifdef OC_HAS_FEATURE_PUSH
+
+#include "api/oc_push_internal.h"
+#include "oc_api.h"
+#include "oc_push.h"
+#include "oc_rep.h"
+#include "tests/gtest/Device.h"
+#include "tests/gtest/RepPool.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr size_t kDeviceID = 0;
+// longer than OC_PUSH_COALESCE_DELAY_MS
+constexpr uint64_t kPushDelayMs = 200;
+
+constexpr std::string_view kSwitchURI = "/push/switch";
+constexpr std::string_view kSensorURI = "/push/sensor";
+constexpr std::string_view kPushTarget = "coap://[::1]:12345/pushed";
+
+struct PushedUpdate
+{
+  std::string selector;
+  std::string resource;
+};
+
+class TestPushWithServer : public testing::Test {
+public:
+  static void SetUpTestCase()
+  {
+    ASSERT_TRUE(oc::TestDevice::StartServer());
+
+    ASSERT_NE(nullptr, addPushableResource(
+                         "Switch", kSwitchURI,
+                         { "oic.r.switch.binary", "oic.r.light" }, OC_IF_A));
+    ASSERT_NE(nullptr, addPushableResource("Sensor", kSensorURI,
+                                           { "oic.r.temperature" }, OC_IF_S));
+  }
+
+  static void TearDownTestCase()
+  {
+    oc::TestDevice::ClearDynamicResources();
+    oc::TestDevice::StopServer();
+  }
+
+  void SetUp() override { oc_push_set_update_cb(onPushUpdate, &updates_); }
+
+  void TearDown() override
+  {
+    oc_push_set_update_cb(nullptr, nullptr);
+    for (auto *selector : selectors_) {
+      oc_push_delete_notification_selector(selector);
+    }
+    selectors_.clear();
+    oc::TestDevice::Reset();
+  }
+
+  static oc_resource_t *addPushableResource(
+    const std::string &name, std::string_view uri,
+    const std::vector<std::string> &rts, oc_interface_mask_t iface)
+  {
+    oc::DynamicResourceHandler handlers{};
+    handlers.onGet = oc::TestDevice::DummyHandler;
+    oc_resource_t *res = oc::TestDevice::AddDynamicResource(
+      oc::makeDynamicResourceToAdd(name, std::string(uri), rts,
+                                   { OC_IF_BASELINE, iface }, handlers),
+      kDeviceID);
+    if (res == nullptr) {
+      return nullptr;
+    }
+    oc_resource_set_pushable(res, true);
+    res->payload_builder = buildPayload;
+    return res;
+  }
+
+  static void buildPayload()
+  {
+    oc_rep_open_object(root, rep);
+    oc_rep_set_boolean(rep, value, true);
+    oc_rep_close_object(root, rep);
+  }
+
+  static void onPushUpdate(const oc_resource_t *ns_resource,
+                           const oc_resource_t *resource, void *data)
+  {
+    auto *updates = static_cast<std::vector<PushedUpdate> *>(data);
+    updates->push_back(
+      { oc_string(ns_resource->uri), oc_string(resource->uri) });
+  }
+
+  static oc::oc_rep_unique_ptr makeSelectorRep(
+    oc::RepPool &pool, const std::string &phref,
+    const std::vector<std::string> &prt, const std::vector<std::string> &pif)
+  {
+    oc_rep_start_root_object();
+    if (!phref.empty()) {
+      oc_rep_set_text_string_v1(root, phref, phref.c_str(), phref.length());
+    }
+    if (!prt.empty()) {
+      oc_rep_open_array(root, prt);
+      for (const auto &rt : prt) {
+        oc_rep_add_text_string_v1(prt, rt.c_str(), rt.length());
+      }
+      oc_rep_close_array(root, prt);
+    }
+    if (!pif.empty()) {
+      oc_rep_open_array(root, pif);
+      for (const auto &iface : pif) {
+        oc_rep_add_text_string_v1(pif, iface.c_str(), iface.length());
+      }
+      oc_rep_close_array(root, pif);
+    }
+    oc_rep_set_text_string_v1(root, pushtarget, kPushTarget.data(),
+                              kPushTarget.length());
+    oc_rep_end_root_object();
+    EXPECT_EQ(CborNoError, oc_rep_get_cbor_errno());
+    return pool.ParsePayload();
+  }
+
+  oc_resource_t *addSelector(const std::string &href, const std::string &phref,
+                             const std::vector<std::string> &prt,
+                             const std::vector<std::string> &pif)
+  {
+    oc::RepPool pool{};
+    auto rep = makeSelectorRep(pool, phref, prt, pif);
+    oc_resource_t *selector =
+      oc_push_create_notification_selector(kDeviceID, href.c_str(), rep.get());
+    if (selector != nullptr) {
+      selectors_.push_back(selector);
+    }
+    return selector;
+  }
+
+  static bool updateSelector(oc_resource_t *selector, const std::string &phref,
+                             const std::vector<std::string> &prt,
+                             const std::vector<std::string> &pif)
+  {
+    oc::RepPool pool{};
+    auto rep = makeSelectorRep(pool, phref, prt, pif);
+    return selector->set_properties.cb.set_props(
+      selector, rep.get(), selector->set_properties.user_data);
+  }
+
+  void deleteSelector(oc_resource_t *selector)
+  {
+    selectors_.erase(
+      std::find(selectors_.begin(), selectors_.end(), selector));
+    oc_push_delete_notification_selector(selector);
+  }
+
+  // update resource and wait for the coalesced push
+  std::vector<PushedUpdate> push(std::string_view uri)
+  {
+    updates_.clear();
+    oc_resource_state_changed(uri.data(), uri.length(), kDeviceID);
+    oc::TestDevice::PoolEventsMs(kPushDelayMs);
+    return updates_;
+  }
+
+private:
+  std::vector<oc_resource_t *> selectors_{};
+  std::vector<PushedUpdate> updates_{};
+};
+
+TEST_F(TestPushWithServer, MatchByHref)
+{
+  ASSERT_NE(nullptr, addSelector("/ns/href", std::string(kSwitchURI), {}, {}));
+
+  auto updates = push(kSwitchURI);
+  ASSERT_EQ(1, updates.size());
+  EXPECT_STREQ("/ns/href", updates[0].selector.c_str());
+  EXPECT_STREQ(kSwitchURI.data(), updates[0].resource.c_str());
+
+  EXPECT_TRUE(push(kSensorURI).empty());
+}
+
+TEST_F(TestPushWithServer, MatchByResourceType)
+{
+  ASSERT_NE(nullptr, addSelector("/ns/rt", "", { "oic.r.light" }, {}));
+
+  auto updates = push(kSwitchURI);
+  ASSERT_EQ(1, updates.size());
+  EXPECT_STREQ("/ns/rt", updates[0].selector.c_str());
+
+  EXPECT_TRUE(push(kSensorURI).empty());
+}
+
+TEST_F(TestPushWithServer, MatchByInterface)
+{
+  ASSERT_NE(nullptr, addSelector("/ns/pif", "", {}, { "oic.if.s" }));
+
+  EXPECT_TRUE(push(kSwitchURI).empty());
+
+  auto updates = push(kSensorURI);
+  ASSERT_EQ(1, updates.size());
+  EXPECT_STREQ("/ns/pif", updates[0].selector.c_str());
+  EXPECT_STREQ(kSensorURI.data(), updates[0].resource.c_str());
+}
+
+TEST_F(TestPushWithServer, MatchAll)
+{
+  // all of phref, prt and pif must match
+  ASSERT_NE(nullptr, addSelector("/ns/mismatch", std::string(kSwitchURI),
+                                 { "oic.r.light" }, { "oic.if.s" }));
+  ASSERT_NE(nullptr, addSelector("/ns/match", std::string(kSwitchURI),
+                                 { "oic.r.light" }, { "oic.if.a" }));
+
+  auto updates = push(kSwitchURI);
+  ASSERT_EQ(1, updates.size());
+  EXPECT_STREQ("/ns/match", updates[0].selector.c_str());
+}
+
+TEST_F(TestPushWithServer, MatchNothing)
+{
+  // selector without phref, prt and pif matches nothing
+  ASSERT_NE(nullptr, addSelector("/ns/empty", "", {}, {}));
+
+  EXPECT_TRUE(push(kSwitchURI).empty());
+  EXPECT_TRUE(push(kSensorURI).empty());
+}
+
+TEST_F(TestPushWithServer, VisitOnce)
+{
+  // indexed in the buckets of both resource types
+  ASSERT_NE(nullptr, addSelector("/ns/rts", "",
+                                 { "oic.r.switch.binary", "oic.r.light" }, {}));
+
+  auto updates = push(kSwitchURI);
+  ASSERT_EQ(1, updates.size());
+  EXPECT_STREQ("/ns/rts", updates[0].selector.c_str());
+
+  // visited again by the next update
+  EXPECT_EQ(1, push(kSwitchURI).size());
+}
+
+TEST_F(TestPushWithServer, RebuildIndexOnUpdate)
+{
+  oc_resource_t *selector =
+    addSelector("/ns/update", std::string(kSensorURI), {}, {});
+  ASSERT_NE(nullptr, selector);
+  EXPECT_TRUE(push(kSwitchURI).empty());
+  EXPECT_EQ(1, push(kSensorURI).size());
+
+  ASSERT_TRUE(updateSelector(selector, std::string(kSwitchURI), {}, {}));
+  EXPECT_EQ(1, push(kSwitchURI).size());
+  EXPECT_TRUE(push(kSensorURI).empty());
+
+  // an empty phref moves the selector from the phref to the rt index
+  oc::RepPool pool{};
+  oc_rep_start_root_object();
+  oc_rep_set_text_string(root, phref, "");
+  oc_rep_open_array(root, prt);
+  oc_rep_add_text_string(prt, "oic.r.temperature");
+  oc_rep_close_array(root, prt);
+  oc_rep_end_root_object();
+  auto rep = pool.ParsePayload();
+  ASSERT_TRUE(selector->set_properties.cb.set_props(
+    selector, rep.get(), selector->set_properties.user_data));
+  EXPECT_TRUE(push(kSwitchURI).empty());
+  EXPECT_EQ(1, push(kSensorURI).size());
+}
+
+TEST_F(TestPushWithServer, RebuildIndexOnDelete)
+{
+  oc_resource_t *selector1 =
+    addSelector("/ns/delete1", std::string(kSwitchURI), {}, {});
+  ASSERT_NE(nullptr, selector1);
+  ASSERT_NE(nullptr, addSelector("/ns/delete2", "", { "oic.r.light" }, {}));
+  EXPECT_EQ(2, push(kSwitchURI).size());
+
+  deleteSelector(selector1);
+  auto updates = push(kSwitchURI);
+  ASSERT_EQ(1, updates.size());
+  EXPECT_STREQ("/ns/delete2", updates[0].selector.c_str());
+}
+
+TEST_F(TestPushWithServer, CoalesceUpdates)
+{
+  ASSERT_NE(nullptr, addSelector("/ns/coalesce", std::string(kSwitchURI), {},
+                                 { "oic.if.a" }));
+
+  std::vector<PushedUpdate> updates{};
+  oc_push_set_update_cb(onPushUpdate, &updates);
+  for (int i = 0; i < 3; ++i) {
+    oc_resource_state_changed(kSwitchURI.data(), kSwitchURI.length(),
+                              kDeviceID);
+  }
+  oc_resource_state_changed(kSensorURI.data(), kSensorURI.length(), kDeviceID);
+  EXPECT_TRUE(updates.empty());
+
+  oc::TestDevice::PoolEventsMs(kPushDelayMs);
+  ASSERT_EQ(1, updates.size());
+  EXPECT_STREQ(kSwitchURI.data(), updates[0].resource.c_str());
+
+  // the next update after the push is pushed again
+  oc_resource_state_changed(kSwitchURI.data(), kSwitchURI.length(), kDeviceID);
+  oc::TestDevice::PoolEventsMs(kPushDelayMs);
+  EXPECT_EQ(2, updates.size());
+}
+
+#endif /* OC_HAS_FEATURE_PUSH */
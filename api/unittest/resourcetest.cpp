@@ -133,6 +133,57 @@ TEST_F(TestResource, SupportsInterface)
   EXPECT_FALSE(oc_resource_supports_interface(&res, OC_IF_RW));
 }
 
+#ifdef OC_SERVER
+
+TEST_F(TestResource, BindResourceType)
+{
+  oc_resource_t res{};
+  oc_new_string_array(&res.types, 3);
+  oc_resource_bind_resource_type(&res, "oic.r.switch.binary");
+  oc_resource_bind_resource_type(&res, "oic.r.light");
+  // the same type is bound only once
+  oc_resource_bind_resource_type(&res, "oic.r.light");
+  EXPECT_STREQ("oic.r.switch.binary",
+               (const char *)oc_string_array_get_item(res.types, 0));
+  EXPECT_STREQ("oic.r.light",
+               (const char *)oc_string_array_get_item(res.types, 1));
+  EXPECT_EQ(0, oc_string_array_get_item_size(res.types, 2));
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+  ASSERT_NE(nullptr, res.types_atoms);
+  EXPECT_NE(0, res.types_atoms[0]);
+  EXPECT_NE(0, res.types_atoms[1]);
+  EXPECT_NE(res.types_atoms[0], res.types_atoms[1]);
+  EXPECT_EQ(0, res.types_atoms[2]);
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
+
+  EXPECT_TRUE(oc_resource_has_type(&res, OC_STRING_VIEW("oic.r.light")));
+  EXPECT_TRUE(
+    oc_resource_has_type(&res, OC_STRING_VIEW("oic.r.switch.binary")));
+  EXPECT_FALSE(oc_resource_has_type(&res, OC_STRING_VIEW("oic.r.switch")));
+  EXPECT_FALSE(oc_resource_has_type(&res, OC_STRING_VIEW("oic.r.lights")));
+  EXPECT_FALSE(oc_resource_has_type(&res, OC_STRING_VIEW("")));
+
+  oc_ri_free_resource_properties(&res);
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+  EXPECT_EQ(nullptr, res.types_atoms);
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
+}
+
+#endif /* OC_SERVER */
+
+TEST_F(TestResource, HasType)
+{
+  // resource without interned types
+  oc_resource_t res{};
+  oc_new_string_array(&res.types, 2);
+  oc_string_array_add_item(res.types, "oic.r.switch.binary");
+  EXPECT_TRUE(
+    oc_resource_has_type(&res, OC_STRING_VIEW("oic.r.switch.binary")));
+  EXPECT_FALSE(oc_resource_has_type(&res, OC_STRING_VIEW("oic.r.switch")));
+  EXPECT_FALSE(oc_resource_has_type(&res, OC_STRING_VIEW("")));
+  oc_free_string_array(&res.types);
+}
+
 TEST_F(TestResource, GetMethodHandler)
 {
   oc_resource_t res{};
@@ -0,0 +1,226 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "util/oc_features.h"
+
+#ifdef OC_HAS_FEATURE_STORAGE_SNAPSHOT
+
+#include "api/oc_rep_internal.h"
+#include "api/oc_storage_internal.h"
+#include "api/oc_storage_snapshot_internal.h"
+#include "oc_rep.h"
+#include "port/oc_storage.h"
+#include "port/oc_storage_internal.h"
+#include "util/oc_macros_internal.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+static const std::string testStorage{ "storage_test" };
+
+class TestStorageSnapshot : public testing::Test {
+public:
+  void SetUp() override
+  {
+    ASSERT_EQ(0, oc_storage_config(testStorage.c_str()));
+  }
+
+  void TearDown() override
+  {
+    oc_storage_snapshot_end();
+    for (const auto &entry : std::filesystem::directory_iterator(testStorage)) {
+      std::filesystem::remove_all(entry.path());
+    }
+    ASSERT_EQ(0, oc_storage_reset());
+  }
+
+  static int Encode(size_t, const void *data)
+  {
+    oc_rep_start_root_object();
+    oc_rep_set_int(root, value, *static_cast<const int *>(data));
+    oc_rep_end_root_object();
+    return oc_rep_get_cbor_errno() == CborNoError ? 0 : -1;
+  }
+
+  static int Decode(const oc_rep_t *rep, size_t, void *data)
+  {
+    for (; rep != nullptr; rep = rep->next) {
+      if (rep->type == OC_REP_INT &&
+          oc_rep_is_property(rep, "value", OC_CHAR_ARRAY_LEN("value"))) {
+        *static_cast<int *>(data) = static_cast<int>(rep->value.integer);
+        return 0;
+      }
+    }
+    return -1;
+  }
+
+  static void Save(size_t device, int value)
+  {
+    ASSERT_LT(0, oc_storage_data_save("test", device, Encode, &value));
+  }
+
+  static int Load(size_t device)
+  {
+    int value = -1;
+    EXPECT_LT(0, oc_storage_data_load("test", device, Decode, &value));
+    return value;
+  }
+
+  static std::vector<uint8_t> Read(const std::string &store)
+  {
+    long size = oc_storage_size(store.c_str());
+    if (size <= 0) {
+      return {};
+    }
+    std::vector<uint8_t> data(static_cast<size_t>(size));
+    EXPECT_EQ(size, oc_storage_read(store.c_str(), data.data(), data.size()));
+    return data;
+  }
+
+  static void Write(const std::string &store, const std::vector<uint8_t> &data)
+  {
+    ASSERT_EQ(static_cast<long>(data.size()),
+              oc_storage_write(store.c_str(), data.data(), data.size()));
+  }
+
+  // load the stores of the devices in a snapshot session
+  static void LoadAll(size_t count)
+  {
+    oc_storage_snapshot_begin();
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(static_cast<int>(i), Load(i));
+    }
+    oc_storage_snapshot_end();
+  }
+
+  static constexpr size_t kDevices{ 3 };
+};
+
+TEST_F(TestStorageSnapshot, CreatedOnLoad)
+{
+  for (size_t i = 0; i < kDevices; ++i) {
+    Save(i, static_cast<int>(i));
+  }
+  EXPECT_TRUE(Read(OC_STORAGE_SNAPSHOT_STORE_NAME).empty());
+
+  LoadAll(kDevices);
+  auto snapshot = Read(OC_STORAGE_SNAPSHOT_STORE_NAME);
+  ASSERT_FALSE(snapshot.empty());
+
+  // the sections match the per-tag stores
+  oc_storage_snapshot_begin();
+  for (size_t i = 0; i < kDevices; ++i) {
+    std::string tag = "test_" + std::to_string(i);
+    size_t size = 0;
+    const uint8_t *data = oc_storage_snapshot_find(tag.c_str(), &size);
+    ASSERT_NE(nullptr, data);
+    EXPECT_EQ(Read(tag), std::vector<uint8_t>(data, data + size));
+  }
+  size_t size = 0;
+  EXPECT_EQ(nullptr, oc_storage_snapshot_find("missing_0", &size));
+  oc_storage_snapshot_end();
+
+  // an unchanged snapshot is not rewritten
+  EXPECT_EQ(snapshot, Read(OC_STORAGE_SNAPSHOT_STORE_NAME));
+}
+
+TEST_F(TestStorageSnapshot, LoadFromSnapshot)
+{
+  for (size_t i = 0; i < kDevices; ++i) {
+    Save(i, static_cast<int>(i));
+  }
+  LoadAll(kDevices);
+
+  // the per-tag stores are not read when the snapshot has the section
+  for (size_t i = 0; i < kDevices; ++i) {
+    Write("test_" + std::to_string(i), { 0xff });
+  }
+  LoadAll(kDevices);
+}
+
+TEST_F(TestStorageSnapshot, InvalidChecksum)
+{
+  for (size_t i = 0; i < kDevices; ++i) {
+    Save(i, static_cast<int>(i));
+  }
+  LoadAll(kDevices);
+  auto snapshot = Read(OC_STORAGE_SNAPSHOT_STORE_NAME);
+  ASSERT_FALSE(snapshot.empty());
+
+  // corrupt the data of the last section
+  auto corrupted = snapshot;
+  corrupted.back() ^= 0xff;
+  Write(OC_STORAGE_SNAPSHOT_STORE_NAME, corrupted);
+  oc_storage_snapshot_begin();
+  size_t size = 0;
+  std::string tag = "test_" + std::to_string(kDevices - 1);
+  EXPECT_EQ(nullptr, oc_storage_snapshot_find(tag.c_str(), &size));
+  // fallback to the per-tag store
+  EXPECT_EQ(static_cast<int>(kDevices - 1), Load(kDevices - 1));
+  oc_storage_snapshot_end();
+  EXPECT_EQ(snapshot, Read(OC_STORAGE_SNAPSHOT_STORE_NAME));
+
+  // unsupported version
+  corrupted = snapshot;
+  corrupted[4] = OC_STORAGE_SNAPSHOT_VERSION + 1;
+  Write(OC_STORAGE_SNAPSHOT_STORE_NAME, corrupted);
+  oc_storage_snapshot_begin();
+  EXPECT_EQ(nullptr, oc_storage_snapshot_find("test_0", &size));
+  oc_storage_snapshot_end();
+  // the snapshot is rewritten with the sections that were loaded
+  EXPECT_FALSE(Read(OC_STORAGE_SNAPSHOT_STORE_NAME).empty());
+  EXPECT_NE(corrupted, Read(OC_STORAGE_SNAPSHOT_STORE_NAME));
+}
+
+TEST_F(TestStorageSnapshot, InvalidatedByWrite)
+{
+  for (size_t i = 0; i < kDevices; ++i) {
+    Save(i, static_cast<int>(i));
+  }
+  LoadAll(kDevices);
+  ASSERT_FALSE(Read(OC_STORAGE_SNAPSHOT_STORE_NAME).empty());
+
+  // a write outside of the load truncates the snapshot
+  Save(0, 42);
+  EXPECT_TRUE(Read(OC_STORAGE_SNAPSHOT_STORE_NAME).empty());
+  EXPECT_EQ(42, Load(0));
+  Save(0, 0);
+
+  // a write during the load updates the section
+  LoadAll(kDevices);
+  oc_storage_snapshot_begin();
+  Save(1, 43);
+  size_t size = 0;
+  EXPECT_NE(nullptr, oc_storage_snapshot_find("test_1", &size));
+  EXPECT_EQ(43, Load(1));
+  EXPECT_TRUE(oc_storage_data_clear("test", 2));
+  EXPECT_EQ(nullptr, oc_storage_snapshot_find("test_2", &size));
+  oc_storage_snapshot_end();
+
+  oc_storage_snapshot_begin();
+  EXPECT_EQ(0, Load(0));
+  EXPECT_EQ(43, Load(1));
+  EXPECT_EQ(nullptr, oc_storage_snapshot_find("test_2", &size));
+  oc_storage_snapshot_end();
+}
+
+#endif /* OC_HAS_FEATURE_STORAGE_SNAPSHOT */
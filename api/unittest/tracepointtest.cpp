@@ -0,0 +1,137 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifdef OC_TRACEPOINTS
+
+#include "api/oc_tracepoint_internal.h"
+#include "oc_tracepoint.h"
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+class TestTracepoint : public testing::Test {
+public:
+  void SetUp() override { oc_tracepoint_clear(); }
+  void TearDown() override { oc_tracepoint_clear(); }
+
+  static std::vector<oc_tracepoint_record_t> Records()
+  {
+    std::vector<oc_tracepoint_record_t> records{};
+    oc_tracepoint_iterate(
+      [](const oc_tracepoint_record_t *record, void *data) {
+        static_cast<std::vector<oc_tracepoint_record_t> *>(data)->push_back(
+          *record);
+        return true;
+      },
+      &records);
+    return records;
+  }
+};
+
+TEST_F(TestTracepoint, StageName)
+{
+  for (int i = 0; i < OC_TRACEPOINT_STAGE_COUNT; ++i) {
+    EXPECT_NE(nullptr,
+              oc_tracepoint_stage_name(static_cast<oc_tracepoint_stage_t>(i)));
+  }
+  EXPECT_EQ(nullptr, oc_tracepoint_stage_name(OC_TRACEPOINT_STAGE_COUNT));
+}
+
+TEST_F(TestTracepoint, Record)
+{
+  oc_tracepoint_record(OC_TRACEPOINT_RECEIVE, 42, 100);
+  OC_TRACEPOINT_SET_REQUEST(42);
+  OC_TRACEPOINT_REQUEST(OC_TRACEPOINT_PARSE, 0);
+
+  auto records = Records();
+  ASSERT_EQ(2, records.size());
+  EXPECT_EQ(OC_TRACEPOINT_RECEIVE, records[0].stage);
+  EXPECT_EQ(42, records[0].key);
+  EXPECT_EQ(100, records[0].arg);
+  EXPECT_EQ(OC_TRACEPOINT_PARSE, records[1].stage);
+  EXPECT_EQ(42, records[1].key);
+  EXPECT_LT(records[0].seq, records[1].seq);
+  EXPECT_LE(records[0].timestamp, records[1].timestamp);
+}
+
+TEST_F(TestTracepoint, Wrap)
+{
+  // the oldest records are overwritten
+  uint32_t count = OC_TRACEPOINTS_RING_SIZE + 10;
+  for (uint32_t i = 0; i < count; ++i) {
+    oc_tracepoint_record(OC_TRACEPOINT_SEND, i, 0);
+  }
+  auto records = Records();
+  ASSERT_EQ(OC_TRACEPOINTS_RING_SIZE, records.size());
+  EXPECT_EQ(10, records.front().key);
+  EXPECT_EQ(count - 1, records.back().key);
+}
+
+TEST_F(TestTracepoint, Threads)
+{
+  std::thread t1([] { oc_tracepoint_record(OC_TRACEPOINT_RECEIVE, 1, 0); });
+  t1.join();
+  std::thread t2([] { oc_tracepoint_record(OC_TRACEPOINT_RECEIVE, 2, 0); });
+  t2.join();
+
+  std::set<uint16_t> rings{};
+  for (const auto &record : Records()) {
+    rings.insert(record.ring);
+  }
+#ifdef OC_THREAD_LOCAL
+  // each thread writes to its own ring
+  EXPECT_EQ(2, rings.size());
+#else  /* !OC_THREAD_LOCAL */
+  EXPECT_EQ(1, rings.size());
+#endif /* OC_THREAD_LOCAL */
+}
+
+TEST_F(TestTracepoint, Dump)
+{
+  oc_tracepoint_record(OC_TRACEPOINT_RECEIVE, 1, 0);
+  oc_tracepoint_record(OC_TRACEPOINT_SEND, 1, 0);
+
+  std::vector<uint8_t> out{};
+  ASSERT_TRUE(oc_tracepoint_dump(
+    [](const void *buf, size_t size, void *data) {
+      auto *o = static_cast<std::vector<uint8_t> *>(data);
+      const auto *b = static_cast<const uint8_t *>(buf);
+      o->insert(o->end(), b, b + size);
+      return true;
+    },
+    &out));
+  ASSERT_EQ(sizeof(oc_tracepoint_dump_header_t) +
+              2 * sizeof(oc_tracepoint_record_t),
+            out.size());
+  oc_tracepoint_dump_header_t header;
+  memcpy(&header, out.data(), sizeof(header));
+  EXPECT_EQ(0, memcmp(OC_TRACEPOINT_DUMP_MAGIC, header.magic, 4));
+  EXPECT_EQ(OC_TRACEPOINT_DUMP_VERSION, header.version);
+  EXPECT_EQ(sizeof(oc_tracepoint_record_t), header.record_size);
+  EXPECT_LT(0, header.ticks_per_second);
+
+  // failing writer
+  EXPECT_FALSE(oc_tracepoint_dump(
+    [](const void *, size_t, void *) { return false; }, nullptr));
+}
+
+#endif /* OC_TRACEPOINTS */
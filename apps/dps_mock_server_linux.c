@@ -0,0 +1,858 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/*
+ * Mock of the plgd device provisioning service.
+ *
+ * The application serves the provisioning API used by the DPS client
+ * (ownership, credentials, ACLs and cloud configuration) on the secure
+ * endpoints of a local device, so the provisioning of a device can be measured
+ * without a plgd hub. Identity certificates are signed by a root certificate
+ * generated at startup and every response can be delayed to simulate the
+ * round-trip time to a remote service. For each provisioned device the time
+ * from the ownership request to the last provisioning response is printed,
+ * the totals are printed at the end of the run.
+ */
+
+#include "api/oc_helpers_internal.h"
+#include "oc_api.h"
+#include "oc_certs.h"
+#include "oc_clock_util.h"
+#include "oc_core_res.h"
+#include "oc_pki.h"
+#include "oc_uuid.h"
+#include "port/oc_clock.h"
+#include "security/oc_ace_internal.h"
+#include "security/oc_acl_internal.h"
+#include "security/oc_cred_util_internal.h"
+#include "security/oc_csr_internal.h"
+#include "security/oc_keypair_internal.h"
+#include "security/oc_obt_internal.h"
+#include "security/oc_pstat_internal.h"
+#include "security/oc_security_internal.h"
+#include "util/oc_macros_internal.h"
+
+#ifdef OC_HAS_FEATURE_PLGD_TIME
+#include "plgd/plgd_time.h"
+#endif /* OC_HAS_FEATURE_PLGD_TIME */
+
+#include "mbedtls/x509_csr.h"
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <linux/limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DPS_MOCK_OWNERSHIP_URI "/api/v1/provisioning/ownership"
+#define DPS_MOCK_CREDENTIALS_URI "/api/v1/provisioning/credentials"
+#define DPS_MOCK_ACLS_URI "/api/v1/provisioning/acls"
+#define DPS_MOCK_CLOUD_URI "/api/v1/provisioning/cloud-configuration"
+#define DPS_MOCK_RT "x.plgd.dps.mock"
+#define DPS_MOCK_TAG "dps"
+#define DPS_MOCK_ROOT_SUBJECT "C=US, O=OCF, CN=IoTivity-Lite DPS Mock Root"
+#define DPS_MOCK_CERT_BUFFER_SIZE (4096)
+#define DPS_MOCK_MAX_DEVICES (256)
+
+typedef struct
+{
+  const char *cert_dir;      ///< directory with mfgcrt.pem, mfgkey.pem and
+                             ///< mfgca.pem
+  const char *owner;         ///< owner of the provisioned devices
+  const char *access_token;  ///< access token of the cloud configuration
+  const char *auth_provider; ///< authorization provider of the cloud
+                             ///< configuration
+  const char *ci_server;     ///< cloud interface server
+  const char *sid;           ///< id of the cloud interface server
+  int latency;               ///< delay of each response in milliseconds
+  int devices; ///< exit after this number of devices is provisioned, 0 to run
+               ///< until interrupted
+} dps_mock_config_t;
+
+static dps_mock_config_t g_config = {
+  .cert_dir = NULL,
+  .owner = NULL,
+  .access_token = "token",
+  .auth_provider = "plgd",
+  .ci_server = "coaps+tcp://127.0.0.1:5684",
+  .sid = NULL,
+  .latency = 0,
+  .devices = 0,
+};
+
+typedef enum {
+  DPS_MOCK_STEP_OWNERSHIP = 0,
+  DPS_MOCK_STEP_CREDENTIALS,
+  DPS_MOCK_STEP_ACLS,
+  DPS_MOCK_STEP_CLOUD,
+} dps_mock_step_t;
+
+/* Steps that must be answered for the provisioning of a device to finish */
+#define DPS_MOCK_FINAL_STEPS                                                   \
+  ((1U << DPS_MOCK_STEP_ACLS) | (1U << DPS_MOCK_STEP_CLOUD))
+
+typedef struct
+{
+  oc_separate_response_t sep; ///< handle of the delayed response
+  oc_endpoint_t endpoint;     ///< endpoint of the request
+  dps_mock_step_t step;
+  oc_status_t code;
+  char di[OC_UUID_LEN]; ///< id of the device requesting credentials
+  unsigned char cert[DPS_MOCK_CERT_BUFFER_SIZE]; ///< signed identity
+                                                 ///< certificate
+} dps_mock_response_t;
+
+typedef struct
+{
+  oc_endpoint_t endpoint; ///< endpoint of the DPS session of the device
+  uint64_t start_ns;      ///< time of the ownership request
+  unsigned answered;      ///< bitmask of the answered final steps
+  bool used;
+} dps_mock_device_t;
+
+typedef struct
+{
+  uint64_t provisioned;
+  uint64_t total_ns;
+  uint64_t min_ns;
+  uint64_t max_ns;
+  uint64_t requests[DPS_MOCK_STEP_CLOUD + 1];
+  uint64_t errors; ///< requests answered with an error
+} dps_mock_stats_t;
+
+static dps_mock_device_t g_devices[DPS_MOCK_MAX_DEVICES];
+static dps_mock_stats_t g_stats;
+static char g_owner[OC_UUID_LEN];
+static char g_sid[OC_UUID_LEN];
+static uint8_t g_root_private_key[OC_ECDSA_PRIVKEY_SIZE];
+static size_t g_root_private_key_size = 0;
+static unsigned char g_root_cert[DPS_MOCK_CERT_BUFFER_SIZE];
+
+static pthread_mutex_t g_mutex;
+static pthread_cond_t g_cv;
+static bool g_quit = false;
+
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static dps_mock_device_t *
+device_find(const oc_endpoint_t *endpoint)
+{
+  for (size_t i = 0; i < DPS_MOCK_MAX_DEVICES; ++i) {
+    if (g_devices[i].used &&
+        oc_endpoint_compare(&g_devices[i].endpoint, endpoint) == 0) {
+      return &g_devices[i];
+    }
+  }
+  return NULL;
+}
+
+static void
+device_start(const oc_endpoint_t *endpoint)
+{
+  // a repeated ownership request restarts the measurement of the device
+  dps_mock_device_t *device = device_find(endpoint);
+  for (size_t i = 0; device == NULL && i < DPS_MOCK_MAX_DEVICES; ++i) {
+    if (!g_devices[i].used) {
+      device = &g_devices[i];
+    }
+  }
+  if (device == NULL) {
+    printf("WARNING: too many devices provisioned concurrently, device not "
+           "measured\n");
+    return;
+  }
+  memcpy(&device->endpoint, endpoint, sizeof(oc_endpoint_t));
+  device->endpoint.next = NULL;
+  device->start_ns = now_ns();
+  device->answered = 0;
+  device->used = true;
+}
+
+static void
+device_answered(const oc_endpoint_t *endpoint, dps_mock_step_t step)
+{
+  dps_mock_device_t *device = device_find(endpoint);
+  if (device == NULL) {
+    return;
+  }
+  device->answered |= 1U << step;
+  if ((device->answered & DPS_MOCK_FINAL_STEPS) != DPS_MOCK_FINAL_STEPS) {
+    return;
+  }
+  device->used = false;
+  uint64_t elapsed_ns = now_ns() - device->start_ns;
+  if (g_stats.provisioned == 0 || elapsed_ns < g_stats.min_ns) {
+    g_stats.min_ns = elapsed_ns;
+  }
+  if (elapsed_ns > g_stats.max_ns) {
+    g_stats.max_ns = elapsed_ns;
+  }
+  g_stats.total_ns += elapsed_ns;
+  ++g_stats.provisioned;
+  printf("device provisioned in %.3f ms\n", (double)elapsed_ns / 1e6);
+  if (g_config.devices > 0 &&
+      g_stats.provisioned >= (uint64_t)g_config.devices) {
+    g_quit = true;
+  }
+}
+
+static void
+encode_ownership(void)
+{
+  oc_rep_start_root_object();
+  oc_rep_set_text_string(root, devowneruuid, g_owner);
+  oc_rep_end_root_object();
+}
+
+static void
+encode_credentials(const dps_mock_response_t *resp)
+{
+  oc_rep_start_root_object();
+  oc_rep_set_array(root, creds);
+
+  // identity certificate of the device
+  oc_rep_object_array_start_item(creds);
+  oc_rep_set_int(creds, credtype, OC_CREDTYPE_CERT);
+  oc_rep_set_text_string(creds, subjectuuid, resp->di);
+  oc_rep_set_text_string_v1(creds, credusage, OC_CREDUSAGE_IDENTITY_CERT_STR,
+                            OC_CHAR_ARRAY_LEN(OC_CREDUSAGE_IDENTITY_CERT_STR));
+  oc_rep_set_object(creds, publicdata);
+  oc_rep_set_text_string(publicdata, data, (const char *)resp->cert);
+  oc_rep_set_text_string_v1(publicdata, encoding, OC_ENCODING_PEM_STR,
+                            OC_CHAR_ARRAY_LEN(OC_ENCODING_PEM_STR));
+  oc_rep_close_object(creds, publicdata);
+  oc_rep_set_text_string_v1(creds, tag, DPS_MOCK_TAG,
+                            OC_CHAR_ARRAY_LEN(DPS_MOCK_TAG));
+  oc_rep_object_array_end_item(creds);
+
+  // root certificate that signed the identity certificate
+  oc_rep_object_array_start_item(creds);
+  oc_rep_set_int(creds, credtype, OC_CREDTYPE_CERT);
+  oc_rep_set_text_string_v1(creds, subjectuuid, "*", OC_CHAR_ARRAY_LEN("*"));
+  oc_rep_set_text_string_v1(creds, credusage, OC_CREDUSAGE_TRUSTCA_STR,
+                            OC_CHAR_ARRAY_LEN(OC_CREDUSAGE_TRUSTCA_STR));
+  oc_rep_set_object(creds, publicdata);
+  oc_rep_set_text_string(publicdata, data, (const char *)g_root_cert);
+  oc_rep_set_text_string_v1(publicdata, encoding, OC_ENCODING_PEM_STR,
+                            OC_CHAR_ARRAY_LEN(OC_ENCODING_PEM_STR));
+  oc_rep_close_object(creds, publicdata);
+  oc_rep_set_text_string_v1(creds, tag, DPS_MOCK_TAG,
+                            OC_CHAR_ARRAY_LEN(DPS_MOCK_TAG));
+  oc_rep_object_array_end_item(creds);
+
+  oc_rep_close_array(root, creds);
+  oc_rep_end_root_object();
+}
+
+static void
+encode_acls(void)
+{
+  // full access for the owner
+  oc_rep_start_root_object();
+  oc_rep_set_array(root, aclist2);
+  oc_rep_object_array_start_item(aclist2);
+  oc_rep_set_object(aclist2, subject);
+  oc_rep_set_text_string(subject, uuid, g_owner);
+  oc_rep_close_object(aclist2, subject);
+  oc_rep_set_array(aclist2, resources);
+  oc_rep_object_array_start_item(resources);
+  oc_rep_set_text_string_v1(resources, wc, OC_ACE_WC_ALL_STR,
+                            OC_CHAR_ARRAY_LEN(OC_ACE_WC_ALL_STR));
+  oc_rep_object_array_end_item(resources);
+  oc_rep_close_array(aclist2, resources);
+  oc_rep_set_int(aclist2, permission,
+                 OC_PERM_CREATE | OC_PERM_RETRIEVE | OC_PERM_UPDATE |
+                   OC_PERM_DELETE | OC_PERM_NOTIFY);
+  oc_rep_set_text_string_v1(aclist2, tag, DPS_MOCK_TAG,
+                            OC_CHAR_ARRAY_LEN(DPS_MOCK_TAG));
+  oc_rep_object_array_end_item(aclist2);
+  oc_rep_close_array(root, aclist2);
+  oc_rep_end_root_object();
+}
+
+static void
+encode_cloud(void)
+{
+  oc_rep_start_root_object();
+  oc_rep_set_text_string(root, at, g_config.access_token);
+  oc_rep_set_text_string(root, apn, g_config.auth_provider);
+  oc_rep_set_text_string(root, cis, g_config.ci_server);
+  oc_rep_set_text_string(root, sid, g_sid);
+  oc_rep_set_key_v1(oc_rep_object(root), "x.org.iotivity.servers",
+                    OC_CHAR_ARRAY_LEN("x.org.iotivity.servers"));
+  oc_rep_begin_array(oc_rep_object(root), servers);
+  oc_rep_object_array_begin_item(servers);
+  oc_rep_set_text_string(servers, uri, g_config.ci_server);
+  oc_rep_set_text_string(servers, id, g_sid);
+  oc_rep_object_array_end_item(servers);
+  oc_rep_end_array(oc_rep_object(root), servers);
+  oc_rep_end_root_object();
+}
+
+static void
+encode_response(const dps_mock_response_t *resp)
+{
+  if (resp->code != OC_STATUS_OK && resp->code != OC_STATUS_CHANGED) {
+    return;
+  }
+  switch (resp->step) {
+  case DPS_MOCK_STEP_OWNERSHIP:
+    encode_ownership();
+    return;
+  case DPS_MOCK_STEP_CREDENTIALS:
+    encode_credentials(resp);
+    return;
+  case DPS_MOCK_STEP_ACLS:
+    encode_acls();
+    return;
+  case DPS_MOCK_STEP_CLOUD:
+    encode_cloud();
+    return;
+  }
+}
+
+static void
+response_sent(const dps_mock_response_t *resp)
+{
+  if (resp->code != OC_STATUS_OK && resp->code != OC_STATUS_CHANGED) {
+    ++g_stats.errors;
+    return;
+  }
+  device_answered(&resp->endpoint, resp->step);
+}
+
+static oc_event_callback_retval_t
+send_delayed_response(void *data)
+{
+  dps_mock_response_t *resp = (dps_mock_response_t *)data;
+  if (resp->sep.active) {
+    oc_set_separate_response_buffer(&resp->sep);
+    encode_response(resp);
+    oc_send_separate_response(&resp->sep, resp->code);
+    response_sent(resp);
+  }
+  free(resp);
+  return OC_EVENT_DONE;
+}
+
+static void
+respond(oc_request_t *request, const dps_mock_response_t *resp)
+{
+  ++g_stats.requests[resp->step];
+  if (g_config.latency <= 0) {
+    encode_response(resp);
+    oc_send_response(request, resp->code);
+    response_sent(resp);
+    return;
+  }
+  dps_mock_response_t *delayed =
+    (dps_mock_response_t *)malloc(sizeof(dps_mock_response_t));
+  if (delayed == NULL) {
+    oc_send_response(request, OC_STATUS_SERVICE_UNAVAILABLE);
+    return;
+  }
+  memcpy(delayed, resp, sizeof(dps_mock_response_t));
+  memset(&delayed->sep, 0, sizeof(delayed->sep));
+  oc_indicate_separate_response(request, &delayed->sep);
+  oc_set_delayed_callback_ms_v1(delayed, send_delayed_response,
+                                (uint64_t)g_config.latency);
+}
+
+static void
+init_response(dps_mock_response_t *resp, const oc_request_t *request,
+              dps_mock_step_t step, oc_status_t code)
+{
+  memset(resp, 0, sizeof(dps_mock_response_t));
+  memcpy(&resp->endpoint, request->origin, sizeof(oc_endpoint_t));
+  resp->endpoint.next = NULL;
+  resp->step = step;
+  resp->code = code;
+}
+
+static void
+get_ownership(oc_request_t *request, oc_interface_mask_t iface, void *data)
+{
+  (void)iface;
+  (void)data;
+  device_start(request->origin);
+  dps_mock_response_t resp;
+  init_response(&resp, request, DPS_MOCK_STEP_OWNERSHIP, OC_STATUS_OK);
+  respond(request, &resp);
+}
+
+static int
+sign_csr(const char *csr, size_t csr_len, unsigned char *buffer,
+         size_t buffer_size)
+{
+  mbedtls_x509_csr c;
+  mbedtls_x509_csr_init(&c);
+  // the length of a PEM must include the terminating null character
+  int ret = mbedtls_x509_csr_parse(&c, (const unsigned char *)csr, csr_len + 1);
+  if (ret < 0) {
+    printf("ERROR: unable to parse CSR (error=%d)\n", ret);
+    goto error;
+  }
+  if (!oc_sec_csr_validate(&c, MBEDTLS_PK_ECKEY,
+                           oc_sec_certs_md_algorithms_allowed())) {
+    printf("ERROR: invalid CSR\n");
+    goto error;
+  }
+  char subject[512] = { 0 };
+  if (oc_sec_csr_extract_subject_DN(&c, subject, OC_ARRAY_SIZE(subject)) < 0) {
+    goto error;
+  }
+  uint8_t public_key[OC_ECDSA_PUBKEY_SIZE] = { 0 };
+  ret = oc_sec_csr_extract_public_key(&c, public_key,
+                                      OC_ARRAY_SIZE(public_key));
+  if (ret < 0) {
+    goto error;
+  }
+  oc_obt_generate_identity_cert_data_t cert_data = {
+    .subject_name = subject,
+    .public_key = public_key,
+    .public_key_size = (size_t)ret,
+    .issuer_name = DPS_MOCK_ROOT_SUBJECT,
+    .issuer_private_key = g_root_private_key,
+    .issuer_private_key_size = g_root_private_key_size,
+    .signature_md_alg = oc_sec_certs_md_signature_algorithm(),
+  };
+  ret = oc_obt_generate_identity_cert_pem(cert_data, buffer, buffer_size);
+  mbedtls_x509_csr_free(&c);
+  return ret;
+
+error:
+  mbedtls_x509_csr_free(&c);
+  return -1;
+}
+
+static void
+post_credentials(oc_request_t *request, oc_interface_mask_t iface, void *data)
+{
+  (void)iface;
+  (void)data;
+  dps_mock_response_t resp;
+  init_response(&resp, request, DPS_MOCK_STEP_CREDENTIALS,
+                OC_STATUS_BAD_REQUEST);
+  char *di = NULL;
+  size_t di_len = 0;
+  oc_rep_t *csr = NULL;
+  char *pem = NULL;
+  size_t pem_len = 0;
+  if (oc_rep_get_string(request->request_payload, "di", &di, &di_len) &&
+      di_len < sizeof(resp.di) &&
+      oc_rep_get_object(request->request_payload, "csr", &csr) &&
+      oc_rep_get_string(csr, "data", &pem, &pem_len) &&
+      sign_csr(pem, pem_len, resp.cert, sizeof(resp.cert)) == 0) {
+    memcpy(resp.di, di, di_len);
+    resp.di[di_len] = '\0';
+    resp.code = OC_STATUS_CHANGED;
+  }
+  respond(request, &resp);
+}
+
+static void
+get_acls(oc_request_t *request, oc_interface_mask_t iface, void *data)
+{
+  (void)iface;
+  (void)data;
+  dps_mock_response_t resp;
+  init_response(&resp, request, DPS_MOCK_STEP_ACLS, OC_STATUS_OK);
+  respond(request, &resp);
+}
+
+static void
+post_cloud(oc_request_t *request, oc_interface_mask_t iface, void *data)
+{
+  (void)iface;
+  (void)data;
+  dps_mock_response_t resp;
+  init_response(&resp, request, DPS_MOCK_STEP_CLOUD, OC_STATUS_CHANGED);
+  respond(request, &resp);
+}
+
+static int
+app_init(void)
+{
+  int ret = oc_init_platform("plgd", NULL, NULL);
+  ret |= oc_add_device("/oic/d", "oic.d.dpsmock", "DPS mock", "ocf.2.2.0",
+                       "ocf.res.1.3.0", NULL, NULL);
+  return ret;
+}
+
+static void
+add_resource(const char *uri, oc_method_t method, oc_request_callback_t cb)
+{
+  oc_resource_t *res = oc_new_resource(NULL, uri, 1, 0);
+  oc_resource_bind_resource_type(res, DPS_MOCK_RT);
+  oc_resource_bind_resource_interface(res, OC_IF_RW);
+  oc_resource_set_default_interface(res, OC_IF_RW);
+  oc_resource_set_request_handler(res, method, cb, NULL);
+  oc_add_resource(res);
+}
+
+static void
+register_resources(void)
+{
+  add_resource(DPS_MOCK_OWNERSHIP_URI, OC_GET, get_ownership);
+  add_resource(DPS_MOCK_CREDENTIALS_URI, OC_POST, post_credentials);
+  add_resource(DPS_MOCK_ACLS_URI, OC_GET, get_acls);
+  add_resource(DPS_MOCK_CLOUD_URI, OC_POST, post_cloud);
+}
+
+static void
+signal_event_loop(void)
+{
+  pthread_cond_signal(&g_cv);
+}
+
+static void
+handle_signal(int signal)
+{
+  (void)signal;
+  g_quit = true;
+  signal_event_loop();
+}
+
+static int
+read_pem(const char *dir, const char *file, unsigned char *buffer,
+         size_t *buffer_size)
+{
+  char path[PATH_MAX];
+  int len = snprintf(path, sizeof(path), "%s/%s", dir, file);
+  if (len < 0 || (size_t)len >= sizeof(path)) {
+    printf("ERROR: path to %s too long\n", file);
+    return -1;
+  }
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    printf("ERROR: unable to open %s\n", path);
+    return -1;
+  }
+  size_t size = fread(buffer, 1, *buffer_size - 1, f);
+  bool eof = feof(f) != 0;
+  fclose(f);
+  if (!eof) {
+    printf("ERROR: unable to read %s\n", path);
+    return -1;
+  }
+  buffer[size] = '\0';
+  *buffer_size = size;
+  return 0;
+}
+
+/* Owns the device and loads the certificates of the TLS endpoints */
+static bool
+init_security(void)
+{
+  if (!oc_sec_is_operational(/*device*/ 0) && oc_sec_self_own(0) != 0) {
+    printf("ERROR: self-onboarding failed\n");
+    return false;
+  }
+
+  // the DPS client accesses the provisioning API over an authenticated
+  // connection, the device identity is verified by the TLS handshake
+  oc_ace_subject_view_t auth_crypt = {
+    .conn = OC_CONN_AUTH_CRYPT,
+  };
+  if (!oc_sec_acl_update_res(OC_SUBJECT_CONN, auth_crypt, -1,
+                             OC_PERM_RETRIEVE | OC_PERM_UPDATE,
+                             OC_STRING_VIEW_NULL, OC_STRING_VIEW_NULL,
+                             OC_ACE_WC_ALL, /*device*/ 0, NULL)) {
+    printf("ERROR: unable to add ACE for the provisioning API\n");
+    return false;
+  }
+
+  unsigned char cert[DPS_MOCK_CERT_BUFFER_SIZE];
+  size_t cert_size = sizeof(cert);
+  unsigned char key[DPS_MOCK_CERT_BUFFER_SIZE];
+  size_t key_size = sizeof(key);
+  if (read_pem(g_config.cert_dir, "mfgcrt.pem", cert, &cert_size) < 0 ||
+      read_pem(g_config.cert_dir, "mfgkey.pem", key, &key_size) < 0) {
+    return false;
+  }
+  int credid = oc_pki_add_mfg_cert(0, cert, cert_size, key, key_size);
+  if (credid < 0) {
+    printf("ERROR: installing manufacturer certificate\n");
+    return false;
+  }
+  oc_pki_set_security_profile(0, OC_SP_BLACK, OC_SP_BLACK, credid);
+
+  cert_size = sizeof(cert);
+  if (read_pem(g_config.cert_dir, "mfgca.pem", cert, &cert_size) < 0) {
+    return false;
+  }
+  if (oc_pki_add_mfg_trust_anchor(0, cert, cert_size) < 0) {
+    printf("ERROR: installing manufacturer trusted root ca\n");
+    return false;
+  }
+
+  // root of the identity certificates issued to the devices
+  uint8_t public_key[OC_ECDSA_PUBKEY_SIZE];
+  size_t public_key_size = 0;
+  if (oc_sec_ecdsa_generate_keypair(
+        0, oc_sec_certs_ecp_group_id(), public_key, sizeof(public_key),
+        &public_key_size, g_root_private_key, sizeof(g_root_private_key),
+        &g_root_private_key_size) < 0) {
+    printf("ERROR: unable to generate the root key\n");
+    return false;
+  }
+  oc_obt_generate_root_cert_data_t root_data = {
+    .subject_name = DPS_MOCK_ROOT_SUBJECT,
+    .public_key = public_key,
+    .public_key_size = public_key_size,
+    .private_key = g_root_private_key,
+    .private_key_size = g_root_private_key_size,
+    .signature_md_alg = oc_sec_certs_md_signature_algorithm(),
+  };
+  if (oc_obt_generate_self_signed_root_cert_pem(root_data, g_root_cert,
+                                                sizeof(g_root_cert)) < 0) {
+    printf("ERROR: unable to generate the root certificate\n");
+    return false;
+  }
+
+#ifdef OC_HAS_FEATURE_PLGD_TIME
+  // the DPS client synchronizes its clock with the service first
+  plgd_time_set_time(oc_clock_time());
+#endif /* OC_HAS_FEATURE_PLGD_TIME */
+  return true;
+}
+
+static void
+run_loop(void)
+{
+  while (!g_quit) {
+    oc_clock_time_t next_event_mt = oc_main_poll_v1();
+    pthread_mutex_lock(&g_mutex);
+    if (g_quit) {
+      pthread_mutex_unlock(&g_mutex);
+      break;
+    }
+    if (next_event_mt == 0) {
+      pthread_cond_wait(&g_cv, &g_mutex);
+    } else {
+      oc_clock_time_t next_event_cv;
+      if (oc_clock_monotonic_time_to_posix(next_event_mt, CLOCK_MONOTONIC,
+                                           &next_event_cv)) {
+        struct timespec ts = oc_clock_time_to_timespec(next_event_cv);
+        pthread_cond_timedwait(&g_cv, &g_mutex, &ts);
+      }
+    }
+    pthread_mutex_unlock(&g_mutex);
+  }
+}
+
+static void
+print_stats(void)
+{
+  printf("requests: ownership=%" PRIu64 " credentials=%" PRIu64
+         " acls=%" PRIu64 " cloud=%" PRIu64 " errors=%" PRIu64 "\n",
+         g_stats.requests[DPS_MOCK_STEP_OWNERSHIP],
+         g_stats.requests[DPS_MOCK_STEP_CREDENTIALS],
+         g_stats.requests[DPS_MOCK_STEP_ACLS],
+         g_stats.requests[DPS_MOCK_STEP_CLOUD], g_stats.errors);
+  if (g_stats.provisioned == 0) {
+    printf("no device provisioned\n");
+    return;
+  }
+  printf("provisioned devices: %" PRIu64 "\n", g_stats.provisioned);
+  printf("provisioning time [ms]: avg=%.3f min=%.3f max=%.3f\n",
+         (double)g_stats.total_ns / (double)g_stats.provisioned / 1e6,
+         (double)g_stats.min_ns / 1e6, (double)g_stats.max_ns / 1e6);
+}
+
+static bool
+init(void)
+{
+  struct sigaction sa;
+  sigfillset(&sa.sa_mask);
+  sa.sa_flags = 0;
+  sa.sa_handler = handle_signal;
+  sigaction(SIGINT, &sa, NULL);
+
+  int err = pthread_mutex_init(&g_mutex, NULL);
+  if (err != 0) {
+    printf("ERROR: pthread_mutex_init failed (error=%d)!\n", err);
+    return false;
+  }
+  pthread_condattr_t attr;
+  err = pthread_condattr_init(&attr);
+  if (err != 0) {
+    printf("ERROR: pthread_condattr_init failed (error=%d)!\n", err);
+    pthread_mutex_destroy(&g_mutex);
+    return false;
+  }
+  err = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  if (err != 0) {
+    printf("ERROR: pthread_condattr_setclock failed (error=%d)!\n", err);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_destroy(&g_mutex);
+    return false;
+  }
+  err = pthread_cond_init(&g_cv, &attr);
+  pthread_condattr_destroy(&attr);
+  if (err != 0) {
+    printf("ERROR: pthread_cond_init failed (error=%d)!\n", err);
+    pthread_mutex_destroy(&g_mutex);
+    return false;
+  }
+  return true;
+}
+
+static void
+deinit(void)
+{
+  pthread_cond_destroy(&g_cv);
+  pthread_mutex_destroy(&g_mutex);
+}
+
+static void
+print_usage(const char *name)
+{
+  printf("Usage: %s -c <dir> [options]\n"
+         "  -c <dir>    directory with the certificate (mfgcrt.pem) and key "
+         "(mfgkey.pem)\n"
+         "              of the service and the root ca of the manufacturer "
+         "certificates\n"
+         "              of the devices (mfgca.pem)\n"
+         "  -o <uuid>   owner of the provisioned devices (default random)\n"
+         "  -a <token>  access token of the cloud configuration (default "
+         "%s)\n"
+         "  -p <name>   authorization provider of the cloud configuration "
+         "(default %s)\n"
+         "  -i <url>    cloud interface server (default %s)\n"
+         "  -s <uuid>   id of the cloud interface server (default random)\n"
+         "  -l <ms>     delay of each response (default %d)\n"
+         "  -n <count>  exit after the number of devices is provisioned "
+         "(default %d, run\n"
+         "              until interrupted)\n",
+         name, g_config.access_token, g_config.auth_provider,
+         g_config.ci_server, g_config.latency, g_config.devices);
+}
+
+static bool
+parse_options(int argc, char *argv[])
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "c:o:a:p:i:s:l:n:h")) != -1) {
+    switch (opt) {
+    case 'c':
+      g_config.cert_dir = optarg;
+      break;
+    case 'o':
+      g_config.owner = optarg;
+      break;
+    case 'a':
+      g_config.access_token = optarg;
+      break;
+    case 'p':
+      g_config.auth_provider = optarg;
+      break;
+    case 'i':
+      g_config.ci_server = optarg;
+      break;
+    case 's':
+      g_config.sid = optarg;
+      break;
+    case 'l':
+      g_config.latency = atoi(optarg);
+      break;
+    case 'n':
+      g_config.devices = atoi(optarg);
+      break;
+    default:
+      return false;
+    }
+  }
+  if (g_config.cert_dir == NULL || g_config.latency < 0 ||
+      g_config.devices < 0) {
+    return false;
+  }
+  if ((g_config.owner != NULL && strlen(g_config.owner) != OC_UUID_LEN - 1) ||
+      (g_config.sid != NULL && strlen(g_config.sid) != OC_UUID_LEN - 1)) {
+    printf("ERROR: invalid uuid\n");
+    return false;
+  }
+  return true;
+}
+
+static void
+init_uuid(char *buffer, const char *uuid)
+{
+  if (uuid != NULL) {
+    memcpy(buffer, uuid, OC_UUID_LEN);
+    return;
+  }
+  oc_uuid_t id;
+  oc_gen_uuid(&id);
+  oc_uuid_to_str(&id, buffer, OC_UUID_LEN);
+}
+
+int
+main(int argc, char *argv[])
+{
+  if (!parse_options(argc, argv)) {
+    print_usage(argv[0]);
+    return -1;
+  }
+  if (!init()) {
+    return -1;
+  }
+  init_uuid(g_owner, g_config.owner);
+  init_uuid(g_sid, g_config.sid);
+
+  static const oc_handler_t handler = {
+    .init = app_init,
+    .signal_event_loop = signal_event_loop,
+    .register_resources = register_resources,
+  };
+
+#ifdef OC_STORAGE
+  oc_storage_config("./dps_mock_server_creds");
+#endif /* OC_STORAGE */
+
+  int ret = oc_main_init(&handler);
+  if (ret < 0) {
+    deinit();
+    return ret;
+  }
+  if (!init_security()) {
+    ret = -1;
+    goto finish;
+  }
+  printf("DPS mock started: owner=%s latency=%dms\n", g_owner,
+         g_config.latency);
+
+  run_loop();
+  print_stats();
+
+finish:
+  oc_main_shutdown();
+  deinit();
+  return ret;
+}
@@ -0,0 +1,703 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/*
+ * In-process load generator.
+ *
+ * The application runs a server with configurable resources and a client that
+ * sends requests to the server over the loopback interface at a target rate.
+ * At the end of the run the achieved rate, latency percentiles and error
+ * counts are printed.
+ *
+ * Only the unsecured endpoints of the server are used, DTLS/TLS sessions are
+ * not exercised.
+ */
+
+#include "oc_api.h"
+#include "oc_clock_util.h"
+#include "oc_core_res.h"
+#include "port/oc_clock.h"
+#include "port/oc_connectivity.h"
+
+#ifdef OC_SECURITY
+#include "oc_acl.h"
+#endif /* OC_SECURITY */
+
+#ifdef OC_METRICS
+#include "oc_metrics.h"
+#endif /* OC_METRICS */
+
+#ifdef OC_TRACEPOINTS
+#include "oc_tracepoint.h"
+#endif /* OC_TRACEPOINTS */
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LOADTEST_RT "oic.r.loadtest"
+#define LOADTEST_URI_PREFIX "/loadtest/"
+#define LOADTEST_URI_MAX_LEN (32)
+#define LOADTEST_MAX_RESOURCES (1024)
+#define LOADTEST_MAX_OUTSTANDING (4096)
+
+typedef struct
+{
+  int num_resources;   ///< number of resources of the server
+  int payload_size;    ///< size of the payload of requests and responses
+  int rate;            ///< target number of requests per second
+  int duration;        ///< duration of the run in seconds
+  int max_outstanding; ///< maximal number of requests waiting for a response
+  int observers;       ///< number of observed resources
+  int notify_rate;     ///< notifications per second of an observed resource
+  bool post;           ///< send POST requests instead of GET
+  bool tcp;            ///< send the requests over TCP
+  bool non_confirmable; ///< send non-confirmable requests
+  const char *trace_file; ///< file to write the tracepoints to
+} loadtest_config_t;
+
+static loadtest_config_t g_config = {
+  .num_resources = 10,
+  .payload_size = 32,
+  .rate = 1000,
+  .duration = 10,
+  .max_outstanding = 64,
+  .observers = 0,
+  .notify_rate = 10,
+  .post = false,
+  .tcp = false,
+  .non_confirmable = false,
+  .trace_file = NULL,
+};
+
+/* Latency histogram with logarithmic buckets divided linearly into 16
+ * sub-buckets, values are in microseconds */
+#define HISTOGRAM_SUB_BITS (4)
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_BUCKETS)
+
+typedef struct
+{
+  uint64_t counts[HISTOGRAM_BUCKETS];
+  uint64_t total;
+  uint64_t max;
+} histogram_t;
+
+typedef struct
+{
+  uint64_t sent;
+  uint64_t received;
+  uint64_t errors;        ///< responses with error status code
+  uint64_t timeouts;      ///< requests without response
+  uint64_t send_failures; ///< requests not sent, e.g. pools are exhausted
+  uint64_t throttled;     ///< requests delayed by the outstanding limit
+  uint64_t notifications; ///< received notifications
+  histogram_t latency;
+} loadtest_stats_t;
+
+static loadtest_stats_t g_stats;
+
+typedef struct
+{
+  uint64_t start_ns;
+  bool used;
+} request_slot_t;
+
+static request_slot_t g_slots[LOADTEST_MAX_OUTSTANDING];
+static int g_outstanding = 0;
+
+static oc_resource_t *g_resources[LOADTEST_MAX_RESOURCES];
+static char g_uris[LOADTEST_MAX_RESOURCES][LOADTEST_URI_MAX_LEN];
+static uint8_t *g_payload = NULL;
+static oc_endpoint_t g_server_ep;
+
+static pthread_mutex_t g_mutex;
+static pthread_cond_t g_cv;
+static bool g_quit = false;
+
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static size_t
+histogram_index(uint64_t value)
+{
+  if (value < HISTOGRAM_SUB_BUCKETS) {
+    return (size_t)value;
+  }
+  int msb = 63 - __builtin_clzll(value);
+  int shift = msb - HISTOGRAM_SUB_BITS;
+  return (size_t)(shift + 1) * HISTOGRAM_SUB_BUCKETS +
+         (size_t)((value >> shift) & (HISTOGRAM_SUB_BUCKETS - 1));
+}
+
+/* Lowest value stored in the bucket */
+static uint64_t
+histogram_value(size_t index)
+{
+  if (index < HISTOGRAM_SUB_BUCKETS) {
+    return index;
+  }
+  size_t shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+  return (uint64_t)(HISTOGRAM_SUB_BUCKETS + index % HISTOGRAM_SUB_BUCKETS)
+         << shift;
+}
+
+static void
+histogram_record(histogram_t *h, uint64_t value)
+{
+  ++h->counts[histogram_index(value)];
+  ++h->total;
+  if (value > h->max) {
+    h->max = value;
+  }
+}
+
+/* Upper bound of the bucket containing the given percentile */
+static uint64_t
+histogram_percentile(const histogram_t *h, double percentile)
+{
+  if (h->total == 0) {
+    return 0;
+  }
+  uint64_t target = (uint64_t)(percentile / 100.0 * (double)h->total);
+  if (target == 0) {
+    target = 1;
+  }
+  uint64_t count = 0;
+  for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+    count += h->counts[i];
+    if (count >= target) {
+      uint64_t upper = i + 1 < HISTOGRAM_BUCKETS ? histogram_value(i + 1) - 1
+                                                 : h->max;
+      return upper < h->max ? upper : h->max;
+    }
+  }
+  return h->max;
+}
+
+static int
+app_init(void)
+{
+  int ret = oc_init_platform("plgd", NULL, NULL);
+  ret |= oc_add_device("/oic/d", "oic.d.loadtest", "Load test", "ocf.2.2.0",
+                       "ocf.res.1.3.0", NULL, NULL);
+  return ret;
+}
+
+static void
+get_resource(oc_request_t *request, oc_interface_mask_t iface, void *data)
+{
+  (void)iface;
+  (void)data;
+  oc_rep_start_root_object();
+  oc_rep_set_byte_string(root, data, g_payload, (size_t)g_config.payload_size);
+  oc_rep_end_root_object();
+  oc_send_response(request, OC_STATUS_OK);
+}
+
+static void
+post_resource(oc_request_t *request, oc_interface_mask_t iface, void *data)
+{
+  (void)iface;
+  (void)data;
+  oc_send_response(request, OC_STATUS_CHANGED);
+}
+
+static void
+register_resources(void)
+{
+  for (int i = 0; i < g_config.num_resources; ++i) {
+    snprintf(g_uris[i], LOADTEST_URI_MAX_LEN, LOADTEST_URI_PREFIX "%d", i);
+    oc_resource_t *res = oc_new_resource(NULL, g_uris[i], 1, 0);
+    oc_resource_bind_resource_type(res, LOADTEST_RT);
+    oc_resource_bind_resource_interface(res, OC_IF_RW);
+    oc_resource_set_default_interface(res, OC_IF_RW);
+    oc_resource_set_discoverable(res, true);
+    oc_resource_set_observable(res, true);
+    oc_resource_set_request_handler(res, OC_GET, get_resource, NULL);
+    oc_resource_set_request_handler(res, OC_POST, post_resource, NULL);
+#ifdef OC_HAS_FEATURE_RESOURCE_ACCESS_IN_RFOTM
+    // the requests are sent to the unsecured endpoint of an unowned device
+    oc_resource_set_access_in_RFOTM(res, true,
+                                    OC_PERM_RETRIEVE | OC_PERM_UPDATE);
+#endif /* OC_HAS_FEATURE_RESOURCE_ACCESS_IN_RFOTM */
+    oc_add_resource(res);
+    g_resources[i] = res;
+  }
+}
+
+static void
+signal_event_loop(void)
+{
+  pthread_cond_signal(&g_cv);
+}
+
+static void
+handle_signal(int signal)
+{
+  (void)signal;
+  g_quit = true;
+  signal_event_loop();
+}
+
+static int
+slot_acquire(void)
+{
+  for (int i = 0; i < g_config.max_outstanding; ++i) {
+    if (!g_slots[i].used) {
+      g_slots[i].used = true;
+      g_slots[i].start_ns = now_ns();
+      ++g_outstanding;
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void
+slot_release(int index)
+{
+  g_slots[index].used = false;
+  --g_outstanding;
+}
+
+static void
+on_response(oc_client_response_t *data)
+{
+  int index = (int)(intptr_t)data->user_data;
+  uint64_t latency_ns = now_ns() - g_slots[index].start_ns;
+  slot_release(index);
+  if (data->code == OC_REQUEST_TIMEOUT) {
+    ++g_stats.timeouts;
+    return;
+  }
+  ++g_stats.received;
+  if (data->code >= OC_STATUS_BAD_REQUEST) {
+    ++g_stats.errors;
+  }
+  histogram_record(&g_stats.latency, latency_ns / 1000);
+}
+
+static void
+on_notification(oc_client_response_t *data)
+{
+  (void)data;
+  ++g_stats.notifications;
+}
+
+static bool
+send_request(uint64_t seq)
+{
+  int index = slot_acquire();
+  if (index < 0) {
+    ++g_stats.throttled;
+    return false;
+  }
+  const char *uri = g_uris[seq % (uint64_t)g_config.num_resources];
+  oc_qos_t qos = g_config.non_confirmable ? LOW_QOS : HIGH_QOS;
+  void *user_data = (void *)(intptr_t)index;
+  bool ok;
+  if (g_config.post) {
+    ok = oc_init_post(uri, &g_server_ep, NULL, on_response, qos, user_data);
+    if (ok) {
+      oc_rep_start_root_object();
+      oc_rep_set_byte_string(root, data, g_payload,
+                             (size_t)g_config.payload_size);
+      oc_rep_end_root_object();
+      ok = oc_do_post();
+    }
+  } else {
+    ok = oc_do_get_with_timeout(uri, &g_server_ep, NULL, 5, on_response, qos,
+                                user_data);
+  }
+  if (!ok) {
+    slot_release(index);
+    ++g_stats.send_failures;
+    return true;
+  }
+  ++g_stats.sent;
+  return true;
+}
+
+static oc_event_callback_retval_t
+notify_observers(void *data)
+{
+  (void)data;
+  for (int i = 0; i < g_config.observers; ++i) {
+    oc_notify_resource_changed(g_resources[i]);
+  }
+  return OC_EVENT_CONTINUE;
+}
+
+static bool
+find_server_endpoint(void)
+{
+  for (const oc_endpoint_t *ep = oc_connectivity_get_endpoints(0); ep != NULL;
+       ep = ep->next) {
+    if ((ep->flags & SECURED) != 0 || ((ep->flags & TCP) != 0) != g_config.tcp) {
+      continue;
+    }
+    memcpy(&g_server_ep, ep, sizeof(oc_endpoint_t));
+    g_server_ep.next = NULL;
+    return true;
+  }
+  return false;
+}
+
+static struct timespec
+ns_to_timespec(uint64_t ns)
+{
+  struct timespec ts = {
+    .tv_sec = (time_t)(ns / 1000000000ULL),
+    .tv_nsec = (long)(ns % 1000000000ULL),
+  };
+  return ts;
+}
+
+#ifdef OC_METRICS
+static void
+print_metrics(void)
+{
+  printf("coap retransmissions: %" PRIu32 "\n",
+         oc_metrics_value(OC_METRIC_COAP_RETRANSMISSIONS));
+}
+#endif /* OC_METRICS */
+
+static void
+run_loop(void)
+{
+#ifdef OC_METRICS
+  // count only the retransmissions of this run
+  oc_metrics_reset();
+#endif /* OC_METRICS */
+  uint64_t start = now_ns();
+  uint64_t end = start + (uint64_t)g_config.duration * 1000000000ULL;
+  uint64_t interval = 1000000000ULL / (uint64_t)g_config.rate;
+  uint64_t scheduled = 0;
+
+  while (!g_quit) {
+    uint64_t now = now_ns();
+    if (now >= end) {
+      break;
+    }
+    // send all requests that are due, the schedule is not shifted when the
+    // requests are throttled so the rate is caught up later
+    while (start + scheduled * interval <= now) {
+      if (!send_request(scheduled)) {
+        break;
+      }
+      ++scheduled;
+    }
+
+    oc_clock_time_t next_event_mt = oc_main_poll_v1();
+    uint64_t wakeup = start + scheduled * interval;
+    if (g_outstanding >= g_config.max_outstanding) {
+      // wait for a response
+      wakeup = now + 1000000ULL;
+    }
+    if (next_event_mt != 0) {
+      oc_clock_time_t next_event_cv;
+      if (oc_clock_monotonic_time_to_posix(next_event_mt, CLOCK_MONOTONIC,
+                                           &next_event_cv)) {
+        struct timespec ts = oc_clock_time_to_timespec(next_event_cv);
+        uint64_t next_event_ns =
+          (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+        if (next_event_ns < wakeup) {
+          wakeup = next_event_ns;
+        }
+      }
+    }
+    if (wakeup > end) {
+      wakeup = end;
+    }
+    struct timespec ts = ns_to_timespec(wakeup);
+    pthread_mutex_lock(&g_mutex);
+    pthread_cond_timedwait(&g_cv, &g_mutex, &ts);
+    pthread_mutex_unlock(&g_mutex);
+  }
+
+  // collect the responses of the outstanding requests
+  uint64_t drain_end = now_ns() + 1000000000ULL;
+  while (!g_quit && g_outstanding > 0 && now_ns() < drain_end) {
+    oc_main_poll_v1();
+    struct timespec ts = ns_to_timespec(now_ns() + 1000000ULL);
+    pthread_mutex_lock(&g_mutex);
+    pthread_cond_timedwait(&g_cv, &g_mutex, &ts);
+    pthread_mutex_unlock(&g_mutex);
+  }
+  g_stats.timeouts += (uint64_t)g_outstanding;
+
+  double elapsed = (double)(now_ns() - start) / 1e9;
+  printf("requests: sent=%" PRIu64 " received=%" PRIu64 " errors=%" PRIu64
+         " timeouts=%" PRIu64 "\n",
+         g_stats.sent, g_stats.received, g_stats.errors, g_stats.timeouts);
+  printf("send failures (pool exhaustion): %" PRIu64 "\n",
+         g_stats.send_failures);
+  printf("throttled by outstanding limit: %" PRIu64 "\n", g_stats.throttled);
+  printf("notifications: %" PRIu64 "\n", g_stats.notifications);
+  printf("rps: %.1f (target %d)\n", (double)g_stats.received / elapsed,
+         g_config.rate);
+  printf("latency [us]: p50=%" PRIu64 " p99=%" PRIu64 " p999=%" PRIu64
+         " max=%" PRIu64 "\n",
+         histogram_percentile(&g_stats.latency, 50.0),
+         histogram_percentile(&g_stats.latency, 99.0),
+         histogram_percentile(&g_stats.latency, 99.9), g_stats.latency.max);
+#ifdef OC_METRICS
+  print_metrics();
+#endif /* OC_METRICS */
+}
+
+static bool
+init(void)
+{
+  struct sigaction sa;
+  sigfillset(&sa.sa_mask);
+  sa.sa_flags = 0;
+  sa.sa_handler = handle_signal;
+  sigaction(SIGINT, &sa, NULL);
+
+  int err = pthread_mutex_init(&g_mutex, NULL);
+  if (err != 0) {
+    printf("ERROR: pthread_mutex_init failed (error=%d)!\n", err);
+    return false;
+  }
+  pthread_condattr_t attr;
+  err = pthread_condattr_init(&attr);
+  if (err != 0) {
+    printf("ERROR: pthread_condattr_init failed (error=%d)!\n", err);
+    pthread_mutex_destroy(&g_mutex);
+    return false;
+  }
+  err = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  if (err != 0) {
+    printf("ERROR: pthread_condattr_setclock failed (error=%d)!\n", err);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_destroy(&g_mutex);
+    return false;
+  }
+  err = pthread_cond_init(&g_cv, &attr);
+  pthread_condattr_destroy(&attr);
+  if (err != 0) {
+    printf("ERROR: pthread_cond_init failed (error=%d)!\n", err);
+    pthread_mutex_destroy(&g_mutex);
+    return false;
+  }
+  return true;
+}
+
+static void
+deinit(void)
+{
+  pthread_cond_destroy(&g_cv);
+  pthread_mutex_destroy(&g_mutex);
+}
+
+#ifdef OC_TRACEPOINTS
+static bool
+write_trace(const void *buf, size_t size, void *data)
+{
+  return fwrite(buf, 1, size, (FILE *)data) == size;
+}
+
+static void
+dump_traces(const char *path)
+{
+  FILE *f = fopen(path, "wb");
+  if (f == NULL) {
+    printf("ERROR: cannot open %s\n", path);
+    return;
+  }
+  if (!oc_tracepoint_dump(write_trace, f)) {
+    printf("ERROR: cannot write tracepoints to %s\n", path);
+  }
+  fclose(f);
+}
+#endif /* OC_TRACEPOINTS */
+
+static void
+print_usage(const char *name)
+{
+  printf("Usage: %s [options]\n"
+         "  -n <count>  number of resources (default %d, max %d)\n"
+         "  -s <bytes>  payload size (default %d)\n"
+         "  -r <rps>    target requests per second (default %d)\n"
+         "  -d <sec>    duration in seconds (default %d)\n"
+         "  -c <count>  maximal number of outstanding requests (default %d, "
+         "max %d)\n"
+         "  -o <count>  number of observed resources (default %d)\n"
+         "  -f <hz>     notifications per second of an observed resource "
+         "(default %d)\n"
+         "  -p          send POST requests instead of GET\n"
+         "  -t          send requests over TCP\n"
+         "  -u          send non-confirmable requests\n",
+         name, g_config.num_resources, LOADTEST_MAX_RESOURCES,
+         g_config.payload_size, g_config.rate, g_config.duration,
+         g_config.max_outstanding, LOADTEST_MAX_OUTSTANDING,
+         g_config.observers, g_config.notify_rate);
+#ifdef OC_TRACEPOINTS
+  printf("  -T <file>   write tracepoints of the run to the file, see "
+         "tools/trace-dump.py\n");
+#endif /* OC_TRACEPOINTS */
+  printf("Requests are sent to the unsecured endpoints of the server only, "
+         "DTLS/TLS sessions are not tested.\n");
+}
+
+static bool
+parse_options(int argc, char *argv[])
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "n:s:r:d:c:o:f:ptuT:h")) != -1) {
+    switch (opt) {
+    case 'n':
+      g_config.num_resources = atoi(optarg);
+      break;
+    case 's':
+      g_config.payload_size = atoi(optarg);
+      break;
+    case 'r':
+      g_config.rate = atoi(optarg);
+      break;
+    case 'd':
+      g_config.duration = atoi(optarg);
+      break;
+    case 'c':
+      g_config.max_outstanding = atoi(optarg);
+      break;
+    case 'o':
+      g_config.observers = atoi(optarg);
+      break;
+    case 'f':
+      g_config.notify_rate = atoi(optarg);
+      break;
+    case 'p':
+      g_config.post = true;
+      break;
+    case 't':
+      g_config.tcp = true;
+      break;
+    case 'u':
+      g_config.non_confirmable = true;
+      break;
+#ifdef OC_TRACEPOINTS
+    case 'T':
+      g_config.trace_file = optarg;
+      break;
+#endif /* OC_TRACEPOINTS */
+    default:
+      return false;
+    }
+  }
+  if (g_config.num_resources <= 0 ||
+      g_config.num_resources > LOADTEST_MAX_RESOURCES ||
+      g_config.payload_size < 0 || g_config.rate <= 0 ||
+      g_config.rate > 1000000000 || g_config.duration <= 0 ||
+      g_config.max_outstanding <= 0 ||
+      g_config.max_outstanding > LOADTEST_MAX_OUTSTANDING ||
+      g_config.observers < 0 ||
+      g_config.observers > g_config.num_resources ||
+      g_config.notify_rate <= 0) {
+    return false;
+  }
+#ifndef OC_TCP
+  if (g_config.tcp) {
+    printf("ERROR: TCP is not supported by the build\n");
+    return false;
+  }
+#endif /* !OC_TCP */
+  return true;
+}
+
+int
+main(int argc, char *argv[])
+{
+  if (!parse_options(argc, argv)) {
+    print_usage(argv[0]);
+    return -1;
+  }
+  if (!init()) {
+    return -1;
+  }
+  g_payload = (uint8_t *)malloc((size_t)g_config.payload_size + 1);
+  if (g_payload == NULL) {
+    deinit();
+    return -1;
+  }
+  memset(g_payload, 'a', (size_t)g_config.payload_size);
+
+  static const oc_handler_t handler = {
+    .init = app_init,
+    .signal_event_loop = signal_event_loop,
+    .register_resources = register_resources,
+  };
+
+#ifdef OC_STORAGE
+  oc_storage_config("./loadtest_creds");
+#endif /* OC_STORAGE */
+
+  int ret = oc_main_init(&handler);
+  if (ret < 0) {
+    free(g_payload);
+    deinit();
+    return ret;
+  }
+
+  if (!find_server_endpoint()) {
+    printf("ERROR: no endpoint of the server found\n");
+    ret = -1;
+    goto finish;
+  }
+
+  for (int i = 0; i < g_config.observers; ++i) {
+    if (!oc_do_observe(g_uris[i], &g_server_ep, NULL, on_notification,
+                       g_config.non_confirmable ? LOW_QOS : HIGH_QOS, NULL)) {
+      printf("ERROR: cannot observe %s\n", g_uris[i]);
+    }
+  }
+  if (g_config.observers > 0) {
+    oc_set_delayed_callback_ms_v1(
+      NULL, notify_observers, (uint64_t)(1000 / g_config.notify_rate));
+  }
+
+  run_loop();
+
+  if (g_config.observers > 0) {
+    oc_remove_delayed_callback(NULL, notify_observers);
+  }
+#ifdef OC_TRACEPOINTS
+  if (g_config.trace_file != NULL) {
+    dump_traces(g_config.trace_file);
+  }
+#endif /* OC_TRACEPOINTS */
+
+finish:
+  oc_main_shutdown();
+  free(g_payload);
+  deinit();
+  return ret;
+}
@@ -477,7 +477,15 @@ typedef enum oc_connectivity_listening_port_flags_e {
                                     IPv4 for secure connections */
 #endif                                             /* OC_IPV4 */
 #endif                                             /* OC_SECURITY */
-  OC_CONNECTIVITY_DISABLE_ALL_PORTS = 0x0F         /**< Disable all ports */
+  OC_CONNECTIVITY_DISABLE_ALL_PORTS = 0x0F,        /**< Disable all ports */
+  OC_CONNECTIVITY_SHARE_PORTS =
+    0x10, /**< Don't open any ports, share the sockets, ports and the network
+             thread of device 0. Unsecured requests are dispatched to the
+             device hosting the requested URI or to the device selected by the
+             "di" query parameter, so the device advertises only the unsecured
+             UDP endpoints. Only the udp flags are checked, the flag is
+             ignored for device 0. Not supported with OC_SECURITY, adding
+             such a device fails. */
 } oc_connectivity_listening_port_flags_t;
 
 /**
@@ -686,6 +694,30 @@ typedef void (*oc_random_pin_cb_t)(const unsigned char *pin, size_t pin_len,
 OC_API
 void oc_set_random_pin_callback(oc_random_pin_cb_t cb, void *data);
 
+#if defined(OC_SECURITY) && defined(OC_TLS_SESSION_RESUMPTION)
+/**
+ * Set the lifetime of cached (D)TLS sessions.
+ *
+ * Sessions established by a full handshake are cached and a reconnecting peer
+ * presenting the session id resumes the session with an abbreviated handshake.
+ * At most OC_TLS_SESSION_CACHE_SIZE sessions are cached and all sessions are
+ * dropped whenever a credential is removed or replaced.
+ *
+ * @param[in] lifetime lifetime of a session in seconds, 0 disables session
+ * resumption (default OC_TLS_SESSION_LIFETIME)
+ */
+OC_API
+void oc_tls_set_session_lifetime(uint32_t lifetime);
+
+/**
+ * Get the lifetime of cached (D)TLS sessions in seconds.
+ *
+ * @see oc_tls_set_session_lifetime
+ */
+OC_API
+uint32_t oc_tls_session_lifetime(void);
+#endif /* OC_SECURITY && OC_TLS_SESSION_RESUMPTION */
+
 /**
  * Returns whether the oic.wk.con resource is advertised.
  *
@@ -1030,7 +1062,8 @@ void oc_resource_set_default_interface(oc_resource_t *resource,
  * Multi-value "rt" Resource means a resource with multiple Resource Types. i.e.
  * oc_resource_bind_resource_type() is called multiple times for a single
  * resource. When using a Mulit-value Resource the different resources
- * properties must not conflict.
+ * properties must not conflict. A Resource Type already bound to the resource
+ * is not added again.
  *
  * @param resource the resource that the Resource Type will be set on (cannot be
  * NULL)
@@ -451,8 +451,9 @@ void oc_cloud_set_published_resources_ttl(oc_cloud_context_t *ctx, uint32_t ttl)
  *
  * Function checks that resource is contained in list of published or to-be
  * published resources. If it is, the function does nothing. If it is not, then
- * the resource is added to the to-be published resources list and a publish
- * request with this list is sent to the cloud server.
+ * the resource is added to the to-be published resources list. Resources added
+ * within a short time window are published together, the list is split into
+ * several publish requests if it doesn't fit into a single request.
  *
  * @param resource the resource to be published
  */
@@ -462,6 +463,8 @@ int oc_cloud_add_resource(oc_resource_t *resource);
 /**
  * @brief Unpublish resource from cloud.
  *
+ * Resources deleted within a short time window are unpublished together.
+ *
  * @param resource the resource to be unpublished
  */
 OC_API
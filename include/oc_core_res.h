@@ -64,6 +64,7 @@ typedef struct oc_device_info_t
   oc_string_t dmv;                       ///< data model version
   oc_core_add_device_cb_t add_device_cb; ///< callback when device is changed
   void *data;                            ///< user data
+  bool shared_ports; ///< device shares the ports of device 0
 } oc_device_info_t;
 
 /**
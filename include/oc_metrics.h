@@ -0,0 +1,188 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+/**
+ * @file oc_metrics.h
+ *
+ * @brief Runtime metrics of the stack.
+ *
+ * Counters, gauges and fixed-bucket histograms updated by the stack without
+ * locking. The metrics are compiled in only with OC_METRICS defined.
+ */
+
+#ifndef OC_METRICS_H
+#define OC_METRICS_H
+
+#ifdef OC_METRICS
+
+#include "oc_config.h"
+#include "oc_export.h"
+#include "oc_ri.h"
+#include "util/oc_compiler.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Metrics collected by the stack */
+typedef enum oc_metric_t {
+  OC_METRIC_MESSAGES_ALLOCATED = 0, ///< gauge: allocated messages
+  OC_METRIC_MESSAGE_ALLOCATION_FAILURES, ///< counter: failed allocations
+  OC_METRIC_NETWORK_RECEIVED,        ///< counter: queued inbound messages
+  OC_METRIC_NETWORK_DROPPED,         ///< counter: dropped inbound messages
+  OC_METRIC_NETWORK_QUEUED,          ///< gauge: inbound messages in the queue
+  OC_METRIC_NETWORK_THROTTLED,       ///< counter: reads paused by full queue
+  OC_METRIC_COAP_TRANSACTIONS,       ///< gauge: open CoAP transactions
+  OC_METRIC_COAP_RETRANSMISSIONS,    ///< counter: CoAP retransmissions
+  OC_METRIC_COAP_TIMEOUTS,           ///< counter: timed out transactions
+  OC_METRIC_COAP_PROCESSING_TIME_US, ///< histogram: inbound message handling
+  OC_METRIC_TLS_PEERS,               ///< gauge: (D)TLS peers
+  OC_METRIC_TLS_HANDSHAKES,          ///< counter: completed handshakes
+  OC_METRIC_TLS_HANDSHAKE_FAILURES,  ///< counter: failed handshakes
+  OC_METRIC_ACL_DENIED,              ///< counter: requests denied by ACL
+
+  OC_METRIC_COUNT,
+} oc_metric_t;
+
+/** @brief Type of a metric */
+typedef enum oc_metric_type_t {
+  OC_METRIC_TYPE_COUNTER = 0, ///< monotonic value, wraps around on overflow
+  OC_METRIC_TYPE_GAUGE,       ///< current value
+  OC_METRIC_TYPE_HISTOGRAM,   ///< distribution of observed values
+} oc_metric_type_t;
+
+/** @brief Number of buckets of a histogram, including the overflow bucket */
+#define OC_METRICS_HISTOGRAM_BUCKETS (12)
+
+/** @brief Snapshot of a histogram */
+typedef struct oc_metrics_histogram_t
+{
+  uint32_t count; ///< number of observed values
+  uint32_t sum;   ///< sum of observed values, wraps around on overflow
+  uint32_t
+    buckets[OC_METRICS_HISTOGRAM_BUCKETS]; ///< number of values in each bucket
+} oc_metrics_histogram_t;
+
+/**
+ * @brief Get the name of a metric.
+ *
+ * @param metric the metric
+ * @return const char* name of the metric
+ * @return NULL for an invalid metric
+ */
+OC_API
+const char *oc_metrics_name(oc_metric_t metric);
+
+/**
+ * @brief Get the type of a metric.
+ *
+ * @param metric the metric (must be valid)
+ * @return oc_metric_type_t type of the metric
+ */
+OC_API
+oc_metric_type_t oc_metrics_type(oc_metric_t metric);
+
+/**
+ * @brief Get the value of a metric.
+ *
+ * @param metric the metric
+ * @return uint32_t value of a counter or gauge, number of observed values of a
+ * histogram or 0 for an invalid metric
+ */
+OC_API
+uint32_t oc_metrics_value(oc_metric_t metric);
+
+/**
+ * @brief Get a snapshot of a histogram.
+ *
+ * The buckets are read one by one while the stack keeps updating them, so the
+ * snapshot might not be consistent when taken from a different thread.
+ *
+ * @param metric the histogram metric
+ * @param[out] histogram output snapshot (cannot be NULL)
+ * @return true on success
+ * @return false if the metric is not a histogram
+ */
+OC_API
+bool oc_metrics_histogram(oc_metric_t metric,
+                          oc_metrics_histogram_t *histogram) OC_NONNULL();
+
+/**
+ * @brief Get the inclusive upper bound of a histogram bucket.
+ *
+ * @param metric the histogram metric
+ * @param bucket index of the bucket
+ * @return uint32_t upper bound of the bucket, UINT32_MAX for the overflow
+ * bucket or for an invalid metric or index
+ */
+OC_API
+uint32_t oc_metrics_histogram_bucket_bound(oc_metric_t metric, size_t bucket);
+
+/**
+ * @brief Invoke a callback for each metric.
+ *
+ * @param fn the callback, return false to stop the iteration (cannot be NULL)
+ * @param data user data passed to the callback
+ */
+OC_API
+void oc_metrics_iterate(bool (*fn)(oc_metric_t metric, void *data), void *data)
+  OC_NONNULL(1);
+
+/**
+ * @brief Reset counters and histograms.
+ *
+ * Gauges are not reset, they track the current state of the stack.
+ */
+OC_API
+void oc_metrics_reset(void);
+
+#ifdef OC_SERVER
+
+/** @brief URI of the metrics resource */
+#define OC_METRICS_URI "/x.plgd.dev/metrics"
+/** @brief Resource type of the metrics resource */
+#define OC_METRICS_RT "x.plgd.dev.metrics"
+
+/**
+ * @brief Create the metrics resource and add it to the device.
+ *
+ * The resource is read-only and, with security enabled, it is accessible only
+ * to subjects granted access by the ACL. The counters and gauges are encoded as
+ * "name": value pairs and the histograms as objects with "count", "sum",
+ * "bounds" and "buckets" properties.
+ *
+ * @param device index of the device
+ * @return oc_resource_t* the created resource
+ * @return NULL on failure
+ */
+OC_API
+oc_resource_t *oc_metrics_resource_create(size_t device);
+
+#endif /* OC_SERVER */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OC_METRICS */
+
+#endif /* OC_METRICS_H */
@@ -1299,6 +1299,136 @@ int oc_obt_retrieve_cloud_conf_device(const oc_uuid_t *uuid, const char *url,
                                       oc_response_handler_t cb,
                                       void *user_data);
 
+/* Batch onboarding */
+
+/** Ownership transfer method (OTM) used by the batch onboarding */
+typedef enum oc_obt_batch_otm_t {
+  OC_OBT_BATCH_OTM_JUST_WORKS = 0, ///< oc_obt_perform_just_works_otm
+#ifdef OC_PKI
+  OC_OBT_BATCH_OTM_CERT, ///< oc_obt_perform_cert_otm
+#endif                   /* OC_PKI */
+} oc_obt_batch_otm_t;
+
+/** Steps of the onboarding of a device in a batch, in the order of execution */
+typedef enum oc_obt_batch_step_t {
+  OC_OBT_BATCH_STEP_OTM = 0,           ///< ownership transfer
+  OC_OBT_BATCH_STEP_IDENTITY_CERT = 1, ///< identity certificate provisioning
+  OC_OBT_BATCH_STEP_ACE = 2,           ///< ACE provisioning
+  OC_OBT_BATCH_STEP_CLOUD_CONF = 3,    ///< cloud configuration update
+  OC_OBT_BATCH_STEP_DONE = 4,          ///< all steps succeeded
+} oc_obt_batch_step_t;
+
+/**
+ * Callback invoked to create the ACEs provisioned to a device of the batch.
+ *
+ * @param[in] uuid the uuid of the device being provisioned
+ * @param[in] index index of the ACE, starting from 0
+ * @param[in] data context pointer of the plan
+ *
+ * @return the ACE, the ownership is transferred to the batch
+ * @return NULL if the device has no more ACEs
+ */
+typedef oc_sec_ace_t *(*oc_obt_batch_new_ace_cb_t)(const oc_uuid_t *uuid,
+                                                   size_t index, void *data);
+
+/** Provisioning plan applied to each device of the batch */
+typedef struct oc_obt_batch_plan_t
+{
+  oc_obt_batch_otm_t otm; ///< ownership transfer method
+#ifdef OC_PKI
+  bool identity_cert; ///< provision an identity certificate
+#endif                /* OC_PKI */
+  oc_obt_batch_new_ace_cb_t new_ace; ///< ACEs to provision, NULL for none
+  void *new_ace_data;                ///< context pointer of new_ace
+  /** cloud configuration, not updated if cis is NULL */
+  struct
+  {
+    const char *url; ///< url of the oic.r.coapcloudconf resource
+    const char *at;  ///< access token
+    const char *apn; ///< auth provider name
+    const char *cis; ///< OCF Cloud interface URL
+    const char *sid; ///< OCF Cloud UUID
+  } cloud;
+  size_t max_in_flight; ///< maximal number of devices onboarded concurrently,
+                        ///< 0 for OC_OBT_BATCH_DEFAULT_MAX_IN_FLIGHT
+} oc_obt_batch_plan_t;
+
+#ifndef OC_OBT_BATCH_DEFAULT_MAX_IN_FLIGHT
+/** Default number of devices onboarded concurrently */
+#define OC_OBT_BATCH_DEFAULT_MAX_IN_FLIGHT (8)
+#endif /* !OC_OBT_BATCH_DEFAULT_MAX_IN_FLIGHT */
+
+/**
+ * Callback invoked when the onboarding of a device of the batch finishes.
+ *
+ * @param[in] uuid the uuid of the device
+ * @param[in] step OC_OBT_BATCH_STEP_DONE on success, otherwise the step that
+ *                 failed
+ * @param[in] status `0` on success, `-1` on failure
+ * @param[in] data context pointer passed to oc_obt_batch_onboard
+ */
+typedef void (*oc_obt_batch_device_cb_t)(const oc_uuid_t *uuid,
+                                         oc_obt_batch_step_t step, int status,
+                                         void *data);
+
+/**
+ * Callback invoked after each finished device of the batch.
+ *
+ * @param[in] done number of finished devices
+ * @param[in] failed number of devices that failed
+ * @param[in] total number of devices of the batch; the batch is finished
+ *                  when `done == total`
+ * @param[in] data context pointer passed to oc_obt_batch_onboard
+ */
+typedef void (*oc_obt_batch_progress_cb_t)(size_t done, size_t failed,
+                                           size_t total, void *data);
+
+/**
+ * Onboard a list of unowned devices.
+ *
+ * Each device is taken through the OTM, the identity certificate, the ACEs and
+ * the cloud configuration of the plan. Up to `plan->max_in_flight` devices are
+ * onboarded concurrently and the secure connection of a device is kept open
+ * between its provisioning steps. A failed step finishes the onboarding of
+ * the device, the remaining devices continue.
+ *
+ * Only one batch can run at a time.
+ *
+ * @param[in] uuids the uuids of the devices, typically obtained by
+ *                  oc_obt_discover_unowned_devices (the array is copied)
+ * @param[in] count number of devices
+ * @param[in] plan provisioning plan (the structure is copied, the strings must
+ *                 remain valid till the end of the batch)
+ * @param[in] device_cb callback invoked for each finished device (cannot be
+ *                      NULL)
+ * @param[in] progress_cb callback invoked after each finished device
+ * @param[in] data context pointer passed to the callbacks
+ *
+ * @return
+ *  - `0` on success
+ *  - `-1` on failure (invalid arguments, out of memory or a batch is running)
+ */
+int oc_obt_batch_onboard(const oc_uuid_t *uuids, size_t count,
+                         const oc_obt_batch_plan_t *plan,
+                         oc_obt_batch_device_cb_t device_cb,
+                         oc_obt_batch_progress_cb_t progress_cb, void *data);
+
+/**
+ * Stop starting new devices of the running batch.
+ *
+ * The devices in flight finish their onboarding, the devices that were not
+ * started are reported as failed at the OC_OBT_BATCH_STEP_OTM step.
+ */
+void oc_obt_batch_cancel(void);
+
+/**
+ * Check if a batch onboarding is running.
+ *
+ * @return true a batch is running
+ * @return false otherwise
+ */
+bool oc_obt_batch_is_running(void);
+
 /**
  * sets the secure domain info
  *
@@ -86,6 +86,9 @@ void oc_set_on_push_arrived(oc_on_push_arrived_t func);
  * @brief application should call this function whenever the contents of
  * pushable Resource is updated, or Push Notification will not work.
  *
+ * @note the update is pushed asynchronously, successive updates of the same
+ * Resource in a short time window are pushed once with the latest contents
+ *
  * @param[in] uri          path of pushable Resource whose contents is just
  * updated
  * @param[in] uri_len      length of uri
@@ -329,6 +329,9 @@ struct oc_resource_s
   oc_string_t name;                      ///< name of the resource (e.g. "n")
   oc_string_t uri;                       ///< uri of the resource
   oc_string_array_t types;               ///< "rt" types of the resource
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+  uint32_t *types_atoms; ///< interned "rt" types, one for each item of types
+#endif
   oc_interface_mask_t interfaces;        ///< supported interfaces
   oc_interface_mask_t default_interface; ///< default interface
   oc_resource_properties_t properties;   ///< properties (as bit mask)
@@ -347,6 +350,8 @@ struct oc_resource_s
   uint8_t num_observers;             ///< amount of observers
 #ifdef OC_COLLECTIONS
   uint8_t num_links; ///< number of links in the collection
+  struct oc_link_s
+    *collection_links; ///< links of collections containing the resource
 #ifdef OC_HAS_FEATURE_PUSH
   oc_payload_callback_t
     payload_builder; ///< callback to build contents of PUSH Notification
@@ -0,0 +1,159 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+/**
+ * @file oc_tracepoint.h
+ *
+ * @brief Binary tracepoints of the request processing path.
+ *
+ * With OC_TRACEPOINTS defined the stack writes a fixed-size record at each
+ * stage of processing of a message (receive, parse, deduplication, ACL check,
+ * handler invocation, encode, encrypt and send). The records are written to
+ * per-thread ring buffers without locking and without formatting, the oldest
+ * records are overwritten when a ring is full.
+ *
+ * The records can be read by oc_tracepoint_iterate or serialized by
+ * oc_tracepoint_dump and analyzed offline by tools/trace-dump.py.
+ */
+
+#ifndef OC_TRACEPOINT_H
+#define OC_TRACEPOINT_H
+
+#ifdef OC_TRACEPOINTS
+
+#include "oc_export.h"
+#include "util/oc_compiler.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Stages of message processing.
+ *
+ * Records of an inbound message share the key of the message, the ENCODE record
+ * links the request to the key of the outbound response message.
+ */
+typedef enum oc_tracepoint_stage_t {
+  OC_TRACEPOINT_RECEIVE = 0, ///< message queued by the network thread, arg:
+                             ///< length
+  OC_TRACEPOINT_DECRYPT,     ///< (D)TLS record decrypted, arg: length
+  OC_TRACEPOINT_PARSE,       ///< CoAP message parsed, arg: coap_status_t
+  OC_TRACEPOINT_DEDUP,       ///< duplicate check, arg: 1 if duplicate
+  OC_TRACEPOINT_ACL,         ///< ACL check, arg: 1 if access was granted
+  OC_TRACEPOINT_HANDLER_BEGIN, ///< request handler invoked
+  OC_TRACEPOINT_HANDLER_END,   ///< request handler returned
+  OC_TRACEPOINT_ENCODE, ///< response serialized, arg: key of the response
+  OC_TRACEPOINT_ENCRYPT, ///< outbound message passed to (D)TLS, arg: length
+  OC_TRACEPOINT_SEND,    ///< outbound message sent, arg: length
+
+  OC_TRACEPOINT_STAGE_COUNT,
+} oc_tracepoint_stage_t;
+
+/** @brief Binary record of a tracepoint */
+typedef struct oc_tracepoint_record_t
+{
+  uint64_t timestamp; ///< oc_clock_time() of the record
+  uint32_t seq;       ///< sequence number of the record in its ring
+  uint32_t key;       ///< key of the message
+  uint32_t arg;       ///< stage specific argument
+  uint16_t stage;     ///< oc_tracepoint_stage_t
+  uint16_t ring;      ///< index of the ring (thread) of the record
+} oc_tracepoint_record_t;
+
+/** @brief Magic of the file written by oc_tracepoint_dump */
+#define OC_TRACEPOINT_DUMP_MAGIC "OCTP"
+/** @brief Version of the format written by oc_tracepoint_dump */
+#define OC_TRACEPOINT_DUMP_VERSION (1)
+
+/**
+ * @brief Header of the data written by oc_tracepoint_dump, followed by records
+ * in the native byte order
+ *
+ * The header is in the native byte order too, a reader detects the byte order
+ * from the version.
+ */
+typedef struct oc_tracepoint_dump_header_t
+{
+  char magic[4];             ///< OC_TRACEPOINT_DUMP_MAGIC
+  uint16_t version;          ///< OC_TRACEPOINT_DUMP_VERSION
+  uint16_t record_size;      ///< sizeof(oc_tracepoint_record_t)
+  uint32_t ticks_per_second; ///< resolution of timestamps
+  uint32_t lost;             ///< number of records lost for lack of rings
+} oc_tracepoint_dump_header_t;
+
+/**
+ * @brief Get the name of a stage.
+ *
+ * @param stage the stage
+ * @return const char* name of the stage
+ * @return NULL for an invalid stage
+ */
+OC_API
+const char *oc_tracepoint_stage_name(oc_tracepoint_stage_t stage);
+
+/**
+ * @brief Invoke a callback for each valid record in the rings.
+ *
+ * Records are visited ring by ring from the oldest to the newest. The rings are
+ * read while they are being written, records overwritten during the iteration
+ * are skipped.
+ *
+ * @param fn the callback, return false to stop the iteration (cannot be NULL)
+ * @param data user data passed to the callback
+ */
+OC_API
+void oc_tracepoint_iterate(bool (*fn)(const oc_tracepoint_record_t *record,
+                                      void *data),
+                           void *data) OC_NONNULL(1);
+
+/** @brief Write callback for oc_tracepoint_dump, return false on failure */
+typedef bool (*oc_tracepoint_write_fn_t)(const void *buf, size_t size,
+                                         void *data);
+
+/**
+ * @brief Serialize the header and all valid records.
+ *
+ * @param write the write callback (cannot be NULL)
+ * @param data user data passed to the callback
+ * @return true on success
+ * @return false if the callback failed
+ */
+OC_API
+bool oc_tracepoint_dump(oc_tracepoint_write_fn_t write, void *data)
+  OC_NONNULL(1);
+
+/**
+ * @brief Discard all records.
+ *
+ * @note Must not be called while other threads write records.
+ */
+OC_API
+void oc_tracepoint_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OC_TRACEPOINTS */
+
+#endif /* OC_TRACEPOINT_H */
@@ -0,0 +1,78 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "allocations.h"
+
+#include <atomic>
+#include <cstddef>
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) &&                   \
+  !defined(__SANITIZE_THREAD__)
+#define OC_BENCH_COUNT_ALLOCATIONS
+#endif
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{ 0 };
+
+} // namespace
+
+#ifdef OC_BENCH_COUNT_ALLOCATIONS
+
+// wrap the allocator of glibc to count the allocations of the whole process,
+// including the C code of the stack
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t nmemb, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *
+malloc(size_t size)
+{
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_realloc(ptr, size);
+}
+
+} // extern "C"
+
+#endif /* OC_BENCH_COUNT_ALLOCATIONS */
+
+namespace oc::bench {
+
+uint64_t
+allocations()
+{
+  return g_allocations.load(std::memory_order_relaxed);
+}
+
+} // namespace oc::bench
@@ -0,0 +1,56 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace oc::bench {
+
+/** @brief Get the number of heap allocations made by the process so far
+ * (always 0 if the allocations cannot be counted on the platform) */
+uint64_t allocations();
+
+/** @brief Report the number of heap allocations per iteration of a benchmark
+ * as the allocs/op counter */
+class AllocationCounter {
+public:
+  explicit AllocationCounter(benchmark::State &state)
+    : state_(state)
+    , start_(allocations())
+  {
+  }
+
+  ~AllocationCounter()
+  {
+    state_.counters["allocs/op"] =
+      benchmark::Counter(static_cast<double>(allocations() - start_),
+                         benchmark::Counter::kAvgIterations);
+  }
+
+  AllocationCounter(const AllocationCounter &) = delete;
+  AllocationCounter &operator=(const AllocationCounter &) = delete;
+
+private:
+  benchmark::State &state_;
+  uint64_t start_;
+};
+
+} // namespace oc::bench
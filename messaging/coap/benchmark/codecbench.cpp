@@ -0,0 +1,252 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "allocations.h"
+
+#include "messaging/coap/coap_internal.h"
+#include "messaging/coap/constants.h"
+#include "messaging/coap/options_internal.h"
+#include "oc_ri.h"
+
+#ifdef OC_OSCORE
+#include "messaging/coap/oscore_internal.h"
+#endif /* OC_OSCORE */
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kBufferSize = 2048;
+using Buffer = std::array<uint8_t, kBufferSize>;
+
+constexpr std::array<uint8_t, 8> kToken = { 0x01, 0x02, 0x03, 0x04,
+                                            0x05, 0x06, 0x07, 0x08 };
+const std::string kURI = "/a/light";
+const std::string kQuery = "if=oic.if.baseline";
+
+// Long path and query, and all options commonly used by OCF requests
+const std::string kLongURI = "/a/b/c/d/e/f/light";
+const std::string kLongQuery = "if=oic.if.baseline&rt=oic.r.switch.binary&"
+                               "rt=oic.r.light.brightness&di=1234";
+constexpr std::array<uint8_t, 8> kETag = { 0xde, 0xad, 0xbe, 0xef,
+                                           0xca, 0xfe, 0xba, 0xbe };
+
+void
+setRequestOptions(coap_packet_t *packet, bool allOptions)
+{
+  coap_set_token(packet, kToken.data(), kToken.size());
+  const std::string &uri = allOptions ? kLongURI : kURI;
+  const std::string &query = allOptions ? kLongQuery : kQuery;
+  coap_options_set_uri_path(packet, uri.c_str(), uri.length());
+  coap_options_set_uri_query(packet, query.c_str(), query.length());
+  coap_options_set_accept(packet, APPLICATION_VND_OCF_CBOR);
+  coap_options_set_content_format(packet, APPLICATION_VND_OCF_CBOR);
+  if (allOptions) {
+    coap_options_set_etag(packet, kETag.data(),
+                          static_cast<uint8_t>(kETag.size()));
+    coap_options_set_observe(packet, OC_COAP_OPTION_OBSERVE_REGISTER);
+    coap_options_set_block2(packet, 0, 0, 1024, 0);
+    coap_options_set_size2(packet, 4096);
+  }
+}
+
+size_t
+serializeUDPRequest(Buffer &buffer, std::vector<uint8_t> &payload,
+                    bool allOptions)
+{
+  coap_packet_t packet;
+  coap_udp_init_message(&packet, COAP_TYPE_CON, COAP_GET, 0x1234);
+  setRequestOptions(&packet, allOptions);
+  coap_set_payload(&packet, payload.data(),
+                   static_cast<uint32_t>(payload.size()));
+  return coap_serialize_message(&packet, buffer.data(), buffer.size());
+}
+
+void
+BM_CoapUDPParseMessage(benchmark::State &state)
+{
+  std::vector<uint8_t> payload(static_cast<size_t>(state.range(0)), 'a');
+  Buffer message{};
+  size_t message_len = serializeUDPRequest(message, payload, false);
+  if (message_len == 0) {
+    state.SkipWithError("cannot serialize message");
+    return;
+  }
+
+  Buffer data{};
+  oc::bench::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    // parsing modifies the data
+    memcpy(data.data(), message.data(), message_len);
+    coap_packet_t packet;
+    coap_status_t ret =
+      coap_udp_parse_message(&packet, data.data(), message_len, false);
+    benchmark::DoNotOptimize(ret);
+    benchmark::DoNotOptimize(packet);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(message_len));
+}
+BENCHMARK(BM_CoapUDPParseMessage)->Arg(0)->Arg(64)->Arg(512);
+
+void
+BM_CoapUDPSerializeMessage(benchmark::State &state)
+{
+  std::vector<uint8_t> payload(static_cast<size_t>(state.range(0)), 'a');
+  Buffer buffer{};
+  oc::bench::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    size_t len = serializeUDPRequest(buffer, payload, false);
+    benchmark::DoNotOptimize(len);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_CoapUDPSerializeMessage)->Arg(0)->Arg(64)->Arg(512);
+
+#ifdef OC_TCP
+
+size_t
+serializeTCPRequest(Buffer &buffer, std::vector<uint8_t> &payload)
+{
+  coap_packet_t packet;
+  coap_tcp_init_message(&packet, COAP_GET);
+  setRequestOptions(&packet, false);
+  coap_set_payload(&packet, payload.data(),
+                   static_cast<uint32_t>(payload.size()));
+  return coap_serialize_message(&packet, buffer.data(), buffer.size());
+}
+
+void
+BM_CoapTCPParseMessage(benchmark::State &state)
+{
+  std::vector<uint8_t> payload(static_cast<size_t>(state.range(0)), 'a');
+  Buffer message{};
+  size_t message_len = serializeTCPRequest(message, payload);
+  if (message_len == 0) {
+    state.SkipWithError("cannot serialize message");
+    return;
+  }
+
+  Buffer data{};
+  oc::bench::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    memcpy(data.data(), message.data(), message_len);
+    coap_packet_t packet;
+    coap_status_t ret =
+      coap_tcp_parse_message(&packet, data.data(), message_len, false);
+    benchmark::DoNotOptimize(ret);
+    benchmark::DoNotOptimize(packet);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(message_len));
+}
+BENCHMARK(BM_CoapTCPParseMessage)->Arg(0)->Arg(64)->Arg(512);
+
+void
+BM_CoapTCPSerializeMessage(benchmark::State &state)
+{
+  std::vector<uint8_t> payload(static_cast<size_t>(state.range(0)), 'a');
+  Buffer buffer{};
+  oc::bench::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    size_t len = serializeTCPRequest(buffer, payload);
+    benchmark::DoNotOptimize(len);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_CoapTCPSerializeMessage)->Arg(0)->Arg(64)->Arg(512);
+
+#endif /* OC_TCP */
+
+void
+BM_CoapParseOptions(benchmark::State &state)
+{
+  bool allOptions = state.range(0) != 0;
+  std::vector<uint8_t> payload{};
+  Buffer message{};
+  size_t message_len = serializeUDPRequest(message, payload, allOptions);
+  if (message_len == 0) {
+    state.SkipWithError("cannot serialize message");
+    return;
+  }
+
+  Buffer data{};
+  oc::bench::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    memcpy(data.data(), message.data(), message_len);
+    coap_packet_t packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.buffer = data.data();
+    packet.transport_type = COAP_TRANSPORT_UDP;
+    packet.code = COAP_GET;
+    packet.token_len = kToken.size();
+    uint8_t *options = data.data() + COAP_HEADER_LEN + kToken.size();
+    coap_status_t ret = coap_oscore_parse_options(
+      &packet, data.data(), message_len, options, true, true, false, false);
+    benchmark::DoNotOptimize(ret);
+    benchmark::DoNotOptimize(packet);
+  }
+}
+BENCHMARK(BM_CoapParseOptions)->ArgName("all")->Arg(0)->Arg(1);
+
+void
+BM_CoapSerializeOptions(benchmark::State &state)
+{
+  bool allOptions = state.range(0) != 0;
+  std::vector<uint8_t> payload{};
+  Buffer buffer{};
+  oc::bench::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    size_t len = serializeUDPRequest(buffer, payload, allOptions);
+    benchmark::DoNotOptimize(len);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_CoapSerializeOptions)->ArgName("all")->Arg(0)->Arg(1);
+
+#ifdef OC_OSCORE
+
+void
+BM_CoapParseOSCOREOption(benchmark::State &state)
+{
+  // RFC 8613, section 6.1: flags (h=1, k=1, n=2), Partial IV, kid context
+  // length and kid context, kid
+  const std::array<uint8_t, 16> option = {
+    0x1a, 0x01, 0x02, 0x08, 'c', 'o', 'n', 't', 'e', 'x', 't', '!',
+    'k',  'i',  'd',  '1',
+  };
+  oc::bench::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    coap_packet_t packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.code = COAP_GET;
+    int ret = coap_parse_oscore_option(&packet, option.data(), option.size());
+    benchmark::DoNotOptimize(ret);
+    benchmark::DoNotOptimize(packet);
+  }
+}
+BENCHMARK(BM_CoapParseOSCOREOption);
+
+#endif /* OC_OSCORE */
+
+} // namespace
@@ -0,0 +1,139 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "allocations.h"
+
+#include "oc_buffer.h"
+#include "messaging/coap/coap_internal.h"
+#include "messaging/coap/constants.h"
+#include "messaging/coap/engine_internal.h"
+#include "messaging/coap/options_internal.h"
+#include "oc_api.h"
+#include "oc_ri.h"
+#include "tests/gtest/Device.h"
+#include "tests/gtest/Resource.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstring>
+#include <string>
+
+#ifdef OC_SERVER
+
+namespace {
+
+constexpr size_t kDeviceID = 0;
+const std::string kResourceURI = "/bench/light";
+
+void
+onGet(oc_request_t *request, oc_interface_mask_t, void *)
+{
+  oc_rep_start_root_object();
+  oc_rep_set_boolean(root, value, true);
+  oc_rep_end_root_object();
+  oc_send_response(request, OC_STATUS_OK);
+}
+
+oc_resource_t *
+getBenchmarkResource()
+{
+  static oc_resource_t *resource = nullptr;
+  if (resource != nullptr) {
+    return resource;
+  }
+  oc::DynamicResourceHandler handlers{};
+  handlers.onGet = onGet;
+  resource = oc::TestDevice::AddDynamicResource(
+    oc::makeDynamicResourceToAdd("Benchmark Light", kResourceURI,
+                                 { "oic.r.switch.binary" },
+                                 { OC_IF_BASELINE, OC_IF_A }, handlers),
+    kDeviceID);
+#ifdef OC_HAS_FEATURE_RESOURCE_ACCESS_IN_RFOTM
+  // without the access in RFOTM the requests are denied by the ACL check
+  if (resource != nullptr &&
+      !oc::SetAccessInRFOTM(resource, true, OC_PERM_RETRIEVE)) {
+    return nullptr;
+  }
+#endif /* OC_HAS_FEATURE_RESOURCE_ACCESS_IN_RFOTM */
+  return resource;
+}
+
+size_t
+serializeGetRequest(std::array<uint8_t, 256> &buffer)
+{
+  coap_packet_t packet;
+  coap_udp_init_message(&packet, COAP_TYPE_CON, COAP_GET, 0);
+  const std::array<uint8_t, 8> token = { 0x01, 0x02, 0x03, 0x04,
+                                         0x05, 0x06, 0x07, 0x08 };
+  coap_set_token(&packet, token.data(), token.size());
+  coap_options_set_uri_path(&packet, kResourceURI.c_str(),
+                            kResourceURI.length());
+  coap_options_set_accept(&packet, APPLICATION_VND_OCF_CBOR);
+  return coap_serialize_message(&packet, buffer.data(), buffer.size());
+}
+
+// Full processing of a GET request by the engine: parsing, dispatching to the
+// resource handler, encoding and sending of the response
+void
+BM_CoapProcessInboundMessage(benchmark::State &state)
+{
+  if (getBenchmarkResource() == nullptr) {
+    state.SkipWithError("cannot create resource");
+    return;
+  }
+  auto epOpt = oc::TestDevice::GetEndpoint(kDeviceID, 0, SECURED | TCP);
+  if (!epOpt.has_value()) {
+    state.SkipWithError("cannot get endpoint");
+    return;
+  }
+  std::array<uint8_t, 256> request{};
+  size_t request_len = serializeGetRequest(request);
+  if (request_len == 0) {
+    state.SkipWithError("cannot serialize message");
+    return;
+  }
+
+  uint16_t mid = 0;
+  oc::bench::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    oc_message_t *msg = oc_allocate_message();
+    if (msg == nullptr) {
+      state.SkipWithError("cannot allocate message");
+      break;
+    }
+    memcpy(msg->data, request.data(), request_len);
+    msg->length = request_len;
+    memcpy(&msg->endpoint, &*epOpt, sizeof(oc_endpoint_t));
+    // a new message id for each request, so it is not dropped as a duplicate
+    ++mid;
+    msg->data[2] = static_cast<uint8_t>(mid >> 8);
+    msg->data[3] = static_cast<uint8_t>(mid & 0xFF);
+
+    coap_status_t ret = coap_process_inbound_message(msg);
+    benchmark::DoNotOptimize(ret);
+    oc_message_unref(msg);
+    // the responses are not sent
+    oc::TestDevice::DropOutgoingMessages();
+  }
+}
+BENCHMARK(BM_CoapProcessInboundMessage);
+
+} // namespace
+
+#endif /* OC_SERVER */
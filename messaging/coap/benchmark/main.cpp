@@ -0,0 +1,41 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "tests/gtest/Device.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+
+int
+main(int argc, char **argv)
+{
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  // the engine benchmarks process the messages by the running stack
+  if (!oc::TestDevice::StartServer()) {
+    fprintf(stderr, "cannot start server\n");
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  oc::TestDevice::StopServer();
+  benchmark::Shutdown();
+  return 0;
+}
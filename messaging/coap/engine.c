@@ -47,11 +47,14 @@
  * This file is part of the Contiki operating system.
  */
 
+#include "api/oc_core_res_internal.h"
 #include "api/oc_helpers_internal.h"
 #include "api/oc_events_internal.h"
 #include "api/oc_main_internal.h"
 #include "api/oc_message_internal.h"
+#include "api/oc_metrics_internal.h"
 #include "api/oc_ri_internal.h"
+#include "api/oc_tracepoint_internal.h"
 #include "messaging/coap/coap_internal.h"
 #include "messaging/coap/log_internal.h"
 #include "messaging/coap/options_internal.h"
@@ -261,8 +264,10 @@ coap_receive_init_response(coap_packet_t *response,
   } else {
 #ifdef OC_REQUEST_HISTORY
     if (oc_coap_check_if_duplicate(endpoint, mid)) {
+      OC_TRACEPOINT_REQUEST(OC_TRACEPOINT_DEDUP, 1);
       return COAP_RECEIVE_SKIP_DUPLICATE_MESSAGE;
     }
+    OC_TRACEPOINT_REQUEST(OC_TRACEPOINT_DEDUP, 0);
     g_history[g_idx] = mid;
     g_history_dev[g_idx] = (uint32_t)endpoint->device;
     g_idx = (g_idx + 1) % OC_REQUEST_HISTORY_SIZE;
@@ -648,6 +653,8 @@ send_transaction:
   ctx->transaction->message->length =
     coap_serialize_message(ctx->response, ctx->transaction->message->data,
                            oc_message_buffer_size(ctx->transaction->message));
+  OC_TRACEPOINT_REQUEST(OC_TRACEPOINT_ENCODE,
+                        OC_TRACEPOINT_KEY(ctx->transaction->message));
   if (ctx->transaction->message->length > 0) {
     coap_send_transaction(ctx->transaction);
   } else {
@@ -794,6 +801,15 @@ coap_receive_request_with_method(coap_receive_ctx_t *ctx,
 #endif /* OC_DBG_IS_ENABLED */
   const char *href;
   size_t href_len = coap_options_get_uri_path(ctx->message, &href);
+  // requests to devices sharing the ports of device 0 are received by device
+  // 0; secured and TCP traffic stays with device 0 because the session is
+  // bound to the device that received it, multicast is already dispatched to
+  // each device by the connectivity layer
+  if ((endpoint->flags & (SECURED | TCP | MULTICAST)) == 0) {
+    endpoint->device = oc_core_select_device_on_shared_ports(
+      endpoint->device, href, href_len, ctx->message->uri_query,
+      ctx->message->uri_query_len);
+  }
   if (coap_receive_init_response(ctx->response, endpoint, ctx->message->type,
                                  ctx->message->mid, href, href_len) ==
       COAP_RECEIVE_SKIP_DUPLICATE_MESSAGE) {
@@ -1123,8 +1139,10 @@ coap_process_inbound_message(oc_message_t *msg)
   static coap_packet_t response;
   static coap_receive_ctx_t ctx;
 
+  OC_TRACEPOINT_SET_REQUEST(OC_TRACEPOINT_KEY(msg));
   coap_status_t status = coap_parse_inbound_message(&message, msg);
   coap_set_global_status_code(status);
+  OC_TRACEPOINT_REQUEST(OC_TRACEPOINT_PARSE, status);
 
   if (status != COAP_NO_ERROR) {
     coap_process_invalid_inbound_message(&message, msg, status);
@@ -1223,6 +1241,16 @@ receive_result:
   return coap_global_status_code();
 }
 
+#ifdef OC_METRICS
+static uint32_t
+coap_processing_time_us(oc_clock_time_t start)
+{
+  oc_clock_time_t elapsed = oc_clock_time() - start;
+  uint64_t us = (uint64_t)elapsed * 1000000 / OC_CLOCK_SECOND;
+  return us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+}
+#endif /* OC_METRICS */
+
 OC_PROCESS_THREAD(g_coap_engine, ev, data)
 {
   OC_PROCESS_BEGIN();
@@ -1235,10 +1263,17 @@ OC_PROCESS_THREAD(g_coap_engine, ev, data)
 
     if (ev == oc_event_to_oc_process_event(INBOUND_RI_EVENT)) {
       oc_message_t *msg = (oc_message_t *)data;
+#ifdef OC_METRICS
+      oc_clock_time_t start = oc_clock_time();
+#endif /* OC_METRICS */
       coap_status_t ret = coap_process_inbound_message(msg);
       if (ret != COAP_NO_ERROR) {
         COAP_WRN("CoAP Engine: Error processing request (%d)", (int)ret);
       }
+#ifdef OC_METRICS
+      OC_METRICS_OBSERVE(OC_METRIC_COAP_PROCESSING_TIME_US,
+                         coap_processing_time_us(start));
+#endif /* OC_METRICS */
 
       oc_message_unref(msg);
     } else if (ev == OC_PROCESS_EVENT_TIMER) {
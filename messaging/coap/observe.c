@@ -86,6 +86,7 @@
 
 #ifdef OC_COLLECTIONS
 #include "api/oc_collection_internal.h"
+#include "api/oc_link_internal.h"
 #include "oc_collection.h"
 #ifdef OC_COLLECTIONS_IF_CREATE
 #include "api/oc_resource_factory_internal.h"
@@ -387,6 +388,22 @@ coap_remove_observers_by_client(const oc_endpoint_t *endpoint)
   return removed;
 }
 
+int
+coap_update_observers_endpoint(const oc_endpoint_t *from,
+                               const oc_endpoint_t *to)
+{
+  int updated = 0;
+  for (coap_observer_t *obs = (coap_observer_t *)oc_list_head(g_observers_list);
+       obs != NULL; obs = obs->next) {
+    if (oc_endpoint_compare(&obs->endpoint, from) == 0) {
+      oc_endpoint_copy_address(&obs->endpoint, to);
+      ++updated;
+    }
+  }
+  COAP_DBG("Moved %d observers", updated);
+  return updated;
+}
+
 typedef struct coap_endpoint_and_token_t
 {
   const oc_endpoint_t *endpoint;
@@ -949,10 +966,13 @@ coap_notify_collections(const oc_resource_t *resource)
   request.request_payload = NULL;
   request.method = OC_GET;
 
-  for (oc_collection_t *collection =
-         oc_get_next_collection_with_link(resource, NULL);
-       collection != NULL && collection->res.num_observers > 0;
-       collection = oc_get_next_collection_with_link(resource, collection)) {
+  for (const oc_link_t *link = oc_get_next_collection_link(resource, NULL);
+       link != NULL; link = oc_get_next_collection_link(resource, link)) {
+    oc_collection_t *collection = link->collection;
+    if (collection->res.device != resource->device ||
+        collection->res.num_observers == 0) {
+      continue;
+    }
     COAP_DBG("Issue GET request to collection(%s) for resource(%s)",
              oc_string(collection->res.uri), oc_string(resource->uri));
 
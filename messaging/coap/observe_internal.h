@@ -112,6 +112,16 @@ coap_observer_t *coap_add_observer(oc_resource_t *resource,
  */
 int coap_remove_observers_by_client(const oc_endpoint_t *endpoint) OC_NONNULL();
 
+/**
+ * @brief Move the observers of a client to a new address of the client.
+ *
+ * @param from previous endpoint of the client (cannot be NULL)
+ * @param to new endpoint of the client (cannot be NULL)
+ * @return number of updated observers
+ */
+int coap_update_observers_endpoint(const oc_endpoint_t *from,
+                                   const oc_endpoint_t *to) OC_NONNULL();
+
 /**
  * @brief Deallocate the first observer with matching endpoint and token and
  * remove it from the global list of observers.
@@ -50,6 +50,7 @@
 #include "api/oc_endpoint_internal.h"
 #include "api/oc_main_internal.h"
 #include "api/oc_message_internal.h"
+#include "api/oc_metrics_internal.h"
 #include "log_internal.h"
 #include "observe_internal.h"
 #include "oc_buffer.h"
@@ -103,6 +104,7 @@ coap_new_transaction(uint16_t mid, const uint8_t *token, uint8_t token_len,
   }
 
   COAP_DBG("Created new transaction %u: %p", mid, (void *)t);
+  OC_METRICS_INCREMENT(OC_METRIC_COAP_TRANSACTIONS);
   t->mid = mid;
   if (token_len > 0) {
     memcpy(t->token, token, token_len);
@@ -170,6 +172,7 @@ coap_send_transaction(coap_transaction_t *t)
     t = NULL;
   } else {
     /* timed out */
+    OC_METRICS_INCREMENT(OC_METRIC_COAP_TIMEOUTS);
 #if OC_WRN_IS_ENABLED
     char endpoint_buf[256];
     memset(endpoint_buf, 0, sizeof(endpoint_buf));
@@ -210,6 +213,7 @@ coap_clear_transaction(coap_transaction_t *t)
     oc_message_unref(t->message);
     oc_list_remove(transactions_list, t);
     oc_memb_free(&transactions_memb, t);
+    OC_METRICS_DECREMENT(OC_METRIC_COAP_TRANSACTIONS);
   }
 }
 coap_transaction_t *
@@ -249,6 +253,9 @@ coap_check_transactions(void)
     if (oc_etimer_expired(&t->retrans_timer)) {
       ++(t->retrans_counter);
       COAP_DBG("Retransmitting %u (%u)", t->mid, t->retrans_counter);
+      if (t->retrans_counter < COAP_MAX_RETRANSMIT) {
+        OC_METRICS_INCREMENT(OC_METRIC_COAP_RETRANSMISSIONS);
+      }
       int removed = oc_list_length(transactions_list);
       coap_send_transaction(t);
       if ((removed - oc_list_length(transactions_list)) > 1) {
@@ -271,6 +278,19 @@ coap_free_all_transactions(void)
   }
 }
 
+void
+coap_update_transactions_endpoint(const oc_endpoint_t *from,
+                                  const oc_endpoint_t *to)
+{
+  for (coap_transaction_t *t =
+         (coap_transaction_t *)oc_list_head(transactions_list);
+       t != NULL; t = t->next) {
+    if (oc_endpoint_compare(&t->message->endpoint, from) == 0) {
+      oc_endpoint_copy_address(&t->message->endpoint, to);
+    }
+  }
+}
+
 void
 coap_free_transactions_by_endpoint(const oc_endpoint_t *endpoint,
                                    oc_status_t code)
@@ -99,6 +99,9 @@ void coap_check_transactions(void);
 void coap_free_all_transactions(void);
 void coap_free_transactions_by_endpoint(const oc_endpoint_t *endpoint,
                                         oc_status_t code);
+/** Move the transactions of a peer to a new address of the peer */
+void coap_update_transactions_endpoint(const oc_endpoint_t *from,
+                                       const oc_endpoint_t *to);
 
 #ifdef __cplusplus
 }
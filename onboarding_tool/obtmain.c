@@ -120,6 +120,7 @@ display_menu(void)
   OC_PRINTF("[26] Provision Server Group OSCORE context\n");
 #endif /* OC_OSCORE */
   OC_PRINTF("[27] Set security domain info\n");
+  OC_PRINTF("[28] Batch Just-Works onboarding of all un-owned devices\n");
 #ifdef OC_CLOUD
   OC_PRINTF("-----------------------------------------------\n");
   OC_PRINTF("[30] Provision cloud config info\n");
@@ -627,6 +628,108 @@ otm_just_works(void)
   otb_mutex_unlock(app_sync_lock);
 }
 
+static oc_sec_ace_t *
+batch_onboarding_ace(const oc_uuid_t *uuid, size_t index, void *data)
+{
+  (void)uuid;
+  (void)data;
+  if (index > 0) {
+    return NULL;
+  }
+  /* auth-crypt RW access to NCRs */
+  oc_sec_ace_t *ace = oc_obt_new_ace_for_connection(OC_CONN_AUTH_CRYPT);
+  if (ace == NULL) {
+    return NULL;
+  }
+  oc_ace_res_t *res = oc_obt_ace_new_resource(ace);
+  if (res == NULL) {
+    oc_obt_free_ace(ace);
+    return NULL;
+  }
+  oc_obt_ace_resource_set_wc(res, OC_ACE_WC_ALL);
+  oc_obt_ace_add_permission(ace, OC_PERM_RETRIEVE | OC_PERM_UPDATE);
+  return ace;
+}
+
+static void
+batch_onboarding_device_cb(const oc_uuid_t *uuid, oc_obt_batch_step_t step,
+                           int status, void *data)
+{
+  (void)data;
+  char di[OC_UUID_LEN];
+  oc_uuid_to_str(uuid, di, OC_ARRAY_SIZE(di));
+  device_handle_t *device = is_device_in_list(uuid, unowned_devices);
+  if (status >= 0) {
+    OC_PRINTF("\nSuccessfully onboarded device with UUID %s\n", di);
+    if (device != NULL) {
+      oc_list_remove(unowned_devices, device);
+      oc_list_add(owned_devices, device);
+    }
+    return;
+  }
+  OC_PRINTF("\nERROR onboarding device %s at step %d\n", di, (int)step);
+  if (step != OC_OBT_BATCH_STEP_OTM && device != NULL) {
+    /* owned, but not fully provisioned */
+    oc_list_remove(unowned_devices, device);
+    oc_list_add(owned_devices, device);
+  }
+}
+
+static void
+batch_onboarding_progress_cb(size_t done, size_t failed, size_t total,
+                             void *data)
+{
+  (void)data;
+  OC_PRINTF("\nBatch onboarding: %zu/%zu done, %zu failed\n", done, total,
+            failed);
+}
+
+static void
+batch_onboarding(void)
+{
+  if (oc_list_length(unowned_devices) == 0) {
+    OC_PRINTF("\nPlease Re-discover Unowned devices\n");
+    return;
+  }
+
+  OC_PRINTF("\nEnter number of devices onboarded concurrently (0 for "
+            "default): ");
+  int in_flight = 0;
+  SCANF("%d", &in_flight);
+  if (in_flight < 0) {
+    OC_PRINTF("ERROR: Invalid number\n");
+    return;
+  }
+
+  otb_mutex_lock(app_sync_lock);
+
+  oc_uuid_t uuids[MAX_NUM_DEVICES];
+  size_t count = 0;
+  const device_handle_t *device =
+    (device_handle_t *)oc_list_head(unowned_devices);
+  while (device != NULL && count < MAX_NUM_DEVICES) {
+    memcpy(&uuids[count++], &device->uuid, sizeof(oc_uuid_t));
+    device = device->next;
+  }
+
+  oc_obt_batch_plan_t plan;
+  memset(&plan, 0, sizeof(plan));
+  plan.otm = OC_OBT_BATCH_OTM_JUST_WORKS;
+  plan.new_ace = batch_onboarding_ace;
+  plan.max_in_flight = (size_t)in_flight;
+  int ret = oc_obt_batch_onboard(uuids, count, &plan,
+                                 batch_onboarding_device_cb,
+                                 batch_onboarding_progress_cb, NULL);
+  if (ret >= 0) {
+    OC_PRINTF("\nSuccessfully issued batch onboarding of %zu devices\n",
+              count);
+  } else {
+    OC_PRINTF("\nERROR issuing batch onboarding\n");
+  }
+
+  otb_mutex_unlock(app_sync_lock);
+}
+
 static void
 retrieve_acl2_rsrc_cb(oc_sec_acl_t *acl, void *data)
 {
@@ -2399,6 +2502,9 @@ main(void)
     case 27:
       set_sd_info();
       break;
+    case 28:
+      batch_onboarding();
+      break;
 #ifdef OC_CLOUD
     case 30:
       set_cloud_info();
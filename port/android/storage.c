@@ -26,10 +26,14 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 static char g_store_path[OC_STORE_PATH_SIZE] = { 0 };
 static uint8_t g_store_path_len = 0;
@@ -135,6 +139,45 @@ oc_storage_size(const char *store)
   return fsize;
 }
 
+const uint8_t *
+oc_storage_map(const char *store, size_t *size)
+{
+  if (g_store_path_len == 0) {
+    return NULL;
+  }
+  size_t store_len = oc_strnlen_s(store, OC_STORE_PATH_SIZE);
+  if ((store_len == 0) ||
+      (store_len + g_store_path_len >= OC_STORE_PATH_SIZE)) {
+    return NULL;
+  }
+  memcpy(g_store_path + g_store_path_len, store, store_len);
+  g_store_path[g_store_path_len + store_len] = '\0';
+
+  int fd = open(g_store_path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return NULL;
+  }
+  void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+  if (data == MAP_FAILED) {
+    return NULL;
+  }
+  *size = (size_t)st.st_size;
+  return (const uint8_t *)data;
+}
+
+void
+oc_storage_unmap(const uint8_t *data, size_t size)
+{
+  munmap((void *)data, size);
+}
+
 long
 oc_storage_read(const char *store, uint8_t *buf, size_t size)
 {
@@ -22,55 +22,121 @@
 
 #include "oc_helpers.h"
 #include "oc_endpoint.h"
+#include "oc_signal_event_loop.h"
+#include "port/oc_clock.h"
+#include "port/oc_dns_internal.h"
 #include "port/oc_log_internal.h"
 #include "port/oc_connectivity.h"
+#include "util/oc_features.h"
+#include "util/oc_list.h"
 #include "util/oc_memb.h"
 #include "util/oc_macros_internal.h"
+#include "util/oc_process.h"
 #include <arpa/inet.h>
 #include <errno.h>
 #include <netdb.h>
+#include <pthread.h>
 #include <sys/socket.h>
 
+/* https://www.rfc-editor.org/rfc/rfc1035.html#section-2.3.4 */
+#define OC_DNS_MAX_DOMAIN_LEN (254)
+
+static int dns_getaddrinfo(const char *domain, transport_flags flags,
+                           oc_endpoint_t *endpoint);
+
+static oc_dns_resolve_fn_t g_dns_resolve = dns_getaddrinfo;
+
 #ifdef OC_DNS_CACHE
 
+static transport_flags
+dns_family(transport_flags flags)
+{
+  return (flags & IPV6) != 0 ? IPV6 : IPV4;
+}
+
 typedef struct oc_dns_cache_t
 {
   struct oc_dns_cache_t *next;
   oc_string_t domain;
+  transport_flags family;
+  int status; ///< 0 for a resolved domain, the error for a negative entry
+  oc_clock_time_t expires;
   union dev_addr addr;
 } oc_dns_cache_t;
 
-OC_MEMB(g_dns_s, oc_dns_cache_t, 1);
+OC_MEMB(g_dns_s, oc_dns_cache_t, OC_DNS_CACHE_MAX_ENTRIES);
 OC_LIST(g_dns_cache);
 
+static void
+dns_cache_free(oc_dns_cache_t *c)
+{
+  oc_free_string(&c->domain);
+  oc_memb_free(&g_dns_s, c);
+}
+
+static bool
+dns_cache_is_expired(const oc_dns_cache_t *c, oc_clock_time_t now)
+{
+  return c->expires <= now;
+}
+
 static oc_dns_cache_t *
-oc_dns_lookup_cache(const char *domain)
+oc_dns_lookup_cache(const char *domain, transport_flags flags)
 {
   if (oc_list_length(g_dns_cache) == 0) {
     return NULL;
   }
+  transport_flags family = dns_family(flags);
+  size_t domain_len = strlen(domain);
+  oc_clock_time_t now = oc_clock_time_monotonic();
   oc_dns_cache_t *c = (oc_dns_cache_t *)oc_list_head(g_dns_cache);
-  while (c) {
-    if (strlen(domain) == oc_string_len(c->domain) &&
-        memcmp(domain, oc_string(c->domain), oc_string_len(c->domain)) == 0) {
+  while (c != NULL) {
+    oc_dns_cache_t *next = c->next;
+    if (dns_cache_is_expired(c, now)) {
+      oc_list_remove(g_dns_cache, c);
+      dns_cache_free(c);
+    } else if (c->family == family &&
+               domain_len == oc_string_len(c->domain) &&
+               memcmp(domain, oc_string(c->domain), domain_len) == 0) {
+      // keep the most recently used entries at the head of the list
+      oc_list_remove(g_dns_cache, c);
+      oc_list_push(g_dns_cache, c);
       return c;
     }
-    c = c->next;
+    c = next;
   }
   return NULL;
 }
 
 static int
-oc_dns_cache_domain(const char *domain, const union dev_addr *addr)
+oc_dns_cache_domain(const char *domain, transport_flags flags, int status,
+                    const union dev_addr *addr)
 {
-  oc_dns_cache_t *c = (oc_dns_cache_t *)oc_memb_alloc(&g_dns_s);
-  if (c) {
+  oc_dns_cache_t *c = oc_dns_lookup_cache(domain, flags);
+  if (c == NULL) {
+    if (oc_list_length(g_dns_cache) >= OC_DNS_CACHE_MAX_ENTRIES) {
+      // evict the least recently used entry
+      dns_cache_free((oc_dns_cache_t *)oc_list_chop(g_dns_cache));
+    }
+    c = (oc_dns_cache_t *)oc_memb_alloc(&g_dns_s);
+    if (c == NULL) {
+      return -1;
+    }
     oc_new_string(&c->domain, domain, strlen(domain));
+    c->family = dns_family(flags);
+    oc_list_push(g_dns_cache, c);
+  }
+  c->status = status;
+  c->expires = oc_clock_time_monotonic() +
+               (oc_clock_time_t)(status == 0 ? OC_DNS_CACHE_TTL
+                                             : OC_DNS_CACHE_NEGATIVE_TTL) *
+                 OC_CLOCK_SECOND;
+  if (status == 0) {
     memcpy(&c->addr, addr, sizeof(union dev_addr));
-    oc_list_add(g_dns_cache, c);
-    return 0;
+  } else {
+    memset(&c->addr, 0, sizeof(union dev_addr));
   }
-  return -1;
+  return 0;
 }
 
 void
@@ -78,13 +144,120 @@ oc_dns_clear_cache(void)
 {
   oc_dns_cache_t *c = (oc_dns_cache_t *)oc_list_pop(g_dns_cache);
   while (c) {
-    oc_free_string(&c->domain);
-    oc_memb_free(&g_dns_s, c);
+    dns_cache_free(c);
     c = (oc_dns_cache_t *)oc_list_pop(g_dns_cache);
   }
 }
+
+size_t
+oc_dns_cache_size(void)
+{
+  return (size_t)oc_list_length(g_dns_cache);
+}
 #endif /* OC_DNS_CACHE */
 
+static int
+dns_getaddrinfo(const char *domain, transport_flags flags,
+                oc_endpoint_t *endpoint)
+{
+  union dev_addr *addr = &endpoint->addr;
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = (flags & IPV6) ? AF_INET6 : AF_INET;
+  hints.ai_socktype = (flags & TCP) ? SOCK_STREAM : SOCK_DGRAM;
+  struct addrinfo *result = NULL;
+  int ret = getaddrinfo(domain, NULL, &hints, &result);
+  if (ret != 0) {
+    OC_ERR("failed to resolve address(%s) with error(%d): %s", domain, ret,
+           gai_strerror(ret));
+    return ret;
+  }
+
+  if ((flags & IPV6) != 0) {
+    CLANG_IGNORE_WARNING_START
+    CLANG_IGNORE_WARNING("-Wcast-align")
+    const struct sockaddr_in6 *r = (struct sockaddr_in6 *)result->ai_addr;
+    CLANG_IGNORE_WARNING_END
+    memcpy(addr->ipv6.address, r->sin6_addr.s6_addr,
+           sizeof(r->sin6_addr.s6_addr));
+    addr->ipv6.port = ntohs(r->sin6_port);
+    addr->ipv6.scope = (uint8_t)r->sin6_scope_id;
+  }
+#ifdef OC_IPV4
+  else {
+    CLANG_IGNORE_WARNING_START
+    CLANG_IGNORE_WARNING("-Wcast-align")
+    const struct sockaddr_in *r = (struct sockaddr_in *)result->ai_addr;
+    CLANG_IGNORE_WARNING_END
+    memcpy(addr->ipv4.address, &r->sin_addr.s_addr, sizeof(r->sin_addr.s_addr));
+    addr->ipv4.port = ntohs(r->sin_port);
+  }
+#endif /* OC_IPV4 */
+  freeaddrinfo(result);
+  return 0;
+}
+
+void
+oc_dns_set_resolver(oc_dns_resolve_fn_t resolve)
+{
+  g_dns_resolve = resolve != NULL ? resolve : dns_getaddrinfo;
+}
+
+static int
+dns_resolve(const char *domain, transport_flags flags, union dev_addr *addr)
+{
+  memset(addr, 0, sizeof(union dev_addr));
+#ifdef OC_DNS_CACHE
+  const oc_dns_cache_t *c = oc_dns_lookup_cache(domain, flags);
+  if (c != NULL) {
+    OC_DBG("%s resolved from cache (status=%d)", domain, c->status);
+    memcpy(addr, &c->addr, sizeof(union dev_addr));
+    return c->status;
+  }
+#endif /* OC_DNS_CACHE */
+  oc_endpoint_t ep;
+  memset(&ep, 0, sizeof(oc_endpoint_t));
+  int ret = g_dns_resolve(domain, flags, &ep);
+  memcpy(addr, &ep.addr, sizeof(union dev_addr));
+#ifdef OC_DNS_CACHE
+  oc_dns_cache_domain(domain, flags, ret, addr);
+#endif /* OC_DNS_CACHE */
+  return ret;
+}
+
+static int
+dns_address_to_string(const char *domain, const union dev_addr *a,
+                      transport_flags flags, oc_string_t *addr)
+{
+#if !OC_ERR_IS_ENABLED
+  (void)domain;
+#endif /* !OC_ERR_IS_ENABLED */
+  char address[INET6_ADDRSTRLEN + 2] = { 0 };
+  const char *dest = NULL;
+  errno = 0;
+  if ((flags & IPV6) != 0) {
+    address[0] = '[';
+    dest = inet_ntop(AF_INET6, (const void *)a->ipv6.address, address + 1,
+                     INET6_ADDRSTRLEN);
+    size_t addr_len = strlen(address);
+    address[addr_len] = ']';
+    address[addr_len + 1] = '\0';
+  }
+#ifdef OC_IPV4
+  else {
+    dest = inet_ntop(AF_INET, (const void *)a->ipv4.address, address,
+                     INET_ADDRSTRLEN);
+  }
+#endif /* OC_IPV4 */
+  if (dest == NULL) {
+    OC_ERR("failed to parse domain(%s) to string: %d", domain, (int)errno);
+    return -1;
+  }
+  OC_DBG("%s address is %s", domain, address);
+  oc_new_string(addr, address, strlen(address));
+  return 0;
+}
+
 int
 oc_dns_lookup(const char *domain, oc_string_t *addr, transport_flags flags)
 {
@@ -93,86 +266,271 @@ oc_dns_lookup(const char *domain, oc_string_t *addr, transport_flags flags)
     return -1;
   }
   OC_DBG("trying to resolve address(%s) for flags(%d)", domain, (int)flags);
-  int ret = -1;
   union dev_addr a;
+  int ret = dns_resolve(domain, flags, &a);
+  if (ret != 0) {
+    return ret;
+  }
+  return dns_address_to_string(domain, &a, flags, addr);
+}
 
-#ifdef OC_DNS_CACHE
-  const oc_dns_cache_t *c = oc_dns_lookup_cache(domain);
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
 
-  if (c == NULL) {
-#endif /* OC_DNS_CACHE */
-    memset(&a, 0, sizeof(union dev_addr));
-
-    struct addrinfo hints;
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = (flags & IPV6) ? AF_INET6 : AF_INET;
-    hints.ai_socktype = (flags & TCP) ? SOCK_STREAM : SOCK_DGRAM;
-    struct addrinfo *result = NULL;
-    ret = getaddrinfo(domain, NULL, &hints, &result);
-
-    if (ret == 0) {
-      if ((flags & IPV6) != 0) {
-        CLANG_IGNORE_WARNING_START
-        CLANG_IGNORE_WARNING("-Wcast-align")
-        const struct sockaddr_in6 *r = (struct sockaddr_in6 *)result->ai_addr;
-        CLANG_IGNORE_WARNING_END
-        memcpy(a.ipv6.address, r->sin6_addr.s6_addr,
-               sizeof(r->sin6_addr.s6_addr));
-        a.ipv6.port = ntohs(r->sin6_port);
-        a.ipv6.scope = (uint8_t)r->sin6_scope_id;
-      }
-#ifdef OC_IPV4
-      else {
-        CLANG_IGNORE_WARNING_START
-        CLANG_IGNORE_WARNING("-Wcast-align")
-        const struct sockaddr_in *r = (struct sockaddr_in *)result->ai_addr;
-        CLANG_IGNORE_WARNING_END
-        memcpy(a.ipv4.address, &r->sin_addr.s_addr, sizeof(r->sin_addr.s_addr));
-        a.ipv4.port = ntohs(r->sin_port);
-      }
-#endif /* OC_IPV4 */
+typedef struct oc_dns_request_t
+{
+  struct oc_dns_request_t *next;
+  char domain[OC_DNS_MAX_DOMAIN_LEN + 1];
+  transport_flags flags;
+  oc_dns_lookup_handler_t handler;
+  void *user_data;
+  bool resolved; ///< result was taken from cache, do not update the cache
+  int status;
+  oc_endpoint_t endpoint;
+} oc_dns_request_t;
+
+OC_MEMB(g_dns_requests_s, oc_dns_request_t, OC_MAX_NUM_CONCURRENT_REQUESTS);
+
+static struct
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  pthread_t thread;
+  bool running;
+  bool terminate;
+  // requests waiting for the worker thread
+  OC_LIST_STRUCT(pending);
+  // requests resolved by the worker thread waiting for the stack thread
+  OC_LIST_STRUCT(done);
+  // request currently resolved by the worker thread
+  oc_dns_request_t *in_progress;
+} g_dns_worker = {
+  .mutex = PTHREAD_MUTEX_INITIALIZER,
+  .cond = PTHREAD_COND_INITIALIZER,
+};
+
+OC_PROCESS(oc_dns_lookup_process, "DNS lookup");
+
+static void
+dns_request_complete(oc_dns_request_t *req)
+{
 #ifdef OC_DNS_CACHE
-      oc_dns_cache_domain(domain, &a);
+  if (!req->resolved) {
+    oc_dns_cache_domain(req->domain, req->flags, req->status,
+                        &req->endpoint.addr);
+  }
 #endif /* OC_DNS_CACHE */
-      freeaddrinfo(result);
-    } else {
-      OC_ERR("failed to resolve address(%s) with error(%d): %s", domain, ret,
-             gai_strerror(ret));
+  if (req->handler == NULL) {
+    // cancelled while being resolved
+    return;
+  }
+  oc_string_t addr;
+  memset(&addr, 0, sizeof(oc_string_t));
+  int status = req->status;
+  if (status == 0) {
+    status = dns_address_to_string(req->domain, &req->endpoint.addr,
+                                   req->flags, &addr);
+  }
+  req->handler(req->domain, status, status == 0 ? &addr : NULL,
+               req->user_data);
+  oc_free_string(&addr);
+}
+
+static void
+dns_process_done_requests(void)
+{
+  pthread_mutex_lock(&g_dns_worker.mutex);
+  OC_LIST_LOCAL(done);
+  oc_list_copy(done, g_dns_worker.done);
+  oc_list_init(g_dns_worker.done);
+  pthread_mutex_unlock(&g_dns_worker.mutex);
+
+  oc_dns_request_t *req = (oc_dns_request_t *)oc_list_pop(done);
+  while (req != NULL) {
+    dns_request_complete(req);
+    oc_memb_free(&g_dns_requests_s, req);
+    req = (oc_dns_request_t *)oc_list_pop(done);
+  }
+}
+
+OC_PROCESS_THREAD(oc_dns_lookup_process, ev, data)
+{
+  (void)ev;
+  (void)data;
+  OC_PROCESS_POLLHANDLER(dns_process_done_requests());
+  OC_PROCESS_BEGIN();
+  while (oc_process_is_running(&oc_dns_lookup_process)) {
+    OC_PROCESS_YIELD();
+  }
+  OC_PROCESS_END();
+}
+
+static void
+dns_signal_done(void)
+{
+  oc_process_poll(&oc_dns_lookup_process);
+  _oc_signal_event_loop();
+}
+
+static void *
+dns_worker_thread(void *data)
+{
+  (void)data;
+  pthread_mutex_lock(&g_dns_worker.mutex);
+  while (!g_dns_worker.terminate) {
+    oc_dns_request_t *req =
+      (oc_dns_request_t *)oc_list_pop(g_dns_worker.pending);
+    if (req == NULL) {
+      pthread_cond_wait(&g_dns_worker.cond, &g_dns_worker.mutex);
+      continue;
     }
+    g_dns_worker.in_progress = req;
+    pthread_mutex_unlock(&g_dns_worker.mutex);
+
+    req->status = g_dns_resolve(req->domain, req->flags, &req->endpoint);
+
+    pthread_mutex_lock(&g_dns_worker.mutex);
+    g_dns_worker.in_progress = NULL;
+    oc_list_add(g_dns_worker.done, req);
+    dns_signal_done();
+  }
+  pthread_mutex_unlock(&g_dns_worker.mutex);
+  return NULL;
+}
+
+static bool
+dns_worker_start(void)
+{
+  if (!oc_process_is_running(&oc_dns_lookup_process)) {
+    oc_process_start(&oc_dns_lookup_process, NULL);
+  }
+  if (g_dns_worker.running) {
+    return true;
+  }
+  OC_LIST_STRUCT_INIT(&g_dns_worker, pending);
+  OC_LIST_STRUCT_INIT(&g_dns_worker, done);
+  g_dns_worker.terminate = false;
+  if (pthread_create(&g_dns_worker.thread, NULL, dns_worker_thread, NULL) !=
+      0) {
+    OC_ERR("creating DNS lookup thread");
+    return false;
+  }
+  g_dns_worker.running = true;
+  return true;
+}
+
+int
+oc_dns_lookup_async(const char *domain, transport_flags flags,
+                    oc_dns_lookup_handler_t handler, void *user_data)
+{
+  if (domain == NULL || handler == NULL) {
+    OC_ERR("Error of input parameters");
+    return -1;
+  }
+  size_t domain_len = strlen(domain);
+  if (domain_len == 0 || domain_len > OC_DNS_MAX_DOMAIN_LEN) {
+    OC_ERR("invalid domain length(%zu)", domain_len);
+    return -1;
+  }
+  if (!dns_worker_start()) {
+    return -1;
+  }
+  oc_dns_request_t *req = (oc_dns_request_t *)oc_memb_alloc(&g_dns_requests_s);
+  if (req == NULL) {
+    OC_ERR("cannot allocate DNS lookup request");
+    return -1;
+  }
+  memcpy(req->domain, domain, domain_len + 1);
+  req->flags = flags;
+  req->handler = handler;
+  req->user_data = user_data;
+  OC_DBG("scheduling lookup of address(%s) for flags(%d)", domain, (int)flags);
+
 #ifdef OC_DNS_CACHE
-  } else {
-    ret = 0;
-    memcpy(&a, &c->addr, sizeof(union dev_addr));
+  const oc_dns_cache_t *c = oc_dns_lookup_cache(domain, flags);
+  if (c != NULL) {
+    req->resolved = true;
+    req->status = c->status;
+    memcpy(&req->endpoint.addr, &c->addr, sizeof(union dev_addr));
+    pthread_mutex_lock(&g_dns_worker.mutex);
+    oc_list_add(g_dns_worker.done, req);
+    pthread_mutex_unlock(&g_dns_worker.mutex);
+    dns_signal_done();
+    return 0;
   }
 #endif /* OC_DNS_CACHE */
 
-  if (ret == 0) {
-    char address[INET6_ADDRSTRLEN + 2] = { 0 };
-    const char *dest = NULL;
-    errno = 0;
-    if ((flags & IPV6) != 0) {
-      address[0] = '[';
-      dest = inet_ntop(AF_INET6, (void *)a.ipv6.address, address + 1,
-                       INET6_ADDRSTRLEN);
-      size_t addr_len = strlen(address);
-      address[addr_len] = ']';
-      address[addr_len + 1] = '\0';
-    }
-#ifdef OC_IPV4
-    else {
-      dest =
-        inet_ntop(AF_INET, (void *)a.ipv4.address, address, INET_ADDRSTRLEN);
-    }
-#endif /* OC_IPV4 */
-    if (dest) {
-      OC_DBG("%s address is %s", domain, address);
-      oc_new_string(addr, address, strlen(address));
-    } else {
-      OC_ERR("failed to parse domain(%s) to string: %d", domain, (int)errno);
-      ret = -1;
+  pthread_mutex_lock(&g_dns_worker.mutex);
+  oc_list_add(g_dns_worker.pending, req);
+  pthread_cond_signal(&g_dns_worker.cond);
+  pthread_mutex_unlock(&g_dns_worker.mutex);
+  return 0;
+}
+
+static size_t
+dns_requests_remove(oc_list_t list, oc_dns_lookup_handler_t handler,
+                    const void *user_data)
+{
+  size_t count = 0;
+  oc_dns_request_t *req = (oc_dns_request_t *)oc_list_head(list);
+  while (req != NULL) {
+    oc_dns_request_t *next = req->next;
+    if (req->handler == handler && req->user_data == user_data) {
+      oc_list_remove(list, req);
+      oc_memb_free(&g_dns_requests_s, req);
+      ++count;
     }
+    req = next;
   }
+  return count;
+}
 
-  return ret;
+size_t
+oc_dns_lookup_async_cancel(oc_dns_lookup_handler_t handler,
+                           const void *user_data)
+{
+  if (!g_dns_worker.running) {
+    return 0;
+  }
+  pthread_mutex_lock(&g_dns_worker.mutex);
+  size_t count =
+    dns_requests_remove(g_dns_worker.pending, handler, user_data) +
+    dns_requests_remove(g_dns_worker.done, handler, user_data);
+  oc_dns_request_t *req = g_dns_worker.in_progress;
+  if (req != NULL && req->handler == handler && req->user_data == user_data) {
+    // the request is released by the stack thread once resolved
+    req->handler = NULL;
+    ++count;
+  }
+  pthread_mutex_unlock(&g_dns_worker.mutex);
+  return count;
 }
+
+static void
+dns_requests_free(oc_list_t list)
+{
+  oc_dns_request_t *req = (oc_dns_request_t *)oc_list_pop(list);
+  while (req != NULL) {
+    oc_memb_free(&g_dns_requests_s, req);
+    req = (oc_dns_request_t *)oc_list_pop(list);
+  }
+}
+
+void
+oc_dns_lookup_async_shutdown(void)
+{
+  if (g_dns_worker.running) {
+    pthread_mutex_lock(&g_dns_worker.mutex);
+    g_dns_worker.terminate = true;
+    pthread_cond_signal(&g_dns_worker.cond);
+    pthread_mutex_unlock(&g_dns_worker.mutex);
+    pthread_join(g_dns_worker.thread, NULL);
+    g_dns_worker.running = false;
+    dns_requests_free(g_dns_worker.pending);
+    dns_requests_free(g_dns_worker.done);
+  }
+  oc_process_exit(&oc_dns_lookup_process);
+}
+
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
+
 #endif /* OC_DNS_LOOKUP */
@@ -0,0 +1,154 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "ifcache.h"
+#include "oc_config.h"
+#include "port/oc_log_internal.h"
+#include "util/oc_list.h"
+#include "util/oc_memb.h"
+
+#include <errno.h>
+#include <ifaddrs.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <string.h>
+
+OC_LIST(g_ifcache);
+OC_MEMB(g_ifcache_s, oc_ifaddr_t, OC_IFCACHE_MAX_ADDRESSES);
+static pthread_rwlock_t g_ifcache_lock = PTHREAD_RWLOCK_INITIALIZER;
+static bool g_ifcache_valid = false;
+
+static void
+ifcache_free_all(void)
+{
+  oc_ifaddr_t *ifaddr = (oc_ifaddr_t *)oc_list_pop(g_ifcache);
+  while (ifaddr != NULL) {
+    oc_memb_free(&g_ifcache_s, ifaddr);
+    ifaddr = (oc_ifaddr_t *)oc_list_pop(g_ifcache);
+  }
+}
+
+static size_t
+ifcache_addr_size(int sa_family)
+{
+  if (sa_family == AF_INET6) {
+    return sizeof(struct sockaddr_in6);
+  }
+#ifdef OC_IPV4
+  if (sa_family == AF_INET) {
+    return sizeof(struct sockaddr_in);
+  }
+#endif /* OC_IPV4 */
+  return 0;
+}
+
+static void
+ifcache_add(const struct ifaddrs *interface)
+{
+  if (interface->ifa_addr == NULL) {
+    return;
+  }
+  size_t addr_size = ifcache_addr_size(interface->ifa_addr->sa_family);
+  if (addr_size == 0) {
+    return;
+  }
+  unsigned if_index = if_nametoindex(interface->ifa_name);
+  if (if_index == 0) {
+    OC_ERR("failed obtaining interface(%s) index: %d", interface->ifa_name,
+           (int)errno);
+    return;
+  }
+  oc_ifaddr_t *ifaddr = (oc_ifaddr_t *)oc_memb_alloc(&g_ifcache_s);
+  if (ifaddr == NULL) {
+    OC_WRN("cannot cache address of interface(%s): out of memory",
+           interface->ifa_name);
+    return;
+  }
+  ifaddr->index = if_index;
+  ifaddr->flags = interface->ifa_flags;
+  memcpy(&ifaddr->addr, interface->ifa_addr, addr_size);
+  strncpy(ifaddr->name, interface->ifa_name, sizeof(ifaddr->name) - 1);
+  oc_list_add(g_ifcache, ifaddr);
+}
+
+bool
+oc_ifcache_refresh(void)
+{
+  struct ifaddrs *ifs = NULL;
+  if (getifaddrs(&ifs) < 0) {
+    OC_ERR("failed querying interface addresses: %d", (int)errno);
+    pthread_rwlock_wrlock(&g_ifcache_lock);
+    ifcache_free_all();
+    g_ifcache_valid = false;
+    pthread_rwlock_unlock(&g_ifcache_lock);
+    return false;
+  }
+
+  pthread_rwlock_wrlock(&g_ifcache_lock);
+  ifcache_free_all();
+  for (const struct ifaddrs *interface = ifs; interface != NULL;
+       interface = interface->ifa_next) {
+    ifcache_add(interface);
+  }
+  g_ifcache_valid = true;
+  OC_DBG("interface cache refreshed: %d addresses", oc_list_length(g_ifcache));
+  pthread_rwlock_unlock(&g_ifcache_lock);
+  freeifaddrs(ifs);
+  return true;
+}
+
+bool
+oc_ifcache_iterate(oc_ifcache_iterate_fn_t fn, void *data)
+{
+  pthread_rwlock_rdlock(&g_ifcache_lock);
+  if (!g_ifcache_valid) {
+    pthread_rwlock_unlock(&g_ifcache_lock);
+    if (!oc_ifcache_refresh()) {
+      return false;
+    }
+    pthread_rwlock_rdlock(&g_ifcache_lock);
+  }
+  bool finished = true;
+  for (const oc_ifaddr_t *ifaddr = (oc_ifaddr_t *)oc_list_head(g_ifcache);
+       ifaddr != NULL; ifaddr = ifaddr->next) {
+    if (!fn(ifaddr, data)) {
+      finished = false;
+      break;
+    }
+  }
+  pthread_rwlock_unlock(&g_ifcache_lock);
+  return finished;
+}
+
+void
+oc_ifcache_clear(void)
+{
+  pthread_rwlock_wrlock(&g_ifcache_lock);
+  ifcache_free_all();
+  g_ifcache_valid = false;
+  pthread_rwlock_unlock(&g_ifcache_lock);
+}
+
+size_t
+oc_ifcache_size(void)
+{
+  pthread_rwlock_rdlock(&g_ifcache_lock);
+  size_t size = (size_t)oc_list_length(g_ifcache);
+  pthread_rwlock_unlock(&g_ifcache_lock);
+  return size;
+}
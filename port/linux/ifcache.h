@@ -0,0 +1,98 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifndef IFCACHE_H
+#define IFCACHE_H
+
+#include "util/oc_compiler.h"
+
+#include <net/if.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/socket.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximal number of cached interface addresses in builds without dynamic
+ * allocation */
+#ifndef OC_IFCACHE_MAX_ADDRESSES
+#define OC_IFCACHE_MAX_ADDRESSES (16)
+#endif /* OC_IFCACHE_MAX_ADDRESSES */
+
+/** @brief IPv6 or IPv4 address of a network interface. */
+typedef struct oc_ifaddr_t
+{
+  struct oc_ifaddr_t *next;
+  unsigned index;               ///< interface index
+  unsigned flags;               ///< interface flags (IFF_*)
+  struct sockaddr_storage addr; ///< interface address
+  char name[IF_NAMESIZE];       ///< interface name
+} oc_ifaddr_t;
+
+/**
+ * @brief Callback invoked for each cached interface address.
+ *
+ * @param ifaddr the interface address
+ * @param data user data
+ * @return true to continue the iteration
+ * @return false to stop the iteration
+ */
+typedef bool (*oc_ifcache_iterate_fn_t)(const oc_ifaddr_t *ifaddr,
+                                        void *data);
+
+/**
+ * @brief Reload the interface addresses from the kernel.
+ *
+ * Invoked when the netlink socket reports an added or removed address
+ * (RTM_NEWADDR/RTM_DELADDR). Interfaces without an IPv6 or IPv4 address are
+ * not cached.
+ *
+ * @return true on success
+ * @return false on failure, the cache is invalidated and reloaded on next
+ * access
+ */
+bool oc_ifcache_refresh(void);
+
+/**
+ * @brief Iterate the cached interface addresses, the cache is loaded if it is
+ * not valid.
+ *
+ * The cache is read-locked for the duration of the iteration, the callback
+ * must not call oc_ifcache_refresh or oc_ifcache_clear.
+ *
+ * @param fn the callback (cannot be NULL)
+ * @param data user data passed to the callback
+ * @return true the iteration finished
+ * @return false the cache could not be loaded or the iteration was stopped by
+ * the callback
+ */
+bool oc_ifcache_iterate(oc_ifcache_iterate_fn_t fn, void *data) OC_NONNULL(1);
+
+/** @brief Remove all cached interface addresses. */
+void oc_ifcache_clear(void);
+
+/** @brief Get the number of cached interface addresses. */
+size_t oc_ifcache_size(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IFCACHE_H */
@@ -19,6 +19,8 @@
 #include "api/oc_endpoint_internal.h"
 #include "api/oc_network_events_internal.h"
 #include "api/oc_message_internal.h"
+#include "api/oc_metrics_internal.h"
+#include "ifcache.h"
 #include "ip.h"
 #include "ipadapter.h"
 #include "ipcontext.h"
@@ -32,6 +34,7 @@
 #include "port/oc_clock.h"
 #include "port/oc_connectivity.h"
 #include "port/oc_connectivity_internal.h"
+#include "port/oc_dns_internal.h"
 #include "port/oc_fcntl_internal.h"
 #include "port/oc_log_internal.h"
 #include "port/oc_network_event_handler_internal.h"
@@ -58,7 +61,6 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
-#include <ifaddrs.h>
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
 #include <net/if.h>
@@ -133,32 +135,25 @@ add_ip_interface(unsigned target_index)
   return true;
 }
 
+static bool
+add_new_ip_interface(const oc_ifaddr_t *ifaddr, void *data)
+{
+  (void)data;
+  /* Ignore interfaces that are down and the loopback interface */
+  if ((ifaddr->flags & IFF_UP) == 0 || (ifaddr->flags & IFF_LOOPBACK) != 0) {
+    return true;
+  }
+  add_ip_interface(ifaddr->index);
+  return true;
+}
+
 static bool
 check_new_ip_interfaces(void)
 {
-  struct ifaddrs *ifs = NULL;
-  if (getifaddrs(&ifs) < 0) {
+  if (!oc_ifcache_iterate(add_new_ip_interface, NULL)) {
     OC_ERR("failed querying interface address");
     return false;
   }
-  for (struct ifaddrs *interface = ifs; interface != NULL;
-       interface = interface->ifa_next) {
-    /* Ignore interfaces that are down and the loopback interface */
-    if ((interface->ifa_flags & IFF_UP) == 0 ||
-        (interface->ifa_flags & IFF_LOOPBACK) != 0) {
-      continue;
-    }
-    /* Obtain interface index for this address */
-    unsigned if_index = if_nametoindex(interface->ifa_name);
-    if (if_index == 0) {
-      OC_ERR("failed obtaining interface(%s) index: %d", interface->ifa_name,
-             (int)errno);
-      continue;
-    }
-
-    add_ip_interface(if_index);
-  }
-  freeifaddrs(ifs);
   return true;
 }
 
@@ -227,6 +222,7 @@ oc_network_event_handler_mutex_destroy(void)
 {
   g_ifchange_initialized = false;
   close(g_ifchange_sock);
+  oc_ifcache_clear();
 #ifdef OC_NETWORK_MONITOR
   remove_all_ip_interface();
   remove_all_network_interface_cbs();
@@ -249,6 +245,16 @@ oc_get_ip_context_for_device(size_t device)
   return dev;
 }
 
+ip_context_t *
+oc_get_socket_ip_context_for_device(size_t device)
+{
+  ip_context_t *dev = oc_get_ip_context_for_device(device);
+  if (dev == NULL || !dev->shared) {
+    return dev;
+  }
+  return oc_get_ip_context_for_device(0);
+}
+
 static ssize_t
 get_data(int sock, uint8_t *buffer, size_t buffer_size)
 {
@@ -437,32 +443,62 @@ free_endpoints_list(ip_context_t *dev)
   }
 }
 
+/* A device sharing the ports of device 0 is reachable on the same ports, but
+ * only the unsecured UDP requests are dispatched to it. Secured and TCP
+ * sessions stay with device 0, so their endpoints are not advertised. */
 static void
-refresh_endpoints_list(ip_context_t *dev)
+refresh_shared_endpoints_list(ip_context_t *ctx)
 {
-  free_endpoints_list(dev);
+  const ip_context_t *dev = oc_get_ip_context_for_device(0);
+  if (dev == NULL) {
+    return;
+  }
+  if (!get_interface_addresses(
+        ctx, AF_INET6, oc_sock_listener_get_port(&dev->server), false, false)) {
+    OC_ERR("failed to refresh endpoints for ipv6 interface with port:%d",
+           oc_sock_listener_get_port(&dev->server));
+  }
+#ifdef OC_IPV4
+  if (!get_interface_addresses(
+        ctx, AF_INET, oc_sock_listener_get_port(&dev->server4), false, false)) {
+    OC_ERR("failed to refresh endpoints for ipv4 interface with port:%d",
+           oc_sock_listener_get_port(&dev->server4));
+  }
+#endif /* OC_IPV4 */
+}
+
+static void
+refresh_endpoints_list(ip_context_t *ctx)
+{
+  free_endpoints_list(ctx);
+
+  if (ctx->shared) {
+    refresh_shared_endpoints_list(ctx);
+    return;
+  }
+  const ip_context_t *dev = ctx;
 
   if (!get_interface_addresses(
-        dev, AF_INET6, oc_sock_listener_get_port(&dev->server), false, false)) {
+        ctx, AF_INET6, oc_sock_listener_get_port(&dev->server), false, false)) {
     OC_ERR("failed to refresh endpoints for ipv6 interface with port:%d",
            oc_sock_listener_get_port(&dev->server));
   }
 #ifdef OC_SECURITY
   if (!get_interface_addresses(
-        dev, AF_INET6, oc_sock_listener_get_port(&dev->secure), true, false)) {
+        ctx, AF_INET6, oc_sock_listener_get_port(&dev->secure), true, false)) {
     OC_ERR("failed to refresh endpoints for secure ipv6 interface with port:%d",
            oc_sock_listener_get_port(&dev->secure));
   }
 #endif /* OC_SECURITY */
 #ifdef OC_IPV4
   if (!get_interface_addresses(
-        dev, AF_INET, oc_sock_listener_get_port(&dev->server4), false, false)) {
+        ctx, AF_INET, oc_sock_listener_get_port(&dev->server4), false, false)) {
     OC_ERR("failed to refresh endpoints for ipv4 interface with port:%d",
            oc_sock_listener_get_port(&dev->server4));
   }
 #ifdef OC_SECURITY
   if (!get_interface_addresses(
-        dev, AF_INET, oc_sock_listener_get_port(&dev->secure4), true, false)) {
+        ctx, AF_INET, oc_sock_listener_get_port(&dev->secure4), true, false)) {
     OC_ERR("failed to refresh endpoints for secure ipv4 interface with port:%d",
            oc_sock_listener_get_port(&dev->secure4));
   }
@@ -470,14 +506,14 @@ refresh_endpoints_list(ip_context_t *dev)
 #endif /* OC_IPV4 */
 
 #ifdef OC_TCP
-  if (!get_interface_addresses(dev, AF_INET6,
+  if (!get_interface_addresses(ctx, AF_INET6,
                                oc_sock_listener_get_port(&dev->tcp.server),
                                false, true)) {
     OC_ERR("failed to refresh endpoints for ipv6 interface (TCP) with port:%d",
            oc_sock_listener_get_port(&dev->tcp.server));
   }
 #ifdef OC_SECURITY
-  if (!get_interface_addresses(dev, AF_INET6,
+  if (!get_interface_addresses(ctx, AF_INET6,
                                oc_sock_listener_get_port(&dev->tcp.secure),
                                true, true)) {
     OC_ERR("failed to refresh endpoints for secure ipv6 interface (TCP) with "
@@ -486,14 +522,14 @@ refresh_endpoints_list(ip_context_t *dev)
   }
 #endif /* OC_SECURITY */
 #ifdef OC_IPV4
-  if (!get_interface_addresses(dev, AF_INET,
+  if (!get_interface_addresses(ctx, AF_INET,
                                oc_sock_listener_get_port(&dev->tcp.server4),
                                false, true)) {
     OC_ERR("failed to refresh endpoints for ipv4 interface (TCP) with port:%d",
            oc_sock_listener_get_port(&dev->tcp.server4));
   }
 #ifdef OC_SECURITY
-  if (!get_interface_addresses(dev, AF_INET,
+  if (!get_interface_addresses(ctx, AF_INET,
                                oc_sock_listener_get_port(&dev->tcp.secure4),
                                true, true)) {
     OC_ERR("failed to refresh endpoints for secure ipv4 interface (TCP) with "
@@ -692,6 +728,10 @@ process_interface_change_event(void)
       process_remove_interface_event(response);
 #endif /* OC_NETWORK_MONITOR */
       if_state_changed = true;
+    } else if (response->nlmsg_type == RTM_NEWLINK ||
+               response->nlmsg_type == RTM_DELLINK) {
+      // link up/down changes the cached IFF_UP/IFF_RUNNING flags
+      if_state_changed = true;
     }
 
     CLANG_IGNORE_WARNING_START
@@ -701,6 +741,7 @@ process_interface_change_event(void)
   }
 
   if (if_state_changed) {
+    oc_ifcache_refresh();
     set_interfaces_waiting_for_refresh(num_devices);
   }
   oc_message_unref(message);
@@ -859,6 +900,40 @@ process_socket_signal_event(const ip_context_t *dev, fd_set *rdfds)
 #endif /* OC_TCP */
 }
 
+/* Multicast requests received on the sockets of device 0 are delivered also
+ * to every device sharing its ports, the same way as if each device was
+ * listening on its own multicast socket.
+ */
+static void
+dispatch_multicast_to_shared_devices(const oc_message_t *message)
+{
+  OC_LIST_LOCAL(copies);
+  pthread_mutex_lock(&g_mutex);
+  for (const ip_context_t *dev = oc_list_head(g_ip_contexts); dev != NULL;
+       dev = dev->next) {
+    if (!dev->shared) {
+      continue;
+    }
+    oc_message_t *copy = oc_allocate_message();
+    if (copy == NULL) {
+      OC_WRN("cannot dispatch multicast message to device(%zu)", dev->device);
+      break;
+    }
+    memcpy(copy->data, message->data, message->length);
+    copy->length = message->length;
+    memcpy(&copy->endpoint, &message->endpoint, sizeof(oc_endpoint_t));
+    copy->endpoint.device = dev->device;
+    oc_list_add(copies, copy);
+  }
+  pthread_mutex_unlock(&g_mutex);
+
+  oc_message_t *copy = (oc_message_t *)oc_list_pop(copies);
+  while (copy != NULL) {
+    oc_network_receive_event(copy);
+    copy = (oc_message_t *)oc_list_pop(copies);
+  }
+}
+
 static int
 process_socket_read_event(ip_context_t *dev, fd_set *rdfds)
 {
@@ -889,6 +964,9 @@ receive:
   OC_LOGipaddr(OC_LOG_LEVEL_TRACE, message->endpoint);
   OC_TRACE("%s", "");
 
+  if ((message->endpoint.flags & MULTICAST) != 0 && dev->device == 0) {
+    dispatch_multicast_to_shared_devices(message);
+  }
   oc_network_receive_event(message);
   return 1;
 }
@@ -1147,6 +1225,7 @@ network_event_thread(void *data)
     if (oc_network_get_event_queue_length(dev->device) >=
         OC_DEVICE_MAX_NUM_CONCURRENT_REQUESTS) {
       // the queue is full -> add only control flow rfds
+      OC_METRICS_INCREMENT(OC_METRIC_NETWORK_THROTTLED);
       FD_ZERO(&rdfds);
       add_control_flow_rfds(&rdfds, dev);
 #ifdef OC_TCP
@@ -1200,7 +1279,8 @@ oc_send_buffer_internal(oc_message_t *message, bool create, bool queue)
   OC_LOGipaddr(OC_LOG_LEVEL_TRACE, message->endpoint);
   OC_TRACE("%s", "");
 
-  ip_context_t *dev = oc_get_ip_context_for_device(message->endpoint.device);
+  ip_context_t *dev =
+    oc_get_socket_ip_context_for_device(message->endpoint.device);
   if (dev == NULL) {
     return -1;
   }
@@ -1245,7 +1325,7 @@ typedef enum {
 
 static send_discovery_t
 send_ipv6_discovery_request(oc_message_t *message,
-                            const struct ifaddrs *interface, int server_sock)
+                            const oc_ifaddr_t *interface, int server_sock)
 {
   if (server_sock == -1) {
     OC_ERR("skipping sending of discovery request: server socket for IPv6 is "
@@ -1253,23 +1333,15 @@ send_ipv6_discovery_request(oc_message_t *message,
     return SEND_DISCOVERY_SKIPPED;
   }
 
-  CLANG_IGNORE_WARNING_START
-  CLANG_IGNORE_WARNING("-Wcast-align")
-  const struct sockaddr_in6 *addr = (struct sockaddr_in6 *)interface->ifa_addr;
-  CLANG_IGNORE_WARNING_END
+  const struct sockaddr_in6 *addr =
+    (const struct sockaddr_in6 *)&interface->addr;
   if (!IN6_IS_ADDR_LINKLOCAL(&addr->sin6_addr)) {
     OC_DBG("skipping sending of discovery request: only link-local addresses "
            "are supported");
     return SEND_DISCOVERY_SKIPPED;
   }
 
-  unsigned mif = if_nametoindex(interface->ifa_name);
-  if (mif == 0) {
-    OC_ERR("cannot send discovery request: cannot obtain interface(%s) "
-           "index(error: %d)",
-           interface->ifa_name, (int)errno);
-    return SEND_DISCOVERY_ERROR;
-  }
+  unsigned mif = interface->index;
 
   if (setsockopt(server_sock, IPPROTO_IPV6, IPV6_MULTICAST_IF, &mif,
                  sizeof(mif)) == -1) {
@@ -1305,24 +1377,21 @@ send_ipv6_discovery_request(oc_message_t *message,
     OC_ERR("failed to send ipv6 discovery request");
     return SEND_DISCOVERY_ERROR;
   }
-  OC_DBG("sent discovery request on interface %s", interface->ifa_name);
+  OC_DBG("sent discovery request on interface %s", interface->name);
   return SEND_DISCOVERY_OK;
 }
 
 #ifdef OC_IPV4
 static send_discovery_t
 send_ipv4_discovery_request(oc_message_t *message,
-                            const struct ifaddrs *interface, int server_sock)
+                            const oc_ifaddr_t *interface, int server_sock)
 {
   if (server_sock == -1) {
     OC_DBG("skipping sending of discovery request: server socket for IPv4 is "
            "disabled");
     return SEND_DISCOVERY_SKIPPED;
   }
-  CLANG_IGNORE_WARNING_START
-  CLANG_IGNORE_WARNING("-Wcast-align")
-  const struct sockaddr_in *addr = (struct sockaddr_in *)interface->ifa_addr;
-  CLANG_IGNORE_WARNING_END
+  const struct sockaddr_in *addr = (const struct sockaddr_in *)&interface->addr;
   if (setsockopt(server_sock, IPPROTO_IP, IP_MULTICAST_IF, &addr->sin_addr,
                  sizeof(addr->sin_addr)) == -1) {
     OC_ERR("setting socket option for default IP_MULTICAST_IF: %d", (int)errno);
@@ -1334,74 +1403,69 @@ send_ipv4_discovery_request(oc_message_t *message,
     OC_ERR("setting socket option for default IP_MULTICAST_TTL: %d", errno);
     return SEND_DISCOVERY_ERROR;
   }
-  unsigned if_index = if_nametoindex(interface->ifa_name);
-  if (if_index == 0) {
-    OC_ERR("could not get interface index for %s (error: %d)",
-           interface->ifa_name, (int)errno);
-    return SEND_DISCOVERY_ERROR;
-  }
-  message->endpoint.interface_index = if_index;
+  message->endpoint.interface_index = interface->index;
   if (oc_send_buffer(message) < 0) {
     OC_ERR("failed to send ipv4 discovery request");
     return SEND_DISCOVERY_ERROR;
   }
-  OC_DBG("sent discovery request on interface %s", interface->ifa_name);
+  OC_DBG("sent discovery request on interface %s", interface->name);
   return SEND_DISCOVERY_OK;
 }
 #endif /* OC_IPV4 */
 
 static send_discovery_t
-send_discovery_request(oc_message_t *message, const struct ifaddrs *interface,
+send_discovery_request(oc_message_t *message, const oc_ifaddr_t *interface,
                        const ip_context_t *dev)
 {
-  if (interface->ifa_addr != NULL) {
-    if ((message->endpoint.flags & IPV6) != 0 &&
-        interface->ifa_addr->sa_family == AF_INET6) {
-      return send_ipv6_discovery_request(message, interface, dev->server.sock);
-    }
+  if ((message->endpoint.flags & IPV6) != 0 &&
+      interface->addr.ss_family == AF_INET6) {
+    return send_ipv6_discovery_request(message, interface, dev->server.sock);
+  }
 #ifdef OC_IPV4
-    if ((message->endpoint.flags & IPV4) != 0 &&
-        interface->ifa_addr->sa_family == AF_INET) {
-      return send_ipv4_discovery_request(message, interface, dev->server4.sock);
-    }
-#endif /* OC_IPV4 */
+  if ((message->endpoint.flags & IPV4) != 0 &&
+      interface->addr.ss_family == AF_INET) {
+    return send_ipv4_discovery_request(message, interface, dev->server4.sock);
   }
+#endif /* OC_IPV4 */
   return SEND_DISCOVERY_SKIPPED;
 }
 
-void
-oc_send_discovery_request(oc_message_t *message)
+typedef struct
 {
-  struct ifaddrs *ifs = NULL;
-  if (getifaddrs(&ifs) < 0) {
-    OC_ERR("querying interfaces: %d", errno);
-    return;
+  oc_message_t *message;
+  const ip_context_t *dev;
+} send_discovery_ctx_t;
+
+static bool
+send_discovery_request_on_interface(const oc_ifaddr_t *interface, void *data)
+{
+  if ((interface->flags & IFF_UP) == 0 ||
+      (interface->flags & IFF_LOOPBACK) != 0) {
+    return true;
   }
+  const send_discovery_ctx_t *ctx = (send_discovery_ctx_t *)data;
+  return send_discovery_request(ctx->message, interface, ctx->dev) !=
+         SEND_DISCOVERY_ERROR;
+}
 
+void
+oc_send_discovery_request(oc_message_t *message)
+{
   memset(&message->endpoint.addr_local, 0,
          sizeof(message->endpoint.addr_local));
   message->endpoint.interface_index = 0;
 
   const ip_context_t *dev =
-    oc_get_ip_context_for_device(message->endpoint.device);
+    oc_get_socket_ip_context_for_device(message->endpoint.device);
   if (dev == NULL) {
     return;
   }
 
-  for (struct ifaddrs *interface = ifs; interface != NULL;
-       interface = interface->ifa_next) {
-    if ((interface->ifa_flags & IFF_UP) == 0 ||
-        (interface->ifa_flags & IFF_LOOPBACK) != 0) {
-      continue;
-    }
-
-    if (send_discovery_request(message, interface, dev) ==
-        SEND_DISCOVERY_ERROR) {
-      freeifaddrs(ifs);
-      return;
-    }
-  }
-  freeifaddrs(ifs);
+  send_discovery_ctx_t ctx = {
+    .message = message,
+    .dev = dev,
+  };
+  oc_ifcache_iterate(send_discovery_request_on_interface, &ctx);
 }
 #endif /* OC_CLIENT */
 
@@ -1692,6 +1756,35 @@ signal_event_thread(const ip_context_t *dev)
   }
 }
 
+static bool
+initialize_shared_ip_context(ip_context_t *dev, size_t device)
+{
+  const ip_context_t *primary = oc_get_ip_context_for_device(0);
+  if (primary == NULL || primary->shared) {
+    OC_ERR("cannot share ports of device 0: device not initialized");
+    return false;
+  }
+  dev->device = device;
+  dev->shared = true;
+  OC_LIST_STRUCT_INIT(dev, eps);
+  dev->mcast_sock = -1;
+  dev->server.sock = -1;
+#ifdef OC_SECURITY
+  dev->secure.sock = -1;
+#endif /* OC_SECURITY */
+#ifdef OC_IPV4
+  dev->mcast4_sock = -1;
+  dev->server4.sock = -1;
+#ifdef OC_SECURITY
+  dev->secure4.sock = -1;
+#endif /* OC_SECURITY */
+#endif /* OC_IPV4 */
+  dev->wakeup_pipe[0] = -1;
+  dev->wakeup_pipe[1] = -1;
+  OC_DBG("device %zu shares ports and network thread of device 0", device);
+  return true;
+}
+
 int
 oc_connectivity_init(size_t device, oc_connectivity_ports_t ports)
 {
@@ -1702,7 +1795,13 @@ oc_connectivity_init(size_t device, oc_connectivity_ports_t ports)
     oc_abort("Insufficient memory");
   }
 
-  if (!initialize_ip_context(dev, device, ports)) {
+  bool initialized;
+  if (device != 0 && (ports.udp.flags & OC_CONNECTIVITY_SHARE_PORTS) != 0) {
+    initialized = initialize_shared_ip_context(dev, device);
+  } else {
+    initialized = initialize_ip_context(dev, device, ports);
+  }
+  if (!initialized) {
     oc_memb_free(&g_ip_context_s, dev);
     return -1;
   }
@@ -1719,7 +1818,7 @@ oc_connectivity_init(size_t device, oc_connectivity_ports_t ports)
 void
 oc_connectivity_wakeup(size_t device)
 {
-  const ip_context_t *dev = oc_get_ip_context_for_device(device);
+  const ip_context_t *dev = oc_get_socket_ip_context_for_device(device);
   if (dev == NULL) {
     OC_WRN("no ip-context found for device(%zu)", device);
     return;
@@ -1738,6 +1837,10 @@ oc_connectivity_shutdown(size_t device)
     return;
   }
 
+  if (dev->shared) {
+    goto remove_context;
+  }
+
   OC_ATOMIC_STORE8(dev->terminate, 1);
   signal_event_thread(dev);
 
@@ -1771,13 +1874,23 @@ oc_connectivity_shutdown(size_t device)
 
   pthread_mutex_destroy(&dev->rfds_mutex);
 
+remove_context:
   free_endpoints_list(dev);
 
   pthread_mutex_lock(&g_mutex);
   oc_list_remove(g_ip_contexts, dev);
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+  bool last_context = oc_list_length(g_ip_contexts) == 0;
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
   pthread_mutex_unlock(&g_mutex);
   oc_memb_free(&g_ip_context_s, dev);
 
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+  if (last_context) {
+    oc_dns_lookup_async_shutdown();
+  }
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
+
   OC_DBG("oc_connectivity_shutdown for device %zd", device);
 }
 
@@ -32,6 +32,15 @@ extern "C" {
  */
 ip_context_t *oc_get_ip_context_for_device(size_t device);
 
+/**
+ * @brief Get ip context that owns the sockets and the network thread used by
+ * the device.
+ *
+ * For a device sharing the ports of device 0 (OC_CONNECTIVITY_SHARE_PORTS) it
+ * is the context of device 0, otherwise it is the context of the device.
+ */
+ip_context_t *oc_get_socket_ip_context_for_device(size_t device);
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,6 +26,7 @@
 #include "tcpcontext.h"
 #endif /* OC_TCP */
 #include <pthread.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <sys/select.h>
 #include <sys/socket.h>
@@ -72,6 +73,8 @@ typedef struct ip_context_t
   fd_set rfds;
   int wakeup_pipe[2];
   OC_ATOMIC_INT8_T flags;
+  bool shared; ///< the context has no sockets nor network thread of its own,
+               ///< it uses the sockets and network thread of device 0
 } ip_context_t;
 
 /**
@@ -17,13 +17,13 @@
  *
  ****************************************************************************/
 
+#include "ifcache.h"
 #include "netsocket.h"
 #include "port/oc_log_internal.h"
 #include "util/oc_macros_internal.h"
 
 #include <assert.h>
 #include <errno.h>
-#include <ifaddrs.h>
 #include <net/if.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
@@ -153,75 +153,63 @@ oc_netsocket_add_sock_to_ipv6_mcast_group(int sock, unsigned if_index)
   return true;
 }
 
-static bool
-netsocket_configure_mcast(int mcast_sock, int sa_family)
+typedef struct
 {
-  assert(mcast_sock != -1);
+  int mcast_sock;
+  int sa_family;
+} netsocket_configure_mcast_ctx_t;
 
-  struct ifaddrs *ifs = NULL;
-  if (getifaddrs(&ifs) < 0) {
-    OC_ERR(
-      "cannot configure multicast socket: failed querying interface addrs: %d",
-      (int)errno);
-    return false;
+static bool
+netsocket_configure_mcast_on_interface(const oc_ifaddr_t *interface,
+                                       void *data)
+{
+  const netsocket_configure_mcast_ctx_t *ctx =
+    (netsocket_configure_mcast_ctx_t *)data;
+  /* Ignore interfaces that are down and the loopback interface */
+  if ((interface->flags & IFF_UP) == 0 ||
+      (interface->flags & IFF_LOOPBACK) != 0) {
+    return true;
+  }
+  /* Ignore interfaces not belonging to the address family under consideration
+   */
+  if (interface->addr.ss_family != ctx->sa_family) {
+    return true;
   }
-  for (struct ifaddrs *interface = ifs; interface != NULL;
-       interface = interface->ifa_next) {
-    /* Ignore interfaces that are down and the loopback interface */
-    if ((interface->ifa_flags & IFF_UP) == 0 ||
-        (interface->ifa_flags & IFF_LOOPBACK) != 0) {
-      continue;
-    }
-    /* Ignore interfaces not belonging to the address family under consideration
-     */
-    if (interface->ifa_addr && interface->ifa_addr->sa_family != sa_family) {
-      continue;
-    }
-    /* Obtain interface index for this address */
-    unsigned if_index = if_nametoindex(interface->ifa_name);
-    if (if_index == 0) {
-      OC_ERR("cannot configure multicast socket: failed obtaining interface "
-             "index for %s: %d",
-             interface->ifa_name, (int)errno);
-      continue;
-    }
 
-    /* Accordingly handle IPv6/IPv4 addresses */
-    if (sa_family == AF_INET6) {
-      CLANG_IGNORE_WARNING_START
-      CLANG_IGNORE_WARNING("-Wcast-align")
-      const struct sockaddr_in6 *addr =
-        (struct sockaddr_in6 *)interface->ifa_addr;
-      CLANG_IGNORE_WARNING_END
-      if (addr == NULL || !IN6_IS_ADDR_LINKLOCAL(&addr->sin6_addr)) {
-        continue;
-      }
-      if (!oc_netsocket_add_sock_to_ipv6_mcast_group(mcast_sock, if_index)) {
-        freeifaddrs(ifs);
-        return false;
-      }
-      continue;
+  /* Accordingly handle IPv6/IPv4 addresses */
+  if (ctx->sa_family == AF_INET6) {
+    const struct sockaddr_in6 *addr =
+      (const struct sockaddr_in6 *)&interface->addr;
+    if (!IN6_IS_ADDR_LINKLOCAL(&addr->sin6_addr)) {
+      return true;
     }
+    return oc_netsocket_add_sock_to_ipv6_mcast_group(ctx->mcast_sock,
+                                                     interface->index);
+  }
 #ifdef OC_IPV4
-    if (sa_family == AF_INET) {
-      CLANG_IGNORE_WARNING_START
-      CLANG_IGNORE_WARNING("-Wcast-align")
-      const struct sockaddr_in *addr =
-        (struct sockaddr_in *)interface->ifa_addr;
-      CLANG_IGNORE_WARNING_END
-      if (addr == NULL) {
-        continue;
-      }
-      if (!oc_netsocket_add_sock_to_ipv4_mcast_group(
-            mcast_sock, &addr->sin_addr, if_index)) {
-        freeifaddrs(ifs);
-        return false;
-      }
-      continue;
-    }
+  if (ctx->sa_family == AF_INET) {
+    const struct sockaddr_in *addr =
+      (const struct sockaddr_in *)&interface->addr;
+    return oc_netsocket_add_sock_to_ipv4_mcast_group(
+      ctx->mcast_sock, &addr->sin_addr, interface->index);
+  }
 #endif /* OC_IPV4 */
+  return true;
+}
+
+static bool
+netsocket_configure_mcast(int mcast_sock, int sa_family)
+{
+  assert(mcast_sock != -1);
+
+  netsocket_configure_mcast_ctx_t ctx = {
+    .mcast_sock = mcast_sock,
+    .sa_family = sa_family,
+  };
+  if (!oc_ifcache_iterate(netsocket_configure_mcast_on_interface, &ctx)) {
+    OC_ERR("cannot configure multicast socket");
+    return false;
   }
-  freeifaddrs(ifs);
   return true;
 }
 
@@ -53,6 +53,11 @@ typedef uint64_t oc_clock_time_t;
 #define OC_DNS_LOOKUP
 #define OC_DNS_CACHE
 // #define OC_DNS_LOOKUP_IPV6
+/* Size of the DNS cache and time-to-live (in seconds) of resolved and failed
+ * lookups */
+// #define OC_DNS_CACHE_MAX_ENTRIES (8)
+// #define OC_DNS_CACHE_TTL (300)
+// #define OC_DNS_CACHE_NEGATIVE_TTL (30)
 
 // The maximum size of a response to an OBSERVE request, in bytes
 // #define OC_MAX_OBSERVE_SIZE 512
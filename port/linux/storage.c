@@ -28,10 +28,13 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 static char g_store_path[OC_STORE_PATH_SIZE] = { 0 };
@@ -173,6 +176,39 @@ oc_storage_size(const char *store)
   return fsize;
 }
 
+const uint8_t *
+oc_storage_map(const char *store, size_t *size)
+{
+  if (g_store_path_len == 0 || storage_write_path(store) < 0) {
+    return NULL;
+  }
+  int fd = open(g_store_path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    OC_DBG("failed to open %s for mapping: %d", g_store_path, errno);
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return NULL;
+  }
+  void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+  if (data == MAP_FAILED) {
+    OC_ERR("failed to map %s: %d", g_store_path, errno);
+    return NULL;
+  }
+  *size = (size_t)st.st_size;
+  return (const uint8_t *)data;
+}
+
+void
+oc_storage_unmap(const uint8_t *data, size_t size)
+{
+  munmap((void *)data, size);
+}
+
 long
 oc_storage_read(const char *store, uint8_t *buf, size_t size)
 {
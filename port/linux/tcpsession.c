@@ -29,6 +29,7 @@
 #include "api/oc_network_events_internal.h"
 #include "api/oc_session_events_internal.h"
 #include "api/oc_tcp_internal.h"
+#include "ifcache.h"
 #include "ipadapter.h"
 #include "ipcontext.h"
 #include "messaging/coap/coap_internal.h"
@@ -48,7 +49,6 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
-#include <ifaddrs.h>
 #include <net/if.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -160,6 +160,28 @@ is_matching_address(const struct sockaddr *first, const struct sockaddr *second)
   return false;
 }
 
+typedef struct
+{
+  const struct sockaddr *addr;
+  long if_index;
+} find_interface_ctx_t;
+
+static bool
+find_interface_by_address(const oc_ifaddr_t *interface, void *data)
+{
+  if ((interface->flags & IFF_UP) == 0 ||
+      (interface->flags & IFF_LOOPBACK) != 0) {
+    return true;
+  }
+  find_interface_ctx_t *ctx = (find_interface_ctx_t *)data;
+  if (is_matching_address((const struct sockaddr *)&interface->addr,
+                          ctx->addr)) {
+    ctx->if_index = interface->index;
+    return false;
+  }
+  return true;
+}
+
 static long
 get_interface_index(int sock)
 {
@@ -171,35 +193,19 @@ get_interface_index(int sock)
     return -1;
   }
 
-  struct ifaddrs *ifs = NULL;
-  if (getifaddrs(&ifs) < 0) {
-    OC_ERR("failed querying interfaces: %d", errno);
-    return -1;
+  find_interface_ctx_t ctx = {
+    .addr = (const struct sockaddr *)&addr,
+    .if_index = 0,
+  };
+  if (oc_ifcache_iterate(find_interface_by_address, &ctx)) {
+    // iteration was not interrupted, so no interface matched
+    return 0;
   }
-
-  for (struct ifaddrs *interface = ifs; interface != NULL;
-       interface = interface->ifa_next) {
-    if ((interface->ifa_flags & IFF_UP) == 0 ||
-        (interface->ifa_flags & IFF_LOOPBACK) != 0 ||
-        interface->ifa_addr == NULL) {
-      continue;
-    }
-
-    if (is_matching_address(interface->ifa_addr, (struct sockaddr *)&addr)) {
-      unsigned if_index = if_nametoindex(interface->ifa_name);
-      if (if_index == 0) {
-        OC_ERR("failed obtaining interface index for %s (error=%d)",
-               interface->ifa_name, (int)errno);
-        freeifaddrs(ifs);
-        return -1;
-      }
-      freeifaddrs(ifs);
-      return if_index;
-    }
+  if (ctx.if_index == 0) {
+    OC_ERR("failed querying interfaces");
+    return -1;
   }
-
-  freeifaddrs(ifs);
-  return 0;
+  return ctx.if_index;
 }
 
 #if OC_DBG_IS_ENABLED
@@ -1417,7 +1423,7 @@ oc_tcp_connect_to_endpoint(oc_endpoint_t *endpoint,
                            void *on_tcp_connect_data)
 {
   assert((endpoint->flags & TCP) != 0);
-  ip_context_t *dev = oc_get_ip_context_for_device(endpoint->device);
+  ip_context_t *dev = oc_get_socket_ip_context_for_device(endpoint->device);
   if (dev == NULL) {
     OC_ERR("cannot find ip-context for device(%zu)", endpoint->device);
     return (oc_tcp_connect_result_t){
@@ -138,8 +138,9 @@ typedef struct oc_message_s
   uint8_t encrypted;
 #endif /* OC_SECURITY */
 #ifdef OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER
-  size_t size; // size of the allocated buffer
-#endif         /* OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER */
+  size_t size;     // usable size of the buffer
+  size_t capacity; // size of the allocated buffer (>= size)
+#endif             /* OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER */
 } oc_message_t;
 
 /**
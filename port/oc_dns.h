@@ -55,6 +55,53 @@ void oc_dns_clear_cache(void);
 
 #endif /* OC_DNS_CACHE */
 
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+
+/**
+ * @brief Callback invoked when an asynchronous DNS lookup finishes.
+ *
+ * @param domain the resolved domain
+ * @param status 0 on success, negative value on failure
+ * @param addr the resolved address in the same format as produced by
+ * oc_dns_lookup (NULL on failure)
+ * @param user_data user data passed to oc_dns_lookup_async
+ */
+typedef void (*oc_dns_lookup_handler_t)(const char *domain, int status,
+                                        const oc_string_t *addr,
+                                        void *user_data);
+
+/**
+ * @brief Asynchronous dns look up
+ *
+ * The domain is resolved on a worker thread and the result is delivered to
+ * the handler as an event on the thread running the main loop. A cached
+ * result is delivered the same way, the handler is never invoked from within
+ * this function.
+ *
+ * @param domain the url (cannot be NULL)
+ * @param flags the transport flags
+ * @param handler the completion handler (cannot be NULL)
+ * @param user_data user data passed to the handler
+ * @return int 0 = the lookup was scheduled
+ */
+OC_API
+int oc_dns_lookup_async(const char *domain, transport_flags flags,
+                        oc_dns_lookup_handler_t handler, void *user_data);
+
+/**
+ * @brief Cancel scheduled asynchronous lookups with matching handler and
+ * user data.
+ *
+ * @param handler the completion handler
+ * @param user_data user data passed to oc_dns_lookup_async
+ * @return number of cancelled lookups
+ */
+OC_API
+size_t oc_dns_lookup_async_cancel(oc_dns_lookup_handler_t handler,
+                                  const void *user_data);
+
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
+
 #endif /* OC_DNS_LOOKUP */
 
 #ifdef __cplusplus
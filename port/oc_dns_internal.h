@@ -0,0 +1,96 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifndef PORT_OC_DNS_INTERNAL_H
+#define PORT_OC_DNS_INTERNAL_H
+
+#include "oc_endpoint.h"
+#include "port/oc_dns.h"
+#include "util/oc_features.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef OC_DNS_LOOKUP
+
+#ifdef OC_DNS_CACHE
+
+/* Maximal number of cached domains, the least recently used entry is evicted
+ * when the cache is full */
+#ifndef OC_DNS_CACHE_MAX_ENTRIES
+#define OC_DNS_CACHE_MAX_ENTRIES (8)
+#endif /* OC_DNS_CACHE_MAX_ENTRIES */
+
+/* Time-to-live of a resolved domain in seconds */
+#ifndef OC_DNS_CACHE_TTL
+#define OC_DNS_CACHE_TTL (300)
+#endif /* OC_DNS_CACHE_TTL */
+
+/* Time-to-live of a failed resolution in seconds */
+#ifndef OC_DNS_CACHE_NEGATIVE_TTL
+#define OC_DNS_CACHE_NEGATIVE_TTL (30)
+#endif /* OC_DNS_CACHE_NEGATIVE_TTL */
+
+/** @brief Get the number of entries in the DNS cache (including expired
+ * entries that have not been evicted yet) */
+size_t oc_dns_cache_size(void);
+
+#endif /* OC_DNS_CACHE */
+
+/**
+ * @brief Resolver used to translate a domain to an address.
+ *
+ * @param domain the domain to resolve (cannot be NULL)
+ * @param flags the transport flags, IPV6 or IPV4 flag selects the address
+ * family
+ * @param[out] endpoint the resolved address is written to the addr member
+ * (cannot be NULL)
+ * @return 0 on success
+ * @return non-zero on failure
+ */
+typedef int (*oc_dns_resolve_fn_t)(const char *domain, transport_flags flags,
+                                   oc_endpoint_t *endpoint);
+
+/**
+ * @brief Replace the resolver used by oc_dns_lookup and oc_dns_lookup_async.
+ *
+ * Must be called while no asynchronous lookup is in progress.
+ *
+ * @param resolve the resolver (NULL restores the default resolver based on
+ * getaddrinfo)
+ */
+void oc_dns_set_resolver(oc_dns_resolve_fn_t resolve);
+
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+
+/**
+ * @brief Stop the worker thread resolving asynchronous lookups and drop all
+ * unfinished lookups without invoking their handlers.
+ */
+void oc_dns_lookup_async_shutdown(void);
+
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
+
+#endif /* OC_DNS_LOOKUP */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORT_OC_DNS_INTERNAL_H */
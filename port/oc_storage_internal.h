@@ -23,6 +23,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -55,6 +56,25 @@ bool oc_storage_path(char *buffer, size_t buffer_size);
  */
 long oc_storage_size(const char *store) OC_NONNULL();
 
+/**
+ * @brief map the content of the store to memory for reading
+ *
+ * @param store the path to be mapped (cannot be NULL)
+ * @param[out] size size of the mapped data (cannot be NULL)
+ * @return read-only data of the store on success
+ * @return NULL on failure, if the store is empty or if the port doesn't
+ * support mapping of stores
+ */
+const uint8_t *oc_storage_map(const char *store, size_t *size) OC_NONNULL();
+
+/**
+ * @brief unmap data mapped by oc_storage_map
+ *
+ * @param data the mapped data (cannot be NULL)
+ * @param size size of the mapped data
+ */
+void oc_storage_unmap(const uint8_t *data, size_t size) OC_NONNULL();
+
 #ifdef __cplusplus
 }
 #endif
@@ -46,6 +46,8 @@
 #include <ctime>
 #include <optional>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace std::chrono_literals;
 
@@ -545,6 +547,46 @@ TEST_F(TestConnectivityWithServer, oc_network_get_event_queue_length)
   EXPECT_EQ(eventCountB, 1);
 }
 
+#ifndef OC_INOUT_BUFFER_POOL
+
+TEST_F(TestConnectivityWithServer, oc_network_receive_event_concurrent)
+{
+  constexpr size_t kThreads = 4;
+  constexpr size_t kMessagesPerThread = 16;
+
+  std::vector<std::vector<oc_message_t *>> messages(kThreads);
+  for (auto &thread_messages : messages) {
+    for (size_t i = 0; i < kMessagesPerThread; ++i) {
+      oc_message_t *message =
+        TestConnectivityWithServer::CreateValidTestUdpMsg();
+      message->endpoint.device = kDeviceID;
+      thread_messages.push_back(message);
+    }
+  }
+
+  std::vector<std::thread> producers;
+  for (auto &thread_messages : messages) {
+    producers.emplace_back([&thread_messages] {
+      for (auto *message : thread_messages) {
+        oc_network_receive_event(message);
+      }
+    });
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+
+  EXPECT_EQ(kThreads * kMessagesPerThread,
+            oc_network_get_event_queue_length(kDeviceID));
+
+  oc_endpoint_t ep = messages[0][0]->endpoint;
+  EXPECT_EQ(kThreads * kMessagesPerThread,
+            oc_network_drop_receive_events(&ep));
+  EXPECT_EQ(0, oc_network_get_event_queue_length(kDeviceID));
+}
+
+#endif /* !OC_INOUT_BUFFER_POOL */
+
 TEST_F(TestConnectivityWithServer, oc_network_drop_receive_events)
 {
   size_t eventCount = oc_network_get_event_queue_length(kDeviceID);
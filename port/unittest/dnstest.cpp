@@ -21,11 +21,18 @@
 #ifdef OC_DNS_LOOKUP
 
 #include "port/oc_connectivity.h"
+#include "port/oc_dns_internal.h"
 #include "oc_endpoint.h"
 #include "oc_helpers.h"
+#include "tests/gtest/Device.h"
+#include "util/oc_features.h"
 
 #include "gtest/gtest.h"
 
+#include <atomic>
+#include <chrono>
+#include <string>
+
 #ifdef _WIN32
 #include <WinSock2.h>
 #endif /* _WIN32 */
@@ -81,4 +88,205 @@ TEST_F(TestDNS, oc_dns_lookup_ipv4)
 
 #endif /* OC_IPV4 */
 
+#ifdef OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+
+using namespace std::chrono_literals;
+
+class TestDNSResolver : public testing::Test {
+public:
+  void SetUp() override
+  {
+    resolved.store(0);
+    fail = false;
+    oc_dns_set_resolver(Resolve);
+#ifdef OC_DNS_CACHE
+    oc_dns_clear_cache();
+#endif /* OC_DNS_CACHE */
+  }
+
+  void TearDown() override
+  {
+#ifdef OC_DNS_CACHE
+    oc_dns_clear_cache();
+#endif /* OC_DNS_CACHE */
+    oc_dns_set_resolver(nullptr);
+  }
+
+  static int Resolve(const char *, transport_flags flags,
+                     oc_endpoint_t *endpoint)
+  {
+    ++resolved;
+    if (fail) {
+      return -1;
+    }
+    if ((flags & IPV6) != 0) {
+      endpoint->addr.ipv6.address[15] = 1;
+    }
+#ifdef OC_IPV4
+    else {
+      endpoint->addr.ipv4.address[0] = 127;
+      endpoint->addr.ipv4.address[3] = 1;
+    }
+#endif /* OC_IPV4 */
+    return 0;
+  }
+
+  static std::atomic<int> resolved;
+  static bool fail;
+};
+
+std::atomic<int> TestDNSResolver::resolved{ 0 };
+bool TestDNSResolver::fail{ false };
+
+TEST_F(TestDNSResolver, Resolve)
+{
+  oc_string_t addr{};
+  ASSERT_EQ(0, oc_dns_lookup("plgd.dev", &addr, IPV6));
+  EXPECT_STREQ("[::1]", oc_string(addr));
+  oc_free_string(&addr);
+  EXPECT_EQ(1, resolved.load());
+}
+
+#ifdef OC_DNS_CACHE
+
+TEST_F(TestDNSResolver, Cache)
+{
+  oc_string_t addr{};
+  ASSERT_EQ(0, oc_dns_lookup("plgd.dev", &addr, IPV6));
+  oc_free_string(&addr);
+  ASSERT_EQ(0, oc_dns_lookup("plgd.dev", &addr, IPV6));
+  oc_free_string(&addr);
+  EXPECT_EQ(1, resolved.load());
+  EXPECT_EQ(1, oc_dns_cache_size());
+
+#ifdef OC_IPV4
+  // different address family is cached separately
+  ASSERT_EQ(0, oc_dns_lookup("plgd.dev", &addr, IPV4));
+  EXPECT_STREQ("127.0.0.1", oc_string(addr));
+  oc_free_string(&addr);
+  EXPECT_EQ(2, resolved.load());
+  EXPECT_EQ(2, oc_dns_cache_size());
+#endif /* OC_IPV4 */
+
+  oc_dns_clear_cache();
+  EXPECT_EQ(0, oc_dns_cache_size());
+}
+
+TEST_F(TestDNSResolver, NegativeCache)
+{
+  fail = true;
+  oc_string_t addr{};
+  EXPECT_NE(0, oc_dns_lookup("plgd.dev", &addr, IPV6));
+  // failure is cached and the resolver is not invoked again
+  fail = false;
+  EXPECT_NE(0, oc_dns_lookup("plgd.dev", &addr, IPV6));
+  EXPECT_EQ(1, resolved.load());
+  EXPECT_EQ(nullptr, oc_string(addr));
+}
+
+TEST_F(TestDNSResolver, CacheEviction)
+{
+  for (int i = 0; i < OC_DNS_CACHE_MAX_ENTRIES + 1; ++i) {
+    std::string domain = "device" + std::to_string(i) + ".plgd.dev";
+    oc_string_t addr{};
+    ASSERT_EQ(0, oc_dns_lookup(domain.c_str(), &addr, IPV6));
+    oc_free_string(&addr);
+  }
+  EXPECT_EQ(OC_DNS_CACHE_MAX_ENTRIES, oc_dns_cache_size());
+
+  // the least recently used domain was evicted
+  oc_string_t addr{};
+  resolved.store(0);
+  ASSERT_EQ(0, oc_dns_lookup("device1.plgd.dev", &addr, IPV6));
+  oc_free_string(&addr);
+  EXPECT_EQ(0, resolved.load());
+  ASSERT_EQ(0, oc_dns_lookup("device0.plgd.dev", &addr, IPV6));
+  oc_free_string(&addr);
+  EXPECT_EQ(1, resolved.load());
+}
+
+#endif /* OC_DNS_CACHE */
+
+class TestDNSAsync : public TestDNSResolver {
+public:
+  static void SetUpTestCase() { ASSERT_TRUE(oc::TestDevice::StartServer()); }
+
+  static void TearDownTestCase() { oc::TestDevice::StopServer(); }
+
+  struct Result
+  {
+    bool invoked;
+    int status;
+    std::string addr;
+  };
+
+  static void OnResolved(const char *, int status, const oc_string_t *addr,
+                         void *user_data)
+  {
+    auto *result = static_cast<Result *>(user_data);
+    result->invoked = true;
+    result->status = status;
+    if (addr != nullptr) {
+      result->addr = oc_string(*addr);
+    }
+    oc::TestDevice::Terminate();
+  }
+};
+
+TEST_F(TestDNSAsync, Lookup_F)
+{
+  EXPECT_EQ(-1, oc_dns_lookup_async(nullptr, IPV6, OnResolved, nullptr));
+  EXPECT_EQ(-1, oc_dns_lookup_async("plgd.dev", IPV6, nullptr, nullptr));
+  EXPECT_EQ(-1, oc_dns_lookup_async("", IPV6, OnResolved, nullptr));
+  std::string domain(255, 'a');
+  EXPECT_EQ(-1,
+            oc_dns_lookup_async(domain.c_str(), IPV6, OnResolved, nullptr));
+}
+
+TEST_F(TestDNSAsync, Lookup)
+{
+  Result result{};
+  ASSERT_EQ(0, oc_dns_lookup_async("plgd.dev", IPV6, OnResolved, &result));
+  // the handler is never invoked synchronously
+  EXPECT_FALSE(result.invoked);
+  oc::TestDevice::PoolEventsMsV1(1s);
+  ASSERT_TRUE(result.invoked);
+  EXPECT_EQ(0, result.status);
+  EXPECT_STREQ("[::1]", result.addr.c_str());
+
+#ifdef OC_DNS_CACHE
+  // second lookup is served from cache, but still delivered as an event
+  Result cached{};
+  ASSERT_EQ(0, oc_dns_lookup_async("plgd.dev", IPV6, OnResolved, &cached));
+  EXPECT_FALSE(cached.invoked);
+  oc::TestDevice::PoolEventsMsV1(1s);
+  ASSERT_TRUE(cached.invoked);
+  EXPECT_STREQ("[::1]", cached.addr.c_str());
+  EXPECT_EQ(1, resolved.load());
+#endif /* OC_DNS_CACHE */
+}
+
+TEST_F(TestDNSAsync, LookupFail)
+{
+  fail = true;
+  Result result{};
+  ASSERT_EQ(0, oc_dns_lookup_async("plgd.dev", IPV6, OnResolved, &result));
+  oc::TestDevice::PoolEventsMsV1(1s);
+  ASSERT_TRUE(result.invoked);
+  EXPECT_NE(0, result.status);
+  EXPECT_TRUE(result.addr.empty());
+}
+
+TEST_F(TestDNSAsync, Cancel)
+{
+  Result result{};
+  ASSERT_EQ(0, oc_dns_lookup_async("plgd.dev", IPV6, OnResolved, &result));
+  EXPECT_EQ(1, oc_dns_lookup_async_cancel(OnResolved, &result));
+  oc::TestDevice::PoolEventsMsV1(50ms);
+  EXPECT_FALSE(result.invoked);
+  EXPECT_EQ(0, oc_dns_lookup_async_cancel(OnResolved, &result));
+}
+
+#endif /* OC_HAS_FEATURE_DNS_LOOKUP_ASYNC */
+
 #endif /* OC_DNS_LOOKUP */
@@ -0,0 +1,73 @@
+/******************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#if defined(__linux__) && !defined(__ANDROID__)
+
+#include "ifcache.h"
+
+#include "gtest/gtest.h"
+
+#include <netinet/in.h>
+
+class TestIfCache : public testing::Test {
+public:
+  void TearDown() override { oc_ifcache_clear(); }
+};
+
+TEST_F(TestIfCache, Refresh)
+{
+  ASSERT_TRUE(oc_ifcache_refresh());
+  // at least the loopback interface has an address
+  EXPECT_LT(0, oc_ifcache_size());
+
+  oc_ifcache_clear();
+  EXPECT_EQ(0, oc_ifcache_size());
+}
+
+TEST_F(TestIfCache, Iterate)
+{
+  // the cache is loaded on first access
+  size_t count = 0;
+  ASSERT_TRUE(oc_ifcache_iterate(
+    [](const oc_ifaddr_t *ifaddr, void *data) {
+      EXPECT_NE(0, ifaddr->index);
+      EXPECT_TRUE(ifaddr->addr.ss_family == AF_INET6 ||
+                  ifaddr->addr.ss_family == AF_INET);
+      ++(*static_cast<size_t *>(data));
+      return true;
+    },
+    &count));
+  EXPECT_EQ(oc_ifcache_size(), count);
+}
+
+TEST_F(TestIfCache, IterateStop)
+{
+  ASSERT_TRUE(oc_ifcache_refresh());
+  ASSERT_LT(0, oc_ifcache_size());
+
+  size_t count = 0;
+  EXPECT_FALSE(oc_ifcache_iterate(
+    [](const oc_ifaddr_t *, void *data) {
+      ++(*static_cast<size_t *>(data));
+      return false;
+    },
+    &count));
+  EXPECT_EQ(1, count);
+}
+
+#endif /* __linux__ && !__ANDROID__ */
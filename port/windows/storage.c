@@ -137,6 +137,22 @@ oc_storage_size(const char *store)
   return fsize;
 }
 
+const uint8_t *
+oc_storage_map(const char *store, size_t *size)
+{
+  // mapping of stores is not supported
+  (void)store;
+  (void)size;
+  return NULL;
+}
+
+void
+oc_storage_unmap(const uint8_t *data, size_t size)
+{
+  (void)data;
+  (void)size;
+}
+
 long
 oc_storage_read(const char *store, uint8_t *buf, size_t size)
 {
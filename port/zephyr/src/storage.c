@@ -296,6 +296,22 @@ oc_storage_size(const char *store)
   return -1;
 }
 
+const uint8_t *
+oc_storage_map(const char *store, size_t *size)
+{
+  // mapping of stores is not supported
+  (void)store;
+  (void)size;
+  return NULL;
+}
+
+void
+oc_storage_unmap(const uint8_t *data, size_t size)
+{
+  (void)data;
+  (void)size;
+}
+
 /*
  * store should contains the memory position to read.
  * The value should be multiple of the flash sector size.
@@ -19,6 +19,7 @@
 #ifdef OC_SECURITY
 
 #include "api/oc_core_res_internal.h"
+#include "api/oc_discovery_cache_internal.h"
 #include "api/oc_discovery_internal.h"
 #include "api/oc_helpers_internal.h"
 #include "api/oc_platform_internal.h"
@@ -582,10 +583,12 @@ oc_resource_set_access_in_RFOTM(oc_resource_t *resource, bool state,
   if (state) {
     resource->properties |= OC_ACCESS_IN_RFOTM;
     resource->anon_permission_in_rfotm = permission;
+    oc_discovery_cache_invalidate();
     return;
   }
   resource->properties &= ~OC_ACCESS_IN_RFOTM;
   resource->anon_permission_in_rfotm = OC_PERM_NONE;
+  oc_discovery_cache_invalidate();
 }
 #endif /* OC_HAS_FEATURE_RESOURCE_ACCESS_IN_RFOTM */
 
@@ -36,6 +36,7 @@
 #include "security/oc_pstat_internal.h"
 #include "security/oc_roles_internal.h"
 #include "security/oc_tls_internal.h"
+#include "security/oc_tls_session_internal.h"
 #include "util/oc_list.h"
 #include "util/oc_macros_internal.h"
 #include "util/oc_memb.h"
@@ -229,6 +230,10 @@ oc_sec_cred_free(oc_sec_cred_t *cred)
 #endif /* OC_PKI */
   oc_free_string(&cred->tag);
   oc_memb_free(&g_creds, cred);
+#ifdef OC_TLS_SESSION_RESUMPTION
+  // cached sessions could have been authenticated by the credential
+  oc_tls_session_cache_clear();
+#endif /* OC_TLS_SESSION_RESUMPTION */
 }
 
 void
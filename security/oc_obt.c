@@ -190,6 +190,29 @@ oc_obt_is_owned_device(const oc_uuid_t *uuid)
   return false;
 }
 
+void
+oc_obt_close_device_connection(const oc_device_t *device)
+{
+  if (device->keep_connection) {
+    return;
+  }
+  oc_tls_close_connection(oc_obt_get_secure_endpoint(device->endpoint));
+}
+
+bool
+oc_obt_device_keep_connection(const oc_uuid_t *uuid, bool keep)
+{
+  oc_device_t *device = oc_obt_get_owned_device_handle(uuid);
+  if (device == NULL) {
+    return false;
+  }
+  device->keep_connection = keep;
+  if (!keep) {
+    oc_obt_close_device_connection(device);
+  }
+  return true;
+}
+
 oc_dostype_t
 oc_obt_parse_dos(oc_rep_t *rep)
 {
@@ -261,6 +284,14 @@ cache_new_device(oc_list_t list, const oc_uuid_t *uuid,
   return device;
 }
 
+#ifdef OC_TEST
+oc_device_t *
+oc_obt_add_owned_device(const oc_uuid_t *uuid, const oc_endpoint_t *endpoint)
+{
+  return cache_new_device(oc_devices, uuid, endpoint);
+}
+#endif /* OC_TEST */
+
 static oc_event_callback_retval_t
 free_device(void *data)
 {
@@ -322,7 +353,7 @@ oc_obt_load_state(void)
     return;
   }
 
-  oc_memb_t rep_objects = { sizeof(oc_rep_t), 0, 0, 0, 0 };
+  OC_MEMB_LOCAL(rep_objects, oc_rep_t, 0);
   oc_memb_t *prev_rep_objects = oc_rep_reset_pool(&rep_objects);
   oc_rep_t *parsed_rep = oc_parse_rep(buf, (size_t)ret);
   if (parsed_rep == NULL) {
@@ -1451,11 +1482,9 @@ free_credprov_state(oc_credprov_ctx_t *p, int status)
     return;
   }
   oc_list_remove(oc_credprov_ctx_l, p);
-  const oc_endpoint_t *ep = oc_obt_get_secure_endpoint(p->device1->endpoint);
-  oc_tls_close_connection(ep);
+  oc_obt_close_device_connection(p->device1);
   if (p->device2) {
-    ep = oc_obt_get_secure_endpoint(p->device2->endpoint);
-    oc_tls_close_connection(ep);
+    oc_obt_close_device_connection(p->device2);
   }
   p->cb.cb(status, p->cb.data);
 #ifdef OC_PKI
@@ -1711,8 +1740,7 @@ free_trustanchor_state(oc_trustanchor_ctx_t *p, int status)
     return;
   }
   oc_list_remove(oc_installtrust_ctx_l, p);
-  const oc_endpoint_t *ep = oc_obt_get_secure_endpoint(p->device1->endpoint);
-  oc_tls_close_connection(ep);
+  oc_obt_close_device_connection(p->device1);
 
   p->cb.cb(status, p->cb.data);
 
@@ -2577,9 +2605,7 @@ free_acl2prov_state(oc_acl2prov_ctx_t *request, int status)
   }
   oc_list_remove(oc_acl2prov_ctx_l, request);
   free_ace(request->ace);
-  const oc_endpoint_t *ep =
-    oc_obt_get_secure_endpoint(request->device->endpoint);
-  oc_tls_close_connection(ep);
+  oc_obt_close_device_connection(request->device);
   if (request->switch_dos) {
     free_switch_dos_state(request->switch_dos);
   }
@@ -3853,6 +3879,7 @@ oc_obt_init(void)
 void
 oc_obt_shutdown(void)
 {
+  oc_obt_batch_shutdown();
   oc_device_t *device = (oc_device_t *)oc_list_pop(oc_cache);
   while (device) {
     oc_free_server_endpoints(device->endpoint);
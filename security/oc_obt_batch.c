@@ -0,0 +1,347 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "oc_config.h"
+
+#ifdef OC_SECURITY
+
+#ifndef OC_DYNAMIC_ALLOCATION
+#error "ERROR: Please rebuild with OC_DYNAMIC_ALLOCATION"
+#endif /* !OC_DYNAMIC_ALLOCATION */
+
+#include "oc_obt.h"
+#include "port/oc_log_internal.h"
+#include "security/oc_obt_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Onboarding state of a device of the batch */
+typedef struct
+{
+  oc_uuid_t uuid;
+  oc_obt_batch_step_t step;
+  size_t ace_index; ///< index of the next ACE
+  bool in_flight;
+} obt_batch_device_t;
+
+typedef struct
+{
+  obt_batch_device_t *devices;
+  size_t count;
+  size_t next; ///< index of the next device to start
+  size_t in_flight;
+  size_t done;
+  size_t failed;
+  oc_obt_batch_plan_t plan;
+  oc_obt_batch_device_cb_t device_cb;
+  oc_obt_batch_progress_cb_t progress_cb;
+  void *data;
+  bool scheduling;
+  bool cancelled;
+} obt_batch_t;
+
+static obt_batch_t g_batch;
+
+static void batch_run_step(obt_batch_device_t *d);
+
+static obt_batch_device_t *
+batch_get_device(void *data)
+{
+  obt_batch_device_t *d = (obt_batch_device_t *)data;
+  if (g_batch.devices == NULL || d < g_batch.devices ||
+      d >= g_batch.devices + g_batch.count || !d->in_flight) {
+    return NULL;
+  }
+  return d;
+}
+
+static void
+batch_free(void)
+{
+  free(g_batch.devices);
+  memset(&g_batch, 0, sizeof(g_batch));
+}
+
+static void batch_schedule(void);
+
+static void
+batch_finish_device(obt_batch_device_t *d, int status)
+{
+  d->in_flight = false;
+  --g_batch.in_flight;
+  ++g_batch.done;
+  if (status < 0) {
+    ++g_batch.failed;
+  } else {
+    d->step = OC_OBT_BATCH_STEP_DONE;
+  }
+  // close the connection kept open between the steps
+  oc_obt_device_keep_connection(&d->uuid, false);
+#if OC_DBG_IS_ENABLED
+  char di[OC_UUID_LEN];
+  oc_uuid_to_str(&d->uuid, di, OC_UUID_LEN);
+  OC_DBG("oc_obt_batch: device %s finished at step %d with status %d", di,
+         (int)d->step, status);
+#endif /* OC_DBG_IS_ENABLED */
+  g_batch.device_cb(&d->uuid, d->step, status < 0 ? -1 : 0, g_batch.data);
+  if (g_batch.done < g_batch.count && g_batch.progress_cb != NULL) {
+    g_batch.progress_cb(g_batch.done, g_batch.failed, g_batch.count,
+                        g_batch.data);
+  }
+  batch_schedule();
+}
+
+static void
+batch_status_cb(int status, void *data)
+{
+  obt_batch_device_t *d = batch_get_device(data);
+  if (d == NULL) {
+    return;
+  }
+  if (status < 0) {
+    batch_finish_device(d, -1);
+    return;
+  }
+  d->step = OC_OBT_BATCH_STEP_ACE;
+  batch_run_step(d);
+}
+
+static void
+batch_device_status_cb(const oc_uuid_t *uuid, int status, void *data)
+{
+  (void)uuid;
+  obt_batch_device_t *d = batch_get_device(data);
+  if (d == NULL) {
+    return;
+  }
+  if (status < 0) {
+    batch_finish_device(d, -1);
+    return;
+  }
+  if (d->step == OC_OBT_BATCH_STEP_OTM) {
+    // the owner credential is installed, reuse the session of the first
+    // provisioning step for the next ones
+    oc_obt_device_keep_connection(&d->uuid, true);
+    d->step = OC_OBT_BATCH_STEP_IDENTITY_CERT;
+  }
+  // OC_OBT_BATCH_STEP_ACE continues with the next ACE
+  batch_run_step(d);
+}
+
+static void
+batch_cloud_conf_cb(oc_client_response_t *response)
+{
+  obt_batch_device_t *d = batch_get_device(response->user_data);
+  if (d == NULL) {
+    return;
+  }
+  if (response->code >= OC_STATUS_BAD_REQUEST) {
+    batch_finish_device(d, -1);
+    return;
+  }
+  d->step = OC_OBT_BATCH_STEP_DONE;
+  batch_run_step(d);
+}
+
+static int
+batch_perform_otm(obt_batch_device_t *d)
+{
+#ifdef OC_PKI
+  if (g_batch.plan.otm == OC_OBT_BATCH_OTM_CERT) {
+    return oc_obt_perform_cert_otm(&d->uuid, batch_device_status_cb, d);
+  }
+#endif /* OC_PKI */
+  return oc_obt_perform_just_works_otm(&d->uuid, batch_device_status_cb, d);
+}
+
+static int
+batch_provision_ace(obt_batch_device_t *d, bool *issued)
+{
+  *issued = false;
+  if (g_batch.plan.new_ace == NULL) {
+    return 0;
+  }
+  oc_sec_ace_t *ace = g_batch.plan.new_ace(&d->uuid, d->ace_index,
+                                           g_batch.plan.new_ace_data);
+  if (ace == NULL) {
+    return 0;
+  }
+  ++d->ace_index;
+  if (oc_obt_provision_ace(&d->uuid, ace, batch_device_status_cb, d) < 0) {
+    oc_obt_free_ace(ace);
+    return -1;
+  }
+  *issued = true;
+  return 0;
+}
+
+/* Issue the current step of the device, steps that are not in the plan are
+ * skipped */
+static void
+batch_run_step(obt_batch_device_t *d)
+{
+  while (true) {
+    switch (d->step) {
+    case OC_OBT_BATCH_STEP_OTM:
+      if (batch_perform_otm(d) < 0) {
+        batch_finish_device(d, -1);
+      }
+      return;
+    case OC_OBT_BATCH_STEP_IDENTITY_CERT:
+#ifdef OC_PKI
+      if (g_batch.plan.identity_cert) {
+        if (oc_obt_provision_identity_certificate(&d->uuid, batch_status_cb,
+                                                  d) < 0) {
+          batch_finish_device(d, -1);
+        }
+        return;
+      }
+#endif /* OC_PKI */
+      d->step = OC_OBT_BATCH_STEP_ACE;
+      break;
+    case OC_OBT_BATCH_STEP_ACE: {
+      bool issued = false;
+      if (batch_provision_ace(d, &issued) < 0) {
+        batch_finish_device(d, -1);
+        return;
+      }
+      if (issued) {
+        return;
+      }
+      d->step = OC_OBT_BATCH_STEP_CLOUD_CONF;
+    } break;
+    case OC_OBT_BATCH_STEP_CLOUD_CONF:
+      if (g_batch.plan.cloud.cis != NULL) {
+        if (oc_obt_update_cloud_conf_device(
+              &d->uuid, g_batch.plan.cloud.url, g_batch.plan.cloud.at,
+              g_batch.plan.cloud.apn, g_batch.plan.cloud.cis,
+              g_batch.plan.cloud.sid, batch_cloud_conf_cb, d) < 0) {
+          batch_finish_device(d, -1);
+        }
+        return;
+      }
+      d->step = OC_OBT_BATCH_STEP_DONE;
+      break;
+    case OC_OBT_BATCH_STEP_DONE:
+    default:
+      batch_finish_device(d, 0);
+      return;
+    }
+  }
+}
+
+/* Start devices up to the limit of devices in flight and finish the batch
+ * when all devices are done */
+static void
+batch_schedule(void)
+{
+  // a device finished synchronously by the loop below calls back here
+  if (g_batch.scheduling) {
+    return;
+  }
+  g_batch.scheduling = true;
+  while (g_batch.next < g_batch.count &&
+         (g_batch.cancelled ||
+          g_batch.in_flight < g_batch.plan.max_in_flight)) {
+    obt_batch_device_t *d = &g_batch.devices[g_batch.next++];
+    d->in_flight = true;
+    ++g_batch.in_flight;
+    if (g_batch.cancelled) {
+      batch_finish_device(d, -1);
+      continue;
+    }
+    batch_run_step(d);
+  }
+  g_batch.scheduling = false;
+
+  if (g_batch.devices != NULL && g_batch.done == g_batch.count) {
+    oc_obt_batch_progress_cb_t progress_cb = g_batch.progress_cb;
+    void *data = g_batch.data;
+    size_t count = g_batch.count;
+    size_t failed = g_batch.failed;
+    OC_DBG("oc_obt_batch: finished %zu devices, %zu failed", count, failed);
+    batch_free();
+    if (progress_cb != NULL) {
+      progress_cb(count, failed, count, data);
+    }
+  }
+}
+
+int
+oc_obt_batch_onboard(const oc_uuid_t *uuids, size_t count,
+                     const oc_obt_batch_plan_t *plan,
+                     oc_obt_batch_device_cb_t device_cb,
+                     oc_obt_batch_progress_cb_t progress_cb, void *data)
+{
+  if (uuids == NULL || count == 0 || plan == NULL || device_cb == NULL) {
+    OC_ERR("oc_obt_batch: invalid arguments");
+    return -1;
+  }
+  if (oc_obt_batch_is_running()) {
+    OC_ERR("oc_obt_batch: batch already running");
+    return -1;
+  }
+  obt_batch_device_t *devices =
+    (obt_batch_device_t *)calloc(count, sizeof(obt_batch_device_t));
+  if (devices == NULL) {
+    OC_ERR("oc_obt_batch: insufficient memory");
+    return -1;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    memcpy(&devices[i].uuid, &uuids[i], sizeof(oc_uuid_t));
+    devices[i].step = OC_OBT_BATCH_STEP_OTM;
+  }
+  g_batch.devices = devices;
+  g_batch.count = count;
+  g_batch.plan = *plan;
+  if (g_batch.plan.max_in_flight == 0) {
+    g_batch.plan.max_in_flight = OC_OBT_BATCH_DEFAULT_MAX_IN_FLIGHT;
+  }
+  g_batch.device_cb = device_cb;
+  g_batch.progress_cb = progress_cb;
+  g_batch.data = data;
+  OC_DBG("oc_obt_batch: onboarding %zu devices, %zu in flight", count,
+         g_batch.plan.max_in_flight);
+  batch_schedule();
+  return 0;
+}
+
+void
+oc_obt_batch_cancel(void)
+{
+  if (!oc_obt_batch_is_running()) {
+    return;
+  }
+  g_batch.cancelled = true;
+  batch_schedule();
+}
+
+bool
+oc_obt_batch_is_running(void)
+{
+  return g_batch.devices != NULL;
+}
+
+void
+oc_obt_batch_shutdown(void)
+{
+  batch_free();
+}
+
+#endif /* OC_SECURITY */
@@ -50,6 +50,8 @@ typedef struct oc_device_t
   oc_endpoint_t *endpoint;
   oc_uuid_t uuid;
   void *ctx;
+  bool keep_connection; ///< keep the secure connection between provisioning
+                        ///< steps
 } oc_device_t;
 
 /* Context for oc_obt_discover_owned/unowned cbs */
@@ -222,6 +224,44 @@ oc_device_t *oc_obt_get_cached_device_handle(const oc_uuid_t *uuid);
 oc_device_t *oc_obt_get_owned_device_handle(const oc_uuid_t *uuid);
 
 bool oc_obt_is_owned_device(const oc_uuid_t *uuid);
+
+/**
+ * @brief Keep the secure connection to the owned device open after a
+ * provisioning sequence finishes, so the next sequence doesn't need a new
+ * handshake.
+ *
+ * @param uuid uuid of the owned device (cannot be NULL)
+ * @param keep true to keep the connection open, false to close it
+ * @return true the device was found
+ * @return false otherwise
+ */
+bool oc_obt_device_keep_connection(const oc_uuid_t *uuid, bool keep)
+  OC_NONNULL();
+
+/**
+ * @brief Close the secure connection to the device after a provisioning
+ * sequence, unless it is kept open by oc_obt_device_keep_connection.
+ *
+ * @param device the device (cannot be NULL)
+ */
+void oc_obt_close_device_connection(const oc_device_t *device) OC_NONNULL();
+
+#ifdef OC_TEST
+/**
+ * @brief Add the device to the cache of owned devices.
+ *
+ * @param uuid uuid of the device (cannot be NULL)
+ * @param endpoint endpoint of the device (cannot be NULL)
+ * @return oc_device_t* the device handle
+ * @return NULL on allocation failure
+ */
+oc_device_t *oc_obt_add_owned_device(const oc_uuid_t *uuid,
+                                     const oc_endpoint_t *endpoint)
+  OC_NONNULL();
+#endif /* OC_TEST */
+
+/** @brief Free the running batch onboarding without invoking the callbacks */
+void oc_obt_batch_shutdown(void);
 oc_dostype_t oc_obt_parse_dos(oc_rep_t *rep);
 
 oc_otm_ctx_t *oc_obt_alloc_otm_ctx(void);
@@ -161,197 +161,136 @@ oc_sec_dump_sp(size_t device)
 }
 
 #ifdef OC_PKI
+static int
+store_decode_ecdsa_keypair(const oc_rep_t *rep, size_t device, void *data)
+{
+  (void)data;
+  if (!oc_sec_ecdsa_decode_keypair_for_device(rep, device)) {
+    // a stored keypair is not regenerated
+    OC_ERR("cannot decode ECDSA keypair for device(%zu)", device);
+  }
+  return 0;
+}
+
 void
 oc_sec_load_ecdsa_keypair(size_t device)
 {
-  oc_storage_buffer_t sb = oc_storage_get_buffer(OC_MAX_APP_DATA_SIZE);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  if (sb.buffer == NULL) {
-    OC_ERR("cannot load %s from store: cannot allocate buffer", "keypair");
-    oc_sec_sp_default(device);
+  if (oc_storage_data_load("keypair", device, store_decode_ecdsa_keypair,
+                           NULL) > 0) {
+    OC_DBG("successfully read ECDSA keypair for device %zd", device);
     return;
   }
-#endif /* !OC_APP_DATA_STORAGE_BUFFER */
-
-  char svr_tag[OC_STORAGE_SVR_TAG_MAX];
-  oc_storage_gen_svr_tag("keypair", device, svr_tag, sizeof(svr_tag));
-  long ret = oc_storage_read(svr_tag, sb.buffer, sb.size);
-  if (ret > 0) {
-    OC_MEMB_LOCAL(rep_objects, oc_rep_t, OC_MAX_NUM_REP_OBJECTS);
-    oc_memb_t *prev_rep_objects = oc_rep_reset_pool(&rep_objects);
-    oc_rep_t *rep = oc_parse_rep(sb.buffer, (size_t)ret);
-    if (rep != NULL && oc_sec_ecdsa_decode_keypair_for_device(rep, device)) {
-      OC_DBG("successfully read ECDSA keypair for device %zd", device);
-    }
-    oc_free_rep(rep);
-    oc_rep_set_pool(prev_rep_objects);
+  if (!oc_sec_ecdsa_update_or_generate_keypair_for_device(
+        oc_sec_certs_ecp_group_id(), device)) {
+    OC_ERR("error generating ECDSA keypair for device %zd", device);
   }
+  oc_sec_dump_ecdsa_keypair(device);
+}
 
-  oc_storage_free_buffer(sb);
-
-  if (ret <= 0) {
-    if (!oc_sec_ecdsa_update_or_generate_keypair_for_device(
-          oc_sec_certs_ecp_group_id(), device)) {
-      OC_ERR("error generating ECDSA keypair for device %zd", device);
-    }
-    oc_sec_dump_ecdsa_keypair(device);
-  }
+static int
+store_encode_ecdsa_keypair(size_t device, const void *data)
+{
+  (void)data;
+  return oc_sec_ecdsa_encode_keypair_for_device(device) ? 0 : -1;
 }
 
 void
 oc_sec_dump_ecdsa_keypair(size_t device)
 {
-  oc_storage_buffer_t sb = oc_storage_get_buffer(OC_MIN_APP_DATA_SIZE);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  if (sb.buffer == NULL) {
-    OC_ERR("cannot dump %s to store: cannot allocate buffer", "keypair");
-    return;
-  }
-  oc_rep_new_realloc_v1(&sb.buffer, OC_MIN_APP_DATA_SIZE, OC_MAX_APP_DATA_SIZE);
-#else  /* !OC_APP_DATA_STORAGE_BUFFER */
-  oc_rep_new_v1(sb.buffer, OC_MIN_APP_DATA_SIZE);
-#endif /* OC_APP_DATA_STORAGE_BUFFER */
-
-  oc_sec_ecdsa_encode_keypair_for_device(device);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  sb.buffer = oc_rep_shrink_encoder_buf(sb.buffer);
-  sb.size = (size_t)oc_rep_get_encoder_buffer_size();
-#endif /* !OC_APP_DATA_STORAGE_BUFFER */
-  int size = oc_rep_get_encoded_payload_size();
-  if (size > 0) {
-    OC_DBG("oc_store: encoded sp size %d", size);
-    char svr_tag[OC_STORAGE_SVR_TAG_MAX];
-    oc_storage_gen_svr_tag("keypair", device, svr_tag, sizeof(svr_tag));
-    oc_storage_write(svr_tag, sb.buffer, size);
+  long ret = oc_storage_data_save("keypair", device, store_encode_ecdsa_keypair,
+                                  NULL);
+  if (ret <= 0) {
+    OC_ERR("cannot dump keypair to storage: error(%ld)", ret);
   }
-  oc_storage_free_buffer(sb);
 }
 #endif /* OC_PKI */
 
+static int
+store_decode_cred(const oc_rep_t *rep, size_t device, void *data)
+{
+  (void)data;
+  if (!oc_sec_decode_cred(rep, NULL, true, false, NULL, device, NULL, NULL)) {
+    OC_ERR("cannot decode cred for device(%zu)", device);
+    return -1;
+  }
+  return 0;
+}
+
 void
 oc_sec_load_cred(size_t device)
 {
-  oc_storage_buffer_t sb = oc_storage_get_buffer(OC_MAX_APP_DATA_SIZE);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  if (sb.buffer == NULL) {
-    OC_ERR("cannot load %s from store: cannot allocate buffer",
-           OCF_SEC_CRED_STORE_NAME);
+  if (oc_storage_data_load(OCF_SEC_CRED_STORE_NAME, device, store_decode_cred,
+                           NULL) <= 0) {
+    OC_DBG("failed to load cred from storage for device(%zu)", device);
     return;
   }
-#endif /* !OC_APP_DATA_STORAGE_BUFFER */
-
-  char svr_tag[OC_STORAGE_SVR_TAG_MAX];
-  oc_storage_gen_svr_tag(OCF_SEC_CRED_STORE_NAME, device, svr_tag,
-                         sizeof(svr_tag));
-  long ret = oc_storage_read(svr_tag, sb.buffer, sb.size);
-  if (ret > 0) {
-    OC_MEMB_LOCAL(rep_objects, oc_rep_t, OC_MAX_NUM_REP_OBJECTS);
-    oc_memb_t *prev_rep_objects = oc_rep_reset_pool(&rep_objects);
-    oc_rep_t *rep = oc_parse_rep(sb.buffer, (size_t)ret);
-    if (rep != NULL &&
-        oc_sec_decode_cred(rep, NULL, true, false, NULL, device, NULL, NULL)) {
-      OC_DBG("successfully read cred for device %zd", device);
-    }
-    oc_free_rep(rep);
-    oc_rep_set_pool(prev_rep_objects);
-  }
-  oc_storage_free_buffer(sb);
+  OC_DBG("successfully read cred for device %zd", device);
+}
+
+static int
+store_encode_cred(size_t device, const void *data)
+{
+  (void)data;
+  oc_sec_encode_cred(device, /*iface_mask*/ 0, /*to_storage*/ true);
+  return 0;
 }
 
 void
 oc_sec_dump_cred(size_t device)
 {
-  oc_storage_buffer_t sb = oc_storage_get_buffer(OC_MIN_APP_DATA_SIZE);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  if (sb.buffer == NULL) {
-    OC_ERR("cannot dump %s to store: cannot allocate buffer",
-           OCF_SEC_CRED_STORE_NAME);
-    return;
+  long ret = oc_storage_data_save(OCF_SEC_CRED_STORE_NAME, device,
+                                  store_encode_cred, NULL);
+  if (ret <= 0) {
+    OC_ERR("cannot dump cred to storage: error(%ld)", ret);
   }
-  oc_rep_new_realloc_v1(&sb.buffer, OC_MIN_APP_DATA_SIZE, OC_MAX_APP_DATA_SIZE);
-#else  /* !OC_APP_DATA_STORAGE_BUFFER */
-  oc_rep_new_v1(sb.buffer, OC_MIN_APP_DATA_SIZE);
-#endif /* OC_APP_DATA_STORAGE_BUFFER */
-
-  oc_sec_encode_cred(device, 0, true);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  sb.buffer = oc_rep_shrink_encoder_buf(sb.buffer);
-  sb.size = (size_t)oc_rep_get_encoder_buffer_size();
-#endif /* !OC_APP_DATA_STORAGE_BUFFER */
-  int size = oc_rep_get_encoded_payload_size();
-  if (size > 0) {
-    OC_DBG("oc_store: encoded cred size %d", size);
-    char svr_tag[OC_STORAGE_SVR_TAG_MAX];
-    oc_storage_gen_svr_tag(OCF_SEC_CRED_STORE_NAME, device, svr_tag,
-                           sizeof(svr_tag));
-    oc_storage_write(svr_tag, sb.buffer, size);
+}
+
+static int
+store_decode_acl(const oc_rep_t *rep, size_t device, void *data)
+{
+  (void)data;
+  if (!oc_sec_decode_acl(rep, true, device, NULL, NULL)) {
+    OC_ERR("cannot decode acl for device(%zu)", device);
+    return -1;
   }
-  oc_storage_free_buffer(sb);
+  return 0;
 }
 
 void
 oc_sec_load_acl(size_t device)
 {
-  oc_storage_buffer_t sb = oc_storage_get_buffer(OC_MAX_APP_DATA_SIZE);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  if (sb.buffer == NULL) {
-    OC_ERR("cannot load %s from store: cannot allocate buffer",
-           OCF_SEC_ACL_STORE_NAME);
+  if (oc_storage_data_load(OCF_SEC_ACL_STORE_NAME, device, store_decode_acl,
+                           NULL) <= 0) {
+    OC_DBG("failed to load acl from storage for device(%zu)", device);
     return;
   }
-#endif /* !OC_APP_DATA_STORAGE_BUFFER */
-
-  char svr_tag[OC_STORAGE_SVR_TAG_MAX];
-  oc_storage_gen_svr_tag(OCF_SEC_ACL_STORE_NAME, device, svr_tag,
-                         sizeof(svr_tag));
-  long ret = oc_storage_read(svr_tag, sb.buffer, sb.size);
-  if (ret > 0) {
-    OC_MEMB_LOCAL(rep_objects, oc_rep_t, OC_MAX_NUM_REP_OBJECTS);
-    oc_memb_t *prev_rep_objects = oc_rep_reset_pool(&rep_objects);
-    oc_rep_t *rep = oc_parse_rep(sb.buffer, (size_t)ret);
-    if (rep != NULL && oc_sec_decode_acl(rep, true, device, NULL, NULL)) {
-      OC_DBG("successfully read acl for device %zd", device);
-    }
-    oc_free_rep(rep);
-    oc_rep_set_pool(prev_rep_objects);
+  OC_DBG("successfully read acl for device %zd", device);
+}
+
+static int
+store_encode_acl(size_t device, const void *data)
+{
+  (void)data;
+  if (!oc_sec_encode_acl(device, /*iface_mask*/ 0, /*to_storage*/ true)) {
+    return -1;
   }
-  oc_storage_free_buffer(sb);
+  return 0;
 }
 
 void
 oc_sec_dump_acl(size_t device)
 {
-  oc_storage_buffer_t sb = oc_storage_get_buffer(OC_MIN_APP_DATA_SIZE);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  if (sb.buffer == NULL) {
-    OC_ERR("cannot dump %s to store: cannot allocate buffer",
-           OCF_SEC_ACL_STORE_NAME);
-    return;
-  }
-  oc_rep_new_realloc_v1(&sb.buffer, OC_MIN_APP_DATA_SIZE, OC_MAX_APP_DATA_SIZE);
-#else  /* !OC_APP_DATA_STORAGE_BUFFER */
-  oc_rep_new_v1(sb.buffer, OC_MIN_APP_DATA_SIZE);
-#endif /* OC_APP_DATA_STORAGE_BUFFER */
-
-  oc_sec_encode_acl(device, 0, true);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  sb.buffer = oc_rep_shrink_encoder_buf(sb.buffer);
-  sb.size = (size_t)oc_rep_get_encoder_buffer_size();
-#endif /* !OC_APP_DATA_STORAGE_BUFFER */
-  int size = oc_rep_get_encoded_payload_size();
-  if (size > 0) {
-    OC_DBG("oc_store: encoded ACL size %d", size);
-    char svr_tag[OC_STORAGE_SVR_TAG_MAX];
-    oc_storage_gen_svr_tag(OCF_SEC_ACL_STORE_NAME, device, svr_tag,
-                           sizeof(svr_tag));
-    oc_storage_write(svr_tag, sb.buffer, size);
+  long ret = oc_storage_data_save(OCF_SEC_ACL_STORE_NAME, device,
+                                  store_encode_acl, NULL);
+  if (ret <= 0) {
+    OC_ERR("cannot dump acl to storage: error(%ld)", ret);
   }
-  oc_storage_free_buffer(sb);
 }
 
-static void
-sec_load_unique_ids_from_rep(oc_rep_t *rep, size_t device)
+static int
+store_decode_unique_ids(const oc_rep_t *rep, size_t device, void *data)
 {
+  (void)data;
   oc_platform_info_t *platform_info = oc_core_get_platform_info();
   oc_device_info_t *device_info = oc_core_get_device_info(device);
   for (; rep != NULL; rep = rep->next) {
@@ -366,52 +305,22 @@ sec_load_unique_ids_from_rep(oc_rep_t *rep, size_t device)
       }
     }
   }
+  return 0;
 }
 
 void
 oc_sec_load_unique_ids(size_t device)
 {
-  oc_storage_buffer_t sb = oc_storage_get_buffer(OC_MAX_APP_DATA_SIZE);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  if (sb.buffer == NULL) {
-    OC_ERR("cannot load %s from store: cannot allocate buffer",
-           OCF_SEC_U_IDS_STORE_NAME);
-    return;
-  }
-#endif /* !OC_APP_DATA_STORAGE_BUFFER */
-
-  char svr_tag[OC_STORAGE_SVR_TAG_MAX];
-  oc_storage_gen_svr_tag(OCF_SEC_U_IDS_STORE_NAME, device, svr_tag,
-                         sizeof(svr_tag));
-  long ret = oc_storage_read(svr_tag, sb.buffer, sb.size);
-  if (ret > 0) {
-    OC_MEMB_LOCAL(rep_objects, oc_rep_t, OC_MAX_NUM_REP_OBJECTS);
-    oc_memb_t *prev_rep_objects = oc_rep_reset_pool(&rep_objects);
-    oc_rep_t *rep = oc_parse_rep(sb.buffer, (size_t)ret);
-    sec_load_unique_ids_from_rep(rep, device);
-    oc_free_rep(rep);
-    oc_rep_set_pool(prev_rep_objects);
-  } else {
+  if (oc_storage_data_load(OCF_SEC_U_IDS_STORE_NAME, device,
+                           store_decode_unique_ids, NULL) <= 0) {
     oc_sec_dump_unique_ids(device);
   }
-  oc_storage_free_buffer(sb);
 }
 
-void
-oc_sec_dump_unique_ids(size_t device)
+static int
+store_encode_unique_ids(size_t device, const void *data)
 {
-  oc_storage_buffer_t sb = oc_storage_get_buffer(OC_MIN_APP_DATA_SIZE);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  if (sb.buffer == NULL) {
-    OC_ERR("cannot dump %s to store: cannot allocate buffer",
-           OCF_SEC_U_IDS_STORE_NAME);
-    return;
-  }
-  oc_rep_new_realloc_v1(&sb.buffer, OC_MIN_APP_DATA_SIZE, OC_MAX_APP_DATA_SIZE);
-#else  /* !OC_APP_DATA_STORAGE_BUFFER */
-  oc_rep_new_v1(sb.buffer, OC_MIN_APP_DATA_SIZE);
-#endif /* OC_APP_DATA_STORAGE_BUFFER */
-
+  (void)data;
   const oc_device_info_t *device_info = oc_core_get_device_info(device);
   char piid[OC_UUID_LEN];
   oc_uuid_to_str(&device_info->piid, piid, sizeof(piid));
@@ -423,81 +332,59 @@ oc_sec_dump_unique_ids(size_t device)
   oc_rep_set_text_string(root, pi, pi);
   oc_rep_set_text_string(root, piid, piid);
   oc_rep_end_root_object();
+  return 0;
+}
 
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  sb.buffer = oc_rep_shrink_encoder_buf(sb.buffer);
-  sb.size = (size_t)oc_rep_get_encoder_buffer_size();
-#endif /* !OC_APP_DATA_STORAGE_BUFFER */
-  int size = oc_rep_get_encoded_payload_size();
-  if (size > 0) {
-    OC_DBG("oc_store: encoded unique identifiers: size %d", size);
-    char svr_tag[OC_STORAGE_SVR_TAG_MAX];
-    oc_storage_gen_svr_tag(OCF_SEC_U_IDS_STORE_NAME, device, svr_tag,
-                           sizeof(svr_tag));
-    oc_storage_write(svr_tag, sb.buffer, size);
+void
+oc_sec_dump_unique_ids(size_t device)
+{
+  long ret = oc_storage_data_save(OCF_SEC_U_IDS_STORE_NAME, device,
+                                  store_encode_unique_ids, NULL);
+  if (ret <= 0) {
+    OC_ERR("cannot dump unique identifiers to storage: error(%ld)", ret);
+  }
+}
+
+static int
+store_decode_ael(const oc_rep_t *rep, size_t device, void *data)
+{
+  (void)data;
+  if (!oc_sec_ael_decode(device, rep, true)) {
+    OC_ERR("cannot decode ael for device(%zu)", device);
+    return -1;
   }
-  oc_storage_free_buffer(sb);
+  return 0;
 }
 
 void
 oc_sec_load_ael(size_t device)
 {
-  oc_storage_buffer_t sb = oc_storage_get_buffer(OC_MAX_APP_DATA_SIZE);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  if (sb.buffer == NULL) {
-    OC_ERR("cannot load %s from store: cannot allocate buffer",
-           OCF_SEC_AEL_STORE_NAME);
+  if (oc_storage_data_load(OCF_SEC_AEL_STORE_NAME, device, store_decode_ael,
+                           NULL) <= 0) {
+    OC_DBG("failed to load ael from storage for device(%zu)", device);
     return;
   }
-#endif /* !OC_APP_DATA_STORAGE_BUFFER */
-
-  char svr_tag[OC_STORAGE_SVR_TAG_MAX];
-  oc_storage_gen_svr_tag(OCF_SEC_AEL_STORE_NAME, device, svr_tag,
-                         sizeof(svr_tag));
-  long ret = oc_storage_read(svr_tag, sb.buffer, sb.size);
-  if (ret > 0) {
-    OC_MEMB_LOCAL(rep_objects, oc_rep_t, OC_MAX_NUM_REP_OBJECTS);
-    oc_memb_t *prev_rep_objects = oc_rep_reset_pool(&rep_objects);
-    oc_rep_t *rep = oc_parse_rep(sb.buffer, (size_t)ret);
-    if (rep != NULL && oc_sec_ael_decode(device, rep, true)) {
-      OC_DBG("successfully read ael for device %zd", device);
-    }
-    oc_free_rep(rep);
-    oc_rep_set_pool(prev_rep_objects);
+  OC_DBG("successfully read ael for device %zd", device);
+}
+
+static int
+store_encode_ael(size_t device, const void *data)
+{
+  (void)data;
+  if (!oc_sec_ael_encode(device, /*iface_mask*/ 0, /*to_storage*/ true)) {
+    return -1;
   }
-  oc_storage_free_buffer(sb);
+  return 0;
 }
 
 void
 oc_sec_dump_ael(size_t device)
 {
-  oc_storage_buffer_t sb = oc_storage_get_buffer(OC_MIN_APP_DATA_SIZE);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  if (sb.buffer == NULL) {
-    OC_ERR("cannot dump %s to store: cannot allocate buffer",
-           OCF_SEC_AEL_STORE_NAME);
-    return;
-  }
-  oc_rep_new_realloc_v1(&sb.buffer, OC_MIN_APP_DATA_SIZE, OC_MAX_APP_DATA_SIZE);
-#else  /* !OC_APP_DATA_STORAGE_BUFFER */
-  oc_rep_new_v1(sb.buffer, OC_MIN_APP_DATA_SIZE);
-#endif /* OC_APP_DATA_STORAGE_BUFFER */
-
-  /* ael */
-  oc_sec_ael_encode(device, 0, true);
-#ifndef OC_APP_DATA_STORAGE_BUFFER
-  sb.buffer = oc_rep_shrink_encoder_buf(sb.buffer);
-  sb.size = (size_t)oc_rep_get_encoder_buffer_size();
-#endif /* !OC_APP_DATA_STORAGE_BUFFER */
-  int size = oc_rep_get_encoded_payload_size();
-  if (size > 0) {
-    OC_DBG("oc_store: encoded ael size %d", size);
-    char svr_tag[OC_STORAGE_SVR_TAG_MAX];
-    oc_storage_gen_svr_tag(OCF_SEC_AEL_STORE_NAME, device, svr_tag,
-                           sizeof(svr_tag));
-    oc_storage_write(svr_tag, sb.buffer, size);
+  long ret = oc_storage_data_save(OCF_SEC_AEL_STORE_NAME, device,
+                                  store_encode_ael, NULL);
+  if (ret <= 0) {
+    OC_ERR("cannot dump ael to storage: error(%ld)", ret);
   }
-  oc_storage_free_buffer(sb);
 }
 
 static int
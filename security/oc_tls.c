@@ -18,13 +18,16 @@
 
 #ifdef OC_SECURITY
 
+#include "api/client/oc_client_cb_internal.h"
 #include "api/oc_endpoint_internal.h"
 #include "api/oc_events_internal.h"
 #include "api/oc_message_buffer_internal.h"
 #include "api/oc_message_internal.h"
+#include "api/oc_metrics_internal.h"
 #include "api/oc_network_events_internal.h"
 #include "api/oc_session_events_internal.h"
 #include "api/oc_tcp_internal.h"
+#include "api/oc_tracepoint_internal.h"
 #include "messaging/coap/engine_internal.h"
 #include "messaging/coap/observe_internal.h"
 #include "oc_api.h"
@@ -46,7 +49,9 @@
 #include "security/oc_pstat_internal.h"
 #include "security/oc_roles_internal.h"
 #include "security/oc_security_internal.h"
+#include "security/oc_tls_async_internal.h"
 #include "security/oc_tls_internal.h"
+#include "security/oc_tls_session_internal.h"
 #include "util/oc_features.h"
 #include "util/oc_macros_internal.h"
 
@@ -65,6 +70,7 @@
 #include "mbedtls/md.h"
 #include "mbedtls/oid.h"
 #include "mbedtls/pkcs5.h"
+#include "mbedtls/platform.h"
 #include "mbedtls/ssl.h"
 #include "mbedtls/ssl_cookie.h"
 #include "mbedtls/timing.h"
@@ -77,7 +83,6 @@
 #if OC_ERR_IS_ENABLED
 #include "mbedtls/debug.h"
 #include "mbedtls/error.h"
-#include "mbedtls/platform.h"
 #endif /* OC_ERR_IS_ENABLED */
 
 #define OC_TLS_SELECTED_ANY_CRED_ID (-1)
@@ -119,6 +124,49 @@ OC_PROCESS(oc_tls_handler, "TLS Process");
 OC_MEMB(g_tls_peers_s, oc_tls_peer_t, OC_MAX_TLS_PEERS);
 OC_LIST(g_tls_peers);
 
+/* Everything the content of a mbedtls configuration depends on, the key is
+ * zeroed before it is filled so it can be compared by memcmp */
+typedef struct
+{
+  size_t device;
+  int role;
+  int transport_type;
+  const int *ciphers; ///< ciphersuite priority requested by the application
+  oc_uuid_t device_id;
+  oc_dostype_t s;
+  int oxmsel;
+  bool owned;
+#ifdef OC_CLIENT
+  bool pin_obt_psk_identity;
+  bool psk_cred; ///< a PSK credential of the remote device exists
+#endif           /* OC_CLIENT */
+#ifdef OC_PKI
+  int mfg_credid;
+  int id_credid;
+#endif /* OC_PKI */
+#ifdef OC_TLS_LOW_MEMORY
+  unsigned char max_frag_len; ///< maximum fragment length requested by clients
+#endif                        /* OC_TLS_LOW_MEMORY */
+} tls_config_key_t;
+
+struct oc_tls_config_t
+{
+  struct oc_tls_config_t *next;
+  tls_config_key_t key;
+  mbedtls_ssl_config conf;
+  size_t refs; ///< number of peers using the configuration
+  bool stale;  ///< the credentials changed, freed with the last peer
+};
+
+OC_MEMB(g_tls_configs_s, oc_tls_config_t, OC_MAX_TLS_PEERS);
+OC_LIST(g_tls_configs); // least recently used first
+
+#ifdef OC_TLS_SESSION_RESUMPTION
+/* The session cache callbacks of a shared configuration do not receive the SSL
+ * context, the peer is the one running the handshake */
+static oc_tls_peer_t *g_tls_handshake_peer = NULL;
+#endif /* OC_TLS_SESSION_RESUMPTION */
+
 static mbedtls_entropy_context g_entropy_ctx;
 static mbedtls_ctr_drbg_context g_oc_ctr_drbg_ctx;
 static mbedtls_ssl_cookie_ctx g_cookie_ctx;
@@ -340,6 +388,89 @@ is_peer_active(const oc_tls_peer_t *peer)
 }
 
 static oc_event_callback_retval_t oc_dtls_inactive(void *data);
+static oc_event_callback_retval_t tls_retry_schedule_read(void *data);
+#ifdef OC_CLIENT
+static oc_event_callback_retval_t tls_retry_schedule_write(void *data);
+#endif /* OC_CLIENT */
+
+static void
+tls_peer_remove_scheduled_retries(oc_tls_peer_t *peer)
+{
+  oc_ri_remove_timed_event_callback(peer, tls_retry_schedule_read);
+#ifdef OC_CLIENT
+  oc_ri_remove_timed_event_callback(peer, tls_retry_schedule_write);
+#endif /* OC_CLIENT */
+}
+
+static void
+tls_config_free(oc_tls_config_t *config)
+{
+  oc_list_remove(g_tls_configs, config);
+  mbedtls_ssl_config_free(&config->conf);
+  oc_memb_free(&g_tls_configs_s, config);
+}
+
+static void
+tls_config_release(oc_tls_peer_t *peer)
+{
+  oc_tls_config_t *config = peer->config;
+  if (config == NULL) {
+    return;
+  }
+  peer->config = NULL;
+  assert(config->refs > 0);
+  --config->refs;
+  if (config->stale && config->refs == 0) {
+    tls_config_free(config);
+  }
+}
+
+static oc_tls_config_t *
+tls_config_allocate(void)
+{
+  size_t unused = 0;
+  oc_tls_config_t *lru = NULL;
+  for (oc_tls_config_t *config = (oc_tls_config_t *)oc_list_head(g_tls_configs);
+       config != NULL; config = config->next) {
+    if (config->refs == 0) {
+      lru = lru == NULL ? config : lru;
+      ++unused;
+    }
+  }
+  if (unused >= OC_TLS_CONFIG_CACHE_SIZE) {
+    tls_config_free(lru);
+    lru = NULL;
+  }
+  oc_tls_config_t *config = oc_memb_alloc(&g_tls_configs_s);
+  if (config == NULL && lru != NULL) {
+    // the pool is exhausted by the cached configurations
+    tls_config_free(lru);
+    config = oc_memb_alloc(&g_tls_configs_s);
+  }
+  return config;
+}
+
+size_t
+oc_tls_num_configs(void)
+{
+  return (size_t)oc_list_length(g_tls_configs);
+}
+
+void
+oc_tls_invalidate_configs(void)
+{
+  OC_DBG("oc_tls: invalidating shared configurations");
+  oc_tls_config_t *config = (oc_tls_config_t *)oc_list_head(g_tls_configs);
+  while (config != NULL) {
+    oc_tls_config_t *next = config->next;
+    if (config->refs == 0) {
+      tls_config_free(config);
+    } else {
+      config->stale = true;
+    }
+    config = next;
+  }
+}
 
 #ifdef OC_CLIENT
 
@@ -351,6 +482,7 @@ oc_tls_free_invalid_peer(oc_tls_peer_t *peer)
   oc_list_remove(g_tls_peers, peer);
 
   oc_ri_remove_timed_event_callback(peer, oc_dtls_inactive);
+  tls_peer_remove_scheduled_retries(peer);
 
   mbedtls_ssl_free(&peer->ssl_ctx);
   oc_message_t *message = (oc_message_t *)oc_list_pop(peer->send_q);
@@ -371,9 +503,10 @@ oc_tls_free_invalid_peer(oc_tls_peer_t *peer)
     oc_message_unref(peer->processed_recv_message);
   }
 #endif
-  mbedtls_ssl_config_free(&peer->ssl_conf);
+  tls_config_release(peer);
   oc_etimer_stop(&peer->timer.fin_timer);
   oc_memb_free(&g_tls_peers_s, peer);
+  OC_METRICS_DECREMENT(OC_METRIC_TLS_PEERS);
 }
 #endif /* OC_CLIENT */
 
@@ -509,6 +642,7 @@ oc_tls_free_peer(oc_tls_peer_t *peer, bool inactivity_cb, bool from_reset,
   if (!inactivity_cb) {
     oc_ri_remove_timed_event_callback(peer, oc_dtls_inactive);
   }
+  tls_peer_remove_scheduled_retries(peer);
   mbedtls_ssl_free(&peer->ssl_ctx);
   oc_message_t *message = (oc_message_t *)oc_list_pop(peer->send_q);
   while (message != NULL) {
@@ -524,12 +658,20 @@ oc_tls_free_peer(oc_tls_peer_t *peer, bool inactivity_cb, bool from_reset,
 #ifdef OC_PKI
   oc_free_string(&peer->public_key);
 #endif /* OC_PKI */
-  mbedtls_ssl_config_free(&peer->ssl_conf);
+  tls_config_release(peer);
   oc_etimer_stop(&peer->timer.fin_timer);
 
   oc_endpoint_t endpoint;
   oc_endpoint_copy(&endpoint, &peer->endpoint);
+#ifdef OC_CLIENT
+  if (peer->role == MBEDTLS_SSL_IS_CLIENT) {
+    // a selection bound by a request queued after the peer was created is not
+    // used by a new peer
+    oc_tls_release_selection(&endpoint);
+  }
+#endif /* OC_CLIENT */
   oc_memb_free(&g_tls_peers_s, peer);
+  OC_METRICS_DECREMENT(OC_METRIC_TLS_PEERS);
 
 #ifdef OC_SERVER
   /* remove all observations by this peer */
@@ -648,20 +790,47 @@ oc_tls_is_cert_otm_supported(size_t device)
 }
 #endif /* OC_PKI */
 
+/* The event is posted again from a timed callback when the event queue is
+ * full, because the data of the peer are already queued and no other event
+ * would process them */
 static void
 oc_tls_handler_schedule_read(oc_tls_peer_t *peer)
 {
-  oc_process_post(&oc_tls_handler,
-                  oc_event_to_oc_process_event(TLS_READ_DECRYPTED_DATA), peer);
+  if (oc_process_post(&oc_tls_handler,
+                      oc_event_to_oc_process_event(TLS_READ_DECRYPTED_DATA),
+                      peer) == OC_PROCESS_ERR_FULL &&
+      !oc_ri_has_timed_event_callback(peer, tls_retry_schedule_read, false)) {
+    OC_WRN("oc_tls: cannot schedule read for peer(%p), retrying", (void *)peer);
+    oc_ri_add_timed_event_callback_ticks(peer, tls_retry_schedule_read, 0);
+  }
+}
+
+static oc_event_callback_retval_t
+tls_retry_schedule_read(void *data)
+{
+  oc_tls_handler_schedule_read((oc_tls_peer_t *)data);
+  return OC_EVENT_DONE;
 }
 
 #ifdef OC_CLIENT
 static void
 oc_tls_handler_schedule_write(oc_tls_peer_t *peer)
 {
-  oc_process_post(&oc_tls_handler,
-                  oc_event_to_oc_process_event(TLS_WRITE_APPLICATION_DATA),
-                  peer);
+  if (oc_process_post(&oc_tls_handler,
+                      oc_event_to_oc_process_event(TLS_WRITE_APPLICATION_DATA),
+                      peer) == OC_PROCESS_ERR_FULL &&
+      !oc_ri_has_timed_event_callback(peer, tls_retry_schedule_write, false)) {
+    OC_WRN("oc_tls: cannot schedule write for peer(%p), retrying",
+           (void *)peer);
+    oc_ri_add_timed_event_callback_ticks(peer, tls_retry_schedule_write, 0);
+  }
+}
+
+static oc_event_callback_retval_t
+tls_retry_schedule_write(void *data)
+{
+  oc_tls_handler_schedule_write((oc_tls_peer_t *)data);
+  return OC_EVENT_DONE;
 }
 #endif /* OC_CLIENT */
 
@@ -689,6 +858,27 @@ oc_dtls_inactive(void *data)
   return OC_EVENT_DONE;
 }
 
+#ifdef OC_DTLS_CID
+/* Offset of the epoch and sequence number in a DTLS 1.2 record: content type
+ * (1), version (2) */
+#define DTLS_RECORD_SEQ_OFFSET (3)
+
+/* Epoch and sequence number of the first record of the datagram as a single
+ * number, so that records are ordered the same way as by RFC 9146, Section 6 */
+static uint64_t
+tls_record_seq(const oc_message_t *message)
+{
+  if (message->length < DTLS_RECORD_SEQ_OFFSET + sizeof(uint64_t)) {
+    return 0;
+  }
+  uint64_t seq = 0;
+  for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+    seq = (seq << 8) | message->data[DTLS_RECORD_SEQ_OFFSET + i];
+  }
+  return seq;
+}
+#endif /* OC_DTLS_CID */
+
 static int
 ssl_recv(void *ctx, unsigned char *buf, size_t len)
 {
@@ -711,6 +901,10 @@ ssl_recv(void *ctx, unsigned char *buf, size_t len)
     {
       recv_len = (message->length < len) ? message->length : len;
       memcpy(buf, message->data, recv_len);
+#ifdef OC_DTLS_CID
+      memcpy(&peer->recv_endpoint, &message->endpoint, sizeof(oc_endpoint_t));
+      peer->recv_record_seq = tls_record_seq(message);
+#endif /* OC_DTLS_CID */
       oc_list_remove(peer->recv_q, message);
       oc_message_unref(message);
     }
@@ -739,6 +933,36 @@ ssl_send(void *ctx, const unsigned char *buf, size_t len)
   return ret;
 }
 
+static int
+tls_peer_handshake(oc_tls_peer_t *peer,
+                   int (*handshake)(mbedtls_ssl_context *ssl))
+{
+#ifdef OC_TLS_SESSION_RESUMPTION
+  g_tls_handshake_peer = peer;
+#endif /* OC_TLS_SESSION_RESUMPTION */
+  int ret = handshake(&peer->ssl_ctx);
+#ifdef OC_TLS_SESSION_RESUMPTION
+  g_tls_handshake_peer = NULL;
+#endif /* OC_TLS_SESSION_RESUMPTION */
+  return ret;
+}
+
+/* The handshake is blocked on I/O or on the crypto worker, it continues when
+ * the peer is processed again */
+static bool
+tls_handshake_in_progress(int ret)
+{
+  if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+    return true;
+  }
+#ifdef OC_TLS_ASYNC_CRYPTO
+  if (ret == MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS) {
+    return true;
+  }
+#endif /* OC_TLS_ASYNC_CRYPTO */
+  return false;
+}
+
 static void
 check_retry_timers(void)
 {
@@ -750,7 +974,7 @@ check_retry_timers(void)
       continue;
     }
     oc_tls_peer_t *next = peer->next;
-    int ret = mbedtls_ssl_handshake(&peer->ssl_ctx);
+    int ret = tls_peer_handshake(peer, mbedtls_ssl_handshake);
     if (ret == MBEDTLS_ERR_SSL_HELLO_VERIFY_REQUIRED) {
       mbedtls_ssl_session_reset(&peer->ssl_ctx);
       if (peer->role == MBEDTLS_SSL_IS_SERVER &&
@@ -763,9 +987,9 @@ check_retry_timers(void)
         continue;
       }
     }
-    if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ &&
-        ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+    if (ret < 0 && !tls_handshake_in_progress(ret)) {
       TLS_LOG_MBEDTLS_ERROR("mbedtls_ssl_handshake", ret);
+      OC_METRICS_INCREMENT(OC_METRIC_TLS_HANDSHAKE_FAILURES);
       oc_tls_free_peer(peer, false, false, true);
     }
     peer = next;
@@ -829,12 +1053,9 @@ oc_tls_audit_log(const char *aeid, const char *message, uint8_t category,
                category, priority, (const char **)aux, 1);
 }
 
-static int
-get_psk_cb(void *data, mbedtls_ssl_context *ssl, const unsigned char *identity,
-           size_t identity_len)
+static oc_tls_peer_t *
+tls_peer_by_ssl(const mbedtls_ssl_context *ssl)
 {
-  (void)data;
-  OC_DBG("oc_tls: In PSK callback");
   oc_tls_peer_t *peer = oc_list_head(g_tls_peers);
   while (peer != NULL) {
     if (&peer->ssl_ctx == ssl) {
@@ -842,6 +1063,16 @@ get_psk_cb(void *data, mbedtls_ssl_context *ssl, const unsigned char *identity,
     }
     peer = peer->next;
   }
+  return peer;
+}
+
+static int
+get_psk_cb(void *data, mbedtls_ssl_context *ssl, const unsigned char *identity,
+           size_t identity_len)
+{
+  (void)data;
+  OC_DBG("oc_tls: In PSK callback");
+  oc_tls_peer_t *peer = tls_peer_by_ssl(ssl);
   if (peer == NULL) {
     OC_ERR("oc_tls: could not peer");
     oc_tls_audit_log("AUTH-1",
@@ -1109,6 +1340,7 @@ add_new_identity_cert(oc_sec_cred_t *cred, size_t device)
 #endif /* OC_DBG_IS_ENABLED */
 
   oc_list_add(g_identity_certs, cert);
+  oc_tls_invalidate_configs();
 
   return;
 
@@ -1156,6 +1388,7 @@ oc_tls_remove_identity_cert(const oc_sec_cred_t *cred)
   }
   OC_DBG("identity cert for credential(credid=%d) removed", cred->credid);
   oc_list_remove(g_identity_certs, cert);
+  oc_tls_invalidate_configs();
   mbedtls_x509_crt_free(&cert->cert);
   mbedtls_pk_free(&cert->pk);
   oc_memb_free(&g_identity_certs_s, cert);
@@ -1236,6 +1469,7 @@ oc_tls_remove_trust_anchor(const oc_sec_cred_t *cred)
   mbedtls_x509_crt_free(&g_trust_anchors);
   mbedtls_x509_crt_init(&g_trust_anchors);
   OC_DBG("trust anchor chain cleared");
+  oc_tls_invalidate_configs();
   return oc_tls_reload_trust_anchors() == 0;
 }
 
@@ -1566,6 +1800,7 @@ add_new_trust_anchor(oc_sec_cred_t *cred, size_t device)
 
   oc_list_add(g_ca_certs, cert);
   OC_DBG("appended new trust anchor to ca certs");
+  oc_tls_invalidate_configs();
 }
 
 void
@@ -1644,87 +1879,88 @@ get_identity_cert_for_session(const mbedtls_ssl_config *conf)
   return NULL;
 }
 
-bool
-oc_tls_load_cert_chain(mbedtls_ssl_config *conf, size_t device, bool owned)
+static bool
+tls_load_cert_chain(mbedtls_ssl_config *conf, size_t device, bool owned,
+                    int mfg_credid, int id_credid)
 {
   /* Decide between configuring the identity cert chain vs manufacturer cert
    * chain for this device based on device ownership status.
    */
-  return (owned && oc_tls_load_identity_cert_chain(conf, device,
-                                                   g_selected_id_cred) == 0) ||
-         (oc_tls_load_mfg_cert_chain(conf, device, g_selected_mfg_cred) == 0);
+  return (owned &&
+          oc_tls_load_identity_cert_chain(conf, device, id_credid) == 0) ||
+         (oc_tls_load_mfg_cert_chain(conf, device, mfg_credid) == 0);
+}
+
+bool
+oc_tls_load_cert_chain(mbedtls_ssl_config *conf, size_t device, bool owned)
+{
+  return tls_load_cert_chain(conf, device, owned, g_selected_mfg_cred,
+                             g_selected_id_cred);
 }
 
 #endif /* OC_PKI */
 
 static void
-oc_tls_set_ciphersuites(mbedtls_ssl_config *conf, const oc_endpoint_t *endpoint)
+oc_tls_set_ciphersuites(mbedtls_ssl_config *conf, const tls_config_key_t *key)
 {
 #ifdef OC_PKI
   mbedtls_ssl_conf_ca_chain(conf, &g_trust_anchors, NULL);
 #ifdef OC_CLIENT
   bool loaded_chain = false;
 #endif /* OC_CLIENT */
-  const oc_sec_doxm_t *doxm = oc_sec_get_doxm(endpoint->device);
-  if (oc_tls_load_cert_chain(conf, endpoint->device, doxm->owned)) {
+  if (tls_load_cert_chain(conf, key->device, key->owned, key->mfg_credid,
+                          key->id_credid)) {
 #ifdef OC_CLIENT
     loaded_chain = true;
 #endif /* OC_CLIENT */
   }
-  g_selected_mfg_cred = OC_TLS_SELECTED_ANY_CRED_ID;
-  g_selected_id_cred = OC_TLS_SELECTED_ANY_CRED_ID;
 #endif /* OC_PKI */
-  const oc_sec_pstat_t *ps = oc_sec_get_pstat(endpoint->device);
-  if (conf->endpoint == MBEDTLS_SSL_IS_SERVER && ps->s == OC_DOS_RFOTM) {
+  const int *ciphers = key->ciphers;
+  if (key->role == MBEDTLS_SSL_IS_SERVER && key->s == OC_DOS_RFOTM) {
     OC_DBG(
       "oc_tls_set_ciphersuites: server selecting OTM ciphersuite priority");
-    const oc_sec_doxm_t *d = oc_sec_get_doxm(endpoint->device);
-    switch (d->oxmsel) {
+    switch (key->oxmsel) {
     case OC_OXMTYPE_JW:
       OC_DBG("oc_tls: selected JW OTM priority");
-      g_ciphers = jw_otm_priority;
+      ciphers = jw_otm_priority;
       break;
     case OC_OXMTYPE_RDP:
       OC_DBG("oc_tls: selected PIN OTM priority");
-      g_ciphers = pin_otm_priority;
+      ciphers = pin_otm_priority;
       break;
 #ifdef OC_PKI
     case OC_OXMTYPE_MFG_CERT:
       OC_DBG("oc_tls: selected cert OTM priority");
-      g_ciphers = cert_otm_priority;
+      ciphers = cert_otm_priority;
       break;
 #endif /* OC_PKI */
     default:
       OC_DBG("oc_tls: selected default OTM priority");
-      g_ciphers = default_priority;
+      ciphers = default_priority;
       break;
     }
-  } else if (!g_ciphers) {
+  } else if (!ciphers) {
     OC_DBG("oc_tls_set_ciphersuites: server selecting default ciphersuite "
            "priority");
-    g_ciphers = default_priority;
+    ciphers = default_priority;
 #ifdef OC_CLIENT
-    if (conf->endpoint == MBEDTLS_SSL_IS_CLIENT) {
-      const oc_sec_cred_t *cred =
-        oc_sec_find_creds_for_subject(NULL, &endpoint->di, endpoint->device);
-      if (cred && cred->credtype == OC_CREDTYPE_PSK) {
+    if (key->role == MBEDTLS_SSL_IS_CLIENT) {
+      if (key->psk_cred) {
         OC_DBG("oc_tls_set_ciphersuites: client selecting PSK ciphersuite "
                "priority");
-        g_ciphers = psk_priority;
+        ciphers = psk_priority;
       }
 #ifdef OC_PKI
       else if (loaded_chain) {
         OC_DBG("oc_tls_set_ciphersuites: client selecting cert ciphersuite "
                "priority");
-        g_ciphers = cert_priority;
+        ciphers = cert_priority;
       }
 #endif /* OC_PKI */
     }
 #endif /* OC_CLIENT */
   }
-  mbedtls_ssl_conf_ciphersuites(conf, g_ciphers);
-  g_ciphers = NULL;
-  OC_DBG("oc_tls: resetting ciphersuite selection for next handshakes");
+  mbedtls_ssl_conf_ciphersuites(conf, ciphers);
 }
 
 #ifdef OC_CLIENT
@@ -1741,6 +1977,104 @@ oc_tls_select_anon_ciphersuite(void)
   OC_DBG("oc_tls: client requesting anon ECDH ciphersuite priority");
   g_ciphers = anon_ecdh_priority;
 }
+
+/* Handshake parameters selected for a client peer that is not created yet */
+typedef struct tls_peer_selection_t
+{
+  struct tls_peer_selection_t *next;
+  oc_endpoint_t endpoint;
+  const int *ciphers;
+  bool pin_obt_psk_identity;
+#ifdef OC_PKI
+  int mfg_credid;
+  int id_credid;
+#endif /* OC_PKI */
+} tls_peer_selection_t;
+
+OC_MEMB(g_peer_selections_s, tls_peer_selection_t, OC_MAX_TLS_PEERS);
+OC_LIST(g_peer_selections);
+
+static bool
+tls_has_selection(void)
+{
+#ifdef OC_PKI
+  if (g_selected_mfg_cred != OC_TLS_SELECTED_ANY_CRED_ID ||
+      g_selected_id_cred != OC_TLS_SELECTED_ANY_CRED_ID) {
+    return true;
+  }
+#endif /* OC_PKI */
+  return g_ciphers != NULL || use_pin_obt_psk_identity;
+}
+
+static tls_peer_selection_t *
+tls_find_selection(const oc_endpoint_t *endpoint)
+{
+  tls_peer_selection_t *sel =
+    (tls_peer_selection_t *)oc_list_head(g_peer_selections);
+  while (sel != NULL && oc_endpoint_compare(&sel->endpoint, endpoint) != 0) {
+    sel = sel->next;
+  }
+  return sel;
+}
+
+void
+oc_tls_bind_selection(const oc_endpoint_t *endpoint)
+{
+  if (!tls_has_selection() || oc_tls_get_peer(endpoint) != NULL) {
+    return;
+  }
+  tls_peer_selection_t *sel = tls_find_selection(endpoint);
+  if (sel == NULL) {
+    sel = (tls_peer_selection_t *)oc_memb_alloc(&g_peer_selections_s);
+    if (sel == NULL) {
+      OC_WRN("oc_tls: cannot bind ciphersuite selection, using the global one");
+      return;
+    }
+    memcpy(&sel->endpoint, endpoint, sizeof(oc_endpoint_t));
+    sel->endpoint.next = NULL;
+    oc_list_add(g_peer_selections, sel);
+  }
+  OC_DBG("oc_tls: binding ciphersuite selection to the endpoint");
+  sel->ciphers = g_ciphers;
+  sel->pin_obt_psk_identity = use_pin_obt_psk_identity;
+  g_ciphers = NULL;
+  use_pin_obt_psk_identity = false;
+#ifdef OC_PKI
+  sel->mfg_credid = g_selected_mfg_cred;
+  sel->id_credid = g_selected_id_cred;
+  g_selected_mfg_cred = OC_TLS_SELECTED_ANY_CRED_ID;
+  g_selected_id_cred = OC_TLS_SELECTED_ANY_CRED_ID;
+#endif /* OC_PKI */
+}
+
+void
+oc_tls_release_selection(const oc_endpoint_t *endpoint)
+{
+  tls_peer_selection_t *sel = tls_find_selection(endpoint);
+  if (sel == NULL) {
+    return;
+  }
+  OC_DBG("oc_tls: releasing ciphersuite selection bound to the endpoint");
+  oc_list_remove(g_peer_selections, sel);
+  oc_memb_free(&g_peer_selections_s, sel);
+}
+
+size_t
+oc_tls_num_selections(void)
+{
+  return (size_t)oc_list_length(g_peer_selections);
+}
+
+static void
+tls_free_selections(void)
+{
+  tls_peer_selection_t *sel =
+    (tls_peer_selection_t *)oc_list_pop(g_peer_selections);
+  while (sel != NULL) {
+    oc_memb_free(&g_peer_selections_s, sel);
+    sel = (tls_peer_selection_t *)oc_list_pop(g_peer_selections);
+  }
+}
 #endif /* OC_CLIENT */
 
 #ifdef OC_PKI
@@ -1800,7 +2134,7 @@ verify_manufacturer_or_identity_certificate(oc_tls_peer_t *peer,
      * as context accompanying the identity certificate. This is queried
      * after validating the end-entity certificate to authorize the
      * the peer per the OCF Specification. */
-    oc_x509_crt_t *id_cert = get_identity_cert_for_session(&peer->ssl_conf);
+    oc_x509_crt_t *id_cert = get_identity_cert_for_session(&peer->config->conf);
     const oc_sec_pstat_t *ps = oc_sec_get_pstat(peer->endpoint.device);
     if (oc_certs_validate_non_end_entity_cert(crt, true, ps->s == OC_DOS_RFOTM,
                                               depth, flags) < 0) {
@@ -1831,7 +2165,7 @@ verify_manufacturer_or_identity_certificate(oc_tls_peer_t *peer,
 
   if (depth == 0) {
     const oc_x509_crt_t *id_cert =
-      get_identity_cert_for_session(&peer->ssl_conf);
+      get_identity_cert_for_session(&peer->config->conf);
 
     /* Parse the peer's subjectuuid from its end-entity certificate */
     char uuid[OC_UUID_LEN] = { 0 };
@@ -1943,21 +2277,118 @@ verify_cloud_certificate(oc_tls_peer_t *peer, const mbedtls_x509_crt *crt,
 #endif /* OC_CLOUD && OC_CLIENT */
 #endif /* OC_PKI */
 
+#ifdef OC_TLS_LOW_MEMORY
+static unsigned char
+tls_max_frag_len(int role, int transport_type)
+{
+  if (role != MBEDTLS_SSL_IS_CLIENT) {
+    // the maximum fragment length is negotiated by the client
+    return MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+  }
+  // a stream is split into records, but a datagram must fit into one record
+  long len = transport_type == MBEDTLS_SSL_TRANSPORT_STREAM ? 512
+                                                            : (long)OC_PDU_SIZE;
+  if (len <= 512) {
+    return MBEDTLS_SSL_MAX_FRAG_LEN_512;
+  }
+  if (len <= 1024) {
+    return MBEDTLS_SSL_MAX_FRAG_LEN_1024;
+  }
+  if (len <= 2048) {
+    return MBEDTLS_SSL_MAX_FRAG_LEN_2048;
+  }
+  if (len <= 4096) {
+    return MBEDTLS_SSL_MAX_FRAG_LEN_4096;
+  }
+  return MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+}
+#endif /* OC_TLS_LOW_MEMORY */
+
+static void
+tls_config_key_init(tls_config_key_t *key, const oc_tls_peer_t *peer)
+{
+  memset(key, 0, sizeof(tls_config_key_t));
+  size_t device = peer->endpoint.device;
+  key->device = device;
+  key->role = peer->role;
+  key->transport_type = (peer->endpoint.flags & TCP) != 0
+                          ? MBEDTLS_SSL_TRANSPORT_STREAM
+                          : MBEDTLS_SSL_TRANSPORT_DATAGRAM;
+#ifdef OC_CLIENT
+  tls_peer_selection_t *sel = peer->role == MBEDTLS_SSL_IS_CLIENT
+                                ? tls_find_selection(&peer->endpoint)
+                                : NULL;
+  if (sel != NULL) {
+    // use the selection bound to the endpoint, the global selection may
+    // belong to another peer
+    oc_list_remove(g_peer_selections, sel);
+    key->ciphers = sel->ciphers;
+  } else
+#endif /* OC_CLIENT */
+  {
+    key->ciphers = g_ciphers;
+    g_ciphers = NULL;
+    OC_DBG("oc_tls: resetting ciphersuite selection for next handshakes");
+  }
+  memcpy(&key->device_id, oc_core_get_device_id(device), sizeof(oc_uuid_t));
+  const oc_sec_pstat_t *ps = oc_sec_get_pstat(device);
+  key->s = ps->s;
+  const oc_sec_doxm_t *doxm = oc_sec_get_doxm(device);
+  key->oxmsel = doxm->oxmsel;
+  key->owned = doxm->owned;
+#ifdef OC_CLIENT
+  if (peer->role == MBEDTLS_SSL_IS_CLIENT) {
+    if (sel != NULL) {
+      key->pin_obt_psk_identity = sel->pin_obt_psk_identity;
+    } else {
+      key->pin_obt_psk_identity = use_pin_obt_psk_identity;
+      use_pin_obt_psk_identity = false;
+    }
+    if (key->ciphers == NULL) {
+      const oc_sec_cred_t *cred =
+        oc_sec_find_creds_for_subject(NULL, &peer->endpoint.di, device);
+      key->psk_cred = cred != NULL && cred->credtype == OC_CREDTYPE_PSK;
+    }
+  }
+#endif /* OC_CLIENT */
+#ifdef OC_PKI
+#ifdef OC_CLIENT
+  if (sel != NULL) {
+    key->mfg_credid = sel->mfg_credid;
+    key->id_credid = sel->id_credid;
+  } else
+#endif /* OC_CLIENT */
+  {
+    key->mfg_credid = g_selected_mfg_cred;
+    key->id_credid = g_selected_id_cred;
+    g_selected_mfg_cred = OC_TLS_SELECTED_ANY_CRED_ID;
+    g_selected_id_cred = OC_TLS_SELECTED_ANY_CRED_ID;
+  }
+#endif /* OC_PKI */
+#ifdef OC_CLIENT
+  if (sel != NULL) {
+    oc_memb_free(&g_peer_selections_s, sel);
+  }
+#endif /* OC_CLIENT */
+#ifdef OC_TLS_LOW_MEMORY
+  key->max_frag_len = tls_max_frag_len(key->role, key->transport_type);
+#endif /* OC_TLS_LOW_MEMORY */
+}
+
 static int
-oc_tls_populate_ssl_config(mbedtls_ssl_config *conf, size_t device, int role,
-                           int transport_type)
+oc_tls_populate_ssl_config(mbedtls_ssl_config *conf,
+                           const tls_config_key_t *key)
 {
   mbedtls_ssl_config_init(conf);
 
-  if (mbedtls_ssl_config_defaults(conf, role, transport_type,
+  if (mbedtls_ssl_config_defaults(conf, key->role, key->transport_type,
                                   MBEDTLS_SSL_PRESET_DEFAULT) != 0) {
     return -1;
   }
 
-  const oc_uuid_t *device_id = oc_core_get_device_id(device);
+  const oc_uuid_t *device_id = &key->device_id;
 #ifdef OC_CLIENT
-  if (role == MBEDTLS_SSL_IS_CLIENT && use_pin_obt_psk_identity) {
-    use_pin_obt_psk_identity = false;
+  if (key->pin_obt_psk_identity) {
     if (mbedtls_ssl_conf_psk(conf, device_id->id, 1,
                              (const unsigned char *)OC_OXMTYPE_RDP_STR,
                              OC_CHAR_ARRAY_LEN(OC_OXMTYPE_RDP_STR)) != 0) {
@@ -1968,9 +2399,7 @@ oc_tls_populate_ssl_config(mbedtls_ssl_config *conf, size_t device, int role,
   {
     unsigned char identity_hint[33];
     size_t identity_hint_len = 33;
-    const oc_sec_doxm_t *doxm = oc_sec_get_doxm(device);
-    const oc_sec_pstat_t *pstat = oc_sec_get_pstat(device);
-    if (pstat->s == OC_DOS_RFOTM && doxm->oxmsel == OC_OXMTYPE_RDP) {
+    if (key->s == OC_DOS_RFOTM && key->oxmsel == OC_OXMTYPE_RDP) {
       memcpy(identity_hint, "oic.sec.doxm.rdp:", 17);
       memcpy(identity_hint + 17, device_id->id, 16);
       identity_hint_len = 33;
@@ -1993,15 +2422,31 @@ oc_tls_populate_ssl_config(mbedtls_ssl_config *conf, size_t device, int role,
   mbedtls_ssl_conf_min_version(conf, MBEDTLS_SSL_MAJOR_VERSION_3,
                                MBEDTLS_SSL_MINOR_VERSION_3);
 #endif /* MBEDTLS_VERSION_NUMBER <= 0x03010000 */
-  const oc_sec_pstat_t *ps = oc_sec_get_pstat(device);
-  if ((ps->s > OC_DOS_RFOTM) || (role != MBEDTLS_SSL_IS_SERVER)) {
+  if ((key->s > OC_DOS_RFOTM) || (key->role != MBEDTLS_SSL_IS_SERVER)) {
     mbedtls_ssl_conf_authmode(conf, MBEDTLS_SSL_VERIFY_REQUIRED);
   }
   mbedtls_ssl_conf_psk_cb(conf, get_psk_cb, NULL);
-  if (transport_type == MBEDTLS_SSL_TRANSPORT_DATAGRAM) {
+#ifdef OC_TLS_LOW_MEMORY
+  // with MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH the record buffers shrink to the
+  // negotiated length after the handshake
+  if (key->max_frag_len != MBEDTLS_SSL_MAX_FRAG_LEN_NONE &&
+      mbedtls_ssl_conf_max_frag_len(conf, key->max_frag_len) != 0) {
+    return -1;
+  }
+#endif /* OC_TLS_LOW_MEMORY */
+  if (key->transport_type == MBEDTLS_SSL_TRANSPORT_DATAGRAM) {
     mbedtls_ssl_conf_dtls_cookies(conf, mbedtls_ssl_cookie_write,
                                   mbedtls_ssl_cookie_check, &g_cookie_ctx);
     mbedtls_ssl_conf_handshake_timeout(conf, 1000, 20000);
+#ifdef OC_DTLS_CID
+    // the address of the server does not change, a client only signals the
+    // support by an empty connection ID
+    size_t cid_len = key->role == MBEDTLS_SSL_IS_SERVER ? OC_DTLS_CID_LEN : 0;
+    if (mbedtls_ssl_conf_cid(conf, cid_len,
+                             MBEDTLS_SSL_UNEXPECTED_CID_IGNORE) != 0) {
+      return -1;
+    }
+#endif /* OC_DTLS_CID */
   }
 
   return 0;
@@ -2021,6 +2466,50 @@ oc_tls_num_peers(size_t device)
   return num_peers;
 }
 
+size_t
+oc_tls_peer_memory_usage(const oc_tls_peer_t *peer,
+                         oc_tls_peer_memory_t *report)
+{
+  oc_tls_peer_memory_t r;
+  memset(&r, 0, sizeof(oc_tls_peer_memory_t));
+  r.peer = sizeof(oc_tls_peer_t);
+  const mbedtls_ssl_context *ssl = &peer->ssl_ctx;
+#ifdef MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+  r.buffers = ssl->in_buf_len + ssl->out_buf_len;
+#else  /* !MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+  r.buffers = (ssl->in_buf != NULL ? MBEDTLS_SSL_IN_CONTENT_LEN : 0) +
+              (ssl->out_buf != NULL ? MBEDTLS_SSL_OUT_CONTENT_LEN : 0);
+#endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
+  if (ssl->session != NULL) {
+    r.session = sizeof(mbedtls_ssl_session);
+#if defined(MBEDTLS_X509_CRT_PARSE_C) &&                                       \
+  defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+    for (const mbedtls_x509_crt *crt = ssl->session->peer_cert; crt != NULL;
+         crt = crt->next) {
+      r.peer_cert += sizeof(mbedtls_x509_crt) + crt->raw.len;
+    }
+#endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_SSL_KEEP_PEER_CERTIFICATE */
+  }
+  r.handshake = ssl->handshake != NULL;
+  if (report != NULL) {
+    *report = r;
+  }
+  return r.peer + r.buffers + r.session + r.peer_cert;
+}
+
+size_t
+oc_tls_peers_memory_usage(size_t device)
+{
+  size_t usage = 0;
+  for (const oc_tls_peer_t *peer = (oc_tls_peer_t *)oc_list_head(g_tls_peers);
+       peer != NULL; peer = peer->next) {
+    if (peer->endpoint.device == device) {
+      usage += oc_tls_peer_memory_usage(peer, NULL);
+    }
+  }
+  return usage;
+}
+
 static oc_tls_peer_t *
 oc_tls_peer_allocate(const oc_endpoint_t *endpoint, int role, bool doc)
 {
@@ -2030,6 +2519,7 @@ oc_tls_peer_allocate(const oc_endpoint_t *endpoint, int role, bool doc)
     return NULL;
   }
   OC_DBG("oc_tls: allocated new peer(%p)", (void *)peer);
+  OC_METRICS_INCREMENT(OC_METRIC_TLS_PEERS);
   memcpy(&peer->endpoint, endpoint, sizeof(oc_endpoint_t));
   OC_LIST_STRUCT_INIT(peer, recv_q);
   OC_LIST_STRUCT_INIT(peer, send_q);
@@ -2037,13 +2527,397 @@ oc_tls_peer_allocate(const oc_endpoint_t *endpoint, int role, bool doc)
   peer->doc = doc;
   assert(role == MBEDTLS_SSL_IS_CLIENT || role == MBEDTLS_SSL_IS_SERVER);
   peer->role = role;
+  peer->config = NULL;
   memset(&peer->timer, 0, sizeof(oc_tls_retry_timer_t));
 #ifdef OC_TCP
   peer->processed_recv_message = NULL;
 #endif /* OC_TCP */
+#ifdef OC_DTLS_CID
+  memset(&peer->recv_endpoint, 0, sizeof(peer->recv_endpoint));
+  peer->recv_record_seq = 0;
+  peer->max_record_seq = 0;
+  memset(peer->prev_endpoints, 0, sizeof(peer->prev_endpoints));
+#endif /* OC_DTLS_CID */
   return peer;
 }
 
+#ifdef OC_TLS_SESSION_RESUMPTION
+static bool
+tls_session_is_resumable(const oc_tls_peer_t *peer)
+{
+  // sessions established before or during the ownership transfer are bound to
+  // credentials replaced by the onboarding
+  const oc_sec_pstat_t *ps = oc_sec_get_pstat(peer->endpoint.device);
+  return ps->s != OC_DOS_RFOTM && ps->s != OC_DOS_RESET;
+}
+
+#ifdef OC_PKI
+static void
+tls_session_copy_bytes(oc_string_t *dst, const oc_string_t *src)
+{
+  oc_free_string(dst);
+  if (src->size == 0) {
+    return;
+  }
+  oc_alloc_string(dst, src->size);
+  if (oc_string(*dst) != NULL) {
+    memcpy(oc_cast(*dst, uint8_t), oc_cast(*src, uint8_t), src->size);
+  }
+}
+#endif /* OC_PKI */
+
+static bool
+tls_session_store(const oc_tls_peer_t *peer, oc_tls_session_t *s,
+                  const mbedtls_ssl_session *session)
+{
+  size_t len = 0;
+  int ret = mbedtls_ssl_session_save(session, NULL, 0, &len);
+  if (ret != MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL || len == 0) {
+    MBEDTLS_ERR("mbedtls_ssl_session_save", ret);
+    return false;
+  }
+  oc_alloc_string(&s->data, len);
+  if (oc_string(s->data) == NULL) {
+    OC_ERR("oc_tls: cannot allocate session data");
+    return false;
+  }
+  ret = mbedtls_ssl_session_save(session, oc_cast(s->data, unsigned char), len,
+                                 &len);
+  if (ret != 0) {
+    MBEDTLS_ERR("mbedtls_ssl_session_save", ret);
+    return false;
+  }
+  memcpy(&s->uuid, &peer->uuid, sizeof(oc_uuid_t));
+#ifdef OC_PKI
+  tls_session_copy_bytes(&s->public_key, &peer->public_key);
+#endif /* OC_PKI */
+  return true;
+}
+
+static int
+tls_session_load(oc_tls_peer_t *peer, const oc_tls_session_t *s,
+                 mbedtls_ssl_session *session)
+{
+  int ret = mbedtls_ssl_session_load(
+    session, oc_cast(s->data, const unsigned char), s->data.size);
+  if (ret != 0) {
+    MBEDTLS_ERR("mbedtls_ssl_session_load", ret);
+    return ret;
+  }
+  // the abbreviated handshake skips the PSK and certificate callbacks, a full
+  // handshake overwrites the restored identity
+  memcpy(&peer->uuid, &s->uuid, sizeof(oc_uuid_t));
+#ifdef OC_PKI
+  tls_session_copy_bytes(&peer->public_key, &s->public_key);
+#endif /* OC_PKI */
+  return 0;
+}
+
+static int
+tls_session_cache_get(void *data, const unsigned char *session_id,
+                      size_t session_id_len, mbedtls_ssl_session *session)
+{
+  (void)data;
+  oc_tls_peer_t *peer = g_tls_handshake_peer;
+  if (peer == NULL || !tls_session_is_resumable(peer)) {
+    return -1;
+  }
+  oc_tls_session_t *s = oc_tls_session_cache_find_server(
+    peer->endpoint.device, session_id, session_id_len);
+  if (s == NULL) {
+    return -1;
+  }
+  if (tls_session_load(peer, s, session) != 0) {
+    oc_tls_session_cache_remove(s);
+    return -1;
+  }
+  OC_DBG("oc_tls: resuming session of peer(%p)", (void *)peer);
+  return 0;
+}
+
+static int
+tls_session_cache_set(void *data, const unsigned char *session_id,
+                      size_t session_id_len, const mbedtls_ssl_session *session)
+{
+  (void)data;
+  const oc_tls_peer_t *peer = g_tls_handshake_peer;
+  if (peer == NULL || !tls_session_is_resumable(peer)) {
+    return -1;
+  }
+  oc_tls_session_t *s = oc_tls_session_cache_add(&peer->endpoint, false,
+                                                 session_id, session_id_len);
+  if (s == NULL) {
+    return -1;
+  }
+  if (!tls_session_store(peer, s, session)) {
+    oc_tls_session_cache_remove(s);
+    return -1;
+  }
+  return 0;
+}
+
+#ifdef OC_CLIENT
+static void
+tls_client_session_resume(oc_tls_peer_t *peer)
+{
+  if (!tls_session_is_resumable(peer)) {
+    return;
+  }
+  oc_tls_session_t *s = oc_tls_session_cache_find_client(&peer->endpoint);
+  if (s == NULL) {
+    return;
+  }
+  mbedtls_ssl_session session;
+  mbedtls_ssl_session_init(&session);
+  if (tls_session_load(peer, s, &session) != 0 ||
+      mbedtls_ssl_set_session(&peer->ssl_ctx, &session) != 0) {
+    oc_tls_session_cache_remove(s);
+  }
+  mbedtls_ssl_session_free(&session);
+}
+
+static void
+tls_client_session_save(const oc_tls_peer_t *peer)
+{
+  if (!tls_session_is_resumable(peer)) {
+    return;
+  }
+  mbedtls_ssl_session session;
+  mbedtls_ssl_session_init(&session);
+  int ret = mbedtls_ssl_get_session(&peer->ssl_ctx, &session);
+  if (ret != 0) {
+    MBEDTLS_ERR("mbedtls_ssl_get_session", ret);
+  } else if (mbedtls_ssl_session_get_id_len(&session) > 0) {
+    // the server issued a session id, so the session can be resumed
+    oc_tls_session_t *s =
+      oc_tls_session_cache_add(&peer->endpoint, true, NULL, 0);
+    if (s != NULL && !tls_session_store(peer, s, &session)) {
+      oc_tls_session_cache_remove(s);
+    }
+  }
+  mbedtls_ssl_session_free(&session);
+}
+#endif /* OC_CLIENT */
+#endif /* OC_TLS_SESSION_RESUMPTION */
+
+#if defined(OC_TLS_ASYNC_CRYPTO) && defined(OC_PKI)
+static const mbedtls_pk_context *
+tls_identity_cert_key(const mbedtls_x509_crt *cert)
+{
+  for (const oc_x509_crt_t *crt =
+         (oc_x509_crt_t *)oc_list_head(g_identity_certs);
+       crt != NULL; crt = crt->next) {
+    if (&crt->cert == cert) {
+      return &crt->pk;
+    }
+  }
+  return NULL;
+}
+
+static int
+tls_async_sign_start(mbedtls_ssl_context *ssl, mbedtls_x509_crt *cert,
+                     mbedtls_md_type_t md_alg, const unsigned char *hash,
+                     size_t hash_len)
+{
+  const mbedtls_pk_context *pk = tls_identity_cert_key(cert);
+  oc_tls_peer_t *peer = tls_peer_by_ssl(ssl);
+  if (pk == NULL || peer == NULL) {
+    return MBEDTLS_ERR_SSL_HW_ACCEL_FALLTHROUGH;
+  }
+  oc_tls_async_job_t *job =
+    oc_tls_async_sign(pk, md_alg, hash, hash_len, peer);
+  if (job == NULL) {
+    // the pool is full, sign on the stack thread
+    OC_DBG("oc_tls: signing synchronously");
+    return MBEDTLS_ERR_SSL_HW_ACCEL_FALLTHROUGH;
+  }
+  mbedtls_ssl_set_async_operation_data(ssl, job);
+  return MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS;
+}
+
+static int
+tls_async_resume(mbedtls_ssl_context *ssl, unsigned char *output,
+                 size_t *output_len, size_t output_size)
+{
+  oc_tls_async_job_t *job =
+    (oc_tls_async_job_t *)mbedtls_ssl_get_async_operation_data(ssl);
+  int ret = oc_tls_async_result(job, output, output_len, output_size);
+  if (ret != MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS) {
+    mbedtls_ssl_set_async_operation_data(ssl, NULL);
+  }
+  return ret;
+}
+
+static void
+tls_async_cancel(mbedtls_ssl_context *ssl)
+{
+  oc_tls_async_job_t *job =
+    (oc_tls_async_job_t *)mbedtls_ssl_get_async_operation_data(ssl);
+  if (job != NULL) {
+    oc_tls_async_cancel(job);
+    mbedtls_ssl_set_async_operation_data(ssl, NULL);
+  }
+}
+
+static void
+tls_async_done(void *data)
+{
+  oc_tls_peer_t *peer = (oc_tls_peer_t *)data;
+  if (is_peer_active(peer)) {
+    // continue the handshake with the finished signature
+    oc_tls_handler_schedule_read(peer);
+  }
+}
+#endif /* OC_TLS_ASYNC_CRYPTO && OC_PKI */
+
+#ifdef OC_DTLS_CID
+static bool
+tls_cid_is_used(const oc_tls_peer_t *self)
+{
+  for (const oc_tls_peer_t *peer = (oc_tls_peer_t *)oc_list_head(g_tls_peers);
+       peer != NULL; peer = peer->next) {
+    if (peer != self && peer->role == MBEDTLS_SSL_IS_SERVER &&
+        memcmp(peer->cid, self->cid, OC_DTLS_CID_LEN) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static int
+tls_peer_set_cid(oc_tls_peer_t *peer)
+{
+  if (peer->role != MBEDTLS_SSL_IS_SERVER) {
+    return mbedtls_ssl_set_cid(&peer->ssl_ctx, MBEDTLS_SSL_CID_ENABLED, NULL,
+                               0);
+  }
+  // the connection ID identifies the server peer of a client that changed its
+  // address, so it must be unique
+  do {
+    int ret = mbedtls_ctr_drbg_random(&g_oc_ctr_drbg_ctx, peer->cid,
+                                      OC_DTLS_CID_LEN);
+    if (ret != 0) {
+      MBEDTLS_ERR("mbedtls_ctr_drbg_random", ret);
+      return ret;
+    }
+  } while (tls_cid_is_used(peer));
+  return mbedtls_ssl_set_cid(&peer->ssl_ctx, MBEDTLS_SSL_CID_ENABLED,
+                             peer->cid, OC_DTLS_CID_LEN);
+}
+
+/* Offset of the connection ID in a DTLS 1.2 record with a connection ID
+ * (RFC 9146): content type (1), version (2), epoch (2), sequence number (6) */
+#define DTLS_CID_RECORD_CID_OFFSET (11)
+
+oc_tls_peer_t *
+oc_tls_get_peer_by_cid(const oc_message_t *message)
+{
+  if ((message->endpoint.flags & TCP) != 0 ||
+      message->length < DTLS_CID_RECORD_CID_OFFSET + OC_DTLS_CID_LEN ||
+      message->data[0] != MBEDTLS_SSL_MSG_CID) {
+    return NULL;
+  }
+  const uint8_t *cid = message->data + DTLS_CID_RECORD_CID_OFFSET;
+  for (oc_tls_peer_t *peer = (oc_tls_peer_t *)oc_list_head(g_tls_peers);
+       peer != NULL; peer = peer->next) {
+    if (peer->role == MBEDTLS_SSL_IS_SERVER &&
+        (peer->endpoint.flags & TCP) == 0 &&
+        peer->endpoint.device == message->endpoint.device &&
+        memcmp(peer->cid, cid, OC_DTLS_CID_LEN) == 0) {
+      return peer;
+    }
+  }
+  return NULL;
+}
+
+static void
+tls_peer_remember_endpoint(oc_tls_peer_t *peer, const oc_endpoint_t *endpoint)
+{
+  memmove(&peer->prev_endpoints[1], &peer->prev_endpoints[0],
+          sizeof(peer->prev_endpoints) - sizeof(peer->prev_endpoints[0]));
+  oc_endpoint_copy(&peer->prev_endpoints[0], endpoint);
+}
+
+/* Move the state kept by the stack for the previous address of a peer */
+static void
+tls_move_endpoint_state(const oc_endpoint_t *from, const oc_endpoint_t *to)
+{
+#ifdef OC_SERVER
+  coap_update_observers_endpoint(from, to);
+#endif /* OC_SERVER */
+  coap_update_transactions_endpoint(from, to);
+#ifdef OC_CLIENT
+  oc_client_cbs_update_endpoint(from, to);
+#endif /* OC_CLIENT */
+}
+
+bool
+oc_tls_peer_update_endpoint(oc_tls_peer_t *peer)
+{
+  const oc_endpoint_t *ep = &peer->recv_endpoint;
+  if ((ep->flags & (IPV4 | IPV6)) == 0) {
+    return false;
+  }
+  // RFC 9146, Section 6: only a record newer than all records received before
+  // may change the address, so a reordered or replayed datagram cannot move
+  // the peer back to an old address
+  bool newest = peer->recv_record_seq > peer->max_record_seq;
+  if (newest) {
+    peer->max_record_seq = peer->recv_record_seq;
+  }
+  if (oc_endpoint_compare(&peer->endpoint, ep) == 0) {
+    return false;
+  }
+  if (!newest) {
+    OC_DBG("oc_tls: peer(%p) ignoring address of an older record",
+           (void *)peer);
+    return false;
+  }
+#if OC_DBG_IS_ENABLED
+  oc_string64_t from_str;
+  oc_endpoint_to_string64(&peer->endpoint, &from_str);
+  oc_string64_t to_str;
+  oc_endpoint_to_string64(ep, &to_str);
+  OC_DBG("oc_tls: peer(%p) moved from %s to %s", (void *)peer,
+         oc_string(from_str), oc_string(to_str));
+#endif /* OC_DBG_IS_ENABLED */
+  // the record carrying the connection ID was authenticated, so replies go to
+  // the new address of the client
+  oc_endpoint_t from;
+  oc_endpoint_copy(&from, &peer->endpoint);
+  oc_endpoint_copy_address(&peer->endpoint, ep);
+  tls_peer_remember_endpoint(peer, &from);
+  tls_move_endpoint_state(&from, &peer->endpoint);
+  return true;
+}
+
+/* State the stack does not track globally (e.g. separate responses) still
+ * refers to the address a request was received from, so a message for a
+ * previous address of a moved peer is redirected to its current address */
+static void
+tls_message_follow_moved_peer(oc_message_t *message)
+{
+  if ((message->endpoint.flags & TCP) != 0 ||
+      oc_tls_get_peer(&message->endpoint) != NULL) {
+    return;
+  }
+  for (const oc_tls_peer_t *peer = (oc_tls_peer_t *)oc_list_head(g_tls_peers);
+       peer != NULL; peer = peer->next) {
+    if (peer->role != MBEDTLS_SSL_IS_SERVER ||
+        (peer->endpoint.flags & TCP) != 0) {
+      continue;
+    }
+    for (size_t i = 0; i < OC_ARRAY_SIZE(peer->prev_endpoints); ++i) {
+      if (oc_endpoint_compare(&peer->prev_endpoints[i], &message->endpoint) ==
+          0) {
+        oc_endpoint_copy_address(&message->endpoint, &peer->endpoint);
+        return;
+      }
+    }
+  }
+}
+#endif /* OC_DTLS_CID */
+
 static void
 oc_tls_export_keys(void *p_expkey, mbedtls_ssl_key_export_type type,
                    const unsigned char *secret, size_t secret_len,
@@ -2068,28 +2942,92 @@ oc_tls_export_keys(void *p_expkey, mbedtls_ssl_key_export_type type,
               OC_ARRAY_SIZE(peer->client_server_random));
 }
 
+static oc_tls_config_t *
+tls_config_build(const tls_config_key_t *key)
+{
+  oc_tls_config_t *config = tls_config_allocate();
+  if (config == NULL) {
+    OC_ERR("oc_tls: cannot allocate configuration");
+    return NULL;
+  }
+  memcpy(&config->key, key, sizeof(tls_config_key_t));
+  config->refs = 0;
+  config->stale = false;
+  if (oc_tls_populate_ssl_config(&config->conf, key) < 0) {
+    OC_ERR("oc_tls: error in tls_populate_ssl_config");
+    mbedtls_ssl_config_free(&config->conf);
+    oc_memb_free(&g_tls_configs_s, config);
+    return NULL;
+  }
+
+  oc_tls_set_ciphersuites(&config->conf, key);
+#ifdef OC_TLS_SESSION_RESUMPTION
+  if (key->role == MBEDTLS_SSL_IS_SERVER) {
+    mbedtls_ssl_conf_session_cache(&config->conf, NULL, tls_session_cache_get,
+                                   tls_session_cache_set);
+  }
+#endif /* OC_TLS_SESSION_RESUMPTION */
+#if defined(OC_TLS_ASYNC_CRYPTO) && defined(OC_PKI)
+  if (key->role == MBEDTLS_SSL_IS_SERVER) {
+    // mbedtls supports asynchronous private key operations only on the server
+    mbedtls_ssl_conf_async_private_cb(&config->conf, tls_async_sign_start,
+                                      NULL, tls_async_resume, tls_async_cancel,
+                                      NULL);
+  }
+#endif /* OC_TLS_ASYNC_CRYPTO && OC_PKI */
+  oc_list_add(g_tls_configs, config);
+  OC_DBG("oc_tls: built configuration(%p) for device(%zu)", (void *)config,
+         key->device);
+  return config;
+}
+
+static oc_tls_config_t *
+tls_config_get(const tls_config_key_t *key)
+{
+  for (oc_tls_config_t *config = (oc_tls_config_t *)oc_list_head(g_tls_configs);
+       config != NULL; config = config->next) {
+    if (!config->stale &&
+        memcmp(&config->key, key, sizeof(tls_config_key_t)) == 0) {
+      // move the configuration to the end of the least recently used list
+      oc_list_remove(g_tls_configs, config);
+      oc_list_add(g_tls_configs, config);
+      return config;
+    }
+  }
+  return tls_config_build(key);
+}
+
 static int
 oc_tls_peer_ssl_init(oc_tls_peer_t *peer)
 {
   mbedtls_ssl_init(&peer->ssl_ctx);
 
-  int transport_type = (peer->endpoint.flags & TCP) != 0
-                         ? MBEDTLS_SSL_TRANSPORT_STREAM
-                         : MBEDTLS_SSL_TRANSPORT_DATAGRAM;
-
-  if (oc_tls_populate_ssl_config(&peer->ssl_conf, peer->endpoint.device,
-                                 peer->role, transport_type) < 0) {
-    OC_ERR("oc_tls: error in tls_populate_ssl_config");
+  tls_config_key_t key;
+  tls_config_key_init(&key, peer);
+  int transport_type = key.transport_type;
+  peer->config = tls_config_get(&key);
+  if (peer->config == NULL) {
     return -1;
   }
+  ++peer->config->refs;
 
-  oc_tls_set_ciphersuites(&peer->ssl_conf, &peer->endpoint);
-
-  int err = mbedtls_ssl_setup(&peer->ssl_ctx, &peer->ssl_conf);
+  int err = mbedtls_ssl_setup(&peer->ssl_ctx, &peer->config->conf);
   if (err != 0) {
     OC_ERR("oc_tls: error in mbedtls_ssl_setup: %d", err);
     return -1;
   }
+#ifdef OC_DTLS_CID
+  if (transport_type == MBEDTLS_SSL_TRANSPORT_DATAGRAM &&
+      tls_peer_set_cid(peer) != 0) {
+    OC_ERR("oc_tls: error in setting of the connection ID");
+    return -1;
+  }
+#endif /* OC_DTLS_CID */
+#if defined(OC_TLS_SESSION_RESUMPTION) && defined(OC_CLIENT)
+  if (peer->role == MBEDTLS_SSL_IS_CLIENT) {
+    tls_client_session_resume(peer);
+  }
+#endif /* OC_TLS_SESSION_RESUMPTION && OC_CLIENT */
   /* Fix maximum size of outgoing encrypted application payloads when sent
    * over UDP */
   if (transport_type == MBEDTLS_SSL_TRANSPORT_DATAGRAM) {
@@ -2153,7 +3091,7 @@ oc_tls_peer_pki_init(oc_tls_peer_t *peer, oc_pki_user_data_t user_data,
 {
   peer->user_data = user_data;
   peer->verify_certificate = verify_certificate;
-  mbedtls_ssl_conf_verify(&peer->ssl_conf, tls_verify_certificate, peer);
+  mbedtls_ssl_set_verify(&peer->ssl_ctx, tls_verify_certificate, peer);
 }
 
 #endif /* OC_PKI */
@@ -2254,6 +3192,10 @@ oc_tls_shutdown(void)
     oc_tls_free_peer(p, false, true, true);
     p = oc_list_pop(g_tls_peers);
   }
+  oc_tls_invalidate_configs();
+#ifdef OC_CLIENT
+  tls_free_selections();
+#endif /* OC_CLIENT */
 #ifdef OC_PKI
   oc_x509_crt_t *cert = (oc_x509_crt_t *)oc_list_pop(g_identity_certs);
   while (cert != NULL) {
@@ -2269,6 +3211,12 @@ oc_tls_shutdown(void)
   }
   mbedtls_x509_crt_free(&g_trust_anchors);
 #endif /* OC_PKI */
+#ifdef OC_TLS_SESSION_RESUMPTION
+  oc_tls_session_cache_clear();
+#endif /* OC_TLS_SESSION_RESUMPTION */
+#ifdef OC_TLS_ASYNC_CRYPTO
+  oc_tls_async_stop();
+#endif /* OC_TLS_ASYNC_CRYPTO */
   mbedtls_ctr_drbg_free(&g_oc_ctr_drbg_ctx);
   mbedtls_ssl_cookie_free(&g_cookie_ctx);
   mbedtls_entropy_free(&g_entropy_ctx);
@@ -2302,6 +3250,12 @@ oc_tls_init_context(void)
 
 #ifdef OC_PKI
   mbedtls_x509_crt_init(&g_trust_anchors);
+#ifdef OC_TLS_ASYNC_CRYPTO
+  if (!oc_tls_async_start(tls_async_done)) {
+    // handshakes fall back to synchronous signatures
+    OC_WRN("oc_tls: cannot start the crypto workers");
+  }
+#endif /* OC_TLS_ASYNC_CRYPTO */
 #endif /* OC_PKI */
 
   return 0;
@@ -2331,6 +3285,10 @@ tls_close_connection(const oc_endpoint_t *endpoint, bool from_reset)
 void
 oc_tls_close_connection(const oc_endpoint_t *endpoint)
 {
+#ifdef OC_CLIENT
+  // the connection might not be established yet
+  oc_tls_release_selection(endpoint);
+#endif /* OC_CLIENT */
   tls_close_connection(endpoint, false);
 }
 
@@ -2562,6 +3520,8 @@ oc_tls_send_message_internal(oc_message_t *message)
   size_t length = 0;
   oc_tls_peer_t *peer = oc_tls_get_peer(&message->endpoint);
   if (peer) {
+    OC_TRACEPOINT(OC_TRACEPOINT_ENCRYPT, OC_TRACEPOINT_KEY(message),
+                  message->length);
     int ret = 0;
 #ifdef OC_TCP
     if (peer->endpoint.flags & TCP) {
@@ -2582,6 +3542,7 @@ oc_tls_send_message_internal(oc_message_t *message)
       oc_tls_free_peer(peer, false, false, true);
     } else {
       length = message->length;
+      OC_TRACEPOINT(OC_TRACEPOINT_SEND, OC_TRACEPOINT_KEY(message), length);
     }
   }
   oc_message_unref(message);
@@ -2642,10 +3603,10 @@ write_application_data(oc_tls_peer_t *peer)
 static void
 oc_tls_handshake(oc_tls_peer_t *peer)
 {
-  int ret = mbedtls_ssl_handshake(&peer->ssl_ctx);
-  if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ &&
-      ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+  int ret = tls_peer_handshake(peer, mbedtls_ssl_handshake);
+  if (ret < 0 && !tls_handshake_in_progress(ret)) {
     TLS_LOG_MBEDTLS_ERROR("mbedtls_ssl_handshake", ret);
+    OC_METRICS_INCREMENT(OC_METRIC_TLS_HANDSHAKE_FAILURES);
     oc_tls_free_peer(peer, false, false, true);
     return;
   }
@@ -2681,6 +3642,7 @@ oc_tls_init_connection(oc_message_t *message)
   const oc_sec_pstat_t *pstat = oc_sec_get_pstat(message->endpoint.device);
   if (pstat->s != OC_DOS_RFNOP) {
     OC_ERR("error: device not in DOS_RFNOP state");
+    oc_tls_release_selection(&message->endpoint);
     oc_message_unref(message);
     return;
   }
@@ -2698,6 +3660,7 @@ oc_tls_init_connection(oc_message_t *message)
 
   if (peer == NULL || peer->role != MBEDTLS_SSL_IS_CLIENT) {
     OC_ERR("oc_tls: failed to get a valid client peer");
+    oc_tls_release_selection(&message->endpoint);
     oc_message_unref(message);
     return;
   }
@@ -2755,6 +3718,9 @@ oc_tls_init_connection(oc_message_t *message)
 size_t
 oc_tls_send_message(oc_message_t *message)
 {
+#ifdef OC_DTLS_CID
+  tls_message_follow_moved_peer(message);
+#endif /* OC_DTLS_CID */
 #if defined(OC_CLIENT)
   if (!oc_tls_connected(&message->endpoint)) {
     oc_tls_init_connection(message);
@@ -2857,6 +3823,9 @@ tls_read_application_data_tcp(oc_tls_peer_t *peer)
       OC_DBG("oc_tls_tcp: Decrypted incoming message %d", (int)(total_length));
       peer->processed_recv_message->encrypted = 0;
       memcpy(peer->processed_recv_message->endpoint.di.id, peer->uuid.id, 16);
+      OC_TRACEPOINT(OC_TRACEPOINT_DECRYPT,
+                    OC_TRACEPOINT_KEY(peer->processed_recv_message),
+                    total_length);
       if (oc_process_post(
             &g_coap_engine, oc_event_to_oc_process_event(INBOUND_RI_EVENT),
             peer->processed_recv_message) == OC_PROCESS_ERR_FULL) {
@@ -2869,11 +3838,40 @@ tls_read_application_data_tcp(oc_tls_peer_t *peer)
 }
 #endif /* OC_TCP */
 
+#ifdef OC_TLS_LOW_MEMORY
+static void
+tls_peer_release_handshake_state(oc_tls_peer_t *peer)
+{
+  mbedtls_ssl_context *ssl = &peer->ssl_ctx;
+#if defined(MBEDTLS_X509_CRT_PARSE_C) &&                                       \
+  defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+  // the identity of the remote endpoint was stored by the verification
+  if (ssl->session != NULL && ssl->session->peer_cert != NULL) {
+    mbedtls_x509_crt_free(ssl->session->peer_cert);
+    mbedtls_free(ssl->session->peer_cert);
+    ssl->session->peer_cert = NULL;
+  }
+#endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_SSL_KEEP_PEER_CERTIFICATE */
+#if defined(MBEDTLS_SSL_DTLS_HELLO_VERIFY) && defined(MBEDTLS_SSL_SRV_C)
+  // the transport ID is only used for the cookie of the ClientHello
+  mbedtls_free(ssl->cli_id);
+  ssl->cli_id = NULL;
+  ssl->cli_id_len = 0;
+#endif /* MBEDTLS_SSL_DTLS_HELLO_VERIFY && MBEDTLS_SSL_SRV_C */
+#if OC_DBG_IS_ENABLED
+  oc_tls_peer_memory_t report;
+  size_t usage = oc_tls_peer_memory_usage(peer, &report);
+  OC_DBG("oc_tls: peer(%p) holds %zu bytes (buffers=%zu)", (void *)peer, usage,
+         report.buffers);
+#endif /* OC_DBG_IS_ENABLED */
+}
+#endif /* OC_TLS_LOW_MEMORY */
+
 static void
 tls_handshake_step(oc_tls_peer_t *peer)
 {
   do {
-    int ret = mbedtls_ssl_handshake_step(&peer->ssl_ctx);
+    int ret = tls_peer_handshake(peer, mbedtls_ssl_handshake_step);
     if (ret == MBEDTLS_ERR_SSL_HELLO_VERIFY_REQUIRED) {
       mbedtls_ssl_session_reset(&peer->ssl_ctx);
       /* For HelloVerifyRequest cookies */
@@ -2892,7 +3890,15 @@ tls_handshake_step(oc_tls_peer_t *peer)
           ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
         break;
       }
+#ifdef OC_TLS_ASYNC_CRYPTO
+      if (ret == MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS) {
+        // the handshake continues when the crypto worker finishes
+        OC_DBG("oc_tls: handshake waiting for the crypto worker");
+        break;
+      }
+#endif /* OC_TLS_ASYNC_CRYPTO */
       TLS_LOG_MBEDTLS_ERROR("mbedtls_ssl_handshake_step", ret);
+      OC_METRICS_INCREMENT(OC_METRIC_TLS_HANDSHAKE_FAILURES);
       oc_tls_free_peer(peer, false, false, true);
       return;
     }
@@ -2905,8 +3911,17 @@ tls_handshake_step(oc_tls_peer_t *peer)
 
   OC_DBG("oc_tls: (D)TLS Session is connected via ciphersuite [0x%x]",
          peer->ssl_ctx.session->ciphersuite);
+  OC_METRICS_INCREMENT(OC_METRIC_TLS_HANDSHAKES);
+#ifdef OC_TLS_LOW_MEMORY
+  tls_peer_release_handshake_state(peer);
+#endif /* OC_TLS_LOW_MEMORY */
   oc_handle_session(&peer->endpoint, OC_SESSION_CONNECTED);
 #ifdef OC_CLIENT
+#ifdef OC_TLS_SESSION_RESUMPTION
+  if (peer->role == MBEDTLS_SSL_IS_CLIENT) {
+    tls_client_session_save(peer);
+  }
+#endif /* OC_TLS_SESSION_RESUMPTION */
 #ifdef OC_PKI
   if (g_auto_assert_all_roles && !oc_tls_uses_psk_cred(peer) &&
       oc_get_all_roles()) {
@@ -2954,6 +3969,11 @@ tls_read_application_data_udp(oc_tls_peer_t *peer)
 
   message->length = ret;
   message->encrypted = 0;
+#ifdef OC_DTLS_CID
+  if (oc_tls_peer_update_endpoint(peer)) {
+    memcpy(&message->endpoint, &peer->endpoint, sizeof(oc_endpoint_t));
+  }
+#endif /* OC_DTLS_CID */
 #ifdef OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER
   oc_message_shrink_buffer(message, message->length);
 #endif /* OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER */
@@ -2969,6 +3989,7 @@ tls_read_application_data_udp(oc_tls_peer_t *peer)
   memcpy(msg->data, message->data, message->length);
 #endif /* OC_INOUT_BUFFER_SIZE */
   memcpy(&msg->endpoint.di.id, &peer->uuid.id, OC_ARRAY_SIZE(peer->uuid.id));
+  OC_TRACEPOINT(OC_TRACEPOINT_DECRYPT, OC_TRACEPOINT_KEY(msg), msg->length);
 
 #ifdef OC_OSCORE
   if (oc_process_post(&oc_oscore_handler,
@@ -3049,8 +4070,15 @@ oc_tls_recv_message(oc_message_t *message)
   } else
 #endif /* OC_TCP */
   {
-    peer =
-      oc_tls_add_or_get_peer(&message->endpoint, MBEDTLS_SSL_IS_SERVER, NULL);
+#ifdef OC_DTLS_CID
+    // a client identified by the connection ID may have changed its address
+    peer = oc_tls_get_peer_by_cid(message);
+    if (peer == NULL)
+#endif /* OC_DTLS_CID */
+    {
+      peer = oc_tls_add_or_get_peer(&message->endpoint, MBEDTLS_SSL_IS_SERVER,
+                                    NULL);
+    }
   }
 
   if (peer == NULL) {
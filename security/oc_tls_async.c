@@ -0,0 +1,339 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#if defined(OC_SECURITY) && defined(OC_TLS_ASYNC_CRYPTO)
+
+#include "oc_signal_event_loop.h"
+#include "port/oc_log_internal.h"
+#include "security/oc_tls_async_internal.h"
+#include "security/oc_tls_internal.h"
+#include "util/oc_list.h"
+#include "util/oc_memb.h"
+#include "util/oc_process.h"
+
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/ssl.h"
+
+#include <limits.h>
+#include <pthread.h>
+#include <string.h>
+
+#define TLS_ASYNC_PERSONALIZATION_DATA "IoTivity-Lite-TLS-Async"
+
+typedef enum {
+  TLS_ASYNC_JOB_PENDING = 0,
+  TLS_ASYNC_JOB_RUNNING,
+  TLS_ASYNC_JOB_DONE,
+} tls_async_job_state_t;
+
+struct oc_tls_async_job_t
+{
+  struct oc_tls_async_job_t *next;
+  void *data;
+  tls_async_job_state_t state;
+  bool cancelled; ///< released by the stack thread once finished
+  mbedtls_ecdsa_context key;
+  mbedtls_md_type_t md_alg;
+  uint8_t hash[MBEDTLS_MD_MAX_SIZE];
+  size_t hash_len;
+  int ret;
+  uint8_t sig[MBEDTLS_ECDSA_MAX_LEN];
+  size_t sig_len;
+};
+
+typedef struct
+{
+  pthread_t thread;
+  // the random generator of the stack is not thread-safe, so each worker has
+  // its own generator seeded from it
+  mbedtls_ctr_drbg_context ctr_drbg;
+} tls_async_worker_t;
+
+OC_MEMB(g_tls_async_jobs_s, oc_tls_async_job_t, OC_TLS_ASYNC_CRYPTO_QUEUE_SIZE);
+
+static struct
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  bool running;
+  bool terminate;
+  oc_tls_async_done_cb_t done_cb;
+  // number of allocated jobs, only accessed by the stack thread
+  size_t num_jobs;
+  // jobs waiting for a worker thread
+  OC_LIST_STRUCT(pending);
+  // jobs finished by a worker thread waiting for the stack thread
+  OC_LIST_STRUCT(done);
+  tls_async_worker_t workers[OC_TLS_ASYNC_CRYPTO_WORKERS];
+  size_t num_workers;
+} g_tls_async = {
+  .mutex = PTHREAD_MUTEX_INITIALIZER,
+  .cond = PTHREAD_COND_INITIALIZER,
+};
+
+OC_PROCESS(oc_tls_async_process, "TLS async crypto");
+
+static void
+tls_async_job_free(oc_tls_async_job_t *job)
+{
+  mbedtls_ecdsa_free(&job->key);
+  oc_memb_free(&g_tls_async_jobs_s, job);
+  --g_tls_async.num_jobs;
+}
+
+static void
+tls_async_process_done_jobs(void)
+{
+  pthread_mutex_lock(&g_tls_async.mutex);
+  OC_LIST_LOCAL(done);
+  oc_list_copy(done, g_tls_async.done);
+  oc_list_init(g_tls_async.done);
+  pthread_mutex_unlock(&g_tls_async.mutex);
+
+  // the result of a job is taken by oc_tls_async_result, the done list only
+  // notifies the owners
+  oc_tls_async_job_t *job = (oc_tls_async_job_t *)oc_list_pop(done);
+  while (job != NULL) {
+    if (job->cancelled) {
+      tls_async_job_free(job);
+    } else {
+      g_tls_async.done_cb(job->data);
+    }
+    job = (oc_tls_async_job_t *)oc_list_pop(done);
+  }
+}
+
+OC_PROCESS_THREAD(oc_tls_async_process, ev, data)
+{
+  (void)ev;
+  (void)data;
+  OC_PROCESS_POLLHANDLER(tls_async_process_done_jobs());
+  OC_PROCESS_BEGIN();
+  while (oc_process_is_running(&oc_tls_async_process)) {
+    OC_PROCESS_YIELD();
+  }
+  OC_PROCESS_END();
+}
+
+static void
+tls_async_signal_done(void)
+{
+  oc_process_poll(&oc_tls_async_process);
+  _oc_signal_event_loop();
+}
+
+static void *
+tls_async_worker_thread(void *data)
+{
+  tls_async_worker_t *worker = (tls_async_worker_t *)data;
+  pthread_mutex_lock(&g_tls_async.mutex);
+  while (!g_tls_async.terminate) {
+    oc_tls_async_job_t *job =
+      (oc_tls_async_job_t *)oc_list_pop(g_tls_async.pending);
+    if (job == NULL) {
+      pthread_cond_wait(&g_tls_async.cond, &g_tls_async.mutex);
+      continue;
+    }
+    job->state = TLS_ASYNC_JOB_RUNNING;
+    pthread_mutex_unlock(&g_tls_async.mutex);
+
+    job->ret = mbedtls_ecdsa_write_signature(
+      &job->key, job->md_alg, job->hash, job->hash_len, job->sig,
+      sizeof(job->sig), &job->sig_len, mbedtls_ctr_drbg_random,
+      &worker->ctr_drbg);
+
+    pthread_mutex_lock(&g_tls_async.mutex);
+    job->state = TLS_ASYNC_JOB_DONE;
+    oc_list_add(g_tls_async.done, job);
+    tls_async_signal_done();
+  }
+  pthread_mutex_unlock(&g_tls_async.mutex);
+  return NULL;
+}
+
+static int
+tls_async_seed(void *ctx, unsigned char *output, size_t len)
+{
+  return mbedtls_ctr_drbg_random(ctx, output, len);
+}
+
+static bool
+tls_async_worker_init(tls_async_worker_t *worker)
+{
+  mbedtls_ctr_drbg_init(&worker->ctr_drbg);
+  int ret = mbedtls_ctr_drbg_seed(
+    &worker->ctr_drbg, tls_async_seed, oc_tls_ctr_drbg_context(),
+    (const unsigned char *)TLS_ASYNC_PERSONALIZATION_DATA,
+    sizeof(TLS_ASYNC_PERSONALIZATION_DATA));
+  if (ret != 0) {
+    OC_ERR("oc_tls_async: cannot seed the random generator of a worker(%d)",
+           ret);
+    mbedtls_ctr_drbg_free(&worker->ctr_drbg);
+    return false;
+  }
+  // a reseed would call the generator of the stack from the worker thread
+  mbedtls_ctr_drbg_set_reseed_interval(&worker->ctr_drbg, INT_MAX);
+  return true;
+}
+
+static void
+tls_async_jobs_free(oc_list_t list)
+{
+  oc_tls_async_job_t *job = (oc_tls_async_job_t *)oc_list_pop(list);
+  while (job != NULL) {
+    tls_async_job_free(job);
+    job = (oc_tls_async_job_t *)oc_list_pop(list);
+  }
+}
+
+bool
+oc_tls_async_start(oc_tls_async_done_cb_t done_cb)
+{
+  if (g_tls_async.running) {
+    return true;
+  }
+  OC_LIST_STRUCT_INIT(&g_tls_async, pending);
+  OC_LIST_STRUCT_INIT(&g_tls_async, done);
+  g_tls_async.terminate = false;
+  g_tls_async.done_cb = done_cb;
+  g_tls_async.num_workers = 0;
+  for (size_t i = 0; i < OC_TLS_ASYNC_CRYPTO_WORKERS; ++i) {
+    tls_async_worker_t *worker = &g_tls_async.workers[i];
+    if (!tls_async_worker_init(worker)) {
+      break;
+    }
+    if (pthread_create(&worker->thread, NULL, tls_async_worker_thread,
+                       worker) != 0) {
+      OC_ERR("oc_tls_async: cannot create worker thread");
+      mbedtls_ctr_drbg_free(&worker->ctr_drbg);
+      break;
+    }
+    ++g_tls_async.num_workers;
+  }
+  if (g_tls_async.num_workers == 0) {
+    return false;
+  }
+  oc_process_start(&oc_tls_async_process, NULL);
+  g_tls_async.running = true;
+  OC_DBG("oc_tls_async: started %zu workers", g_tls_async.num_workers);
+  return true;
+}
+
+void
+oc_tls_async_stop(void)
+{
+  if (!g_tls_async.running) {
+    return;
+  }
+  pthread_mutex_lock(&g_tls_async.mutex);
+  g_tls_async.terminate = true;
+  pthread_cond_broadcast(&g_tls_async.cond);
+  pthread_mutex_unlock(&g_tls_async.mutex);
+  for (size_t i = 0; i < g_tls_async.num_workers; ++i) {
+    pthread_join(g_tls_async.workers[i].thread, NULL);
+    mbedtls_ctr_drbg_free(&g_tls_async.workers[i].ctr_drbg);
+  }
+  g_tls_async.num_workers = 0;
+  g_tls_async.running = false;
+  tls_async_jobs_free(g_tls_async.pending);
+  tls_async_jobs_free(g_tls_async.done);
+  oc_process_exit(&oc_tls_async_process);
+}
+
+oc_tls_async_job_t *
+oc_tls_async_sign(const mbedtls_pk_context *pk, mbedtls_md_type_t md_alg,
+                  const uint8_t *hash, size_t hash_len, void *data)
+{
+  if (!g_tls_async.running ||
+      g_tls_async.num_jobs >= OC_TLS_ASYNC_CRYPTO_QUEUE_SIZE ||
+      !mbedtls_pk_can_do(pk, MBEDTLS_PK_ECDSA) ||
+      hash_len > MBEDTLS_MD_MAX_SIZE) {
+    return NULL;
+  }
+  oc_tls_async_job_t *job =
+    (oc_tls_async_job_t *)oc_memb_alloc(&g_tls_async_jobs_s);
+  if (job == NULL) {
+    return NULL;
+  }
+  ++g_tls_async.num_jobs;
+  memset(job, 0, sizeof(oc_tls_async_job_t));
+  mbedtls_ecdsa_init(&job->key);
+  // the worker signs with a copy, the key of the stack may be used or freed
+  // concurrently
+  int ret = mbedtls_ecdsa_from_keypair(&job->key, mbedtls_pk_ec(*pk));
+  if (ret != 0) {
+    OC_ERR("oc_tls_async: cannot copy the private key(%d)", ret);
+    tls_async_job_free(job);
+    return NULL;
+  }
+  job->data = data;
+  job->md_alg = md_alg;
+  memcpy(job->hash, hash, hash_len);
+  job->hash_len = hash_len;
+
+  pthread_mutex_lock(&g_tls_async.mutex);
+  oc_list_add(g_tls_async.pending, job);
+  pthread_cond_signal(&g_tls_async.cond);
+  pthread_mutex_unlock(&g_tls_async.mutex);
+  return job;
+}
+
+int
+oc_tls_async_result(oc_tls_async_job_t *job, uint8_t *output,
+                    size_t *output_len, size_t output_size)
+{
+  pthread_mutex_lock(&g_tls_async.mutex);
+  if (job->state != TLS_ASYNC_JOB_DONE) {
+    pthread_mutex_unlock(&g_tls_async.mutex);
+    return MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS;
+  }
+  // the result may be taken before the done list is processed
+  oc_list_remove(g_tls_async.done, job);
+  pthread_mutex_unlock(&g_tls_async.mutex);
+
+  int ret = job->ret;
+  if (ret == 0) {
+    if (job->sig_len > output_size) {
+      ret = MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL;
+    } else {
+      memcpy(output, job->sig, job->sig_len);
+      *output_len = job->sig_len;
+    }
+  }
+  tls_async_job_free(job);
+  return ret;
+}
+
+void
+oc_tls_async_cancel(oc_tls_async_job_t *job)
+{
+  pthread_mutex_lock(&g_tls_async.mutex);
+  if (job->state == TLS_ASYNC_JOB_RUNNING) {
+    job->cancelled = true;
+    pthread_mutex_unlock(&g_tls_async.mutex);
+    return;
+  }
+  oc_list_remove(job->state == TLS_ASYNC_JOB_PENDING ? g_tls_async.pending
+                                                     : g_tls_async.done,
+                 job);
+  pthread_mutex_unlock(&g_tls_async.mutex);
+  tls_async_job_free(job);
+}
+
+#endif /* OC_SECURITY && OC_TLS_ASYNC_CRYPTO */
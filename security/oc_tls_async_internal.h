@@ -0,0 +1,120 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifndef OC_TLS_ASYNC_INTERNAL_H
+#define OC_TLS_ASYNC_INTERNAL_H
+
+#if defined(OC_SECURITY) && defined(OC_TLS_ASYNC_CRYPTO)
+
+#ifndef OC_DYNAMIC_ALLOCATION
+#error "OC_TLS_ASYNC_CRYPTO requires OC_DYNAMIC_ALLOCATION"
+#endif /* !OC_DYNAMIC_ALLOCATION */
+
+#include "util/oc_compiler.h"
+
+#include "mbedtls/md.h"
+#include "mbedtls/pk.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef OC_TLS_ASYNC_CRYPTO_WORKERS
+/* Number of worker threads of the crypto pool */
+#define OC_TLS_ASYNC_CRYPTO_WORKERS (2)
+#endif /* !OC_TLS_ASYNC_CRYPTO_WORKERS */
+
+#ifndef OC_TLS_ASYNC_CRYPTO_QUEUE_SIZE
+/* Maximal number of unfinished jobs, operations above the limit are executed
+ * synchronously by the caller */
+#define OC_TLS_ASYNC_CRYPTO_QUEUE_SIZE (16)
+#endif /* !OC_TLS_ASYNC_CRYPTO_QUEUE_SIZE */
+
+typedef struct oc_tls_async_job_t oc_tls_async_job_t;
+
+/**
+ * @brief Callback invoked on the stack thread when a job is finished.
+ *
+ * @param data user data of the job
+ */
+typedef void (*oc_tls_async_done_cb_t)(void *data);
+
+/**
+ * @brief Start the worker threads of the crypto pool.
+ *
+ * @param done_cb callback invoked when a job is finished (cannot be NULL)
+ * @return true on success, or if the pool is already running
+ * @return false on failure
+ */
+bool oc_tls_async_start(oc_tls_async_done_cb_t done_cb) OC_NONNULL();
+
+/** @brief Stop the worker threads and free all jobs */
+void oc_tls_async_stop(void);
+
+/**
+ * @brief Queue an ECDSA signature of a hash with the private key to the
+ * worker pool.
+ *
+ * The key is copied, so it may be modified or freed while the job runs.
+ *
+ * @param pk private key (cannot be NULL)
+ * @param md_alg algorithm of the hash
+ * @param hash hash to sign (cannot be NULL)
+ * @param hash_len length of the hash
+ * @param data user data passed to the done callback
+ * @return oc_tls_async_job_t* the queued job
+ * @return NULL if the pool is not running or full, or the key is not an EC
+ * key; the caller should sign synchronously
+ */
+oc_tls_async_job_t *oc_tls_async_sign(const mbedtls_pk_context *pk,
+                                      mbedtls_md_type_t md_alg,
+                                      const uint8_t *hash, size_t hash_len,
+                                      void *data) OC_NONNULL(1, 3);
+
+/**
+ * @brief Get the result of a job and free the finished job.
+ *
+ * @param job the job (cannot be NULL)
+ * @param output buffer for the DER encoded signature (cannot be NULL)
+ * @param output_len length of the signature written to the buffer (cannot be
+ * NULL)
+ * @param output_size size of the buffer
+ * @return MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS if the job is not finished
+ * @return 0 on success, the job is freed
+ * @return <0 error of the signature, the job is freed
+ */
+int oc_tls_async_result(oc_tls_async_job_t *job, uint8_t *output,
+                        size_t *output_len, size_t output_size) OC_NONNULL();
+
+/**
+ * @brief Cancel and free a job, the done callback is not invoked for a
+ * cancelled job.
+ */
+void oc_tls_async_cancel(oc_tls_async_job_t *job) OC_NONNULL();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OC_SECURITY && OC_TLS_ASYNC_CRYPTO */
+
+#endif /* OC_TLS_ASYNC_INTERNAL_H */
@@ -41,6 +41,28 @@ extern "C" {
 
 OC_PROCESS_NAME(oc_tls_handler);
 
+#ifdef OC_DTLS_CID
+#ifndef OC_DTLS_CID_LEN
+/* Length of the DTLS connection ID (RFC 9146) assigned to the server peers */
+#define OC_DTLS_CID_LEN (4)
+#endif /* !OC_DTLS_CID_LEN */
+#ifndef OC_DTLS_CID_PREV_ENDPOINTS
+/* Number of previous addresses of a server peer to which messages are still
+ * redirected after the client moved */
+#define OC_DTLS_CID_PREV_ENDPOINTS (2)
+#endif /* !OC_DTLS_CID_PREV_ENDPOINTS */
+#endif /* OC_DTLS_CID */
+
+#ifndef OC_TLS_CONFIG_CACHE_SIZE
+/* Maximal number of mbedtls configurations kept for new peers after their
+ * last peer was freed */
+#define OC_TLS_CONFIG_CACHE_SIZE (4)
+#endif /* !OC_TLS_CONFIG_CACHE_SIZE */
+
+/* mbedtls configuration shared by the peers with the same device, role,
+ * transport and credentials */
+typedef struct oc_tls_config_t oc_tls_config_t;
+
 typedef struct
 {
   struct oc_etimer fin_timer;
@@ -53,7 +75,7 @@ typedef struct oc_tls_peer_t
   OC_LIST_STRUCT(recv_q);
   OC_LIST_STRUCT(send_q);
   mbedtls_ssl_context ssl_ctx;
-  mbedtls_ssl_config ssl_conf;
+  oc_tls_config_t *config; ///< shared configuration of ssl_ctx
   oc_endpoint_t endpoint;
   int role; // MBEDTLS_SSL_IS_SERVER = device acts as a server
             // MBEDTLS_SSL_IS_CLIENT = device acts as a client
@@ -69,6 +91,18 @@ typedef struct oc_tls_peer_t
 #ifdef OC_TCP
   oc_message_t *processed_recv_message;
 #endif /* OC_TCP */
+#ifdef OC_DTLS_CID
+  uint8_t cid[OC_DTLS_CID_LEN]; ///< connection ID of the records sent to us by
+                                ///< a client
+  oc_endpoint_t recv_endpoint;  ///< endpoint of the last datagram read by
+                                ///< mbedtls
+  uint64_t recv_record_seq; ///< epoch and sequence number of the last datagram
+                            ///< read by mbedtls
+  uint64_t max_record_seq;  ///< highest epoch and sequence number of a
+                            ///< decrypted record
+  /// previous addresses of the client, the latest first
+  oc_endpoint_t prev_endpoints[OC_DTLS_CID_PREV_ENDPOINTS];
+#endif /* OC_DTLS_CID */
 #ifdef OC_PKI
   oc_pki_user_data_t
     user_data; ///< user data for the peer, can be used by application
@@ -185,6 +219,32 @@ void oc_tls_close_peers(oc_tls_peer_filter_t filter, void *user_data);
  */
 oc_tls_peer_t *oc_tls_get_peer(const oc_endpoint_t *endpoint);
 
+#ifdef OC_DTLS_CID
+/**
+ * @brief Get the server peer owning the connection ID of the DTLS record in the
+ * message.
+ *
+ * @param message the received datagram (cannot be NULL)
+ * @return peer with matching connection ID
+ * @return NULL if the record has no connection ID or no peer owns it
+ */
+oc_tls_peer_t *oc_tls_get_peer_by_cid(const oc_message_t *message)
+  OC_NONNULL();
+
+/**
+ * @brief Move the peer to the address of the last datagram read by mbedtls.
+ *
+ * The address is changed only if the datagram is newer than all datagrams of
+ * decrypted records received before (RFC 9146, Section 6). Observers,
+ * transactions and client callbacks of the previous address are moved with
+ * the peer.
+ *
+ * @param peer the peer that has decrypted a record (cannot be NULL)
+ * @return true if the address of the peer was changed
+ */
+bool oc_tls_peer_update_endpoint(oc_tls_peer_t *peer) OC_NONNULL();
+#endif /* OC_DTLS_CID */
+
 /**
  * @brief Get uuid of the peer for the endpoint.
  *
@@ -205,6 +265,55 @@ bool oc_tls_peer_is_doc(const oc_endpoint_t *endpoint);
  */
 int oc_tls_num_peers(size_t device);
 
+/**
+ * @brief Count the number of shared mbedtls configurations, including the
+ * cached configurations without a peer.
+ */
+size_t oc_tls_num_configs(void);
+
+/**
+ * @brief Rebuild the shared mbedtls configurations for new peers.
+ *
+ * Must be called when the certificates or trust anchors loaded into the
+ * configurations change. Configurations without a peer are freed, the rest
+ * are freed with their last peer.
+ */
+void oc_tls_invalidate_configs(void);
+
+/** Memory held by a peer */
+typedef struct oc_tls_peer_memory_t
+{
+  size_t peer;      ///< the peer including the embedded SSL context
+  size_t buffers;   ///< record buffers of the SSL context
+  size_t session;   ///< the established session
+  size_t peer_cert; ///< certificate chain of the remote endpoint
+  bool handshake;   ///< the state of an unfinished handshake is allocated
+} oc_tls_peer_memory_t;
+
+/**
+ * @brief Report the memory held by the peer.
+ *
+ * The shared configuration, the state of an unfinished handshake, the
+ * transforms and their cipher contexts and the allocator overhead are not
+ * included, so the result is a lower bound of the memory held by the peer.
+ * Without MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH only the payload of the record
+ * buffers is counted.
+ *
+ * @param peer the peer (cannot be NULL)
+ * @param[out] report the breakdown of the memory (can be NULL)
+ * @return size_t total number of bytes
+ */
+size_t oc_tls_peer_memory_usage(const oc_tls_peer_t *peer,
+                                oc_tls_peer_memory_t *report) OC_NONNULL(1);
+
+/**
+ * @brief Sum the memory held by the peers of the device.
+ *
+ * @param device the device
+ * @return size_t total number of bytes
+ */
+size_t oc_tls_peers_memory_usage(size_t device);
+
 /**
  * @brief Check if the endpoint has a connected peer.
  *
@@ -268,6 +377,30 @@ void oc_tls_select_anon_ciphersuite(void);
 void oc_tls_select_cloud_ciphersuite(void);
 void oc_tls_reset_ciphersuite(void);
 
+/**
+ * @brief Bind the ciphersuite and credential selection to the endpoint.
+ *
+ * The selection is otherwise consumed by the next created peer. Binding it
+ * when a request to a new peer is queued keeps the selection of concurrent
+ * requests to different peers apart.
+ *
+ * @param endpoint endpoint of the peer (cannot be NULL)
+ */
+void oc_tls_bind_selection(const oc_endpoint_t *endpoint) OC_NONNULL();
+
+/**
+ * @brief Release the selection bound to the endpoint by oc_tls_bind_selection.
+ *
+ * Called when the request is dropped or the connection is closed before the
+ * selection is used by a new peer.
+ *
+ * @param endpoint endpoint of the peer (cannot be NULL)
+ */
+void oc_tls_release_selection(const oc_endpoint_t *endpoint) OC_NONNULL();
+
+/** @brief Count the selections bound to endpoints and not used yet. */
+size_t oc_tls_num_selections(void);
+
 /* Internal interface for checking supported OTMs */
 bool oc_tls_is_pin_otm_supported(size_t device);
 bool oc_tls_is_cert_otm_supported(size_t device);
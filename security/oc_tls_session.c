@@ -0,0 +1,218 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#if defined(OC_SECURITY) && defined(OC_TLS_SESSION_RESUMPTION)
+
+#include "oc_api.h"
+#include "port/oc_log_internal.h"
+#include "security/oc_tls_session_internal.h"
+#include "util/oc_list.h"
+#include "util/oc_memb.h"
+
+#include <string.h>
+
+OC_MEMB(g_tls_sessions_s, oc_tls_session_t, OC_TLS_SESSION_CACHE_SIZE);
+OC_LIST(g_tls_sessions);
+static uint32_t g_tls_session_lifetime = OC_TLS_SESSION_LIFETIME;
+
+void
+oc_tls_set_session_lifetime(uint32_t lifetime)
+{
+  g_tls_session_lifetime = lifetime;
+  if (lifetime == 0) {
+    oc_tls_session_cache_clear();
+  }
+}
+
+uint32_t
+oc_tls_session_lifetime(void)
+{
+  return g_tls_session_lifetime;
+}
+
+static void
+tls_session_free(oc_tls_session_t *session)
+{
+#ifdef OC_PKI
+  oc_free_string(&session->public_key);
+#endif /* OC_PKI */
+  oc_free_string(&session->data);
+  oc_memb_free(&g_tls_sessions_s, session);
+}
+
+void
+oc_tls_session_cache_remove(oc_tls_session_t *session)
+{
+  oc_list_remove(g_tls_sessions, session);
+  tls_session_free(session);
+}
+
+static void
+tls_session_remove_expired(oc_clock_time_t now)
+{
+  oc_tls_session_t *session = (oc_tls_session_t *)oc_list_head(g_tls_sessions);
+  while (session != NULL) {
+    oc_tls_session_t *next = session->next;
+    if (session->expires <= now) {
+      oc_tls_session_cache_remove(session);
+    }
+    session = next;
+  }
+}
+
+static oc_tls_session_t *
+tls_session_oldest(void)
+{
+  oc_tls_session_t *oldest = (oc_tls_session_t *)oc_list_head(g_tls_sessions);
+  for (oc_tls_session_t *session = oldest; session != NULL;
+       session = session->next) {
+    if (session->expires < oldest->expires) {
+      oldest = session;
+    }
+  }
+  return oldest;
+}
+
+static bool
+tls_session_is_client(const oc_tls_session_t *session,
+                      const oc_endpoint_t *endpoint)
+{
+  if (!session->client) {
+    return false;
+  }
+  oc_endpoint_t ep;
+  memcpy(&ep, endpoint, sizeof(oc_endpoint_t));
+#ifdef OC_TCP
+  ep.session_id = 0;
+#endif /* OC_TCP */
+  return oc_endpoint_compare(&session->endpoint, &ep) == 0;
+}
+
+static bool
+tls_session_is_server(const oc_tls_session_t *session, size_t device,
+                      const uint8_t *id, size_t id_len)
+{
+  return !session->client && session->endpoint.device == device &&
+         session->id_len == id_len && memcmp(session->id, id, id_len) == 0;
+}
+
+oc_tls_session_t *
+oc_tls_session_cache_add(const oc_endpoint_t *endpoint, bool client,
+                         const uint8_t *id, size_t id_len)
+{
+  if (g_tls_session_lifetime == 0) {
+    return NULL;
+  }
+  if (!client && (id == NULL || id_len == 0 ||
+                  id_len > OC_TLS_SESSION_ID_MAX_SIZE)) {
+    return NULL;
+  }
+  oc_clock_time_t now = oc_clock_time();
+  tls_session_remove_expired(now);
+
+  oc_tls_session_t *session =
+    client ? oc_tls_session_cache_find_client(endpoint)
+           : oc_tls_session_cache_find_server(endpoint->device, id, id_len);
+  if (session != NULL) {
+    oc_tls_session_cache_remove(session);
+  }
+
+  // the pool is not bounded with dynamic allocation
+  if (oc_list_length(g_tls_sessions) >= OC_TLS_SESSION_CACHE_SIZE) {
+    OC_DBG("oc_tls: session cache full, evicting the oldest session");
+    oc_tls_session_cache_remove(tls_session_oldest());
+  }
+  session = (oc_tls_session_t *)oc_memb_alloc(&g_tls_sessions_s);
+  if (session == NULL) {
+    OC_ERR("oc_tls: cannot allocate session");
+    return NULL;
+  }
+  memset(session, 0, sizeof(oc_tls_session_t));
+  memcpy(&session->endpoint, endpoint, sizeof(oc_endpoint_t));
+#ifdef OC_TCP
+  session->endpoint.session_id = 0;
+#endif /* OC_TCP */
+  session->endpoint.next = NULL;
+  session->client = client;
+  if (!client) {
+    memcpy(session->id, id, id_len);
+    session->id_len = (uint8_t)id_len;
+  }
+  session->expires = now + (oc_clock_time_t)g_tls_session_lifetime *
+                             (oc_clock_time_t)OC_CLOCK_SECOND;
+  oc_list_add(g_tls_sessions, session);
+  return session;
+}
+
+oc_tls_session_t *
+oc_tls_session_cache_find_server(size_t device, const uint8_t *id,
+                                 size_t id_len)
+{
+  if (id == NULL || id_len == 0) {
+    return NULL;
+  }
+  oc_clock_time_t now = oc_clock_time();
+  for (oc_tls_session_t *session =
+         (oc_tls_session_t *)oc_list_head(g_tls_sessions);
+       session != NULL; session = session->next) {
+    if (tls_session_is_server(session, device, id, id_len)) {
+      if (session->expires <= now) {
+        oc_tls_session_cache_remove(session);
+        return NULL;
+      }
+      return session;
+    }
+  }
+  return NULL;
+}
+
+oc_tls_session_t *
+oc_tls_session_cache_find_client(const oc_endpoint_t *endpoint)
+{
+  oc_clock_time_t now = oc_clock_time();
+  for (oc_tls_session_t *session =
+         (oc_tls_session_t *)oc_list_head(g_tls_sessions);
+       session != NULL; session = session->next) {
+    if (tls_session_is_client(session, endpoint)) {
+      if (session->expires <= now) {
+        oc_tls_session_cache_remove(session);
+        return NULL;
+      }
+      return session;
+    }
+  }
+  return NULL;
+}
+
+void
+oc_tls_session_cache_clear(void)
+{
+  oc_tls_session_t *session = (oc_tls_session_t *)oc_list_pop(g_tls_sessions);
+  while (session != NULL) {
+    tls_session_free(session);
+    session = (oc_tls_session_t *)oc_list_pop(g_tls_sessions);
+  }
+}
+
+size_t
+oc_tls_session_cache_size(void)
+{
+  return (size_t)oc_list_length(g_tls_sessions);
+}
+
+#endif /* OC_SECURITY && OC_TLS_SESSION_RESUMPTION */
@@ -0,0 +1,118 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifndef OC_TLS_SESSION_INTERNAL_H
+#define OC_TLS_SESSION_INTERNAL_H
+
+#if defined(OC_SECURITY) && defined(OC_TLS_SESSION_RESUMPTION)
+
+#include "oc_endpoint.h"
+#include "oc_helpers.h"
+#include "oc_uuid.h"
+#include "port/oc_clock.h"
+#include "util/oc_compiler.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef OC_TLS_SESSION_CACHE_SIZE
+/* Maximal number of cached sessions, the oldest session is evicted when the
+ * cache is full */
+#define OC_TLS_SESSION_CACHE_SIZE (16)
+#endif /* !OC_TLS_SESSION_CACHE_SIZE */
+
+#ifndef OC_TLS_SESSION_LIFETIME
+/* Default lifetime of a cached session in seconds */
+#define OC_TLS_SESSION_LIFETIME (24 * 60 * 60)
+#endif /* !OC_TLS_SESSION_LIFETIME */
+
+#define OC_TLS_SESSION_ID_MAX_SIZE (32)
+
+/**
+ * @brief Session established by a full (D)TLS handshake.
+ *
+ * Server sessions are found by the session id sent by the client, client
+ * sessions by the endpoint of the server. A resumed handshake skips the
+ * credential callbacks, so the authenticated identity of the peer is cached
+ * together with the session.
+ */
+typedef struct oc_tls_session_t
+{
+  struct oc_tls_session_t *next;
+  oc_endpoint_t endpoint; ///< endpoint of the peer, without the TCP session id
+  uint8_t id[OC_TLS_SESSION_ID_MAX_SIZE]; ///< session id (server sessions)
+  uint8_t id_len;
+  bool client;            ///< session of the client side of the handshake
+  oc_uuid_t uuid;         ///< authenticated uuid of the peer
+#ifdef OC_PKI
+  oc_string_t public_key; ///< public key of the peer certificate
+#endif /* OC_PKI */
+  oc_string_t data;       ///< session serialized by mbedtls_ssl_session_save
+  oc_clock_time_t expires;
+} oc_tls_session_t;
+
+/**
+ * @brief Add a session to the cache.
+ *
+ * A session with the same key is replaced. The caller fills the identity and
+ * the data of the returned session.
+ *
+ * @param endpoint endpoint of the peer (cannot be NULL)
+ * @param client true for the client side of the handshake
+ * @param id session id of a server session
+ * @param id_len length of the session id
+ * @return oc_tls_session_t* the new session
+ * @return NULL if resumption is disabled or the session id is invalid
+ */
+oc_tls_session_t *oc_tls_session_cache_add(const oc_endpoint_t *endpoint,
+                                           bool client, const uint8_t *id,
+                                           size_t id_len) OC_NONNULL(1);
+
+/** @brief Find an unexpired server session of the device by session id */
+oc_tls_session_t *oc_tls_session_cache_find_server(size_t device,
+                                                   const uint8_t *id,
+                                                   size_t id_len);
+
+/** @brief Find an unexpired client session with the server endpoint */
+oc_tls_session_t *oc_tls_session_cache_find_client(
+  const oc_endpoint_t *endpoint) OC_NONNULL();
+
+/** @brief Remove a session from the cache */
+void oc_tls_session_cache_remove(oc_tls_session_t *session) OC_NONNULL();
+
+/**
+ * @brief Remove all sessions, must be called whenever a credential that could
+ * have authenticated a session is removed or replaced.
+ */
+void oc_tls_session_cache_clear(void);
+
+/** @brief Number of cached sessions, including expired ones */
+size_t oc_tls_session_cache_size(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OC_SECURITY && OC_TLS_SESSION_RESUMPTION */
+
+#endif /* OC_TLS_SESSION_INTERNAL_H */
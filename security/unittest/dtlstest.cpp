@@ -20,18 +20,32 @@
 
 #include "api/oc_core_res_internal.h"
 #include "api/oc_endpoint_internal.h"
+#include "api/oc_message_internal.h"
+#include "messaging/coap/transactions_internal.h"
 #include "port/oc_clock.h"
 #include "port/oc_log_internal.h"
 #include "security/oc_pstat_internal.h"
 #include "security/oc_tls_internal.h"
 #include "tests/gtest/Device.h"
+#include "tests/gtest/Endpoint.h"
 #include "tests/gtest/tls/DTLS.h"
 #include "tests/gtest/tls/DTLSClient.h"
 #include "util/oc_macros_internal.h"
 
 #include "gtest/gtest.h"
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#ifdef OC_TLS_LOW_MEMORY
+#include <sys/resource.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif /* __GLIBC__ */
+#endif /* OC_TLS_LOW_MEMORY */
 
 // TODO: upgrade mingw, because on v10.2 std::thread doesn't work correctly
 #if defined(__MINGW32__) && defined(__GNUC__) && (__GNUC__ < 12)
@@ -42,6 +56,7 @@
 #endif /* __MINGW32__ */
 
 #include "mbedtls/build_info.h"
+#include "mbedtls/platform.h"
 
 #if defined(MBEDTLS_NET_C) && defined(MBEDTLS_TIMING_C)
 
@@ -163,6 +178,316 @@ TEST_F(TestDTLSWithServer, DTLSInactivityMonitor)
   oc_dtls_set_inactivity_timeout(timeout_default);
 }
 
+#if defined(OC_TLS_LOW_MEMORY) && defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH) &&  \
+  !defined(MINGW_WINTHREAD)
+
+#if defined(__GLIBC__) && defined(MBEDTLS_PLATFORM_MEMORY) &&                \
+  !defined(MBEDTLS_PLATFORM_CALLOC_MACRO) &&                                   \
+  !defined(MBEDTLS_PLATFORM_FREE_MACRO)
+#define COUNT_MBEDTLS_MEMORY
+
+/* Count the heap memory allocated by mbedTLS in the thread of the server (the
+ * thread creating the counter), the clients run in other threads. The blocks
+ * are allocated without a header, so they can be freed after the counter is
+ * removed. */
+class MbedTLSMemoryCounter {
+public:
+  MbedTLSMemoryCounter()
+  {
+    owner_ = std::this_thread::get_id();
+    usage_ = 0;
+    mbedtls_platform_set_calloc_free(Calloc, Free);
+  }
+  ~MbedTLSMemoryCounter() { mbedtls_platform_set_calloc_free(calloc, free); }
+
+  MbedTLSMemoryCounter(const MbedTLSMemoryCounter &) = delete;
+  MbedTLSMemoryCounter &operator=(const MbedTLSMemoryCounter &) = delete;
+
+  // bytes allocated and not freed since the counter was created
+  static int64_t Usage() { return usage_; }
+
+private:
+  static void *Calloc(size_t n, size_t size)
+  {
+    void *ptr = calloc(n, size);
+    if (ptr != nullptr && std::this_thread::get_id() == owner_) {
+      usage_ += static_cast<int64_t>(malloc_usable_size(ptr));
+    }
+    return ptr;
+  }
+
+  static void Free(void *ptr)
+  {
+    if (ptr != nullptr && std::this_thread::get_id() == owner_) {
+      usage_ -= static_cast<int64_t>(malloc_usable_size(ptr));
+    }
+    free(ptr);
+  }
+
+  static inline std::thread::id owner_{};
+  static inline int64_t usage_{ 0 };
+};
+
+#endif /* __GLIBC__ && MBEDTLS_PLATFORM_MEMORY &&                           \
+          !MBEDTLS_PLATFORM_CALLOC_MACRO && !MBEDTLS_PLATFORM_FREE_MACRO */
+
+TEST_F(TestDTLSWithServer, IdleSessionsMemory)
+{
+  constexpr size_t kIdleSessions = 1000;
+  constexpr size_t kBatchSize = 50;
+  // upper bound of the memory held by an idle peer with 1 KiB records
+  constexpr size_t kIdleSessionBudget = 8 * 1024;
+
+  // each client holds a socket
+  rlimit limit{};
+  ASSERT_EQ(0, getrlimit(RLIMIT_NOFILE, &limit));
+  if (limit.rlim_max < kIdleSessions + 64) {
+    GTEST_SKIP() << "limit of open files is too low";
+  }
+  limit.rlim_cur = limit.rlim_max;
+  ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &limit));
+
+  auto epOpt = oc::TestDevice::GetEndpoint(kDeviceID, SECURED, TCP);
+  ASSERT_TRUE(epOpt.has_value());
+  auto port = static_cast<uint16_t>(oc_endpoint_port(&*epOpt));
+
+  oc::tls::PreSharedKey psk = {
+    0xD1, 0xD0, 0xDB, 0x1F, 0x8B, 0xB2, 0x40, 0x55,
+    0x9B, 0x07, 0xB8, 0x76, 0x50, 0x7E, 0x25, 0xCF,
+  };
+  auto hint = oc::tls::AddPresharedKey(kDeviceID, psk);
+  ASSERT_TRUE(hint.has_value());
+
+  // the clients are kept alive, so the ports of the sessions are not reused
+  std::vector<std::unique_ptr<oc::tls::DTLSClient>> clients{};
+#ifdef COUNT_MBEDTLS_MEMORY
+  // the configuration, the transforms and the cipher contexts of the peers are
+  // allocated by mbedTLS
+  MbedTLSMemoryCounter counter{};
+#endif /* COUNT_MBEDTLS_MEMORY */
+  for (size_t i = 0; i < kIdleSessions; i += kBatchSize) {
+    std::atomic<size_t> done{ 0 };
+    std::atomic<size_t> failed{ 0 };
+    std::vector<std::thread> threads{};
+    for (size_t j = 0; j < kBatchSize; ++j) {
+      auto &client =
+        clients.emplace_back(std::make_unique<oc::tls::DTLSClient>());
+      client->SetPresharedKey(psk, *hint);
+      ASSERT_EQ(0, client->SetMaxFragmentLength(MBEDTLS_SSL_MAX_FRAG_LEN_1024));
+      threads.emplace_back([c = client.get(), port, &done, &failed] {
+        if (!c->ConnectWithHandshake("::1", port)) {
+          ++failed;
+        }
+        ++done;
+      });
+    }
+    while (done.load() < kBatchSize) {
+      oc::TestDevice::PoolEventsMs(10);
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    ASSERT_EQ(0, failed.load());
+  }
+
+  ASSERT_EQ(static_cast<int>(kIdleSessions), oc_tls_num_peers(kDeviceID));
+  // the self-reported usage is a lower bound
+  size_t usage = oc_tls_peers_memory_usage(kDeviceID);
+  OC_INFO("%zu idle sessions report %zu bytes", kIdleSessions, usage);
+#ifdef COUNT_MBEDTLS_MEMORY
+  ASSERT_LT(0, MbedTLSMemoryCounter::Usage());
+  size_t allocated = static_cast<size_t>(MbedTLSMemoryCounter::Usage()) +
+                     kIdleSessions * sizeof(oc_tls_peer_t);
+  OC_INFO("%zu idle sessions hold %zu bytes", kIdleSessions, allocated);
+  EXPECT_LE(usage, allocated);
+  usage = allocated;
+#endif /* COUNT_MBEDTLS_MEMORY */
+  EXPECT_GE(kIdleSessions * kIdleSessionBudget, usage);
+}
+
+#endif /* OC_TLS_LOW_MEMORY && MBEDTLS_SSL_MAX_FRAGMENT_LENGTH &&             \
+          !MINGW_WINTHREAD */
+
+#ifdef OC_DTLS_CID
+
+/* Epoch 1 is the first epoch of the records protected by the negotiated keys */
+static constexpr uint64_t kRecordEpoch1 = uint64_t{ 1 } << 48;
+
+TEST_F(TestDTLSWithServer, ConnectionIDLookup)
+{
+  oc_endpoint_t ep = oc::endpoint::FromString("coaps://[::1]:1338");
+  oc_tls_peer_t *peer =
+    oc_tls_add_or_get_peer(&ep, MBEDTLS_SSL_IS_SERVER, nullptr);
+  ASSERT_NE(nullptr, peer);
+
+  oc_message_t *message = oc_allocate_message();
+  ASSERT_NE(nullptr, message);
+  // record with the connection ID received from another address
+  message->endpoint = oc::endpoint::FromString("coaps://[::1]:1339");
+  memset(message->data, 0, 32);
+  message->data[0] = MBEDTLS_SSL_MSG_CID;
+  memcpy(&message->data[11], peer->cid, OC_DTLS_CID_LEN);
+  message->length = 32;
+  EXPECT_EQ(peer, oc_tls_get_peer_by_cid(message));
+
+  // unknown connection ID
+  message->data[11] = static_cast<uint8_t>(~peer->cid[0]);
+  EXPECT_EQ(nullptr, oc_tls_get_peer_by_cid(message));
+  message->data[11] = peer->cid[0];
+
+  // record without a connection ID
+  message->data[0] = MBEDTLS_SSL_MSG_APPLICATION_DATA;
+  EXPECT_EQ(nullptr, oc_tls_get_peer_by_cid(message));
+  message->data[0] = MBEDTLS_SSL_MSG_CID;
+
+  // truncated record
+  message->length = 11 + OC_DTLS_CID_LEN - 1;
+  EXPECT_EQ(nullptr, oc_tls_get_peer_by_cid(message));
+  oc_message_unref(message);
+}
+
+TEST_F(TestDTLSWithServer, ConnectionIDUpdateEndpoint)
+{
+  oc_endpoint_t ep1 = oc::endpoint::FromString("coaps://[::1]:1338");
+  oc_tls_peer_t *peer =
+    oc_tls_add_or_get_peer(&ep1, MBEDTLS_SSL_IS_SERVER, nullptr);
+  ASSERT_NE(nullptr, peer);
+  // an open transaction is moved with the peer
+  std::array<uint8_t, 1> token{ 0x42 };
+  coap_transaction_t *t =
+    coap_new_transaction(42, token.data(), token.size(), &ep1);
+  ASSERT_NE(nullptr, t);
+
+  oc_endpoint_t ep2 = oc::endpoint::FromString("coaps://[::1]:1339");
+  peer->recv_endpoint = ep2;
+  peer->recv_record_seq = kRecordEpoch1 | 5;
+  EXPECT_TRUE(oc_tls_peer_update_endpoint(peer));
+  EXPECT_EQ(0, oc_endpoint_compare(&peer->endpoint, &ep2));
+  EXPECT_EQ(0, oc_endpoint_compare(&peer->prev_endpoints[0], &ep1));
+  EXPECT_EQ(0, oc_endpoint_compare(&t->message->endpoint, &ep2));
+  EXPECT_EQ(peer, oc_tls_get_peer(&ep2));
+  EXPECT_EQ(nullptr, oc_tls_get_peer(&ep1));
+  coap_clear_transaction(t);
+}
+
+TEST_F(TestDTLSWithServer, ConnectionIDStaleRecord)
+{
+  oc_endpoint_t ep1 = oc::endpoint::FromString("coaps://[::1]:1338");
+  oc_tls_peer_t *peer =
+    oc_tls_add_or_get_peer(&ep1, MBEDTLS_SSL_IS_SERVER, nullptr);
+  ASSERT_NE(nullptr, peer);
+
+  oc_endpoint_t ep2 = oc::endpoint::FromString("coaps://[::1]:1339");
+  peer->recv_endpoint = ep2;
+  peer->recv_record_seq = kRecordEpoch1 | 5;
+  ASSERT_TRUE(oc_tls_peer_update_endpoint(peer));
+
+  // a reordered record sent before the move must not move the peer back
+  peer->recv_endpoint = ep1;
+  peer->recv_record_seq = kRecordEpoch1 | 3;
+  EXPECT_FALSE(oc_tls_peer_update_endpoint(peer));
+  EXPECT_EQ(0, oc_endpoint_compare(&peer->endpoint, &ep2));
+
+  // neither can a replayed record from another address
+  oc_endpoint_t ep3 = oc::endpoint::FromString("coaps://[::1]:1340");
+  peer->recv_endpoint = ep3;
+  peer->recv_record_seq = kRecordEpoch1 | 5;
+  EXPECT_FALSE(oc_tls_peer_update_endpoint(peer));
+  EXPECT_EQ(0, oc_endpoint_compare(&peer->endpoint, &ep2));
+
+  // a newer record from the same address keeps the address
+  peer->recv_endpoint = ep2;
+  peer->recv_record_seq = kRecordEpoch1 | 6;
+  EXPECT_FALSE(oc_tls_peer_update_endpoint(peer));
+  EXPECT_EQ(kRecordEpoch1 | 6, peer->max_record_seq);
+
+  // the record from epoch 2 is newer than any record from epoch 1
+  peer->recv_endpoint = ep3;
+  peer->recv_record_seq = (uint64_t{ 2 } << 48) | 1;
+  EXPECT_TRUE(oc_tls_peer_update_endpoint(peer));
+  EXPECT_EQ(0, oc_endpoint_compare(&peer->endpoint, &ep3));
+}
+
+#if defined(MBEDTLS_SSL_DTLS_CONNECTION_ID) && !defined(MINGW_WINTHREAD)
+
+TEST_F(TestDTLSWithServer, ConnectionIDRebind)
+{
+  auto epOpt = oc::TestDevice::GetEndpoint(kDeviceID, SECURED, TCP);
+  ASSERT_TRUE(epOpt.has_value());
+  auto port = static_cast<uint16_t>(oc_endpoint_port(&*epOpt));
+
+  oc::tls::PreSharedKey psk = {
+    0xD1, 0xD0, 0xDB, 0x1F, 0x8B, 0xB2, 0x40, 0x55,
+    0x9B, 0x07, 0xB8, 0x76, 0x50, 0x7E, 0x25, 0xCF,
+  };
+  auto hint = oc::tls::AddPresharedKey(kDeviceID, psk);
+  ASSERT_TRUE(hint.has_value());
+
+  oc::tls::DTLSClient dtls{};
+  dtls.SetPresharedKey(psk, *hint);
+  ASSERT_EQ(0, dtls.EnableConnectionID());
+
+  enum class Step : int {
+    INIT,
+    HANDSHAKE_DONE,
+    REBIND,
+    SENT,
+    ERROR,
+  };
+  std::atomic<Step> step{ Step::INIT };
+  std::thread dtls_thread{ [&dtls, &step, port] {
+    if (!dtls.ConnectWithHandshake("::1", port)) {
+      step.store(Step::ERROR);
+      return;
+    }
+    step.store(Step::HANDSHAKE_DONE);
+    while (step.load() != Step::REBIND) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    // the client moves to another port (e.g. a NAT rebinding)
+    if (dtls.Reconnect("::1", port) != 0) {
+      step.store(Step::ERROR);
+      return;
+    }
+    // empty confirmable CoAP message (ping)
+    std::array<uint8_t, 4> ping{ 0x40, 0x00, 0x00, 0x01 };
+    if (dtls.Write(ping.data(), ping.size()) < 0) {
+      step.store(Step::ERROR);
+      return;
+    }
+    step.store(Step::SENT);
+  } };
+
+  while (step.load() == Step::INIT) {
+    oc::TestDevice::PoolEventsMs(50);
+  }
+  bool handshake = step.load() == Step::HANDSHAKE_DONE;
+  oc_endpoint_t before{};
+  oc_tls_peer_t *peer = oc_tls_get_peer(nullptr);
+  if (peer != nullptr) {
+    before = peer->endpoint;
+  }
+  step.store(Step::REBIND);
+  for (int i = 0; i < 40 && peer != nullptr &&
+                  oc_endpoint_compare(&peer->endpoint, &before) == 0;
+       ++i) {
+    oc::TestDevice::PoolEventsMs(50);
+  }
+  dtls_thread.join();
+
+  ASSERT_TRUE(handshake);
+  ASSERT_NE(nullptr, peer);
+  EXPECT_EQ(Step::SENT, step.load());
+  // the record was routed to the existing peer by the connection ID
+  EXPECT_EQ(1, oc_tls_num_peers(kDeviceID));
+  EXPECT_NE(oc_endpoint_port(&before), oc_endpoint_port(&peer->endpoint));
+  EXPECT_EQ(0, oc_endpoint_compare(&peer->prev_endpoints[0], &before));
+}
+
+#endif /* MBEDTLS_SSL_DTLS_CONNECTION_ID && !MINGW_WINTHREAD */
+
+#endif /* OC_DTLS_CID */
+
 #endif /* MBEDTLS_NET_C && MBEDTLS_TIMING_C */
 
 #endif /* OC_SECURITY */
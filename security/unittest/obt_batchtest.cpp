@@ -0,0 +1,279 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "oc_config.h"
+
+#if defined(OC_SECURITY) && defined(OC_CLIENT) &&                              \
+  defined(OC_DYNAMIC_ALLOCATION)
+
+#include "api/oc_core_res_internal.h"
+#include "api/oc_ri_internal.h"
+#include "api/oc_runtime_internal.h"
+#include "oc_api.h"
+#include "oc_obt.h"
+#include "oc_uuid.h"
+#include "port/oc_network_event_handler_internal.h"
+#include "security/oc_obt_internal.h"
+#include "security/oc_pstat_internal.h"
+#include "security/oc_svr_internal.h"
+#include "security/oc_tls_internal.h"
+#include "tests/gtest/Endpoint.h"
+
+#ifdef OC_HAS_FEATURE_PUSH
+#include "api/oc_push_internal.h"
+#endif /* OC_HAS_FEATURE_PUSH */
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#endif /* _WIN32 */
+
+static constexpr size_t kDeviceID{ 0 };
+static const std::string kDeviceURI{ "/oic/d" };
+static const std::string kDeviceType{ "oic.d.obt" };
+static const std::string kDeviceName{ "OBT" };
+static const std::string kOCFSpecVersion{ "ocf.1.0.0" };
+static const std::string kOCFDataModelVersion{ "ocf.res.1.0.0" };
+
+struct BatchResult
+{
+  std::vector<oc_uuid_t> devices{};
+  std::vector<oc_obt_batch_step_t> steps{};
+  size_t done{ 0 };
+  size_t failed{ 0 };
+  size_t total{ 0 };
+  size_t progress{ 0 };
+  bool finished{ false };
+};
+
+class TestObtBatch : public testing::Test {
+public:
+  void TearDown() override { oc_obt_batch_shutdown(); }
+
+  static std::vector<oc_uuid_t> GenerateUUIDs(size_t count)
+  {
+    std::vector<oc_uuid_t> uuids(count);
+    for (auto &uuid : uuids) {
+      oc_gen_uuid(&uuid);
+    }
+    return uuids;
+  }
+
+  static void OnDevice(const oc_uuid_t *uuid, oc_obt_batch_step_t step,
+                       int status, void *data)
+  {
+    auto *result = static_cast<BatchResult *>(data);
+    EXPECT_FALSE(result->finished);
+    EXPECT_EQ(-1, status);
+    result->devices.push_back(*uuid);
+    result->steps.push_back(step);
+  }
+
+  static void OnProgress(size_t done, size_t failed, size_t total, void *data)
+  {
+    auto *result = static_cast<BatchResult *>(data);
+    EXPECT_FALSE(result->finished);
+    EXPECT_LT(result->done, done);
+    EXPECT_EQ(result->devices.size(), done);
+    result->done = done;
+    result->failed = failed;
+    result->total = total;
+    ++result->progress;
+    if (done == total) {
+      EXPECT_FALSE(oc_obt_batch_is_running());
+      result->finished = true;
+    }
+  }
+};
+
+TEST_F(TestObtBatch, InvalidArguments)
+{
+  auto uuids = GenerateUUIDs(1);
+  oc_obt_batch_plan_t plan{};
+  EXPECT_EQ(-1, oc_obt_batch_onboard(nullptr, 1, &plan, OnDevice, nullptr,
+                                     nullptr));
+  EXPECT_EQ(-1, oc_obt_batch_onboard(uuids.data(), 0, &plan, OnDevice,
+                                     nullptr, nullptr));
+  EXPECT_EQ(-1, oc_obt_batch_onboard(uuids.data(), 1, nullptr, OnDevice,
+                                     nullptr, nullptr));
+  EXPECT_EQ(-1, oc_obt_batch_onboard(uuids.data(), 1, &plan, nullptr, nullptr,
+                                     nullptr));
+  EXPECT_FALSE(oc_obt_batch_is_running());
+}
+
+TEST_F(TestObtBatch, UnknownDevices)
+{
+  // devices that were not discovered fail at the ownership transfer
+  auto uuids = GenerateUUIDs(5);
+  oc_obt_batch_plan_t plan{};
+  plan.max_in_flight = 2;
+  BatchResult result{};
+  ASSERT_EQ(0, oc_obt_batch_onboard(uuids.data(), uuids.size(), &plan,
+                                    OnDevice, OnProgress, &result));
+  EXPECT_FALSE(oc_obt_batch_is_running());
+  ASSERT_TRUE(result.finished);
+  EXPECT_EQ(uuids.size(), result.progress);
+  EXPECT_EQ(uuids.size(), result.total);
+  EXPECT_EQ(uuids.size(), result.failed);
+  ASSERT_EQ(uuids.size(), result.devices.size());
+  for (size_t i = 0; i < uuids.size(); ++i) {
+    // devices are started in the order of the list
+    EXPECT_TRUE(oc_uuid_is_equal(uuids[i], result.devices[i]));
+    EXPECT_EQ(OC_OBT_BATCH_STEP_OTM, result.steps[i]);
+  }
+}
+
+TEST_F(TestObtBatch, SingleBatch)
+{
+  auto uuids = GenerateUUIDs(3);
+  oc_obt_batch_plan_t plan{};
+  static oc_obt_batch_plan_t nested_plan{};
+  static std::vector<oc_uuid_t> nested_uuids{};
+  nested_uuids = GenerateUUIDs(1);
+  BatchResult result{};
+  ASSERT_EQ(0, oc_obt_batch_onboard(
+                 uuids.data(), uuids.size(), &plan,
+                 [](const oc_uuid_t *, oc_obt_batch_step_t, int, void *) {
+                   // another batch cannot start while one is running
+                   EXPECT_TRUE(oc_obt_batch_is_running());
+                   EXPECT_EQ(-1, oc_obt_batch_onboard(
+                                   nested_uuids.data(), nested_uuids.size(),
+                                   &nested_plan, OnDevice, nullptr, nullptr));
+                 },
+                 [](size_t done, size_t, size_t total, void *data) {
+                   if (done < total) {
+                     return;
+                   }
+                   // the finished batch is released before the last progress
+                   auto *result = static_cast<BatchResult *>(data);
+                   EXPECT_EQ(0, oc_obt_batch_onboard(
+                                  nested_uuids.data(), nested_uuids.size(),
+                                  &nested_plan, OnDevice, OnProgress, result));
+                 },
+                 &result));
+  EXPECT_FALSE(oc_obt_batch_is_running());
+  EXPECT_TRUE(result.finished);
+  ASSERT_EQ(1, result.devices.size());
+  EXPECT_TRUE(oc_uuid_is_equal(nested_uuids[0], result.devices[0]));
+}
+
+class TestObtKeepConnection : public testing::Test {
+public:
+  static void SetUpTestCase()
+  {
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif /* _WIN32 */
+
+    oc_network_event_handler_mutex_init();
+    oc_runtime_init();
+    oc_ri_init();
+    oc_core_init();
+    ASSERT_EQ(0, oc_add_device(kDeviceURI.c_str(), kDeviceType.c_str(),
+                               kDeviceName.c_str(), kOCFSpecVersion.c_str(),
+                               kOCFDataModelVersion.c_str(), nullptr, nullptr));
+    oc_sec_svr_create();
+
+    oc_sec_pstat_t *pstat = oc_sec_get_pstat(kDeviceID);
+    pstat->s = OC_DOS_RFNOP;
+  }
+
+  static void TearDownTestCase()
+  {
+    oc_sec_svr_free();
+#ifdef OC_HAS_FEATURE_PUSH
+    oc_push_free();
+#endif /* OC_HAS_FEATURE_PUSH */
+    oc_connectivity_shutdown(kDeviceID);
+    oc_core_shutdown();
+    oc_ri_shutdown();
+    oc_runtime_shutdown();
+    oc_network_event_handler_mutex_destroy();
+
+#ifdef _WIN32
+    WSACleanup();
+#endif /* _WIN32 */
+  }
+
+  void SetUp() override { oc_tls_init_context(); }
+
+  void TearDown() override
+  {
+    oc_obt_shutdown();
+    oc_tls_shutdown();
+  }
+};
+
+TEST_F(TestObtKeepConnection, UnknownDevice)
+{
+  oc_uuid_t uuid;
+  oc_gen_uuid(&uuid);
+  EXPECT_FALSE(oc_obt_device_keep_connection(&uuid, true));
+}
+
+TEST_F(TestObtKeepConnection, CloseAfterStep)
+{
+  oc_uuid_t uuid;
+  oc_gen_uuid(&uuid);
+  oc_endpoint_t ep = oc::endpoint::FromString("coaps://[ff02::61]:1361");
+  oc_device_t *device = oc_obt_add_owned_device(&uuid, &ep);
+  ASSERT_NE(nullptr, device);
+
+  // by default the connection is closed at the end of each step
+  ASSERT_NE(nullptr,
+            oc_tls_add_or_get_peer(&ep, MBEDTLS_SSL_IS_CLIENT, nullptr));
+  oc_obt_close_device_connection(device);
+  EXPECT_EQ(nullptr, oc_tls_get_peer(&ep));
+
+  // the selection of a step that did not connect yet is released
+  oc_tls_select_anon_ciphersuite();
+  oc_tls_bind_selection(&ep);
+  ASSERT_EQ(1U, oc_tls_num_selections());
+  oc_obt_close_device_connection(device);
+  EXPECT_EQ(0U, oc_tls_num_selections());
+}
+
+TEST_F(TestObtKeepConnection, KeepAcrossSteps)
+{
+  oc_uuid_t uuid;
+  oc_gen_uuid(&uuid);
+  oc_endpoint_t ep = oc::endpoint::FromString("coaps://[ff02::62]:1362");
+  oc_device_t *device = oc_obt_add_owned_device(&uuid, &ep);
+  ASSERT_NE(nullptr, device);
+  ASSERT_TRUE(oc_obt_device_keep_connection(&uuid, true));
+
+  // the session established by the first step is reused by the next ones
+  oc_tls_peer_t *peer =
+    oc_tls_add_or_get_peer(&ep, MBEDTLS_SSL_IS_CLIENT, nullptr);
+  ASSERT_NE(nullptr, peer);
+  for (int i = 0; i < 3; ++i) {
+    oc_obt_close_device_connection(device);
+    EXPECT_EQ(peer, oc_tls_get_peer(&ep));
+  }
+
+  // the connection is closed when the device finishes
+  ASSERT_TRUE(oc_obt_device_keep_connection(&uuid, false));
+  EXPECT_EQ(nullptr, oc_tls_get_peer(&ep));
+}
+
+#endif /* OC_SECURITY && OC_CLIENT && OC_DYNAMIC_ALLOCATION */
@@ -0,0 +1,134 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#if defined(OC_SECURITY) && defined(OC_PKI) && defined(OC_TLS_ASYNC_CRYPTO)
+
+#include "port/oc_network_event_handler_internal.h"
+#include "security/oc_tls_async_internal.h"
+#include "security/oc_tls_internal.h"
+
+#include "gtest/gtest.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/ssl.h"
+
+#include <array>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+class TestTLSAsync : public testing::Test {
+public:
+  void SetUp() override
+  {
+    oc_network_event_handler_mutex_init();
+    // starts the crypto workers
+    ASSERT_EQ(0, oc_tls_init_context());
+    mbedtls_pk_init(&pk_);
+    ASSERT_EQ(0, mbedtls_pk_setup(&pk_, mbedtls_pk_info_from_type(
+                                          MBEDTLS_PK_ECKEY)));
+    ASSERT_EQ(0,
+              mbedtls_ecp_gen_key(MBEDTLS_ECP_DP_SECP256R1, mbedtls_pk_ec(pk_),
+                                  mbedtls_ctr_drbg_random,
+                                  oc_tls_ctr_drbg_context()));
+    hash_.fill(0x42);
+  }
+
+  void TearDown() override
+  {
+    mbedtls_pk_free(&pk_);
+    oc_tls_shutdown();
+    oc_network_event_handler_mutex_destroy();
+  }
+
+  static int WaitForResult(oc_tls_async_job_t *job, uint8_t *output,
+                           size_t *output_len, size_t output_size)
+  {
+    for (int i = 0; i < 500; ++i) {
+      int ret = oc_tls_async_result(job, output, output_len, output_size);
+      if (ret != MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS) {
+        return ret;
+      }
+      std::this_thread::sleep_for(10ms);
+    }
+    return MBEDTLS_ERR_SSL_ASYNC_IN_PROGRESS;
+  }
+
+  mbedtls_pk_context pk_;
+  std::array<uint8_t, 32> hash_{};
+};
+
+TEST_F(TestTLSAsync, Sign)
+{
+  oc_tls_async_job_t *job = oc_tls_async_sign(
+    &pk_, MBEDTLS_MD_SHA256, hash_.data(), hash_.size(), nullptr);
+  ASSERT_NE(nullptr, job);
+  std::array<uint8_t, MBEDTLS_ECDSA_MAX_LEN> sig{};
+  size_t sig_len = 0;
+  ASSERT_EQ(0, WaitForResult(job, sig.data(), &sig_len, sig.size()));
+  EXPECT_EQ(0, mbedtls_pk_verify(&pk_, MBEDTLS_MD_SHA256, hash_.data(),
+                                 hash_.size(), sig.data(), sig_len));
+}
+
+TEST_F(TestTLSAsync, Sign_F)
+{
+  // the output buffer is too small
+  oc_tls_async_job_t *job = oc_tls_async_sign(
+    &pk_, MBEDTLS_MD_SHA256, hash_.data(), hash_.size(), nullptr);
+  ASSERT_NE(nullptr, job);
+  std::array<uint8_t, 1> sig{};
+  size_t sig_len = 0;
+  EXPECT_EQ(MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL,
+            WaitForResult(job, sig.data(), &sig_len, sig.size()));
+
+  // not an EC key
+  mbedtls_pk_context empty;
+  mbedtls_pk_init(&empty);
+  EXPECT_EQ(nullptr, oc_tls_async_sign(&empty, MBEDTLS_MD_SHA256, hash_.data(),
+                                       hash_.size(), nullptr));
+
+  // the pool is not running
+  oc_tls_async_stop();
+  EXPECT_EQ(nullptr, oc_tls_async_sign(&pk_, MBEDTLS_MD_SHA256, hash_.data(),
+                                       hash_.size(), nullptr));
+}
+
+TEST_F(TestTLSAsync, QueueFull)
+{
+  std::vector<oc_tls_async_job_t *> jobs;
+  for (int i = 0; i < OC_TLS_ASYNC_CRYPTO_QUEUE_SIZE; ++i) {
+    oc_tls_async_job_t *job = oc_tls_async_sign(
+      &pk_, MBEDTLS_MD_SHA256, hash_.data(), hash_.size(), nullptr);
+    ASSERT_NE(nullptr, job);
+    jobs.push_back(job);
+  }
+  // the caller signs synchronously
+  EXPECT_EQ(nullptr, oc_tls_async_sign(&pk_, MBEDTLS_MD_SHA256, hash_.data(),
+                                       hash_.size(), nullptr));
+
+  // cancel pending, running and finished jobs
+  for (auto *job : jobs) {
+    oc_tls_async_cancel(job);
+  }
+  EXPECT_NE(nullptr, oc_tls_async_sign(&pk_, MBEDTLS_MD_SHA256, hash_.data(),
+                                       hash_.size(), nullptr));
+  // unfinished jobs are released by the shutdown
+}
+
+#endif /* OC_SECURITY && OC_PKI && OC_TLS_ASYNC_CRYPTO */
@@ -20,6 +20,7 @@
 
 #include "api/oc_core_res_internal.h"
 #include "api/oc_endpoint_internal.h"
+#include "api/oc_message_internal.h"
 #include "api/oc_ri_internal.h"
 #include "api/oc_runtime_internal.h"
 #include "oc_api.h"
@@ -45,6 +46,7 @@
 #include "mbedtls/x509_crt.h"
 
 #include <array>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -237,6 +239,170 @@ TEST_F(TestTLSPeer, ClearPeers)
   ASSERT_EQ(0, oc_tls_num_peers(kDeviceID));
 }
 
+#ifdef OC_DYNAMIC_ALLOCATION
+
+TEST_F(TestTLSPeer, SharedConfig)
+{
+  oc_endpoint_t ep1 = oc::endpoint::FromString("coaps://[ff02::43]:1338");
+  oc_tls_peer_t *server1 =
+    oc_tls_add_or_get_peer(&ep1, MBEDTLS_SSL_IS_SERVER, nullptr);
+  ASSERT_NE(nullptr, server1);
+  oc_endpoint_t ep2 = oc::endpoint::FromString("coaps://[ff02::44]:1339");
+  oc_tls_peer_t *server2 =
+    oc_tls_add_or_get_peer(&ep2, MBEDTLS_SSL_IS_SERVER, nullptr);
+  ASSERT_NE(nullptr, server2);
+  // peers with the same device, role and transport share the configuration
+  EXPECT_EQ(server1->config, server2->config);
+  EXPECT_EQ(1U, oc_tls_num_configs());
+
+  oc_endpoint_t ep3 = oc::endpoint::FromString("coaps://[ff02::45]:1340");
+  oc_tls_peer_t *client =
+    oc_tls_add_or_get_peer(&ep3, MBEDTLS_SSL_IS_CLIENT, nullptr);
+  ASSERT_NE(nullptr, client);
+  EXPECT_NE(server1->config, client->config);
+  EXPECT_EQ(2U, oc_tls_num_configs());
+
+  // the configuration is cached after its peers are freed
+  oc_tls_close_connection(&ep3);
+  EXPECT_EQ(2U, oc_tls_num_configs());
+  client = oc_tls_add_or_get_peer(&ep3, MBEDTLS_SSL_IS_CLIENT, nullptr);
+  ASSERT_NE(nullptr, client);
+  EXPECT_EQ(2U, oc_tls_num_configs());
+
+  // invalidated configurations are kept until their last peer is freed
+  oc_tls_invalidate_configs();
+  EXPECT_EQ(2U, oc_tls_num_configs());
+  oc_endpoint_t ep4 = oc::endpoint::FromString("coaps://[ff02::46]:1341");
+  oc_tls_peer_t *server3 =
+    oc_tls_add_or_get_peer(&ep4, MBEDTLS_SSL_IS_SERVER, nullptr);
+  ASSERT_NE(nullptr, server3);
+  EXPECT_NE(server1->config, server3->config);
+  EXPECT_EQ(3U, oc_tls_num_configs());
+
+  oc_tls_close_peers(nullptr, nullptr);
+  EXPECT_EQ(1U, oc_tls_num_configs());
+}
+
+#endif /* OC_DYNAMIC_ALLOCATION */
+
+TEST_F(TestTLSPeer, MemoryUsage)
+{
+  EXPECT_EQ(0U, oc_tls_peers_memory_usage(kDeviceID));
+
+  oc_endpoint_t ep = oc::endpoint::FromString("coaps://[ff02::43]:1338");
+  oc_tls_peer_t *peer =
+    oc_tls_add_or_get_peer(&ep, MBEDTLS_SSL_IS_SERVER, nullptr);
+  ASSERT_NE(nullptr, peer);
+
+  oc_tls_peer_memory_t report{};
+  size_t usage = oc_tls_peer_memory_usage(peer, &report);
+  EXPECT_EQ(sizeof(oc_tls_peer_t), report.peer);
+  EXPECT_LT(0U, report.buffers);
+  EXPECT_EQ(0U, report.peer_cert);
+  // the handshake has not started
+  EXPECT_TRUE(report.handshake);
+  EXPECT_EQ(report.peer + report.buffers + report.session + report.peer_cert,
+            usage);
+  EXPECT_EQ(usage, oc_tls_peer_memory_usage(peer, nullptr));
+  EXPECT_EQ(usage, oc_tls_peers_memory_usage(kDeviceID));
+
+  oc_tls_close_peers(nullptr, nullptr);
+  EXPECT_EQ(0U, oc_tls_peers_memory_usage(kDeviceID));
+}
+
+#ifdef OC_CLIENT
+
+TEST_F(TestTLSPeer, BindSelection)
+{
+  oc_endpoint_t ep1 = oc::endpoint::FromString("coaps://[ff02::51]:1351");
+  oc_endpoint_t ep2 = oc::endpoint::FromString("coaps://[ff02::52]:1352");
+  oc_endpoint_t ep3 = oc::endpoint::FromString("coaps://[ff02::53]:1353");
+
+  // nothing is bound without a selection
+  oc_tls_bind_selection(&ep1);
+  EXPECT_EQ(0U, oc_tls_num_selections());
+
+  oc_tls_select_anon_ciphersuite();
+  oc_tls_bind_selection(&ep1);
+  EXPECT_EQ(1U, oc_tls_num_selections());
+
+  // the selection was moved to the endpoint, a peer for another endpoint
+  // doesn't use it
+  oc_tls_peer_t *peer2 =
+    oc_tls_add_or_get_peer(&ep2, MBEDTLS_SSL_IS_CLIENT, nullptr);
+  ASSERT_NE(nullptr, peer2);
+  EXPECT_EQ(1U, oc_tls_num_selections());
+
+  oc_tls_peer_t *peer1 =
+    oc_tls_add_or_get_peer(&ep1, MBEDTLS_SSL_IS_CLIENT, nullptr);
+  ASSERT_NE(nullptr, peer1);
+  EXPECT_EQ(0U, oc_tls_num_selections());
+  EXPECT_NE(peer1->config, peer2->config);
+
+  // the same global selection gives the same configuration
+  oc_tls_select_anon_ciphersuite();
+  oc_tls_peer_t *peer3 =
+    oc_tls_add_or_get_peer(&ep3, MBEDTLS_SSL_IS_CLIENT, nullptr);
+  ASSERT_NE(nullptr, peer3);
+  EXPECT_EQ(peer1->config, peer3->config);
+
+  // the selection is not bound to an endpoint with a peer
+  oc_tls_select_anon_ciphersuite();
+  oc_tls_bind_selection(&ep1);
+  EXPECT_EQ(0U, oc_tls_num_selections());
+  oc_tls_reset_ciphersuite();
+
+  oc_tls_close_peers(nullptr, nullptr);
+}
+
+TEST_F(TestTLSPeer, ReleaseSelection)
+{
+  oc_endpoint_t ep1 = oc::endpoint::FromString("coaps://[ff02::51]:1351");
+  oc_endpoint_t ep2 = oc::endpoint::FromString("coaps://[ff02::52]:1352");
+
+  // released when the connection is closed before the peer is created
+  oc_tls_select_anon_ciphersuite();
+  oc_tls_bind_selection(&ep1);
+  ASSERT_EQ(1U, oc_tls_num_selections());
+  oc_tls_close_connection(&ep1);
+  EXPECT_EQ(0U, oc_tls_num_selections());
+
+  oc_tls_peer_t *peer2 =
+    oc_tls_add_or_get_peer(&ep2, MBEDTLS_SSL_IS_CLIENT, nullptr);
+  ASSERT_NE(nullptr, peer2);
+  // the released selection is not used by the next peer of the endpoint
+  oc_tls_peer_t *peer1 =
+    oc_tls_add_or_get_peer(&ep1, MBEDTLS_SSL_IS_CLIENT, nullptr);
+  ASSERT_NE(nullptr, peer1);
+  EXPECT_EQ(peer1->config, peer2->config);
+  oc_tls_close_peers(nullptr, nullptr);
+
+  // released when the request is dropped
+  oc_tls_select_anon_ciphersuite();
+  oc_tls_bind_selection(&ep1);
+  ASSERT_EQ(1U, oc_tls_num_selections());
+  oc_tls_release_selection(&ep2);
+  EXPECT_EQ(1U, oc_tls_num_selections());
+  oc_tls_release_selection(&ep1);
+  EXPECT_EQ(0U, oc_tls_num_selections());
+
+  // released when the device is not ready for the connection
+  oc_sec_pstat_t *pstat = oc_sec_get_pstat(kDeviceID);
+  pstat->s = OC_DOS_RFOTM;
+  oc_tls_select_anon_ciphersuite();
+  oc_message_t *msg = oc_message_allocate_outgoing();
+  ASSERT_NE(nullptr, msg);
+  memcpy(&msg->endpoint, &ep1, sizeof(oc_endpoint_t));
+  oc_tls_bind_selection(&msg->endpoint);
+  ASSERT_EQ(1U, oc_tls_num_selections());
+  EXPECT_EQ(0, oc_tls_send_message(msg));
+  EXPECT_EQ(0U, oc_tls_num_selections());
+  EXPECT_EQ(nullptr, oc_tls_get_peer(&ep1));
+  pstat->s = OC_DOS_RFNOP;
+}
+
+#endif /* OC_CLIENT */
+
 #ifdef OC_PKI
 
 TEST_F(TestTLSPeer, VerifyCertificate)
@@ -246,16 +412,16 @@ TEST_F(TestTLSPeer, VerifyCertificate)
     oc_tls_add_or_get_peer(&ep, MBEDTLS_SSL_IS_SERVER, nullptr);
   ASSERT_NE(nullptr, peer);
   ASSERT_EQ(MBEDTLS_SSL_IS_SERVER, peer->role);
-  ASSERT_NE(nullptr, peer->ssl_conf.f_vrfy);
-  ASSERT_EQ(-1, peer->ssl_conf.f_vrfy(nullptr, nullptr, 0, nullptr));
+  ASSERT_NE(nullptr, peer->ssl_ctx.f_vrfy);
+  ASSERT_EQ(-1, peer->ssl_ctx.f_vrfy(nullptr, nullptr, 0, nullptr));
 
   oc_pki_verify_certificate_cb_t verify_certificate = peer->verify_certificate;
   peer->verify_certificate = nullptr;
-  ASSERT_EQ(-1, peer->ssl_conf.f_vrfy(peer, nullptr, 0, nullptr));
+  ASSERT_EQ(-1, peer->ssl_ctx.f_vrfy(peer, nullptr, 0, nullptr));
 
   mbedtls_x509_crt crt{};
   peer->verify_certificate = verify_certificate;
-  ASSERT_EQ(-1, peer->ssl_conf.f_vrfy(peer, &crt, 1, nullptr));
+  ASSERT_EQ(-1, peer->ssl_ctx.f_vrfy(peer, &crt, 1, nullptr));
 }
 
 #endif /* OC_PKI */
@@ -0,0 +1,171 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#if defined(OC_SECURITY) && defined(OC_TLS_SESSION_RESUMPTION)
+
+#include "oc_api.h"
+#include "security/oc_tls_session_internal.h"
+#include "tests/gtest/Endpoint.h"
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+class TestTLSSession : public testing::Test {
+public:
+  void SetUp() override
+  {
+    oc_tls_session_cache_clear();
+    oc_tls_set_session_lifetime(OC_TLS_SESSION_LIFETIME);
+  }
+
+  void TearDown() override
+  {
+    oc_tls_session_cache_clear();
+    oc_tls_set_session_lifetime(OC_TLS_SESSION_LIFETIME);
+  }
+
+  static std::array<uint8_t, OC_TLS_SESSION_ID_MAX_SIZE> SessionID(uint8_t val)
+  {
+    std::array<uint8_t, OC_TLS_SESSION_ID_MAX_SIZE> id{};
+    id.fill(val);
+    return id;
+  }
+};
+
+TEST_F(TestTLSSession, Server)
+{
+  oc_endpoint_t ep = oc::endpoint::FromString("coaps://[ff02::158]:1234");
+  auto id = SessionID(1);
+  oc_tls_session_t *s =
+    oc_tls_session_cache_add(&ep, false, id.data(), id.size());
+  ASSERT_NE(nullptr, s);
+  EXPECT_EQ(s,
+            oc_tls_session_cache_find_server(ep.device, id.data(), id.size()));
+  // the session is not visible to a client or another device
+  EXPECT_EQ(nullptr, oc_tls_session_cache_find_client(&ep));
+  EXPECT_EQ(nullptr, oc_tls_session_cache_find_server(ep.device + 1, id.data(),
+                                                      id.size()));
+  auto other = SessionID(2);
+  EXPECT_EQ(nullptr, oc_tls_session_cache_find_server(ep.device, other.data(),
+                                                      other.size()));
+
+  // adding a session with the same id replaces the session
+  ASSERT_NE(nullptr,
+            oc_tls_session_cache_add(&ep, false, id.data(), id.size()));
+  EXPECT_EQ(1, oc_tls_session_cache_size());
+
+  oc_tls_session_cache_remove(
+    oc_tls_session_cache_find_server(ep.device, id.data(), id.size()));
+  EXPECT_EQ(0, oc_tls_session_cache_size());
+}
+
+TEST_F(TestTLSSession, Server_F)
+{
+  oc_endpoint_t ep = oc::endpoint::FromString("coaps://[ff02::158]:1234");
+  // server sessions require a session id
+  EXPECT_EQ(nullptr, oc_tls_session_cache_add(&ep, false, nullptr, 0));
+  std::array<uint8_t, OC_TLS_SESSION_ID_MAX_SIZE + 1> id{};
+  EXPECT_EQ(nullptr,
+            oc_tls_session_cache_add(&ep, false, id.data(), id.size()));
+}
+
+TEST_F(TestTLSSession, Client)
+{
+  oc_endpoint_t ep = oc::endpoint::FromString("coaps+tcp://[ff02::158]:1234");
+  ep.session_id = 42;
+  oc_tls_session_t *s = oc_tls_session_cache_add(&ep, true, nullptr, 0);
+  ASSERT_NE(nullptr, s);
+
+  // a new connection to the same server finds the session
+  ep.session_id = 43;
+  EXPECT_EQ(s, oc_tls_session_cache_find_client(&ep));
+
+  oc_endpoint_t other =
+    oc::endpoint::FromString("coaps+tcp://[ff02::158]:4321");
+  EXPECT_EQ(nullptr, oc_tls_session_cache_find_client(&other));
+
+  ASSERT_NE(nullptr, oc_tls_session_cache_add(&ep, true, nullptr, 0));
+  EXPECT_EQ(1, oc_tls_session_cache_size());
+}
+
+TEST_F(TestTLSSession, Evict)
+{
+  oc_endpoint_t ep = oc::endpoint::FromString("coaps://[ff02::158]:1234");
+  for (int i = 0; i < OC_TLS_SESSION_CACHE_SIZE + 1; ++i) {
+    auto id = SessionID(static_cast<uint8_t>(i));
+    ASSERT_NE(nullptr,
+              oc_tls_session_cache_add(&ep, false, id.data(), id.size()));
+    // distinct expiration times
+    std::this_thread::sleep_for(2ms);
+  }
+  EXPECT_EQ(OC_TLS_SESSION_CACHE_SIZE, oc_tls_session_cache_size());
+  // the oldest session was evicted
+  auto first = SessionID(0);
+  EXPECT_EQ(nullptr, oc_tls_session_cache_find_server(ep.device, first.data(),
+                                                      first.size()));
+  auto last = SessionID(OC_TLS_SESSION_CACHE_SIZE);
+  EXPECT_NE(nullptr, oc_tls_session_cache_find_server(ep.device, last.data(),
+                                                      last.size()));
+}
+
+TEST_F(TestTLSSession, Lifetime)
+{
+  oc_tls_set_session_lifetime(1);
+  EXPECT_EQ(1, oc_tls_session_lifetime());
+  oc_endpoint_t ep = oc::endpoint::FromString("coaps://[ff02::158]:1234");
+  auto id = SessionID(1);
+  ASSERT_NE(nullptr,
+            oc_tls_session_cache_add(&ep, false, id.data(), id.size()));
+  ASSERT_NE(nullptr, oc_tls_session_cache_add(&ep, true, nullptr, 0));
+
+  std::this_thread::sleep_for(1100ms);
+  EXPECT_EQ(nullptr,
+            oc_tls_session_cache_find_server(ep.device, id.data(), id.size()));
+  EXPECT_EQ(nullptr, oc_tls_session_cache_find_client(&ep));
+  EXPECT_EQ(0, oc_tls_session_cache_size());
+
+  // zero lifetime disables resumption and drops the cached sessions
+  ASSERT_NE(nullptr,
+            oc_tls_session_cache_add(&ep, false, id.data(), id.size()));
+  oc_tls_set_session_lifetime(0);
+  EXPECT_EQ(0, oc_tls_session_cache_size());
+  EXPECT_EQ(nullptr,
+            oc_tls_session_cache_add(&ep, false, id.data(), id.size()));
+}
+
+TEST_F(TestTLSSession, Clear)
+{
+  oc_endpoint_t ep = oc::endpoint::FromString("coaps://[ff02::158]:1234");
+  auto id = SessionID(1);
+  oc_tls_session_t *s =
+    oc_tls_session_cache_add(&ep, false, id.data(), id.size());
+  ASSERT_NE(nullptr, s);
+  oc_alloc_string(&s->data, 16);
+  ASSERT_NE(nullptr, oc_tls_session_cache_add(&ep, true, nullptr, 0));
+
+  oc_tls_session_cache_clear();
+  EXPECT_EQ(0, oc_tls_session_cache_size());
+}
+
+#endif /* OC_SECURITY && OC_TLS_SESSION_RESUMPTION */
@@ -330,7 +330,7 @@ typedef struct oc_collection_s oc_collection_t;
 %ignore oc_collection_free;
 %ignore oc_collection_add;
 %ignore oc_collection_get_all;
-%ignore oc_get_next_collection_with_link;
+%ignore oc_get_next_collection_link;
 %ignore oc_handle_collection_request;
 
 %include "api/oc_collection_internal.h"
@@ -141,6 +141,10 @@ struct oc_response_s
 %immutable oc_resource_s::num_observers;
 %rename("%(lowercamelcase)s") num_links;
 %immutable oc_resource_s::num_links;
+// reverse index of the collection links is internal to the stack
+%ignore oc_resource_s::collection_links;
+// interned resource types are internal to the stack
+%ignore oc_resource_s::types_atoms;
 %rename("%(lowercamelcase)s") observe_period_seconds;
 %immutable oc_resource_s::observe_period_seconds;
 // get/set properties callbacks are not expected to be read or writen directly to by Java code.
@@ -168,6 +168,14 @@ DTLSClient::SetPresharedKey(const PreSharedKey &psk, const IdentityHint &hint)
                               hint_.size());
 }
 
+#ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+int
+DTLSClient::SetMaxFragmentLength(unsigned char mfl)
+{
+  return mbedtls_ssl_conf_max_frag_len(&config_, mfl);
+}
+#endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+
 int
 DTLSClient::Connect(const std::string &host, uint16_t port)
 {
@@ -211,6 +219,43 @@ DTLSClient::ConnectWithHandshake(const std::string &host, uint16_t port)
   return true;
 }
 
+int
+DTLSClient::Write(const uint8_t *data, size_t size)
+{
+  int ret;
+  do {
+    ret = mbedtls_ssl_write(&ssl_, data, size);
+  } while (ret == MBEDTLS_ERR_SSL_WANT_READ ||
+           ret == MBEDTLS_ERR_SSL_WANT_WRITE);
+  return ret;
+}
+
+#ifdef MBEDTLS_SSL_DTLS_CONNECTION_ID
+int
+DTLSClient::EnableConnectionID()
+{
+  // like the client peers of the stack, send an empty connection ID to only
+  // signal support of the extension
+  if (int ret =
+        mbedtls_ssl_conf_cid(&config_, 0, MBEDTLS_SSL_UNEXPECTED_CID_IGNORE);
+      ret != 0) {
+    return ret;
+  }
+  return mbedtls_ssl_set_cid(&ssl_, MBEDTLS_SSL_CID_ENABLED, nullptr, 0);
+}
+
+int
+DTLSClient::Reconnect(const std::string &host, uint16_t port)
+{
+  // open the new socket before closing the old one, so the port is not reused
+  mbedtls_net_context old = serverFd_;
+  mbedtls_net_init(&serverFd_);
+  int ret = Connect(host, port);
+  mbedtls_net_free(&old);
+  return ret;
+}
+#endif /* MBEDTLS_SSL_DTLS_CONNECTION_ID */
+
 DTLSClient::~DTLSClient()
 {
   service_.Stop();
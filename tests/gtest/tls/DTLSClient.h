@@ -58,12 +58,24 @@ public:
   mbedtls_net_context *GetNetContext() override { return &serverFd_; };
 
   int SetPresharedKey(const PreSharedKey &psk, const IdentityHint &hint);
+#ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+  int SetMaxFragmentLength(unsigned char mfl);
+#endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
 
   int Connect(const std::string &host, uint16_t port);
   void CloseNotify();
   int Handshake();
 
   bool ConnectWithHandshake(const std::string &host, uint16_t port);
+  int Write(const uint8_t *data, size_t size);
+
+#ifdef MBEDTLS_SSL_DTLS_CONNECTION_ID
+  /** Negotiate a connection ID, must be called before the handshake */
+  int EnableConnectionID();
+  /** Continue the session from a new socket, so that the records are sent from
+   * a different port */
+  int Reconnect(const std::string &host, uint16_t port);
+#endif /* MBEDTLS_SSL_DTLS_CONNECTION_ID */
   int Run() { return service_.Run(); }
   void Stop() { service_.Stop(); }
 
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2024 plgd.dev s.r.o.
+#
+# Licensed under the Apache License, Version 2.0 (the "License"),
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Reconstruct per-request latency breakdowns from a file written by
+# oc_tracepoint_dump (see include/oc_tracepoint.h).
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"OCTP"
+VERSION = 1
+# the dump is in the byte order of the writer, it is detected from the version
+HEADER_FORMAT = "4sHHII"
+RECORD_FORMAT = "QIIIHH"
+
+STAGES = [
+    "receive",
+    "decrypt",
+    "parse",
+    "dedup",
+    "acl",
+    "handler_begin",
+    "handler_end",
+    "encode",
+    "encrypt",
+    "send",
+]
+RECEIVE = STAGES.index("receive")
+DECRYPT = STAGES.index("decrypt")
+ENCODE = STAGES.index("encode")
+
+
+def stage_name(stage):
+    return STAGES[stage] if stage < len(STAGES) else "stage%d" % stage
+
+
+def read_dump(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    header = struct.Struct("<" + HEADER_FORMAT)
+    if len(data) < header.size:
+        raise ValueError("%s: file too short" % path)
+    if data[:len(MAGIC)] != MAGIC:
+        raise ValueError("%s: invalid magic" % path)
+    byte_order = "<"
+    if header.unpack_from(data)[1] != VERSION:
+        big_endian = struct.Struct(">" + HEADER_FORMAT)
+        if big_endian.unpack_from(data)[1] == VERSION:
+            byte_order = ">"
+            header = big_endian
+    _, version, record_size, ticks_per_second, lost = header.unpack_from(data)
+    if version != VERSION:
+        raise ValueError("%s: unsupported version %d" % (path, version))
+    record = struct.Struct(byte_order + RECORD_FORMAT)
+    if record_size != record.size:
+        raise ValueError("%s: unsupported record size %d" % (path, record_size))
+    records = []
+    for offset in range(header.size, len(data) - record.size + 1, record.size):
+        timestamp, seq, key, arg, stage, ring = record.unpack_from(data, offset)
+        records.append((timestamp, ring, seq, key, arg, stage))
+    # records of a ring are ordered, rings are merged by the timestamp
+    records.sort()
+    return ticks_per_second, lost, records
+
+
+def build_requests(records):
+    # a request is opened by the receive (or decrypt for secured endpoints) of
+    # a message and joined by all records with the key of the message, the
+    # encode record links the key of the response to the request
+    requests = []
+    open_keys = {}
+    for timestamp, _, _, key, arg, stage in records:
+        if stage in (RECEIVE, DECRYPT) and (
+            key not in open_keys or open_keys[key][-1][0] != RECEIVE
+        ):
+            request = []
+            requests.append(request)
+            open_keys[key] = request
+        request = open_keys.get(key)
+        if request is None:
+            continue
+        request.append((stage, timestamp, arg))
+        if stage == ENCODE and arg != 0:
+            open_keys[arg] = request
+    return requests
+
+
+def percentile(values, p):
+    values = sorted(values)
+    index = min(len(values) - 1, int(round(p / 100.0 * (len(values) - 1))))
+    return values[index]
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Print per-request latency breakdowns of a tracepoint dump."
+    )
+    parser.add_argument("file", help="file written by oc_tracepoint_dump")
+    parser.add_argument(
+        "-r",
+        "--requests",
+        action="store_true",
+        help="print the breakdown of each request",
+    )
+    args = parser.parse_args()
+
+    try:
+        ticks_per_second, lost, records = read_dump(args.file)
+    except (OSError, ValueError) as e:
+        print("ERROR: %s" % e, file=sys.stderr)
+        return 1
+    to_us = 1e6 / ticks_per_second
+
+    requests = build_requests(records)
+    transitions = {}
+    totals = []
+    for request in requests:
+        if len(request) < 2:
+            continue
+        total = (request[-1][1] - request[0][1]) * to_us
+        totals.append(total)
+        steps = []
+        for prev, cur in zip(request, request[1:]):
+            name = "%s -> %s" % (stage_name(prev[0]), stage_name(cur[0]))
+            delta = (cur[1] - prev[1]) * to_us
+            transitions.setdefault(name, []).append(delta)
+            steps.append("%s +%.0f" % (stage_name(cur[0]), delta))
+        if args.requests:
+            print(
+                "%.0fus: %s %s"
+                % (total, stage_name(request[0][0]), ", ".join(steps))
+            )
+
+    print(
+        "records: %d, lost: %d, requests: %d" % (len(records), lost, len(totals))
+    )
+    if not totals:
+        return 0
+    print("%-32s %8s %10s %10s %10s" % ("transition", "count", "p50[us]",
+                                        "p99[us]", "max[us]"))
+    for name, values in sorted(transitions.items(), key=lambda t: -len(t[1])):
+        print(
+            "%-32s %8d %10.0f %10.0f %10.0f"
+            % (name, len(values), percentile(values, 50), percentile(values, 99),
+               max(values))
+        )
+    print(
+        "%-32s %8d %10.0f %10.0f %10.0f"
+        % ("total", len(totals), percentile(totals, 50), percentile(totals, 99),
+           max(totals))
+    )
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,204 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "util/oc_features.h"
+
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+
+#include "util/oc_atom_internal.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+  char *str;
+  size_t len;
+  uint32_t hash;
+} atom_entry_t;
+
+/* Interned strings, atom N is stored at index N - 1 */
+static atom_entry_t *g_atoms = NULL;
+static size_t g_atoms_count = 0;
+static size_t g_atoms_capacity = 0;
+
+/* Open addressing hash table of atoms, the size is a power of 2 */
+static oc_atom_t *g_atoms_table = NULL;
+static size_t g_atoms_table_size = 0;
+
+enum {
+  ATOMS_TABLE_MIN_SIZE = 64,
+};
+
+static uint32_t
+atom_hash(const char *str, size_t len)
+{
+  // FNV-1a
+  uint32_t hash = 2166136261U;
+  for (size_t i = 0; i < len; ++i) {
+    hash ^= (uint8_t)str[i];
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+static bool
+atom_is_equal(const atom_entry_t *entry, const char *str, size_t len,
+              uint32_t hash)
+{
+  return entry->hash == hash && entry->len == len &&
+         memcmp(entry->str, str, len) == 0;
+}
+
+/* Find the slot of the string, the slot is either empty or holds the atom of
+ * the string */
+static size_t
+atoms_table_slot(const char *str, size_t len, uint32_t hash)
+{
+  assert(g_atoms_table_size > 0);
+  size_t mask = g_atoms_table_size - 1;
+  size_t slot = hash & mask;
+  while (g_atoms_table[slot] != OC_ATOM_NONE) {
+    if (atom_is_equal(&g_atoms[g_atoms_table[slot] - 1], str, len, hash)) {
+      break;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+static bool
+atoms_table_resize(size_t size)
+{
+  oc_atom_t *table = (oc_atom_t *)calloc(size, sizeof(oc_atom_t));
+  if (table == NULL) {
+    return false;
+  }
+  free(g_atoms_table);
+  g_atoms_table = table;
+  g_atoms_table_size = size;
+  for (size_t i = 0; i < g_atoms_count; ++i) {
+    const atom_entry_t *entry = &g_atoms[i];
+    size_t slot = atoms_table_slot(entry->str, entry->len, entry->hash);
+    g_atoms_table[slot] = (oc_atom_t)(i + 1);
+  }
+  return true;
+}
+
+oc_atom_t
+oc_atom_find(const char *str, size_t len)
+{
+  assert(str != NULL);
+  if (g_atoms_count == 0) {
+    return OC_ATOM_NONE;
+  }
+  return g_atoms_table[atoms_table_slot(str, len, atom_hash(str, len))];
+}
+
+static bool
+atoms_reserve(void)
+{
+  // keep the load factor of the hash table under 1/2
+  if (2 * (g_atoms_count + 1) > g_atoms_table_size) {
+    size_t size = g_atoms_table_size > 0 ? 2 * g_atoms_table_size
+                                         : (size_t)ATOMS_TABLE_MIN_SIZE;
+    if (!atoms_table_resize(size)) {
+      return false;
+    }
+  }
+  if (g_atoms_count == g_atoms_capacity) {
+    size_t capacity = g_atoms_capacity > 0 ? 2 * g_atoms_capacity
+                                           : (size_t)ATOMS_TABLE_MIN_SIZE / 2;
+    atom_entry_t *atoms =
+      (atom_entry_t *)realloc(g_atoms, capacity * sizeof(atom_entry_t));
+    if (atoms == NULL) {
+      return false;
+    }
+    g_atoms = atoms;
+    g_atoms_capacity = capacity;
+  }
+  return true;
+}
+
+oc_atom_t
+oc_atom_intern(const char *str, size_t len)
+{
+  assert(str != NULL);
+  uint32_t hash = atom_hash(str, len);
+  if (g_atoms_count > 0) {
+    oc_atom_t atom = g_atoms_table[atoms_table_slot(str, len, hash)];
+    if (atom != OC_ATOM_NONE) {
+      return atom;
+    }
+  }
+  if (!atoms_reserve()) {
+    return OC_ATOM_NONE;
+  }
+  char *copy = (char *)malloc(len + 1);
+  if (copy == NULL) {
+    return OC_ATOM_NONE;
+  }
+  memcpy(copy, str, len);
+  copy[len] = '\0';
+
+  atom_entry_t *entry = &g_atoms[g_atoms_count];
+  entry->str = copy;
+  entry->len = len;
+  entry->hash = hash;
+  oc_atom_t atom = (oc_atom_t)(++g_atoms_count);
+  g_atoms_table[atoms_table_slot(str, len, hash)] = atom;
+  return atom;
+}
+
+const char *
+oc_atom_string(oc_atom_t atom, size_t *len)
+{
+  if (atom == OC_ATOM_NONE || atom > g_atoms_count) {
+    return NULL;
+  }
+  const atom_entry_t *entry = &g_atoms[atom - 1];
+  if (len != NULL) {
+    *len = entry->len;
+  }
+  return entry->str;
+}
+
+size_t
+oc_atom_count(void)
+{
+  return g_atoms_count;
+}
+
+void
+oc_atom_table_clear(void)
+{
+  for (size_t i = 0; i < g_atoms_count; ++i) {
+    free(g_atoms[i].str);
+  }
+  free(g_atoms);
+  g_atoms = NULL;
+  g_atoms_count = 0;
+  g_atoms_capacity = 0;
+  free(g_atoms_table);
+  g_atoms_table = NULL;
+  g_atoms_table_size = 0;
+}
+
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
@@ -0,0 +1,86 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifndef OC_ATOM_INTERNAL_H
+#define OC_ATOM_INTERNAL_H
+
+#include "util/oc_features.h"
+
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Identifier of an interned string.
+ *
+ * Equal strings are interned to the same atom, so strings can be compared by
+ * comparing their atoms.
+ */
+typedef uint32_t oc_atom_t;
+
+/** @brief Invalid atom */
+#define OC_ATOM_NONE ((oc_atom_t)0)
+
+/**
+ * @brief Intern a string.
+ *
+ * @param str the string (cannot be NULL)
+ * @param len the length of the string
+ * @return oc_atom_t atom of the string
+ * @return OC_ATOM_NONE on allocation failure
+ */
+oc_atom_t oc_atom_intern(const char *str, size_t len);
+
+/**
+ * @brief Find the atom of an already interned string.
+ *
+ * @param str the string (cannot be NULL)
+ * @param len the length of the string
+ * @return oc_atom_t atom of the string
+ * @return OC_ATOM_NONE if the string was not interned
+ */
+oc_atom_t oc_atom_find(const char *str, size_t len);
+
+/**
+ * @brief Get the interned string of an atom.
+ *
+ * @param atom the atom
+ * @param[out] len the length of the string (can be NULL)
+ * @return const char* the zero-terminated interned string
+ * @return NULL if the atom is invalid
+ */
+const char *oc_atom_string(oc_atom_t atom, size_t *len);
+
+/** @brief Get the number of interned strings */
+size_t oc_atom_count(void);
+
+/** @brief Deallocate all interned strings, all atoms become invalid */
+void oc_atom_table_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
+
+#endif /* OC_ATOM_INTERNAL_H */
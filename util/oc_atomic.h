@@ -27,6 +27,7 @@
 #ifndef OC_ATOMIC_H
 #define OC_ATOMIC_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -52,6 +53,9 @@ typedef uint32_t OC_ATOMIC_UINT32_T;
 
 #define OC_ATOMIC_DECREMENT32(x) __atomic_sub_fetch(&(x), 1, __ATOMIC_SEQ_CST)
 
+#define OC_ATOMIC_ADD32(x, val)                                                \
+  __atomic_add_fetch(&(x), (val), __ATOMIC_SEQ_CST)
+
 // Function compares the contents of x with the contents of expected. If equal,
 // the operation is a read-modify-write operation that writes desired into x.
 // If they are not equal, the operation is a read and the current contents of
@@ -65,6 +69,15 @@ typedef uint32_t OC_ATOMIC_UINT32_T;
       &(x), &(expected), desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);  \
   } while (0)
 
+#define OC_ATOMIC_LOADPTR(x) __atomic_load_n(&(x), __ATOMIC_SEQ_CST)
+
+// Atomically writes val into x and returns the previous value of x.
+#define OC_ATOMIC_EXCHANGEPTR(x, val)                                          \
+  __atomic_exchange_n(&(x), (val), __ATOMIC_SEQ_CST)
+
+#define OC_ATOMIC_COMPARE_AND_SWAPPTR(x, expected, desired, result)            \
+  OC_ATOMIC_COMPARE_AND_SWAP32(x, expected, desired, result)
+
 // aliases for compatibility
 #define OC_ATOMIC_LOAD8(x) OC_ATOMIC_LOAD32(x)
 #define OC_ATOMIC_STORE8(x, val) OC_ATOMIC_STORE32(x, val)
@@ -95,6 +108,8 @@ typedef uint32_t OC_ATOMIC_UINT32_T;
 
 #define OC_ATOMIC_DECREMENT32(x) _InterlockedDecrement((&x))
 
+#define OC_ATOMIC_ADD32(x, val) (_InterlockedExchangeAdd((&x), (val)) + (val))
+
 #define OC_ATOMIC_COMPARE_AND_SWAP8(x, expected, desired, result)              \
   do {                                                                         \
     char _oc_compare_and_swap_initial =                                        \
@@ -117,6 +132,22 @@ typedef uint32_t OC_ATOMIC_UINT32_T;
     }                                                                          \
   } while (0)
 
+#define OC_ATOMIC_LOADPTR(x)                                                   \
+  _InterlockedCompareExchangePointer((void *volatile *)&(x), NULL, NULL)
+
+#define OC_ATOMIC_EXCHANGEPTR(x, val)                                          \
+  _InterlockedExchangePointer((void *volatile *)&(x), (val))
+
+#define OC_ATOMIC_COMPARE_AND_SWAPPTR(x, expected, desired, result)            \
+  do {                                                                         \
+    void *_oc_compare_and_swap_initial = _InterlockedCompareExchangePointer(   \
+      (void *volatile *)&(x), (desired), (expected));                          \
+    (result) = ((void *)(expected) == _oc_compare_and_swap_initial);           \
+    if (!result) {                                                             \
+      (expected) = _oc_compare_and_swap_initial;                               \
+    }                                                                          \
+  } while (0)
+
 #endif // _MSC_VER
 
 #endif // defined(_WIN32) || defined(_WIN64)
@@ -146,6 +177,8 @@ atomics for your platform to this file")
 
 #define OC_ATOMIC_DECREMENT32(x) --(x)
 
+#define OC_ATOMIC_ADD32(x, val) ((x) += (val))
+
 // Copy the semantics of the Unix version of OC_ATOMIC_COMPARE_AND_SWAP32
 // using non-atomic operations.
 #define OC_ATOMIC_COMPARE_AND_SWAP32(x, expected, desired, result)             \
@@ -159,6 +192,21 @@ atomics for your platform to this file")
     }                                                                          \
   } while (0)
 
+#define OC_ATOMIC_LOADPTR(x) (x)
+
+#define OC_ATOMIC_EXCHANGEPTR(x, val) oc_atomic_exchangeptr((void **)&(x), (val))
+
+static inline void *
+oc_atomic_exchangeptr(void **x, void *val)
+{
+  void *prev = *x;
+  *x = val;
+  return prev;
+}
+
+#define OC_ATOMIC_COMPARE_AND_SWAPPTR(x, expected, desired, result)            \
+  OC_ATOMIC_COMPARE_AND_SWAP32(x, expected, desired, result)
+
 // aliases for compatibility
 #define OC_ATOMIC_LOAD8(x) OC_ATOMIC_LOAD32(x)
 #define OC_ATOMIC_STORE8(x, val) OC_ATOMIC_STORE32(x, val)
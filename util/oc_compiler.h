@@ -129,6 +129,12 @@
 #define OC_SANITIZE_THREAD
 #endif
 
+#if defined(__clang__) || defined(__GNUC__)
+#define OC_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define OC_THREAD_LOCAL __declspec(thread)
+#endif
+
 #if __has_builtin(__builtin_speculation_safe_value)
 #define OC_SPECULATION_SAFE(x) __builtin_speculation_safe_value(x)
 #else
@@ -18,7 +18,8 @@
 
 #include "util/oc_features.h"
 
-#ifdef OC_HAS_FEATURE_CRC_ENCODER
+#if defined(OC_HAS_FEATURE_CRC_ENCODER) ||                                     \
+  defined(OC_HAS_FEATURE_STORAGE_SNAPSHOT)
 
 #include "util/oc_crc_internal.h"
 
@@ -51,4 +52,4 @@ oc_crc64(uint64_t crc, const uint8_t *buffer, size_t size)
   return crc;
 }
 
-#endif /* OC_HAS_FEATURE_CRC_ENCODER */
+#endif /* OC_HAS_FEATURE_CRC_ENCODER || OC_HAS_FEATURE_STORAGE_SNAPSHOT */
@@ -21,7 +21,8 @@
 
 #include "util/oc_features.h"
 
-#ifdef OC_HAS_FEATURE_CRC_ENCODER
+#if defined(OC_HAS_FEATURE_CRC_ENCODER) ||                                     \
+  defined(OC_HAS_FEATURE_STORAGE_SNAPSHOT)
 
 #include <stddef.h>
 #include <stdint.h>
@@ -45,6 +46,6 @@ uint64_t oc_crc64(uint64_t crc, const uint8_t *buffer, size_t size);
 }
 #endif
 
-#endif /* OC_HAS_FEATURE_CRC_ENCODER */
+#endif /* OC_HAS_FEATURE_CRC_ENCODER || OC_HAS_FEATURE_STORAGE_SNAPSHOT */
 
 #endif /* OC_CRC_INTERNAL_H */
@@ -34,6 +34,11 @@
 #define OC_HAS_FEATURE_TCP_ASYNC_CONNECT
 #endif /* __linux__ && !__ANDROID_API__ && OC_CLIENT && OC_TCP */
 
+#if defined(__linux__) && !defined(__ANDROID_API__) && defined(OC_DNS_LOOKUP)
+/* Support asynchronous DNS lookup */
+#define OC_HAS_FEATURE_DNS_LOOKUP_ASYNC
+#endif /* __linux__ && !__ANDROID_API__ && OC_DNS_LOOKUP */
+
 #if defined(OC_PUSH) && defined(OC_SERVER) && defined(OC_CLIENT) &&            \
   defined(OC_DYNAMIC_ALLOCATION) && defined(OC_COLLECTIONS_IF_CREATE)
 #define OC_HAS_FEATURE_PUSH
@@ -71,6 +76,19 @@
 #define OC_HAS_FEATURE_MESSAGE_DYNAMIC_BUFFER
 #endif /* OC_DYNAMIC_ALLOCATION && !OC_INOUT_BUFFER_SIZE */
 
+#ifdef OC_DYNAMIC_ALLOCATION
+/* Table of interned strings */
+#define OC_HAS_FEATURE_ATOM_TABLE
+/* Cache encoded links of /oic/res responses and index resources by type */
+#define OC_HAS_FEATURE_DISCOVERY_CACHE
+#endif /* OC_DYNAMIC_ALLOCATION */
+
+#if defined(OC_STORAGE_SNAPSHOT) && defined(OC_STORAGE) &&                     \
+  defined(OC_DYNAMIC_ALLOCATION)
+/* Load stored resources from a consolidated snapshot */
+#define OC_HAS_FEATURE_STORAGE_SNAPSHOT
+#endif /* OC_STORAGE_SNAPSHOT && OC_STORAGE && OC_DYNAMIC_ALLOCATION */
+
 #if !defined(OC_DYNAMIC_ALLOCATION) || defined(OC_INOUT_BUFFER_POOL)
 #define OC_HAS_FEATURE_ALLOCATOR_MUTEX
 #endif /* !OC_DYNAMIC_ALLOCATION || OC_INOUT_BUFFER_POOL */
@@ -41,6 +41,10 @@
 #include "util/oc_mem_trace_internal.h"
 #endif
 
+#ifdef OC_POOL_STATS
+#include "util/oc_pool_stats_internal.h"
+#endif /* OC_POOL_STATS */
+
 void
 oc_memb_init(struct oc_memb *m)
 {
@@ -62,6 +66,10 @@ _oc_memb_alloc(
     return NULL;
   }
 
+#ifdef OC_POOL_STATS
+  oc_pool_stats_register(&m->stats, m->size, m->num);
+#endif /* OC_POOL_STATS */
+
   void *ptr = NULL;
   if (m->num > 0) {
     unsigned short i = 0;
@@ -89,9 +97,16 @@ _oc_memb_alloc(
   if (!ptr) {
     /* No free block was found, so we return NULL to indicate failure to
        allocate block. */
+#ifdef OC_POOL_STATS
+    oc_pool_stats_failed(&m->stats);
+#endif /* OC_POOL_STATS */
     return NULL;
   }
 
+#ifdef OC_POOL_STATS
+  oc_pool_stats_allocated(&m->stats, 1);
+#endif /* OC_POOL_STATS */
+
 #ifdef OC_MEMORY_TRACE
   oc_mem_trace_add_pace(func, m->size, MEM_TRACE_ALLOC, ptr);
 #endif
@@ -99,7 +114,7 @@ _oc_memb_alloc(
   return ptr;
 }
 
-static void
+static bool
 memb_free_block(struct oc_memb *m, void *ptr)
 {
   /* Walk through the list of blocks and try to find the block to
@@ -112,11 +127,13 @@ memb_free_block(struct oc_memb *m, void *ptr)
       if (m->count[i] > 0) {
         /* Make sure that we don't deallocate free memory. */
         --(m->count[i]);
+        return true;
       }
-      break;
+      return false;
     }
     ptr2 += m->size;
   }
+  return false;
 }
 
 char
@@ -135,14 +152,23 @@ _oc_memb_free(
   oc_mem_trace_add_pace(func, m->size, MEM_TRACE_FREE, ptr);
 #endif
 
+  bool freed = false;
   if (m->num > 0) {
-    memb_free_block(m, ptr);
+    freed = memb_free_block(m, ptr);
   }
 #ifdef OC_DYNAMIC_ALLOCATION
   else {
+    freed = ptr != NULL;
     free(ptr);
   }
 #endif /* OC_DYNAMIC_ALLOCATION */
+#ifdef OC_POOL_STATS
+  if (freed) {
+    oc_pool_stats_freed(&m->stats, 1);
+  }
+#else  /* !OC_POOL_STATS */
+  (void)freed;
+#endif /* OC_POOL_STATS */
   if (m->buffers_avail_cb != NULL) {
     m->buffers_avail_cb(oc_memb_numfree(m));
   }
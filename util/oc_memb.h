@@ -50,6 +50,7 @@
 #include "oc_config.h"
 #include "oc_export.h"
 #include "util/oc_compiler.h"
+#include "util/oc_pool_stats.h"
 
 #include <stdbool.h>
 
@@ -66,6 +67,16 @@ extern "C" {
  */
 #define CC_CONCAT(s1, s2) CC_CONCAT2(s1, s2)
 
+#ifdef OC_POOL_STATS
+/* Named pools are registered in the pool statistics, pools allocated on the
+ * stack are not. */
+#define OC_MEMB_STATS_INIT(name) , OC_POOL_STATS_INIT(#name)
+#define OC_MEMB_LOCAL_STATS_INIT , OC_POOL_STATS_INIT(NULL)
+#else /* !OC_POOL_STATS */
+#define OC_MEMB_STATS_INIT(name)
+#define OC_MEMB_LOCAL_STATS_INIT
+#endif /* OC_POOL_STATS */
+
 /**
  * Declare a memory block.
  *
@@ -96,15 +107,18 @@ extern "C" {
 extern "C" {
 #endif
 #define OC_MEMB(name, structure, num)                                          \
-  static oc_memb_t name = { sizeof(structure), 0, NULL, NULL, NULL }
+  static oc_memb_t name = { sizeof(structure), 0, NULL, NULL,                  \
+                            NULL OC_MEMB_STATS_INIT(name) }
 #define OC_MEMB_LOCAL(name, structure, num)                                    \
-  oc_memb_t name = { sizeof(structure), 0, NULL, NULL, NULL }
+  oc_memb_t name = { sizeof(structure), 0, NULL, NULL,                         \
+                     NULL OC_MEMB_LOCAL_STATS_INIT }
 #define OC_MEMB_STATIC(name, structure, num)                                   \
   static char CC_CONCAT(name, _memb_count)[num];                               \
   static structure CC_CONCAT(name, _memb_mem)[num];                            \
   static oc_memb_t name = { sizeof(structure), num,                            \
                             CC_CONCAT(name, _memb_count),                      \
-                            (void *)CC_CONCAT(name, _memb_mem), NULL }
+                            (void *)CC_CONCAT(name, _memb_mem),                \
+                            NULL OC_MEMB_STATS_INIT(name) }
 #else /* OC_DYNAMIC_ALLOCATION */
 #ifdef __cplusplus
 }
@@ -118,14 +132,16 @@ extern "C" {
   static structure CC_CONCAT(name, _memb_mem)[num];                            \
   static oc_memb_t name = { sizeof(structure), num,                            \
                             CC_CONCAT(name, _memb_count),                      \
-                            (void *)CC_CONCAT(name, _memb_mem), NULL }
+                            (void *)CC_CONCAT(name, _memb_mem),                \
+                            NULL OC_MEMB_STATS_INIT(name) }
 #define OC_MEMB_LOCAL(name, structure, num)                                    \
   char CC_CONCAT(name, _memb_count)[num];                                      \
   memset(CC_CONCAT(name, _memb_count), 0, (num) * sizeof(char));               \
   structure CC_CONCAT(name, _memb_mem)[num];                                   \
   memset(CC_CONCAT(name, _memb_mem), 0, (num) * sizeof(structure));            \
   oc_memb_t name = { sizeof(structure), num, CC_CONCAT(name, _memb_count),     \
-                     (void *)CC_CONCAT(name, _memb_mem), NULL }
+                     (void *)CC_CONCAT(name, _memb_mem),                       \
+                     NULL OC_MEMB_LOCAL_STATS_INIT }
 
 #endif /* !OC_DYNAMIC_ALLOCATION */
 
@@ -138,6 +154,9 @@ typedef struct oc_memb
   char *count;
   void *mem;
   oc_memb_buffers_avail_callback_t buffers_avail_cb;
+#ifdef OC_POOL_STATS
+  oc_pool_stats_t stats;
+#endif /* OC_POOL_STATS */
 } oc_memb_t;
 
 /**
@@ -33,7 +33,6 @@
  */
 
 #include "oc_config.h"
-#include "oc_list.h"
 #include "oc_mmem.h"
 #include "oc_mmem_internal.h"
 #include "port/oc_log_internal.h"
@@ -42,6 +41,10 @@
 #include "util/oc_mem_trace_internal.h"
 #endif /* OC_MEMORY_TRACE */
 
+#ifdef OC_POOL_STATS
+#include "util/oc_pool_stats_internal.h"
+#endif /* OC_POOL_STATS */
+
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
@@ -57,17 +60,260 @@
 #endif /* !OC_BYTES_POOL_SIZE || !OC_INTS_POOL_SIZE || !OC_DOUBLES_POOL_SIZE   \
         */
 
-static unsigned char g_mmem_bytes[OC_BYTES_POOL_SIZE] = { 0 };
-static unsigned int g_mmem_avail_bytes = OC_BYTES_POOL_SIZE;
-OC_LIST(g_mmem_bytes_list);
+/*
+ * The pools are divided into blocks of granules. A block is allocated from
+ * segregated lists of free blocks, the list of class k holds the free blocks
+ * of [2^k, 2^(k+1)) granules. The first fitting block of the class of the
+ * request is taken, otherwise the head of the next non-empty larger class. The
+ * allocated block is split off a free block and a freed block is coalesced
+ * with its free neighbours in constant time, allocated blocks never move.
+ *
+ * The size of each block is kept in a tag table (one tag per granule), the
+ * tags of the first and the last granule of a block are valid. The links of a
+ * free block are stored in its first granule.
+ *
+ * An item of the int and double pools is a granule. The byte pool uses granules
+ * of MMEM_BYTES_GRANULE bytes, so a byte allocation is rounded up to a whole
+ * number of granules and the available size of the pool is reduced by the
+ * rounded size. The tag tables cost sizeof(mmem_tag_t) bytes per granule on top
+ * of the pools.
+ */
+
+/* Number of bytes in a granule of the byte pool */
+#define MMEM_BYTES_GRANULE (8)
+#define MMEM_BYTES_GRANULES                                                    \
+  ((OC_BYTES_POOL_SIZE + MMEM_BYTES_GRANULE - 1) / MMEM_BYTES_GRANULE)
+
+typedef uint16_t mmem_tag_t;
+
+#define MMEM_TAG_FREE (0x8000)
+#define MMEM_TAG_SIZE_MASK (0x7FFF)
+#define MMEM_NONE (0xFFFF)
+#define MMEM_CLASSES (15)
+
+#if MMEM_BYTES_GRANULES > MMEM_TAG_SIZE_MASK ||                                \
+  OC_INTS_POOL_SIZE > MMEM_TAG_SIZE_MASK ||                                    \
+  OC_DOUBLES_POOL_SIZE > MMEM_TAG_SIZE_MASK
+#error "Byte, int or double pool size is too large"
+#endif /* MMEM_BYTES_GRANULES > MMEM_TAG_SIZE_MASK || ... */
+
+typedef struct
+{
+  uint16_t prev;
+  uint16_t next;
+} mmem_link_t;
+
+typedef struct
+{
+  const char *name;
+  unsigned char *mem;
+  mmem_tag_t *tags;
+  size_t granule_size;  ///< size of a granule in bytes
+  size_t granule_items; ///< number of items in a granule
+  uint16_t granules;
+  uint16_t heads[MMEM_CLASSES];
+  uint16_t nonempty; ///< bitmap of classes with a free block
+  size_t capacity;   ///< number of items
+  size_t avail;      ///< number of items not allocated
+} mmem_pool_t;
+
+static unsigned char g_mmem_bytes[MMEM_BYTES_GRANULES * MMEM_BYTES_GRANULE];
+static mmem_tag_t g_mmem_bytes_tags[MMEM_BYTES_GRANULES];
+
+static int64_t g_mmem_ints[OC_INTS_POOL_SIZE];
+static mmem_tag_t g_mmem_ints_tags[OC_INTS_POOL_SIZE];
+
+static double g_mmem_doubles[OC_DOUBLES_POOL_SIZE];
+static mmem_tag_t g_mmem_doubles_tags[OC_DOUBLES_POOL_SIZE];
 
-static int64_t g_mmem_ints[OC_INTS_POOL_SIZE] = { 0 };
-static unsigned int g_mmem_avail_ints = OC_INTS_POOL_SIZE;
-OC_LIST(g_mmem_ints_list);
+// indexed by oc_mmem_pool_t
+static mmem_pool_t g_mmem_pools[] = {
+  {
+    .name = "byte",
+    .mem = g_mmem_bytes,
+    .tags = g_mmem_bytes_tags,
+    .granule_size = MMEM_BYTES_GRANULE,
+    .granule_items = MMEM_BYTES_GRANULE,
+    .granules = MMEM_BYTES_GRANULES,
+    .capacity = MMEM_BYTES_GRANULES * MMEM_BYTES_GRANULE,
+  },
+  {
+    .name = "int",
+    .mem = (unsigned char *)g_mmem_ints,
+    .tags = g_mmem_ints_tags,
+    .granule_size = sizeof(int64_t),
+    .granule_items = 1,
+    .granules = OC_INTS_POOL_SIZE,
+    .capacity = OC_INTS_POOL_SIZE,
+  },
+  {
+    .name = "double",
+    .mem = (unsigned char *)g_mmem_doubles,
+    .tags = g_mmem_doubles_tags,
+    .granule_size = sizeof(double),
+    .granule_items = 1,
+    .granules = OC_DOUBLES_POOL_SIZE,
+    .capacity = OC_DOUBLES_POOL_SIZE,
+  },
+};
 
-static double g_mmem_doubles[OC_DOUBLES_POOL_SIZE] = { 0.0 };
-static unsigned int g_mmem_avail_doubles = OC_DOUBLES_POOL_SIZE;
-OC_LIST(g_mmem_doubles_list);
+static bool g_mmem_initialized = false;
+
+static unsigned
+mmem_class(uint16_t granules)
+{
+  unsigned c = 0;
+  while (granules > 1) {
+    granules >>= 1;
+    ++c;
+  }
+  return c;
+}
+
+static mmem_link_t
+mmem_get_link(const mmem_pool_t *pool, uint16_t block)
+{
+  mmem_link_t link;
+  memcpy(&link, pool->mem + (size_t)block * pool->granule_size, sizeof(link));
+  return link;
+}
+
+static void
+mmem_set_link(mmem_pool_t *pool, uint16_t block, mmem_link_t link)
+{
+  memcpy(pool->mem + (size_t)block * pool->granule_size, &link, sizeof(link));
+}
+
+static void
+mmem_set_block(mmem_pool_t *pool, uint16_t block, uint16_t granules,
+               bool free)
+{
+  mmem_tag_t tag = (mmem_tag_t)(granules | (free ? MMEM_TAG_FREE : 0));
+  pool->tags[block] = tag;
+  pool->tags[block + granules - 1] = tag;
+}
+
+static void
+mmem_list_insert(mmem_pool_t *pool, uint16_t block, uint16_t granules)
+{
+  unsigned c = mmem_class(granules);
+  uint16_t head = pool->heads[c];
+  mmem_set_link(pool, block, (mmem_link_t){ MMEM_NONE, head });
+  if (head != MMEM_NONE) {
+    mmem_link_t link = mmem_get_link(pool, head);
+    link.prev = block;
+    mmem_set_link(pool, head, link);
+  }
+  pool->heads[c] = block;
+  pool->nonempty |= (uint16_t)(1U << c);
+}
+
+static void
+mmem_list_remove(mmem_pool_t *pool, uint16_t block, uint16_t granules)
+{
+  unsigned c = mmem_class(granules);
+  mmem_link_t link = mmem_get_link(pool, block);
+  if (link.prev != MMEM_NONE) {
+    mmem_link_t prev = mmem_get_link(pool, link.prev);
+    prev.next = link.next;
+    mmem_set_link(pool, link.prev, prev);
+  } else {
+    pool->heads[c] = link.next;
+  }
+  if (link.next != MMEM_NONE) {
+    mmem_link_t next = mmem_get_link(pool, link.next);
+    next.prev = link.prev;
+    mmem_set_link(pool, link.next, next);
+  }
+  if (pool->heads[c] == MMEM_NONE) {
+    pool->nonempty &= (uint16_t)~(1U << c);
+  }
+}
+
+/* Number of granules of a block holding size items */
+static uint16_t
+mmem_pool_granules(const mmem_pool_t *pool, size_t size)
+{
+  size_t granules = (size + pool->granule_items - 1) / pool->granule_items;
+  return granules > 0 ? (uint16_t)granules : 1;
+}
+
+static void
+mmem_pool_init(mmem_pool_t *pool)
+{
+  for (size_t i = 0; i < MMEM_CLASSES; ++i) {
+    pool->heads[i] = MMEM_NONE;
+  }
+  pool->nonempty = 0;
+  pool->avail = pool->capacity;
+  if (pool->granules > 0) {
+    mmem_set_block(pool, 0, pool->granules, true);
+    mmem_list_insert(pool, 0, pool->granules);
+  }
+}
+
+static uint16_t
+mmem_pool_alloc(mmem_pool_t *pool, uint16_t granules)
+{
+  unsigned c = mmem_class(granules);
+  // the blocks of class c may be smaller than the request, take the first
+  // one that fits
+  uint16_t block = pool->heads[c];
+  while (block != MMEM_NONE &&
+         (pool->tags[block] & MMEM_TAG_SIZE_MASK) < granules) {
+    block = mmem_get_link(pool, block).next;
+  }
+  if (block == MMEM_NONE) {
+    // any block of a larger class fits
+    unsigned larger = pool->nonempty & ~((2U << c) - 1);
+    if (larger == 0) {
+      return MMEM_NONE;
+    }
+    c = 0;
+    while ((larger & (1U << c)) == 0) {
+      ++c;
+    }
+    block = pool->heads[c];
+  }
+  uint16_t size = pool->tags[block] & MMEM_TAG_SIZE_MASK;
+  mmem_list_remove(pool, block, size);
+  if (size > granules) {
+    uint16_t rest = (uint16_t)(block + granules);
+    mmem_set_block(pool, rest, (uint16_t)(size - granules), true);
+    mmem_list_insert(pool, rest, (uint16_t)(size - granules));
+  }
+  mmem_set_block(pool, block, granules, false);
+  return block;
+}
+
+static void
+mmem_pool_free(mmem_pool_t *pool, uint16_t block)
+{
+  uint16_t size = pool->tags[block] & MMEM_TAG_SIZE_MASK;
+  uint16_t next = (uint16_t)(block + size);
+  if (next < pool->granules && (pool->tags[next] & MMEM_TAG_FREE) != 0) {
+    uint16_t next_size = pool->tags[next] & MMEM_TAG_SIZE_MASK;
+    mmem_list_remove(pool, next, next_size);
+    size = (uint16_t)(size + next_size);
+  }
+  if (block > 0 && (pool->tags[block - 1] & MMEM_TAG_FREE) != 0) {
+    uint16_t prev_size = pool->tags[block - 1] & MMEM_TAG_SIZE_MASK;
+    block = (uint16_t)(block - prev_size);
+    mmem_list_remove(pool, block, prev_size);
+    size = (uint16_t)(size + prev_size);
+  }
+  mmem_set_block(pool, block, size, true);
+  mmem_list_insert(pool, block, size);
+}
+
+static void
+mmem_init_pools(void)
+{
+  for (size_t i = 0; i < sizeof(g_mmem_pools) / sizeof(g_mmem_pools[0]); ++i) {
+    mmem_pool_init(&g_mmem_pools[i]);
+  }
+  g_mmem_initialized = true;
+}
 #endif /* !OC_DYNAMIC_ALLOCATION */
 
 static uint8_t
@@ -84,6 +330,51 @@ memm_type_size(oc_mmem_pool_t pool_type)
   return 0;
 }
 
+#ifdef OC_POOL_STATS
+static oc_pool_stats_t g_mmem_bytes_stats = OC_POOL_STATS_INIT("mmem_bytes");
+static oc_pool_stats_t g_mmem_ints_stats = OC_POOL_STATS_INIT("mmem_ints");
+static oc_pool_stats_t g_mmem_doubles_stats =
+  OC_POOL_STATS_INIT("mmem_doubles");
+
+static oc_pool_stats_t *
+mmem_pool_stats(oc_mmem_pool_t pool_type)
+{
+  oc_pool_stats_t *stats = NULL;
+  switch (pool_type) {
+  case BYTE_POOL:
+    stats = &g_mmem_bytes_stats;
+    break;
+  case INT_POOL:
+    stats = &g_mmem_ints_stats;
+    break;
+  case DOUBLE_POOL:
+    stats = &g_mmem_doubles_stats;
+    break;
+  }
+  if (stats != NULL) {
+    size_t capacity = 0;
+#ifndef OC_DYNAMIC_ALLOCATION
+    capacity = g_mmem_pools[pool_type].capacity;
+#endif /* !OC_DYNAMIC_ALLOCATION */
+    oc_pool_stats_register(stats, memm_type_size(pool_type), capacity);
+  }
+  return stats;
+}
+
+/* Number of items taken from the pool by an allocation of size items */
+static size_t
+mmem_pool_stats_items(oc_mmem_pool_t pool_type, size_t size)
+{
+#ifdef OC_DYNAMIC_ALLOCATION
+  (void)pool_type;
+  return size;
+#else  /* !OC_DYNAMIC_ALLOCATION */
+  const mmem_pool_t *pool = &g_mmem_pools[pool_type];
+  return (size_t)mmem_pool_granules(pool, size) * pool->granule_items;
+#endif /* OC_DYNAMIC_ALLOCATION */
+}
+#endif /* OC_POOL_STATS */
+
 size_t
 _oc_mmem_alloc(
 #ifdef OC_MEMORY_TRACE
@@ -98,44 +389,52 @@ _oc_mmem_alloc(
 
   const uint8_t type_size = memm_type_size(pool_type);
   size_t bytes_allocated = size * type_size;
+#ifdef OC_POOL_STATS
+  oc_pool_stats_t *stats = mmem_pool_stats(pool_type);
+#endif /* OC_POOL_STATS */
 #ifdef OC_DYNAMIC_ALLOCATION
   m->ptr = malloc(size * type_size);
   m->size = size;
+#ifdef OC_POOL_STATS
+  if (m->ptr == NULL && size > 0) {
+    oc_pool_stats_failed(stats);
+    stats = NULL;
+  }
+#endif /* OC_POOL_STATS */
 #else  /* !OC_DYNAMIC_ALLOCATION */
-  switch (pool_type) {
-  case BYTE_POOL:
-    if (g_mmem_avail_bytes < size) {
-      OC_WRN("byte pool exhausted");
-      return 0;
-    }
-    oc_list_add(g_mmem_bytes_list, m);
-    m->ptr = &g_mmem_bytes[OC_BYTES_POOL_SIZE - g_mmem_avail_bytes];
-    m->size = size;
-    g_mmem_avail_bytes -= size;
-    break;
-  case INT_POOL:
-    if (g_mmem_avail_ints < size) {
-      OC_WRN("int pool exhausted");
-      return 0;
-    }
-    oc_list_add(g_mmem_ints_list, m);
-    m->ptr = &g_mmem_ints[OC_INTS_POOL_SIZE - g_mmem_avail_ints];
-    m->size = size;
-    g_mmem_avail_ints -= size;
-    break;
-  case DOUBLE_POOL:
-    if (g_mmem_avail_doubles < size) {
-      OC_WRN("double pool exhausted");
-      return 0;
+  if (!g_mmem_initialized) {
+    mmem_init_pools();
+  }
+  mmem_pool_t *pool = &g_mmem_pools[pool_type];
+  size_t items = size;
+  uint16_t block = MMEM_NONE;
+  if (items <= pool->avail) {
+    uint16_t granules = mmem_pool_granules(pool, size);
+    items = (size_t)granules * pool->granule_items;
+    if (items <= pool->avail) {
+      block = mmem_pool_alloc(pool, granules);
     }
-    oc_list_add(g_mmem_doubles_list, m);
-    m->ptr = &g_mmem_doubles[OC_DOUBLES_POOL_SIZE - g_mmem_avail_doubles];
-    m->size = size;
-    g_mmem_avail_doubles -= size;
-    break;
   }
+  if (block == MMEM_NONE) {
+    OC_WRN("%s pool exhausted", pool->name);
+#ifdef OC_POOL_STATS
+    oc_pool_stats_failed(stats);
+#endif /* OC_POOL_STATS */
+    return 0;
+  }
+  m->next = NULL;
+  m->ptr = pool->mem + (size_t)block * pool->granule_size;
+  m->size = size;
+  pool->avail -= items;
 #endif /* OC_DYNAMIC_ALLOCATION */
 
+#ifdef OC_POOL_STATS
+  if (stats != NULL) {
+    oc_pool_stats_allocated(
+      stats, (uint32_t)mmem_pool_stats_items(pool_type, size));
+  }
+#endif /* OC_POOL_STATS */
+
 #ifdef OC_MEMORY_TRACE
   oc_mem_trace_add_pace(func, bytes_allocated, MEM_TRACE_ALLOC, m->ptr);
 #endif
@@ -155,72 +454,43 @@ _oc_mmem_free(
     return;
   }
 
-#if defined(OC_MEMORY_TRAC) || !defined(OC_DYNAMIC_ALLOCATION)
-  const uint8_t type_size = memm_type_size(pool_type);
-#endif /* OC_MEMORY_TRACE || !OC_DYNAMIC_ALLOCATION */
-
 #ifdef OC_MEMORY_TRACE
+  const uint8_t type_size = memm_type_size(pool_type);
   unsigned int bytes_freed = m->size * type_size;
   oc_mem_trace_add_pace(func, bytes_freed, MEM_TRACE_FREE, m->ptr);
 #endif /* OC_MEMORY_TRACE */
 
 #ifndef OC_DYNAMIC_ALLOCATION
-  struct oc_mmem *n;
-
-  if (m->next != NULL) {
-    switch (pool_type) {
-    case BYTE_POOL:
-      memmove(m->ptr, m->next->ptr,
-              (&g_mmem_bytes[OC_BYTES_POOL_SIZE - g_mmem_avail_bytes] -
-               (unsigned char *)m->next->ptr) *
-                type_size);
-
-      break;
-    case INT_POOL:
-      memmove(m->ptr, m->next->ptr,
-              (&g_mmem_ints[OC_INTS_POOL_SIZE - g_mmem_avail_ints] -
-               (int64_t *)m->next->ptr) *
-                type_size);
-      break;
-    case DOUBLE_POOL:
-      memmove(m->ptr, m->next->ptr,
-              (&g_mmem_doubles[OC_DOUBLES_POOL_SIZE - g_mmem_avail_doubles] -
-               (double *)m->next->ptr) *
-                type_size);
-      break;
-    }
-    for (n = m->next; n != NULL; n = n->next) {
-      if (pool_type == BYTE_POOL) {
-        n->ptr = (void *)((unsigned char *)n->ptr - m->size);
-        continue;
-      }
-      if (pool_type == INT_POOL) {
-        n->ptr = (void *)((int64_t *)n->ptr - m->size);
-        continue;
-      }
-      if (pool_type == DOUBLE_POOL) {
-        n->ptr = (void *)((double *)n->ptr - m->size);
-        continue;
-      }
-    }
+  if (m->ptr == NULL) {
+    return;
+  }
+  mmem_pool_t *pool = &g_mmem_pools[pool_type];
+  const unsigned char *ptr = (const unsigned char *)m->ptr;
+  if (ptr < pool->mem ||
+      ptr >= pool->mem + (size_t)pool->granules * pool->granule_size) {
+    OC_ERR("pointer is not in the %s pool", pool->name);
+    return;
   }
+  uint16_t block = (uint16_t)((size_t)(ptr - pool->mem) / pool->granule_size);
+  if ((pool->tags[block] & MMEM_TAG_FREE) != 0) {
+    OC_ERR("block of the %s pool is already free", pool->name);
+    return;
+  }
+  mmem_pool_free(pool, block);
+  pool->avail +=
+    (size_t)mmem_pool_granules(pool, m->size) * pool->granule_items;
+#endif /* !OC_DYNAMIC_ALLOCATION */
 
-  switch (pool_type) {
-  case BYTE_POOL:
-    g_mmem_avail_bytes += m->size;
-    oc_list_remove(g_mmem_bytes_list, m);
-    break;
-  case INT_POOL:
-    g_mmem_avail_ints += m->size;
-    oc_list_remove(g_mmem_ints_list, m);
-    break;
-  case DOUBLE_POOL:
-    g_mmem_avail_doubles += m->size;
-    oc_list_remove(g_mmem_doubles_list, m);
-    break;
+#ifdef OC_POOL_STATS
+  if (m->ptr != NULL) {
+    oc_pool_stats_freed(mmem_pool_stats(pool_type),
+                        (uint32_t)mmem_pool_stats_items(pool_type, m->size));
   }
-#else  /* !OC_DYNAMIC_ALLOCATION */
+#else  /* !OC_POOL_STATS */
   (void)pool_type;
+#endif /* OC_POOL_STATS */
+
+#ifdef OC_DYNAMIC_ALLOCATION
   free(m->ptr);
   m->size = 0;
 #endif /* OC_DYNAMIC_ALLOCATION */
@@ -231,16 +501,10 @@ _oc_mmem_free(
 size_t
 oc_mmem_available_size(oc_mmem_pool_t pool_type)
 {
-  if (pool_type == BYTE_POOL) {
-    return g_mmem_avail_bytes;
+  if (!g_mmem_initialized) {
+    mmem_init_pools();
   }
-  if (pool_type == INT_POOL) {
-    return g_mmem_avail_ints;
-  }
-  if (pool_type == DOUBLE_POOL) {
-    return g_mmem_avail_doubles;
-  }
-  return 0;
+  return g_mmem_pools[pool_type].avail;
 }
 
 #endif /* !OC_DYNAMIC_ALLOCATION */
@@ -249,16 +513,9 @@ void
 oc_mmem_init(void)
 {
 #ifndef OC_DYNAMIC_ALLOCATION
-  static bool initialized = false;
-  if (initialized) {
+  if (g_mmem_initialized) {
     return;
   }
-  oc_list_init(g_mmem_bytes_list);
-  oc_list_init(g_mmem_ints_list);
-  oc_list_init(g_mmem_doubles_list);
-  g_mmem_avail_bytes = OC_BYTES_POOL_SIZE;
-  g_mmem_avail_ints = OC_INTS_POOL_SIZE;
-  g_mmem_avail_doubles = OC_DOUBLES_POOL_SIZE;
-  initialized = true;
+  mmem_init_pools();
 #endif /* OC_DYNAMIC_ALLOCATION */
 }
@@ -58,7 +58,7 @@ typedef enum {
 struct oc_mmem
 {
 #ifndef OC_DYNAMIC_ALLOCATION
-  struct oc_mmem *next; ///< Pointer to next block in memory pool.
+  struct oc_mmem *next; ///< Unused, kept for compatibility.
 #endif                  /* !OC_DYNAMIC_ALLOCATION */
   size_t size;          ///< Size of this block.
   void *ptr;            ///< Pointer to the memory.
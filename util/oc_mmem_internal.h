@@ -108,7 +108,13 @@ void _oc_mmem_free(
   struct oc_mmem *m, oc_mmem_pool_t pool_type);
 
 #ifndef OC_DYNAMIC_ALLOCATION
-/** Return the available allocation size for given pool */
+/**
+ * Return the available allocation size for given pool
+ *
+ * The size is the number of items (bytes, ints or doubles) not allocated.
+ * Allocations from the byte pool are rounded up to granules of 8 bytes, so an
+ * allocation reduces the available size by the rounded size.
+ */
 size_t oc_mmem_available_size(oc_mmem_pool_t pool_type);
 #endif /* !OC_DYNAMIC_ALLOCATION */
 
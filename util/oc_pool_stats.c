@@ -0,0 +1,141 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "oc_config.h"
+
+#ifdef OC_POOL_STATS
+
+#include "port/oc_log_internal.h"
+#include "util/oc_atomic.h"
+#include "util/oc_pool_stats_internal.h"
+
+#include <string.h>
+
+// pools are only prepended to the registry and never removed, so the list can
+// be traversed without a lock
+static oc_pool_stats_t *g_pool_stats = NULL;
+
+void
+oc_pool_stats_register(oc_pool_stats_t *stats, size_t block_size,
+                       size_t capacity)
+{
+  if (stats->name == NULL || OC_ATOMIC_LOAD8(stats->registered) != 0) {
+    return;
+  }
+  uint8_t expected = 0;
+  bool swapped = false;
+  OC_ATOMIC_COMPARE_AND_SWAP8(stats->registered, expected, 1, swapped);
+  if (!swapped) {
+    // registered by another thread
+    return;
+  }
+  stats->block_size = block_size;
+  stats->capacity = capacity;
+  oc_pool_stats_t *head = OC_ATOMIC_LOADPTR(g_pool_stats);
+  do {
+    stats->next = head;
+    OC_ATOMIC_COMPARE_AND_SWAPPTR(g_pool_stats, head, stats, swapped);
+  } while (!swapped);
+}
+
+void
+oc_pool_stats_allocated(oc_pool_stats_t *stats, uint32_t count)
+{
+  uint32_t used = OC_ATOMIC_ADD32(stats->used, count);
+  uint32_t peak = OC_ATOMIC_LOAD32(stats->peak);
+  while (used > peak) {
+    bool swapped = false;
+    OC_ATOMIC_COMPARE_AND_SWAP32(stats->peak, peak, used, swapped);
+    if (swapped) {
+      break;
+    }
+  }
+}
+
+void
+oc_pool_stats_freed(oc_pool_stats_t *stats, uint32_t count)
+{
+  uint32_t used = OC_ATOMIC_LOAD32(stats->used);
+  bool swapped = false;
+  do {
+    uint32_t desired = used > count ? used - count : 0;
+    OC_ATOMIC_COMPARE_AND_SWAP32(stats->used, used, desired, swapped);
+  } while (!swapped);
+}
+
+void
+oc_pool_stats_failed(oc_pool_stats_t *stats)
+{
+  OC_ATOMIC_INCREMENT32(stats->failures);
+}
+
+void
+oc_pool_stats_iterate(oc_pool_stats_iterate_fn_t fn, void *user_data)
+{
+  for (const oc_pool_stats_t *stats = OC_ATOMIC_LOADPTR(g_pool_stats);
+       stats != NULL; stats = stats->next) {
+    if (!fn(stats, user_data)) {
+      return;
+    }
+  }
+}
+
+const oc_pool_stats_t *
+oc_pool_stats_find(const char *name)
+{
+  for (const oc_pool_stats_t *stats = OC_ATOMIC_LOADPTR(g_pool_stats);
+       stats != NULL; stats = stats->next) {
+    if (strcmp(stats->name, name) == 0) {
+      return stats;
+    }
+  }
+  return NULL;
+}
+
+void
+oc_pool_stats_reset(void)
+{
+  for (oc_pool_stats_t *stats = OC_ATOMIC_LOADPTR(g_pool_stats); stats != NULL;
+       stats = stats->next) {
+    OC_ATOMIC_STORE32(stats->peak, OC_ATOMIC_LOAD32(stats->used));
+    OC_ATOMIC_STORE32(stats->failures, 0);
+  }
+}
+
+static bool
+pool_stats_print(const oc_pool_stats_t *stats, void *user_data)
+{
+  (void)user_data;
+  OC_PRINTF("%-32s %8u %8u %8u %8u %8u\n", stats->name,
+            (unsigned)stats->block_size, (unsigned)stats->capacity,
+            (unsigned)OC_ATOMIC_LOAD32(stats->used),
+            (unsigned)OC_ATOMIC_LOAD32(stats->peak),
+            (unsigned)OC_ATOMIC_LOAD32(stats->failures));
+  return true;
+}
+
+void
+oc_pool_stats_dump(void)
+{
+  OC_PRINTF("==================== memory pools ====================\n");
+  OC_PRINTF("%-32s %8s %8s %8s %8s %8s\n", "name", "block", "capacity",
+            "used", "peak", "failures");
+  oc_pool_stats_iterate(pool_stats_print, NULL);
+}
+
+#endif /* OC_POOL_STATS */
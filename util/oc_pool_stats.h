@@ -0,0 +1,114 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+/**
+ * @file oc_pool_stats.h
+ *
+ * @brief Usage statistics of the memory pools (OC_MEMB and mmem pools).
+ *
+ * A named pool registers itself on its first allocation. The statistics are
+ * available with the OC_POOL_STATS build option and they are printed by
+ * oc_main_shutdown.
+ */
+
+#ifndef OC_POOL_STATS_H
+#define OC_POOL_STATS_H
+
+#include "oc_config.h"
+
+#ifdef OC_POOL_STATS
+
+#include "oc_export.h"
+#include "util/oc_atomic.h"
+#include "util/oc_compiler.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Usage statistics of a memory pool. */
+typedef struct oc_pool_stats_t
+{
+  const char *name;             ///< name, NULL for unregistered pools
+  struct oc_pool_stats_t *next; ///< next registered pool
+  size_t block_size;            ///< size of a block in bytes
+  size_t capacity;              ///< number of blocks, 0 if unbounded
+  OC_ATOMIC_UINT32_T used;      ///< number of blocks in use
+  OC_ATOMIC_UINT32_T peak;      ///< highest number of blocks in use
+  OC_ATOMIC_UINT32_T failures;  ///< number of failed allocations
+  OC_ATOMIC_UINT8_T registered; ///< pool is in the registry
+} oc_pool_stats_t;
+
+/** @brief Initializer of the statistics of a pool. */
+#define OC_POOL_STATS_INIT(name)                                               \
+  {                                                                            \
+    (name), NULL, 0, 0, 0, 0, 0, 0                                             \
+  }
+
+/**
+ * @brief Callback invoked for each registered pool.
+ *
+ * @return true to continue the iteration
+ * @return false to stop the iteration
+ */
+typedef bool (*oc_pool_stats_iterate_fn_t)(const oc_pool_stats_t *stats,
+                                           void *user_data);
+
+/**
+ * @brief Iterate over the registered pools, the most recently registered pool
+ * goes first.
+ *
+ * @param fn callback invoked for each pool (cannot be NULL)
+ * @param user_data user data passed to the callback
+ */
+OC_API
+void oc_pool_stats_iterate(oc_pool_stats_iterate_fn_t fn, void *user_data)
+  OC_NONNULL(1);
+
+/**
+ * @brief Find the registered pool by name.
+ *
+ * @param name name of the pool (cannot be NULL)
+ * @return const oc_pool_stats_t* statistics of the pool
+ * @return NULL if no pool with the name is registered
+ */
+OC_API
+const oc_pool_stats_t *oc_pool_stats_find(const char *name) OC_NONNULL();
+
+/**
+ * @brief Reset the peak usage to the current usage and the failure counters of
+ * all registered pools.
+ */
+OC_API
+void oc_pool_stats_reset(void);
+
+/** @brief Print the statistics of the registered pools. */
+OC_API
+void oc_pool_stats_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OC_POOL_STATS */
+
+#endif /* OC_POOL_STATS_H */
@@ -0,0 +1,64 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#ifndef OC_POOL_STATS_INTERNAL_H
+#define OC_POOL_STATS_INTERNAL_H
+
+#include "util/oc_pool_stats.h"
+
+#ifdef OC_POOL_STATS
+
+#include "util/oc_compiler.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Add the pool to the registry.
+ *
+ * Pools without a name and already registered pools are skipped, so it is
+ * safe to call the function before each allocation.
+ *
+ * @param stats statistics of the pool (cannot be NULL)
+ * @param block_size size of a block in bytes
+ * @param capacity number of blocks, 0 if the pool is unbounded
+ */
+void oc_pool_stats_register(oc_pool_stats_t *stats, size_t block_size,
+                            size_t capacity) OC_NONNULL();
+
+/** @brief Record allocation of blocks and update the peak usage. */
+void oc_pool_stats_allocated(oc_pool_stats_t *stats, uint32_t count)
+  OC_NONNULL();
+
+/** @brief Record deallocation of blocks. */
+void oc_pool_stats_freed(oc_pool_stats_t *stats, uint32_t count) OC_NONNULL();
+
+/** @brief Record a failed allocation. */
+void oc_pool_stats_failed(oc_pool_stats_t *stats) OC_NONNULL();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OC_POOL_STATS */
+
+#endif /* OC_POOL_STATS_INTERNAL_H */
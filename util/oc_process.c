@@ -47,9 +47,9 @@
 #endif /* OC_SECURITY */
 
 #include <stdio.h>
+#include <string.h>
 #ifdef OC_DYNAMIC_ALLOCATION
 #include <stdlib.h>
-#include <string.h>
 #endif /* OC_DYNAMIC_ALLOCATION */
 
 /*
@@ -70,19 +70,47 @@ struct event_data
   struct oc_process *p;
 };
 
+#ifndef OC_PROCESS_NUMEVENTS
+/* Initial (with OC_DYNAMIC_ALLOCATION) or fixed size of an event queue */
+#define OC_PROCESS_NUMEVENTS (10)
+#endif /* !OC_PROCESS_NUMEVENTS */
+
 #ifdef OC_DYNAMIC_ALLOCATION
-static oc_process_num_events_t OC_PROCESS_NUMEVENTS = 10;
-#else /* OC_DYNAMIC_ALLOCATION */
-#define OC_PROCESS_NUMEVENTS 10
-#endif /* !OC_DYNAMIC_ALLOCATION */
+#ifndef OC_PROCESS_MAX_NUMEVENTS
+/* Maximal size of an event queue */
+#define OC_PROCESS_MAX_NUMEVENTS (1024)
+#endif /* !OC_PROCESS_MAX_NUMEVENTS */
+#endif /* OC_DYNAMIC_ALLOCATION */
+
+#ifndef OC_PROCESS_HIGH_PRIORITY_BURST
+/* Maximal number of high priority events delivered in a row when there are
+ * normal priority events waiting */
+#define OC_PROCESS_HIGH_PRIORITY_BURST (8)
+#endif /* !OC_PROCESS_HIGH_PRIORITY_BURST */
+
+#define OC_PROCESS_PRIORITIES (OC_PROCESS_PRIORITY_HIGH + 1)
 
-static oc_process_num_events_t g_nevents;
-static oc_process_num_events_t g_fevent;
+/*
+ * Ring buffer of events of a priority.
+ */
+typedef struct
+{
 #ifdef OC_DYNAMIC_ALLOCATION
-static struct event_data *g_events;
-#else  /* OC_DYNAMIC_ALLOCATION */
-static struct event_data g_events[OC_PROCESS_NUMEVENTS];
-#endif /* !OC_DYNAMIC_ALLOCATION */
+  struct event_data *events;
+#else  /* !OC_DYNAMIC_ALLOCATION */
+  struct event_data events[OC_PROCESS_NUMEVENTS];
+#endif /* OC_DYNAMIC_ALLOCATION */
+  oc_process_num_events_t size;
+  oc_process_num_events_t count;
+  oc_process_num_events_t first;
+  uint32_t dropped;
+} event_queue_t;
+
+static event_queue_t g_queues[OC_PROCESS_PRIORITIES];
+/* Bitmap of events posted with high priority by default */
+static uint8_t g_high_priority_events[(OC_PROCESS_EVENT_T_MAX + 1) / 8];
+/* Number of high priority events delivered in a row */
+static unsigned g_high_priority_burst;
 
 #ifdef OC_TEST
 #define OC_PROCESS_QUEUED_NUMEVENTS 128
@@ -237,28 +265,132 @@ oc_process_exit(struct oc_process *p)
   exit_process(p, OC_PROCESS_CURRENT());
 }
 
+static struct event_data *
+queue_event_at(event_queue_t *queue, oc_process_num_events_t i)
+{
+  return &queue->events[(queue->first + i) % queue->size];
+}
+
+static oc_process_num_events_t
+queues_count(void)
+{
+  oc_process_num_events_t count = 0;
+  for (int i = 0; i < OC_PROCESS_PRIORITIES; ++i) {
+    count += g_queues[i].count;
+  }
+  return count;
+}
+
+#ifdef OC_DYNAMIC_ALLOCATION
+static bool
+queue_grow(event_queue_t *queue)
+{
+  if (queue->size >= OC_PROCESS_MAX_NUMEVENTS) {
+    return false;
+  }
+  oc_process_num_events_t size = queue->size << 1;
+  if (size > OC_PROCESS_MAX_NUMEVENTS) {
+    size = OC_PROCESS_MAX_NUMEVENTS;
+  }
+  struct event_data *events =
+    (struct event_data *)calloc(size, sizeof(struct event_data));
+  if (events == NULL) {
+    return false;
+  }
+  // unwrap the ring to the start of the new buffer
+  for (oc_process_num_events_t i = 0; i < queue->count; ++i) {
+    events[i] = *queue_event_at(queue, i);
+  }
+  free(queue->events);
+  queue->events = events;
+  queue->size = size;
+  queue->first = 0;
+  return true;
+}
+#endif /* OC_DYNAMIC_ALLOCATION */
+
+static int
+queue_push(event_queue_t *queue, struct oc_process *p, oc_process_event_t ev,
+           oc_process_data_t data)
+{
+  if (queue->count == queue->size
+#ifdef OC_DYNAMIC_ALLOCATION
+      && !queue_grow(queue)
+#endif /* OC_DYNAMIC_ALLOCATION */
+  ) {
+    ++queue->dropped;
+    return OC_PROCESS_ERR_FULL;
+  }
+  struct event_data *event = queue_event_at(queue, queue->count);
+  event->ev = ev;
+  event->data = data;
+  event->p = p;
+  ++queue->count;
+  return OC_PROCESS_ERR_OK;
+}
+
+static struct event_data
+queue_pop(event_queue_t *queue)
+{
+  struct event_data event = queue->events[queue->first];
+  queue->first = (queue->first + 1) % queue->size;
+  --queue->count;
+  return event;
+}
+
+static int
+queue_drop(event_queue_t *queue, const struct oc_process *p,
+           oc_process_drop_event_t drop_event, const void *user_data)
+{
+  // keep the order of the remaining events
+  oc_process_num_events_t kept = 0;
+  for (oc_process_num_events_t i = 0; i < queue->count; ++i) {
+    struct event_data *event = queue_event_at(queue, i);
+    if (event->p == p && drop_event(event->ev, event->data, user_data)) {
+      continue;
+    }
+    if (kept != i) {
+      *queue_event_at(queue, kept) = *event;
+    }
+    ++kept;
+  }
+  int dropped = (int)(queue->count - kept);
+  queue->count = kept;
+  return dropped;
+}
+
 void
 oc_process_shutdown(void)
 {
 #ifdef OC_DYNAMIC_ALLOCATION
-  free(g_events);
+  for (int i = 0; i < OC_PROCESS_PRIORITIES; ++i) {
+    free(g_queues[i].events);
+    g_queues[i].events = NULL;
+  }
 #endif /* OC_DYNAMIC_ALLOCATION */
 }
 
 void
 oc_process_init(void)
 {
+  for (int i = 0; i < OC_PROCESS_PRIORITIES; ++i) {
+    event_queue_t *queue = &g_queues[i];
 #ifdef OC_DYNAMIC_ALLOCATION
-  g_events = (struct event_data *)calloc(OC_PROCESS_NUMEVENTS,
-                                         sizeof(struct event_data));
-  if (!g_events) {
-    oc_abort("Insufficient memory");
-  }
+    queue->events = (struct event_data *)calloc(OC_PROCESS_NUMEVENTS,
+                                                sizeof(struct event_data));
+    if (!queue->events) {
+      oc_abort("Insufficient memory");
+    }
 #endif /* OC_DYNAMIC_ALLOCATION */
+    queue->size = OC_PROCESS_NUMEVENTS;
+    queue->count = queue->first = 0;
+    queue->dropped = 0;
+  }
+  g_high_priority_burst = 0;
+  memset(g_high_priority_events, 0, sizeof(g_high_priority_events));
 
   oc_lastevent = OC_PROCESS_EVENT_MAX;
 
-  g_nevents = g_fevent = 0;
   oc_process_current = oc_process_list = NULL;
 }
 
@@ -282,6 +414,25 @@ do_poll(void)
   }
 }
 
+/*
+ * Select the queue of the next event, high priority events go first unless a
+ * normal priority event waits for a burst of high priority events.
+ */
+static event_queue_t *
+next_event_queue(void)
+{
+  event_queue_t *high = &g_queues[OC_PROCESS_PRIORITY_HIGH];
+  event_queue_t *normal = &g_queues[OC_PROCESS_PRIORITY_NORMAL];
+  if (high->count > 0 &&
+      (normal->count == 0 ||
+       g_high_priority_burst < OC_PROCESS_HIGH_PRIORITY_BURST)) {
+    ++g_high_priority_burst;
+    return high;
+  }
+  g_high_priority_burst = 0;
+  return normal->count > 0 ? normal : NULL;
+}
+
 /*
  * Process the next event in the event queue and deliver it to
  * listening processes.
@@ -302,19 +453,16 @@ do_event(void)
    * call the poll handlers inbetween.
    */
 
-  if (g_nevents <= 0) {
+  event_queue_t *queue = next_event_queue();
+  if (queue == NULL) {
     return;
   }
 
   /* There are events that we should deliver. */
-  ev = g_events[g_fevent].ev;
-  data = g_events[g_fevent].data;
-  receiver = g_events[g_fevent].p;
-
-  /* Since we have seen the new event, we move pointer upwards
-     and decrease the number of events. */
-  g_fevent = (g_fevent + 1) % OC_PROCESS_NUMEVENTS;
-  --g_nevents;
+  struct event_data event = queue_pop(queue);
+  ev = event.ev;
+  data = event.data;
+  receiver = event.p;
 
   /* If this is a broadcast event, we deliver it to all events, in
      order of their priority. */
@@ -353,13 +501,13 @@ oc_process_run(void)
   /* Process one event from the queue */
   do_event();
 
-  return (int)g_nevents + OC_ATOMIC_LOAD8(g_poll_requested);
+  return (int)queues_count() + OC_ATOMIC_LOAD8(g_poll_requested);
 }
 
 int
 oc_process_nevents(void)
 {
-  return (int)g_nevents + OC_ATOMIC_LOAD8(g_poll_requested);
+  return (int)queues_count() + OC_ATOMIC_LOAD8(g_poll_requested);
 }
 
 bool
@@ -374,10 +522,12 @@ oc_process_is_closing_all_tls_sessions(void)
 {
   const oc_process_event_t tls_close =
     oc_event_to_oc_process_event(TLS_CLOSE_ALL_SESSIONS);
-  for (oc_process_num_events_t i = 0; i < g_nevents; ++i) {
-    oc_process_num_events_t index = (g_fevent + i) % OC_PROCESS_NUMEVENTS;
-    if (g_events[index].ev == tls_close) {
-      return true;
+  for (int i = 0; i < OC_PROCESS_PRIORITIES; ++i) {
+    event_queue_t *queue = &g_queues[i];
+    for (oc_process_num_events_t j = 0; j < queue->count; ++j) {
+      if (queue_event_at(queue, j)->ev == tls_close) {
+        return true;
+      }
     }
   }
   return false;
@@ -387,11 +537,13 @@ oc_process_is_closing_all_tls_sessions(void)
 void
 oc_process_iterate_events(oc_process_iterate_event_fn_t fn, void *fn_data)
 {
-  for (oc_process_num_events_t i = 0; i < g_nevents; ++i) {
-    oc_process_num_events_t index = (g_fevent + i) % OC_PROCESS_NUMEVENTS;
-    struct event_data *event = &g_events[index];
-    if (!fn(event->p, event->ev, event->data, fn_data)) {
-      return;
+  for (int i = OC_PROCESS_PRIORITY_HIGH; i >= 0; --i) {
+    event_queue_t *queue = &g_queues[i];
+    for (oc_process_num_events_t j = 0; j < queue->count; ++j) {
+      const struct event_data *event = queue_event_at(queue, j);
+      if (!fn(event->p, event->ev, event->data, fn_data)) {
+        return;
+      }
     }
   }
 }
@@ -406,78 +558,58 @@ oc_process_drop(const struct oc_process *p, oc_process_drop_event_t drop_event,
     return dropped;
   }
 
-  oc_process_num_events_t i = 0;
-  while (i < g_nevents) {
-    oc_process_num_events_t index = (g_fevent + i) % OC_PROCESS_NUMEVENTS;
-    struct event_data *event = &g_events[index];
-    if (event->p != p || !drop_event(event->ev, event->data, user_data)) {
-      // move to the next event
-      ++i;
-      continue;
-    }
-    // we have a match, drop the event and move the last event to its position
-    if (g_nevents > 1) {
-      oc_process_num_events_t last_index =
-        (g_fevent + g_nevents - 1) % OC_PROCESS_NUMEVENTS;
-
-      if (last_index >= index) {
-        memmove(event, event + 1,
-                (last_index - index) * sizeof(struct event_data));
-      } else {
-        // Handle rotation when last_index is wrapped around to the beginning of
-        // the array
-        memmove(event, event + 1,
-                (OC_PROCESS_NUMEVENTS - 1 - index) * sizeof(struct event_data));
-        g_events[OC_PROCESS_NUMEVENTS - 1] = g_events[0];
-        memmove(g_events, g_events + 1, last_index * sizeof(struct event_data));
-      }
-    }
-    --g_nevents;
-    ++dropped;
+  for (int i = 0; i < OC_PROCESS_PRIORITIES; ++i) {
+    dropped += queue_drop(&g_queues[i], p, drop_event, user_data);
   }
   return dropped;
 }
 
 int
-oc_process_post(struct oc_process *p, oc_process_event_t ev,
-                oc_process_data_t data)
+oc_process_post_with_priority(struct oc_process *p, oc_process_event_t ev,
+                              oc_process_data_t data,
+                              oc_process_priority_t priority)
 {
-  static oc_process_num_events_t snum;
+  if ((int)priority < 0 || (int)priority >= OC_PROCESS_PRIORITIES) {
+    priority = OC_PROCESS_PRIORITY_NORMAL;
+  }
+  return queue_push(&g_queues[priority], p, ev, data);
+}
 
-  if (g_nevents == OC_PROCESS_NUMEVENTS) {
-#ifdef OC_DYNAMIC_ALLOCATION
-    OC_PROCESS_NUMEVENTS <<= 1;
-    struct event_data *events = (struct event_data *)realloc(
-      g_events, OC_PROCESS_NUMEVENTS * sizeof(struct event_data));
-    if (events == NULL) {
-      oc_abort("Insufficient memory");
-    }
-    g_events = events;
-    oc_process_num_events_t i = g_fevent;
-    oc_process_num_events_t n = g_nevents - g_fevent;
-    oc_process_num_events_t j = 0;
-    while (i < (OC_PROCESS_NUMEVENTS - n)) {
-      if (i < g_nevents) {
-        memcpy(&g_events[OC_PROCESS_NUMEVENTS - n + j], &g_events[i],
-               sizeof(struct event_data));
-        j++;
-      }
-      memset(&g_events[i], 0, sizeof(struct event_data));
-      i++;
-    }
-    g_fevent = OC_PROCESS_NUMEVENTS - n;
-#else  /* OC_DYNAMIC_ALLOCATION */
-    return OC_PROCESS_ERR_FULL;
-#endif /* !OC_DYNAMIC_ALLOCATION */
+void
+oc_process_set_event_priority(oc_process_event_t ev,
+                              oc_process_priority_t priority)
+{
+  uint8_t mask = (uint8_t)(1 << (ev % 8));
+  if (priority == OC_PROCESS_PRIORITY_HIGH) {
+    g_high_priority_events[ev / 8] |= mask;
+  } else {
+    g_high_priority_events[ev / 8] &= (uint8_t)~mask;
   }
+}
 
-  snum = (g_fevent + g_nevents) % OC_PROCESS_NUMEVENTS;
-  g_events[snum].ev = ev;
-  g_events[snum].data = data;
-  g_events[snum].p = p;
-  ++g_nevents;
+oc_process_priority_t
+oc_process_event_priority(oc_process_event_t ev)
+{
+  return (g_high_priority_events[ev / 8] & (1 << (ev % 8))) != 0
+           ? OC_PROCESS_PRIORITY_HIGH
+           : OC_PROCESS_PRIORITY_NORMAL;
+}
 
-  return OC_PROCESS_ERR_OK;
+int
+oc_process_post(struct oc_process *p, oc_process_event_t ev,
+                oc_process_data_t data)
+{
+  return oc_process_post_with_priority(p, ev, data,
+                                       oc_process_event_priority(ev));
+}
+
+uint32_t
+oc_process_dropped_events(oc_process_priority_t priority)
+{
+  if ((int)priority < 0 || (int)priority >= OC_PROCESS_PRIORITIES) {
+    return 0;
+  }
+  return g_queues[priority].dropped;
 }
 
 void
@@ -511,9 +643,9 @@ oc_process_is_running(const struct oc_process *p)
 #ifdef OC_TEST
 
 oc_process_num_events_t
-oc_process_num_events(void)
+oc_process_num_events(oc_process_priority_t priority)
 {
-  return OC_PROCESS_NUMEVENTS;
+  return g_queues[priority].size;
 }
 
 void
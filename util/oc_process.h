@@ -46,6 +46,7 @@
 #include "util/oc_atomic.h"
 #include "util/pt/pt.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -56,6 +57,7 @@ extern "C" {
 #endif /* NULL */
 
 typedef unsigned char oc_process_event_t;
+#define OC_PROCESS_EVENT_T_MAX (UINT8_MAX)
 typedef void *oc_process_data_t;
 #ifdef OC_DYNAMIC_ALLOCATION
 typedef unsigned long oc_process_num_events_t;
@@ -354,6 +356,9 @@ void oc_process_start(struct oc_process *p, oc_process_data_t data);
  * all processes, in which case all processes in the system will be
  * scheduled to handle the event.
  *
+ * The event is posted with the priority set by
+ * oc_process_set_event_priority.
+ *
  * \param ev The event to be posted.
  *
  * \param data The auxiliary data to be sent with the event
@@ -369,6 +374,75 @@ void oc_process_start(struct oc_process *p, oc_process_data_t data);
 int oc_process_post(struct oc_process *p, oc_process_event_t ev,
                     oc_process_data_t data);
 
+/**
+ * \brief Priority of an asynchronous event.
+ *
+ * Events of each priority are kept in a separate queue. Events of high
+ * priority are delivered first, but an event of normal priority is delivered
+ * after a burst of high priority events so the normal events are not starved.
+ */
+typedef enum oc_process_priority_t {
+  OC_PROCESS_PRIORITY_NORMAL = 0, ///< timers and housekeeping
+  OC_PROCESS_PRIORITY_HIGH,       ///< network and security
+} oc_process_priority_t;
+
+/**
+ * Post an asynchronous event with a priority.
+ *
+ * With OC_DYNAMIC_ALLOCATION the queue of the priority grows up to
+ * OC_PROCESS_MAX_NUMEVENTS events, otherwise it holds OC_PROCESS_NUMEVENTS
+ * events. An event posted to a full queue is dropped and counted.
+ *
+ * \param p The process to which the event should be posted, or
+ * OC_PROCESS_BROADCAST if the event should be posted to all processes.
+ *
+ * \param ev The event to be posted.
+ *
+ * \param data The auxiliary data to be sent with the event
+ *
+ * \param priority The priority of the event.
+ *
+ * \retval OC_PROCESS_ERR_OK The event could be posted.
+ *
+ * \retval OC_PROCESS_ERR_FULL The event queue was full and the event could
+ * not be posted.
+ *
+ * \see oc_process_dropped_events
+ */
+int oc_process_post_with_priority(struct oc_process *p, oc_process_event_t ev,
+                                  oc_process_data_t data,
+                                  oc_process_priority_t priority);
+
+/**
+ * Set the priority used by oc_process_post for the event.
+ *
+ * All events have normal priority after oc_process_init.
+ *
+ * \param ev The event.
+ *
+ * \param priority The priority of the event.
+ */
+void oc_process_set_event_priority(oc_process_event_t ev,
+                                   oc_process_priority_t priority);
+
+/**
+ * Get the priority used by oc_process_post for the event.
+ *
+ * \param ev The event.
+ *
+ * \return The priority of the event.
+ */
+oc_process_priority_t oc_process_event_priority(oc_process_event_t ev);
+
+/**
+ * Number of events dropped because the event queue of the priority was full.
+ *
+ * \param priority The priority of the event queue.
+ *
+ * \return The number of dropped events since oc_process_init.
+ */
+uint32_t oc_process_dropped_events(oc_process_priority_t priority);
+
 /**
  * @brief This function is responsible for determining whether an event should
  * be removed from the event queue of a given process.
@@ -78,8 +78,8 @@ void oc_process_iterate_events(oc_process_iterate_event_fn_t fn, void *fn_data)
 
 #ifdef OC_TEST
 
-/** @brief Get the maximal number of events */
-oc_process_num_events_t oc_process_num_events(void);
+/** @brief Get the current size of the event queue of the priority */
+oc_process_num_events_t oc_process_num_events(oc_process_priority_t priority);
 
 /**
  * @brief Temporarily suspend a process.
@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "util/oc_features.h"
+
+#ifdef OC_HAS_FEATURE_ATOM_TABLE
+
+#include "util/oc_atom_internal.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+class TestAtom : public testing::Test {
+public:
+  void TearDown() override { oc_atom_table_clear(); }
+};
+
+TEST_F(TestAtom, Intern)
+{
+  std::string rt = "oic.r.switch.binary";
+  oc_atom_t atom = oc_atom_intern(rt.c_str(), rt.length());
+  EXPECT_NE(OC_ATOM_NONE, atom);
+  EXPECT_EQ(1, oc_atom_count());
+
+  // equal strings are interned to the same atom
+  std::string copy = rt;
+  EXPECT_EQ(atom, oc_atom_intern(copy.c_str(), copy.length()));
+  EXPECT_EQ(1, oc_atom_count());
+
+  size_t len = 0;
+  const char *str = oc_atom_string(atom, &len);
+  ASSERT_NE(nullptr, str);
+  EXPECT_EQ(rt, std::string(str, len));
+
+  // prefix is a different string
+  oc_atom_t prefix = oc_atom_intern(rt.c_str(), rt.length() - 1);
+  EXPECT_NE(OC_ATOM_NONE, prefix);
+  EXPECT_NE(atom, prefix);
+  EXPECT_EQ(2, oc_atom_count());
+}
+
+TEST_F(TestAtom, Find)
+{
+  std::string rt = "oic.r.temperature";
+  EXPECT_EQ(OC_ATOM_NONE, oc_atom_find(rt.c_str(), rt.length()));
+
+  oc_atom_t atom = oc_atom_intern(rt.c_str(), rt.length());
+  EXPECT_EQ(atom, oc_atom_find(rt.c_str(), rt.length()));
+  EXPECT_EQ(OC_ATOM_NONE, oc_atom_find("oic.r.light", 11));
+  EXPECT_EQ(1, oc_atom_count());
+}
+
+TEST_F(TestAtom, String_F)
+{
+  EXPECT_EQ(nullptr, oc_atom_string(OC_ATOM_NONE, nullptr));
+  EXPECT_EQ(nullptr, oc_atom_string(42, nullptr));
+}
+
+TEST_F(TestAtom, Many)
+{
+  // enough strings to resize the table several times
+  std::vector<oc_atom_t> atoms;
+  for (int i = 0; i < 1000; ++i) {
+    std::string str = "oic.r.test." + std::to_string(i);
+    oc_atom_t atom = oc_atom_intern(str.c_str(), str.length());
+    ASSERT_NE(OC_ATOM_NONE, atom);
+    atoms.push_back(atom);
+  }
+  EXPECT_EQ(atoms.size(), oc_atom_count());
+
+  for (size_t i = 0; i < atoms.size(); ++i) {
+    std::string str = "oic.r.test." + std::to_string(i);
+    EXPECT_EQ(atoms[i], oc_atom_find(str.c_str(), str.length()));
+    EXPECT_STREQ(str.c_str(), oc_atom_string(atoms[i], nullptr));
+  }
+
+  oc_atom_table_clear();
+  EXPECT_EQ(0, oc_atom_count());
+  EXPECT_EQ(nullptr, oc_atom_string(atoms[0], nullptr));
+}
+
+#endif /* OC_HAS_FEATURE_ATOM_TABLE */
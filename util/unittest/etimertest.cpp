@@ -167,7 +167,8 @@ TEST_F(TestEventTimer, ProcessTimeoutEvent)
   // for static allocated process event queue this means that the expired timer
   // won't be able to post OC_PROCESS_EVENT_TIMER currently, but it should be
   // retried and succeed eventually
-  oc_process_num_events_t size = oc_process_num_events();
+  oc_process_num_events_t size =
+    oc_process_num_events(OC_PROCESS_PRIORITY_NORMAL);
   for (size_t i = 0; i < size; ++i) {
     oc_process_post(&oc_etimer_process, OC_PROCESS_EVENT_CONTINUE, nullptr);
   }
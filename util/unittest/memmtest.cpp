@@ -20,7 +20,15 @@
 
 #include "gtest/gtest.h"
 
+#include <array>
 #include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifndef OC_DYNAMIC_ALLOCATION
+// allocations from the byte pool are rounded up to granules of 8 bytes
+constexpr size_t kByteGranule = 8;
+#endif // OC_DYNAMIC_ALLOCATION
 
 class TestMemoryPool : public testing::Test {
 public:
@@ -102,7 +110,7 @@ TEST_F(TestMemoryPool, AllocateMultipleBytes)
   ASSERT_NE(byte1.ptr, nullptr);
   ASSERT_EQ(byte1.size, 1);
 #ifndef OC_DYNAMIC_ALLOCATION
-  EXPECT_EQ(bytePoolSize - 1, oc_mmem_available_size(BYTE_POOL));
+  EXPECT_EQ(bytePoolSize - kByteGranule, oc_mmem_available_size(BYTE_POOL));
 #endif // OC_DYNAMIC_ALLOCATION
   uint8_t byte1Value = 0x42;
   memcpy(byte1.ptr, &byte1Value, 1);
@@ -113,7 +121,8 @@ TEST_F(TestMemoryPool, AllocateMultipleBytes)
   ASSERT_NE(byte2.ptr, nullptr);
   ASSERT_EQ(byte2.size, 1);
 #ifndef OC_DYNAMIC_ALLOCATION
-  EXPECT_EQ(bytePoolSize - 2, oc_mmem_available_size(BYTE_POOL));
+  EXPECT_EQ(bytePoolSize - 2 * kByteGranule,
+            oc_mmem_available_size(BYTE_POOL));
 #endif // OC_DYNAMIC_ALLOCATION
   uint8_t byte2Value = 0x43;
   memcpy(byte2.ptr, &byte2Value, 1);
@@ -126,7 +135,7 @@ TEST_F(TestMemoryPool, AllocateMultipleBytes)
 
   oc_mmem_free(&byte1, BYTE_POOL);
 #ifndef OC_DYNAMIC_ALLOCATION
-  EXPECT_EQ(bytePoolSize - 1, oc_mmem_available_size(BYTE_POOL));
+  EXPECT_EQ(bytePoolSize - kByteGranule, oc_mmem_available_size(BYTE_POOL));
 #endif // OC_DYNAMIC_ALLOCATION
   memcpy(&exp, byte2.ptr, 1);
   EXPECT_EQ(exp, byte2Value);
@@ -285,4 +294,100 @@ TEST_F(TestMemoryPool, ExhaustDoublePool)
   ASSERT_EQ(doublePoolSize, oc_mmem_available_size(DOUBLE_POOL));
 }
 
+TEST_F(TestMemoryPool, BytePoolGranules)
+{
+  size_t bytePoolSize = oc_mmem_available_size(BYTE_POOL);
+  ASSERT_EQ(0, bytePoolSize % kByteGranule);
+
+  // the available size is reduced by whole granules
+  std::array<oc_mmem, 4> blocks{};
+  std::array<size_t, 4> sizes{ 1, kByteGranule, kByteGranule + 1,
+                               2 * kByteGranule };
+  size_t used = 0;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    ASSERT_EQ(sizes[i], oc_mmem_alloc(&blocks[i], sizes[i], BYTE_POOL));
+    used += (sizes[i] + kByteGranule - 1) / kByteGranule * kByteGranule;
+    EXPECT_EQ(bytePoolSize - used, oc_mmem_available_size(BYTE_POOL));
+  }
+
+  // the rest of the pool can be allocated
+  oc_mmem rest{};
+  size_t restSize = oc_mmem_available_size(BYTE_POOL);
+  ASSERT_EQ(restSize, oc_mmem_alloc(&rest, restSize, BYTE_POOL));
+  EXPECT_EQ(0, oc_mmem_available_size(BYTE_POOL));
+  oc_mmem_free(&rest, BYTE_POOL);
+
+  for (auto &block : blocks) {
+    oc_mmem_free(&block, BYTE_POOL);
+  }
+  EXPECT_EQ(bytePoolSize, oc_mmem_available_size(BYTE_POOL));
+}
+
+TEST_F(TestMemoryPool, BytePoolFitInClass)
+{
+  size_t bytePoolSize = oc_mmem_available_size(BYTE_POOL);
+
+  // two free blocks of 2 and 3 granules (same class) separated by allocated
+  // blocks and no other free block
+  std::array<oc_mmem, 4> blocks{};
+  std::array<size_t, 4> sizes{ 2 * kByteGranule, kByteGranule,
+                               3 * kByteGranule, kByteGranule };
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    ASSERT_EQ(sizes[i], oc_mmem_alloc(&blocks[i], sizes[i], BYTE_POOL));
+  }
+  oc_mmem rest{};
+  size_t restSize = oc_mmem_available_size(BYTE_POOL);
+  ASSERT_EQ(restSize, oc_mmem_alloc(&rest, restSize, BYTE_POOL));
+  void *ptr = blocks[2].ptr;
+  oc_mmem_free(&blocks[2], BYTE_POOL);
+  oc_mmem_free(&blocks[0], BYTE_POOL);
+
+  // the 3 granule block is found behind the smaller head of the class
+  oc_mmem fit{};
+  ASSERT_EQ(3 * kByteGranule, oc_mmem_alloc(&fit, 3 * kByteGranule, BYTE_POOL));
+  EXPECT_EQ(ptr, fit.ptr);
+
+  oc_mmem_free(&fit, BYTE_POOL);
+  oc_mmem_free(&rest, BYTE_POOL);
+  oc_mmem_free(&blocks[1], BYTE_POOL);
+  oc_mmem_free(&blocks[3], BYTE_POOL);
+  EXPECT_EQ(bytePoolSize, oc_mmem_available_size(BYTE_POOL));
+}
+
+TEST_F(TestMemoryPool, StablePointers)
+{
+  size_t bytePoolSize = oc_mmem_available_size(BYTE_POOL);
+  std::array<oc_mmem, 3> blocks{};
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    ASSERT_EQ(i + 10, oc_mmem_alloc(&blocks[i], i + 10, BYTE_POOL));
+    memset(blocks[i].ptr, static_cast<int>(i + 1), blocks[i].size);
+  }
+
+  // freeing a block doesn't move the others
+  std::array<void *, 3> ptrs{};
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    ptrs[i] = blocks[i].ptr;
+  }
+  oc_mmem_free(&blocks[0], BYTE_POOL);
+  for (size_t i = 1; i < blocks.size(); ++i) {
+    EXPECT_EQ(ptrs[i], blocks[i].ptr);
+    std::vector<uint8_t> expected(blocks[i].size, static_cast<uint8_t>(i + 1));
+    EXPECT_EQ(0, memcmp(expected.data(), blocks[i].ptr, expected.size()));
+  }
+
+  // freed blocks are reused
+  oc_mmem reused{};
+  ASSERT_EQ(10, oc_mmem_alloc(&reused, 10, BYTE_POOL));
+  EXPECT_EQ(ptrs[0], reused.ptr);
+  oc_mmem_free(&reused, BYTE_POOL);
+
+  // free blocks are coalesced, so the whole pool can be allocated again
+  oc_mmem_free(&blocks[2], BYTE_POOL);
+  oc_mmem_free(&blocks[1], BYTE_POOL);
+  ASSERT_EQ(bytePoolSize, oc_mmem_available_size(BYTE_POOL));
+  oc_mmem bytes{};
+  ASSERT_EQ(bytePoolSize, oc_mmem_alloc(&bytes, bytePoolSize, BYTE_POOL));
+  oc_mmem_free(&bytes, BYTE_POOL);
+}
+
 #endif // OC_DYNAMIC_ALLOCATION
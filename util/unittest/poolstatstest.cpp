@@ -0,0 +1,182 @@
+/****************************************************************************
+ *
+ * Copyright (c) 2024 plgd.dev s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ *
+ ****************************************************************************/
+
+#include "oc_config.h"
+
+#ifdef OC_POOL_STATS
+
+#include "util/oc_memb.h"
+#include "util/oc_mmem_internal.h"
+#include "util/oc_pool_stats.h"
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+struct test_data_t
+{
+  int a;
+  int b;
+};
+
+OC_MEMB(g_pool_stats_test, test_data_t, 4);
+
+#ifdef OC_DYNAMIC_ALLOCATION
+OC_MEMB_STATIC(g_pool_stats_fixed, test_data_t, 2);
+#else  /* !OC_DYNAMIC_ALLOCATION */
+OC_MEMB(g_pool_stats_fixed, test_data_t, 2);
+#endif /* OC_DYNAMIC_ALLOCATION */
+
+class TestPoolStats : public testing::Test {
+public:
+  static void SetUpTestCase() { oc_mmem_init(); }
+
+  void SetUp() override { oc_pool_stats_reset(); }
+};
+
+TEST_F(TestPoolStats, Register)
+{
+  void *block = oc_memb_alloc(&g_pool_stats_test);
+  ASSERT_NE(nullptr, block);
+  const oc_pool_stats_t *stats = oc_pool_stats_find("g_pool_stats_test");
+  ASSERT_NE(nullptr, stats);
+  EXPECT_EQ(&g_pool_stats_test.stats, stats);
+  EXPECT_EQ(sizeof(test_data_t), stats->block_size);
+#ifdef OC_DYNAMIC_ALLOCATION
+  EXPECT_EQ(0, stats->capacity);
+#else  /* !OC_DYNAMIC_ALLOCATION */
+  EXPECT_EQ(4, stats->capacity);
+#endif /* OC_DYNAMIC_ALLOCATION */
+  EXPECT_EQ(0, oc_memb_free(&g_pool_stats_test, block));
+
+  // registered only once
+  block = oc_memb_alloc(&g_pool_stats_test);
+  ASSERT_NE(nullptr, block);
+  size_t count = 0;
+  oc_pool_stats_iterate(
+    [](const oc_pool_stats_t *s, void *data) {
+      if (std::string(s->name) == "g_pool_stats_test") {
+        ++*static_cast<size_t *>(data);
+      }
+      return true;
+    },
+    &count);
+  EXPECT_EQ(1, count);
+  EXPECT_EQ(0, oc_memb_free(&g_pool_stats_test, block));
+}
+
+TEST_F(TestPoolStats, UsageAndPeak)
+{
+  std::array<void *, 3> blocks{};
+  for (auto &block : blocks) {
+    block = oc_memb_alloc(&g_pool_stats_test);
+    ASSERT_NE(nullptr, block);
+  }
+  EXPECT_EQ(3, g_pool_stats_test.stats.used);
+  EXPECT_EQ(3, g_pool_stats_test.stats.peak);
+
+  EXPECT_EQ(0, oc_memb_free(&g_pool_stats_test, blocks[0]));
+  EXPECT_EQ(0, oc_memb_free(&g_pool_stats_test, blocks[1]));
+  EXPECT_EQ(1, g_pool_stats_test.stats.used);
+  EXPECT_EQ(3, g_pool_stats_test.stats.peak);
+
+  oc_pool_stats_reset();
+  EXPECT_EQ(1, g_pool_stats_test.stats.peak);
+  EXPECT_EQ(0, oc_memb_free(&g_pool_stats_test, blocks[2]));
+  EXPECT_EQ(0, g_pool_stats_test.stats.used);
+}
+
+TEST_F(TestPoolStats, Exhausted)
+{
+  std::array<void *, 2> blocks{};
+  for (auto &block : blocks) {
+    block = oc_memb_alloc(&g_pool_stats_fixed);
+    ASSERT_NE(nullptr, block);
+  }
+  EXPECT_EQ(nullptr, oc_memb_alloc(&g_pool_stats_fixed));
+  EXPECT_EQ(nullptr, oc_memb_alloc(&g_pool_stats_fixed));
+  const oc_pool_stats_t *stats = oc_pool_stats_find("g_pool_stats_fixed");
+  ASSERT_NE(nullptr, stats);
+  EXPECT_EQ(2, stats->capacity);
+  EXPECT_EQ(2, stats->used);
+  EXPECT_EQ(2, stats->peak);
+  EXPECT_EQ(2, stats->failures);
+
+  for (auto *block : blocks) {
+    EXPECT_EQ(0, oc_memb_free(&g_pool_stats_fixed, block));
+  }
+  EXPECT_EQ(0, stats->used);
+  // freeing a block twice doesn't change the usage
+  EXPECT_EQ(0, oc_memb_free(&g_pool_stats_fixed, blocks[0]));
+  EXPECT_EQ(0, stats->used);
+
+  oc_pool_stats_reset();
+  EXPECT_EQ(0, stats->failures);
+}
+
+TEST_F(TestPoolStats, LocalPoolNotRegistered)
+{
+  OC_MEMB_LOCAL(local_pool, test_data_t, 1);
+  void *block = oc_memb_alloc(&local_pool);
+  ASSERT_NE(nullptr, block);
+  EXPECT_EQ(nullptr, oc_pool_stats_find("local_pool"));
+  EXPECT_EQ(0, oc_memb_free(&local_pool, block));
+}
+
+TEST_F(TestPoolStats, Mmem)
+{
+  oc_mmem bytes{};
+  ASSERT_EQ(5, oc_mmem_alloc(&bytes, 5, BYTE_POOL));
+  const oc_pool_stats_t *stats = oc_pool_stats_find("mmem_bytes");
+  ASSERT_NE(nullptr, stats);
+  EXPECT_EQ(sizeof(uint8_t), stats->block_size);
+#ifdef OC_DYNAMIC_ALLOCATION
+  EXPECT_EQ(5, stats->used);
+  EXPECT_EQ(5, stats->peak);
+#else  /* !OC_DYNAMIC_ALLOCATION */
+  // byte allocations take whole granules of 8 bytes from the pool
+  EXPECT_EQ(8, stats->used);
+  EXPECT_EQ(8, stats->peak);
+  EXPECT_EQ(0, stats->capacity % 8);
+  EXPECT_LE(static_cast<size_t>(OC_BYTES_POOL_SIZE), stats->capacity);
+#endif /* OC_DYNAMIC_ALLOCATION */
+
+  oc_mmem doubles{};
+  ASSERT_EQ(2 * sizeof(double), oc_mmem_alloc(&doubles, 2, DOUBLE_POOL));
+  stats = oc_pool_stats_find("mmem_doubles");
+  ASSERT_NE(nullptr, stats);
+  EXPECT_EQ(sizeof(double), stats->block_size);
+  EXPECT_EQ(2, stats->used);
+
+  oc_mmem_free(&doubles, DOUBLE_POOL);
+  EXPECT_EQ(0, stats->used);
+  oc_mmem_free(&bytes, BYTE_POOL);
+  EXPECT_EQ(0, oc_pool_stats_find("mmem_bytes")->used);
+}
+
+TEST_F(TestPoolStats, Dump)
+{
+  void *block = oc_memb_alloc(&g_pool_stats_test);
+  ASSERT_NE(nullptr, block);
+  oc_pool_stats_dump();
+  EXPECT_EQ(0, oc_memb_free(&g_pool_stats_test, block));
+}
+
+#endif /* OC_POOL_STATS */
@@ -30,6 +30,9 @@
 #include "gtest/gtest.h"
 
 #include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
 
 using namespace std::chrono_literals;
 
@@ -49,6 +52,23 @@ OC_PROCESS_THREAD(test_process, ev, data)
   OC_PROCESS_END();
 }
 
+static oc_process_event_t g_recorded_event{ OC_PROCESS_EVENT_NONE };
+static std::vector<intptr_t> g_received{};
+
+OC_PROCESS(recording_process, "Recording process");
+
+OC_PROCESS_THREAD(recording_process, ev, data)
+{
+  OC_PROCESS_BEGIN();
+  while (oc_process_is_running(&recording_process)) {
+    OC_PROCESS_YIELD();
+    if (ev == g_recorded_event) {
+      g_received.push_back(reinterpret_cast<intptr_t>(data));
+    }
+  }
+  OC_PROCESS_END();
+}
+
 class TestProcess : public testing::Test {
 public:
   static void SetUpTestCase()
@@ -79,6 +99,156 @@ TEST_F(TestProcess, Start)
   EXPECT_EQ(0, oc_process_is_running(&test_process));
 }
 
+#ifdef OC_TEST
+
+class TestProcessQueue : public testing::Test {
+public:
+  void SetUp() override
+  {
+    oc_process_init();
+    g_recorded_event = oc_process_alloc_event();
+    oc_process_start(&recording_process, nullptr);
+    g_received.clear();
+    queueSize_ = oc_process_num_events(OC_PROCESS_PRIORITY_NORMAL);
+  }
+
+  void TearDown() override
+  {
+    oc_process_exit(&recording_process);
+    oc_process_shutdown();
+  }
+
+  static void Post(intptr_t value, oc_process_priority_t priority)
+  {
+    ASSERT_EQ(OC_PROCESS_ERR_OK,
+              oc_process_post_with_priority(
+                &recording_process, g_recorded_event,
+                reinterpret_cast<oc_process_data_t>(value), priority));
+  }
+
+  static void Run()
+  {
+    while (oc_process_run() > 0) {
+      // process all events
+    }
+  }
+
+  int queueSize_{ 0 };
+};
+
+TEST_F(TestProcessQueue, HighPriorityFirst)
+{
+  Post(1, OC_PROCESS_PRIORITY_NORMAL);
+  Post(2, OC_PROCESS_PRIORITY_HIGH);
+  Post(3, OC_PROCESS_PRIORITY_NORMAL);
+  Post(4, OC_PROCESS_PRIORITY_HIGH);
+  EXPECT_EQ(4, oc_process_nevents());
+  Run();
+  EXPECT_EQ((std::vector<intptr_t>{ 2, 4, 1, 3 }), g_received);
+}
+
+TEST_F(TestProcessQueue, EventPriority)
+{
+  EXPECT_EQ(OC_PROCESS_PRIORITY_NORMAL,
+            oc_process_event_priority(g_recorded_event));
+  ASSERT_EQ(OC_PROCESS_ERR_OK,
+            oc_process_post(&recording_process, g_recorded_event,
+                            reinterpret_cast<oc_process_data_t>(1)));
+  oc_process_set_event_priority(g_recorded_event, OC_PROCESS_PRIORITY_HIGH);
+  EXPECT_EQ(OC_PROCESS_PRIORITY_HIGH,
+            oc_process_event_priority(g_recorded_event));
+  ASSERT_EQ(OC_PROCESS_ERR_OK,
+            oc_process_post(&recording_process, g_recorded_event,
+                            reinterpret_cast<oc_process_data_t>(2)));
+  Run();
+  EXPECT_EQ((std::vector<intptr_t>{ 2, 1 }), g_received);
+
+  // reset by oc_process_init
+  oc_process_shutdown();
+  oc_process_init();
+  EXPECT_EQ(OC_PROCESS_PRIORITY_NORMAL,
+            oc_process_event_priority(g_recorded_event));
+}
+
+TEST_F(TestProcessQueue, NormalPriorityNotStarved)
+{
+  // keep the high priority queue busy, the normal priority event must be
+  // delivered before the high priority queue is drained
+  const int count = 2 * queueSize_;
+  Post(0, OC_PROCESS_PRIORITY_NORMAL);
+  for (int i = 1; i <= queueSize_; ++i) {
+    Post(i, OC_PROCESS_PRIORITY_HIGH);
+  }
+  for (int i = queueSize_ + 1; i <= count; ++i) {
+    ASSERT_LT(0, oc_process_run());
+    if (g_received.back() == 0) {
+      // the normal priority event was delivered, make room for a high one
+      ASSERT_LT(0, oc_process_run());
+    }
+    Post(i, OC_PROCESS_PRIORITY_HIGH);
+  }
+  Run();
+  ASSERT_EQ(static_cast<size_t>(count + 1), g_received.size());
+  auto it = std::find(g_received.begin(), g_received.end(), 0);
+  ASSERT_NE(g_received.end(), it);
+  EXPECT_GT(queueSize_, std::distance(g_received.begin(), it));
+}
+
+TEST_F(TestProcessQueue, Full)
+{
+  for (int i = OC_PROCESS_PRIORITY_NORMAL; i <= OC_PROCESS_PRIORITY_HIGH;
+       ++i) {
+    auto priority = static_cast<oc_process_priority_t>(i);
+    EXPECT_EQ(0, oc_process_dropped_events(priority));
+    int posted = 0;
+    while (oc_process_post_with_priority(&recording_process, g_recorded_event,
+                                         nullptr,
+                                         priority) == OC_PROCESS_ERR_OK) {
+      ++posted;
+      ASSERT_GT(UINT16_MAX, posted);
+    }
+    EXPECT_EQ(1, oc_process_dropped_events(priority));
+    EXPECT_EQ(posted, oc_process_num_events(priority));
+#ifdef OC_DYNAMIC_ALLOCATION
+    // the queue has grown up to the cap
+    EXPECT_LT(queueSize_, posted);
+#else  /* !OC_DYNAMIC_ALLOCATION */
+    EXPECT_EQ(queueSize_, posted);
+#endif /* OC_DYNAMIC_ALLOCATION */
+  }
+  Run();
+  EXPECT_EQ(0, oc_process_nevents());
+}
+
+TEST_F(TestProcessQueue, DropKeepsOrder)
+{
+  const int count = 3 * (queueSize_ / 2);
+  for (int i = 0; i < count; ++i) {
+    // make the ring wrap around
+    if (i == queueSize_ / 2) {
+      Run();
+      g_received.clear();
+    }
+    Post(i, OC_PROCESS_PRIORITY_NORMAL);
+  }
+  auto drop_odd = [](oc_process_event_t, oc_process_data_t data,
+                     const void *) {
+    return reinterpret_cast<intptr_t>(data) % 2 != 0;
+  };
+  std::vector<intptr_t> expected{};
+  for (int i = queueSize_ / 2; i < count; ++i) {
+    if (i % 2 == 0) {
+      expected.push_back(i);
+    }
+  }
+  EXPECT_EQ(count - queueSize_ / 2 - static_cast<int>(expected.size()),
+            oc_process_drop(&recording_process, drop_odd, nullptr));
+  Run();
+  EXPECT_EQ(expected, g_received);
+}
+
+#endif /* OC_TEST */
+
 #ifdef OC_SECURITY
 
 TEST_F(TestProcess, IsClosingTLSSessions_F)